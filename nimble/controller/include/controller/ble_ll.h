@@ -209,6 +209,12 @@ STATS_SECT_START(ble_ll_stats)
     STATS_SECT_ENTRY(sync_scheduled)
     STATS_SECT_ENTRY(sched_state_sync_errs)
     STATS_SECT_ENTRY(sched_invalid_pdu)
+    STATS_SECT_ENTRY(rpa_cache_hit)
+    STATS_SECT_ENTRY(rpa_cache_miss)
+    STATS_SECT_ENTRY(rx_batch_1)
+    STATS_SECT_ENTRY(rx_batch_2_3)
+    STATS_SECT_ENTRY(rx_batch_4_7)
+    STATS_SECT_ENTRY(rx_batch_8_more)
 STATS_SECT_END
 extern STATS_SECT_DECL(ble_ll_stats) ble_ll_stats;
 
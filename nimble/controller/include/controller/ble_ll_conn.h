@@ -209,6 +209,18 @@ struct hci_ext_create_conn
     struct hci_ext_conn_params params[3];
 };
 
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+/* Per-connection throughput counters; only data (l2cap) PDUs are counted */
+struct ble_ll_conn_tput_stats
+{
+    uint32_t events;
+    uint32_t tx_pdus;       /* Acknowledged by peer */
+    uint32_t tx_bytes;
+    uint32_t rx_pdus;
+    uint32_t rx_bytes;
+};
+#endif
+
 /* Connection state machine */
 struct ble_ll_conn_sm
 {
@@ -253,6 +265,9 @@ struct ble_ll_conn_sm
     /* Used to calculate data channel index for connection */
     uint8_t chanmap[BLE_LL_CONN_CHMAP_LEN];
     uint8_t req_chanmap[BLE_LL_CONN_CHMAP_LEN];
+#if MYNEWT_VAL(BLE_LL_CHAN_REMAP_TABLE)
+    uint8_t chan_remap[BLE_PHY_NUM_DATA_CHANS];
+#endif
     uint16_t chanmap_instant;
     uint16_t channel_id; /* TODO could be union with hop and last chan used */
     uint8_t hop_inc;
@@ -316,6 +331,10 @@ struct ble_ll_conn_sm
     uint32_t slave_cur_tx_win_usecs;
     uint32_t slave_cur_window_widening;
     uint32_t last_rxd_pdu_cputime;  /* Used exclusively for supervision timer */
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+    uint32_t max_event_ticks;       /* 0: event not limited */
+    struct ble_ll_conn_tput_stats tput_stats;
+#endif
 
     /*
      * Used to mark that identity address was used as InitA
@@ -424,6 +443,30 @@ uint8_t ble_ll_conn_calc_dci(struct ble_ll_conn_sm *conn, uint16_t latency);
 void ble_ll_conn_get_anchor(struct ble_ll_conn_sm *connsm, uint16_t conn_event,
                             uint32_t *anchor, uint8_t *anchor_usecs);
 
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+/*
+ * Limits length of connection events, measured from anchor point. No more
+ * data is sent once the limit is reached. Zero removes the limit. Set by
+ * the host with the BLE_HCI_OCF_VS_SET_MAX_CONN_EVENT_LEN command.
+ */
+int ble_ll_conn_set_max_event_len(uint16_t handle, uint32_t usecs);
+
+/* Read by the host with the BLE_HCI_OCF_VS_RD_CONN_TPUT_STATS command */
+int ble_ll_conn_get_tput_stats(uint16_t handle,
+                               struct ble_ll_conn_tput_stats *stats);
+
+/*
+ * Time to reserve in the scheduler for the next connection event; not used
+ * with BLE_LL_STRICT_CONN_SCHEDULING.
+ */
+uint32_t ble_ll_conn_burst_ticks(struct ble_ll_conn_sm *connsm,
+                                 uint32_t min_ticks);
+
+/* Caps end of the current connection event at the maximum event length */
+uint32_t ble_ll_conn_burst_end_time(struct ble_ll_conn_sm *connsm,
+                                    uint32_t ce_end);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
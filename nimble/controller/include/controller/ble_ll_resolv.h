@@ -103,12 +103,21 @@ uint32_t ble_ll_resolv_get_rpa_tmo(void);
 /* Resolve a resolvable private address */
 int ble_ll_resolv_rpa(const uint8_t *rpa, const uint8_t *irk);
 
-/* Try to resolve peer RPA and return index on RL if matched */
+/*
+ * Try to resolve peer RPA in software and return index on RL if matched.
+ * Results are cached (BLE_LL_RESOLV_CACHE_SIZE). Used for periodic sync
+ * transfer only; other roles rely on ble_hw_resolv_list_match().
+ */
 int ble_ll_resolv_peer_rpa_any(const uint8_t *rpa);
 
 /* Initialize resolv*/
 void ble_ll_resolv_init(void);
 
+#if MYNEWT_VAL(SELFTEST)
+/* Override resolving list size reported by HW (restored on reset) */
+void ble_ll_resolv_list_size_set(uint8_t size);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -286,6 +286,31 @@ void ble_ll_scan_end_adv_evt(struct ble_ll_aux_data *aux_data);
 /* Called to halt currently running scan */
 void ble_ll_scan_halt(void);
 
+/*
+ * Called to append a single advertising report event to a pending event of
+ * the same subevent. Returns non-zero if the report does not fit in it.
+ */
+int ble_ll_scan_rpt_append(struct ble_hci_ev *pending,
+                           const struct ble_hci_ev *hci_ev);
+
+/* Initializes the duplicate filter; all advertisers are forgotten */
+void ble_ll_scan_dup_init(void);
+
+/*
+ * Returns non-zero if a legacy PDU of the given type from the advertiser was
+ * already reported. Otherwise the advertiser becomes the most recently seen
+ * entry, evicting the least recently seen one if the filter is full.
+ */
+int ble_ll_scan_dup_check_legacy(uint8_t addr_type, const uint8_t *addr,
+                                 uint8_t pdu_type);
+
+/*
+ * Records that a report was sent for the advertiser passed to the preceding
+ * ble_ll_scan_dup_check_legacy() call.
+ */
+int ble_ll_scan_dup_update_legacy(uint8_t addr_type, const uint8_t *addr,
+                                  uint8_t subev, uint8_t evtype);
+
 #ifdef __cplusplus
 }
 #endif
@@ -132,6 +132,12 @@ struct ble_ll_sched_item
     void            *cb_arg;
     sched_cb_func   sched_cb;
     TAILQ_ENTRY(ble_ll_sched_item) link;
+#if MYNEWT_VAL(BLE_LL_SCHED_SKIPLIST_LEVELS)
+    /* Skip list index; item is linked on levels below sl_height */
+    uint8_t         sl_height;
+    struct ble_ll_sched_item *sl_next[MYNEWT_VAL(BLE_LL_SCHED_SKIPLIST_LEVELS)];
+    struct ble_ll_sched_item *sl_prev[MYNEWT_VAL(BLE_LL_SCHED_SKIPLIST_LEVELS)];
+#endif
 };
 
 /* Initialize the scheduler */
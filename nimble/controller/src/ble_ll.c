@@ -220,6 +220,12 @@ STATS_NAME_START(ble_ll_stats)
     STATS_NAME(ble_ll_stats, sync_scheduled)
     STATS_NAME(ble_ll_stats, sched_state_sync_errs)
     STATS_NAME(ble_ll_stats, sched_invalid_pdu)
+    STATS_NAME(ble_ll_stats, rpa_cache_hit)
+    STATS_NAME(ble_ll_stats, rpa_cache_miss)
+    STATS_NAME(ble_ll_stats, rx_batch_1)
+    STATS_NAME(ble_ll_stats, rx_batch_2_3)
+    STATS_NAME(ble_ll_stats, rx_batch_4_7)
+    STATS_NAME(ble_ll_stats, rx_batch_8_more)
 STATS_NAME_END(ble_ll_stats)
 
 static void ble_ll_event_rx_pkt(struct ble_npl_event *ev);
@@ -784,10 +790,86 @@ ble_ll_count_rx_stats(struct ble_mbuf_hdr *hdr, uint16_t len, uint8_t pdu_type)
     }
 }
 
+/**
+ * Process a single received packet from PHY.
+ *
+ * Context: Link layer task
+ *
+ * @param m Pointer to received packet
+ */
+static void
+ble_ll_rx_pkt_proc(struct os_mbuf *m)
+{
+    uint8_t pdu_type;
+    uint8_t *rxbuf;
+    struct ble_mbuf_hdr *ble_hdr;
+
+    /* Note: pdu type wont get used unless this is an advertising pdu */
+    ble_hdr = BLE_MBUF_HDR_PTR(m);
+    rxbuf = m->om_data;
+    pdu_type = rxbuf[0] & BLE_ADV_PDU_HDR_TYPE_MASK;
+    ble_ll_count_rx_stats(ble_hdr, OS_MBUF_PKTLEN(m), pdu_type);
+
+    /* Process the data or advertising pdu */
+    /* Process the PDU */
+    switch (BLE_MBUF_HDR_RX_STATE(ble_hdr)) {
+    case BLE_LL_STATE_CONNECTION:
+        ble_ll_conn_rx_data_pdu(m, ble_hdr);
+        /* m is going to be free by function above */
+        m = NULL;
+        break;
+    case BLE_LL_STATE_ADV:
+        ble_ll_adv_rx_pkt_in(pdu_type, rxbuf, ble_hdr);
+        break;
+    case BLE_LL_STATE_SCANNING:
+        ble_ll_scan_rx_pkt_in(pdu_type, m, ble_hdr);
+        break;
+    case BLE_LL_STATE_INITIATING:
+        ble_ll_init_rx_pkt_in(pdu_type, rxbuf, ble_hdr);
+        break;
+#if MYNEWT_VAL(BLE_LL_DTM)
+    case BLE_LL_STATE_DTM:
+        ble_ll_dtm_rx_pkt_in(m, ble_hdr);
+        break;
+#endif
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PERIODIC_ADV)
+    case BLE_LL_STATE_SYNC:
+        ble_ll_sync_rx_pkt_in(m, ble_hdr);
+        break;
+#endif
+    default:
+        /* Any other state should never occur */
+        STATS_INC(ble_ll_stats, bad_ll_state);
+        break;
+    }
+    if (m) {
+        /* Free the packet buffer */
+        os_mbuf_free_chain(m);
+    }
+}
+
+static void
+ble_ll_count_rx_batch(int cnt)
+{
+    if (cnt == 1) {
+        STATS_INC(ble_ll_stats, rx_batch_1);
+    } else if (cnt < 4) {
+        STATS_INC(ble_ll_stats, rx_batch_2_3);
+    } else if (cnt < 8) {
+        STATS_INC(ble_ll_stats, rx_batch_4_7);
+    } else {
+        STATS_INC(ble_ll_stats, rx_batch_8_more);
+    }
+}
+
 /**
  * ll rx pkt in
  *
- * Process received packet from PHY.
+ * Process received packets from PHY.
+ *
+ * All packets queued so far are taken off the receive queue at once, with a
+ * single critical section, and then processed in the order they were
+ * received. Packets received in the meantime are picked up by the next batch.
  *
  * Context: Link layer task
  *
@@ -796,65 +878,36 @@ static void
 ble_ll_rx_pkt_in(void)
 {
     os_sr_t sr;
-    uint8_t pdu_type;
-    uint8_t *rxbuf;
+    int cnt;
     struct os_mbuf_pkthdr *pkthdr;
-    struct ble_mbuf_hdr *ble_hdr;
+    struct os_mbuf_pkthdr *next;
     struct os_mbuf *m;
 
-    /* Drain all packets off the queue */
-    while (STAILQ_FIRST(&g_ble_ll_data.ll_rx_pkt_q)) {
-        /* Get mbuf pointer from packet header pointer */
-        pkthdr = STAILQ_FIRST(&g_ble_ll_data.ll_rx_pkt_q);
-        m = (struct os_mbuf *)((uint8_t *)pkthdr - sizeof(struct os_mbuf));
-
-        /* Remove from queue */
+    while (1) {
+        /* Detach all queued packets */
         OS_ENTER_CRITICAL(sr);
-        STAILQ_REMOVE_HEAD(&g_ble_ll_data.ll_rx_pkt_q, omp_next);
+        pkthdr = STAILQ_FIRST(&g_ble_ll_data.ll_rx_pkt_q);
+        STAILQ_INIT(&g_ble_ll_data.ll_rx_pkt_q);
         OS_EXIT_CRITICAL(sr);
 
-        /* Note: pdu type wont get used unless this is an advertising pdu */
-        ble_hdr = BLE_MBUF_HDR_PTR(m);
-        rxbuf = m->om_data;
-        pdu_type = rxbuf[0] & BLE_ADV_PDU_HDR_TYPE_MASK;
-        ble_ll_count_rx_stats(ble_hdr, pkthdr->omp_len, pdu_type);
-
-        /* Process the data or advertising pdu */
-        /* Process the PDU */
-        switch (BLE_MBUF_HDR_RX_STATE(ble_hdr)) {
-        case BLE_LL_STATE_CONNECTION:
-            ble_ll_conn_rx_data_pdu(m, ble_hdr);
-            /* m is going to be free by function above */
-            m = NULL;
-            break;
-        case BLE_LL_STATE_ADV:
-            ble_ll_adv_rx_pkt_in(pdu_type, rxbuf, ble_hdr);
-            break;
-        case BLE_LL_STATE_SCANNING:
-            ble_ll_scan_rx_pkt_in(pdu_type, m, ble_hdr);
-            break;
-        case BLE_LL_STATE_INITIATING:
-            ble_ll_init_rx_pkt_in(pdu_type, rxbuf, ble_hdr);
-            break;
-#if MYNEWT_VAL(BLE_LL_DTM)
-        case BLE_LL_STATE_DTM:
-            ble_ll_dtm_rx_pkt_in(m, ble_hdr);
-            break;
-#endif
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PERIODIC_ADV)
-        case BLE_LL_STATE_SYNC:
-            ble_ll_sync_rx_pkt_in(m, ble_hdr);
-            break;
-#endif
-        default:
-            /* Any other state should never occur */
-            STATS_INC(ble_ll_stats, bad_ll_state);
+        if (!pkthdr) {
             break;
         }
-        if (m) {
-            /* Free the packet buffer */
-            os_mbuf_free_chain(m);
+
+        cnt = 0;
+        while (pkthdr) {
+            /* Packet header is reused once packet is processed */
+            next = STAILQ_NEXT(pkthdr, omp_next);
+
+            /* Get mbuf pointer from packet header pointer */
+            m = (struct os_mbuf *)((uint8_t *)pkthdr - sizeof(struct os_mbuf));
+            ble_ll_rx_pkt_proc(m);
+
+            pkthdr = next;
+            ++cnt;
         }
+
+        ble_ll_count_rx_batch(cnt);
     }
 }
 
@@ -867,10 +920,20 @@ void
 ble_ll_rx_pdu_in(struct os_mbuf *rxpdu)
 {
     struct os_mbuf_pkthdr *pkthdr;
+    bool was_empty;
 
     pkthdr = OS_MBUF_PKTHDR(rxpdu);
+    was_empty = STAILQ_EMPTY(&g_ble_ll_data.ll_rx_pkt_q);
     STAILQ_INSERT_TAIL(&g_ble_ll_data.ll_rx_pkt_q, pkthdr, omp_next);
-    ble_npl_eventq_put(&g_ble_ll_data.ll_evq, &g_ble_ll_data.ll_rx_pkt_ev);
+
+    /*
+     * If queue was not empty, event is already pending or the link layer
+     * task has not taken queued packets yet; either way this packet will be
+     * processed along with them.
+     */
+    if (was_empty) {
+        ble_npl_eventq_put(&g_ble_ll_data.ll_evq, &g_ble_ll_data.ll_rx_pkt_ev);
+    }
 }
 
 /**
@@ -160,6 +160,9 @@ struct ble_ll_adv_sm
     uint8_t periodic_sync_index : 1;
     uint8_t periodic_num_used_chans;
     uint8_t periodic_chanmap[BLE_LL_CONN_CHMAP_LEN];
+#if MYNEWT_VAL(BLE_LL_CHAN_REMAP_TABLE)
+    uint8_t periodic_chan_remap[BLE_PHY_NUM_DATA_CHANS];
+#endif
     uint32_t periodic_adv_itvl_ticks;
     uint8_t periodic_adv_itvl_rem_usec;
     uint8_t periodic_adv_event_start_time_remainder;
@@ -2216,6 +2219,22 @@ adv_tx_done:
     return BLE_LL_SCHED_STATE_DONE;
 }
 
+static uint8_t
+ble_ll_adv_periodic_calc_chan(struct ble_ll_adv_sm *advsm, uint16_t event_cntr)
+{
+#if MYNEWT_VAL(BLE_LL_CHAN_REMAP_TABLE)
+    return ble_ll_utils_calc_dci_csa2_table(event_cntr,
+                                            advsm->periodic_channel_id,
+                                            advsm->periodic_num_used_chans,
+                                            advsm->periodic_chanmap,
+                                            advsm->periodic_chan_remap);
+#else
+    return ble_ll_utils_calc_dci_csa2(event_cntr, advsm->periodic_channel_id,
+                                      advsm->periodic_num_used_chans,
+                                      advsm->periodic_chanmap);
+#endif
+}
+
 static void
 ble_ll_adv_sync_calculate(struct ble_ll_adv_sm *advsm,
                           struct ble_ll_adv_sync *sync,
@@ -2309,10 +2328,7 @@ ble_ll_adv_periodic_schedule_first(struct ble_ll_adv_sm *advsm,
      * Preincrement event counter as we later send this in PDU so make sure
      * same values are used
      */
-    chan = ble_ll_utils_calc_dci_csa2(++advsm->periodic_event_cntr,
-                                      advsm->periodic_channel_id,
-                                      advsm->periodic_num_used_chans,
-                                      advsm->periodic_chanmap);
+    chan = ble_ll_adv_periodic_calc_chan(advsm, ++advsm->periodic_event_cntr);
 
     ble_ll_adv_sync_calculate(advsm, sync, 0, chan);
 
@@ -2400,10 +2416,8 @@ ble_ll_adv_periodic_schedule_next(struct ble_ll_adv_sm *advsm)
     assert(rem_sync_data_len > 0);
 
     /* we use separate counter for chaining */
-    chan = ble_ll_utils_calc_dci_csa2(advsm->periodic_chain_event_cntr++,
-                                      advsm->periodic_channel_id,
-                                      advsm->periodic_num_used_chans,
-                                      advsm->periodic_chanmap);
+    chan = ble_ll_adv_periodic_calc_chan(advsm,
+                                         advsm->periodic_chain_event_cntr++);
 
     ble_ll_adv_sync_calculate(advsm, sync_next, next_sync_data_offset, chan);
     max_usecs = ble_ll_pdu_tx_time_get(sync_next->payload_len, advsm->sec_phy);
@@ -2545,6 +2559,10 @@ ble_ll_adv_sm_start_periodic(struct ble_ll_adv_sm *advsm)
     memcpy(advsm->periodic_chanmap, g_ble_ll_conn_params.master_chan_map,
            BLE_LL_CONN_CHMAP_LEN);
     advsm->periodic_num_used_chans = g_ble_ll_conn_params.num_used_chans;
+#if MYNEWT_VAL(BLE_LL_CHAN_REMAP_TABLE)
+    ble_ll_utils_calc_remap_table(advsm->periodic_chanmap,
+                                  advsm->periodic_chan_remap);
+#endif
     advsm->periodic_event_cntr = 0;
     /* for chaining we start with random counter as we share access addr */
     advsm->periodic_chain_event_cntr = rand();
@@ -624,7 +624,11 @@ ble_ll_conn_calc_dci_csa1(struct ble_ll_conn_sm *conn)
     /* Calculate remap index */
     remap_index = curchan % conn->num_used_chans;
 
+#if MYNEWT_VAL(BLE_LL_CHAN_REMAP_TABLE)
+    return conn->chan_remap[remap_index];
+#else
     return ble_ll_utils_remapped_channel(remap_index, conn->chanmap);
+#endif
 }
 
 /**
@@ -643,8 +647,16 @@ ble_ll_conn_calc_dci(struct ble_ll_conn_sm *conn, uint16_t latency)
 
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_CSA2)
     if (CONN_F_CSA2_SUPP(conn)) {
+#if MYNEWT_VAL(BLE_LL_CHAN_REMAP_TABLE)
+        return ble_ll_utils_calc_dci_csa2_table(conn->event_cntr,
+                                                conn->channel_id,
+                                                conn->num_used_chans,
+                                                conn->chanmap,
+                                                conn->chan_remap);
+#else
         return ble_ll_utils_calc_dci_csa2(conn->event_cntr, conn->channel_id,
                                           conn->num_used_chans, conn->chanmap);
+#endif
     }
 #endif
 
@@ -846,9 +858,175 @@ ble_ll_conn_get_next_sched_time(struct ble_ll_conn_sm *connsm)
     }
 #endif
 
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+    ce_end = ble_ll_conn_burst_end_time(connsm, ce_end);
+#endif
+
     return ce_end;
 }
 
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+/**
+ * Applies the maximum connection event length to the time by which the
+ * current connection event has to end. The master does not start another
+ * PDU exchange, and so stops setting MD, once it would run past this time.
+ *
+ * @param connsm
+ * @param ce_end End of event as allowed by the scheduler
+ *
+ * @return uint32_t End of event
+ */
+uint32_t
+ble_ll_conn_burst_end_time(struct ble_ll_conn_sm *connsm, uint32_t ce_end)
+{
+    uint32_t limit;
+
+    if (connsm->max_event_ticks) {
+        limit = connsm->anchor_point + connsm->max_event_ticks;
+        if (CPUTIME_LT(limit, ce_end)) {
+            ce_end = limit;
+        }
+    }
+
+    return ce_end;
+}
+
+/**
+ * Calculates how long it takes to send a packet of given length, including
+ * empty PDUs received in response.
+ */
+static uint32_t
+ble_ll_conn_burst_pkt_usecs(struct ble_ll_conn_sm *connsm, uint16_t len,
+                            int tx_phy_mode, int rx_phy_mode)
+{
+    uint32_t usecs;
+    uint16_t txlen;
+
+    usecs = 0;
+    do {
+        txlen = min(len, connsm->eff_max_tx_octets);
+        usecs += ble_ll_pdu_tx_time_get(txlen, tx_phy_mode) + BLE_LL_IFS +
+                 ble_ll_pdu_tx_time_get(0, rx_phy_mode) + BLE_LL_IFS;
+        len -= txlen;
+    } while (len > 0);
+
+    return usecs;
+}
+
+/**
+ * Calculates time to reserve for next connection event so that the data
+ * queued for transmission can be sent in a single event.
+ *
+ * The reservation is at least min_ticks and at most half of the connection
+ * interval or the configured maximum event length, whichever is shorter.
+ * Only used without BLE_LL_STRICT_CONN_SCHEDULING; strict scheduling gives
+ * each connection a fixed period.
+ *
+ * @param connsm
+ * @param min_ticks Default reservation
+ *
+ * @return uint32_t Number of ticks to reserve
+ */
+uint32_t
+ble_ll_conn_burst_ticks(struct ble_ll_conn_sm *connsm, uint32_t min_ticks)
+{
+    os_sr_t sr;
+    uint32_t max_ticks;
+    uint32_t max_usecs;
+    uint32_t usecs;
+    uint32_t ticks;
+    struct ble_mbuf_hdr *txhdr;
+    struct os_mbuf_pkthdr *pkthdr;
+    int tx_phy_mode;
+    int rx_phy_mode;
+
+    max_ticks = connsm->conn_itvl_ticks / 2;
+    if (connsm->max_event_ticks && (connsm->max_event_ticks < max_ticks)) {
+        max_ticks = connsm->max_event_ticks;
+    }
+
+    if (max_ticks <= min_ticks) {
+        return min_ticks;
+    }
+
+#if BLE_LL_BT5_PHY_SUPPORTED
+    tx_phy_mode = connsm->phy_data.tx_phy_mode;
+    rx_phy_mode = connsm->phy_data.rx_phy_mode;
+#else
+    tx_phy_mode = BLE_PHY_MODE_1M;
+    rx_phy_mode = BLE_PHY_MODE_1M;
+#endif
+
+    max_usecs = os_cputime_ticks_to_usecs(max_ticks);
+    usecs = 0;
+
+    /* Queue is modified in interrupt context */
+    OS_ENTER_CRITICAL(sr);
+
+    if (connsm->cur_tx_pdu) {
+        txhdr = BLE_MBUF_HDR_PTR(connsm->cur_tx_pdu);
+        usecs += ble_ll_conn_burst_pkt_usecs(connsm,
+                                             OS_MBUF_PKTLEN(connsm->cur_tx_pdu) -
+                                             txhdr->txinfo.offset,
+                                             tx_phy_mode, rx_phy_mode);
+    }
+
+    STAILQ_FOREACH(pkthdr, &connsm->conn_txq, omp_next) {
+        if (usecs >= max_usecs) {
+            break;
+        }
+        usecs += ble_ll_conn_burst_pkt_usecs(connsm, pkthdr->omp_len,
+                                             tx_phy_mode, rx_phy_mode);
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    ticks = os_cputime_usecs_to_ticks(usecs);
+    if (ticks < min_ticks) {
+        ticks = min_ticks;
+    } else if (ticks > max_ticks) {
+        ticks = max_ticks;
+    }
+
+    return ticks;
+}
+
+int
+ble_ll_conn_set_max_event_len(uint16_t handle, uint32_t usecs)
+{
+    struct ble_ll_conn_sm *connsm;
+
+    connsm = ble_ll_conn_find_active_conn(handle);
+    if (!connsm) {
+        return BLE_ERR_UNK_CONN_ID;
+    }
+
+    connsm->max_event_ticks = os_cputime_usecs_to_ticks(usecs);
+
+    return BLE_ERR_SUCCESS;
+}
+
+int
+ble_ll_conn_get_tput_stats(uint16_t handle,
+                           struct ble_ll_conn_tput_stats *stats)
+{
+    os_sr_t sr;
+    struct ble_ll_conn_sm *connsm;
+
+    connsm = ble_ll_conn_find_active_conn(handle);
+    if (!connsm) {
+        return BLE_ERR_UNK_CONN_ID;
+    }
+
+    /* Counters are updated in interrupt context */
+    OS_ENTER_CRITICAL(sr);
+    *stats = connsm->tput_stats;
+    OS_EXIT_CRITICAL(sr);
+
+    return BLE_ERR_SUCCESS;
+}
+#endif
+
 /**
  * Called to check if certain connection state machine flags have been
  * set.
@@ -1619,6 +1797,9 @@ ble_ll_conn_master_common_init(struct ble_ll_conn_sm *connsm)
     connsm->num_used_chans = g_ble_ll_conn_params.num_used_chans;
     memcpy(connsm->chanmap, g_ble_ll_conn_params.master_chan_map,
            BLE_LL_CONN_CHMAP_LEN);
+#if MYNEWT_VAL(BLE_LL_CHAN_REMAP_TABLE)
+    ble_ll_utils_calc_remap_table(connsm->chanmap, connsm->chan_remap);
+#endif
 
     /*  Calculate random access address and crc initialization value */
     connsm->access_addr = ble_ll_utils_calc_access_addr();
@@ -1843,6 +2024,10 @@ ble_ll_conn_sm_new(struct ble_ll_conn_sm *connsm)
     connsm->vers_nr = 0;
     connsm->comp_id = 0;
     connsm->sub_vers_nr = 0;
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+    connsm->max_event_ticks = 0;
+    memset(&connsm->tput_stats, 0, sizeof(connsm->tput_stats));
+#endif
     connsm->reject_reason = BLE_ERR_SUCCESS;
     connsm->conn_rssi = BLE_LL_CONN_UNKNOWN_RSSI;
     connsm->rpa_index = -1;
@@ -2273,6 +2458,9 @@ ble_ll_conn_next_event(struct ble_ll_conn_sm *connsm)
         connsm->num_used_chans =
             ble_ll_utils_calc_num_used_chans(connsm->req_chanmap);
         memcpy(connsm->chanmap, connsm->req_chanmap, BLE_LL_CONN_CHMAP_LEN);
+#if MYNEWT_VAL(BLE_LL_CHAN_REMAP_TABLE)
+        ble_ll_utils_calc_remap_table(connsm->chanmap, connsm->chan_remap);
+#endif
 
         connsm->csmflags.cfbit.chanmap_update_scheduled = 0;
 
@@ -2350,6 +2538,9 @@ ble_ll_conn_next_event(struct ble_ll_conn_sm *connsm)
     itvl = g_ble_ll_sched_data.sch_ticks_per_period;
 #else
     itvl = MYNEWT_VAL(BLE_LL_CONN_INIT_SLOTS) * BLE_LL_SCHED_32KHZ_TICKS_PER_SLOT;
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+    itvl = ble_ll_conn_burst_ticks(connsm, itvl);
+#endif
 #endif
     if (connsm->conn_role == BLE_LL_CONN_ROLE_SLAVE) {
 
@@ -2601,6 +2792,10 @@ ble_ll_conn_event_end(struct ble_npl_event *ev)
      */
 #endif
 
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+    ++connsm->tput_stats.events;
+#endif
+
     /* Move to next connection event */
     if (ble_ll_conn_next_event(connsm)) {
         ble_ll_conn_end(connsm, BLE_ERR_CONN_TERM_LOCAL);
@@ -3724,6 +3919,10 @@ ble_ll_conn_rx_data_pdu(struct os_mbuf *rxpdu, struct ble_mbuf_hdr *hdr)
         /* Count # of received l2cap frames and byes */
         STATS_INC(ble_ll_conn_stats, rx_l2cap_pdus);
         STATS_INCN(ble_ll_conn_stats, rx_l2cap_bytes, acl_len);
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+        ++connsm->tput_stats.rx_pdus;
+        connsm->tput_stats.rx_bytes += acl_len;
+#endif
 
         /* NOTE: there should be at least two bytes available */
         BLE_LL_ASSERT(OS_MBUF_LEADINGSPACE(rxpdu) >= 2);
@@ -3962,6 +4161,11 @@ ble_ll_conn_rx_isr_end(uint8_t *rxbuf, struct ble_mbuf_hdr *rxhdr)
                         }
                     }
 
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+                    ++connsm->tput_stats.tx_pdus;
+                    connsm->tput_stats.tx_bytes += txhdr->txinfo.pyld_len;
+#endif
+
                     /* Increment offset based on number of bytes sent */
                     txhdr->txinfo.offset += txhdr->txinfo.pyld_len;
                     if (txhdr->txinfo.offset >= OS_MBUF_PKTLEN(txpdu)) {
@@ -4306,6 +4510,9 @@ ble_ll_conn_slave_start(uint8_t *rxbuf, uint8_t pat, struct ble_mbuf_hdr *rxhdr,
     if (connsm->num_used_chans < 2) {
         goto err_slave_start;
     }
+#if MYNEWT_VAL(BLE_LL_CHAN_REMAP_TABLE)
+    ble_ll_utils_calc_remap_table(connsm->chanmap, connsm->chan_remap);
+#endif
 
     /* Start the connection state machine */
     connsm->conn_role = BLE_LL_CONN_ROLE_SLAVE;
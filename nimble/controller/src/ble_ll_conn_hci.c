@@ -1917,3 +1917,83 @@ ble_ll_set_default_sync_transfer_params(const uint8_t *cmdbuf, uint8_t len)
     return BLE_ERR_SUCCESS;
 }
 #endif
+
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+/**
+ * Vendor specific command limiting the length of connection events of a
+ * connection; see ble_ll_conn_set_max_event_len().
+ *
+ * @param cmdbuf
+ * @param rspbuf
+ * @param rsplen
+ *
+ * @return int
+ */
+int
+ble_ll_conn_hci_vs_set_max_event_len(const uint8_t *cmdbuf, uint8_t len,
+                                     uint8_t *rspbuf, uint8_t *rsplen)
+{
+    const struct ble_hci_vs_set_max_conn_event_len_cp *cmd;
+    struct ble_hci_vs_set_max_conn_event_len_rp *rsp;
+    uint32_t usecs;
+    int rc;
+
+    cmd = (const void *)cmdbuf;
+    rsp = (void *)rspbuf;
+
+    if (len != sizeof(*cmd)) {
+        return BLE_ERR_INV_HCI_CMD_PARMS;
+    }
+
+    /* No connection event is longer than the longest connection interval */
+    usecs = le32toh(cmd->max_event_len);
+    if (usecs > BLE_HCI_CONN_ITVL_MAX * BLE_HCI_CONN_ITVL) {
+        return BLE_ERR_INV_HCI_CMD_PARMS;
+    }
+
+    rc = ble_ll_conn_set_max_event_len(le16toh(cmd->conn_handle), usecs);
+
+    rsp->conn_handle = cmd->conn_handle;
+    *rsplen = sizeof(*rsp);
+    return rc;
+}
+
+/**
+ * Vendor specific command reading the throughput counters of a connection;
+ * see ble_ll_conn_get_tput_stats().
+ *
+ * @param cmdbuf
+ * @param rspbuf
+ * @param rsplen
+ *
+ * @return int
+ */
+int
+ble_ll_conn_hci_vs_rd_tput_stats(const uint8_t *cmdbuf, uint8_t len,
+                                 uint8_t *rspbuf, uint8_t *rsplen)
+{
+    const struct ble_hci_vs_rd_conn_tput_stats_cp *cmd = (const void *)cmdbuf;
+    struct ble_hci_vs_rd_conn_tput_stats_rp *rsp = (void *)rspbuf;
+    struct ble_ll_conn_tput_stats stats;
+    int rc;
+
+    if (len != sizeof(*cmd)) {
+        return BLE_ERR_INV_HCI_CMD_PARMS;
+    }
+
+    rc = ble_ll_conn_get_tput_stats(le16toh(cmd->conn_handle), &stats);
+    if (rc) {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    rsp->conn_handle = cmd->conn_handle;
+    rsp->events = htole32(stats.events);
+    rsp->tx_pdus = htole32(stats.tx_pdus);
+    rsp->tx_bytes = htole32(stats.tx_bytes);
+    rsp->rx_pdus = htole32(stats.rx_pdus);
+    rsp->rx_bytes = htole32(stats.rx_bytes);
+
+    *rsplen = sizeof(*rsp);
+    return rc;
+}
+#endif
@@ -201,6 +201,13 @@ int ble_ll_conn_req_peer_sca(const uint8_t *cmdbuf, uint8_t len,
                              uint8_t *rspbuf, uint8_t *rsplen);
 #endif
 
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+int ble_ll_conn_hci_vs_set_max_event_len(const uint8_t *cmdbuf, uint8_t len,
+                                         uint8_t *rspbuf, uint8_t *rsplen);
+int ble_ll_conn_hci_vs_rd_tput_stats(const uint8_t *cmdbuf, uint8_t len,
+                                     uint8_t *rspbuf, uint8_t *rsplen);
+#endif
+
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_PING)
 void ble_ll_conn_auth_pyld_timer_start(struct ble_ll_conn_sm *connsm);
 #else
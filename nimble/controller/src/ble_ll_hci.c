@@ -35,6 +35,7 @@
 #include "controller/ble_ll_sync.h"
 #include "controller/ble_ll_iso.h"
 #include "ble_ll_priv.h"
+#include "ble_ll_hci_priv.h"
 #include "ble_ll_conn_priv.h"
 
 #if MYNEWT_VAL(BLE_LL_DTM)
@@ -621,41 +622,6 @@ ble_ll_hci_is_event_enabled(unsigned int evcode)
     return g_ble_ll_hci_event_mask & (1ull << (evcode - 1));
 }
 
-/**
- * Called to determine if the reply to the command should be a command complete
- * event or a command status event.
- *
- * @param ocf
- *
- * @return int 0: return command complete; 1: return command status event
- */
-static int
-ble_ll_hci_le_cmd_send_cmd_status(uint16_t ocf)
-{
-    int rc;
-
-    switch (ocf) {
-    case BLE_HCI_OCF_LE_RD_REM_FEAT:
-    case BLE_HCI_OCF_LE_CREATE_CONN:
-    case BLE_HCI_OCF_LE_EXT_CREATE_CONN:
-    case BLE_HCI_OCF_LE_CONN_UPDATE:
-    case BLE_HCI_OCF_LE_START_ENCRYPT:
-    case BLE_HCI_OCF_LE_RD_P256_PUBKEY:
-    case BLE_HCI_OCF_LE_GEN_DHKEY:
-    case BLE_HCI_OCF_LE_SET_PHY:
-    case BLE_HCI_OCF_LE_PERIODIC_ADV_CREATE_SYNC:
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_SCA_UPDATE)
-    case BLE_HCI_OCF_LE_REQ_PEER_SCA:
-#endif
-        rc = 1;
-        break;
-    default:
-        rc = 0;
-        break;
-    }
-    return rc;
-}
-
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
 /** HCI LE read maximum advertising data length command. Returns the controllers
 * max supported advertising data length;
@@ -694,75 +660,6 @@ ble_ll_adv_rd_sup_adv_sets(uint8_t *rspbuf, uint8_t *rsplen)
     *rsplen = sizeof(*rsp);
     return BLE_ERR_SUCCESS;
 }
-
-static bool
-ble_ll_is_valid_adv_mode(uint8_t ocf)
-{
-    /*
-     * If, since the last power-on or reset, the Host has ever issued a legacy
-     * advertising command and then issues an extended advertising command, or
-     * has ever issued an extended advertising command and then issues a legacy
-     * advertising command, the Controller shall return the error code Command
-     * Disallowed (0x0C).
-    */
-
-    switch(ocf) {
-    case BLE_HCI_OCF_LE_CREATE_CONN:
-    case BLE_HCI_OCF_LE_SET_ADV_PARAMS:
-    case BLE_HCI_OCF_LE_SET_ADV_ENABLE:
-    case BLE_HCI_OCF_LE_SET_ADV_DATA:
-    case BLE_HCI_OCF_LE_SET_SCAN_PARAMS:
-    case BLE_HCI_OCF_LE_SET_SCAN_ENABLE:
-    case BLE_HCI_OCF_LE_SET_SCAN_RSP_DATA:
-    case BLE_HCI_OCF_LE_RD_ADV_CHAN_TXPWR:
-        if (hci_adv_mode == ADV_MODE_EXT) {
-            return false;
-        }
-
-        hci_adv_mode = ADV_MODE_LEGACY;
-        break;
-    case BLE_HCI_OCF_LE_EXT_CREATE_CONN:
-    case BLE_HCI_OCF_LE_SET_EXT_ADV_DATA:
-    case BLE_HCI_OCF_LE_SET_EXT_ADV_ENABLE:
-    case BLE_HCI_OCF_LE_SET_EXT_ADV_PARAM:
-    case BLE_HCI_OCF_LE_SET_EXT_SCAN_ENABLE:
-    case BLE_HCI_OCF_LE_SET_EXT_SCAN_PARAM:
-    case BLE_HCI_OCF_LE_SET_EXT_SCAN_RSP_DATA:
-    case BLE_HCI_OCF_LE_RD_MAX_ADV_DATA_LEN:
-    case BLE_HCI_OCF_LE_RD_NUM_OF_ADV_SETS:
-    case BLE_HCI_OCF_LE_REMOVE_ADV_SET:
-    case BLE_HCI_OCF_LE_CLEAR_ADV_SETS:
-    case BLE_HCI_OCF_LE_SET_PERIODIC_ADV_PARAMS:
-    case BLE_HCI_OCF_LE_SET_PERIODIC_ADV_DATA:
-    case BLE_HCI_OCF_LE_SET_PERIODIC_ADV_ENABLE:
-    case BLE_HCI_OCF_LE_PERIODIC_ADV_CREATE_SYNC:
-    case BLE_HCI_OCF_LE_PERIODIC_ADV_CREATE_SYNC_CANCEL:
-    case BLE_HCI_OCF_LE_PERIODIC_ADV_TERM_SYNC:
-    case BLE_HCI_OCF_LE_ADD_DEV_TO_PERIODIC_ADV_LIST:
-    case BLE_HCI_OCF_LE_REM_DEV_FROM_PERIODIC_ADV_LIST:
-    case BLE_HCI_OCF_LE_CLEAR_PERIODIC_ADV_LIST:
-    case BLE_HCI_OCF_LE_RD_PERIODIC_ADV_LIST_SIZE:
-#if MYNEWT_VAL(BLE_VERSION) >= 51
-    case BLE_HCI_OCF_LE_PERIODIC_ADV_RECEIVE_ENABLE:
-#endif
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PERIODIC_ADV_SYNC_TRANSFER)
-    case BLE_HCI_OCF_LE_PERIODIC_ADV_SYNC_TRANSFER:
-    case BLE_HCI_OCF_LE_PERIODIC_ADV_SET_INFO_TRANSFER:
-    case BLE_HCI_OCF_LE_PERIODIC_ADV_SYNC_TRANSFER_PARAMS:
-    case BLE_HCI_OCF_LE_SET_DEFAULT_SYNC_TRANSFER_PARAMS:
-#endif
-        if (hci_adv_mode == ADV_MODE_LEGACY) {
-            return false;
-        }
-
-        hci_adv_mode = ADV_MODE_EXT;
-        break;
-    default:
-        break;
-    }
-
-    return true;
-}
 #endif
 
 static int
@@ -821,455 +718,6 @@ ble_ll_get_tx_pwr_compensation(void)
     return tx_path_pwr_compensation / 10;
 }
 
-/**
- * Process a LE command sent from the host to the controller. The HCI command
- * has a 3 byte command header followed by data. The header is:
- *  -> opcode (2 bytes)
- *  -> Length of parameters (1 byte; does include command header bytes).
- *
- * @param cmdbuf Pointer to command buffer. Points to start of command header.
- * @param ocf    Opcode command field.
- * @param *rsplen Pointer to length of response
- *
- * @return int  This function returns a BLE error code. If a command status
- *              event should be returned as opposed to command complete,
- *              256 gets added to the return value.
- */
-static int
-ble_ll_hci_le_cmd_proc(const uint8_t *cmdbuf, uint8_t len, uint16_t ocf,
-                       uint8_t *rspbuf, uint8_t *rsplen,
-                       ble_ll_hci_post_cmd_complete_cb *cb)
-{
-    int rc;
-
-    /* Assume error; if all pass rc gets set to 0 */
-    rc = BLE_ERR_INV_HCI_CMD_PARMS;
-
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
-    if (!ble_ll_is_valid_adv_mode(ocf)) {
-        rc = BLE_ERR_CMD_DISALLOWED;
-
-        /*
-         * This code is here because we add 256 to the return code to denote
-         * that the reply to this command should be command status (as opposed to
-         * command complete).
-         *
-         * For unknown HCI command let us return always command status as per
-         * specification Bluetooth 5, Vol. 2, Chapter 4.4
-         */
-        if (ble_ll_hci_le_cmd_send_cmd_status(ocf)) {
-            rc += (BLE_ERR_MAX + 1);
-        }
-
-        return rc;
-    }
-#endif
-
-    switch (ocf) {
-    case BLE_HCI_OCF_LE_SET_EVENT_MASK:
-        rc = ble_ll_hci_set_le_event_mask(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_RD_BUF_SIZE:
-        if (len == 0) {
-            rc = ble_ll_hci_le_read_bufsize(rspbuf, rsplen);
-        }
-        break;
-    case BLE_HCI_OCF_LE_RD_LOC_SUPP_FEAT:
-        if (len == 0) {
-            rc = ble_ll_hci_le_read_local_features(rspbuf, rsplen);
-        }
-        break;
-    case BLE_HCI_OCF_LE_SET_RAND_ADDR:
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
-        rc = ble_ll_set_random_addr(cmdbuf, len, hci_adv_mode == ADV_MODE_EXT);
-#else
-        rc = ble_ll_set_random_addr(cmdbuf, len, false);
-#endif
-        break;
-    case BLE_HCI_OCF_LE_SET_ADV_PARAMS:
-        rc = ble_ll_adv_set_adv_params(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_RD_ADV_CHAN_TXPWR:
-        if (len == 0) {
-            rc = ble_ll_adv_read_txpwr(rspbuf, rsplen);
-        }
-        break;
-    case BLE_HCI_OCF_LE_SET_ADV_DATA:
-        rc = ble_ll_hci_set_adv_data(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_SET_SCAN_RSP_DATA:
-        rc = ble_ll_hci_set_scan_rsp_data(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_SET_ADV_ENABLE:
-        rc = ble_ll_hci_adv_set_enable(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_SET_SCAN_PARAMS:
-        rc = ble_ll_scan_set_scan_params(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_SET_SCAN_ENABLE:
-        rc = ble_ll_hci_scan_set_enable(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_CREATE_CONN:
-        rc = ble_ll_conn_create(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_CREATE_CONN_CANCEL:
-        if (len == 0) {
-            rc = ble_ll_conn_create_cancel(cb);
-        }
-        break;
-    case BLE_HCI_OCF_LE_RD_WHITE_LIST_SIZE:
-        if (len == 0) {
-            rc = ble_ll_whitelist_read_size(rspbuf, rsplen);
-        }
-        break;
-    case BLE_HCI_OCF_LE_CLEAR_WHITE_LIST:
-        if (len == 0) {
-            rc = ble_ll_whitelist_clear();
-        }
-        break;
-    case BLE_HCI_OCF_LE_ADD_WHITE_LIST:
-        rc = ble_ll_whitelist_add(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_RMV_WHITE_LIST:
-        rc = ble_ll_whitelist_rmv(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_CONN_UPDATE:
-        rc = ble_ll_conn_hci_update(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_SET_HOST_CHAN_CLASS:
-        rc = ble_ll_conn_hci_set_chan_class(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_RD_CHAN_MAP:
-        rc = ble_ll_conn_hci_rd_chan_map(cmdbuf, len, rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_RD_REM_FEAT:
-        rc = ble_ll_conn_hci_read_rem_features(cmdbuf, len);
-        break;
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_ENCRYPTION)
-    case BLE_HCI_OCF_LE_ENCRYPT:
-        rc = ble_ll_hci_le_encrypt(cmdbuf, len, rspbuf, rsplen);
-        break;
-#endif
-    case BLE_HCI_OCF_LE_RAND:
-        if (len == 0) {
-            rc = ble_ll_hci_le_rand(rspbuf, rsplen);
-        }
-        break;
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_ENCRYPTION)
-    case BLE_HCI_OCF_LE_START_ENCRYPT:
-        rc = ble_ll_conn_hci_le_start_encrypt(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_LT_KEY_REQ_REPLY:
-        rc = ble_ll_conn_hci_le_ltk_reply(cmdbuf, len, rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_LT_KEY_REQ_NEG_REPLY:
-        rc = ble_ll_conn_hci_le_ltk_neg_reply(cmdbuf, len, rspbuf, rsplen);
-        break;
-#endif
-    case BLE_HCI_OCF_LE_RD_SUPP_STATES :
-        if (len == 0) {
-            rc = ble_ll_hci_le_read_supp_states(rspbuf, rsplen);
-        }
-        break;
-#if MYNEWT_VAL(BLE_LL_DTM)
-    case BLE_HCI_OCF_LE_TX_TEST:
-        rc = ble_ll_hci_dtm_tx_test(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_RX_TEST:
-        rc = ble_ll_hci_dtm_rx_test(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_TEST_END:
-        if (len == 0) {
-            rc = ble_ll_dtm_end_test(rspbuf, rsplen);
-        }
-        break;
-#endif
-    case BLE_HCI_OCF_LE_REM_CONN_PARAM_RR:
-        rc = ble_ll_conn_hci_param_rr(cmdbuf, len, rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_REM_CONN_PARAM_NRR:
-        rc = ble_ll_conn_hci_param_nrr(cmdbuf, len, rspbuf, rsplen);
-        break;
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_DATA_LEN_EXT)
-    case BLE_HCI_OCF_LE_SET_DATA_LEN:
-        rc = ble_ll_conn_hci_set_data_len(cmdbuf, len, rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_RD_SUGG_DEF_DATA_LEN:
-        if (len == 0) {
-            rc = ble_ll_hci_le_rd_sugg_data_len(rspbuf, rsplen);
-        }
-        break;
-    case BLE_HCI_OCF_LE_WR_SUGG_DEF_DATA_LEN:
-        rc = ble_ll_hci_le_wr_sugg_data_len(cmdbuf, len);
-        break;
-#endif
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PRIVACY)
-    case BLE_HCI_OCF_LE_ADD_RESOLV_LIST:
-        rc = ble_ll_resolv_list_add(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_RMV_RESOLV_LIST:
-        rc = ble_ll_resolv_list_rmv(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_CLR_RESOLV_LIST:
-        if (len == 0) {
-            rc = ble_ll_resolv_list_clr();
-        }
-        break;
-    case BLE_HCI_OCF_LE_RD_RESOLV_LIST_SIZE:
-        if (len == 0) {
-            rc = ble_ll_resolv_list_read_size(rspbuf, rsplen);
-        }
-        break;
-    case BLE_HCI_OCF_LE_RD_PEER_RESOLV_ADDR:
-        rc = ble_ll_resolv_peer_addr_rd(cmdbuf, len, rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_RD_LOCAL_RESOLV_ADDR:
-        rc = ble_ll_resolv_local_addr_rd(cmdbuf, len, rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_SET_ADDR_RES_EN:
-        rc = ble_ll_resolv_enable_cmd(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_SET_RPA_TMO:
-        rc = ble_ll_resolv_set_rpa_tmo(cmdbuf, len);
-        break;
-#endif
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_DATA_LEN_EXT)
-    case BLE_HCI_OCF_LE_RD_MAX_DATA_LEN:
-        if (len == 0) {
-            rc = ble_ll_hci_le_rd_max_data_len(rspbuf, rsplen);
-        }
-        break;
-#endif
-#if (BLE_LL_BT5_PHY_SUPPORTED == 1)
-    case BLE_HCI_OCF_LE_RD_PHY:
-        rc = ble_ll_conn_hci_le_rd_phy(cmdbuf, len, rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_SET_DEFAULT_PHY:
-        rc = ble_ll_hci_le_set_def_phy(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_SET_PHY:
-        rc = ble_ll_conn_hci_le_set_phy(cmdbuf, len);
-        break;
-#endif
-#if MYNEWT_VAL(BLE_LL_DTM)
-    case BLE_HCI_OCF_LE_RX_TEST_V2:
-        rc = ble_ll_hci_dtm_rx_test_v2(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_TX_TEST_V2:
-        rc = ble_ll_hci_dtm_tx_test_v2(cmdbuf, len);
-        break;
-#endif
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
-    case BLE_HCI_OCF_LE_SET_ADV_SET_RND_ADDR:
-        rc = ble_ll_adv_hci_set_random_addr(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_SET_EXT_ADV_PARAM:
-        rc = ble_ll_adv_ext_set_param(cmdbuf, len, rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_SET_EXT_ADV_DATA:
-        rc = ble_ll_adv_ext_set_adv_data(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_SET_EXT_SCAN_RSP_DATA:
-        rc = ble_ll_adv_ext_set_scan_rsp(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_SET_EXT_ADV_ENABLE:
-        rc =  ble_ll_adv_ext_set_enable(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_RD_MAX_ADV_DATA_LEN:
-        if (len == 0) {
-            rc = ble_ll_adv_rd_max_adv_data_len(rspbuf, rsplen);
-        }
-        break;
-    case BLE_HCI_OCF_LE_RD_NUM_OF_ADV_SETS:
-        if (len == 0) {
-            rc = ble_ll_adv_rd_sup_adv_sets(rspbuf, rsplen);
-        }
-        break;
-    case BLE_HCI_OCF_LE_REMOVE_ADV_SET:
-        rc =  ble_ll_adv_remove(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_CLEAR_ADV_SETS:
-        if (len == 0) {
-            rc =  ble_ll_adv_clear_all();
-        }
-        break;
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PERIODIC_ADV)
-    case BLE_HCI_OCF_LE_SET_PERIODIC_ADV_PARAMS:
-        rc = ble_ll_adv_periodic_set_param(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_SET_PERIODIC_ADV_DATA:
-        rc = ble_ll_adv_periodic_set_data(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_SET_PERIODIC_ADV_ENABLE:
-        rc = ble_ll_adv_periodic_enable(cmdbuf, len);
-        break;
-#endif
-#endif
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
-    case BLE_HCI_OCF_LE_SET_EXT_SCAN_PARAM:
-        rc = ble_ll_set_ext_scan_params(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_SET_EXT_SCAN_ENABLE:
-        rc = ble_ll_hci_ext_scan_set_enable(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_EXT_CREATE_CONN:
-        rc = ble_ll_ext_conn_create(cmdbuf, len);
-        break;
-#endif
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PERIODIC_ADV)
-    case BLE_HCI_OCF_LE_PERIODIC_ADV_CREATE_SYNC:
-        rc = ble_ll_sync_create(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_PERIODIC_ADV_CREATE_SYNC_CANCEL:
-        if (len == 0) {
-            rc = ble_ll_sync_cancel(cb);
-        }
-        break;
-    case BLE_HCI_OCF_LE_PERIODIC_ADV_TERM_SYNC:
-        rc = ble_ll_sync_terminate(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_ADD_DEV_TO_PERIODIC_ADV_LIST:
-        rc = ble_ll_sync_list_add(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_REM_DEV_FROM_PERIODIC_ADV_LIST:
-        rc = ble_ll_sync_list_remove(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_CLEAR_PERIODIC_ADV_LIST:
-        if (len == 0) {
-            rc = ble_ll_sync_list_clear();
-        }
-        break;
-    case BLE_HCI_OCF_LE_RD_PERIODIC_ADV_LIST_SIZE:
-        if (len == 0) {
-            rc = ble_ll_sync_list_size(rspbuf, rsplen);
-        }
-        break;
-#if MYNEWT_VAL(BLE_VERSION) >= 51
-    case BLE_HCI_OCF_LE_PERIODIC_ADV_RECEIVE_ENABLE:
-        rc = ble_ll_sync_receive_enable(cmdbuf, len);
-        break;
-#endif
-#endif
-    case BLE_HCI_OCF_LE_RD_TRANSMIT_POWER:
-        rc = ble_ll_read_tx_power(rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_RD_RF_PATH_COMPENSATION:
-        rc = ble_ll_read_rf_path_compensation(rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_WR_RF_PATH_COMPENSATION:
-        rc = ble_ll_write_rf_path_compensation(cmdbuf, len);
-        break;
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PRIVACY)
-    case BLE_HCI_OCF_LE_SET_PRIVACY_MODE:
-        rc = ble_ll_resolve_set_priv_mode(cmdbuf, len);
-        break;
-#endif
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PERIODIC_ADV_SYNC_TRANSFER)
-    case BLE_HCI_OCF_LE_PERIODIC_ADV_SYNC_TRANSFER:
-        rc = ble_ll_sync_transfer(cmdbuf, len, rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_PERIODIC_ADV_SET_INFO_TRANSFER:
-        rc = ble_ll_adv_periodic_set_info_transfer(cmdbuf, len, rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_PERIODIC_ADV_SYNC_TRANSFER_PARAMS:
-        rc = ble_ll_set_sync_transfer_params(cmdbuf, len, rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_SET_DEFAULT_SYNC_TRANSFER_PARAMS:
-        rc = ble_ll_set_default_sync_transfer_params(cmdbuf, len);
-        break;
-#endif
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_ISO)
-    case BLE_HCI_OCF_LE_READ_ISO_TX_SYNC:
-        rc = ble_ll_iso_read_tx_sync(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_SET_CIG_PARAM:
-        rc = ble_ll_iso_set_cig_param(cmdbuf, len, rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_CREATE_CIS:
-        rc = ble_ll_iso_create_cis(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_REMOVE_CIG:
-        rc = ble_ll_iso_remove_cig(cmdbuf, len, rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_ACCEPT_CIS_REQ:
-        rc = ble_ll_iso_accept_cis_req(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_REJECT_CIS_REQ:
-        rc = ble_ll_iso_reject_cis_req(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_CREATE_BIG:
-        rc = ble_ll_iso_create_big(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_TERMINATE_BIG:
-        rc = ble_ll_iso_terminate_big(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_BIG_CREATE_SYNC:
-        rc = ble_ll_iso_big_create_sync(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_BIG_TERMINATE_SYNC:
-        rc = ble_ll_iso_big_terminate_sync(cmdbuf,len);
-        break;
-    case BLE_HCI_OCF_LE_SETUP_ISO_DATA_PATH:
-        rc = ble_ll_iso_setup_iso_data_path(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_REMOVE_ISO_DATA_PATH:
-        rc = ble_ll_iso_remove_iso_data_path(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_RD_BUF_SIZE_V2:
-        rc = ble_ll_hci_le_read_bufsize_v2(rspbuf, rsplen);
-        break;
-#endif
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_ISO_TEST)
-    case BLE_HCI_OCF_LE_SET_CIG_PARAM_TEST:
-        rc = ble_ll_iso_set_cig_param_test(cmdbuf, len, rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_LE_CREATE_BIG_TEST:
-        rc = ble_ll_iso_create_big_test(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_ISO_TRANSMIT_TEST:
-        rc = ble_ll_iso_transmit_test(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_ISO_RECEIVE_TEST:
-        rc = ble_ll_iso_receive_test(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_ISO_READ_TEST_COUNTERS:
-        rc = ble_ll_iso_read_counters_test(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_LE_ISO_TEST_END:
-        rc = ble_ll_iso_end_test(cmdbuf, len);
-        break;
-#endif
-#if MYNEWT_VAL(BLE_VERSION) >= 52
-    case BLE_HCI_OCF_LE_SET_HOST_FEAT:
-        rc = ble_ll_set_host_feat(cmdbuf, len);
-        break;
-#endif
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_SCA_UPDATE)
-    case BLE_HCI_OCF_LE_REQ_PEER_SCA:
-        rc = ble_ll_conn_req_peer_sca(cmdbuf, len,
-                                      rspbuf, rsplen);
-        break;
-#endif
-    default:
-        rc = BLE_ERR_UNKNOWN_HCI_CMD;
-        break;
-    }
-
-    /*
-     * This code is here because we add 256 to the return code to denote
-     * that the reply to this command should be command status (as opposed to
-     * command complete).
-     *
-     * For unknown HCI command let us return always command status as per
-     * specification Bluetooth 5, Vol. 2, Chapter 4.4
-     */
-    if (ble_ll_hci_le_cmd_send_cmd_status(ocf) || rc == BLE_ERR_UNKNOWN_HCI_CMD) {
-        rc += (BLE_ERR_MAX + 1);
-    }
-
-    return rc;
-}
-
 static int
 ble_ll_hci_disconnect(const uint8_t *cmdbuf, uint8_t len)
 {
@@ -1290,45 +738,6 @@ ble_ll_hci_disconnect(const uint8_t *cmdbuf, uint8_t len)
     return ble_ll_conn_hci_disconnect_cmd(cmd);
 }
 
-/**
- * Process a link control command sent from the host to the controller. The HCI
- * command has a 3 byte command header followed by data. The header is:
- *  -> opcode (2 bytes)
- *  -> Length of parameters (1 byte; does include command header bytes).
- *
- * @param cmdbuf Pointer to command buffer. Points to start of command header.
- * @param ocf    Opcode command field.
- *
- * @return int  This function returns a BLE error code. If a command status
- *              event should be returned as opposed to command complete,
- *              256 gets added to the return value.
- */
-static int
-ble_ll_hci_link_ctrl_cmd_proc(const uint8_t *cmdbuf, uint8_t len, uint16_t ocf)
-{
-    int rc;
-
-    switch (ocf) {
-    case BLE_HCI_OCF_DISCONNECT_CMD:
-        rc = ble_ll_hci_disconnect(cmdbuf, len);
-        /* Send command status instead of command complete */
-        rc += (BLE_ERR_MAX + 1);
-        break;
-
-    case BLE_HCI_OCF_RD_REM_VER_INFO:
-        rc = ble_ll_conn_hci_rd_rem_ver_cmd(cmdbuf, len);
-        /* Send command status instead of command complete */
-        rc += (BLE_ERR_MAX + 1);
-        break;
-
-    default:
-        rc = BLE_ERR_UNKNOWN_HCI_CMD;
-        break;
-    }
-
-    return rc;
-}
-
 static int
 ble_ll_hci_cb_set_event_mask(const uint8_t *cmdbuf, uint8_t len)
 {
@@ -1415,111 +824,579 @@ ble_ll_hci_cb_set_event_mask2(const uint8_t *cmdbuf, uint8_t len)
     return BLE_ERR_SUCCESS;
 }
 
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_CTRL_TO_HOST_FLOW_CONTROL)
 static int
-ble_ll_hci_ctlr_bb_cmd_proc(const uint8_t *cmdbuf, uint8_t len, uint16_t ocf,
-                            uint8_t *rspbuf, uint8_t *rsplen)
+ble_ll_hci_cb_host_num_comp_pkts(const uint8_t *cmdbuf, uint8_t len)
 {
-    int rc;
+    /*
+     * HCI_Host_Number_Of_Completed_Packets is handled immediately when
+     * received from transport so we should never receive it here.
+     */
+    BLE_LL_ASSERT(0);
+    return BLE_ERR_UNKNOWN_HCI_CMD;
+}
+#endif
 
-    /* Assume error; if all pass rc gets set to 0 */
-    rc = BLE_ERR_INV_HCI_CMD_PARMS;
+static int
+ble_ll_hci_le_set_rand_addr(const uint8_t *cmdbuf, uint8_t len)
+{
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
+    return ble_ll_set_random_addr(cmdbuf, len, hci_adv_mode == ADV_MODE_EXT);
+#else
+    return ble_ll_set_random_addr(cmdbuf, len, false);
+#endif
+}
 
-    switch (ocf) {
-    case BLE_HCI_OCF_CB_SET_EVENT_MASK:
-        rc = ble_ll_hci_cb_set_event_mask(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_CB_RESET:
-        if (len == 0) {
-            rc = ble_ll_reset();
-        }
-        break;
+#define BLE_LL_HCI_CP(_fn, _plen, _flags, _supp)                            \
+    { .cp = (_fn), .type = BLE_LL_HCI_CMD_T_CP, .plen = (_plen),            \
+      .flags = (_flags), .supp = (_supp) }
+#define BLE_LL_HCI_RP(_fn, _flags, _supp)                                   \
+    { .rp = (_fn), .type = BLE_LL_HCI_CMD_T_RP, .plen = 0,                  \
+      .flags = (_flags), .supp = (_supp) }
+#define BLE_LL_HCI_CP_RP(_fn, _plen, _flags, _supp)                         \
+    { .cp_rp = (_fn), .type = BLE_LL_HCI_CMD_T_CP_RP, .plen = (_plen),      \
+      .flags = (_flags), .supp = (_supp) }
+#define BLE_LL_HCI_VOID(_fn, _flags, _supp)                                 \
+    { .v = (_fn), .type = BLE_LL_HCI_CMD_T_VOID, .plen = 0,                 \
+      .flags = (_flags), .supp = (_supp) }
+#define BLE_LL_HCI_CB(_fn, _flags, _supp)                                   \
+    { .cb = (_fn), .type = BLE_LL_HCI_CMD_T_CB, .plen = 0,                  \
+      .flags = (_flags), .supp = (_supp) }
+
+#define CP_LEN(_cp)     sizeof(struct _cp)
+#define ANY             BLE_LL_HCI_CMD_PLEN_ANY
+#define STATUS          BLE_LL_HCI_CMD_F_STATUS
+#define LEGACY          BLE_LL_HCI_CMD_F_ADV_LEGACY
+#define EXT             BLE_LL_HCI_CMD_F_ADV_EXT
+#define SUPP            BLE_LL_HCI_SUPP
+
+static const struct ble_ll_hci_cmd g_ble_ll_hci_link_ctrl_cmds[] = {
+    [BLE_HCI_OCF_DISCONNECT_CMD] =
+        BLE_LL_HCI_CP(ble_ll_hci_disconnect,
+                      CP_LEN(ble_hci_lc_disconnect_cp), STATUS, SUPP(0, 5)),
+    [BLE_HCI_OCF_RD_REM_VER_INFO] =
+        BLE_LL_HCI_CP(ble_ll_conn_hci_rd_rem_ver_cmd,
+                      CP_LEN(ble_hci_rd_rem_ver_info_cp), STATUS, SUPP(2, 7)),
+};
+
+static const struct ble_ll_hci_cmd g_ble_ll_hci_ctlr_bb_cmds[] = {
+    [BLE_HCI_OCF_CB_SET_EVENT_MASK] =
+        BLE_LL_HCI_CP(ble_ll_hci_cb_set_event_mask,
+                      CP_LEN(ble_hci_cb_set_event_mask_cp), 0, SUPP(5, 6)),
+    [BLE_HCI_OCF_CB_RESET] =
+        BLE_LL_HCI_VOID(ble_ll_reset, 0, SUPP(5, 7)),
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_CTRL_TO_HOST_FLOW_CONTROL)
-    case BLE_HCI_OCF_CB_SET_CTLR_TO_HOST_FC:
-        rc = ble_ll_hci_cb_set_ctrlr_to_host_fc(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_CB_HOST_BUF_SIZE:
-        rc = ble_ll_hci_cb_host_buf_size(cmdbuf, len);
-        break;
-    case BLE_HCI_OCF_CB_HOST_NUM_COMP_PKTS:
-        /*
-         * HCI_Host_Number_Of_Completed_Packets is handled immediately when
-         * received from transport so we should never receive it here.
-         */
-        BLE_LL_ASSERT(0);
-        rc = BLE_ERR_UNKNOWN_HCI_CMD;
-        break;
+    [BLE_HCI_OCF_CB_SET_CTLR_TO_HOST_FC] =
+        BLE_LL_HCI_CP(ble_ll_hci_cb_set_ctrlr_to_host_fc,
+                      CP_LEN(ble_hci_cb_ctlr_to_host_fc_cp), 0, SUPP(10, 5)),
+    [BLE_HCI_OCF_CB_HOST_BUF_SIZE] =
+        BLE_LL_HCI_CP(ble_ll_hci_cb_host_buf_size,
+                      CP_LEN(ble_hci_cb_host_buf_size_cp), 0, SUPP(10, 6)),
+    [BLE_HCI_OCF_CB_HOST_NUM_COMP_PKTS] =
+        BLE_LL_HCI_CP(ble_ll_hci_cb_host_num_comp_pkts, ANY, 0, SUPP(10, 7)),
 #endif
-    case BLE_HCI_OCF_CB_SET_EVENT_MASK2:
-        rc = ble_ll_hci_cb_set_event_mask2(cmdbuf, len);
-        break;
+    [BLE_HCI_OCF_CB_SET_EVENT_MASK2] =
+        BLE_LL_HCI_CP(ble_ll_hci_cb_set_event_mask2,
+                      CP_LEN(ble_hci_cb_set_event_mask2_cp), 0, SUPP(22, 2)),
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_PING)
-    case BLE_HCI_OCF_CB_RD_AUTH_PYLD_TMO:
-        rc = ble_ll_conn_hci_rd_auth_pyld_tmo(cmdbuf, len, rspbuf, rsplen);
-        break;
-    case BLE_HCI_OCF_CB_WR_AUTH_PYLD_TMO:
-        rc = ble_ll_conn_hci_wr_auth_pyld_tmo(cmdbuf, len, rspbuf, rsplen);
-        break;
+    [BLE_HCI_OCF_CB_RD_AUTH_PYLD_TMO] =
+        BLE_LL_HCI_CP_RP(ble_ll_conn_hci_rd_auth_pyld_tmo,
+                         CP_LEN(ble_hci_cb_rd_auth_pyld_tmo_cp), 0,
+                         SUPP(32, 4)),
+    [BLE_HCI_OCF_CB_WR_AUTH_PYLD_TMO] =
+        BLE_LL_HCI_CP_RP(ble_ll_conn_hci_wr_auth_pyld_tmo,
+                         CP_LEN(ble_hci_cb_wr_auth_pyld_tmo_cp), 0,
+                         SUPP(32, 5)),
 #endif
-    default:
-        rc = BLE_ERR_UNKNOWN_HCI_CMD;
-        break;
+};
+
+static const struct ble_ll_hci_cmd g_ble_ll_hci_info_params_cmds[] = {
+    [BLE_HCI_OCF_IP_RD_LOCAL_VER] =
+        BLE_LL_HCI_RP(ble_ll_hci_rd_local_version, 0, SUPP(14, 3)),
+    [BLE_HCI_OCF_IP_RD_LOC_SUPP_CMD] =
+        BLE_LL_HCI_RP(ble_ll_hci_rd_local_supp_cmd, 0, BLE_LL_HCI_SUPP_NONE),
+    [BLE_HCI_OCF_IP_RD_LOC_SUPP_FEAT] =
+        BLE_LL_HCI_RP(ble_ll_hci_rd_local_supp_feat, 0, SUPP(14, 5)),
+    [BLE_HCI_OCF_IP_RD_BD_ADDR] =
+        BLE_LL_HCI_RP(ble_ll_hci_rd_bd_addr, 0, SUPP(15, 1)),
+};
+
+static const struct ble_ll_hci_cmd g_ble_ll_hci_status_params_cmds[] = {
+    [BLE_HCI_OCF_RD_RSSI] =
+        BLE_LL_HCI_CP_RP(ble_ll_conn_hci_rd_rssi, CP_LEN(ble_hci_rd_rssi_cp),
+                         0, SUPP(15, 5)),
+};
+
+static const struct ble_ll_hci_cmd g_ble_ll_hci_le_cmds[] = {
+    [BLE_HCI_OCF_LE_SET_EVENT_MASK] =
+        BLE_LL_HCI_CP(ble_ll_hci_set_le_event_mask,
+                      CP_LEN(ble_hci_le_set_event_mask_cp), 0, SUPP(25, 0)),
+    [BLE_HCI_OCF_LE_RD_BUF_SIZE] =
+        BLE_LL_HCI_RP(ble_ll_hci_le_read_bufsize, 0, SUPP(25, 1)),
+    [BLE_HCI_OCF_LE_RD_LOC_SUPP_FEAT] =
+        BLE_LL_HCI_RP(ble_ll_hci_le_read_local_features, 0, SUPP(25, 2)),
+    [BLE_HCI_OCF_LE_SET_RAND_ADDR] =
+        BLE_LL_HCI_CP(ble_ll_hci_le_set_rand_addr, ANY, 0, SUPP(25, 4)),
+    [BLE_HCI_OCF_LE_SET_ADV_PARAMS] =
+        BLE_LL_HCI_CP(ble_ll_adv_set_adv_params,
+                      CP_LEN(ble_hci_le_set_adv_params_cp), LEGACY,
+                      SUPP(25, 5)),
+    [BLE_HCI_OCF_LE_RD_ADV_CHAN_TXPWR] =
+        BLE_LL_HCI_RP(ble_ll_adv_read_txpwr, LEGACY, SUPP(25, 6)),
+    [BLE_HCI_OCF_LE_SET_ADV_DATA] =
+        BLE_LL_HCI_CP(ble_ll_hci_set_adv_data,
+                      CP_LEN(ble_hci_le_set_adv_data_cp), LEGACY, SUPP(25, 7)),
+    [BLE_HCI_OCF_LE_SET_SCAN_RSP_DATA] =
+        BLE_LL_HCI_CP(ble_ll_hci_set_scan_rsp_data,
+                      CP_LEN(ble_hci_le_set_scan_rsp_data_cp), LEGACY,
+                      SUPP(26, 0)),
+    [BLE_HCI_OCF_LE_SET_ADV_ENABLE] =
+        BLE_LL_HCI_CP(ble_ll_hci_adv_set_enable,
+                      CP_LEN(ble_hci_le_set_adv_enable_cp), LEGACY,
+                      SUPP(26, 1)),
+    [BLE_HCI_OCF_LE_SET_SCAN_PARAMS] =
+        BLE_LL_HCI_CP(ble_ll_scan_set_scan_params,
+                      CP_LEN(ble_hci_le_set_scan_params_cp), LEGACY,
+                      SUPP(26, 2)),
+    [BLE_HCI_OCF_LE_SET_SCAN_ENABLE] =
+        BLE_LL_HCI_CP(ble_ll_hci_scan_set_enable,
+                      CP_LEN(ble_hci_le_set_scan_enable_cp), LEGACY,
+                      SUPP(26, 3)),
+    [BLE_HCI_OCF_LE_CREATE_CONN] =
+        BLE_LL_HCI_CP(ble_ll_conn_create, ANY, STATUS | LEGACY, SUPP(26, 4)),
+    [BLE_HCI_OCF_LE_CREATE_CONN_CANCEL] =
+        BLE_LL_HCI_CB(ble_ll_conn_create_cancel, 0, SUPP(26, 5)),
+    [BLE_HCI_OCF_LE_RD_WHITE_LIST_SIZE] =
+        BLE_LL_HCI_RP(ble_ll_whitelist_read_size, 0, SUPP(26, 6)),
+    [BLE_HCI_OCF_LE_CLEAR_WHITE_LIST] =
+        BLE_LL_HCI_VOID(ble_ll_whitelist_clear, 0, SUPP(26, 7)),
+    [BLE_HCI_OCF_LE_ADD_WHITE_LIST] =
+        BLE_LL_HCI_CP(ble_ll_whitelist_add, CP_LEN(ble_hci_le_add_whte_list_cp),
+                      0, SUPP(27, 0)),
+    [BLE_HCI_OCF_LE_RMV_WHITE_LIST] =
+        BLE_LL_HCI_CP(ble_ll_whitelist_rmv,
+                      CP_LEN(ble_hci_le_rmv_white_list_cp), 0, SUPP(27, 1)),
+    [BLE_HCI_OCF_LE_CONN_UPDATE] =
+        BLE_LL_HCI_CP(ble_ll_conn_hci_update, ANY, STATUS, SUPP(27, 2)),
+    [BLE_HCI_OCF_LE_SET_HOST_CHAN_CLASS] =
+        BLE_LL_HCI_CP(ble_ll_conn_hci_set_chan_class,
+                      CP_LEN(ble_hci_le_set_host_chan_class_cp), 0,
+                      SUPP(27, 3)),
+    [BLE_HCI_OCF_LE_RD_CHAN_MAP] =
+        BLE_LL_HCI_CP_RP(ble_ll_conn_hci_rd_chan_map,
+                         CP_LEN(ble_hci_le_rd_chan_map_cp), 0, SUPP(27, 4)),
+    [BLE_HCI_OCF_LE_RD_REM_FEAT] =
+        BLE_LL_HCI_CP(ble_ll_conn_hci_read_rem_features,
+                      CP_LEN(ble_hci_le_rd_rem_feat_cp), STATUS, SUPP(27, 5)),
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_ENCRYPTION)
+    [BLE_HCI_OCF_LE_ENCRYPT] =
+        BLE_LL_HCI_CP_RP(ble_ll_hci_le_encrypt, ANY, 0, SUPP(27, 6)),
+#endif
+    [BLE_HCI_OCF_LE_RAND] =
+        BLE_LL_HCI_RP(ble_ll_hci_le_rand, 0, SUPP(27, 7)),
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_ENCRYPTION)
+    [BLE_HCI_OCF_LE_START_ENCRYPT] =
+        BLE_LL_HCI_CP(ble_ll_conn_hci_le_start_encrypt,
+                      CP_LEN(ble_hci_le_start_encrypt_cp), STATUS,
+                      SUPP(28, 0)),
+    [BLE_HCI_OCF_LE_LT_KEY_REQ_REPLY] =
+        BLE_LL_HCI_CP_RP(ble_ll_conn_hci_le_ltk_reply,
+                         CP_LEN(ble_hci_le_lt_key_req_reply_cp), 0,
+                         SUPP(28, 1)),
+    [BLE_HCI_OCF_LE_LT_KEY_REQ_NEG_REPLY] =
+        BLE_LL_HCI_CP_RP(ble_ll_conn_hci_le_ltk_neg_reply,
+                         CP_LEN(ble_hci_le_lt_key_req_neg_reply_cp), 0,
+                         SUPP(28, 2)),
+#endif
+    [BLE_HCI_OCF_LE_RD_SUPP_STATES] =
+        BLE_LL_HCI_RP(ble_ll_hci_le_read_supp_states, 0, SUPP(28, 3)),
+#if MYNEWT_VAL(BLE_LL_DTM)
+    [BLE_HCI_OCF_LE_RX_TEST] =
+        BLE_LL_HCI_CP(ble_ll_hci_dtm_rx_test, CP_LEN(ble_hci_le_rx_test_cp),
+                      0, SUPP(28, 4)),
+    [BLE_HCI_OCF_LE_TX_TEST] =
+        BLE_LL_HCI_CP(ble_ll_hci_dtm_tx_test, CP_LEN(ble_hci_le_tx_test_cp),
+                      0, SUPP(28, 5)),
+    [BLE_HCI_OCF_LE_TEST_END] =
+        BLE_LL_HCI_RP(ble_ll_dtm_end_test, 0, SUPP(28, 6)),
+#endif
+    [BLE_HCI_OCF_LE_REM_CONN_PARAM_RR] =
+        BLE_LL_HCI_CP_RP(ble_ll_conn_hci_param_rr,
+                         CP_LEN(ble_hci_le_rem_conn_param_rr_cp), 0,
+                         SUPP(33, 4)),
+    [BLE_HCI_OCF_LE_REM_CONN_PARAM_NRR] =
+        BLE_LL_HCI_CP_RP(ble_ll_conn_hci_param_nrr,
+                         CP_LEN(ble_hci_le_rem_conn_params_nrr_cp), 0,
+                         SUPP(33, 5)),
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_DATA_LEN_EXT)
+    [BLE_HCI_OCF_LE_SET_DATA_LEN] =
+        BLE_LL_HCI_CP_RP(ble_ll_conn_hci_set_data_len,
+                         CP_LEN(ble_hci_le_set_data_len_cp), 0, SUPP(33, 6)),
+    [BLE_HCI_OCF_LE_RD_SUGG_DEF_DATA_LEN] =
+        BLE_LL_HCI_RP(ble_ll_hci_le_rd_sugg_data_len, 0, SUPP(33, 7)),
+    [BLE_HCI_OCF_LE_WR_SUGG_DEF_DATA_LEN] =
+        BLE_LL_HCI_CP(ble_ll_hci_le_wr_sugg_data_len,
+                      CP_LEN(ble_hci_le_wr_sugg_def_data_len_cp), 0,
+                      SUPP(34, 0)),
+#endif
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PRIVACY)
+    [BLE_HCI_OCF_LE_ADD_RESOLV_LIST] =
+        BLE_LL_HCI_CP(ble_ll_resolv_list_add,
+                      CP_LEN(ble_hci_le_add_resolv_list_cp), 0, SUPP(34, 3)),
+    [BLE_HCI_OCF_LE_RMV_RESOLV_LIST] =
+        BLE_LL_HCI_CP(ble_ll_resolv_list_rmv,
+                      CP_LEN(ble_hci_le_rmv_resolve_list_cp), 0, SUPP(34, 4)),
+    [BLE_HCI_OCF_LE_CLR_RESOLV_LIST] =
+        BLE_LL_HCI_VOID(ble_ll_resolv_list_clr, 0, SUPP(34, 5)),
+    [BLE_HCI_OCF_LE_RD_RESOLV_LIST_SIZE] =
+        BLE_LL_HCI_RP(ble_ll_resolv_list_read_size, 0, SUPP(34, 6)),
+    [BLE_HCI_OCF_LE_RD_PEER_RESOLV_ADDR] =
+        BLE_LL_HCI_CP_RP(ble_ll_resolv_peer_addr_rd,
+                         CP_LEN(ble_hci_le_rd_peer_recolv_addr_cp), 0,
+                         SUPP(34, 7)),
+    [BLE_HCI_OCF_LE_RD_LOCAL_RESOLV_ADDR] =
+        BLE_LL_HCI_CP_RP(ble_ll_resolv_local_addr_rd,
+                         CP_LEN(ble_hci_le_rd_local_recolv_addr_cp), 0,
+                         SUPP(35, 0)),
+    [BLE_HCI_OCF_LE_SET_ADDR_RES_EN] =
+        BLE_LL_HCI_CP(ble_ll_resolv_enable_cmd,
+                      CP_LEN(ble_hci_le_set_addr_res_en_cp), 0, SUPP(35, 1)),
+    [BLE_HCI_OCF_LE_SET_RPA_TMO] =
+        BLE_LL_HCI_CP(ble_ll_resolv_set_rpa_tmo,
+                      CP_LEN(ble_hci_le_set_rpa_tmo_cp), 0, SUPP(35, 2)),
+#endif
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_DATA_LEN_EXT)
+    [BLE_HCI_OCF_LE_RD_MAX_DATA_LEN] =
+        BLE_LL_HCI_RP(ble_ll_hci_le_rd_max_data_len, 0, SUPP(35, 3)),
+#endif
+#if (BLE_LL_BT5_PHY_SUPPORTED == 1)
+    [BLE_HCI_OCF_LE_RD_PHY] =
+        BLE_LL_HCI_CP_RP(ble_ll_conn_hci_le_rd_phy,
+                         CP_LEN(ble_hci_le_rd_phy_cp), 0, SUPP(35, 4)),
+    [BLE_HCI_OCF_LE_SET_DEFAULT_PHY] =
+        BLE_LL_HCI_CP(ble_ll_hci_le_set_def_phy,
+                      CP_LEN(ble_hci_le_set_default_phy_cp), 0, SUPP(35, 5)),
+    [BLE_HCI_OCF_LE_SET_PHY] =
+        BLE_LL_HCI_CP(ble_ll_conn_hci_le_set_phy,
+                      CP_LEN(ble_hci_le_set_phy_cp), STATUS, SUPP(35, 6)),
+#endif
+#if MYNEWT_VAL(BLE_LL_DTM)
+    [BLE_HCI_OCF_LE_RX_TEST_V2] =
+        BLE_LL_HCI_CP(ble_ll_hci_dtm_rx_test_v2,
+                      CP_LEN(ble_hci_le_rx_test_v2_cp), 0, SUPP(35, 7)),
+    [BLE_HCI_OCF_LE_TX_TEST_V2] =
+        BLE_LL_HCI_CP(ble_ll_hci_dtm_tx_test_v2,
+                      CP_LEN(ble_hci_le_tx_test_v2_cp), 0, SUPP(36, 0)),
+#endif
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
+    [BLE_HCI_OCF_LE_SET_ADV_SET_RND_ADDR] =
+        BLE_LL_HCI_CP(ble_ll_adv_hci_set_random_addr,
+                      CP_LEN(ble_hci_le_set_adv_set_rnd_addr_cp), 0,
+                      SUPP(36, 1)),
+    [BLE_HCI_OCF_LE_SET_EXT_ADV_PARAM] =
+        BLE_LL_HCI_CP_RP(ble_ll_adv_ext_set_param, ANY, EXT, SUPP(36, 2)),
+    [BLE_HCI_OCF_LE_SET_EXT_ADV_DATA] =
+        BLE_LL_HCI_CP(ble_ll_adv_ext_set_adv_data, ANY, EXT, SUPP(36, 3)),
+    [BLE_HCI_OCF_LE_SET_EXT_SCAN_RSP_DATA] =
+        BLE_LL_HCI_CP(ble_ll_adv_ext_set_scan_rsp, ANY, EXT, SUPP(36, 4)),
+    [BLE_HCI_OCF_LE_SET_EXT_ADV_ENABLE] =
+        BLE_LL_HCI_CP(ble_ll_adv_ext_set_enable, ANY, EXT, SUPP(36, 5)),
+    [BLE_HCI_OCF_LE_RD_MAX_ADV_DATA_LEN] =
+        BLE_LL_HCI_RP(ble_ll_adv_rd_max_adv_data_len, EXT, SUPP(36, 6)),
+    [BLE_HCI_OCF_LE_RD_NUM_OF_ADV_SETS] =
+        BLE_LL_HCI_RP(ble_ll_adv_rd_sup_adv_sets, EXT, SUPP(36, 7)),
+    [BLE_HCI_OCF_LE_REMOVE_ADV_SET] =
+        BLE_LL_HCI_CP(ble_ll_adv_remove, CP_LEN(ble_hci_le_remove_adv_set_cp),
+                      EXT, SUPP(37, 0)),
+    [BLE_HCI_OCF_LE_CLEAR_ADV_SETS] =
+        BLE_LL_HCI_VOID(ble_ll_adv_clear_all, EXT, SUPP(37, 1)),
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PERIODIC_ADV)
+    [BLE_HCI_OCF_LE_SET_PERIODIC_ADV_PARAMS] =
+        BLE_LL_HCI_CP(ble_ll_adv_periodic_set_param,
+                      CP_LEN(ble_hci_le_set_periodic_adv_params_cp), EXT,
+                      SUPP(37, 2)),
+    [BLE_HCI_OCF_LE_SET_PERIODIC_ADV_DATA] =
+        BLE_LL_HCI_CP(ble_ll_adv_periodic_set_data, ANY, EXT, SUPP(37, 3)),
+    [BLE_HCI_OCF_LE_SET_PERIODIC_ADV_ENABLE] =
+        BLE_LL_HCI_CP(ble_ll_adv_periodic_enable,
+                      CP_LEN(ble_hci_le_set_periodic_adv_enable_cp), EXT,
+                      SUPP(37, 4)),
+#endif
+    [BLE_HCI_OCF_LE_SET_EXT_SCAN_PARAM] =
+        BLE_LL_HCI_CP(ble_ll_set_ext_scan_params, ANY, EXT, SUPP(37, 5)),
+    [BLE_HCI_OCF_LE_SET_EXT_SCAN_ENABLE] =
+        BLE_LL_HCI_CP(ble_ll_hci_ext_scan_set_enable,
+                      CP_LEN(ble_hci_le_set_ext_scan_enable_cp), EXT,
+                      SUPP(37, 6)),
+    [BLE_HCI_OCF_LE_EXT_CREATE_CONN] =
+        BLE_LL_HCI_CP(ble_ll_ext_conn_create, ANY, STATUS | EXT, SUPP(37, 7)),
+#endif
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PERIODIC_ADV)
+    [BLE_HCI_OCF_LE_PERIODIC_ADV_CREATE_SYNC] =
+        BLE_LL_HCI_CP(ble_ll_sync_create,
+                      CP_LEN(ble_hci_le_periodic_adv_create_sync_cp),
+                      STATUS | EXT, SUPP(38, 0)),
+    [BLE_HCI_OCF_LE_PERIODIC_ADV_CREATE_SYNC_CANCEL] =
+        BLE_LL_HCI_CB(ble_ll_sync_cancel, EXT, SUPP(38, 1)),
+    [BLE_HCI_OCF_LE_PERIODIC_ADV_TERM_SYNC] =
+        BLE_LL_HCI_CP(ble_ll_sync_terminate,
+                      CP_LEN(ble_hci_le_periodic_adv_term_sync_cp), EXT,
+                      SUPP(38, 2)),
+    [BLE_HCI_OCF_LE_ADD_DEV_TO_PERIODIC_ADV_LIST] =
+        BLE_LL_HCI_CP(ble_ll_sync_list_add,
+                      CP_LEN(ble_hci_le_add_dev_to_periodic_adv_list_cp), EXT,
+                      SUPP(38, 3)),
+    [BLE_HCI_OCF_LE_REM_DEV_FROM_PERIODIC_ADV_LIST] =
+        BLE_LL_HCI_CP(ble_ll_sync_list_remove,
+                      CP_LEN(ble_hci_le_rem_dev_from_periodic_adv_list_cp),
+                      EXT, SUPP(38, 4)),
+    [BLE_HCI_OCF_LE_CLEAR_PERIODIC_ADV_LIST] =
+        BLE_LL_HCI_VOID(ble_ll_sync_list_clear, EXT, SUPP(38, 5)),
+    [BLE_HCI_OCF_LE_RD_PERIODIC_ADV_LIST_SIZE] =
+        BLE_LL_HCI_RP(ble_ll_sync_list_size, EXT, SUPP(38, 6)),
+#endif
+    [BLE_HCI_OCF_LE_RD_TRANSMIT_POWER] =
+        BLE_LL_HCI_RP(ble_ll_read_tx_power, 0, SUPP(38, 7)),
+    [BLE_HCI_OCF_LE_RD_RF_PATH_COMPENSATION] =
+        BLE_LL_HCI_RP(ble_ll_read_rf_path_compensation, 0, SUPP(39, 0)),
+    [BLE_HCI_OCF_LE_WR_RF_PATH_COMPENSATION] =
+        BLE_LL_HCI_CP(ble_ll_write_rf_path_compensation,
+                      CP_LEN(ble_hci_le_wr_rf_path_compensation_cp), 0,
+                      SUPP(39, 1)),
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PRIVACY)
+    [BLE_HCI_OCF_LE_SET_PRIVACY_MODE] =
+        BLE_LL_HCI_CP(ble_ll_resolve_set_priv_mode,
+                      CP_LEN(ble_hci_le_set_privacy_mode_cp), 0, SUPP(39, 2)),
+#endif
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PERIODIC_ADV) && MYNEWT_VAL(BLE_VERSION) >= 51
+    [BLE_HCI_OCF_LE_PERIODIC_ADV_RECEIVE_ENABLE] =
+        BLE_LL_HCI_CP(ble_ll_sync_receive_enable,
+                      CP_LEN(ble_hci_le_periodic_adv_receive_enable_cp), EXT,
+                      SUPP(40, 5)),
+#endif
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PERIODIC_ADV_SYNC_TRANSFER)
+    [BLE_HCI_OCF_LE_PERIODIC_ADV_SYNC_TRANSFER] =
+        BLE_LL_HCI_CP_RP(ble_ll_sync_transfer,
+                         CP_LEN(ble_hci_le_periodic_adv_sync_transfer_cp), EXT,
+                         SUPP(40, 6)),
+    [BLE_HCI_OCF_LE_PERIODIC_ADV_SET_INFO_TRANSFER] =
+        BLE_LL_HCI_CP_RP(ble_ll_adv_periodic_set_info_transfer,
+                         CP_LEN(ble_hci_le_periodic_adv_set_info_transfer_cp),
+                         EXT, SUPP(40, 7)),
+    [BLE_HCI_OCF_LE_PERIODIC_ADV_SYNC_TRANSFER_PARAMS] =
+        BLE_LL_HCI_CP_RP(ble_ll_set_sync_transfer_params,
+                         CP_LEN(ble_hci_le_periodic_adv_sync_transfer_params_cp),
+                         EXT, SUPP(41, 0)),
+    [BLE_HCI_OCF_LE_SET_DEFAULT_SYNC_TRANSFER_PARAMS] =
+        BLE_LL_HCI_CP(ble_ll_set_default_sync_transfer_params,
+                      CP_LEN(ble_hci_le_set_default_periodic_sync_transfer_params_cp),
+                      EXT, SUPP(41, 1)),
+#endif
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_ISO)
+    [BLE_HCI_OCF_LE_RD_BUF_SIZE_V2] =
+        BLE_LL_HCI_RP(ble_ll_hci_le_read_bufsize_v2, 0, SUPP(41, 5)),
+    [BLE_HCI_OCF_LE_READ_ISO_TX_SYNC] =
+        BLE_LL_HCI_CP(ble_ll_iso_read_tx_sync, ANY, 0, SUPP(41, 6)),
+    [BLE_HCI_OCF_LE_SET_CIG_PARAM] =
+        BLE_LL_HCI_CP_RP(ble_ll_iso_set_cig_param, ANY, 0, SUPP(41, 7)),
+    [BLE_HCI_OCF_LE_CREATE_CIS] =
+        BLE_LL_HCI_CP(ble_ll_iso_create_cis, ANY, 0, SUPP(42, 1)),
+    [BLE_HCI_OCF_LE_REMOVE_CIG] =
+        BLE_LL_HCI_CP_RP(ble_ll_iso_remove_cig, ANY, 0, SUPP(42, 2)),
+    [BLE_HCI_OCF_LE_ACCEPT_CIS_REQ] =
+        BLE_LL_HCI_CP(ble_ll_iso_accept_cis_req, ANY, 0, SUPP(42, 3)),
+    [BLE_HCI_OCF_LE_REJECT_CIS_REQ] =
+        BLE_LL_HCI_CP(ble_ll_iso_reject_cis_req, ANY, 0, SUPP(42, 4)),
+    [BLE_HCI_OCF_LE_CREATE_BIG] =
+        BLE_LL_HCI_CP(ble_ll_iso_create_big, ANY, 0, SUPP(42, 5)),
+    [BLE_HCI_OCF_LE_TERMINATE_BIG] =
+        BLE_LL_HCI_CP(ble_ll_iso_terminate_big, ANY, 0, SUPP(42, 7)),
+    [BLE_HCI_OCF_LE_BIG_CREATE_SYNC] =
+        BLE_LL_HCI_CP(ble_ll_iso_big_create_sync, ANY, 0, SUPP(43, 0)),
+    [BLE_HCI_OCF_LE_BIG_TERMINATE_SYNC] =
+        BLE_LL_HCI_CP(ble_ll_iso_big_terminate_sync, ANY, 0, SUPP(43, 1)),
+    [BLE_HCI_OCF_LE_SETUP_ISO_DATA_PATH] =
+        BLE_LL_HCI_CP(ble_ll_iso_setup_iso_data_path, ANY, 0, SUPP(43, 3)),
+    [BLE_HCI_OCF_LE_REMOVE_ISO_DATA_PATH] =
+        BLE_LL_HCI_CP(ble_ll_iso_remove_iso_data_path, ANY, 0, SUPP(43, 4)),
+#endif
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_ISO_TEST)
+    [BLE_HCI_OCF_LE_SET_CIG_PARAM_TEST] =
+        BLE_LL_HCI_CP_RP(ble_ll_iso_set_cig_param_test, ANY, 0, SUPP(42, 0)),
+    [BLE_HCI_OCF_LE_CREATE_BIG_TEST] =
+        BLE_LL_HCI_CP(ble_ll_iso_create_big_test, ANY, 0, SUPP(42, 6)),
+    [BLE_HCI_OCF_LE_ISO_TRANSMIT_TEST] =
+        BLE_LL_HCI_CP(ble_ll_iso_transmit_test, ANY, 0, SUPP(43, 5)),
+    [BLE_HCI_OCF_LE_ISO_RECEIVE_TEST] =
+        BLE_LL_HCI_CP(ble_ll_iso_receive_test, ANY, 0, SUPP(43, 6)),
+    [BLE_HCI_OCF_LE_ISO_READ_TEST_COUNTERS] =
+        BLE_LL_HCI_CP(ble_ll_iso_read_counters_test, ANY, 0, SUPP(43, 7)),
+    [BLE_HCI_OCF_LE_ISO_TEST_END] =
+        BLE_LL_HCI_CP(ble_ll_iso_end_test, ANY, 0, SUPP(44, 0)),
+#endif
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_SCA_UPDATE)
+    [BLE_HCI_OCF_LE_REQ_PEER_SCA] =
+        BLE_LL_HCI_CP_RP(ble_ll_conn_req_peer_sca, ANY, STATUS, SUPP(43, 2)),
+#endif
+#if MYNEWT_VAL(BLE_VERSION) >= 52
+    [BLE_HCI_OCF_LE_SET_HOST_FEAT] =
+        BLE_LL_HCI_CP(ble_ll_set_host_feat, CP_LEN(ble_hci_le_set_host_feat_cp),
+                      0, SUPP(44, 1)),
+#endif
+};
+
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+static const struct ble_ll_hci_cmd g_ble_ll_hci_vs_cmds[] = {
+    [BLE_HCI_OCF_VS_SET_MAX_CONN_EVENT_LEN] =
+        BLE_LL_HCI_CP_RP(ble_ll_conn_hci_vs_set_max_event_len,
+                         CP_LEN(ble_hci_vs_set_max_conn_event_len_cp), 0,
+                         BLE_LL_HCI_SUPP_NONE),
+    [BLE_HCI_OCF_VS_RD_CONN_TPUT_STATS] =
+        BLE_LL_HCI_CP_RP(ble_ll_conn_hci_vs_rd_tput_stats,
+                         CP_LEN(ble_hci_vs_rd_conn_tput_stats_cp), 0,
+                         BLE_LL_HCI_SUPP_NONE),
+};
+#endif
+
+#undef CP_LEN
+#undef ANY
+#undef STATUS
+#undef LEGACY
+#undef EXT
+#undef SUPP
+
+#define BLE_LL_HCI_CMD_GROUP(_cmds) \
+    { .cmds = (_cmds), .num_cmds = sizeof(_cmds) / sizeof((_cmds)[0]) }
+
+const struct ble_ll_hci_cmd_group g_ble_ll_hci_cmd_groups[] = {
+    [BLE_HCI_OGF_LINK_CTRL] = BLE_LL_HCI_CMD_GROUP(g_ble_ll_hci_link_ctrl_cmds),
+    [BLE_HCI_OGF_CTLR_BASEBAND] =
+        BLE_LL_HCI_CMD_GROUP(g_ble_ll_hci_ctlr_bb_cmds),
+    [BLE_HCI_OGF_INFO_PARAMS] =
+        BLE_LL_HCI_CMD_GROUP(g_ble_ll_hci_info_params_cmds),
+    [BLE_HCI_OGF_STATUS_PARAMS] =
+        BLE_LL_HCI_CMD_GROUP(g_ble_ll_hci_status_params_cmds),
+    [BLE_HCI_OGF_LE] = BLE_LL_HCI_CMD_GROUP(g_ble_ll_hci_le_cmds),
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+    [BLE_HCI_OGF_VENDOR] = BLE_LL_HCI_CMD_GROUP(g_ble_ll_hci_vs_cmds),
+#endif
+};
+
+const uint8_t g_ble_ll_hci_num_cmd_groups =
+    sizeof(g_ble_ll_hci_cmd_groups) / sizeof(g_ble_ll_hci_cmd_groups[0]);
+
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
+static bool
+ble_ll_hci_adv_mode_check(uint8_t flags)
+{
+    /*
+     * If, since the last power-on or reset, the Host has ever issued a legacy
+     * advertising command and then issues an extended advertising command, or
+     * has ever issued an extended advertising command and then issues a legacy
+     * advertising command, the Controller shall return the error code Command
+     * Disallowed (0x0C).
+     */
+    if (flags & BLE_LL_HCI_CMD_F_ADV_LEGACY) {
+        if (hci_adv_mode == ADV_MODE_EXT) {
+            return false;
+        }
+
+        hci_adv_mode = ADV_MODE_LEGACY;
+    } else if (flags & BLE_LL_HCI_CMD_F_ADV_EXT) {
+        if (hci_adv_mode == ADV_MODE_LEGACY) {
+            return false;
+        }
+
+        hci_adv_mode = ADV_MODE_EXT;
     }
 
-    return rc;
+    return true;
 }
+#endif
 
+/**
+ * Validates and dispatches an HCI command through the command table.
+ *
+ * @param ogf    Opcode group field.
+ * @param ocf    Opcode command field.
+ * @param cmdbuf Pointer to command parameters.
+ * @param len    Length of command parameters.
+ * @param rspbuf Pointer to response buffer.
+ * @param rsplen Pointer to length of response.
+ * @param cb     Pointer to post command complete callback.
+ *
+ * @return int  This function returns a BLE error code. If a command status
+ *              event should be returned as opposed to command complete,
+ *              256 gets added to the return value.
+ */
 static int
-ble_ll_hci_info_params_cmd_proc(const uint8_t *cmdbuf, uint8_t len,
-                                uint16_t ocf, uint8_t *rspbuf, uint8_t *rsplen)
+ble_ll_hci_cmd_dispatch(uint8_t ogf, uint16_t ocf, const uint8_t *cmdbuf,
+                        uint8_t len, uint8_t *rspbuf, uint8_t *rsplen,
+                        ble_ll_hci_post_cmd_complete_cb *cb)
 {
+    const struct ble_ll_hci_cmd_group *grp;
+    const struct ble_ll_hci_cmd *cmd;
     int rc;
 
-    /* Assume error; if all pass rc gets set to 0 */
-    rc = BLE_ERR_INV_HCI_CMD_PARMS;
-
-    switch (ocf) {
-    case BLE_HCI_OCF_IP_RD_LOCAL_VER:
-        if (len == 0) {
-            rc = ble_ll_hci_rd_local_version(rspbuf, rsplen);
+    cmd = NULL;
+    if (ogf < g_ble_ll_hci_num_cmd_groups) {
+        grp = &g_ble_ll_hci_cmd_groups[ogf];
+        if (ocf < grp->num_cmds && grp->cmds[ocf].type) {
+            cmd = &grp->cmds[ocf];
         }
+    }
+
+    /*
+     * For unknown HCI command let us return always command status as per
+     * specification Bluetooth 5, Vol. 2, Chapter 4.4
+     */
+    if (!cmd) {
+        return BLE_ERR_UNKNOWN_HCI_CMD + (BLE_ERR_MAX + 1);
+    }
+
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
+    if (!ble_ll_hci_adv_mode_check(cmd->flags)) {
+        rc = BLE_ERR_CMD_DISALLOWED;
+        goto done;
+    }
+#endif
+
+    if ((cmd->plen != BLE_LL_HCI_CMD_PLEN_ANY) && (len != cmd->plen)) {
+        rc = BLE_ERR_INV_HCI_CMD_PARMS;
+        goto done;
+    }
+
+    switch (cmd->type) {
+    case BLE_LL_HCI_CMD_T_CP:
+        rc = cmd->cp(cmdbuf, len);
         break;
-    case BLE_HCI_OCF_IP_RD_LOC_SUPP_CMD:
-        if (len == 0) {
-            rc = ble_ll_hci_rd_local_supp_cmd(rspbuf, rsplen);
-        }
+    case BLE_LL_HCI_CMD_T_RP:
+        rc = cmd->rp(rspbuf, rsplen);
         break;
-    case BLE_HCI_OCF_IP_RD_LOC_SUPP_FEAT:
-        if (len == 0) {
-            rc = ble_ll_hci_rd_local_supp_feat(rspbuf, rsplen);
-        }
+    case BLE_LL_HCI_CMD_T_CP_RP:
+        rc = cmd->cp_rp(cmdbuf, len, rspbuf, rsplen);
         break;
-    case BLE_HCI_OCF_IP_RD_BD_ADDR:
-        if (len == 0) {
-            rc = ble_ll_hci_rd_bd_addr(rspbuf, rsplen);
-        }
+    case BLE_LL_HCI_CMD_T_VOID:
+        rc = cmd->v();
+        break;
+    case BLE_LL_HCI_CMD_T_CB:
+        rc = cmd->cb(cb);
         break;
     default:
+        BLE_LL_ASSERT(0);
         rc = BLE_ERR_UNKNOWN_HCI_CMD;
         break;
     }
 
-    return rc;
-}
-
-static int
-ble_ll_hci_status_params_cmd_proc(const uint8_t *cmdbuf, uint8_t len,
-                                  uint16_t ocf, uint8_t *rspbuf,
-                                  uint8_t *rsplen)
-{
-    int rc;
-
-    switch (ocf) {
-    case BLE_HCI_OCF_RD_RSSI:
-        rc = ble_ll_conn_hci_rd_rssi(cmdbuf, len, rspbuf, rsplen);
-        break;
-    default:
-        rc = BLE_ERR_UNKNOWN_HCI_CMD;
-        break;
+done:
+    /*
+     * This code is here because we add 256 to the return code to denote
+     * that the reply to this command should be command status (as opposed to
+     * command complete).
+     */
+    if ((cmd->flags & BLE_LL_HCI_CMD_F_STATUS) ||
+        (rc == BLE_ERR_UNKNOWN_HCI_CMD)) {
+        rc += (BLE_ERR_MAX + 1);
     }
 
     return rc;
@@ -1568,27 +1445,8 @@ ble_ll_hci_cmd_proc(struct ble_npl_event *ev)
     /* Assume response length is zero */
     rsplen = 0;
 
-    switch (ogf) {
-    case BLE_HCI_OGF_LINK_CTRL:
-        rc = ble_ll_hci_link_ctrl_cmd_proc(cmd->data, cmd->length, ocf);
-        break;
-    case BLE_HCI_OGF_CTLR_BASEBAND:
-        rc = ble_ll_hci_ctlr_bb_cmd_proc(cmd->data, cmd->length, ocf, rspbuf, &rsplen);
-        break;
-    case BLE_HCI_OGF_INFO_PARAMS:
-        rc = ble_ll_hci_info_params_cmd_proc(cmd->data, cmd->length, ocf, rspbuf, &rsplen);
-        break;
-    case BLE_HCI_OGF_STATUS_PARAMS:
-        rc = ble_ll_hci_status_params_cmd_proc(cmd->data, cmd->length, ocf, rspbuf, &rsplen);
-        break;
-    case BLE_HCI_OGF_LE:
-        rc = ble_ll_hci_le_cmd_proc(cmd->data, cmd->length, ocf, rspbuf, &rsplen, &post_cb);
-        break;
-    default:
-        /* XXX: Need to support other OGF. For now, return unsupported */
-        rc = BLE_ERR_UNKNOWN_HCI_CMD;
-        break;
-    }
+    rc = ble_ll_hci_cmd_dispatch(ogf, ocf, cmd->data, cmd->length, rspbuf,
+                                 &rsplen, &post_cb);
 
     /* If no response is generated, we free the buffers */
     BLE_LL_ASSERT(rc >= 0);
@@ -1718,6 +1576,9 @@ ble_ll_hci_init(void)
     /* Set page 2 to 0 */
     g_ble_ll_hci_event_mask2 = 0;
 
+    /* Supported commands follow the command table */
+    ble_ll_supp_cmd_init();
+
     /* reset RF path compensation values */
     rx_path_pwr_compensation = 0;
     tx_path_pwr_compensation = 0;
@@ -0,0 +1,87 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_BLE_LL_HCI_PRIV_
+#define H_BLE_LL_HCI_PRIV_
+
+#include <stdint.h>
+#include "controller/ble_ll_hci.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Handler signatures; an unused table slot has type 0 */
+#define BLE_LL_HCI_CMD_T_CP         (1) /* fn(cmdbuf, len) */
+#define BLE_LL_HCI_CMD_T_RP         (2) /* fn(rspbuf, rsplen) */
+#define BLE_LL_HCI_CMD_T_CP_RP      (3) /* fn(cmdbuf, len, rspbuf, rsplen) */
+#define BLE_LL_HCI_CMD_T_VOID       (4) /* fn(void) */
+#define BLE_LL_HCI_CMD_T_CB         (5) /* fn(post_cb) */
+
+/* Reply with Command Status instead of Command Complete */
+#define BLE_LL_HCI_CMD_F_STATUS     (0x01)
+/* Legacy advertising command; not allowed once extended ones were used */
+#define BLE_LL_HCI_CMD_F_ADV_LEGACY (0x02)
+/* Extended advertising command; not allowed once legacy ones were used */
+#define BLE_LL_HCI_CMD_F_ADV_EXT    (0x04)
+
+/* Parameter length is checked by the handler */
+#define BLE_LL_HCI_CMD_PLEN_ANY     (0xff)
+
+/* Position of the command in the Supported Commands bitmap */
+#define BLE_LL_HCI_SUPP(_octet, _bit)   (0x8000 | ((_octet) << 3) | (_bit))
+#define BLE_LL_HCI_SUPP_NONE            (0)
+#define BLE_LL_HCI_SUPP_OCTET(_supp)    (((_supp) & 0x7fff) >> 3)
+#define BLE_LL_HCI_SUPP_BIT(_supp)      ((_supp) & 0x07)
+
+struct ble_ll_hci_cmd
+{
+    union {
+        int (*cp)(const uint8_t *cmdbuf, uint8_t len);
+        int (*rp)(uint8_t *rspbuf, uint8_t *rsplen);
+        int (*cp_rp)(const uint8_t *cmdbuf, uint8_t len, uint8_t *rspbuf,
+                     uint8_t *rsplen);
+        int (*v)(void);
+        int (*cb)(ble_ll_hci_post_cmd_complete_cb *post_cb);
+    };
+    uint8_t type;
+    uint8_t plen;
+    uint8_t flags;
+    uint16_t supp;
+};
+
+/* Commands of one OGF, indexed by OCF */
+struct ble_ll_hci_cmd_group
+{
+    const struct ble_ll_hci_cmd *cmds;
+    uint16_t num_cmds;
+};
+
+/* Indexed by OGF */
+extern const struct ble_ll_hci_cmd_group g_ble_ll_hci_cmd_groups[];
+extern const uint8_t g_ble_ll_hci_num_cmd_groups;
+
+/* Builds the Supported Commands bitmap from the command table */
+void ble_ll_supp_cmd_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H_BLE_LL_HCI_PRIV_ */
@@ -47,6 +47,83 @@ struct ble_ll_resolv_data g_ble_ll_resolv_data;
 __attribute__((aligned(4)))
 struct ble_ll_resolv_entry g_ble_ll_resolv_list[MYNEWT_VAL(BLE_LL_RESOLV_LIST_SIZE)];
 
+/*
+ * Indexes of resolving list entries sorted by identity address type and
+ * identity address. Resolving list itself cannot be reordered since entries
+ * with peer IRK are kept first to match HW resolving list and indexes are
+ * stored e.g. in connection state machines, so lookups by identity address
+ * use this index instead. Rebuilt whenever resolving list is modified.
+ */
+static uint8_t g_ble_ll_resolv_idx[MYNEWT_VAL(BLE_LL_RESOLV_LIST_SIZE)];
+
+#if MYNEWT_VAL(BLE_LL_RESOLV_CACHE_SIZE)
+/*
+ * Cache of recently resolved peer RPAs. Peers keep using the same RPA for
+ * a while so this saves calculating ah() with each IRK on resolving list
+ * every time the same RPA is received. RPAs which did not resolve with any
+ * IRK are cached as well (rl_idx set to -1).
+ */
+struct ble_ll_resolv_cache_entry {
+    uint8_t rpa[BLE_DEV_ADDR_LEN];
+    int8_t rl_idx;
+};
+
+struct ble_ll_resolv_cache {
+    uint8_t cnt;
+    uint8_t next;
+    struct ble_ll_resolv_cache_entry entries[MYNEWT_VAL(BLE_LL_RESOLV_CACHE_SIZE)];
+};
+
+static struct ble_ll_resolv_cache g_ble_ll_resolv_cache;
+
+/**
+ * Invalidates all cached RPA resolutions. Shall be called whenever resolving
+ * list is modified since cached indexes may not be valid anymore.
+ */
+static void
+ble_ll_resolv_cache_clear(void)
+{
+    g_ble_ll_resolv_cache.cnt = 0;
+    g_ble_ll_resolv_cache.next = 0;
+}
+
+static struct ble_ll_resolv_cache_entry *
+ble_ll_resolv_cache_find(const uint8_t *rpa)
+{
+    struct ble_ll_resolv_cache_entry *e;
+    int i;
+
+    for (i = 0; i < g_ble_ll_resolv_cache.cnt; i++) {
+        e = &g_ble_ll_resolv_cache.entries[i];
+        if (!memcmp(e->rpa, rpa, BLE_DEV_ADDR_LEN)) {
+            return e;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+ble_ll_resolv_cache_add(const uint8_t *rpa, int rl_idx)
+{
+    struct ble_ll_resolv_cache_entry *e;
+
+    /* Replace oldest entry if cache is full */
+    e = &g_ble_ll_resolv_cache.entries[g_ble_ll_resolv_cache.next];
+    memcpy(e->rpa, rpa, BLE_DEV_ADDR_LEN);
+    e->rl_idx = rl_idx;
+
+    if (g_ble_ll_resolv_cache.cnt < MYNEWT_VAL(BLE_LL_RESOLV_CACHE_SIZE)) {
+        g_ble_ll_resolv_cache.cnt++;
+    }
+
+    g_ble_ll_resolv_cache.next++;
+    if (g_ble_ll_resolv_cache.next == MYNEWT_VAL(BLE_LL_RESOLV_CACHE_SIZE)) {
+        g_ble_ll_resolv_cache.next = 0;
+    }
+}
+#endif
+
 static int
 ble_ll_is_controller_busy(void)
 {
@@ -155,6 +232,11 @@ ble_ll_resolv_rpa_timer_cb(struct ble_npl_event *ev)
     ble_npl_callout_reset(&g_ble_ll_resolv_data.rpa_timer,
                           g_ble_ll_resolv_data.rpa_tmo);
 
+#if MYNEWT_VAL(BLE_LL_RESOLV_CACHE_SIZE)
+    /* Peers are expected to change their RPAs as well */
+    ble_ll_resolv_cache_clear();
+#endif
+
     ble_ll_adv_rpa_timeout();
 }
 
@@ -201,6 +283,10 @@ ble_ll_resolv_list_clr(void)
     g_ble_ll_resolv_data.rl_cnt = 0;
     ble_hw_resolv_list_clear();
 
+#if MYNEWT_VAL(BLE_LL_RESOLV_CACHE_SIZE)
+    ble_ll_resolv_cache_clear();
+#endif
+
     /* stop RPA timer when clearing RL */
     ble_npl_callout_stop(&g_ble_ll_resolv_data.rpa_timer);
 
@@ -226,9 +312,53 @@ ble_ll_resolv_list_read_size(uint8_t *rspbuf, uint8_t *rsplen)
     return BLE_ERR_SUCCESS;
 }
 
+static int
+ble_ll_resolv_cmp(const struct ble_ll_resolv_entry *rl, const uint8_t *addr,
+                  uint8_t addr_type)
+{
+    if (rl->rl_addr_type != addr_type) {
+        return rl->rl_addr_type < addr_type ? -1 : 1;
+    }
+
+    return memcmp(rl->rl_identity_addr, addr, BLE_DEV_ADDR_LEN);
+}
+
+/**
+ * Rebuilds sorted index of resolving list. Uses insertion sort which is fine
+ * since resolving list is small and this is only called on HCI commands
+ * modifying the list.
+ */
+static void
+ble_ll_resolv_idx_rebuild(void)
+{
+    struct ble_ll_resolv_entry *rl;
+    uint8_t idx;
+    int i;
+    int j;
+
+    for (i = 0; i < g_ble_ll_resolv_data.rl_cnt; i++) {
+        rl = &g_ble_ll_resolv_list[i];
+
+        for (j = i; j > 0; j--) {
+            idx = g_ble_ll_resolv_idx[j - 1];
+            if (ble_ll_resolv_cmp(&g_ble_ll_resolv_list[idx],
+                                  rl->rl_identity_addr,
+                                  rl->rl_addr_type) < 0) {
+                break;
+            }
+            g_ble_ll_resolv_idx[j] = idx;
+        }
+
+        g_ble_ll_resolv_idx[j] = i;
+    }
+}
+
 /**
  * Used to determine if the device is on the resolving list.
  *
+ * Worst case this takes ceil(log2(BLE_LL_RESOLV_LIST_SIZE + 1)) address
+ * comparisons.
+ *
  * @param addr
  * @param addr_type Public address (0) or random address (1)
  *
@@ -239,16 +369,29 @@ ble_ll_resolv_list_read_size(uint8_t *rspbuf, uint8_t *rsplen)
 static int
 ble_ll_is_on_resolv_list(const uint8_t *addr, uint8_t addr_type)
 {
-    int i;
-    struct ble_ll_resolv_entry *rl;
+    uint8_t idx;
+    int lo;
+    int hi;
+    int mid;
+    int rc;
 
-    rl = &g_ble_ll_resolv_list[0];
-    for (i = 0; i < g_ble_ll_resolv_data.rl_cnt; ++i) {
-        if ((rl->rl_addr_type == addr_type) &&
-            (!memcmp(&rl->rl_identity_addr[0], addr, BLE_DEV_ADDR_LEN))) {
-            return i + 1;
+    lo = 0;
+    hi = g_ble_ll_resolv_data.rl_cnt;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        idx = g_ble_ll_resolv_idx[mid];
+
+        rc = ble_ll_resolv_cmp(&g_ble_ll_resolv_list[idx], addr, addr_type);
+        if (rc == 0) {
+            return idx + 1;
+        }
+
+        if (rc < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
-        ++rl;
     }
 
     return 0;
@@ -265,19 +408,14 @@ ble_ll_is_on_resolv_list(const uint8_t *addr, uint8_t addr_type)
 struct ble_ll_resolv_entry *
 ble_ll_resolv_list_find(const uint8_t *addr, uint8_t addr_type)
 {
-    int i;
-    struct ble_ll_resolv_entry *rl;
+    int position;
 
-    rl = &g_ble_ll_resolv_list[0];
-    for (i = 0; i < g_ble_ll_resolv_data.rl_cnt; ++i) {
-        if ((rl->rl_addr_type == addr_type) &&
-            (!memcmp(&rl->rl_identity_addr[0], addr, BLE_DEV_ADDR_LEN))) {
-            return rl;
-        }
-        ++rl;
+    position = ble_ll_is_on_resolv_list(addr, addr_type);
+    if (!position) {
+        return NULL;
     }
 
-    return NULL;
+    return &g_ble_ll_resolv_list[position - 1];
 }
 
 /**
@@ -361,6 +499,12 @@ ble_ll_resolv_list_add(const uint8_t *cmdbuf, uint8_t len)
     }
 
     g_ble_ll_resolv_data.rl_cnt++;
+    ble_ll_resolv_idx_rebuild();
+
+#if MYNEWT_VAL(BLE_LL_RESOLV_CACHE_SIZE)
+    /* Entries were moved and new IRK may resolve previously unresolved RPA */
+    ble_ll_resolv_cache_clear();
+#endif
 
     /* start RPA timer if this was first element added to RL */
     if (g_ble_ll_resolv_data.rl_cnt == 1) {
@@ -403,6 +547,7 @@ ble_ll_resolv_list_rmv(const uint8_t *cmdbuf, uint8_t len)
                 (g_ble_ll_resolv_data.rl_cnt - position) *
                 sizeof(g_ble_ll_resolv_list[0]));
         g_ble_ll_resolv_data.rl_cnt--;
+        ble_ll_resolv_idx_rebuild();
 
         /* Remove from HW list */
         if (position <= g_ble_ll_resolv_data.rl_cnt_hw) {
@@ -410,6 +555,10 @@ ble_ll_resolv_list_rmv(const uint8_t *cmdbuf, uint8_t len)
             g_ble_ll_resolv_data.rl_cnt_hw--;
         }
 
+#if MYNEWT_VAL(BLE_LL_RESOLV_CACHE_SIZE)
+        ble_ll_resolv_cache_clear();
+#endif
+
         /* stop RPA timer if list is empty */
         if (g_ble_ll_resolv_data.rl_cnt == 0) {
             ble_npl_callout_stop(&g_ble_ll_resolv_data.rpa_timer);
@@ -695,15 +844,36 @@ ble_ll_resolv_rpa(const uint8_t *rpa, const uint8_t *irk)
 int
 ble_ll_resolv_peer_rpa_any(const uint8_t *rpa)
 {
+#if MYNEWT_VAL(BLE_LL_RESOLV_CACHE_SIZE)
+    struct ble_ll_resolv_cache_entry *e;
+#endif
+    int rc;
     int i;
 
+#if MYNEWT_VAL(BLE_LL_RESOLV_CACHE_SIZE)
+    e = ble_ll_resolv_cache_find(rpa);
+    if (e) {
+        STATS_INC(ble_ll_stats, rpa_cache_hit);
+        return e->rl_idx;
+    }
+
+    STATS_INC(ble_ll_stats, rpa_cache_miss);
+#endif
+
+    rc = -1;
+
     for (i = 0; i < g_ble_ll_resolv_data.rl_cnt_hw; i++) {
         if (ble_ll_resolv_rpa(rpa, g_ble_ll_resolv_list[i].rl_peer_irk)) {
-            return i;
+            rc = i;
+            break;
         }
     }
 
-    return -1;
+#if MYNEWT_VAL(BLE_LL_RESOLV_CACHE_SIZE)
+    ble_ll_resolv_cache_add(rpa, rc);
+#endif
+
+    return rc;
 }
 
 /**
@@ -749,5 +919,16 @@ ble_ll_resolv_init(void)
                          NULL);
 }
 
+#if MYNEWT_VAL(SELFTEST)
+void
+ble_ll_resolv_list_size_set(uint8_t size)
+{
+    if (size > MYNEWT_VAL(BLE_LL_RESOLV_LIST_SIZE)) {
+        size = MYNEWT_VAL(BLE_LL_RESOLV_LIST_SIZE);
+    }
+    g_ble_ll_resolv_data.rl_size = size;
+}
+#endif
+
 #endif  /* if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PRIVACY) */
 
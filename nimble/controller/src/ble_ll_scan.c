@@ -130,14 +130,38 @@ struct ble_ll_scan_dup_entry {
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
     uint16_t adi;
 #endif
-    TAILQ_ENTRY(ble_ll_scan_dup_entry) link;
+#if MYNEWT_VAL(BLE_LL_SCAN_DUP_EXPIRY_MS)
+    uint32_t timestamp; /* cputime when flags were last cleared */
+#endif
+    TAILQ_ENTRY(ble_ll_scan_dup_entry) link;    /* LRU list, newest first */
+    SLIST_ENTRY(ble_ll_scan_dup_entry) hlink;   /* hash bucket */
 };
 
+#if (MYNEWT_VAL(BLE_LL_SCAN_DUP_HASH_SIZE) == 0) || \
+    (MYNEWT_VAL(BLE_LL_SCAN_DUP_HASH_SIZE) & \
+     (MYNEWT_VAL(BLE_LL_SCAN_DUP_HASH_SIZE) - 1))
+#error "BLE_LL_SCAN_DUP_HASH_SIZE must be a power of 2"
+#endif
+
+/* Max parameter length of an event with coalesced advertising reports */
+#define BLE_LL_SCAN_RPT_MAX_LEN     min(UINT8_MAX, BLE_HCI_MAX_DATA_LEN)
+
+#if MYNEWT_VAL(BLE_LL_SCAN_RPT_COALESCE_MS)
+/* Advertising report event waiting for more reports to be appended */
+static struct ble_hci_ev *g_ble_ll_scan_rpt_ev;
+static struct ble_npl_callout g_ble_ll_scan_rpt_timer;
+#endif
+
 static os_membuf_t g_scan_dup_mem[ OS_MEMPOOL_SIZE(
                                    MYNEWT_VAL(BLE_LL_NUM_SCAN_DUP_ADVS),
                                    sizeof(struct ble_ll_scan_dup_entry)) ];
 static struct os_mempool g_scan_dup_pool;
 static TAILQ_HEAD(ble_ll_scan_dup_list, ble_ll_scan_dup_entry) g_scan_dup_list;
+static SLIST_HEAD(ble_ll_scan_dup_bucket, ble_ll_scan_dup_entry)
+                    g_scan_dup_hash[MYNEWT_VAL(BLE_LL_SCAN_DUP_HASH_SIZE)];
+#if MYNEWT_VAL(BLE_LL_SCAN_DUP_EXPIRY_MS)
+static uint32_t g_scan_dup_expiry_ticks;
+#endif
 
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
 #if MYNEWT_VAL(BLE_LL_EXT_ADV_AUX_PTR_CNT) != 0
@@ -384,6 +408,110 @@ ble_ll_scan_req_tx_pdu_cb(uint8_t *dptr, void *pducb_arg, uint8_t *hdr_byte)
     return BLE_DEV_ADDR_LEN * 2;
 }
 
+#if MYNEWT_VAL(BLE_LL_SCAN_RPT_COALESCE_MS)
+static void
+ble_ll_scan_rpt_flush(void)
+{
+    struct ble_hci_ev *hci_ev;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    hci_ev = g_ble_ll_scan_rpt_ev;
+    g_ble_ll_scan_rpt_ev = NULL;
+    OS_EXIT_CRITICAL(sr);
+
+    if (hci_ev) {
+        ble_npl_callout_stop(&g_ble_ll_scan_rpt_timer);
+        ble_ll_hci_event_send(hci_ev);
+    }
+}
+
+static void
+ble_ll_scan_rpt_timer_cb(struct ble_npl_event *ev)
+{
+    ble_ll_scan_rpt_flush();
+}
+#endif
+
+/* Max number of reports in a single event of the specified subevent */
+static uint8_t
+ble_ll_scan_rpt_max_num(uint8_t subev_code)
+{
+    if (subev_code == BLE_HCI_LE_SUBEV_EXT_ADV_RPT) {
+        return BLE_HCI_LE_EXT_ADV_RPT_NUM_RPTS_MAX;
+    }
+
+    return BLE_HCI_LE_ADV_RPT_NUM_RPTS_MAX;
+}
+
+int
+ble_ll_scan_rpt_append(struct ble_hci_ev *pending,
+                       const struct ble_hci_ev *hci_ev)
+{
+    uint8_t len;
+
+    if ((pending->data[0] != hci_ev->data[0]) ||
+        (pending->data[1] >= ble_ll_scan_rpt_max_num(pending->data[0]))) {
+        return -1;
+    }
+
+    /* Appended part does not include subevent code and number of reports */
+    len = hci_ev->length - 2;
+    if (pending->length + len > BLE_LL_SCAN_RPT_MAX_LEN) {
+        return -1;
+    }
+
+    memcpy(&pending->data[pending->length], &hci_ev->data[2], len);
+    pending->length += len;
+    pending->data[1]++;
+
+    return 0;
+}
+
+/**
+ * Sends an advertising report event to the host.
+ *
+ * The event shall contain exactly one report. If coalescing is enabled, the
+ * report is appended to a pending event of the same subevent type and sent
+ * when that event is full or BLE_LL_SCAN_RPT_COALESCE_MS have elapsed since
+ * its first report, whichever comes first. Reports are always delivered in
+ * order they were passed here.
+ *
+ * @param hci_ev    LE Meta event with a single (Direct/Extended) Advertising
+ *                  Report. Ownership is passed to this function.
+ *
+ * @return          0 on success, non-zero on failure.
+ */
+static int
+ble_ll_scan_rpt_send(struct ble_hci_ev *hci_ev)
+{
+#if MYNEWT_VAL(BLE_LL_SCAN_RPT_COALESCE_MS)
+    struct ble_hci_ev *pending;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    pending = g_ble_ll_scan_rpt_ev;
+    if (pending && (ble_ll_scan_rpt_append(pending, hci_ev) == 0)) {
+        OS_EXIT_CRITICAL(sr);
+
+        ble_hci_trans_buf_free((uint8_t *)hci_ev);
+        return 0;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    ble_ll_scan_rpt_flush();
+
+    g_ble_ll_scan_rpt_ev = hci_ev;
+    ble_npl_callout_reset(&g_ble_ll_scan_rpt_timer,
+                          ble_npl_time_ms_to_ticks32(
+                              MYNEWT_VAL(BLE_LL_SCAN_RPT_COALESCE_MS)));
+
+    return 0;
+#else
+    return ble_ll_hci_event_send(hci_ev);
+#endif
+}
+
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
 /* if copy_from is provided new report is initialized with that instead of
  * defaults
@@ -406,7 +534,7 @@ ble_ll_scan_get_ext_adv_report(struct ext_adv_report *copy_from)
 
     memset(ev, 0, sizeof(*ev));
     ev->subev_code = BLE_HCI_LE_SUBEV_EXT_ADV_RPT;
-    /* We support only one report per event now */
+    /* Reports from multiple events may be coalesced later on */
     ev->num_reports = 1;
 
     report = ev->reports;
@@ -475,7 +603,7 @@ ble_ll_scan_send_truncated(struct ble_ll_aux_data *aux_data)
     }
 
     report->sid = aux_data->adi >> 12;
-    ble_ll_hci_event_send(hci_ev);
+    ble_ll_scan_rpt_send(hci_ev);
 
     aux_data->flags_ll |= BLE_LL_AUX_FLAG_SCAN_ERROR;
     aux_data->flags_ll |= BLE_LL_AUX_FLAG_HCI_SENT_ANY;
@@ -684,7 +812,7 @@ ble_ll_hci_send_legacy_ext_adv_report(uint8_t evtype,
         os_mbuf_copydata(adv_data, 0, adv_data_len, report->data);
     }
 
-    return ble_ll_hci_event_send(hci_ev);
+    return ble_ll_scan_rpt_send(hci_ev);
 }
 #endif
 
@@ -729,7 +857,7 @@ ble_ll_hci_send_adv_report(uint8_t evtype,
     ev_rssi = (int8_t *) (hci_ev->data + sizeof(*ev) + sizeof(ev->reports[0]) + adv_data_len);
     *ev_rssi = rssi;
 
-    return ble_ll_hci_event_send(hci_ev);
+    return ble_ll_scan_rpt_send(hci_ev);
 }
 
 static int
@@ -763,10 +891,18 @@ ble_ll_hci_send_dir_adv_report(const uint8_t *addr, uint8_t addr_type,
     memcpy(ev->reports[0].dir_addr, inita, BLE_DEV_ADDR_LEN);
     ev->reports[0].rssi = rssi;
 
-    return ble_ll_hci_event_send(hci_ev);
+    return ble_ll_scan_rpt_send(hci_ev);
 }
 
-static int
+static void
+ble_ll_scan_dup_clear(void)
+{
+    os_mempool_clear(&g_scan_dup_pool);
+    TAILQ_INIT(&g_scan_dup_list);
+    memset(g_scan_dup_hash, 0, sizeof(g_scan_dup_hash));
+}
+
+int
 ble_ll_scan_dup_update_legacy(uint8_t addr_type, const uint8_t *addr,
                               uint8_t subev, uint8_t evtype)
 {
@@ -799,8 +935,8 @@ ble_ll_scan_dup_update_legacy(uint8_t addr_type, const uint8_t *addr,
 /**
  * Send an advertising report to the host.
  *
- * NOTE: while we are allowed to send multiple devices in one report, we
- * will just send for one for now.
+ * NOTE: each report is built as a separate event; multiple reports may be
+ * coalesced into single event by ble_ll_scan_rpt_send().
  *
  * @param pdu_type
  * @param txadd
@@ -1170,6 +1306,11 @@ ble_ll_scan_sm_stop(int chk_disable)
     ble_ll_rfmgmt_scan_changed(false, 0);
     ble_ll_rfmgmt_release();
     OS_EXIT_CRITICAL(sr);
+
+#if MYNEWT_VAL(BLE_LL_SCAN_RPT_COALESCE_MS)
+    /* Do not hold reports until next scan */
+    ble_ll_scan_rpt_flush();
+#endif
 }
 
 static int
@@ -1206,8 +1347,7 @@ ble_ll_scan_sm_start(struct ble_ll_scan_sm *scansm)
     /* Forget filtered advertisers from previous scan. */
     g_ble_ll_scan_num_rsp_advs = 0;
 
-    os_mempool_clear(&g_scan_dup_pool);
-    TAILQ_INIT(&g_scan_dup_list);
+    ble_ll_scan_dup_clear();
 
     /*
      * First scan window can start when RF is enabled. Add 1 tick since we are
@@ -2655,7 +2795,7 @@ ble_ll_hci_send_ext_adv_report(uint8_t ptype, uint8_t *adva, uint8_t adva_type,
             report->data_len = 0;
             report->evt_type |= BLE_HCI_ADV_DATA_STATUS_TRUNCATED;
 
-            ble_ll_hci_event_send(hci_ev);
+            ble_ll_scan_rpt_send(hci_ev);
             goto done;
         }
 
@@ -2733,7 +2873,7 @@ ble_ll_hci_send_ext_adv_report(uint8_t ptype, uint8_t *adva, uint8_t adva_type,
             }
         }
 
-        ble_ll_hci_event_send(hci_ev);
+        ble_ll_scan_rpt_send(hci_ev);
 
         hci_ev = hci_ev_next;
     } while ((offset < datalen) && hci_ev);
@@ -2835,6 +2975,39 @@ ble_ll_scan_check_periodic_sync(const struct os_mbuf *om, struct ble_mbuf_hdr *r
 }
 #endif
 
+static inline struct ble_ll_scan_dup_bucket *
+ble_ll_scan_dup_bucket(uint8_t type, const uint8_t *addr)
+{
+    uint32_t h;
+    int i;
+
+    /* FNV-1a; anonymous entries are hashed with all-zero address */
+    h = 2166136261u;
+    h = (h ^ type) * 16777619u;
+    for (i = 0; i < BLE_DEV_ADDR_LEN; i++) {
+        h = (h ^ (addr ? addr[i] : 0)) * 16777619u;
+    }
+    h ^= h >> 16;
+
+    return &g_scan_dup_hash[h & (MYNEWT_VAL(BLE_LL_SCAN_DUP_HASH_SIZE) - 1)];
+}
+
+static struct ble_ll_scan_dup_entry *
+ble_ll_scan_dup_find(struct ble_ll_scan_dup_bucket *bucket, uint8_t type,
+                     const uint8_t *addr)
+{
+    struct ble_ll_scan_dup_entry *e;
+
+    SLIST_FOREACH(e, bucket, hlink) {
+        if ((e->type == type) &&
+            (!addr || !memcmp(e->addr, addr, BLE_DEV_ADDR_LEN))) {
+            break;
+        }
+    }
+
+    return e;
+}
+
 static inline void
 ble_ll_scan_dup_move_to_head(struct ble_ll_scan_dup_entry *e)
 {
@@ -2844,38 +3017,64 @@ ble_ll_scan_dup_move_to_head(struct ble_ll_scan_dup_entry *e)
     }
 }
 
+#if MYNEWT_VAL(BLE_LL_SCAN_DUP_EXPIRY_MS)
+static inline void
+ble_ll_scan_dup_check_expired(struct ble_ll_scan_dup_entry *e)
+{
+    uint32_t now;
+
+    now = os_cputime_get32();
+    if ((int32_t)(now - e->timestamp) >= (int32_t)g_scan_dup_expiry_ticks) {
+        e->flags = 0;
+        e->timestamp = now;
+    }
+}
+#endif
+
 static inline struct ble_ll_scan_dup_entry *
-ble_ll_scan_dup_new(void)
+ble_ll_scan_dup_new(struct ble_ll_scan_dup_bucket *bucket)
 {
     struct ble_ll_scan_dup_entry *e;
+    struct ble_ll_scan_dup_bucket *old;
 
     e = os_memblock_get(&g_scan_dup_pool);
     if (!e) {
+        /* Evict least recently seen advertiser */
         e = TAILQ_LAST(&g_scan_dup_list, ble_ll_scan_dup_list);
         TAILQ_REMOVE(&g_scan_dup_list, e, link);
+        old = ble_ll_scan_dup_bucket(e->type, e->addr);
+        SLIST_REMOVE(old, e, ble_ll_scan_dup_entry, hlink);
     }
 
     memset(e, 0, sizeof(*e));
+#if MYNEWT_VAL(BLE_LL_SCAN_DUP_EXPIRY_MS)
+    e->timestamp = os_cputime_get32();
+#endif
+
+    TAILQ_INSERT_HEAD(&g_scan_dup_list, e, link);
+    SLIST_INSERT_HEAD(bucket, e, hlink);
 
     return e;
 }
 
-static int
-ble_ll_scan_dup_check_legacy(uint8_t addr_type, uint8_t *addr, uint8_t pdu_type)
+int
+ble_ll_scan_dup_check_legacy(uint8_t addr_type, const uint8_t *addr,
+                             uint8_t pdu_type)
 {
+    struct ble_ll_scan_dup_bucket *bucket;
     struct ble_ll_scan_dup_entry *e;
     uint8_t type;
     int rc;
 
     type = BLE_LL_SCAN_ENTRY_TYPE_LEGACY(addr_type);
+    bucket = ble_ll_scan_dup_bucket(type, addr);
 
-    TAILQ_FOREACH(e, &g_scan_dup_list, link) {
-        if ((e->type == type) && !memcmp(e->addr, addr, 6)) {
-            break;
-        }
-    }
-
+    e = ble_ll_scan_dup_find(bucket, type, addr);
     if (e) {
+#if MYNEWT_VAL(BLE_LL_SCAN_DUP_EXPIRY_MS)
+        ble_ll_scan_dup_check_expired(e);
+#endif
+
         if (pdu_type == BLE_ADV_PDU_TYPE_ADV_DIRECT_IND) {
             rc = e->flags & BLE_LL_SCAN_DUP_F_DIR_ADV_REPORT_SENT;
         } else if (pdu_type == BLE_ADV_PDU_TYPE_SCAN_RSP) {
@@ -2888,12 +3087,9 @@ ble_ll_scan_dup_check_legacy(uint8_t addr_type, uint8_t *addr, uint8_t pdu_type)
     } else {
         rc = 0;
 
-        e = ble_ll_scan_dup_new();
-        e->flags = 0;
+        e = ble_ll_scan_dup_new(bucket);
         e->type = type;
         memcpy(e->addr, addr, 6);
-
-        TAILQ_INSERT_HEAD(&g_scan_dup_list, e, link);
     }
 
     return rc;
@@ -2904,6 +3100,7 @@ static int
 ble_ll_scan_dup_check_ext(uint8_t addr_type, uint8_t *addr,
                           struct ble_ll_aux_data *aux_data)
 {
+    struct ble_ll_scan_dup_bucket *bucket;
     struct ble_ll_scan_dup_entry *e;
     bool has_aux;
     bool is_anon;
@@ -2916,15 +3113,14 @@ ble_ll_scan_dup_check_ext(uint8_t addr_type, uint8_t *addr,
     adi = has_aux ? aux_data->adi : 0;
 
     type = BLE_LL_SCAN_ENTRY_TYPE_EXT(addr_type, has_aux, is_anon, adi);
+    bucket = ble_ll_scan_dup_bucket(type, addr);
 
-    TAILQ_FOREACH(e, &g_scan_dup_list, link) {
-        if ((e->type == type) &&
-            (is_anon || !memcmp(e->addr, addr, BLE_DEV_ADDR_LEN))) {
-            break;
-        }
-    }
-
+    e = ble_ll_scan_dup_find(bucket, type, addr);
     if (e) {
+#if MYNEWT_VAL(BLE_LL_SCAN_DUP_EXPIRY_MS)
+        ble_ll_scan_dup_check_expired(e);
+#endif
+
         if (e->adi != adi) {
             rc = 0;
 
@@ -2938,15 +3134,12 @@ ble_ll_scan_dup_check_ext(uint8_t addr_type, uint8_t *addr,
     } else {
         rc = 0;
 
-        e = ble_ll_scan_dup_new();
-        e->flags = 0;
+        e = ble_ll_scan_dup_new(bucket);
         e->type = type;
         e->adi = adi;
         if (!is_anon) {
             memcpy(e->addr, addr, 6);
         }
-
-        TAILQ_INSERT_HEAD(&g_scan_dup_list, e, link);
     }
 
     return rc;
@@ -3932,8 +4125,15 @@ ble_ll_scan_reset(void)
     g_ble_ll_scan_num_rsp_advs = 0;
     memset(&g_ble_ll_scan_rsp_advs[0], 0, sizeof(g_ble_ll_scan_rsp_advs));
 
-    os_mempool_clear(&g_scan_dup_pool);
-    TAILQ_INIT(&g_scan_dup_list);
+    ble_ll_scan_dup_clear();
+
+#if MYNEWT_VAL(BLE_LL_SCAN_RPT_COALESCE_MS)
+    ble_npl_callout_stop(&g_ble_ll_scan_rpt_timer);
+    if (g_ble_ll_scan_rpt_ev) {
+        ble_hci_trans_buf_free((uint8_t *)g_ble_ll_scan_rpt_ev);
+        g_ble_ll_scan_rpt_ev = NULL;
+    }
+#endif
 
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
     /* clear memory pool for AUX scan results */
@@ -3944,6 +4144,27 @@ ble_ll_scan_reset(void)
     ble_ll_scan_common_init();
 }
 
+void
+ble_ll_scan_dup_init(void)
+{
+    os_error_t err;
+
+    err = os_mempool_init(&g_scan_dup_pool,
+                          MYNEWT_VAL(BLE_LL_NUM_SCAN_DUP_ADVS),
+                          sizeof(struct ble_ll_scan_dup_entry),
+                          g_scan_dup_mem,
+                          "ble_ll_scan_dup_pool");
+    BLE_LL_ASSERT(err == 0);
+
+    TAILQ_INIT(&g_scan_dup_list);
+    memset(g_scan_dup_hash, 0, sizeof(g_scan_dup_hash));
+
+#if MYNEWT_VAL(BLE_LL_SCAN_DUP_EXPIRY_MS)
+    g_scan_dup_expiry_ticks =
+        os_cputime_usecs_to_ticks(MYNEWT_VAL(BLE_LL_SCAN_DUP_EXPIRY_MS) * 1000);
+#endif
+}
+
 /**
  * ble ll scan init
  *
@@ -3953,9 +4174,9 @@ ble_ll_scan_reset(void)
 void
 ble_ll_scan_init(void)
 {
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
     os_error_t err;
 
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
     err = os_mempool_init(&ext_scan_aux_pool,
                           MYNEWT_VAL(BLE_LL_EXT_ADV_AUX_PTR_CNT),
                           sizeof (struct ble_ll_aux_data),
@@ -3964,14 +4185,12 @@ ble_ll_scan_init(void)
     BLE_LL_ASSERT(err == 0);
 #endif
 
-    err = os_mempool_init(&g_scan_dup_pool,
-                          MYNEWT_VAL(BLE_LL_NUM_SCAN_DUP_ADVS),
-                          sizeof(struct ble_ll_scan_dup_entry),
-                          g_scan_dup_mem,
-                          "ble_ll_scan_dup_pool");
-    BLE_LL_ASSERT(err == 0);
+    ble_ll_scan_dup_init();
 
-    TAILQ_INIT(&g_scan_dup_list);
+#if MYNEWT_VAL(BLE_LL_SCAN_RPT_COALESCE_MS)
+    ble_npl_callout_init(&g_ble_ll_scan_rpt_timer, &g_ble_ll_data.ll_evq,
+                         ble_ll_scan_rpt_timer_cb, NULL);
+#endif
 
     ble_ll_scan_common_init();
 }
@@ -63,6 +63,179 @@ int32_t g_ble_ll_sched_max_early;
 /* Queue for timers */
 TAILQ_HEAD(ll_sched_qhead, ble_ll_sched_item) g_ble_ll_sched_q;
 
+#define BLE_LL_SCHED_SL_LEVELS  MYNEWT_VAL(BLE_LL_SCHED_SKIPLIST_LEVELS)
+
+#if BLE_LL_SCHED_SL_LEVELS
+/*
+ * Skip list index over the schedule queue. The queue itself stays the
+ * authoritative ordering; every schedule item is additionally linked on a
+ * random number of express levels so that the place where a new item has to
+ * go can be found without walking every scheduled item.
+ */
+static struct ble_ll_sched_item *g_ble_ll_sched_sl_head[BLE_LL_SCHED_SL_LEVELS];
+static uint32_t g_ble_ll_sched_sl_cntr;
+
+/*
+ * Picks the number of express levels for a new item. Counting trailing zeros
+ * of a running counter gives each item a 1/2 chance of being on the next
+ * level, like coin flipping does, but without using the random generator.
+ */
+static uint8_t
+ble_ll_sched_sl_height(void)
+{
+    uint32_t cntr;
+    uint8_t height;
+
+    cntr = ++g_ble_ll_sched_sl_cntr;
+    height = 0;
+    while (((cntr & 1) == 0) && (height < BLE_LL_SCHED_SL_LEVELS)) {
+        cntr >>= 1;
+        ++height;
+    }
+
+    return height;
+}
+
+/* Links an item which was just added to the schedule queue */
+static void
+ble_ll_sched_sl_link(struct ble_ll_sched_item *sch)
+{
+    int i;
+    struct ble_ll_sched_item *prev;
+    struct ble_ll_sched_item *next;
+
+    sch->sl_height = ble_ll_sched_sl_height();
+
+    prev = TAILQ_PREV(sch, ll_sched_qhead, link);
+    for (i = 0; i < sch->sl_height; ++i) {
+        /* Find closest preceding item on this level */
+        while (prev && (prev->sl_height <= i)) {
+            if (i == 0) {
+                prev = TAILQ_PREV(prev, ll_sched_qhead, link);
+            } else {
+                prev = prev->sl_prev[i - 1];
+            }
+        }
+
+        if (prev) {
+            next = prev->sl_next[i];
+            prev->sl_next[i] = sch;
+        } else {
+            next = g_ble_ll_sched_sl_head[i];
+            g_ble_ll_sched_sl_head[i] = sch;
+        }
+
+        if (next) {
+            next->sl_prev[i] = sch;
+        }
+
+        sch->sl_prev[i] = prev;
+        sch->sl_next[i] = next;
+    }
+}
+
+static void
+ble_ll_sched_sl_unlink(struct ble_ll_sched_item *sch)
+{
+    int i;
+
+    for (i = 0; i < sch->sl_height; ++i) {
+        if (sch->sl_prev[i]) {
+            sch->sl_prev[i]->sl_next[i] = sch->sl_next[i];
+        } else {
+            g_ble_ll_sched_sl_head[i] = sch->sl_next[i];
+        }
+
+        if (sch->sl_next[i]) {
+            sch->sl_next[i]->sl_prev[i] = sch->sl_prev[i];
+        }
+    }
+
+    sch->sl_height = 0;
+}
+#endif
+
+static void
+ble_ll_sched_q_insert_before(struct ble_ll_sched_item *entry,
+                             struct ble_ll_sched_item *sch)
+{
+    TAILQ_INSERT_BEFORE(entry, sch, link);
+#if BLE_LL_SCHED_SL_LEVELS
+    ble_ll_sched_sl_link(sch);
+#endif
+}
+
+static void
+ble_ll_sched_q_insert_head(struct ble_ll_sched_item *sch)
+{
+    TAILQ_INSERT_HEAD(&g_ble_ll_sched_q, sch, link);
+#if BLE_LL_SCHED_SL_LEVELS
+    ble_ll_sched_sl_link(sch);
+#endif
+}
+
+static void
+ble_ll_sched_q_insert_tail(struct ble_ll_sched_item *sch)
+{
+    TAILQ_INSERT_TAIL(&g_ble_ll_sched_q, sch, link);
+#if BLE_LL_SCHED_SL_LEVELS
+    ble_ll_sched_sl_link(sch);
+#endif
+}
+
+static void
+ble_ll_sched_q_remove(struct ble_ll_sched_item *sch)
+{
+#if BLE_LL_SCHED_SL_LEVELS
+    ble_ll_sched_sl_unlink(sch);
+#endif
+    TAILQ_REMOVE(&g_ble_ll_sched_q, sch, link);
+}
+
+/**
+ * Finds the first item in the schedule queue which ends after given time.
+ *
+ * Items in the schedule do not overlap so they are ordered by end time as
+ * well. All items which precede the returned one end before given time, thus
+ * they can neither overlap an item starting at that time nor be the place to
+ * insert it. Searching for a place for a new item can start at the returned
+ * item instead of the head of the queue.
+ *
+ * @param time  Start time of the item to be scheduled
+ *
+ * @return struct ble_ll_sched_item* First item ending after given time or
+ *                                   NULL if there is no such item.
+ */
+static struct ble_ll_sched_item *
+ble_ll_sched_q_find(uint32_t time)
+{
+    struct ble_ll_sched_item *entry;
+#if BLE_LL_SCHED_SL_LEVELS
+    struct ble_ll_sched_item *prev;
+    struct ble_ll_sched_item *next;
+    int i;
+
+    prev = NULL;
+    for (i = BLE_LL_SCHED_SL_LEVELS - 1; i >= 0; --i) {
+        next = prev ? prev->sl_next[i] : g_ble_ll_sched_sl_head[i];
+        while (next && CPUTIME_LEQ(next->end_time, time)) {
+            prev = next;
+            next = next->sl_next[i];
+        }
+    }
+
+    entry = prev ? TAILQ_NEXT(prev, link) : TAILQ_FIRST(&g_ble_ll_sched_q);
+#else
+    entry = TAILQ_FIRST(&g_ble_ll_sched_q);
+#endif
+
+    while (entry && CPUTIME_LEQ(entry->end_time, time)) {
+        entry = TAILQ_NEXT(entry, link);
+    }
+
+    return entry;
+}
+
 #if MYNEWT_VAL(BLE_LL_STRICT_CONN_SCHEDULING)
 struct ble_ll_sched_obj g_ble_ll_sched_data;
 #endif
@@ -128,7 +301,7 @@ ble_ll_sched_conn_overlap(struct ble_ll_sched_item *entry)
     if (entry->sched_type == BLE_LL_SCHED_TYPE_CONN) {
         connsm = (struct ble_ll_conn_sm *)entry->cb_arg;
         entry->enqueued = 0;
-        TAILQ_REMOVE(&g_ble_ll_sched_q, entry, link);
+        ble_ll_sched_q_remove(entry);
         ble_ll_event_send(&connsm->conn_ev_end);
         rc = 0;
     } else {
@@ -145,7 +318,7 @@ ble_ll_sched_insert_if_empty(struct ble_ll_sched_item *sch)
 
     entry = TAILQ_FIRST(&g_ble_ll_sched_q);
     if (!entry) {
-        TAILQ_INSERT_HEAD(&g_ble_ll_sched_q, sch, link);
+        ble_ll_sched_q_insert_head(sch);
         sch->enqueued = 1;
     }
     return entry;
@@ -196,7 +369,8 @@ ble_ll_sched_conn_reschedule(struct ble_ll_conn_sm *connsm)
     start_overlap = NULL;
     end_overlap = NULL;
     rc = 0;
-    TAILQ_FOREACH(entry, &g_ble_ll_sched_q, link) {
+    for (entry = ble_ll_sched_q_find(sch->start_time); entry;
+         entry = TAILQ_NEXT(entry, link)) {
         if (ble_ll_sched_is_overlap(sch, entry)) {
            if (entry->sched_type == BLE_LL_SCHED_TYPE_CONN &&
                             !ble_ll_conn_is_lru((struct ble_ll_conn_sm *)sch->cb_arg,
@@ -218,7 +392,7 @@ ble_ll_sched_conn_reschedule(struct ble_ll_conn_sm *connsm)
         } else {
             if ((int32_t)(sch->end_time - entry->start_time) <= 0) {
                 rc = 0;
-                TAILQ_INSERT_BEFORE(entry, sch, link);
+                ble_ll_sched_q_insert_before(entry, sch);
                 break;
             }
         }
@@ -226,7 +400,7 @@ ble_ll_sched_conn_reschedule(struct ble_ll_conn_sm *connsm)
 
     if (!rc) {
         if (!entry) {
-            TAILQ_INSERT_TAIL(&g_ble_ll_sched_q, sch, link);
+            ble_ll_sched_q_insert_tail(sch);
         }
         sch->enqueued = 1;
     }
@@ -261,7 +435,7 @@ ble_ll_sched_conn_reschedule(struct ble_ll_conn_sm *connsm)
             break;
         }
 
-        TAILQ_REMOVE(&g_ble_ll_sched_q, entry, link);
+        ble_ll_sched_q_remove(entry);
         entry->enqueued = 0;
 
         if (entry == end_overlap) {
@@ -462,7 +636,8 @@ ble_ll_sched_master_new(struct ble_ll_conn_sm *connsm,
         connsm->tx_win_off = MYNEWT_VAL(BLE_LL_CONN_INIT_MIN_WIN_OFFSET);
     } else {
         os_cputime_timer_stop(&g_ble_ll_sched_timer);
-        TAILQ_FOREACH(entry, &g_ble_ll_sched_q, link) {
+        for (entry = ble_ll_sched_q_find(sch->start_time); entry;
+             entry = TAILQ_NEXT(entry, link)) {
             /* Set these because overlap function needs them to be set */
             sch->start_time = earliest_start;
             sch->end_time = earliest_end;
@@ -471,7 +646,7 @@ ble_ll_sched_master_new(struct ble_ll_conn_sm *connsm,
             if ((int32_t)(sch->end_time - entry->start_time) <= 0) {
                 if ((earliest_start - initial_start) <= itvl_t) {
                     rc = 0;
-                    TAILQ_INSERT_BEFORE(entry, sch, link);
+                    ble_ll_sched_q_insert_before(entry, sch);
                 }
                 break;
             }
@@ -488,7 +663,7 @@ ble_ll_sched_master_new(struct ble_ll_conn_sm *connsm,
         if (!entry) {
             if ((earliest_start - initial_start) <= itvl_t) {
                 rc = 0;
-                TAILQ_INSERT_TAIL(&g_ble_ll_sched_q, sch, link);
+                ble_ll_sched_q_insert_tail(sch);
             }
         }
 
@@ -649,7 +824,8 @@ ble_ll_sched_master_new(struct ble_ll_conn_sm *connsm,
         connsm->tx_win_off = MYNEWT_VAL(BLE_LL_CONN_INIT_MIN_WIN_OFFSET);
     } else {
         os_cputime_timer_stop(&g_ble_ll_sched_timer);
-        TAILQ_FOREACH(entry, &g_ble_ll_sched_q, link) {
+        for (entry = ble_ll_sched_q_find(sch->start_time); entry;
+             entry = TAILQ_NEXT(entry, link)) {
             /* Set these because overlap function needs them to be set */
             sch->start_time = earliest_start;
             sch->end_time = earliest_end;
@@ -658,7 +834,7 @@ ble_ll_sched_master_new(struct ble_ll_conn_sm *connsm,
             if ((int32_t)(sch->end_time - entry->start_time) <= 0) {
                 if ((earliest_start - initial_start) <= itvl_t) {
                     rc = 0;
-                    TAILQ_INSERT_BEFORE(entry, sch, link);
+                    ble_ll_sched_q_insert_before(entry, sch);
                 }
                 break;
             }
@@ -675,7 +851,7 @@ ble_ll_sched_master_new(struct ble_ll_conn_sm *connsm,
         if (!entry) {
             if ((earliest_start - initial_start) <= itvl_t) {
                 rc = 0;
-                TAILQ_INSERT_TAIL(&g_ble_ll_sched_q, sch, link);
+                ble_ll_sched_q_insert_tail(sch);
             }
         }
 
@@ -767,12 +943,20 @@ ble_ll_sched_slave_new(struct ble_ll_conn_sm *connsm)
         first = 1;
     } else {
         os_cputime_timer_stop(&g_ble_ll_sched_timer);
+        entry = ble_ll_sched_q_find(sch->start_time);
         while (1) {
+            /* Insert at tail if none left to check */
+            if (!entry) {
+                rc = 0;
+                ble_ll_sched_q_insert_tail(sch);
+                break;
+            }
+
             next_sch = entry->link.tqe_next;
             /* Insert if event ends before next starts */
             if ((int32_t)(sch->end_time - entry->start_time) <= 0) {
                 rc = 0;
-                TAILQ_INSERT_BEFORE(entry, sch, link);
+                ble_ll_sched_q_insert_before(entry, sch);
                 break;
             }
 
@@ -785,13 +969,6 @@ ble_ll_sched_slave_new(struct ble_ll_conn_sm *connsm)
 
             /* Move to next entry */
             entry = next_sch;
-
-            /* Insert at tail if none left to check */
-            if (!entry) {
-                rc = 0;
-                TAILQ_INSERT_TAIL(&g_ble_ll_sched_q, sch, link);
-                break;
-            }
         }
 
         if (!rc) {
@@ -900,10 +1077,11 @@ ble_ll_sched_sync_reschedule(struct ble_ll_sched_item *sch,
     /* Try to find slot for sync scan. */
     os_cputime_timer_stop(&g_ble_ll_sched_timer);
 
-    TAILQ_FOREACH(entry, &g_ble_ll_sched_q, link) {
+    for (entry = ble_ll_sched_q_find(sch->start_time); entry;
+         entry = TAILQ_NEXT(entry, link)) {
         /* We can insert if before entry in list */
         if (CPUTIME_LEQ(sch->end_time, entry->start_time)) {
-            TAILQ_INSERT_BEFORE(entry, sch, link);
+            ble_ll_sched_q_insert_before(entry, sch);
             sch->enqueued = 1;
             break;
         }
@@ -918,7 +1096,7 @@ ble_ll_sched_sync_reschedule(struct ble_ll_sched_item *sch,
     }
 
     if (!entry) {
-        TAILQ_INSERT_TAIL(&g_ble_ll_sched_q, sch, link);
+        ble_ll_sched_q_insert_tail(sch);
         sch->enqueued = 1;
     }
 
@@ -983,10 +1161,11 @@ ble_ll_sched_sync(struct ble_ll_sched_item *sch,
 
     /* Try to find slot for scan. */
     os_cputime_timer_stop(&g_ble_ll_sched_timer);
-    TAILQ_FOREACH(entry, &g_ble_ll_sched_q, link) {
+    for (entry = ble_ll_sched_q_find(sch->start_time); entry;
+         entry = TAILQ_NEXT(entry, link)) {
         /* We can insert if before entry in list */
         if (CPUTIME_LEQ(sch->end_time, entry->start_time)) {
-            TAILQ_INSERT_BEFORE(entry, sch, link);
+            ble_ll_sched_q_insert_before(entry, sch);
             sch->enqueued = 1;
             break;
         }
@@ -1001,7 +1180,7 @@ ble_ll_sched_sync(struct ble_ll_sched_item *sch,
     }
 
     if (!entry) {
-        TAILQ_INSERT_TAIL(&g_ble_ll_sched_q, sch, link);
+        ble_ll_sched_q_insert_tail(sch);
         sch->enqueued = 1;
     }
 
@@ -1045,10 +1224,11 @@ ble_ll_sched_adv_new(struct ble_ll_sched_item *sch, ble_ll_sched_adv_new_cb cb,
     } else {
         /* XXX: no need to stop timer if not first on list. Modify code? */
         os_cputime_timer_stop(&g_ble_ll_sched_timer);
-        TAILQ_FOREACH(entry, &g_ble_ll_sched_q, link) {
+        for (entry = ble_ll_sched_q_find(sch->start_time); entry;
+             entry = TAILQ_NEXT(entry, link)) {
             /* We can insert if before entry in list */
             if ((int32_t)(sch->end_time - entry->start_time) <= 0) {
-                TAILQ_INSERT_BEFORE(entry, sch, link);
+                ble_ll_sched_q_insert_before(entry, sch);
                 break;
             }
 
@@ -1061,7 +1241,7 @@ ble_ll_sched_adv_new(struct ble_ll_sched_item *sch, ble_ll_sched_adv_new_cb cb,
         }
 
         if (!entry) {
-            TAILQ_INSERT_TAIL(&g_ble_ll_sched_q, sch, link);
+            ble_ll_sched_q_insert_tail(sch);
         }
         adv_start = sch->start_time;
 
@@ -1109,10 +1289,11 @@ ble_ll_sched_periodic_adv(struct ble_ll_sched_item *sch, uint32_t *start,
     } else {
         /* XXX: no need to stop timer if not first on list. Modify code? */
         os_cputime_timer_stop(&g_ble_ll_sched_timer);
-        TAILQ_FOREACH(entry, &g_ble_ll_sched_q, link) {
+        for (entry = ble_ll_sched_q_find(sch->start_time); entry;
+             entry = TAILQ_NEXT(entry, link)) {
             /* We can insert if before entry in list */
             if ((int32_t)(sch->end_time - entry->start_time) <= 0) {
-                TAILQ_INSERT_BEFORE(entry, sch, link);
+                ble_ll_sched_q_insert_before(entry, sch);
                 break;
             }
 
@@ -1130,7 +1311,7 @@ ble_ll_sched_periodic_adv(struct ble_ll_sched_item *sch, uint32_t *start,
         }
 
         if (!entry) {
-            TAILQ_INSERT_TAIL(&g_ble_ll_sched_q, sch, link);
+            ble_ll_sched_q_insert_tail(sch);
         }
         adv_start = sch->start_time;
 
@@ -1190,7 +1371,8 @@ ble_ll_sched_adv_reschedule(struct ble_ll_sched_item *sch, uint32_t *start,
     entry = ble_ll_sched_insert_if_empty(sch);
     if (entry) {
         os_cputime_timer_stop(&g_ble_ll_sched_timer);
-        while (1) {
+        entry = ble_ll_sched_q_find(sch->start_time);
+        while (entry) {
             next_sch = entry->link.tqe_next;
             if (ble_ll_sched_is_overlap(sch, entry)) {
                 if (start_overlap == NULL) {
@@ -1207,9 +1389,6 @@ ble_ll_sched_adv_reschedule(struct ble_ll_sched_item *sch, uint32_t *start,
             }
 
             entry = next_sch;
-            if (entry == NULL) {
-                break;
-            }
         }
 
         /*
@@ -1218,9 +1397,9 @@ ble_ll_sched_adv_reschedule(struct ble_ll_sched_item *sch, uint32_t *start,
          */
         if (start_overlap == NULL) {
             if (before) {
-                TAILQ_INSERT_BEFORE(before, sch, link);
+                ble_ll_sched_q_insert_before(before, sch);
             } else {
-                TAILQ_INSERT_TAIL(&g_ble_ll_sched_q, sch, link);
+                ble_ll_sched_q_insert_tail(sch);
             }
         } else {
             /*
@@ -1236,7 +1415,7 @@ ble_ll_sched_adv_reschedule(struct ble_ll_sched_item *sch, uint32_t *start,
                 if ((int32_t)(sch->end_time - entry->start_time) <= 0) {
                     rand_ticks = entry->start_time - sch->end_time;
                     before = entry;
-                    TAILQ_INSERT_BEFORE(before, sch, link);
+                    ble_ll_sched_q_insert_before(before, sch);
                     break;
                 } else {
                     sch->start_time = entry->end_time;
@@ -1250,9 +1429,9 @@ ble_ll_sched_adv_reschedule(struct ble_ll_sched_item *sch, uint32_t *start,
                         rc = -1;
                     } else {
                         if (next_sch == NULL) {
-                            TAILQ_INSERT_TAIL(&g_ble_ll_sched_q, sch, link);
+                            ble_ll_sched_q_insert_tail(sch);
                         } else {
-                            TAILQ_INSERT_BEFORE(next_sch, sch, link);
+                            ble_ll_sched_q_insert_before(next_sch, sch);
                         }
                     }
                     break;
@@ -1306,7 +1485,7 @@ ble_ll_sched_adv_resched_pdu(struct ble_ll_sched_item *sch)
             goto adv_resched_pdu_fail;
         }
         os_cputime_timer_stop(&g_ble_ll_sched_timer);
-        TAILQ_INSERT_BEFORE(entry, sch, link);
+        ble_ll_sched_q_insert_before(entry, sch);
         sch->enqueued = 1;
     }
 
@@ -1346,7 +1525,7 @@ ble_ll_sched_rmv_elem(struct ble_ll_sched_item *sch)
             os_cputime_timer_stop(&g_ble_ll_sched_timer);
         }
 
-        TAILQ_REMOVE(&g_ble_ll_sched_q, sch, link);
+        ble_ll_sched_q_remove(sch);
         sch->enqueued = 0;
         rc = 0;
 
@@ -1385,7 +1564,7 @@ ble_ll_sched_rmv_elem_type(uint8_t type, sched_remove_cb_func remove_cb)
                 first = NULL;
             }
 
-            TAILQ_REMOVE(&g_ble_ll_sched_q, entry, link);
+            ble_ll_sched_q_remove(entry);
             remove_cb(entry);
             entry->enqueued = 0;
         }
@@ -1508,7 +1687,7 @@ ble_ll_sched_run(void *arg)
 #endif
 
         /* Remove schedule item and execute the callback */
-        TAILQ_REMOVE(&g_ble_ll_sched_q, sch, link);
+        ble_ll_sched_q_remove(sch);
         sch->enqueued = 0;
         ble_ll_sched_execute_item(sch);
 
@@ -1593,7 +1772,7 @@ ble_ll_sched_scan_req_over_aux_ptr(uint32_t chan, uint8_t phy_mode)
         }
 
         ble_ll_scan_end_adv_evt((struct ble_ll_aux_data *)sch->cb_arg);
-        TAILQ_REMOVE(&g_ble_ll_sched_q, sch, link);
+        ble_ll_sched_q_remove(sch);
         sch->enqueued = 0;
         sch = TAILQ_FIRST(&g_ble_ll_sched_q);
     }
@@ -1668,11 +1847,12 @@ ble_ll_sched_aux_scan(struct ble_mbuf_hdr *ble_hdr,
 
     /* Try to find slot for aux scan. */
     os_cputime_timer_stop(&g_ble_ll_sched_timer);
-    TAILQ_FOREACH(entry, &g_ble_ll_sched_q, link) {
+    for (entry = ble_ll_sched_q_find(sch->start_time); entry;
+         entry = TAILQ_NEXT(entry, link)) {
         /* We can insert if before entry in list */
         if ((int32_t)(sch->end_time - entry->start_time) <= 0) {
             rc = 0;
-            TAILQ_INSERT_BEFORE(entry, sch, link);
+            ble_ll_sched_q_insert_before(entry, sch);
             sch->enqueued = 1;
             break;
         }
@@ -1687,7 +1867,7 @@ ble_ll_sched_aux_scan(struct ble_mbuf_hdr *ble_hdr,
 
     if (!entry) {
         rc = 0;
-        TAILQ_INSERT_TAIL(&g_ble_ll_sched_q, sch, link);
+        ble_ll_sched_q_insert_tail(sch);
         sch->enqueued = 1;
     }
 
@@ -1734,11 +1914,12 @@ int ble_ll_sched_dtm(struct ble_ll_sched_item *sch)
 
     /* Try to find slot for test. */
     os_cputime_timer_stop(&g_ble_ll_sched_timer);
-    TAILQ_FOREACH(entry, &g_ble_ll_sched_q, link) {
+    for (entry = ble_ll_sched_q_find(sch->start_time); entry;
+         entry = TAILQ_NEXT(entry, link)) {
         /* We can insert if before entry in list */
         if (sch->end_time <= entry->start_time) {
             rc = 0;
-            TAILQ_INSERT_BEFORE(entry, sch, link);
+            ble_ll_sched_q_insert_before(entry, sch);
             sch->enqueued = 1;
             break;
         }
@@ -1754,7 +1935,7 @@ int ble_ll_sched_dtm(struct ble_ll_sched_item *sch)
 
     if (!entry) {
         rc = 0;
-        TAILQ_INSERT_TAIL(&g_ble_ll_sched_q, sch, link);
+        ble_ll_sched_q_insert_tail(sch);
         sch->enqueued = 1;
     }
 
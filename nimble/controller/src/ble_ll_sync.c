@@ -74,6 +74,9 @@ struct ble_ll_sync_sm {
     uint8_t sca;
     uint8_t chanmap[BLE_LL_SYNC_CHMAP_LEN];
     uint8_t num_used_chans;
+#if MYNEWT_VAL(BLE_LL_CHAN_REMAP_TABLE)
+    uint8_t chan_remap[BLE_PHY_NUM_DATA_CHANS];
+#endif
 
     uint8_t chan_index;
     uint8_t chan_chain;
@@ -210,6 +213,19 @@ ble_ll_sync_sm_clear(struct ble_ll_sync_sm *sm)
     memset(sm, 0, sizeof(*sm));
 }
 
+static uint8_t
+ble_ll_sync_calc_chan_index(struct ble_ll_sync_sm *sm)
+{
+#if MYNEWT_VAL(BLE_LL_CHAN_REMAP_TABLE)
+    return ble_ll_utils_calc_dci_csa2_table(sm->event_cntr, sm->channel_id,
+                                            sm->num_used_chans, sm->chanmap,
+                                            sm->chan_remap);
+#else
+    return ble_ll_utils_calc_dci_csa2(sm->event_cntr, sm->channel_id,
+                                      sm->num_used_chans, sm->chanmap);
+#endif
+}
+
 static uint8_t
 ble_ll_sync_phy_mode_to_hci(int8_t phy_mode)
 {
@@ -1132,8 +1148,7 @@ ble_ll_sync_next_event(struct ble_ll_sync_sm *sm, uint32_t cur_ww_adjust)
     sm->event_cntr += 1 + skip;
 
     /* Calculate channel index of next event */
-    sm->chan_index = ble_ll_utils_calc_dci_csa2(sm->event_cntr, sm->channel_id,
-                                                sm->num_used_chans, sm->chanmap);
+    sm->chan_index = ble_ll_sync_calc_chan_index(sm);
 
     cur_ww = ble_ll_utils_calc_window_widening(sm->anchor_point,
                                                sm->last_anchor_point,
@@ -1350,6 +1365,9 @@ ble_ll_sync_info_event(const uint8_t *addr, uint8_t addr_type, int rpa_index,
     sm->chanmap[3] = syncinfo[7];
     sm->chanmap[4] = syncinfo[8] & 0x1f;
     sm->num_used_chans = ble_ll_utils_calc_num_used_chans(sm->chanmap);
+#if MYNEWT_VAL(BLE_LL_CHAN_REMAP_TABLE)
+    ble_ll_utils_calc_remap_table(sm->chanmap, sm->chan_remap);
+#endif
 
     /* SCA (3 bits) */
     sm->sca = syncinfo[8] >> 5;
@@ -1380,8 +1398,7 @@ ble_ll_sync_info_event(const uint8_t *addr, uint8_t addr_type, int rpa_index,
     sm->window_widening = BLE_LL_JITTER_USECS;
 
     /* Calculate channel index of first event */
-    sm->chan_index = ble_ll_utils_calc_dci_csa2(sm->event_cntr, sm->channel_id,
-                                                sm->num_used_chans, sm->chanmap);
+    sm->chan_index = ble_ll_sync_calc_chan_index(sm);
 
     sm->sch.sched_cb = ble_ll_sync_event_start_cb;
     sm->sch.cb_arg = sm;
@@ -1910,6 +1927,9 @@ ble_ll_sync_periodic_ind(struct ble_ll_conn_sm *connsm,
     sm->chanmap[3] = syncinfo[7];
     sm->chanmap[4] = syncinfo[8] & 0x1f;
     sm->num_used_chans = ble_ll_utils_calc_num_used_chans(sm->chanmap);
+#if MYNEWT_VAL(BLE_LL_CHAN_REMAP_TABLE)
+    ble_ll_utils_calc_remap_table(sm->chanmap, sm->chan_remap);
+#endif
 
     /* SCA (3 bits) */
     sm->sca = syncinfo[8] >> 5;
@@ -1936,8 +1956,7 @@ ble_ll_sync_periodic_ind(struct ble_ll_conn_sm *connsm,
     sm->phy_mode = phy_mode;
 
     /* Calculate channel index of first event */
-    sm->chan_index = ble_ll_utils_calc_dci_csa2(sm->event_cntr, sm->channel_id,
-                                                sm->num_used_chans, sm->chanmap);
+    sm->chan_index = ble_ll_sync_calc_chan_index(sm);
 
     sm->sch.sched_cb = ble_ll_sync_event_start_cb;
     sm->sch.cb_arg = sm;
@@ -180,6 +180,28 @@ ble_ll_utils_remapped_channel(uint8_t remap_index, const uint8_t *chanmap)
     return 0;
 }
 
+/**
+ * Builds table mapping remapping index to data channel index for given
+ * channel map, i.e. lists used channels in ascending order. With this table
+ * a channel can be remapped without scanning the channel map.
+ *
+ * @param chanmap       Channel map
+ * @param remap_table   Table to fill; shall hold BLE_PHY_NUM_DATA_CHANS entries
+ */
+void
+ble_ll_utils_calc_remap_table(const uint8_t *chanmap, uint8_t *remap_table)
+{
+    uint8_t chan;
+    uint8_t cntr;
+
+    cntr = 0;
+    for (chan = 0; chan < BLE_PHY_NUM_DATA_CHANS; chan++) {
+        if (chanmap[chan >> 3] & (1 << (chan & 0x07))) {
+            remap_table[cntr++] = chan;
+        }
+    }
+}
+
 uint8_t
 ble_ll_utils_calc_num_used_chans(const uint8_t *chmap)
 {
@@ -213,18 +235,12 @@ ble_ll_utils_calc_num_used_chans(const uint8_t *chmap)
 static uint16_t
 ble_ll_utils_csa2_perm(uint16_t in)
 {
-    uint16_t out = 0;
-    int i;
-
-    for (i = 0; i < 8; i++) {
-        out |= ((in >> i) & 0x00000001) << (7 - i);
-    }
-
-    for (i = 8; i < 16; i++) {
-        out |= ((in >> i) & 0x00000001) << (15 + 8 - i);
-    }
+    /* Reverse bit order in each byte */
+    in = ((in & 0xaaaa) >> 1) | ((in & 0x5555) << 1);
+    in = ((in & 0xcccc) >> 2) | ((in & 0x3333) << 2);
+    in = ((in & 0xf0f0) >> 4) | ((in & 0x0f0f) << 4);
 
-    return out;
+    return in;
 }
 
 static uint16_t
@@ -248,9 +264,10 @@ ble_ll_utils_csa2_prng(uint16_t counter, uint16_t ch_id)
     return prn_e;
 }
 
-uint8_t
-ble_ll_utils_calc_dci_csa2(uint16_t event_cntr, uint16_t channel_id,
-                           uint8_t num_used_chans, const uint8_t *chanmap)
+static uint8_t
+ble_ll_utils_csa2_calc(uint16_t event_cntr, uint16_t channel_id,
+                       uint8_t num_used_chans, const uint8_t *chanmap,
+                       const uint8_t *remap_table)
 {
     uint16_t channel_unmapped;
     uint8_t remap_index;
@@ -273,8 +290,33 @@ ble_ll_utils_calc_dci_csa2(uint16_t event_cntr, uint16_t channel_id,
 
     remap_index = (num_used_chans * prn_e) / 0x10000;
 
+    if (remap_table) {
+        return remap_table[remap_index];
+    }
+
     return ble_ll_utils_remapped_channel(remap_index, chanmap);
 }
+
+uint8_t
+ble_ll_utils_calc_dci_csa2(uint16_t event_cntr, uint16_t channel_id,
+                           uint8_t num_used_chans, const uint8_t *chanmap)
+{
+    return ble_ll_utils_csa2_calc(event_cntr, channel_id, num_used_chans,
+                                  chanmap, NULL);
+}
+
+/**
+ * Same as ble_ll_utils_calc_dci_csa2() but uses remapping table built with
+ * ble_ll_utils_calc_remap_table() instead of scanning the channel map.
+ */
+uint8_t
+ble_ll_utils_calc_dci_csa2_table(uint16_t event_cntr, uint16_t channel_id,
+                                 uint8_t num_used_chans, const uint8_t *chanmap,
+                                 const uint8_t *remap_table)
+{
+    return ble_ll_utils_csa2_calc(event_cntr, channel_id, num_used_chans,
+                                  chanmap, remap_table);
+}
 #endif
 
 uint32_t
@@ -30,20 +30,31 @@
 #include "controller/ble_ll_scan.h"
 #include "controller/ble_hw.h"
 
-#if (MYNEWT_VAL(BLE_LL_WHITELIST_SIZE) < BLE_HW_WHITE_LIST_SIZE)
-#define BLE_LL_WHITELIST_SIZE       MYNEWT_VAL(BLE_LL_WHITELIST_SIZE)
-#else
+/* Whitelist size is limited by HW only if HW whitelist is used */
+#if (BLE_USES_HW_WHITELIST == 1) && \
+    (MYNEWT_VAL(BLE_LL_WHITELIST_SIZE) > BLE_HW_WHITE_LIST_SIZE)
 #define BLE_LL_WHITELIST_SIZE       BLE_HW_WHITE_LIST_SIZE
+#else
+#define BLE_LL_WHITELIST_SIZE       MYNEWT_VAL(BLE_LL_WHITELIST_SIZE)
+#endif
+
+#if BLE_LL_WHITELIST_SIZE > UINT8_MAX
+#error "BLE_LL_WHITELIST_SIZE shall not be greater than 255"
 #endif
 
 struct ble_ll_whitelist_entry
 {
-    uint8_t wl_valid;
     uint8_t wl_addr_type;
     uint8_t wl_dev_addr[BLE_DEV_ADDR_LEN];
 };
 
+/*
+ * Whitelist entries are kept sorted by address type and address (see
+ * ble_ll_whitelist_cmp()) so that lookups done from ISR context can use
+ * binary search. Only the first g_ble_ll_whitelist_cnt entries are valid.
+ */
 struct ble_ll_whitelist_entry g_ble_ll_whitelist[BLE_LL_WHITELIST_SIZE];
+static uint8_t g_ble_ll_whitelist_cnt;
 
 static int
 ble_ll_whitelist_chg_allowed(void)
@@ -64,6 +75,61 @@ ble_ll_whitelist_chg_allowed(void)
     return rc;
 }
 
+static int
+ble_ll_whitelist_cmp(const struct ble_ll_whitelist_entry *wl,
+                     const uint8_t *addr, uint8_t addr_type)
+{
+    if (wl->wl_addr_type != addr_type) {
+        return wl->wl_addr_type < addr_type ? -1 : 1;
+    }
+
+    return memcmp(wl->wl_dev_addr, addr, BLE_DEV_ADDR_LEN);
+}
+
+/**
+ * Finds position at which the address is (or shall be inserted) in the
+ * whitelist.
+ *
+ * Worst case this takes ceil(log2(BLE_LL_WHITELIST_SIZE + 1)) comparisons,
+ * i.e. 4 for a whitelist of 8 entries and 8 for 255 entries.
+ *
+ * @param addr      Device or identity address to look for.
+ * @param addr_type Public address (0) or random address (1)
+ * @param found     Set to 1 if address is on whitelist, 0 otherwise.
+ *
+ * @return int Index of the matching entry, or index of the first entry
+ *             greater than the address if there is no match.
+ */
+static int
+ble_ll_whitelist_bsearch(const uint8_t *addr, uint8_t addr_type, int *found)
+{
+    int lo;
+    int hi;
+    int mid;
+    int rc;
+
+    lo = 0;
+    hi = g_ble_ll_whitelist_cnt;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        rc = ble_ll_whitelist_cmp(&g_ble_ll_whitelist[mid], addr, addr_type);
+        if (rc == 0) {
+            *found = 1;
+            return mid;
+        }
+
+        if (rc < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    *found = 0;
+    return lo;
+}
+
 /**
  * Clear the whitelist.
  *
@@ -72,20 +138,13 @@ ble_ll_whitelist_chg_allowed(void)
 int
 ble_ll_whitelist_clear(void)
 {
-    int i;
-    struct ble_ll_whitelist_entry *wl;
-
     /* Check proper state */
     if (!ble_ll_whitelist_chg_allowed()) {
         return BLE_ERR_CMD_DISALLOWED;
     }
 
     /* Set the number of entries to 0 */
-    wl = &g_ble_ll_whitelist[0];
-    for (i = 0; i < BLE_LL_WHITELIST_SIZE; ++i) {
-        wl->wl_valid = 0;
-        ++wl;
-    }
+    g_ble_ll_whitelist_cnt = 0;
 
 #if (BLE_USES_HW_WHITELIST == 1)
     ble_hw_whitelist_clear();
@@ -129,19 +188,12 @@ ble_ll_whitelist_read_size(uint8_t *rspbuf, uint8_t *rsplen)
 static int
 ble_ll_whitelist_search(const uint8_t *addr, uint8_t addr_type)
 {
+    int found;
     int i;
-    struct ble_ll_whitelist_entry *wl;
 
-    wl = &g_ble_ll_whitelist[0];
-    for (i = 0; i < BLE_LL_WHITELIST_SIZE; ++i) {
-        if ((wl->wl_valid) && (wl->wl_addr_type == addr_type) &&
-            (!memcmp(&wl->wl_dev_addr[0], addr, BLE_DEV_ADDR_LEN))) {
-            return i + 1;
-        }
-        ++wl;
-    }
+    i = ble_ll_whitelist_bsearch(addr, addr_type, &found);
 
-    return 0;
+    return found ? i + 1 : 0;
 }
 
 /**
@@ -188,6 +240,7 @@ ble_ll_whitelist_add(const uint8_t *cmdbuf, uint8_t len)
 {
     const struct ble_hci_le_add_whte_list_cp *cmd = (const void *) cmdbuf;
     struct ble_ll_whitelist_entry *wl;
+    int found;
     int rc;
     int i;
 
@@ -200,27 +253,26 @@ ble_ll_whitelist_add(const uint8_t *cmdbuf, uint8_t len)
         return BLE_ERR_CMD_DISALLOWED;
     }
 
-    /* Check if we have any open entries */
     rc = BLE_ERR_SUCCESS;
-    if (!ble_ll_whitelist_search(cmd->addr, cmd->addr_type)) {
-        wl = &g_ble_ll_whitelist[0];
-        for (i = 0; i < BLE_LL_WHITELIST_SIZE; ++i) {
-            if (wl->wl_valid == 0) {
-                memcpy(&wl->wl_dev_addr[0], cmd->addr, BLE_DEV_ADDR_LEN);
-                wl->wl_addr_type = cmd->addr_type;
-                wl->wl_valid = 1;
-                break;
-            }
-            ++wl;
+    i = ble_ll_whitelist_bsearch(cmd->addr, cmd->addr_type, &found);
+    if (!found) {
+        /* Check if we have any open entries */
+        if (g_ble_ll_whitelist_cnt == BLE_LL_WHITELIST_SIZE) {
+            return BLE_ERR_MEM_CAPACITY;
         }
 
-        if (i == BLE_LL_WHITELIST_SIZE) {
-            rc = BLE_ERR_MEM_CAPACITY;
-        } else {
+        /* Keep list sorted */
+        memmove(&g_ble_ll_whitelist[i + 1], &g_ble_ll_whitelist[i],
+                (g_ble_ll_whitelist_cnt - i) * sizeof(g_ble_ll_whitelist[0]));
+
+        wl = &g_ble_ll_whitelist[i];
+        memcpy(&wl->wl_dev_addr[0], cmd->addr, BLE_DEV_ADDR_LEN);
+        wl->wl_addr_type = cmd->addr_type;
+        g_ble_ll_whitelist_cnt++;
+
 #if (BLE_USES_HW_WHITELIST == 1)
-            rc = ble_hw_whitelist_add(cmd->addr, cmd->addr_type);
+        rc = ble_hw_whitelist_add(cmd->addr, cmd->addr_type);
 #endif
-        }
     }
 
     return rc;
@@ -250,7 +302,11 @@ ble_ll_whitelist_rmv(const uint8_t *cmdbuf, uint8_t len)
 
     position = ble_ll_whitelist_search(cmd->addr, cmd->addr_type);
     if (position) {
-        g_ble_ll_whitelist[position - 1].wl_valid = 0;
+        memmove(&g_ble_ll_whitelist[position - 1],
+                &g_ble_ll_whitelist[position],
+                (g_ble_ll_whitelist_cnt - position) *
+                sizeof(g_ble_ll_whitelist[0]));
+        g_ble_ll_whitelist_cnt--;
     }
 
 #if (BLE_USES_HW_WHITELIST == 1)
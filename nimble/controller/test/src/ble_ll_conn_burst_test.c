@@ -0,0 +1,206 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "syscfg/syscfg.h"
+#include "testutil/testutil.h"
+#include "os/os.h"
+#include "os/os_cputime.h"
+#include "nimble/ble.h"
+#include "controller/ble_ll.h"
+#include "controller/ble_ll_conn.h"
+#include "ble_ll_conn_burst_test.h"
+
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+
+#define BLE_LL_CONN_BURST_TEST_ITVL_USECS   (100000)
+#define BLE_LL_CONN_BURST_TEST_MIN_TICKS    (10)
+#define BLE_LL_CONN_BURST_TEST_PKTS         (64)
+/* Effective max tx octets; the minimum data length */
+#define BLE_LL_CONN_BURST_TEST_DATA_LEN     (27)
+
+static struct ble_ll_conn_sm ble_ll_conn_burst_test_connsm;
+static struct os_mbuf_pkthdr
+    ble_ll_conn_burst_test_pkts[BLE_LL_CONN_BURST_TEST_PKTS];
+
+static struct ble_ll_conn_sm *
+ble_ll_conn_burst_test_util_init(int phy_mode)
+{
+    struct ble_ll_conn_sm *connsm = &ble_ll_conn_burst_test_connsm;
+
+    memset(connsm, 0, sizeof(*connsm));
+    STAILQ_INIT(&connsm->conn_txq);
+    connsm->conn_itvl_ticks =
+        os_cputime_usecs_to_ticks(BLE_LL_CONN_BURST_TEST_ITVL_USECS);
+    connsm->eff_max_tx_octets = BLE_LL_CONN_BURST_TEST_DATA_LEN;
+#if BLE_LL_BT5_PHY_SUPPORTED
+    connsm->phy_data.tx_phy_mode = phy_mode;
+    connsm->phy_data.rx_phy_mode = phy_mode;
+#endif
+
+    return connsm;
+}
+
+/* Queues num packets of len bytes */
+static void
+ble_ll_conn_burst_test_util_queue(struct ble_ll_conn_sm *connsm, int num,
+                                  uint16_t len)
+{
+    struct os_mbuf_pkthdr *pkthdr;
+    int i;
+
+    TEST_ASSERT_FATAL(num <= BLE_LL_CONN_BURST_TEST_PKTS);
+
+    for (i = 0; i < num; i++) {
+        pkthdr = &ble_ll_conn_burst_test_pkts[i];
+        memset(pkthdr, 0, sizeof(*pkthdr));
+        pkthdr->omp_len = len;
+        STAILQ_INSERT_TAIL(&connsm->conn_txq, pkthdr, omp_next);
+    }
+}
+
+/* Time to send one PDU of len bytes and receive an empty PDU in response */
+static uint32_t
+ble_ll_conn_burst_test_util_pdu_usecs(uint16_t len, int phy_mode)
+{
+    return ble_ll_pdu_tx_time_get(len, phy_mode) + BLE_LL_IFS +
+           ble_ll_pdu_tx_time_get(0, phy_mode) + BLE_LL_IFS;
+}
+
+TEST_CASE_SELF(ble_ll_conn_burst_test_case_reservation)
+{
+    struct ble_ll_conn_sm *connsm;
+    uint32_t usecs;
+    uint32_t ticks;
+
+    connsm = ble_ll_conn_burst_test_util_init(BLE_PHY_MODE_1M);
+
+    /* Nothing queued; the default reservation is kept */
+    ticks = ble_ll_conn_burst_ticks(connsm, BLE_LL_CONN_BURST_TEST_MIN_TICKS);
+    TEST_ASSERT(ticks == BLE_LL_CONN_BURST_TEST_MIN_TICKS);
+
+    /*
+     * Ten packets of twice the data length; each takes two PDUs, so the
+     * burst extends past the default reservation.
+     */
+    ble_ll_conn_burst_test_util_queue(connsm, 10,
+                                      2 * BLE_LL_CONN_BURST_TEST_DATA_LEN);
+    usecs = 20 * ble_ll_conn_burst_test_util_pdu_usecs(
+                                    BLE_LL_CONN_BURST_TEST_DATA_LEN,
+                                    BLE_PHY_MODE_1M);
+    ticks = ble_ll_conn_burst_ticks(connsm, BLE_LL_CONN_BURST_TEST_MIN_TICKS);
+    TEST_ASSERT(ticks == os_cputime_usecs_to_ticks(usecs));
+    TEST_ASSERT(ticks > BLE_LL_CONN_BURST_TEST_MIN_TICKS);
+
+    /* A larger default reservation is not shrunk */
+    TEST_ASSERT(ble_ll_conn_burst_ticks(connsm, ticks + 1) == ticks + 1);
+}
+
+#if BLE_LL_BT5_PHY_SUPPORTED
+TEST_CASE_SELF(ble_ll_conn_burst_test_case_phy)
+{
+    struct ble_ll_conn_sm *connsm;
+    uint32_t ticks_1m;
+    uint32_t ticks_2m;
+    uint32_t usecs;
+
+    connsm = ble_ll_conn_burst_test_util_init(BLE_PHY_MODE_1M);
+    ble_ll_conn_burst_test_util_queue(connsm, 10,
+                                      BLE_LL_CONN_BURST_TEST_DATA_LEN);
+    ticks_1m = ble_ll_conn_burst_ticks(connsm, 0);
+
+    connsm = ble_ll_conn_burst_test_util_init(BLE_PHY_MODE_2M);
+    ble_ll_conn_burst_test_util_queue(connsm, 10,
+                                      BLE_LL_CONN_BURST_TEST_DATA_LEN);
+    ticks_2m = ble_ll_conn_burst_ticks(connsm, 0);
+
+    usecs = 10 * ble_ll_conn_burst_test_util_pdu_usecs(
+                                    BLE_LL_CONN_BURST_TEST_DATA_LEN,
+                                    BLE_PHY_MODE_2M);
+    TEST_ASSERT(ticks_2m == os_cputime_usecs_to_ticks(usecs));
+    TEST_ASSERT(ticks_2m < ticks_1m);
+}
+#endif
+
+TEST_CASE_SELF(ble_ll_conn_burst_test_case_cap)
+{
+    struct ble_ll_conn_sm *connsm;
+    uint32_t ticks;
+
+    /* Far more data than fits; capped at half of the connection interval */
+    connsm = ble_ll_conn_burst_test_util_init(BLE_PHY_MODE_1M);
+    ble_ll_conn_burst_test_util_queue(connsm, BLE_LL_CONN_BURST_TEST_PKTS,
+                                      4 * BLE_LL_CONN_BURST_TEST_DATA_LEN);
+    ticks = ble_ll_conn_burst_ticks(connsm, BLE_LL_CONN_BURST_TEST_MIN_TICKS);
+    TEST_ASSERT(ticks == connsm->conn_itvl_ticks / 2);
+
+    /* A shorter maximum event length caps it further */
+    connsm->max_event_ticks = connsm->conn_itvl_ticks / 4;
+    ticks = ble_ll_conn_burst_ticks(connsm, BLE_LL_CONN_BURST_TEST_MIN_TICKS);
+    TEST_ASSERT(ticks == connsm->conn_itvl_ticks / 4);
+
+    /* But never below the default reservation */
+    connsm->max_event_ticks = BLE_LL_CONN_BURST_TEST_MIN_TICKS / 2;
+    ticks = ble_ll_conn_burst_ticks(connsm, BLE_LL_CONN_BURST_TEST_MIN_TICKS);
+    TEST_ASSERT(ticks == BLE_LL_CONN_BURST_TEST_MIN_TICKS);
+}
+
+TEST_CASE_SELF(ble_ll_conn_burst_test_case_cutoff)
+{
+    struct ble_ll_conn_sm *connsm;
+    uint32_t ce_end;
+    uint32_t limit;
+
+    connsm = ble_ll_conn_burst_test_util_init(BLE_PHY_MODE_1M);
+    connsm->anchor_point = 1000;
+    ce_end = connsm->anchor_point + connsm->conn_itvl_ticks;
+
+    /* No limit; the event may run until the next scheduled item */
+    TEST_ASSERT(ble_ll_conn_burst_end_time(connsm, ce_end) == ce_end);
+
+    /* The limit cuts the event short, counted from the anchor point */
+    connsm->max_event_ticks = connsm->conn_itvl_ticks / 4;
+    limit = connsm->anchor_point + connsm->max_event_ticks;
+    TEST_ASSERT(ble_ll_conn_burst_end_time(connsm, ce_end) == limit);
+
+    /* An earlier scheduled item still takes precedence */
+    TEST_ASSERT(ble_ll_conn_burst_end_time(connsm, limit - 1) == limit - 1);
+
+    /* Limit past the cputime wrap */
+    connsm->anchor_point = UINT32_MAX - connsm->max_event_ticks / 2;
+    ce_end = connsm->anchor_point + connsm->conn_itvl_ticks;
+    limit = connsm->anchor_point + connsm->max_event_ticks;
+    TEST_ASSERT(limit < connsm->anchor_point);
+    TEST_ASSERT(ble_ll_conn_burst_end_time(connsm, ce_end) == limit);
+}
+
+#endif
+
+TEST_SUITE(ble_ll_conn_burst_test_suite)
+{
+#if MYNEWT_VAL(BLE_LL_CONN_ADAPTIVE_BURST)
+    ble_ll_conn_burst_test_case_reservation();
+#if BLE_LL_BT5_PHY_SUPPORTED
+    ble_ll_conn_burst_test_case_phy();
+#endif
+    ble_ll_conn_burst_test_case_cap();
+    ble_ll_conn_burst_test_case_cutoff();
+#endif
+}
@@ -17,11 +17,15 @@
  * under the License.
  */
 
+#include <stdio.h>
 #include <stddef.h>
 #include <string.h>
+#include "syscfg/syscfg.h"
 #include "testutil/testutil.h"
+#include "os/os_cputime.h"
 #include "controller/ble_ll_test.h"
 #include "controller/ble_ll_conn.h"
+#include "controller/ble_ll_utils.h"
 #include "ble_ll_csa2_test.h"
 
 TEST_CASE_SELF(ble_ll_csa2_test_1)
@@ -52,6 +56,9 @@ TEST_CASE_SELF(ble_ll_csa2_test_1)
     conn.chanmap[2] = 0xff;
     conn.chanmap[3] = 0xff;
     conn.chanmap[4] = 0x1f;
+#if MYNEWT_VAL(BLE_LL_CHAN_REMAP_TABLE)
+    ble_ll_utils_calc_remap_table(conn.chanmap, conn.chan_remap);
+#endif
 
     conn.event_cntr = 1;
     rc = ble_ll_conn_calc_dci(&conn, 0);
@@ -94,6 +101,9 @@ TEST_CASE_SELF(ble_ll_csa2_test_2)
     conn.chanmap[2] = 0xe0;
     conn.chanmap[3] = 0x00;
     conn.chanmap[4] = 0x1e;
+#if MYNEWT_VAL(BLE_LL_CHAN_REMAP_TABLE)
+    ble_ll_utils_calc_remap_table(conn.chanmap, conn.chan_remap);
+#endif
 
     conn.event_cntr = 6;
     rc = ble_ll_conn_calc_dci(&conn, 0);
@@ -108,8 +118,97 @@ TEST_CASE_SELF(ble_ll_csa2_test_2)
     TEST_ASSERT(rc == 34);
 }
 
+static const uint8_t ble_ll_csa2_test_chanmaps[][BLE_LL_CONN_CHMAP_LEN] = {
+    { 0xff, 0xff, 0xff, 0xff, 0x1f },
+    { 0x00, 0x06, 0xe0, 0x00, 0x1e },
+    { 0x01, 0x00, 0x00, 0x00, 0x10 },
+    { 0x55, 0xaa, 0x55, 0xaa, 0x15 },
+    { 0xf0, 0x0f, 0x00, 0xff, 0x00 },
+};
+
+TEST_CASE_SELF(ble_ll_csa2_test_3)
+{
+    uint8_t remap_table[BLE_PHY_NUM_DATA_CHANS];
+    const uint8_t *chanmap;
+    uint8_t num_used_chans;
+    uint16_t channel_id;
+    uint8_t exp;
+    uint8_t chan;
+    uint32_t cntr;
+    int i;
+
+    /* Remapping table gives the same channels as scanning the channel map */
+    channel_id = ((0x8e89bed6 & 0xffff0000) >> 16) ^ (0x8e89bed6 & 0x0000ffff);
+
+    for (i = 0;
+         i < sizeof(ble_ll_csa2_test_chanmaps) /
+             sizeof(ble_ll_csa2_test_chanmaps[0]);
+         i++) {
+        chanmap = ble_ll_csa2_test_chanmaps[i];
+        num_used_chans = ble_ll_utils_calc_num_used_chans(chanmap);
+        ble_ll_utils_calc_remap_table(chanmap, remap_table);
+
+        for (cntr = 0; cntr <= UINT16_MAX; cntr++) {
+            exp = ble_ll_utils_calc_dci_csa2(cntr, channel_id, num_used_chans,
+                                             chanmap);
+            chan = ble_ll_utils_calc_dci_csa2_table(cntr, channel_id,
+                                                    num_used_chans, chanmap,
+                                                    remap_table);
+            TEST_ASSERT_FATAL(chan == exp);
+            TEST_ASSERT_FATAL(chanmap[chan >> 3] & (1 << (chan & 0x07)));
+        }
+    }
+}
+
+/*
+ * Compares throughput of channel index calculation when remapping by scanning
+ * the channel map and by table lookup.
+ */
+TEST_CASE_SELF(ble_ll_csa2_test_throughput)
+{
+    uint8_t remap_table[BLE_PHY_NUM_DATA_CHANS];
+    const uint8_t *chanmap;
+    uint8_t num_used_chans;
+    uint32_t ticks_map;
+    uint32_t ticks_table;
+    uint32_t sum_map;
+    uint32_t sum_table;
+    uint32_t cntr;
+
+    /* Few used channels, so most channels have to be remapped */
+    chanmap = ble_ll_csa2_test_chanmaps[2];
+    num_used_chans = ble_ll_utils_calc_num_used_chans(chanmap);
+    ble_ll_utils_calc_remap_table(chanmap, remap_table);
+
+    sum_map = 0;
+    ticks_map = os_cputime_get32();
+    for (cntr = 0; cntr <= UINT16_MAX; cntr++) {
+        sum_map += ble_ll_utils_calc_dci_csa2(cntr, 0x305f, num_used_chans,
+                                              chanmap);
+    }
+    ticks_map = os_cputime_get32() - ticks_map;
+
+    sum_table = 0;
+    ticks_table = os_cputime_get32();
+    for (cntr = 0; cntr <= UINT16_MAX; cntr++) {
+        sum_table += ble_ll_utils_calc_dci_csa2_table(cntr, 0x305f,
+                                                      num_used_chans, chanmap,
+                                                      remap_table);
+    }
+    ticks_table = os_cputime_get32() - ticks_table;
+
+    TEST_ASSERT(sum_map == sum_table);
+
+    printf("ble_ll_csa2: %lu events, channel map %lu usecs, "
+           "remap table %lu usecs\n", (unsigned long)(UINT16_MAX + 1),
+           (unsigned long)os_cputime_ticks_to_usecs(ticks_map),
+           (unsigned long)os_cputime_ticks_to_usecs(ticks_table));
+}
+
 TEST_SUITE(ble_ll_csa2_test_suite)
 {
     ble_ll_csa2_test_1();
     ble_ll_csa2_test_2();
+    ble_ll_csa2_test_3();
+    ble_ll_csa2_test_throughput();
 }
@@ -0,0 +1,303 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "syscfg/syscfg.h"
+#include "testutil/testutil.h"
+#include "nimble/ble.h"
+#include "nimble/hci_common.h"
+#include "controller/ble_hw.h"
+#include "controller/ble_ll_resolv.h"
+#include "ble_ll_resolv_test.h"
+
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PRIVACY) && \
+    MYNEWT_VAL(BLE_LL_RESOLV_CACHE_SIZE)
+
+static void
+ble_ll_resolv_test_util_irk(int i, uint8_t *irk)
+{
+    int j;
+
+    for (j = 0; j < 16; j++) {
+        irk[j] = (i << 4) + j + 1;
+    }
+}
+
+static void
+ble_ll_resolv_test_util_addr(int i, uint8_t *addr)
+{
+    memset(addr, 0, BLE_DEV_ADDR_LEN);
+    addr[0] = i + 1;
+}
+
+/* Generates RPA for IRK given in HCI (little endian) byte order */
+static void
+ble_ll_resolv_test_util_rpa(const uint8_t *irk, uint16_t prand, uint8_t *rpa)
+{
+    struct ble_encryption_block ecb;
+    int rc;
+
+    rpa[3] = prand;
+    rpa[4] = prand >> 8;
+    rpa[5] = 0x40;
+
+    swap_buf(ecb.key, irk, 16);
+    memset(ecb.plain_text, 0, 13);
+    ecb.plain_text[13] = rpa[5];
+    ecb.plain_text[14] = rpa[4];
+    ecb.plain_text[15] = rpa[3];
+
+    rc = ble_hw_encrypt_block(&ecb);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rpa[0] = ecb.cipher_text[15];
+    rpa[1] = ecb.cipher_text[14];
+    rpa[2] = ecb.cipher_text[13];
+}
+
+/* RPA which does not resolve with any IRK used by tests */
+static void
+ble_ll_resolv_test_util_rpa_unknown(uint16_t prand, uint8_t *rpa)
+{
+    rpa[0] = 0xa5;
+    rpa[1] = 0x5a;
+    rpa[2] = 0xa5;
+    rpa[3] = prand;
+    rpa[4] = prand >> 8;
+    rpa[5] = 0x41;
+}
+
+static int
+ble_ll_resolv_test_util_add(int i, int irk_i)
+{
+    struct ble_hci_le_add_resolv_list_cp cmd;
+
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.peer_addr_type = BLE_ADDR_PUBLIC;
+    ble_ll_resolv_test_util_addr(i, cmd.peer_id_addr);
+    ble_ll_resolv_test_util_irk(irk_i, cmd.peer_irk);
+
+    return ble_ll_resolv_list_add((uint8_t *)&cmd, sizeof(cmd));
+}
+
+static int
+ble_ll_resolv_test_util_rmv(int i)
+{
+    struct ble_hci_le_rmv_resolve_list_cp cmd;
+
+    cmd.peer_addr_type = BLE_ADDR_PUBLIC;
+    ble_ll_resolv_test_util_addr(i, cmd.peer_id_addr);
+
+    return ble_ll_resolv_list_rmv((uint8_t *)&cmd, sizeof(cmd));
+}
+
+static struct ble_ll_resolv_entry *
+ble_ll_resolv_test_util_find(int i)
+{
+    uint8_t addr[BLE_DEV_ADDR_LEN];
+
+    ble_ll_resolv_test_util_addr(i, addr);
+
+    return ble_ll_resolv_list_find(addr, BLE_ADDR_PUBLIC);
+}
+
+static int
+ble_ll_resolv_test_util_idx(int i)
+{
+    struct ble_ll_resolv_entry *rl;
+
+    rl = ble_ll_resolv_test_util_find(i);
+    TEST_ASSERT_FATAL(rl != NULL);
+
+    return rl - g_ble_ll_resolv_list;
+}
+
+/*
+ * Changes peer IRK of entry behind LL's back so that cache hits (resolved as
+ * with old IRK) can be told apart from misses (resolved with new IRK).
+ */
+static void
+ble_ll_resolv_test_util_set_irk(int i, int irk_i)
+{
+    struct ble_ll_resolv_entry *rl;
+    uint8_t irk[16];
+
+    rl = ble_ll_resolv_test_util_find(i);
+    TEST_ASSERT_FATAL(rl != NULL);
+
+    ble_ll_resolv_test_util_irk(irk_i, irk);
+    swap_buf(rl->rl_peer_irk, irk, 16);
+}
+
+static void
+ble_ll_resolv_test_util_init(void)
+{
+    /* Native driver has no resolving list HW */
+    ble_ll_resolv_list_reset();
+    ble_ll_resolv_list_size_set(MYNEWT_VAL(BLE_LL_RESOLV_LIST_SIZE));
+}
+
+TEST_CASE_SELF(ble_ll_resolv_test_case_cache_hit_miss)
+{
+    uint8_t irk[16];
+    uint8_t rpa0[BLE_DEV_ADDR_LEN];
+    uint8_t rpa0_new[BLE_DEV_ADDR_LEN];
+    uint8_t rpa2[BLE_DEV_ADDR_LEN];
+    int idx0;
+    int idx1;
+    int rc;
+
+    ble_ll_resolv_test_util_init();
+
+    rc = ble_ll_resolv_test_util_add(0, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = ble_ll_resolv_test_util_add(1, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+    idx0 = ble_ll_resolv_test_util_idx(0);
+    idx1 = ble_ll_resolv_test_util_idx(1);
+
+    ble_ll_resolv_test_util_irk(0, irk);
+    ble_ll_resolv_test_util_rpa(irk, 0x1234, rpa0);
+    ble_ll_resolv_test_util_rpa(irk, 0x4321, rpa0_new);
+    ble_ll_resolv_test_util_irk(2, irk);
+    ble_ll_resolv_test_util_rpa(irk, 0x1234, rpa2);
+
+    /* Misses are resolved with IRKs on resolving list */
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa0) == idx0);
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa2) == -1);
+
+    /* Hits, including failed resolution, do not use IRKs anymore */
+    ble_ll_resolv_test_util_set_irk(0, 15);
+    ble_ll_resolv_test_util_set_irk(1, 2);
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa0) == idx0);
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa2) == -1);
+
+    /* New RPA of the same peer is a miss */
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa0_new) == -1);
+
+    /* Sanity check that IRK change is seen on miss */
+    ble_ll_resolv_test_util_irk(2, irk);
+    ble_ll_resolv_test_util_rpa(irk, 0x4321, rpa2);
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa2) == idx1);
+
+    ble_ll_resolv_list_reset();
+}
+
+TEST_CASE_SELF(ble_ll_resolv_test_case_cache_invalidate)
+{
+    uint8_t irk[16];
+    uint8_t rpa0[BLE_DEV_ADDR_LEN];
+    uint8_t rpa1[BLE_DEV_ADDR_LEN];
+    uint8_t rpa2[BLE_DEV_ADDR_LEN];
+    int rc;
+
+    ble_ll_resolv_test_util_init();
+
+    ble_ll_resolv_test_util_irk(0, irk);
+    ble_ll_resolv_test_util_rpa(irk, 0x1234, rpa0);
+    ble_ll_resolv_test_util_irk(1, irk);
+    ble_ll_resolv_test_util_rpa(irk, 0x1234, rpa1);
+    ble_ll_resolv_test_util_irk(2, irk);
+    ble_ll_resolv_test_util_rpa(irk, 0x1234, rpa2);
+
+    rc = ble_ll_resolv_test_util_add(0, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa0) == 0);
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa1) == -1);
+
+    /* Added IRK resolves previously unresolved RPA */
+    rc = ble_ll_resolv_test_util_add(1, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa1) ==
+                ble_ll_resolv_test_util_idx(1));
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa0) ==
+                ble_ll_resolv_test_util_idx(0));
+
+    /* Removed peer is not resolved anymore, others may have moved */
+    rc = ble_ll_resolv_test_util_rmv(0);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa0) == -1);
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa1) ==
+                ble_ll_resolv_test_util_idx(1));
+
+    /* Peer IRK changed, old RPA is not resolved while new one is */
+    rc = ble_ll_resolv_test_util_rmv(1);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = ble_ll_resolv_test_util_add(1, 2);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa1) == -1);
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa2) ==
+                ble_ll_resolv_test_util_idx(1));
+
+    /* Cleared list */
+    rc = ble_ll_resolv_list_clr();
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa2) == -1);
+
+    ble_ll_resolv_list_reset();
+}
+
+TEST_CASE_SELF(ble_ll_resolv_test_case_cache_evict)
+{
+    uint8_t irk[16];
+    uint8_t rpa0[BLE_DEV_ADDR_LEN];
+    uint8_t rpa_unk[BLE_DEV_ADDR_LEN];
+    int idx;
+    int rc;
+    int i;
+
+    ble_ll_resolv_test_util_init();
+
+    rc = ble_ll_resolv_test_util_add(0, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    idx = ble_ll_resolv_test_util_idx(0);
+
+    ble_ll_resolv_test_util_irk(0, irk);
+    ble_ll_resolv_test_util_rpa(irk, 0x1234, rpa0);
+
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa0) == idx);
+    ble_ll_resolv_test_util_set_irk(0, 15);
+
+    /* Fill remaining cache entries, RPA is still cached */
+    for (i = 1; i < MYNEWT_VAL(BLE_LL_RESOLV_CACHE_SIZE); i++) {
+        ble_ll_resolv_test_util_rpa_unknown(i, rpa_unk);
+        TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa_unk) == -1);
+    }
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa0) == idx);
+
+    /* Oldest entry is replaced */
+    ble_ll_resolv_test_util_rpa_unknown(i, rpa_unk);
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa_unk) == -1);
+    TEST_ASSERT(ble_ll_resolv_peer_rpa_any(rpa0) == -1);
+
+    ble_ll_resolv_list_reset();
+}
+#endif
+
+TEST_SUITE(ble_ll_resolv_test_suite)
+{
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PRIVACY) && \
+    MYNEWT_VAL(BLE_LL_RESOLV_CACHE_SIZE)
+    ble_ll_resolv_test_case_cache_hit_miss();
+    ble_ll_resolv_test_case_cache_invalidate();
+    ble_ll_resolv_test_case_cache_evict();
+#endif
+}
@@ -0,0 +1,326 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <stddef.h>
+#include <string.h>
+#include "syscfg/syscfg.h"
+#include "testutil/testutil.h"
+#include "os/os.h"
+#include "nimble/ble.h"
+#include "nimble/hci_common.h"
+#include "controller/ble_ll.h"
+#include "controller/ble_ll_scan.h"
+#include "ble_ll_scan_test.h"
+
+/* Max parameter length of an event with coalesced advertising reports */
+#define BLE_LL_SCAN_TEST_MAX_LEN    min(UINT8_MAX, BLE_HCI_MAX_DATA_LEN)
+
+#define BLE_LL_SCAN_TEST_EV_SIZE    (sizeof(struct ble_hci_ev) + UINT8_MAX)
+
+static uint8_t ble_ll_scan_test_pending[BLE_LL_SCAN_TEST_EV_SIZE];
+static uint8_t ble_ll_scan_test_rpt[BLE_LL_SCAN_TEST_EV_SIZE];
+
+/*
+ * Builds an event carrying a single report of the specified subevent with
+ * data_len bytes of advertising data. Returns the length of the report.
+ */
+static uint8_t
+ble_ll_scan_test_util_rpt(uint8_t *buf, uint8_t subev_code, uint8_t data_len)
+{
+    struct ble_hci_ev *hci_ev = (struct ble_hci_ev *)buf;
+    struct ble_hci_ev_le_subev_ext_adv_rpt *ext_ev;
+    struct ble_hci_ev_le_subev_adv_rpt *ev;
+    uint8_t len;
+
+    memset(buf, 0, BLE_LL_SCAN_TEST_EV_SIZE);
+    hci_ev->opcode = BLE_HCI_EVCODE_LE_META;
+
+    if (subev_code == BLE_HCI_LE_SUBEV_EXT_ADV_RPT) {
+        ext_ev = (void *)hci_ev->data;
+        ext_ev->reports[0].data_len = data_len;
+        len = sizeof(ext_ev->reports[0]) + data_len;
+    } else {
+        ev = (void *)hci_ev->data;
+        ev->reports[0].data_len = data_len;
+        /* RSSI follows advertising data */
+        len = sizeof(ev->reports[0]) + data_len + 1;
+    }
+
+    hci_ev->data[0] = subev_code;
+    hci_ev->data[1] = 1;
+    hci_ev->length = 2 + len;
+
+    return len;
+}
+
+static void
+ble_ll_scan_test_util_coalesce(uint8_t subev_code, uint8_t data_len,
+                               uint8_t max_num)
+{
+    struct ble_hci_ev *pending;
+    struct ble_hci_ev *hci_ev;
+    uint8_t exp_num;
+    uint8_t len;
+    int rc;
+    int i;
+
+    pending = (struct ble_hci_ev *)ble_ll_scan_test_pending;
+    hci_ev = (struct ble_hci_ev *)ble_ll_scan_test_rpt;
+
+    len = ble_ll_scan_test_util_rpt(ble_ll_scan_test_pending, subev_code,
+                                    data_len);
+    ble_ll_scan_test_util_rpt(ble_ll_scan_test_rpt, subev_code, data_len);
+
+    /* Limited either by number of reports or by event buffer size */
+    exp_num = min(max_num, (BLE_LL_SCAN_TEST_MAX_LEN - 2) / len);
+    TEST_ASSERT_FATAL(exp_num > 1);
+
+    for (i = 1; i < exp_num; i++) {
+        rc = ble_ll_scan_rpt_append(pending, hci_ev);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    TEST_ASSERT(pending->data[1] == exp_num);
+    TEST_ASSERT(pending->length == 2 + exp_num * len);
+
+    rc = ble_ll_scan_rpt_append(pending, hci_ev);
+    TEST_ASSERT(rc != 0);
+    TEST_ASSERT(pending->data[1] == exp_num);
+    TEST_ASSERT(pending->length == 2 + exp_num * len);
+}
+
+TEST_CASE_SELF(ble_ll_scan_test_case_coalesce_legacy)
+{
+    /* Number of reports limit */
+    ble_ll_scan_test_util_coalesce(BLE_HCI_LE_SUBEV_ADV_RPT, 0,
+                                   BLE_HCI_LE_ADV_RPT_NUM_RPTS_MAX);
+
+    /* Event length limit */
+    ble_ll_scan_test_util_coalesce(BLE_HCI_LE_SUBEV_ADV_RPT, 31,
+                                   BLE_HCI_LE_ADV_RPT_NUM_RPTS_MAX);
+}
+
+TEST_CASE_SELF(ble_ll_scan_test_case_coalesce_ext)
+{
+    /* Number of reports limit */
+    ble_ll_scan_test_util_coalesce(BLE_HCI_LE_SUBEV_EXT_ADV_RPT, 0,
+                                   BLE_HCI_LE_EXT_ADV_RPT_NUM_RPTS_MAX);
+
+    /* Event length limit */
+    ble_ll_scan_test_util_coalesce(BLE_HCI_LE_SUBEV_EXT_ADV_RPT, 31,
+                                   BLE_HCI_LE_EXT_ADV_RPT_NUM_RPTS_MAX);
+}
+
+TEST_CASE_SELF(ble_ll_scan_test_case_coalesce_mixed)
+{
+    struct ble_hci_ev *pending;
+    struct ble_hci_ev *hci_ev;
+    uint8_t len;
+    int rc;
+
+    pending = (struct ble_hci_ev *)ble_ll_scan_test_pending;
+    hci_ev = (struct ble_hci_ev *)ble_ll_scan_test_rpt;
+
+    /* Reports of different subevents are never merged */
+    len = ble_ll_scan_test_util_rpt(ble_ll_scan_test_pending,
+                                    BLE_HCI_LE_SUBEV_ADV_RPT, 0);
+    ble_ll_scan_test_util_rpt(ble_ll_scan_test_rpt,
+                              BLE_HCI_LE_SUBEV_EXT_ADV_RPT, 0);
+
+    rc = ble_ll_scan_rpt_append(pending, hci_ev);
+    TEST_ASSERT(rc != 0);
+    TEST_ASSERT(pending->data[1] == 1);
+    TEST_ASSERT(pending->length == 2 + len);
+
+    ble_ll_scan_test_util_rpt(ble_ll_scan_test_rpt,
+                              BLE_HCI_LE_SUBEV_DIRECT_ADV_RPT, 0);
+    rc = ble_ll_scan_rpt_append(pending, hci_ev);
+    TEST_ASSERT(rc != 0);
+    TEST_ASSERT(pending->data[1] == 1);
+}
+
+/* Address of the i-th advertiser used by the duplicate filter tests */
+static void
+ble_ll_scan_test_util_dup_addr(uint8_t *addr, int i)
+{
+    memset(addr, 0, BLE_DEV_ADDR_LEN);
+    put_le32(addr, 0x00c0ffee + i);
+}
+
+/*
+ * Runs the duplicate filter on a legacy PDU from the advertiser as the
+ * scanner does; the report is sent, and recorded, only if the advertiser was
+ * not reported before. Returns non-zero if the report was suppressed.
+ */
+static int
+ble_ll_scan_test_util_dup(uint8_t addr_type, const uint8_t *addr,
+                          uint8_t pdu_type)
+{
+    uint8_t evtype;
+    uint8_t subev;
+    int rc;
+
+    rc = ble_ll_scan_dup_check_legacy(addr_type, addr, pdu_type);
+    if (rc) {
+        return rc;
+    }
+
+    subev = BLE_HCI_LE_SUBEV_ADV_RPT;
+    if (pdu_type == BLE_ADV_PDU_TYPE_ADV_DIRECT_IND) {
+        subev = BLE_HCI_LE_SUBEV_DIRECT_ADV_RPT;
+        evtype = BLE_HCI_ADV_RPT_EVTYPE_DIR_IND;
+    } else if (pdu_type == BLE_ADV_PDU_TYPE_SCAN_RSP) {
+        evtype = BLE_HCI_ADV_RPT_EVTYPE_SCAN_RSP;
+    } else {
+        evtype = BLE_HCI_ADV_RPT_EVTYPE_ADV_IND;
+    }
+
+    rc = ble_ll_scan_dup_update_legacy(addr_type, addr, subev, evtype);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    return 0;
+}
+
+TEST_CASE_SELF(ble_ll_scan_test_case_dup_suppress)
+{
+    uint8_t addr[BLE_DEV_ADDR_LEN];
+
+    ble_ll_scan_dup_init();
+    ble_ll_scan_test_util_dup_addr(addr, 0);
+
+    /* First advertisement is reported, repeated ones are not */
+    TEST_ASSERT(!ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                           BLE_ADV_PDU_TYPE_ADV_IND));
+    TEST_ASSERT(ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                          BLE_ADV_PDU_TYPE_ADV_IND));
+    TEST_ASSERT(ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                          BLE_ADV_PDU_TYPE_ADV_IND));
+
+    /* Scan response and directed advertising are filtered separately */
+    TEST_ASSERT(!ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                           BLE_ADV_PDU_TYPE_SCAN_RSP));
+    TEST_ASSERT(ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                          BLE_ADV_PDU_TYPE_SCAN_RSP));
+    TEST_ASSERT(!ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                           BLE_ADV_PDU_TYPE_ADV_DIRECT_IND));
+    TEST_ASSERT(ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                          BLE_ADV_PDU_TYPE_ADV_DIRECT_IND));
+
+    /* Same address of another type is another advertiser */
+    TEST_ASSERT(!ble_ll_scan_test_util_dup(BLE_ADDR_RANDOM, addr,
+                                           BLE_ADV_PDU_TYPE_ADV_IND));
+    TEST_ASSERT(ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                          BLE_ADV_PDU_TYPE_ADV_IND));
+
+    /* Restarting the filter forgets everything */
+    ble_ll_scan_dup_init();
+    TEST_ASSERT(!ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                           BLE_ADV_PDU_TYPE_ADV_IND));
+}
+
+TEST_CASE_SELF(ble_ll_scan_test_case_dup_full)
+{
+    uint8_t addr[BLE_DEV_ADDR_LEN];
+    int num;
+    int i;
+
+    ble_ll_scan_dup_init();
+
+    /* Fill the filter; more entries than hash buckets share buckets */
+    num = MYNEWT_VAL(BLE_LL_NUM_SCAN_DUP_ADVS);
+    for (i = 0; i < num; i++) {
+        ble_ll_scan_test_util_dup_addr(addr, i);
+        TEST_ASSERT(!ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                               BLE_ADV_PDU_TYPE_ADV_IND));
+    }
+    for (i = 0; i < num; i++) {
+        ble_ll_scan_test_util_dup_addr(addr, i);
+        TEST_ASSERT(ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                              BLE_ADV_PDU_TYPE_ADV_IND));
+    }
+
+    /* Seeing advertiser 0 again makes advertiser 1 the least recently seen */
+    ble_ll_scan_test_util_dup_addr(addr, 0);
+    TEST_ASSERT(ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                          BLE_ADV_PDU_TYPE_ADV_IND));
+
+    /* A new advertiser evicts it */
+    ble_ll_scan_test_util_dup_addr(addr, num);
+    TEST_ASSERT(!ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                           BLE_ADV_PDU_TYPE_ADV_IND));
+
+    /* All others are still filtered */
+    for (i = 0; i <= num; i++) {
+        if (i == 1) {
+            continue;
+        }
+        ble_ll_scan_test_util_dup_addr(addr, i);
+        TEST_ASSERT(ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                              BLE_ADV_PDU_TYPE_ADV_IND));
+    }
+
+    /* The evicted advertiser is reported again */
+    ble_ll_scan_test_util_dup_addr(addr, 1);
+    TEST_ASSERT(!ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                           BLE_ADV_PDU_TYPE_ADV_IND));
+}
+
+#if MYNEWT_VAL(BLE_LL_SCAN_DUP_EXPIRY_MS)
+TEST_CASE_SELF(ble_ll_scan_test_case_dup_expiry)
+{
+    uint8_t addr[BLE_DEV_ADDR_LEN];
+
+    ble_ll_scan_dup_init();
+    ble_ll_scan_test_util_dup_addr(addr, 0);
+
+    TEST_ASSERT(!ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                           BLE_ADV_PDU_TYPE_ADV_IND));
+    TEST_ASSERT(!ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                           BLE_ADV_PDU_TYPE_SCAN_RSP));
+
+    /* Still filtered halfway through the expiry time */
+    os_time_delay(os_time_ms_to_ticks32(
+                      MYNEWT_VAL(BLE_LL_SCAN_DUP_EXPIRY_MS) / 2));
+    TEST_ASSERT(ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                          BLE_ADV_PDU_TYPE_ADV_IND));
+
+    /* Once expired, all reports of the advertiser are sent again */
+    os_time_delay(os_time_ms_to_ticks32(
+                      MYNEWT_VAL(BLE_LL_SCAN_DUP_EXPIRY_MS)));
+    TEST_ASSERT(!ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                           BLE_ADV_PDU_TYPE_ADV_IND));
+    TEST_ASSERT(!ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                           BLE_ADV_PDU_TYPE_SCAN_RSP));
+    TEST_ASSERT(ble_ll_scan_test_util_dup(BLE_ADDR_PUBLIC, addr,
+                                          BLE_ADV_PDU_TYPE_ADV_IND));
+}
+#endif
+
+TEST_SUITE(ble_ll_scan_test_suite)
+{
+    ble_ll_scan_test_case_coalesce_legacy();
+    ble_ll_scan_test_case_coalesce_ext();
+    ble_ll_scan_test_case_coalesce_mixed();
+    ble_ll_scan_test_case_dup_suppress();
+    ble_ll_scan_test_case_dup_full();
+#if MYNEWT_VAL(BLE_LL_SCAN_DUP_EXPIRY_MS)
+    ble_ll_scan_test_case_dup_expiry();
+#endif
+}
@@ -0,0 +1,241 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "syscfg/syscfg.h"
+#include "testutil/testutil.h"
+#include "os/os_cputime.h"
+#include "controller/ble_ll_sched.h"
+#include "ble_ll_sched_test.h"
+
+#define BLE_LL_SCHED_TEST_NUM       (64)
+#define BLE_LL_SCHED_TEST_ROUNDS    (1000)
+
+/* Each item gets a slot; items are shorter than slots leaving gaps */
+#define BLE_LL_SCHED_TEST_SLOT      (100)
+#define BLE_LL_SCHED_TEST_DUR       (40)
+
+static struct ble_ll_sched_item ble_ll_sched_test_items[BLE_LL_SCHED_TEST_NUM];
+static struct ble_ll_sched_item ble_ll_sched_test_extra;
+static uint32_t ble_ll_sched_test_base;
+
+static int
+ble_ll_sched_test_util_sched_cb(struct ble_ll_sched_item *sch)
+{
+    return BLE_LL_SCHED_STATE_DONE;
+}
+
+static void
+ble_ll_sched_test_util_new_cb(struct ble_ll_adv_sm *advsm, uint32_t sch_start,
+                              void *arg)
+{
+    *(uint32_t *)arg = sch_start;
+}
+
+static uint32_t
+ble_ll_sched_test_util_slot(int i)
+{
+    return ble_ll_sched_test_base + i * BLE_LL_SCHED_TEST_SLOT;
+}
+
+static uint32_t
+ble_ll_sched_test_util_add(struct ble_ll_sched_item *sch, uint32_t start,
+                           uint32_t dur)
+{
+    uint32_t sch_start;
+    int rc;
+
+    memset(sch, 0, sizeof(*sch));
+    sch->sched_type = BLE_LL_SCHED_TYPE_ADV;
+    sch->sched_cb = ble_ll_sched_test_util_sched_cb;
+    sch->start_time = start;
+    sch->end_time = start + dur;
+
+    rc = ble_ll_sched_adv_new(sch, ble_ll_sched_test_util_new_cb, &sch_start);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(sch->enqueued);
+
+    return sch_start;
+}
+
+/* Adds all items in an order different from their order in time */
+static void
+ble_ll_sched_test_util_fill(void)
+{
+    uint32_t start;
+    int i;
+    int k;
+
+    /*
+     * Start far enough in the future so that scheduler timer does not expire
+     * while the test is running.
+     */
+    ble_ll_sched_test_base = os_cputime_get32() +
+                             os_cputime_usecs_to_ticks(10000000);
+
+    for (i = 0; i < BLE_LL_SCHED_TEST_NUM; i++) {
+        k = (i * 37) % BLE_LL_SCHED_TEST_NUM;
+        start = ble_ll_sched_test_util_add(&ble_ll_sched_test_items[k],
+                                           ble_ll_sched_test_util_slot(k),
+                                           BLE_LL_SCHED_TEST_DUR);
+        TEST_ASSERT(start == ble_ll_sched_test_util_slot(k));
+    }
+}
+
+/* Checks items are scheduled in slot order and removes them */
+static void
+ble_ll_sched_test_util_verify_and_clear(void)
+{
+    uint32_t next;
+    int rc;
+    int i;
+
+    for (i = 0; i < BLE_LL_SCHED_TEST_NUM; i++) {
+        rc = ble_ll_sched_next_time(&next);
+        TEST_ASSERT_FATAL(rc == 1);
+        TEST_ASSERT(next == ble_ll_sched_test_util_slot(i));
+
+        rc = ble_ll_sched_rmv_elem(&ble_ll_sched_test_items[i]);
+        TEST_ASSERT(rc == 0);
+    }
+
+    TEST_ASSERT(ble_ll_sched_next_time(&next) == 0);
+}
+
+TEST_CASE_SELF(ble_ll_sched_test_case_order)
+{
+    int rc;
+    int i;
+
+    ble_ll_sched_test_util_fill();
+
+    /* Remove every other item and add it back */
+    for (i = 0; i < BLE_LL_SCHED_TEST_NUM; i += 2) {
+        rc = ble_ll_sched_rmv_elem(&ble_ll_sched_test_items[i]);
+        TEST_ASSERT(rc == 0);
+        TEST_ASSERT(!ble_ll_sched_test_items[i].enqueued);
+    }
+
+    for (i = BLE_LL_SCHED_TEST_NUM - 2; i >= 0; i -= 2) {
+        ble_ll_sched_test_util_add(&ble_ll_sched_test_items[i],
+                                   ble_ll_sched_test_util_slot(i),
+                                   BLE_LL_SCHED_TEST_DUR);
+    }
+
+    ble_ll_sched_test_util_verify_and_clear();
+}
+
+TEST_CASE_SELF(ble_ll_sched_test_case_overlap)
+{
+    struct ble_ll_sched_item *sch;
+    uint32_t start;
+    int rc;
+
+    ble_ll_sched_test_util_fill();
+
+    sch = &ble_ll_sched_test_extra;
+
+    /* Overlapping item is moved to the gap after the item it overlaps */
+    start = ble_ll_sched_test_util_add(sch, ble_ll_sched_test_util_slot(20) + 10,
+                                       BLE_LL_SCHED_TEST_DUR);
+    TEST_ASSERT(start == ble_ll_sched_test_util_slot(20) +
+                         BLE_LL_SCHED_TEST_DUR);
+
+    rc = ble_ll_sched_rmv_elem(sch);
+    TEST_ASSERT(rc == 0);
+
+    /* Item which does not fit in any gap goes after the last item */
+    start = ble_ll_sched_test_util_add(sch, ble_ll_sched_test_util_slot(20),
+                                       BLE_LL_SCHED_TEST_SLOT);
+    TEST_ASSERT(start ==
+                ble_ll_sched_test_util_slot(BLE_LL_SCHED_TEST_NUM - 1) +
+                BLE_LL_SCHED_TEST_DUR);
+
+    rc = ble_ll_sched_rmv_elem(sch);
+    TEST_ASSERT(rc == 0);
+
+    /* Item which fits in a gap exactly */
+    start = ble_ll_sched_test_util_add(sch, ble_ll_sched_test_util_slot(5) +
+                                       BLE_LL_SCHED_TEST_DUR,
+                                       BLE_LL_SCHED_TEST_SLOT -
+                                       BLE_LL_SCHED_TEST_DUR);
+    TEST_ASSERT(start == ble_ll_sched_test_util_slot(5) +
+                         BLE_LL_SCHED_TEST_DUR);
+
+    rc = ble_ll_sched_rmv_elem(sch);
+    TEST_ASSERT(rc == 0);
+
+    ble_ll_sched_test_util_verify_and_clear();
+}
+
+/*
+ * Measures insertion latency with a full schedule. Items are removed and
+ * scheduled again at their own slot, so most insertions go somewhere in the
+ * middle of the queue.
+ */
+TEST_CASE_SELF(ble_ll_sched_test_case_insert_latency)
+{
+    uint32_t total;
+    uint32_t ticks;
+    uint32_t max;
+    uint32_t start;
+    int rc;
+    int i;
+    int k;
+
+    ble_ll_sched_test_util_fill();
+
+    total = 0;
+    max = 0;
+    for (i = 0; i < BLE_LL_SCHED_TEST_ROUNDS; i++) {
+        k = (i * 37) % BLE_LL_SCHED_TEST_NUM;
+
+        rc = ble_ll_sched_rmv_elem(&ble_ll_sched_test_items[k]);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        ticks = os_cputime_get32();
+        start = ble_ll_sched_test_util_add(&ble_ll_sched_test_items[k],
+                                           ble_ll_sched_test_util_slot(k),
+                                           BLE_LL_SCHED_TEST_DUR);
+        ticks = os_cputime_get32() - ticks;
+        TEST_ASSERT(start == ble_ll_sched_test_util_slot(k));
+
+        total += ticks;
+        if (ticks > max) {
+            max = ticks;
+        }
+    }
+
+    printf("ble_ll_sched: %d items, %d insertions, avg %lu usecs, "
+           "max %lu usecs\n", BLE_LL_SCHED_TEST_NUM, BLE_LL_SCHED_TEST_ROUNDS,
+           (unsigned long)(os_cputime_ticks_to_usecs(total) /
+                           BLE_LL_SCHED_TEST_ROUNDS),
+           (unsigned long)os_cputime_ticks_to_usecs(max));
+
+    ble_ll_sched_test_util_verify_and_clear();
+}
+
+TEST_SUITE(ble_ll_sched_test_suite)
+{
+    ble_ll_sched_test_case_order();
+    ble_ll_sched_test_case_overlap();
+    ble_ll_sched_test_case_insert_latency();
+}
@@ -23,6 +23,12 @@
 #include "os/os.h"
 #include "testutil/testutil.h"
 #include "ble_ll_csa2_test.h"
+#include "ble_ll_whitelist_test.h"
+#include "ble_ll_sched_test.h"
+#include "ble_ll_scan_test.h"
+#include "ble_ll_conn_burst_test.h"
+#include "ble_ll_resolv_test.h"
+#include "ble_phy_sim_test.h"
 
 #if MYNEWT_VAL(SELFTEST)
 
@@ -30,6 +36,12 @@ int
 main(int argc, char **argv)
 {
     ble_ll_csa2_test_suite();
+    ble_ll_whitelist_test_suite();
+    ble_ll_sched_test_suite();
+    ble_ll_scan_test_suite();
+    ble_ll_conn_burst_test_suite();
+    ble_ll_resolv_test_suite();
+    ble_phy_sim_test_suite();
     return tu_any_failed;
 }
 
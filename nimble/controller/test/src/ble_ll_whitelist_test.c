@@ -0,0 +1,258 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "syscfg/syscfg.h"
+#include "testutil/testutil.h"
+#include "nimble/ble.h"
+#include "nimble/hci_common.h"
+#include "controller/ble_ll_whitelist.h"
+#include "controller/ble_ll_resolv.h"
+#include "ble_ll_whitelist_test.h"
+
+#define BLE_LL_WHITELIST_TEST_NUM   MYNEWT_VAL(BLE_LL_WHITELIST_SIZE)
+
+/*
+ * Generates distinct addresses in non-sorted order so that entries are not
+ * added to lists in the same order they are stored.
+ */
+static void
+ble_ll_whitelist_test_util_addr(int i, uint8_t *addr_type, uint8_t *addr)
+{
+    *addr_type = i & 1;
+    addr[0] = (i * 37) & 0xff;
+    addr[1] = 0x11;
+    addr[2] = 0x22;
+    addr[3] = 0x33;
+    addr[4] = 0x44;
+    addr[5] = 0xc0 | (((i * 37) >> 8) & 0x3f);
+}
+
+static int
+ble_ll_whitelist_test_util_add(int i)
+{
+    struct ble_hci_le_add_whte_list_cp cmd;
+
+    ble_ll_whitelist_test_util_addr(i, &cmd.addr_type, cmd.addr);
+
+    return ble_ll_whitelist_add((uint8_t *)&cmd, sizeof(cmd));
+}
+
+static int
+ble_ll_whitelist_test_util_rmv(int i)
+{
+    struct ble_hci_le_rmv_white_list_cp cmd;
+
+    ble_ll_whitelist_test_util_addr(i, &cmd.addr_type, cmd.addr);
+
+    return ble_ll_whitelist_rmv((uint8_t *)&cmd, sizeof(cmd));
+}
+
+static int
+ble_ll_whitelist_test_util_match(int i)
+{
+    uint8_t addr_type;
+    uint8_t addr[BLE_DEV_ADDR_LEN];
+
+    ble_ll_whitelist_test_util_addr(i, &addr_type, addr);
+
+    return ble_ll_whitelist_match(addr, addr_type, 1);
+}
+
+TEST_CASE_SELF(ble_ll_whitelist_test_case_full)
+{
+    int rc;
+    int i;
+
+    rc = ble_ll_whitelist_clear();
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < BLE_LL_WHITELIST_TEST_NUM; i++) {
+        rc = ble_ll_whitelist_test_util_add(i);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    /* Adding same device again is not an error */
+    rc = ble_ll_whitelist_test_util_add(0);
+    TEST_ASSERT(rc == 0);
+
+    /* No more space */
+    rc = ble_ll_whitelist_test_util_add(BLE_LL_WHITELIST_TEST_NUM);
+    TEST_ASSERT(rc == BLE_ERR_MEM_CAPACITY);
+
+    for (i = 0; i < BLE_LL_WHITELIST_TEST_NUM; i++) {
+        TEST_ASSERT(ble_ll_whitelist_test_util_match(i));
+    }
+    TEST_ASSERT(!ble_ll_whitelist_test_util_match(BLE_LL_WHITELIST_TEST_NUM));
+
+    /* Same address but different type shall not match */
+    TEST_ASSERT(!ble_ll_whitelist_match(
+                    (uint8_t[]){ 0, 0x11, 0x22, 0x33, 0x44, 0xc0 }, 1, 1));
+
+    rc = ble_ll_whitelist_clear();
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < BLE_LL_WHITELIST_TEST_NUM; i++) {
+        TEST_ASSERT(!ble_ll_whitelist_test_util_match(i));
+    }
+}
+
+TEST_CASE_SELF(ble_ll_whitelist_test_case_rmv)
+{
+    int rc;
+    int i;
+
+    rc = ble_ll_whitelist_clear();
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < BLE_LL_WHITELIST_TEST_NUM; i++) {
+        rc = ble_ll_whitelist_test_util_add(i);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    /* Remove every other device */
+    for (i = 0; i < BLE_LL_WHITELIST_TEST_NUM; i += 2) {
+        rc = ble_ll_whitelist_test_util_rmv(i);
+        TEST_ASSERT(rc == 0);
+    }
+
+    for (i = 0; i < BLE_LL_WHITELIST_TEST_NUM; i++) {
+        TEST_ASSERT(!ble_ll_whitelist_test_util_match(i) == !(i & 1));
+    }
+
+    /* Freed entries can be reused */
+    for (i = 0; i < BLE_LL_WHITELIST_TEST_NUM; i += 2) {
+        rc = ble_ll_whitelist_test_util_add(i + BLE_LL_WHITELIST_TEST_NUM);
+        TEST_ASSERT(rc == 0);
+    }
+
+    for (i = 0; i < BLE_LL_WHITELIST_TEST_NUM; i += 2) {
+        TEST_ASSERT(!ble_ll_whitelist_test_util_match(i));
+        TEST_ASSERT(ble_ll_whitelist_test_util_match(i + 1));
+        TEST_ASSERT(ble_ll_whitelist_test_util_match(
+                        i + BLE_LL_WHITELIST_TEST_NUM));
+    }
+
+    rc = ble_ll_whitelist_clear();
+    TEST_ASSERT(rc == 0);
+}
+
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PRIVACY)
+static int
+ble_ll_whitelist_test_util_rl_add(int i)
+{
+    struct ble_hci_le_add_resolv_list_cp cmd;
+
+    memset(&cmd, 0, sizeof(cmd));
+    ble_ll_whitelist_test_util_addr(i, &cmd.peer_addr_type, cmd.peer_id_addr);
+
+    return ble_ll_resolv_list_add((uint8_t *)&cmd, sizeof(cmd));
+}
+
+static int
+ble_ll_whitelist_test_util_rl_rmv(int i)
+{
+    struct ble_hci_le_rmv_resolve_list_cp cmd;
+
+    ble_ll_whitelist_test_util_addr(i, &cmd.peer_addr_type, cmd.peer_id_addr);
+
+    return ble_ll_resolv_list_rmv((uint8_t *)&cmd, sizeof(cmd));
+}
+
+static struct ble_ll_resolv_entry *
+ble_ll_whitelist_test_util_rl_find(int i)
+{
+    uint8_t addr_type;
+    uint8_t addr[BLE_DEV_ADDR_LEN];
+
+    ble_ll_whitelist_test_util_addr(i, &addr_type, addr);
+
+    return ble_ll_resolv_list_find(addr, addr_type);
+}
+
+TEST_CASE_SELF(ble_ll_whitelist_test_case_resolv_list)
+{
+    struct ble_ll_resolv_entry *rl;
+    uint8_t addr_type;
+    uint8_t addr[BLE_DEV_ADDR_LEN];
+    int num;
+    int rc;
+    int i;
+
+    /* Native driver has no resolving list HW */
+    ble_ll_resolv_list_reset();
+    num = MYNEWT_VAL(BLE_LL_RESOLV_LIST_SIZE);
+    ble_ll_resolv_list_size_set(num);
+
+    for (i = 0; i < num; i++) {
+        rc = ble_ll_whitelist_test_util_rl_add(i);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        /* Duplicates are rejected (capacity is checked first) */
+        if (i < num - 1) {
+            rc = ble_ll_whitelist_test_util_rl_add(i / 2);
+            TEST_ASSERT(rc == BLE_ERR_INV_HCI_CMD_PARMS);
+        }
+    }
+
+    /* No more space */
+    rc = ble_ll_whitelist_test_util_rl_add(num);
+    TEST_ASSERT(rc == BLE_ERR_MEM_CAPACITY);
+
+    for (i = 0; i < num; i++) {
+        rl = ble_ll_whitelist_test_util_rl_find(i);
+        TEST_ASSERT_FATAL(rl != NULL);
+
+        ble_ll_whitelist_test_util_addr(i, &addr_type, addr);
+        TEST_ASSERT(rl->rl_addr_type == addr_type);
+        TEST_ASSERT(memcmp(rl->rl_identity_addr, addr, sizeof(addr)) == 0);
+    }
+    TEST_ASSERT(ble_ll_whitelist_test_util_rl_find(num) == NULL);
+
+    /* Remove from the middle; remaining entries shall still be found */
+    rc = ble_ll_whitelist_test_util_rl_rmv(num / 2);
+    TEST_ASSERT(rc == 0);
+    rc = ble_ll_whitelist_test_util_rl_rmv(num / 2);
+    TEST_ASSERT(rc == BLE_ERR_UNK_CONN_ID);
+
+    for (i = 0; i < num; i++) {
+        rl = ble_ll_whitelist_test_util_rl_find(i);
+        TEST_ASSERT((rl == NULL) == (i == num / 2));
+    }
+
+    rc = ble_ll_resolv_list_clr();
+    TEST_ASSERT(rc == 0);
+
+    for (i = 0; i < num; i++) {
+        TEST_ASSERT(ble_ll_whitelist_test_util_rl_find(i) == NULL);
+    }
+
+    ble_ll_resolv_list_reset();
+}
+#endif
+
+TEST_SUITE(ble_ll_whitelist_test_suite)
+{
+    ble_ll_whitelist_test_case_full();
+    ble_ll_whitelist_test_case_rmv();
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_PRIVACY)
+    ble_ll_whitelist_test_case_resolv_list();
+#endif
+}
@@ -0,0 +1,229 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "syscfg/syscfg.h"
+#include "testutil/testutil.h"
+#include "os/os.h"
+#include "ble/ble_phy_sim.h"
+#include "ble_phy_sim_test.h"
+
+#if MYNEWT_VAL(BLE_PHY_NATIVE_SIM)
+
+/* Above any process id, so test nodes never clash with a PHY. */
+#define BLE_PHY_SIM_TEST_NODE_ID    (4000000000UL)
+
+#define BLE_PHY_SIM_TEST_AA         (0x8e89bed6)
+#define BLE_PHY_SIM_TEST_CHAN       (37)
+#define BLE_PHY_SIM_TEST_TXPWR      (4)
+
+struct ble_phy_sim_test_node {
+    struct ble_phy_sim_node node;
+    int num_rx;
+    int num_tx_end;
+    int num_wfr;
+    int8_t rssi;
+    struct ble_phy_sim_frame frame;
+};
+
+static struct ble_phy_sim_test_node ble_phy_sim_test_nodes[2];
+static struct os_sem ble_phy_sim_test_sem;
+static char ble_phy_sim_test_dir[64];
+
+static struct ble_phy_sim_test_node *
+ble_phy_sim_test_util_node(struct ble_phy_sim_node *node)
+{
+    return (struct ble_phy_sim_test_node *)node;
+}
+
+static void
+ble_phy_sim_test_util_rx(struct ble_phy_sim_node *node,
+                         const struct ble_phy_sim_frame *frame, int8_t rssi,
+                         uint32_t age_usecs)
+{
+    struct ble_phy_sim_test_node *tnode;
+
+    tnode = ble_phy_sim_test_util_node(node);
+    tnode->frame = *frame;
+    tnode->rssi = rssi;
+    ++tnode->num_rx;
+
+    os_sem_release(&ble_phy_sim_test_sem);
+}
+
+static void
+ble_phy_sim_test_util_tx_end(struct ble_phy_sim_node *node)
+{
+    ++ble_phy_sim_test_util_node(node)->num_tx_end;
+
+    os_sem_release(&ble_phy_sim_test_sem);
+}
+
+static void
+ble_phy_sim_test_util_wfr(struct ble_phy_sim_node *node)
+{
+    ++ble_phy_sim_test_util_node(node)->num_wfr;
+
+    os_sem_release(&ble_phy_sim_test_sem);
+}
+
+static const struct ble_phy_sim_isrs ble_phy_sim_test_isrs = {
+    .rx = ble_phy_sim_test_util_rx,
+    .tx_end = ble_phy_sim_test_util_tx_end,
+    .wfr = ble_phy_sim_test_util_wfr,
+};
+
+static void
+ble_phy_sim_test_util_join(void)
+{
+    int rc;
+    int i;
+
+    memset(ble_phy_sim_test_nodes, 0, sizeof(ble_phy_sim_test_nodes));
+
+    rc = os_sem_init(&ble_phy_sim_test_sem, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Private medium, so frames from other processes do not interfere. */
+    snprintf(ble_phy_sim_test_dir, sizeof(ble_phy_sim_test_dir),
+             "/tmp/ble_phy_sim_test.%d", (int)getpid());
+
+    for (i = 0; i < 2; i++) {
+        rc = ble_phy_sim_node_init(&ble_phy_sim_test_nodes[i].node,
+                                   ble_phy_sim_test_dir,
+                                   BLE_PHY_SIM_TEST_NODE_ID + i,
+                                   &ble_phy_sim_test_isrs);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    /* Let the medium threads discover each other. */
+    os_time_delay(os_time_ms_to_ticks32(250));
+}
+
+static void
+ble_phy_sim_test_util_leave(void)
+{
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        ble_phy_sim_node_leave(&ble_phy_sim_test_nodes[i].node);
+    }
+
+    rmdir(ble_phy_sim_test_dir);
+}
+
+/* Waits until 'cnt' reaches 'exp' or one second passes without an event. */
+static void
+ble_phy_sim_test_util_wait(const int *cnt, int exp)
+{
+    int rc;
+
+    while (*cnt < exp) {
+        rc = os_sem_pend(&ble_phy_sim_test_sem, os_time_ms_to_ticks32(1000));
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+}
+
+static void
+ble_phy_sim_test_util_tx_rx(int tx_idx, const char *data)
+{
+    struct ble_phy_sim_test_node *tx;
+    struct ble_phy_sim_test_node *rx;
+    struct ble_phy_sim_frame frame;
+
+    tx = &ble_phy_sim_test_nodes[tx_idx];
+    rx = &ble_phy_sim_test_nodes[!tx_idx];
+
+    memset(&frame, 0, sizeof(frame));
+    frame.access_addr = BLE_PHY_SIM_TEST_AA;
+    frame.chan = BLE_PHY_SIM_TEST_CHAN;
+    frame.phy_mode = BLE_PHY_MODE_1M;
+    frame.txpwr_dbm = BLE_PHY_SIM_TEST_TXPWR;
+    frame.pdu_len = strlen(data);
+    memcpy(frame.pdu, data, frame.pdu_len);
+    frame.air_usecs = 80 + 8 * frame.pdu_len;
+
+    ble_phy_sim_node_tx(&tx->node, &frame);
+    ble_phy_sim_node_tx_end_set(&tx->node, frame.air_usecs);
+
+    ble_phy_sim_test_util_wait(&tx->num_tx_end, 1);
+    ble_phy_sim_test_util_wait(&rx->num_rx, 1);
+
+    TEST_ASSERT(tx->node.stats.tx_frames == 1);
+    TEST_ASSERT(rx->frame.src == tx->node.node_id);
+    TEST_ASSERT(rx->frame.access_addr == BLE_PHY_SIM_TEST_AA);
+    TEST_ASSERT(rx->frame.chan == BLE_PHY_SIM_TEST_CHAN);
+    TEST_ASSERT(rx->frame.pdu_len == strlen(data));
+    TEST_ASSERT(memcmp(rx->frame.pdu, data, rx->frame.pdu_len) == 0);
+    TEST_ASSERT(rx->rssi == rx->node.rssi_dbm + BLE_PHY_SIM_TEST_TXPWR);
+
+    /* A node does not hear its own transmission. */
+    TEST_ASSERT(tx->num_rx == 0);
+}
+
+TEST_CASE_TASK(ble_phy_sim_test_case_tx_rx)
+{
+    ble_phy_sim_test_util_join();
+
+    ble_phy_sim_test_util_tx_rx(0, "ping");
+
+    /* And back; node 1 has heard "ping" by now. */
+    ble_phy_sim_test_nodes[1].num_rx = 0;
+
+    ble_phy_sim_test_util_tx_rx(1, "pong");
+
+    ble_phy_sim_test_util_leave();
+}
+
+TEST_CASE_TASK(ble_phy_sim_test_case_wfr)
+{
+    struct ble_phy_sim_test_node *tnode;
+
+    ble_phy_sim_test_util_join();
+    tnode = &ble_phy_sim_test_nodes[0];
+
+    /* Nothing on the air; the wait for response expires once. */
+    ble_phy_sim_node_wfr_set(&tnode->node, 150);
+    ble_phy_sim_test_util_wait(&tnode->num_wfr, 1);
+    TEST_ASSERT(tnode->num_rx == 0);
+
+    /* A cleared timer does not expire. */
+    ble_phy_sim_node_wfr_set(&tnode->node, 150);
+    ble_phy_sim_node_timers_clear(&tnode->node);
+    os_time_delay(os_time_ms_to_ticks32(50));
+    TEST_ASSERT(tnode->num_wfr == 1);
+
+    ble_phy_sim_test_util_leave();
+}
+
+TEST_SUITE(ble_phy_sim_test_suite)
+{
+    ble_phy_sim_test_case_tx_rx();
+    ble_phy_sim_test_case_wfr();
+}
+
+#else
+
+TEST_SUITE(ble_phy_sim_test_suite)
+{
+}
+
+#endif
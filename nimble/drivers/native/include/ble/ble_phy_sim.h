@@ -0,0 +1,176 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_BLE_PHY_SIM_
+#define H_BLE_PHY_SIM_
+
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/un.h>
+#include "syscfg/syscfg.h"
+#include "os/os_cputime.h"
+#include "controller/ble_phy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLE_PHY_SIM_FRAME_MAGIC     (0x4e424c45)
+#define BLE_PHY_SIM_RXQ_LEN         (8)
+
+/*
+ * A single PDU on the virtual air medium. The PDU starts with the 2-byte
+ * LL header, followed by the payload (no preamble, access address or CRC).
+ */
+struct ble_phy_sim_frame
+{
+    uint32_t magic;
+    uint32_t src;
+    uint64_t tx_usecs;
+    uint32_t air_usecs;
+    uint32_t access_addr;
+    uint8_t chan;
+    uint8_t phy_mode;
+    int8_t txpwr_dbm;
+    uint8_t pdu_len;
+    uint8_t pdu[BLE_PHY_MAX_PDU_LEN];
+};
+
+struct ble_phy_sim_node;
+
+/*
+ * Emulated radio interrupts of a node. They are called from cputime timer
+ * callbacks, i.e. in the same context as the link layer's own timers.
+ *
+ * For received frames, 'age_usecs' is the time elapsed since the frame
+ * started arriving at the node.
+ */
+struct ble_phy_sim_isrs
+{
+    void (*rx)(struct ble_phy_sim_node *node,
+               const struct ble_phy_sim_frame *frame, int8_t rssi,
+               uint32_t age_usecs);
+    void (*tx_end)(struct ble_phy_sim_node *node);
+    void (*wfr)(struct ble_phy_sim_node *node);
+};
+
+struct ble_phy_sim_stats
+{
+    uint32_t tx_frames;
+    uint32_t tx_errs;
+    uint32_t rx_frames;
+    uint32_t rx_lost;
+    uint32_t rx_overflow;
+
+    /* Updated by the medium thread. */
+    uint32_t fanout_errs;
+    uint32_t stale_nodes;
+};
+
+struct ble_phy_sim_rx_entry
+{
+    uint64_t due_usecs;
+    uint64_t start_usecs;
+    int8_t rssi;
+    struct ble_phy_sim_frame frame;
+};
+
+/* A node on the air medium. */
+struct ble_phy_sim_node
+{
+    const struct ble_phy_sim_isrs *isrs;
+    int sock;
+    /* Frames queued for transmission to the medium thread */
+    int tx_fd[2];
+    uint32_t node_id;
+    uint32_t latency_usecs;
+    uint32_t loss_pct;
+    int8_t rssi_dbm;
+    unsigned int rand_seed;
+    char dir[sizeof(((struct sockaddr_un *)0)->sun_path) - 16];
+    struct sockaddr_un self;
+
+    /* Owned by the medium thread. */
+    uint64_t peers_refresh_usecs;
+    int num_peers;
+    struct sockaddr_un peers[MYNEWT_VAL(BLE_PHY_NATIVE_SIM_MAX_NODES)];
+    pthread_t thread;
+
+    /* Owned by the OS. */
+    struct hal_timer tx_end_timer;
+    struct hal_timer wfr_timer;
+    struct hal_timer rx_timer;
+    uint8_t wfr_armed;
+    uint8_t rxq_head;
+    uint8_t rxq_cnt;
+    struct ble_phy_sim_rx_entry rxq[BLE_PHY_SIM_RXQ_LEN];
+
+    struct ble_phy_sim_stats stats;
+};
+
+/*
+ * Joins the air medium in directory 'dir' as node 'node_id' and starts the
+ * node's medium thread. Node ids are unique on a medium; the PHY uses its
+ * process id.
+ */
+int ble_phy_sim_node_init(struct ble_phy_sim_node *node, const char *dir,
+                          uint32_t node_id,
+                          const struct ble_phy_sim_isrs *isrs);
+
+/* Leaves the air medium and stops the node's medium thread. */
+void ble_phy_sim_node_leave(struct ble_phy_sim_node *node);
+
+/* Puts a frame on the air. Fills in the source and transmit timestamp. */
+void ble_phy_sim_node_tx(struct ble_phy_sim_node *node,
+                         struct ble_phy_sim_frame *frame);
+
+/* Arms the transmit end event, 'usecs' from now. */
+void ble_phy_sim_node_tx_end_set(struct ble_phy_sim_node *node,
+                                 uint32_t usecs);
+
+/*
+ * Arms the wait for response timer, 'usecs' from now. The medium latency is
+ * added on top so that responses delayed by the medium are still caught.
+ */
+void ble_phy_sim_node_wfr_set(struct ble_phy_sim_node *node, uint32_t usecs);
+
+/* Stops both the transmit end event and the wait for response timer. */
+void ble_phy_sim_node_timers_clear(struct ble_phy_sim_node *node);
+
+/*
+ * The PHY's own node. ble_phy_sim_init() joins the medium configured in
+ * syscfg and the environment; calling it again is a no-op.
+ */
+int ble_phy_sim_init(void);
+void ble_phy_sim_tx(struct ble_phy_sim_frame *frame);
+void ble_phy_sim_tx_end_set(uint32_t usecs);
+void ble_phy_sim_wfr_set(uint32_t usecs);
+void ble_phy_sim_timers_clear(void);
+
+/* Implemented by the PHY; the radio interrupts of its own node. */
+void ble_phy_sim_rx_isr(const struct ble_phy_sim_frame *frame, int8_t rssi,
+                        uint32_t age_usecs);
+void ble_phy_sim_tx_end_isr(void);
+void ble_phy_sim_wfr_isr(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H_BLE_PHY_SIM_ */
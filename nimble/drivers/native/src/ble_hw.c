@@ -27,6 +27,8 @@
 #include "nimble/ble.h"
 #include "nimble/nimble_opt.h"
 #include "controller/ble_hw.h"
+#include "tinycrypt/aes.h"
+#include "tinycrypt/constants.h"
 
 /* Total number of white list elements supported by nrf52 */
 #define BLE_HW_WHITE_LIST_SIZE      (0)
@@ -130,11 +132,24 @@ ble_hw_whitelist_match(void)
     return 0;
 }
 
-/* Encrypt data */
+/* Encrypt data. Done in software since there is no ECB peripheral. Key and
+ * data are MSB first, same as with ECB HW on nRF.
+ */
 int
 ble_hw_encrypt_block(struct ble_encryption_block *ecb)
 {
-    return -1;
+    struct tc_aes_key_sched_struct s;
+
+    if (tc_aes128_set_encrypt_key(&s, ecb->key) == TC_CRYPTO_FAIL) {
+        return -1;
+    }
+
+    if (tc_aes_encrypt(ecb->cipher_text, ecb->plain_text, &s) ==
+        TC_CRYPTO_FAIL) {
+        return -1;
+    }
+
+    return 0;
 }
 
 /**
@@ -215,7 +230,11 @@ ble_hw_resolv_list_clear(void)
 int
 ble_hw_resolv_list_add(uint8_t *irk)
 {
-    return BLE_ERR_MEM_CAPACITY;
+    /* Nothing to program. Size is reported as 0 so LL only gets here if
+     * unit tests override resolving list size; IRKs are then used for
+     * resolution done in software only.
+     */
+    return BLE_ERR_SUCCESS;
 }
 
 /**
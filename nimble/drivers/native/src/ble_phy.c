@@ -27,12 +27,16 @@
 #include "nimble/nimble_opt.h"
 #include "controller/ble_phy.h"
 #include "controller/ble_ll.h"
+#if MYNEWT_VAL(BLE_PHY_NATIVE_SIM)
+#include "ble/ble_phy_sim.h"
+#endif
 
 /* BLE PHY data structure */
 struct ble_phy_obj
 {
     uint8_t phy_stats_initialized;
     int8_t  phy_txpwr_dbm;
+    int8_t  phy_rx_rssi;
     int16_t rx_pwr_compensation;
     uint8_t phy_chan;
     uint8_t phy_state;
@@ -68,7 +72,14 @@ struct ble_phy_statistics
 
 struct ble_phy_statistics g_ble_phy_stats;
 
+#if MYNEWT_VAL(BLE_PHY_NATIVE_SIM)
+static struct ble_phy_sim_frame g_ble_phy_tx_frame;
+#else
 static uint8_t g_ble_phy_tx_buf[BLE_PHY_MAX_PDU_LEN];
+#endif
+
+/* Received PDUs are copied out in words, so keep this aligned. */
+static uint32_t g_ble_phy_rx_buf[(BLE_PHY_MAX_PDU_LEN + 3) / 4];
 
 /* XCVR object to emulate transceiver */
 struct xcvr_data
@@ -236,14 +247,21 @@ ble_phy_isr(void)
         assert(g_ble_phy_data.phy_state == BLE_PHY_STATE_TX);
         ble_xcvr_clear_irq(BLE_XCVR_IRQ_F_TX_END);
 
+        /* Call transmit end callback */
+        if (g_ble_phy_data.txend_cb) {
+            g_ble_phy_data.txend_cb(g_ble_phy_data.txend_arg);
+        }
+
         transition = g_ble_phy_data.phy_transition;
         if (transition == BLE_PHY_TRANSITION_TX_RX) {
-            /* Disable the phy */
-            /* XXX: count no bufs? */
-            ble_phy_disable();
+            /* Turn around and wait for the response */
+            g_ble_phy_data.phy_state = BLE_PHY_STATE_RX;
+            g_ble_phy_data.phy_rx_started = 0;
+            ble_phy_wfr_enable(BLE_PHY_WFR_ENABLE_TXRX, BLE_PHY_MODE_1M, 0);
         } else {
             /* Better not be going from rx to tx! */
             assert(transition == BLE_PHY_TRANSITION_NONE);
+            ble_phy_disable();
         }
     }
 
@@ -251,6 +269,18 @@ ble_phy_isr(void)
     if (irq_en & BLE_XCVR_IRQ_F_RX_START) {
 
         ble_xcvr_clear_irq(BLE_XCVR_IRQ_F_RX_START);
+        g_ble_phy_data.phy_rx_started = 1;
+
+        /* Construct BLE header before handing up */
+        ble_hdr = &g_ble_phy_data.rxhdr;
+        ble_hdr->rxinfo.flags = ble_ll_state_get();
+        ble_hdr->rxinfo.channel = g_ble_phy_data.phy_chan;
+        ble_hdr->rxinfo.handle = 0;
+        ble_hdr->rxinfo.phy = BLE_PHY_1M;
+        ble_hdr->rxinfo.phy_mode = BLE_PHY_MODE_1M;
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
+        ble_hdr->rxinfo.user_data = NULL;
+#endif
 
         /* Call Link Layer receive start function */
         rc = ble_ll_rx_start(g_ble_phy_data.rxdptr, g_ble_phy_data.phy_chan,
@@ -273,21 +303,21 @@ ble_phy_isr(void)
 
         ble_xcvr_clear_irq(BLE_XCVR_IRQ_F_RX_END);
 
-        /* Construct BLE header before handing up */
         ble_hdr = &g_ble_phy_data.rxhdr;
-        ble_hdr->rxinfo.flags = 0;
-        /* XXX: dummy rssi */
-        ble_hdr->rxinfo.rssi = -77 + g_ble_phy_data.rx_pwr_compensation;
-        ble_hdr->rxinfo.channel = g_ble_phy_data.phy_chan;
-        ble_hdr->rxinfo.phy = BLE_PHY_1M;
-#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LL_EXT_ADV)
-        ble_hdr->rxinfo.aux_data = NULL;
-#endif
+        ble_hdr->rxinfo.rssi = g_ble_phy_data.phy_rx_rssi +
+                               g_ble_phy_data.rx_pwr_compensation;
 
         /* Count PHY valid packets */
         ++g_ble_phy_stats.rx_valid;
         ble_hdr->rxinfo.flags |= BLE_MBUF_HDR_F_CRC_OK;
 
+        /*
+         * Reception is over; the link layer may turn the radio around and
+         * transmit a response from within the end callback.
+         */
+        g_ble_phy_data.phy_state = BLE_PHY_STATE_IDLE;
+        g_ble_phy_data.phy_rx_started = 0;
+
         /* Call Link Layer receive payload function */
         rc = ble_ll_rx_end(g_ble_phy_data.rxdptr, ble_hdr);
         if (rc < 0) {
@@ -316,7 +346,16 @@ ble_phy_init(void)
 
     g_ble_phy_data.rx_pwr_compensation = 0;
 
-    /* XXX: emulate ISR? */
+    /* XXX: dummy rssi, unless the medium reports one */
+    g_ble_phy_data.phy_rx_rssi = -77;
+    g_ble_phy_data.rxdptr = (uint8_t *)g_ble_phy_rx_buf;
+
+#if MYNEWT_VAL(BLE_PHY_NATIVE_SIM)
+    /* Radio interrupts are emulated by the virtual air medium */
+    if (ble_phy_sim_init() != 0) {
+        return BLE_PHY_ERR_INIT;
+    }
+#endif
 
     return 0;
 }
@@ -332,6 +371,7 @@ ble_phy_rx(void)
     }
 
     g_ble_phy_data.phy_state = BLE_PHY_STATE_RX;
+    g_ble_phy_data.phy_rx_started = 0;
 
     return 0;
 }
@@ -339,6 +379,11 @@ ble_phy_rx(void)
 void
 ble_phy_restart_rx(void)
 {
+#if MYNEWT_VAL(BLE_PHY_NATIVE_SIM)
+    ble_phy_sim_timers_clear();
+    g_ble_phy_data.phy_state = BLE_PHY_STATE_RX;
+    g_ble_phy_data.phy_rx_started = 0;
+#endif
 }
 
 #if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_ENCRYPTION)
@@ -414,6 +459,11 @@ ble_phy_tx_set_start_time(uint32_t cputime, uint8_t rem_usecs)
 int
 ble_phy_rx_set_start_time(uint32_t cputime, uint8_t rem_usecs)
 {
+#if MYNEWT_VAL(BLE_PHY_NATIVE_SIM)
+    /* No way to start on time here; just start listening now */
+    g_ble_phy_data.phy_state = BLE_PHY_STATE_RX;
+    g_ble_phy_data.phy_rx_started = 0;
+#endif
     return 0;
 }
 
@@ -421,6 +471,10 @@ ble_phy_rx_set_start_time(uint32_t cputime, uint8_t rem_usecs)
 int
 ble_phy_tx(ble_phy_tx_pducb_t pducb, void *pducb_arg, uint8_t end_trans)
 {
+#if MYNEWT_VAL(BLE_PHY_NATIVE_SIM)
+    struct ble_phy_sim_frame *frame;
+#endif
+    uint8_t payload_len;
     uint8_t hdr_byte;
     int rc;
 
@@ -430,21 +484,34 @@ ble_phy_tx(ble_phy_tx_pducb_t pducb, void *pducb_arg, uint8_t end_trans)
         return BLE_PHY_ERR_RADIO_STATE;
     }
 
-    /* Select tx address */
-    if (g_ble_phy_data.phy_chan < BLE_PHY_NUM_DATA_CHANS) {
-        /* XXX: fix this */
-        assert(0);
-    } else {
-    }
-
     /* Set the PHY transition */
     g_ble_phy_data.phy_transition = end_trans;
 
     /* Set phy state to transmitting and count packet statistics */
     g_ble_phy_data.phy_state = BLE_PHY_STATE_TX;
     ++g_ble_phy_stats.tx_good;
-    g_ble_phy_stats.tx_bytes += pducb(g_ble_phy_tx_buf, pducb_arg, &hdr_byte) +
-                                BLE_LL_PDU_HDR_LEN;
+
+#if MYNEWT_VAL(BLE_PHY_NATIVE_SIM)
+    frame = &g_ble_phy_tx_frame;
+    payload_len = pducb(&frame->pdu[BLE_LL_PDU_HDR_LEN], pducb_arg,
+                        &hdr_byte);
+    frame->pdu[0] = hdr_byte;
+    frame->pdu[1] = payload_len;
+    frame->pdu_len = payload_len + BLE_LL_PDU_HDR_LEN;
+    frame->chan = g_ble_phy_data.phy_chan;
+    frame->phy_mode = BLE_PHY_MODE_1M;
+    frame->txpwr_dbm = g_ble_phy_data.phy_txpwr_dbm;
+    frame->access_addr = g_ble_phy_data.phy_access_address;
+    frame->air_usecs = ble_ll_pdu_tx_time_get(payload_len, BLE_PHY_MODE_1M);
+
+    ble_phy_sim_tx(frame);
+    ble_phy_sim_tx_end_set(frame->air_usecs);
+#else
+    payload_len = pducb(g_ble_phy_tx_buf, pducb_arg, &hdr_byte);
+#endif
+
+    g_ble_phy_data.phy_tx_pyld_len = payload_len;
+    g_ble_phy_stats.tx_bytes += payload_len + BLE_LL_PDU_HDR_LEN;
     rc = BLE_ERR_SUCCESS;
 
     return rc;
@@ -566,7 +633,11 @@ ble_phy_setchan(uint8_t chan, uint32_t access_addr, uint32_t crcinit)
 void
 ble_phy_disable(void)
 {
+#if MYNEWT_VAL(BLE_PHY_NATIVE_SIM)
+    ble_phy_sim_timers_clear();
+#endif
     g_ble_phy_data.phy_state = BLE_PHY_STATE_IDLE;
+    g_ble_phy_data.phy_rx_started = 0;
 }
 
 /* Gets the current access address */
@@ -639,6 +710,14 @@ ble_phy_xcvr_state_get(void)
 void
 ble_phy_wfr_enable(int txrx, uint8_t tx_phy_mode, uint32_t wfr_usecs)
 {
+#if MYNEWT_VAL(BLE_PHY_NATIVE_SIM)
+    if (txrx == BLE_PHY_WFR_ENABLE_TXRX) {
+        /* Response is due T_IFS after our transmission ended */
+        ble_phy_sim_wfr_set(BLE_LL_IFS);
+    } else if (wfr_usecs) {
+        ble_phy_sim_wfr_set(wfr_usecs);
+    }
+#endif
 }
 
 void
@@ -650,3 +729,58 @@ void
 ble_phy_rfclk_disable(void)
 {
 }
+
+#if MYNEWT_VAL(BLE_PHY_NATIVE_SIM)
+/**
+ * Called by the air medium when a frame has been received in full.
+ *
+ * Frames are dropped unless the PHY is listening on the channel and access
+ * address the frame was sent on, just as a real receiver would miss them.
+ *
+ * @param frame     The received frame
+ * @param rssi      RSSI computed by the medium
+ * @param age_usecs Time since the frame started arriving
+ */
+void
+ble_phy_sim_rx_isr(const struct ble_phy_sim_frame *frame, int8_t rssi,
+                   uint32_t age_usecs)
+{
+    if ((g_ble_phy_data.phy_state != BLE_PHY_STATE_RX) ||
+        (frame->chan != g_ble_phy_data.phy_chan) ||
+        (frame->access_addr != g_ble_phy_data.phy_access_address)) {
+        return;
+    }
+
+    /* Got something; the wait for response is over */
+    ble_phy_sim_timers_clear();
+
+    memcpy(g_ble_phy_data.rxdptr, frame->pdu, frame->pdu_len);
+    g_ble_phy_data.phy_rx_rssi = rssi;
+    g_ble_phy_data.rxhdr.beg_cputime = os_cputime_get32() -
+                                       os_cputime_usecs_to_ticks(age_usecs);
+    g_ble_phy_data.rxhdr.rem_usecs = 0;
+
+    g_xcvr_data.irq_status |= BLE_XCVR_IRQ_F_RX_START | BLE_XCVR_IRQ_F_RX_END;
+    ble_phy_isr();
+}
+
+void
+ble_phy_sim_tx_end_isr(void)
+{
+    if (g_ble_phy_data.phy_state != BLE_PHY_STATE_TX) {
+        return;
+    }
+
+    g_xcvr_data.irq_status |= BLE_XCVR_IRQ_F_TX_END;
+    ble_phy_isr();
+}
+
+void
+ble_phy_sim_wfr_isr(void)
+{
+    if ((g_ble_phy_data.phy_state == BLE_PHY_STATE_RX) &&
+        !g_ble_phy_data.phy_rx_started) {
+        ble_ll_wfr_timer_exp(NULL);
+    }
+}
+#endif
@@ -0,0 +1,583 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Virtual air medium for the native PHY.
+ *
+ * Every node joins the medium by binding a UNIX datagram socket inside a
+ * shared directory, named after its node id (the PHY uses its process id).
+ * A transmitted frame is queued to the node's medium thread, which sends it
+ * to every other socket in the directory; the list of peers is refreshed by
+ * that thread periodically so that transmit from the PHY is a single send.
+ *
+ * The medium thread never touches PHY or link layer state. Radio interrupts
+ * are emulated from cputime timers instead, in the context the link layer
+ * runs its own timers in: the receive timer polls the socket, applies the
+ * configured latency, loss and RSSI and hands frames that have been fully
+ * received to the PHY as if they came from the radio. Channel and access
+ * address filtering is left to the PHY, so nodes tuned elsewhere simply do
+ * not hear the frame.
+ *
+ * The compile time defaults can be overridden per process through the
+ * environment, which allows running several nodes from one build:
+ *
+ *   BLE_PHY_SIM_DIR          Medium directory
+ *   BLE_PHY_SIM_LATENCY_US   Latency added to every frame (usecs)
+ *   BLE_PHY_SIM_LOSS_PCT     Percentage of received frames dropped
+ *   BLE_PHY_SIM_RSSI         RSSI reported for a 0 dBm transmitter
+ *
+ * Timing is best effort; frames are picked up by polling and timers run on
+ * a regular Linux scheduler, so the wait for response timer is padded
+ * accordingly.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "syscfg/syscfg.h"
+
+#if MYNEWT_VAL(BLE_PHY_NATIVE_SIM)
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "os/os.h"
+#include "os/os_cputime.h"
+#include "ble/ble_phy_sim.h"
+
+#define BLE_PHY_SIM_MAX_NODES   (MYNEWT_VAL(BLE_PHY_NATIVE_SIM_MAX_NODES))
+
+/* Interval at which medium directory is rescanned for nodes (usecs) */
+#define BLE_PHY_SIM_PEERS_REFRESH_USECS (100000)
+
+/* Interval at which the socket is polled for received frames (usecs) */
+#define BLE_PHY_SIM_POLL_USECS  (MYNEWT_VAL(BLE_PHY_NATIVE_SIM_POLL_US))
+
+static struct ble_phy_sim_node g_ble_phy_sim;
+static int g_ble_phy_sim_joined;
+
+static uint64_t
+ble_phy_sim_now(void)
+{
+    struct timespec ts;
+
+    /* CLOCK_MONOTONIC is shared by all processes on the host. */
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static long
+ble_phy_sim_env(const char *name, long dflt)
+{
+    const char *val;
+    char *end;
+    long l;
+
+    val = getenv(name);
+    if (val == NULL || *val == '\0') {
+        return dflt;
+    }
+
+    l = strtol(val, &end, 0);
+    if (*end != '\0') {
+        return dflt;
+    }
+
+    return l;
+}
+
+/*
+ * Rescans medium directory for nodes. Directory mtime is not used to skip
+ * the scan as its granularity is too coarse to catch nodes joining in quick
+ * succession.
+ */
+static void
+ble_phy_sim_peers_refresh(struct ble_phy_sim_node *node, uint64_t now)
+{
+    struct dirent *de;
+    DIR *d;
+
+    if (now < node->peers_refresh_usecs) {
+        return;
+    }
+    node->peers_refresh_usecs = now + BLE_PHY_SIM_PEERS_REFRESH_USECS;
+
+    d = opendir(node->dir);
+    if (d == NULL) {
+        node->num_peers = 0;
+        return;
+    }
+
+    node->num_peers = 0;
+    while ((de = readdir(d)) != NULL) {
+        /* Nodes are named after their node id */
+        if (de->d_name[0] < '0' || de->d_name[0] > '9' ||
+            strlen(de->d_name) > 10) {
+            continue;
+        }
+        if (strtoul(de->d_name, NULL, 10) == node->node_id) {
+            continue;
+        }
+        if (node->num_peers == BLE_PHY_SIM_MAX_NODES) {
+            break;
+        }
+
+        node->peers[node->num_peers].sun_family = AF_UNIX;
+        snprintf(node->peers[node->num_peers].sun_path,
+                 sizeof(node->peers[0].sun_path), "%s/%.10s",
+                 node->dir, de->d_name);
+        ++node->num_peers;
+    }
+    closedir(d);
+}
+
+void
+ble_phy_sim_node_tx(struct ble_phy_sim_node *node,
+                    struct ble_phy_sim_frame *frame)
+{
+    size_t len;
+
+    frame->magic = BLE_PHY_SIM_FRAME_MAGIC;
+    frame->src = node->node_id;
+    frame->tx_usecs = ble_phy_sim_now();
+    len = offsetof(struct ble_phy_sim_frame, pdu) + frame->pdu_len;
+
+    /* Medium thread delivers the frame to other nodes. */
+    if (send(node->tx_fd[1], frame, len, MSG_DONTWAIT) < 0) {
+        ++node->stats.tx_errs;
+        return;
+    }
+
+    ++node->stats.tx_frames;
+}
+
+/* Sends all frames queued for transmission to every other node. */
+static void
+ble_phy_sim_fanout(struct ble_phy_sim_node *node)
+{
+    struct ble_phy_sim_frame frame;
+    ssize_t len;
+    ssize_t rc;
+    int i;
+
+    for (;;) {
+        len = recv(node->tx_fd[0], &frame, sizeof(frame), MSG_DONTWAIT);
+        if (len < 0) {
+            return;
+        }
+
+        ble_phy_sim_peers_refresh(node, ble_phy_sim_now());
+
+        for (i = 0; i < node->num_peers; i++) {
+            rc = sendto(node->sock, &frame, len, MSG_DONTWAIT,
+                        (struct sockaddr *)&node->peers[i],
+                        sizeof(node->peers[i]));
+            if (rc >= 0) {
+                continue;
+            }
+
+            if (errno == ECONNREFUSED || errno == ENOENT) {
+                /* Node went away without leaving the medium; clean up. */
+                unlink(node->peers[i].sun_path);
+                node->peers_refresh_usecs = 0;
+                ++node->stats.stale_nodes;
+            } else {
+                ++node->stats.fanout_errs;
+            }
+        }
+    }
+}
+
+static void *
+ble_phy_sim_thread(void *arg)
+{
+    struct ble_phy_sim_node *node;
+    struct pollfd pfd;
+    struct timespec ts;
+    uint64_t now;
+
+    node = arg;
+
+    pfd.fd = node->tx_fd[0];
+    pfd.events = POLLIN;
+
+    for (;;) {
+        now = ble_phy_sim_now();
+
+        /* Keep peer list up to date even if nothing is transmitted. */
+        ble_phy_sim_peers_refresh(node, now);
+
+        if (node->peers_refresh_usecs > now) {
+            ts.tv_sec = (node->peers_refresh_usecs - now) / 1000000;
+            ts.tv_nsec = ((node->peers_refresh_usecs - now) % 1000000) * 1000;
+            ppoll(&pfd, 1, &ts, NULL);
+        }
+
+        ble_phy_sim_fanout(node);
+    }
+
+    return NULL;
+}
+
+/* Arms a cputime timer for an absolute time on the medium clock. */
+static void
+ble_phy_sim_timer_at(struct hal_timer *timer, uint64_t at_usecs)
+{
+    uint64_t now;
+
+    now = ble_phy_sim_now();
+    os_cputime_timer_relative(timer, at_usecs > now ?
+                                     (uint32_t)(at_usecs - now) : 0);
+}
+
+void
+ble_phy_sim_node_tx_end_set(struct ble_phy_sim_node *node, uint32_t usecs)
+{
+    os_cputime_timer_relative(&node->tx_end_timer, usecs);
+}
+
+void
+ble_phy_sim_node_wfr_set(struct ble_phy_sim_node *node, uint32_t usecs)
+{
+    uint32_t pad;
+
+    /* Round trip through the medium plus polling and scheduling jitter. */
+    pad = 2 * node->latency_usecs + MYNEWT_VAL(BLE_PHY_NATIVE_SIM_WFR_PAD_US);
+
+    node->wfr_armed = 1;
+    os_cputime_timer_relative(&node->wfr_timer, usecs + pad);
+}
+
+void
+ble_phy_sim_node_timers_clear(struct ble_phy_sim_node *node)
+{
+    node->wfr_armed = 0;
+    os_cputime_timer_stop(&node->tx_end_timer);
+    os_cputime_timer_stop(&node->wfr_timer);
+}
+
+/* Reads all pending frames from the socket into the receive queue. */
+static void
+ble_phy_sim_recv(struct ble_phy_sim_node *node)
+{
+    struct ble_phy_sim_rx_entry *ent;
+    struct ble_phy_sim_frame *frame;
+    struct ble_phy_sim_frame scratch;
+    ssize_t rc;
+    uint8_t idx;
+
+    for (;;) {
+        if (node->rxq_cnt == BLE_PHY_SIM_RXQ_LEN) {
+            /* Receiver is not keeping up; drop the frame. */
+            rc = recv(node->sock, &scratch, sizeof(scratch), MSG_DONTWAIT);
+            if (rc < 0) {
+                return;
+            }
+            ++node->stats.rx_overflow;
+            continue;
+        }
+
+        idx = (node->rxq_head + node->rxq_cnt) % BLE_PHY_SIM_RXQ_LEN;
+        ent = &node->rxq[idx];
+        frame = &ent->frame;
+
+        rc = recv(node->sock, frame, sizeof(*frame), MSG_DONTWAIT);
+        if (rc < 0) {
+            return;
+        }
+
+        if (rc < (ssize_t)offsetof(struct ble_phy_sim_frame, pdu) ||
+            frame->magic != BLE_PHY_SIM_FRAME_MAGIC ||
+            frame->src == node->node_id ||
+            rc != (ssize_t)(offsetof(struct ble_phy_sim_frame, pdu) +
+                            frame->pdu_len)) {
+            continue;
+        }
+
+        ++node->stats.rx_frames;
+
+        if (node->loss_pct &&
+            (uint32_t)(rand_r(&node->rand_seed) % 100) < node->loss_pct) {
+            ++node->stats.rx_lost;
+            continue;
+        }
+
+        /* Frame is handed over once it has been fully received. */
+        ent->start_usecs = frame->tx_usecs + node->latency_usecs;
+        ent->due_usecs = ent->start_usecs + frame->air_usecs;
+        ent->rssi = node->rssi_dbm + frame->txpwr_dbm;
+        ++node->rxq_cnt;
+    }
+}
+
+/* Picks up received frames and hands those that are due to the PHY. */
+static void
+ble_phy_sim_rx_run(struct ble_phy_sim_node *node)
+{
+    struct ble_phy_sim_rx_entry *ent;
+    uint64_t now;
+
+    ble_phy_sim_recv(node);
+
+    now = ble_phy_sim_now();
+    while (node->rxq_cnt) {
+        ent = &node->rxq[node->rxq_head];
+        if (ent->due_usecs > now) {
+            break;
+        }
+
+        node->rxq_head = (node->rxq_head + 1) % BLE_PHY_SIM_RXQ_LEN;
+        --node->rxq_cnt;
+
+        node->isrs->rx(node, &ent->frame, ent->rssi,
+                       (uint32_t)(now - ent->start_usecs));
+    }
+}
+
+static void
+ble_phy_sim_rx_timer_cb(void *arg)
+{
+    struct ble_phy_sim_node *node;
+    uint64_t next;
+
+    node = arg;
+
+    ble_phy_sim_rx_run(node);
+
+    next = ble_phy_sim_now() + BLE_PHY_SIM_POLL_USECS;
+    if (node->rxq_cnt && node->rxq[node->rxq_head].due_usecs < next) {
+        next = node->rxq[node->rxq_head].due_usecs;
+    }
+    ble_phy_sim_timer_at(&node->rx_timer, next);
+}
+
+static void
+ble_phy_sim_tx_end_timer_cb(void *arg)
+{
+    struct ble_phy_sim_node *node;
+
+    node = arg;
+    node->isrs->tx_end(node);
+}
+
+static void
+ble_phy_sim_wfr_timer_cb(void *arg)
+{
+    struct ble_phy_sim_node *node;
+
+    node = arg;
+
+    /* A response that arrived since the last poll ends the wait. */
+    ble_phy_sim_rx_run(node);
+
+    if (node->wfr_armed) {
+        node->wfr_armed = 0;
+        node->isrs->wfr(node);
+    }
+}
+
+int
+ble_phy_sim_node_init(struct ble_phy_sim_node *node, const char *dir,
+                      uint32_t node_id, const struct ble_phy_sim_isrs *isrs)
+{
+    int rc;
+
+    memset(node, 0, sizeof(*node));
+    node->sock = -1;
+    node->isrs = isrs;
+
+    if (strlen(dir) >= sizeof(node->dir)) {
+        return -1;
+    }
+    strcpy(node->dir, dir);
+
+    node->latency_usecs = ble_phy_sim_env("BLE_PHY_SIM_LATENCY_US",
+                                    MYNEWT_VAL(BLE_PHY_NATIVE_SIM_LATENCY_US));
+    node->loss_pct = ble_phy_sim_env("BLE_PHY_SIM_LOSS_PCT",
+                                     MYNEWT_VAL(BLE_PHY_NATIVE_SIM_LOSS_PCT));
+    node->rssi_dbm = ble_phy_sim_env("BLE_PHY_SIM_RSSI",
+                                     MYNEWT_VAL(BLE_PHY_NATIVE_SIM_RSSI));
+    if (node->loss_pct > 100) {
+        node->loss_pct = 100;
+    }
+
+    node->node_id = node_id;
+    node->rand_seed = node_id ^ (unsigned int)ble_phy_sim_now();
+
+    if (mkdir(node->dir, 0777) != 0 && errno != EEXIST) {
+        return -1;
+    }
+
+    node->sock = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (node->sock < 0) {
+        return -1;
+    }
+
+    node->self.sun_family = AF_UNIX;
+    snprintf(node->self.sun_path, sizeof(node->self.sun_path), "%s/%u",
+             node->dir, (unsigned int)node->node_id);
+    unlink(node->self.sun_path);
+
+    rc = bind(node->sock, (struct sockaddr *)&node->self,
+              sizeof(node->self));
+    if (rc != 0) {
+        goto err;
+    }
+
+    rc = socketpair(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0, node->tx_fd);
+    if (rc != 0) {
+        goto err_bound;
+    }
+
+    rc = pthread_create(&node->thread, NULL, ble_phy_sim_thread, node);
+    if (rc != 0) {
+        close(node->tx_fd[0]);
+        close(node->tx_fd[1]);
+        goto err_bound;
+    }
+
+    os_cputime_timer_init(&node->tx_end_timer, ble_phy_sim_tx_end_timer_cb,
+                          node);
+    os_cputime_timer_init(&node->wfr_timer, ble_phy_sim_wfr_timer_cb, node);
+    os_cputime_timer_init(&node->rx_timer, ble_phy_sim_rx_timer_cb, node);
+    os_cputime_timer_relative(&node->rx_timer, BLE_PHY_SIM_POLL_USECS);
+
+    return 0;
+
+err_bound:
+    unlink(node->self.sun_path);
+err:
+    close(node->sock);
+    node->sock = -1;
+    return -1;
+}
+
+void
+ble_phy_sim_node_leave(struct ble_phy_sim_node *node)
+{
+    ble_phy_sim_node_timers_clear(node);
+    os_cputime_timer_stop(&node->rx_timer);
+
+    pthread_cancel(node->thread);
+    pthread_join(node->thread, NULL);
+
+    unlink(node->self.sun_path);
+    close(node->tx_fd[0]);
+    close(node->tx_fd[1]);
+    close(node->sock);
+    node->sock = -1;
+}
+
+static void
+ble_phy_sim_phy_rx(struct ble_phy_sim_node *node,
+                   const struct ble_phy_sim_frame *frame, int8_t rssi,
+                   uint32_t age_usecs)
+{
+    ble_phy_sim_rx_isr(frame, rssi, age_usecs);
+}
+
+static void
+ble_phy_sim_phy_tx_end(struct ble_phy_sim_node *node)
+{
+    ble_phy_sim_tx_end_isr();
+}
+
+static void
+ble_phy_sim_phy_wfr(struct ble_phy_sim_node *node)
+{
+    ble_phy_sim_wfr_isr();
+}
+
+static const struct ble_phy_sim_isrs ble_phy_sim_phy_isrs = {
+    .rx = ble_phy_sim_phy_rx,
+    .tx_end = ble_phy_sim_phy_tx_end,
+    .wfr = ble_phy_sim_phy_wfr,
+};
+
+static void
+ble_phy_sim_leave(void)
+{
+    unlink(g_ble_phy_sim.self.sun_path);
+}
+
+int
+ble_phy_sim_init(void)
+{
+    const char *dir;
+    int rc;
+
+    /* The PHY is re-initialized on every link layer reset. */
+    if (g_ble_phy_sim_joined) {
+        return 0;
+    }
+
+    dir = getenv("BLE_PHY_SIM_DIR");
+    if (dir == NULL || *dir == '\0') {
+        dir = MYNEWT_VAL(BLE_PHY_NATIVE_SIM_DIR);
+    }
+
+    rc = ble_phy_sim_node_init(&g_ble_phy_sim, dir, getpid(),
+                               &ble_phy_sim_phy_isrs);
+    if (rc != 0) {
+        return rc;
+    }
+
+    atexit(ble_phy_sim_leave);
+    g_ble_phy_sim_joined = 1;
+
+    return 0;
+}
+
+void
+ble_phy_sim_tx(struct ble_phy_sim_frame *frame)
+{
+    ble_phy_sim_node_tx(&g_ble_phy_sim, frame);
+}
+
+void
+ble_phy_sim_tx_end_set(uint32_t usecs)
+{
+    ble_phy_sim_node_tx_end_set(&g_ble_phy_sim, usecs);
+}
+
+void
+ble_phy_sim_wfr_set(uint32_t usecs)
+{
+    ble_phy_sim_node_wfr_set(&g_ble_phy_sim, usecs);
+}
+
+void
+ble_phy_sim_timers_clear(void)
+{
+    ble_phy_sim_node_timers_clear(&g_ble_phy_sim);
+}
+
+#endif
@@ -56,6 +56,8 @@ struct os_mbuf;
 #define BLE_ATT_ERR_INSUFFICIENT_ENC        0x0f
 #define BLE_ATT_ERR_UNSUPPORTED_GROUP       0x10
 #define BLE_ATT_ERR_INSUFFICIENT_RES        0x11
+#define BLE_ATT_ERR_DB_OUT_OF_SYNC          0x12
+#define BLE_ATT_ERR_VALUE_NOT_ALLOWED       0x13
 
 #define BLE_ATT_OP_ERROR_RSP                0x01
 #define BLE_ATT_OP_MTU_REQ                  0x02
@@ -83,7 +85,11 @@ struct os_mbuf;
 #define BLE_ATT_OP_NOTIFY_REQ               0x1b
 #define BLE_ATT_OP_INDICATE_REQ             0x1d
 #define BLE_ATT_OP_INDICATE_RSP             0x1e
+#define BLE_ATT_OP_READ_MULT_VAR_REQ        0x20
+#define BLE_ATT_OP_READ_MULT_VAR_RSP        0x21
+#define BLE_ATT_OP_NOTIFY_MULTI_REQ         0x23
 #define BLE_ATT_OP_WRITE_CMD                0x52
+#define BLE_ATT_OP_SIGNED_WRITE_CMD         0xd2
 
 #define BLE_ATT_ATTR_MAX_LEN                512
 
@@ -183,6 +189,26 @@ uint16_t ble_att_preferred_mtu(void);
  */
 int ble_att_set_preferred_mtu(uint16_t mtu);
 
+/**
+ * Opens Enhanced ATT bearers to the peer.  The bearers are L2CAP enhanced
+ * credit based channels; once connected, GATT client procedures are spread
+ * across them so they no longer wait for each other.  A BLE_GAP_EVENT_MTU
+ * event is reported for each bearer that gets connected.
+ *
+ * The link has to be encrypted.  Requires BLE_EATT_CHAN_NUM > 0.
+ *
+ * @param conn_handle           The connection to open the bearers on.
+ * @param num_bearers           The number of bearers to open.
+ *
+ * @return                      0 if the bearers are being connected;
+ *                              BLE_HS_EENCRYPT if the link is not encrypted;
+ *                              BLE_HS_ENOMEM if there are not enough free
+ *                                  bearers;
+ *                              BLE_HS_ENOTSUP if EATT is not compiled in;
+ *                              Other nonzero on error.
+ */
+int ble_att_eatt_connect(uint16_t conn_handle, uint8_t num_bearers);
+
 #ifdef __cplusplus
 }
 #endif
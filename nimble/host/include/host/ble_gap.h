@@ -1874,6 +1874,53 @@ int ble_gap_encryption_initiate(uint16_t conn_handle, uint8_t key_size,
  */
 int ble_gap_conn_rssi(uint16_t conn_handle, int8_t *out_rssi);
 
+/** Outgoing ACL data queue statistics for a single connection. */
+struct ble_gap_conn_tx_stats {
+    /** Number of packets currently waiting for controller buffers. */
+    uint16_t queue_len;
+
+    /** Highest number of packets that waited at the same time. */
+    uint16_t queue_len_max;
+
+    /** Longest time, in milliseconds, a packet waited at the queue head. */
+    uint32_t wait_max_ms;
+
+    /** Share of controller buffers; see ble_gap_set_tx_weight(). */
+    uint8_t weight;
+};
+
+/**
+ * Sets the share of controller ACL buffers a connection receives when several
+ * connections have queued outgoing data.  A connection with weight 4 is given
+ * four times as many buffers as a connection with weight 1.  Newly created
+ * connections have a weight of 1.  Only available when
+ * BLE_HS_TX_SCHED_WEIGHTED is enabled.
+ *
+ * @param conn_handle           The connection to configure.
+ * @param weight                The weight to assign; must be nonzero.
+ *
+ * @return                      0 on success;
+ *                              BLE_HS_ENOTCONN if there is no connection with
+ *                                  the specified handle;
+ *                              BLE_HS_EINVAL if the weight is zero;
+ *                              BLE_HS_ENOTSUP if weighted scheduling is
+ *                                  disabled.
+ */
+int ble_gap_set_tx_weight(uint16_t conn_handle, uint8_t weight);
+
+/**
+ * Retrieves outgoing ACL data queue statistics for a connection.
+ *
+ * @param conn_handle           The connection to query.
+ * @param out_stats             On success, the statistics are written here.
+ *
+ * @return                      0 on success;
+ *                              BLE_HS_ENOTCONN if there is no connection with
+ *                                  the specified handle.
+ */
+int ble_gap_conn_tx_stats(uint16_t conn_handle,
+                          struct ble_gap_conn_tx_stats *out_stats);
+
 /**
  * Unpairs a device with the specified address. The keys related to that peer
  * device are removed from storage and peer address is removed from the resolve
@@ -44,6 +44,18 @@ struct ble_hs_cfg;
 
 #define BLE_GATT_SVC_UUID16                             0x1801
 #define BLE_GATT_DSC_CLT_CFG_UUID16                     0x2902
+#define BLE_GATT_CHR_DB_HASH_UUID16                     0x2b2a
+
+/** Size of the Database Hash characteristic value. */
+#define BLE_GATT_DB_HASH_SZ                             16
+
+/** Size of the Client Supported Features characteristic value we track. */
+#define BLE_GATT_CHR_CLI_SUP_FEAT_SZ                    1
+
+/** Client Supported Features bits (octet 0). */
+#define BLE_GATT_CLI_SUP_FEAT_ROBUST_CACHING            0x01
+#define BLE_GATT_CLI_SUP_FEAT_EATT                      0x02
+#define BLE_GATT_CLI_SUP_FEAT_MULT_NTF                  0x04
 
 #define BLE_GATT_CHR_PROP_BROADCAST                     0x01
 #define BLE_GATT_CHR_PROP_READ                          0x02
@@ -97,6 +109,15 @@ struct ble_gatt_attr {
     struct os_mbuf *om;
 };
 
+/** One value of a multiple handle value notification. */
+struct ble_gatt_notif {
+    /** The characteristic value handle. */
+    uint16_t handle;
+
+    /** The value to send; NULL to read it from the characteristic. */
+    struct os_mbuf *value;
+};
+
 struct ble_gatt_chr {
     uint16_t def_handle;
     uint16_t val_handle;
@@ -137,6 +158,18 @@ typedef int ble_gatt_reliable_attr_fn(uint16_t conn_handle,
                                       struct ble_gatt_attr *attrs,
                                       uint8_t num_attrs, void *arg);
 
+/**
+ * Reports the values read by a Read Multiple Variable Length Characteristic
+ * Values procedure; attrs[i] corresponds to the i-th requested handle.  The
+ * host will free the attribute mbufs automatically after the callback is
+ * executed.  The application can take ownership of the mbufs and prevent them
+ * from being freed by assigning NULL to each attribute's om field.
+ */
+typedef int ble_gatt_attr_mult_fn(uint16_t conn_handle,
+                                  const struct ble_gatt_error *error,
+                                  struct ble_gatt_attr *attrs,
+                                  uint8_t num_attrs, void *arg);
+
 typedef int ble_gatt_chr_fn(uint16_t conn_handle,
                             const struct ble_gatt_error *error,
                             const struct ble_gatt_chr *chr, void *arg);
@@ -147,6 +180,65 @@ typedef int ble_gatt_dsc_fn(uint16_t conn_handle,
                             const struct ble_gatt_dsc *dsc,
                             void *arg);
 
+/**
+ * Reports the outcome of ble_gattc_cache_discover().  A status of 0 means the
+ * procedure completed; the connection's discovery procedures are served from
+ * the cache only if it could be validated or populated.
+ */
+typedef int ble_gatt_cache_fn(uint16_t conn_handle, int status, void *arg);
+
+#define BLE_GATT_DISC_DB_EVENT_SVC                      1
+#define BLE_GATT_DISC_DB_EVENT_CHR                      2
+#define BLE_GATT_DISC_DB_EVENT_DSC                      3
+#define BLE_GATT_DISC_DB_EVENT_DONE                     4
+
+/**
+ * Reports one step of a ble_gattc_disc_db() procedure.  Services,
+ * characteristics and descriptors are reported as they are discovered; as the
+ * discovery phases overlap, events of different types interleave and
+ * descriptors of different characteristics are not necessarily reported in
+ * handle order.  The final event is always BLE_GATT_DISC_DB_EVENT_DONE.
+ */
+struct ble_gatt_disc_db_event {
+    /** BLE_GATT_DISC_DB_EVENT_[...]. */
+    uint8_t type;
+
+    union {
+        /** BLE_GATT_DISC_DB_EVENT_SVC: A primary service. */
+        const struct ble_gatt_svc *svc;
+
+        /** BLE_GATT_DISC_DB_EVENT_CHR: A characteristic. */
+        const struct ble_gatt_chr *chr;
+
+        /** BLE_GATT_DISC_DB_EVENT_DSC: A characteristic descriptor. */
+        struct {
+            uint16_t chr_val_handle;
+            const struct ble_gatt_dsc *dsc;
+        } dsc;
+
+        /** BLE_GATT_DISC_DB_EVENT_DONE: The procedure is over. */
+        struct {
+            /** 0 if the whole database has been discovered. */
+            int status;
+
+            /** Number of ATT requests the procedure sent to the peer. */
+            uint16_t num_reqs;
+
+            /** Time the procedure took, in milliseconds. */
+            uint32_t elapsed_ms;
+        } done;
+    };
+};
+
+/**
+ * Receives the events of a ble_gattc_disc_db() procedure.  Returning nonzero
+ * from a service, characteristic or descriptor event aborts the procedure;
+ * no further events are reported.
+ */
+typedef int ble_gatt_disc_db_fn(uint16_t conn_handle,
+                                const struct ble_gatt_disc_db_event *event,
+                                void *arg);
+
 /**
  * Initiates GATT procedure: Exchange MTU.
  *
@@ -343,6 +435,27 @@ int ble_gattc_read_mult(uint16_t conn_handle, const uint16_t *handles,
                         uint8_t num_handles, ble_gatt_attr_fn *cb,
                         void *cb_arg);
 
+/**
+ * Initiates GATT procedure: Read Multiple Variable Length Characteristic
+ * Values.  Unlike ble_gattc_read_mult(), the values are reported separately,
+ * so they need not have a fixed length.
+ *
+ * @param conn_handle           The connection over which to execute the
+ *                                  procedure.
+ * @param handles               An array of 16-bit attribute handles to read;
+ *                                  at least two.
+ * @param num_handles           The number of entries in the "handles" array.
+ * @param cb                    The function to call to report procedure status
+ *                                  updates; null for no callback.
+ * @param cb_arg                The optional argument to pass to the callback
+ *                                  function.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int ble_gattc_read_mult_var(uint16_t conn_handle, const uint16_t *handles,
+                            uint8_t num_handles, ble_gatt_attr_mult_fn *cb,
+                            void *cb_arg);
+
 /**
  * Initiates GATT procedure: Write Without Response.  This function consumes
  * the supplied mbuf regardless of the outcome.
@@ -487,6 +600,67 @@ int ble_gattc_notify_custom(uint16_t conn_handle, uint16_t att_handle,
  */
 int ble_gattc_notify(uint16_t conn_handle, uint16_t chr_val_handle);
 
+/**
+ * Sends a "free-form" characteristic notification to several connections.
+ * Only the attribute read is done once; the payload is not shared.  Each
+ * recipient except the last receives its own copy of the supplied mbuf,
+ * since every connection prepends its own headers.  A failure to notify one
+ * connection does not prevent the others from being notified.  This function
+ * consumes the supplied mbuf regardless of the outcome.
+ *
+ * @param conn_handles          The connections to send the notification over.
+ * @param num_conns             The number of entries in the conn_handles
+ *                                  array.
+ * @param chr_val_handle        The attribute handle to indicate in the
+ *                                  outgoing notifications.
+ * @param txom                  The value to write to the characteristic; null
+ *                                  to read the value from the characteristic.
+ *
+ * @return                      0 if all notifications were sent; otherwise the
+ *                                  first error encountered.
+ */
+int ble_gattc_notify_multi_custom(const uint16_t *conn_handles, int num_conns,
+                                  uint16_t chr_val_handle,
+                                  struct os_mbuf *txom);
+
+/**
+ * Sends a characteristic notification to several connections.  The
+ * characteristic value is read once, so the access callback runs a single
+ * time; each connection is still sent its own copy of the value.
+ *
+ * @param conn_handles          The connections to send the notification over.
+ * @param num_conns             The number of entries in the conn_handles
+ *                                  array.
+ * @param chr_val_handle        The value attribute handle of the
+ *                                  characteristic to include in the outgoing
+ *                                  notifications.
+ *
+ * @return                      0 if all notifications were sent; otherwise the
+ *                                  first error encountered.
+ */
+int ble_gattc_notify_multi(const uint16_t *conn_handles, int num_conns,
+                           uint16_t chr_val_handle);
+
+/**
+ * Sends notifications for several characteristics to one peer.  If the peer
+ * has enabled Multiple Handle Value Notifications in its Client Supported
+ * Features, the values are packed into as few Multiple Handle Value
+ * Notification PDUs as the MTU allows; otherwise, or for values too large to
+ * share a PDU, a regular notification is sent.  This function consumes the
+ * supplied values regardless of the outcome.
+ *
+ * @param conn_handle           The connection over which to send the
+ *                                  notifications.
+ * @param notifs                The handles and values to send.  The values
+ *                                  are set to NULL as they are consumed.
+ * @param num_notifs            The number of entries in the notifs array.
+ *
+ * @return                      0 if all notifications were sent; otherwise the
+ *                                  first error encountered.
+ */
+int ble_gattc_notify_handles(uint16_t conn_handle,
+                             struct ble_gatt_notif *notifs, int num_notifs);
+
 /**
  * Sends a "free-form" characteristic indication.  The provided mbuf contains
  * the indication payload.  This function consumes the supplied mbuf regardless
@@ -518,6 +692,60 @@ int ble_gattc_indicate_custom(uint16_t conn_handle, uint16_t chr_val_handle,
  */
 int ble_gattc_indicate(uint16_t conn_handle, uint16_t chr_val_handle);
 
+/**
+ * Validates the cached attribute tree of the specified peer, discovering and
+ * storing it first if necessary.  Only bonded peers are cached, and only
+ * over an encrypted link; on any other connection the procedure completes
+ * without validating a tree.  A stored tree is used only if the peer still
+ * exposes the same Database Hash.  Once this procedure completes with a
+ * validated tree, service, characteristic and descriptor discovery on
+ * the connection is answered from the store without any ATT traffic, until
+ * the peer indicates Service Changed.
+ *
+ * @param conn_handle           The connection over which to execute the
+ *                                  procedure.
+ * @param cb                    The function to call when the procedure
+ *                                  completes; null for no callback.
+ * @param cb_arg                The optional argument to pass to the callback
+ *                                  function.
+ *
+ * @return                      0 on success;
+ *                              BLE_HS_EALREADY if the procedure is already in
+ *                                  progress on this connection;
+ *                              BLE_HS_ENOTSUP if the discovery cache is not
+ *                                  compiled in;
+ *                              Other nonzero on failure.
+ */
+int ble_gattc_cache_discover(uint16_t conn_handle, ble_gatt_cache_fn *cb,
+                             void *cb_arg);
+
+/**
+ * Discovers every primary service, characteristic and descriptor of the
+ * peer's database.  Services and characteristics are each discovered with a
+ * single pass over the whole handle range, so every response is filled up to
+ * the ATT MTU; descriptors are only looked for between a characteristic's
+ * value and the next attribute that cannot be one of its descriptors.  When
+ * the connection has enhanced ATT bearers, the phases overlap and the
+ * descriptors of several characteristics are discovered simultaneously, one
+ * request per bearer.
+ *
+ * @param conn_handle           The connection over which to execute the
+ *                                  procedure.
+ * @param cb                    The function to report discovered attributes
+ *                                  and the procedure's outcome to.
+ * @param cb_arg                The optional argument to pass to the callback
+ *                                  function.
+ *
+ * @return                      0 on success;
+ *                              BLE_HS_EALREADY if the procedure is already in
+ *                                  progress on this connection;
+ *                              BLE_HS_ENOTSUP if the procedure is not
+ *                                  compiled in;
+ *                              Other nonzero on failure.
+ */
+int ble_gattc_disc_db(uint16_t conn_handle, ble_gatt_disc_db_fn *cb,
+                      void *cb_arg);
+
 int ble_gattc_init(void);
 
 /*** @server. */
@@ -794,6 +1022,53 @@ int ble_gatts_count_cfg(const struct ble_gatt_svc_def *defs);
  */
 void ble_gatts_chr_updated(uint16_t chr_val_handle);
 
+/**
+ * Retrieves the Client Supported Features the specified peer has written to
+ * the local GATT server.
+ *
+ * @param conn_handle           The connection of the peer.
+ * @param out_supported_feat    On success, the features get written here.
+ * @param len                   The size of the out_supported_feat buffer.
+ *
+ * @return                      0 on success;
+ *                              BLE_HS_ENOTCONN if the connection is unknown.
+ */
+int ble_gatts_peer_cl_sup_feat_get(uint16_t conn_handle,
+                                   uint8_t *out_supported_feat, uint8_t len);
+
+/**
+ * Applies a write to the Client Supported Features characteristic.  Meant to
+ * be called from the access callback of the characteristic.  Bits of
+ * features that are unknown or not built in are ignored.
+ *
+ * @param conn_handle           The connection of the writing peer.
+ * @param om                    The written value.
+ *
+ * @return                      0 on success;
+ *                              BLE_ATT_ERR_VALUE_NOT_ALLOWED if the write
+ *                                  would clear a previously set feature;
+ *                              BLE_ATT_ERR_UNLIKELY if the connection is
+ *                                  unknown.
+ */
+int ble_gatts_peer_cl_sup_feat_update(uint16_t conn_handle,
+                                      struct os_mbuf *om);
+
+/**
+ * Retrieves the Database Hash of the local GATT server.  The hash covers the
+ * attributes currently visible to peers; it is calculated on first use after
+ * the database changes.
+ *
+ * @param out_hash              On success, the BLE_GATT_DB_HASH_SZ-byte hash
+ *                                  gets written here, in little-endian byte
+ *                                  order.
+ *
+ * @return                      0 on success;
+ *                              BLE_HS_ENOTSUP if robust caching support is
+ *                                  not compiled in;
+ *                              Other nonzero on error.
+ */
+int ble_gatts_db_hash(uint8_t *out_hash);
+
 /**
  * Retrieves the attribute handle associated with a local GATT service.
  *
@@ -22,6 +22,8 @@
 
 #include <inttypes.h>
 #include "nimble/ble.h"
+#include "host/ble_uuid.h"
+#include "host/ble_gatt.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,6 +32,8 @@ extern "C" {
 #define BLE_STORE_OBJ_TYPE_OUR_SEC      1
 #define BLE_STORE_OBJ_TYPE_PEER_SEC     2
 #define BLE_STORE_OBJ_TYPE_CCCD         3
+#define BLE_STORE_OBJ_TYPE_PEER_ATTR    4
+#define BLE_STORE_OBJ_TYPE_CL_SUP_FEAT  5
 
 /** Failed to persist record; insufficient storage capacity. */
 #define BLE_STORE_EVENT_OVERFLOW        1
@@ -37,6 +41,14 @@ extern "C" {
 /** About to execute a procedure that may fail due to overflow. */
 #define BLE_STORE_EVENT_FULL            2
 
+/** Peer attribute record types; see struct ble_store_value_peer_attr. */
+#define BLE_STORE_PEER_ATTR_TYPE_SVC    1
+#define BLE_STORE_PEER_ATTR_TYPE_CHR    2
+#define BLE_STORE_PEER_ATTR_TYPE_DSC    3
+
+/** Terminates a discovered attribute tree; written once it is complete. */
+#define BLE_STORE_PEER_ATTR_TYPE_END    4
+
 /**
  * Used as a key for lookups of security material.  This struct corresponds to
  * the following store object types:
@@ -120,6 +132,90 @@ struct ble_store_value_cccd {
     unsigned value_changed:1;
 };
 
+/**
+ * Used as a key for lookups of a peer's cached GATT attributes.  This struct
+ * corresponds to the BLE_STORE_OBJ_TYPE_PEER_ATTR store object type.
+ */
+struct ble_store_key_peer_attr {
+    /**
+     * Key by peer identity address;
+     * peer_addr=BLE_ADDR_ANY means don't key off peer.
+     */
+    ble_addr_t peer_addr;
+
+    /** Key by database hash; db_hash_present=0 means don't key off hash. */
+    uint8_t db_hash[16];
+    unsigned db_hash_present:1;
+
+    /** Key by record type; type=0 means don't key off type. */
+    uint8_t type;
+
+    /** Key by attribute handle; handle=0 means don't key off handle. */
+    uint16_t handle;
+
+    /** Number of results to skip; 0 means retrieve the first match. */
+    uint8_t idx;
+};
+
+/**
+ * Represents one attribute of a peer's GATT database, as discovered by the
+ * GATT client.  Records belong to the bonded peer in peer_addr and, if
+ * db_hash_present is set, describe the database with that hash.  This struct
+ * corresponds to the BLE_STORE_OBJ_TYPE_PEER_ATTR store object type.
+ */
+struct ble_store_value_peer_attr {
+    ble_addr_t peer_addr;
+    uint8_t db_hash[16];
+    unsigned db_hash_present:1;
+
+    /** One of the BLE_STORE_PEER_ATTR_TYPE_[...] codes. */
+    uint8_t type;
+
+    /** Service start, characteristic definition or descriptor handle. */
+    uint16_t handle;
+
+    /** Service end or characteristic value handle. */
+    uint16_t end_handle;
+
+    /** Characteristic properties. */
+    uint8_t properties;
+
+    ble_uuid_any_t uuid;
+};
+
+/**
+ * Used as a key for lookups of the Client Supported Features of bonded peers.
+ * This struct corresponds to the BLE_STORE_OBJ_TYPE_CL_SUP_FEAT store object
+ * type.
+ */
+struct ble_store_key_cl_sup_feat {
+    /**
+     * Key by peer identity address;
+     * peer_addr=BLE_ADDR_ANY means don't key off peer.
+     */
+    ble_addr_t peer_addr;
+
+    /** Number of results to skip; 0 means retrieve the first match. */
+    uint8_t idx;
+};
+
+/**
+ * Represents the Client Supported Features written by a bonded peer, along
+ * with its robust caching state.  This struct corresponds to the
+ * BLE_STORE_OBJ_TYPE_CL_SUP_FEAT store object type.
+ */
+struct ble_store_value_cl_sup_feat {
+    ble_addr_t peer_addr;
+    uint8_t cl_sup_feat[BLE_GATT_CHR_CLI_SUP_FEAT_SZ];
+
+    /**
+     * Database Hash of the database the peer was last change-aware of;
+     * db_hash_present=0 means the peer is change-unaware.
+     */
+    uint8_t db_hash[BLE_GATT_DB_HASH_SZ];
+    unsigned db_hash_present:1;
+};
+
 /**
  * Used as a key for store lookups.  This union must be accompanied by an
  * object type code to indicate which field is valid.
@@ -127,6 +223,8 @@ struct ble_store_value_cccd {
 union ble_store_key {
     struct ble_store_key_sec sec;
     struct ble_store_key_cccd cccd;
+    struct ble_store_key_peer_attr peer_attr;
+    struct ble_store_key_cl_sup_feat cl_sup_feat;
 };
 
 /**
@@ -136,6 +234,8 @@ union ble_store_key {
 union ble_store_value {
     struct ble_store_value_sec sec;
     struct ble_store_value_cccd cccd;
+    struct ble_store_value_peer_attr peer_attr;
+    struct ble_store_value_cl_sup_feat cl_sup_feat;
 };
 
 struct ble_store_status_event {
@@ -266,10 +366,27 @@ int ble_store_read_cccd(const struct ble_store_key_cccd *key,
 int ble_store_write_cccd(const struct ble_store_value_cccd *value);
 int ble_store_delete_cccd(const struct ble_store_key_cccd *key);
 
+int ble_store_read_peer_attr(const struct ble_store_key_peer_attr *key,
+                             struct ble_store_value_peer_attr *out_value);
+int ble_store_write_peer_attr(const struct ble_store_value_peer_attr *value);
+int ble_store_delete_peer_attr(const struct ble_store_key_peer_attr *key);
+
+int ble_store_read_cl_sup_feat(const struct ble_store_key_cl_sup_feat *key,
+                               struct ble_store_value_cl_sup_feat *out_value);
+int ble_store_write_cl_sup_feat(
+    const struct ble_store_value_cl_sup_feat *value);
+int ble_store_delete_cl_sup_feat(const struct ble_store_key_cl_sup_feat *key);
+
 void ble_store_key_from_value_sec(struct ble_store_key_sec *out_key,
                                   const struct ble_store_value_sec *value);
 void ble_store_key_from_value_cccd(struct ble_store_key_cccd *out_key,
                                    const struct ble_store_value_cccd *value);
+void ble_store_key_from_value_peer_attr(
+    struct ble_store_key_peer_attr *out_key,
+    const struct ble_store_value_peer_attr *value);
+void ble_store_key_from_value_cl_sup_feat(
+    struct ble_store_key_cl_sup_feat *out_key,
+    const struct ble_store_value_cl_sup_feat *value);
 
 void ble_store_key_from_value(int obj_type,
                               union ble_store_key *out_key,
@@ -23,6 +23,14 @@
 #include "host/ble_hs.h"
 #include "services/gatt/ble_svc_gatt.h"
 
+/* Client Supported Features is only exposed if a client has something to
+ * enable; otherwise it would shift the handles of every application.
+ */
+#define BLE_SVC_GATT_CL_SUP_FEAT                \
+    (MYNEWT_VAL(BLE_GATT_NOTIFY_MULTI) ||       \
+     MYNEWT_VAL(BLE_GATT_ROBUST_CACHING) ||     \
+     MYNEWT_VAL(BLE_EATT_CHAN_NUM) > 0)
+
 static uint16_t ble_svc_gatt_changed_val_handle;
 static uint16_t ble_svc_gatt_start_handle;
 static uint16_t ble_svc_gatt_end_handle;
@@ -42,6 +50,19 @@ static const struct ble_gatt_svc_def ble_svc_gatt_defs[] = {
             .val_handle = &ble_svc_gatt_changed_val_handle,
             .flags = BLE_GATT_CHR_F_INDICATE,
         }, {
+#if BLE_SVC_GATT_CL_SUP_FEAT
+            .uuid = BLE_UUID16_DECLARE(
+                BLE_SVC_GATT_CHR_CLIENT_SUPPORTED_FEAT_UUID16),
+            .access_cb = ble_svc_gatt_access,
+            .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_WRITE,
+        }, {
+#endif
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+            .uuid = BLE_UUID16_DECLARE(BLE_SVC_GATT_CHR_DATABASE_HASH_UUID16),
+            .access_cb = ble_svc_gatt_access,
+            .flags = BLE_GATT_CHR_F_READ,
+        }, {
+#endif
             0, /* No more characteristics in this service. */
         } },
     },
@@ -51,17 +72,81 @@ static const struct ble_gatt_svc_def ble_svc_gatt_defs[] = {
     },
 };
 
+#if BLE_SVC_GATT_CL_SUP_FEAT
+static int
+ble_svc_gatt_cl_sup_feat_access(uint16_t conn_handle,
+                                struct ble_gatt_access_ctxt *ctxt)
+{
+    uint8_t feat[BLE_GATT_CHR_CLI_SUP_FEAT_SZ];
+    int rc;
+
+    if (ctxt->op == BLE_GATT_ACCESS_OP_WRITE_CHR) {
+        return ble_gatts_peer_cl_sup_feat_update(conn_handle, ctxt->om);
+    }
+
+    rc = ble_gatts_peer_cl_sup_feat_get(conn_handle, feat, sizeof feat);
+    if (rc != 0) {
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+
+    rc = os_mbuf_append(ctxt->om, feat, sizeof feat);
+    if (rc != 0) {
+        return BLE_ATT_ERR_INSUFFICIENT_RES;
+    }
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+static int
+ble_svc_gatt_db_hash_access(struct ble_gatt_access_ctxt *ctxt)
+{
+    uint8_t hash[BLE_GATT_DB_HASH_SZ];
+    int rc;
+
+    assert(ctxt->op == BLE_GATT_ACCESS_OP_READ_CHR);
+
+    rc = ble_gatts_db_hash(hash);
+    if (rc != 0) {
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+
+    rc = os_mbuf_append(ctxt->om, hash, sizeof hash);
+    if (rc != 0) {
+        return BLE_ATT_ERR_INSUFFICIENT_RES;
+    }
+
+    return 0;
+}
+#endif
+
 static int
 ble_svc_gatt_access(uint16_t conn_handle, uint16_t attr_handle,
                     struct ble_gatt_access_ctxt *ctxt, void *arg)
 {
     uint8_t *u8p;
 
-    /* The only operation allowed for this characteristic is indicate.  This
-     * access callback gets called by the stack when it needs to read the
-     * characteristic value to populate the outgoing indication command.
-     * Therefore, this callback should only get called during an attempt to
-     * read the characteristic.
+    switch (ble_uuid_u16(ctxt->chr->uuid)) {
+#if BLE_SVC_GATT_CL_SUP_FEAT
+    case BLE_SVC_GATT_CHR_CLIENT_SUPPORTED_FEAT_UUID16:
+        return ble_svc_gatt_cl_sup_feat_access(conn_handle, ctxt);
+#endif
+
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+    case BLE_SVC_GATT_CHR_DATABASE_HASH_UUID16:
+        return ble_svc_gatt_db_hash_access(ctxt);
+#endif
+
+    default:
+        break;
+    }
+
+    /* The only operation allowed for the Service Changed characteristic is
+     * indicate.  This access callback gets called by the stack when it needs
+     * to read the characteristic value to populate the outgoing indication
+     * command.  Therefore, this callback should only get called during an
+     * attempt to read the characteristic.
      */
     assert(ctxt->op == BLE_GATT_ACCESS_OP_READ_CHR);
     assert(ctxt->chr == &ble_svc_gatt_defs[0].characteristics[0]);
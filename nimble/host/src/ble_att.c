@@ -24,7 +24,8 @@
 static uint16_t ble_att_preferred_mtu_val;
 
 /** Dispatch table for incoming ATT requests.  Sorted by op code. */
-typedef int ble_att_rx_fn(uint16_t conn_handle, struct os_mbuf **om);
+typedef int ble_att_rx_fn(uint16_t conn_handle, uint16_t cid,
+                          struct os_mbuf **om);
 struct ble_att_rx_dispatch_entry {
     uint8_t bde_op;
     ble_att_rx_fn *bde_fn;
@@ -58,6 +59,9 @@ static const struct ble_att_rx_dispatch_entry ble_att_rx_dispatch[] = {
     { BLE_ATT_OP_NOTIFY_REQ,           ble_att_svr_rx_notify },
     { BLE_ATT_OP_INDICATE_REQ,         ble_att_svr_rx_indicate },
     { BLE_ATT_OP_INDICATE_RSP,         ble_att_clt_rx_indicate },
+    { BLE_ATT_OP_READ_MULT_VAR_REQ,    ble_att_svr_rx_read_mult_var },
+    { BLE_ATT_OP_READ_MULT_VAR_RSP,    ble_att_clt_rx_read_mult_var },
+    { BLE_ATT_OP_NOTIFY_MULTI_REQ,     ble_att_svr_rx_notify_multi },
     { BLE_ATT_OP_WRITE_CMD,            ble_att_svr_rx_write_no_rsp },
 };
 
@@ -120,6 +124,12 @@ STATS_NAME_START(ble_att_stats)
     STATS_NAME(ble_att_stats, indicate_rsp_tx)
     STATS_NAME(ble_att_stats, write_cmd_rx)
     STATS_NAME(ble_att_stats, write_cmd_tx)
+    STATS_NAME(ble_att_stats, read_mult_var_req_rx)
+    STATS_NAME(ble_att_stats, read_mult_var_req_tx)
+    STATS_NAME(ble_att_stats, read_mult_var_rsp_rx)
+    STATS_NAME(ble_att_stats, read_mult_var_rsp_tx)
+    STATS_NAME(ble_att_stats, notify_multi_req_rx)
+    STATS_NAME(ble_att_stats, notify_multi_req_tx)
 STATS_NAME_END(ble_att_stats)
 
 static const struct ble_att_rx_dispatch_entry *
@@ -143,11 +153,11 @@ ble_att_rx_dispatch_entry_find(uint8_t op)
 }
 
 int
-ble_att_conn_chan_find(uint16_t conn_handle, struct ble_hs_conn **out_conn,
+ble_att_conn_chan_find(uint16_t conn_handle, uint16_t cid,
+                       struct ble_hs_conn **out_conn,
                        struct ble_l2cap_chan **out_chan)
 {
-    return ble_hs_misc_conn_chan_find(conn_handle, BLE_L2CAP_CID_ATT,
-                                      out_conn, out_chan);
+    return ble_hs_misc_conn_chan_find(conn_handle, cid, out_conn, out_chan);
 }
 
 void
@@ -262,6 +272,18 @@ ble_att_inc_tx_stat(uint8_t att_op)
         STATS_INC(ble_att_stats, write_cmd_tx);
         break;
 
+    case BLE_ATT_OP_READ_MULT_VAR_REQ:
+        STATS_INC(ble_att_stats, read_mult_var_req_tx);
+        break;
+
+    case BLE_ATT_OP_READ_MULT_VAR_RSP:
+        STATS_INC(ble_att_stats, read_mult_var_rsp_tx);
+        break;
+
+    case BLE_ATT_OP_NOTIFY_MULTI_REQ:
+        STATS_INC(ble_att_stats, notify_multi_req_tx);
+        break;
+
     default:
         break;
     }
@@ -379,6 +401,18 @@ ble_att_inc_rx_stat(uint8_t att_op)
         STATS_INC(ble_att_stats, write_cmd_rx);
         break;
 
+    case BLE_ATT_OP_READ_MULT_VAR_REQ:
+        STATS_INC(ble_att_stats, read_mult_var_req_rx);
+        break;
+
+    case BLE_ATT_OP_READ_MULT_VAR_RSP:
+        STATS_INC(ble_att_stats, read_mult_var_rsp_rx);
+        break;
+
+    case BLE_ATT_OP_NOTIFY_MULTI_REQ:
+        STATS_INC(ble_att_stats, notify_multi_req_rx);
+        break;
+
     default:
         break;
     }
@@ -400,6 +434,12 @@ ble_att_truncate_to_mtu(const struct ble_l2cap_chan *att_chan,
 
 uint16_t
 ble_att_mtu(uint16_t conn_handle)
+{
+    return ble_att_mtu_by_cid(conn_handle, BLE_L2CAP_CID_ATT);
+}
+
+uint16_t
+ble_att_mtu_by_cid(uint16_t conn_handle, uint16_t cid)
 {
     struct ble_l2cap_chan *chan;
     struct ble_hs_conn *conn;
@@ -408,7 +448,7 @@ ble_att_mtu(uint16_t conn_handle)
 
     ble_hs_lock();
 
-    rc = ble_att_conn_chan_find(conn_handle, &conn, &chan);
+    rc = ble_att_conn_chan_find(conn_handle, cid, &conn, &chan);
     if (rc == 0) {
         mtu = ble_att_chan_mtu(chan);
     } else {
@@ -435,6 +475,13 @@ ble_att_chan_mtu(const struct ble_l2cap_chan *chan)
 {
     uint16_t mtu;
 
+#if MYNEWT_VAL(BLE_EATT_CHAN_NUM) > 0
+    /* An enhanced bearer's MTU is set up when the channel is connected. */
+    if (chan->scid != BLE_L2CAP_CID_ATT) {
+        return min(chan->coc_rx.mtu, chan->coc_tx.mtu);
+    }
+#endif
+
     /* If either side has not exchanged MTU size, use the default.  Otherwise,
      * use the lesser of the two exchanged values.
      */
@@ -453,7 +500,7 @@ ble_att_chan_mtu(const struct ble_l2cap_chan *chan)
 
 static void
 ble_att_rx_handle_unknown_request(uint8_t op, uint16_t conn_handle,
-                                  struct os_mbuf **om)
+                                  uint16_t cid, struct os_mbuf **om)
 {
     /* If this is command (bit6 is set to 1), do nothing */
     if (op & 0x40) {
@@ -461,29 +508,30 @@ ble_att_rx_handle_unknown_request(uint8_t op, uint16_t conn_handle,
     }
 
     os_mbuf_adj(*om, OS_MBUF_PKTLEN(*om));
-    ble_att_svr_tx_error_rsp(conn_handle, *om, op, 0,
+    ble_att_svr_tx_error_rsp(conn_handle, cid, *om, op, 0,
                              BLE_ATT_ERR_REQ_NOT_SUPPORTED);
 
     *om = NULL;
 }
 
-static int
-ble_att_rx(struct ble_l2cap_chan *chan)
+/**
+ * Dispatches an ATT PDU received over the specified bearer.
+ *
+ * @param conn_handle           The connection the PDU was received on.
+ * @param cid                   The bearer the PDU was received on.
+ * @param om                    The PDU, starting with the ATT opcode.  On
+ *                                  return, this points to whatever is left of
+ *                                  the mbuf for the caller to free.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int
+ble_att_rx_bearer(uint16_t conn_handle, uint16_t cid, struct os_mbuf **om)
 {
     const struct ble_att_rx_dispatch_entry *entry;
     uint8_t op;
-    uint16_t conn_handle;
-    struct os_mbuf **om;
     int rc;
 
-    conn_handle = ble_l2cap_get_conn_handle(chan);
-    if (conn_handle == BLE_HS_CONN_HANDLE_NONE) {
-        return BLE_HS_ENOTCONN;
-    }
-
-    om = &chan->rx_buf;
-    BLE_HS_DBG_ASSERT(*om != NULL);
-
     rc = os_mbuf_copydata(*om, 0, 1, &op);
     if (rc != 0) {
         return BLE_HS_EMSGSIZE;
@@ -491,7 +539,7 @@ ble_att_rx(struct ble_l2cap_chan *chan)
 
     entry = ble_att_rx_dispatch_entry_find(op);
     if (entry == NULL) {
-        ble_att_rx_handle_unknown_request(op, conn_handle, om);
+        ble_att_rx_handle_unknown_request(op, conn_handle, cid, om);
         return BLE_HS_ENOTSUP;
     }
 
@@ -500,10 +548,17 @@ ble_att_rx(struct ble_l2cap_chan *chan)
     /* Strip L2CAP ATT header from the front of the mbuf. */
     os_mbuf_adj(*om, 1);
 
-    rc = entry->bde_fn(conn_handle, om);
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+    rc = ble_att_svr_rx_change_aware(conn_handle, cid, op, om);
+    if (rc != 0) {
+        return rc;
+    }
+#endif
+
+    rc = entry->bde_fn(conn_handle, cid, om);
     if (rc != 0) {
         if (rc == BLE_HS_ENOTSUP) {
-            ble_att_rx_handle_unknown_request(op, conn_handle, om);
+            ble_att_rx_handle_unknown_request(op, conn_handle, cid, om);
         }
         return rc;
     }
@@ -511,6 +566,21 @@ ble_att_rx(struct ble_l2cap_chan *chan)
     return 0;
 }
 
+static int
+ble_att_rx(struct ble_l2cap_chan *chan)
+{
+    uint16_t conn_handle;
+
+    conn_handle = ble_l2cap_get_conn_handle(chan);
+    if (conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+        return BLE_HS_ENOTCONN;
+    }
+
+    BLE_HS_DBG_ASSERT(chan->rx_buf != NULL);
+
+    return ble_att_rx_bearer(conn_handle, BLE_L2CAP_CID_ATT, &chan->rx_buf);
+}
+
 uint16_t
 ble_att_preferred_mtu(void)
 {
@@ -522,7 +592,6 @@ ble_att_set_preferred_mtu(uint16_t mtu)
 {
     struct ble_l2cap_chan *chan;
     struct ble_hs_conn *conn;
-    int i;
 
     if (mtu < BLE_ATT_MTU_DFLT) {
         return BLE_HS_EINVAL;
@@ -536,16 +605,16 @@ ble_att_set_preferred_mtu(uint16_t mtu)
     /* Set my_mtu for established connections that haven't exchanged. */
     ble_hs_lock();
 
-    i = 0;
-    while ((conn = ble_hs_conn_find_by_idx(i)) != NULL) {
+    for (conn = ble_hs_conn_first();
+         conn != NULL;
+         conn = SLIST_NEXT(conn, bhc_next)) {
+
         chan = ble_hs_conn_chan_find_by_scid(conn, BLE_L2CAP_CID_ATT);
         BLE_HS_DBG_ASSERT(chan != NULL);
 
         if (!(chan->flags & BLE_L2CAP_CHAN_F_TXED_MTU)) {
             chan->my_mtu = mtu;
         }
-
-        i++;
     }
 
     ble_hs_unlock();
@@ -578,6 +647,11 @@ ble_att_init(void)
 
     ble_att_preferred_mtu_val = MYNEWT_VAL(BLE_ATT_PREFERRED_MTU);
 
+    rc = ble_att_eatt_init();
+    if (rc != 0) {
+        return rc;
+    }
+
     rc = stats_init_and_reg(
         STATS_HDR(ble_att_stats), STATS_SIZE_INIT_PARMS(ble_att_stats,
         STATS_SIZE_32), STATS_NAME_INIT_PARMS(ble_att_stats), "ble_att");
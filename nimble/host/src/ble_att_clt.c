@@ -31,7 +31,7 @@
  *****************************************************************************/
 
 int
-ble_att_clt_rx_error(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_clt_rx_error(uint16_t conn_handle, uint16_t cid, struct os_mbuf **rxom)
 {
     struct ble_att_error_rsp *rsp;
     int rc;
@@ -43,7 +43,7 @@ ble_att_clt_rx_error(uint16_t conn_handle, struct os_mbuf **rxom)
 
     rsp = (struct ble_att_error_rsp *)(*rxom)->om_data;
 
-    ble_gattc_rx_err(conn_handle, le16toh(rsp->baep_handle),
+    ble_gattc_rx_err(conn_handle, cid, le16toh(rsp->baep_handle),
                      le16toh(rsp->baep_error_code));
 
     return 0;
@@ -68,7 +68,7 @@ ble_att_clt_tx_mtu(uint16_t conn_handle, uint16_t mtu)
 
     ble_hs_lock();
 
-    rc = ble_att_conn_chan_find(conn_handle, &conn, &chan);
+    rc = ble_att_conn_chan_find(conn_handle, BLE_L2CAP_CID_ATT, &conn, &chan);
     if (rc != 0) {
         rc = BLE_HS_ENOTCONN;
     } else if (chan->flags & BLE_L2CAP_CHAN_F_TXED_MTU) {
@@ -89,14 +89,14 @@ ble_att_clt_tx_mtu(uint16_t conn_handle, uint16_t mtu)
 
     req->bamc_mtu = htole16(mtu);
 
-    rc = ble_att_tx(conn_handle, txom);
+    rc = ble_att_tx(conn_handle, BLE_L2CAP_CID_ATT, txom);
     if (rc != 0) {
         return rc;
     }
 
     ble_hs_lock();
 
-    rc = ble_att_conn_chan_find(conn_handle, &conn, &chan);
+    rc = ble_att_conn_chan_find(conn_handle, BLE_L2CAP_CID_ATT, &conn, &chan);
     if (rc == 0) {
         chan->flags |= BLE_L2CAP_CHAN_F_TXED_MTU;
     }
@@ -107,13 +107,18 @@ ble_att_clt_tx_mtu(uint16_t conn_handle, uint16_t mtu)
 }
 
 int
-ble_att_clt_rx_mtu(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_clt_rx_mtu(uint16_t conn_handle, uint16_t cid, struct os_mbuf **rxom)
 {
     struct ble_att_mtu_cmd *cmd;
     struct ble_l2cap_chan *chan;
     uint16_t mtu;
     int rc;
 
+    /* MTU exchange is only allowed on the unenhanced bearer. */
+    if (cid != BLE_L2CAP_CID_ATT) {
+        return BLE_HS_EBADDATA;
+    }
+
     mtu = 0;
 
     rc = ble_hs_mbuf_pullup_base(rxom, sizeof(*cmd));
@@ -122,7 +127,8 @@ ble_att_clt_rx_mtu(uint16_t conn_handle, struct os_mbuf **rxom)
 
         ble_hs_lock();
 
-        rc = ble_att_conn_chan_find(conn_handle, NULL, &chan);
+        rc = ble_att_conn_chan_find(conn_handle, BLE_L2CAP_CID_ATT, NULL,
+                                    &chan);
         if (rc == 0) {
             ble_att_set_peer_mtu(chan, le16toh(cmd->bamc_mtu));
             mtu = ble_att_chan_mtu(chan);
@@ -144,8 +150,8 @@ ble_att_clt_rx_mtu(uint16_t conn_handle, struct os_mbuf **rxom)
  *****************************************************************************/
 
 int
-ble_att_clt_tx_find_info(uint16_t conn_handle, uint16_t start_handle,
-                         uint16_t end_handle)
+ble_att_clt_tx_find_info(uint16_t conn_handle, uint16_t cid,
+                         uint16_t start_handle, uint16_t end_handle)
 {
 #if !NIMBLE_BLE_ATT_CLT_FIND_INFO
     return BLE_HS_ENOTSUP;
@@ -166,7 +172,7 @@ ble_att_clt_tx_find_info(uint16_t conn_handle, uint16_t start_handle,
     req->bafq_start_handle = htole16(start_handle);
     req->bafq_end_handle = htole16(end_handle);
 
-    return ble_att_tx(conn_handle, txom);
+    return ble_att_tx(conn_handle, cid, txom);
 }
 
 static int
@@ -221,7 +227,8 @@ ble_att_clt_parse_find_info_entry(struct os_mbuf **rxom, uint8_t rsp_format,
 }
 
 int
-ble_att_clt_rx_find_info(uint16_t conn_handle, struct os_mbuf **om)
+ble_att_clt_rx_find_info(uint16_t conn_handle, uint16_t cid,
+                         struct os_mbuf **om)
 {
 #if !NIMBLE_BLE_ATT_CLT_FIND_INFO
     return BLE_HS_ENOTSUP;
@@ -248,14 +255,14 @@ ble_att_clt_rx_find_info(uint16_t conn_handle, struct os_mbuf **om)
         }
 
         /* Hand find-info entry to GATT. */
-        ble_gattc_rx_find_info_idata(conn_handle, &idata);
+        ble_gattc_rx_find_info_idata(conn_handle, cid, &idata);
     }
 
     rc = 0;
 
 done:
     /* Notify GATT that response processing is done. */
-    ble_gattc_rx_find_info_complete(conn_handle, rc);
+    ble_gattc_rx_find_info_complete(conn_handle, cid, rc);
     return rc;
 }
 
@@ -268,8 +275,9 @@ done:
  * anyway
  */
 int
-ble_att_clt_tx_find_type_value(uint16_t conn_handle, uint16_t start_handle,
-                               uint16_t end_handle, uint16_t attribute_type,
+ble_att_clt_tx_find_type_value(uint16_t conn_handle, uint16_t cid,
+                               uint16_t start_handle, uint16_t end_handle,
+                               uint16_t attribute_type,
                                const void *attribute_value, int value_len)
 {
 #if !NIMBLE_BLE_ATT_CLT_FIND_TYPE
@@ -294,7 +302,7 @@ ble_att_clt_tx_find_type_value(uint16_t conn_handle, uint16_t start_handle,
     req->bavq_attr_type = htole16(attribute_type);
     memcpy(req->bavq_value, attribute_value, value_len);
 
-    return ble_att_tx(conn_handle, txom);
+    return ble_att_tx(conn_handle, cid, txom);
 }
 
 static int
@@ -320,7 +328,8 @@ ble_att_clt_parse_find_type_value_hinfo(
 }
 
 int
-ble_att_clt_rx_find_type_value(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_clt_rx_find_type_value(uint16_t conn_handle, uint16_t cid,
+                               struct os_mbuf **rxom)
 {
 #if !NIMBLE_BLE_ATT_CLT_FIND_TYPE
     return BLE_HS_ENOTSUP;
@@ -337,11 +346,11 @@ ble_att_clt_rx_find_type_value(uint16_t conn_handle, struct os_mbuf **rxom)
             break;
         }
 
-        ble_gattc_rx_find_type_value_hinfo(conn_handle, &hinfo);
+        ble_gattc_rx_find_type_value_hinfo(conn_handle, cid, &hinfo);
     }
 
     /* Notify GATT client that the full response has been parsed. */
-    ble_gattc_rx_find_type_value_complete(conn_handle, rc);
+    ble_gattc_rx_find_type_value_complete(conn_handle, cid, rc);
 
     return 0;
 }
@@ -351,8 +360,9 @@ ble_att_clt_rx_find_type_value(uint16_t conn_handle, struct os_mbuf **rxom)
  *****************************************************************************/
 
 int
-ble_att_clt_tx_read_type(uint16_t conn_handle, uint16_t start_handle,
-                         uint16_t end_handle, const ble_uuid_t *uuid)
+ble_att_clt_tx_read_type(uint16_t conn_handle, uint16_t cid,
+                         uint16_t start_handle, uint16_t end_handle,
+                         const ble_uuid_t *uuid)
 {
 #if !NIMBLE_BLE_ATT_CLT_READ_TYPE
     return BLE_HS_ENOTSUP;
@@ -376,11 +386,12 @@ ble_att_clt_tx_read_type(uint16_t conn_handle, uint16_t start_handle,
 
     ble_uuid_flat(uuid, req->uuid);
 
-    return ble_att_tx(conn_handle, txom);
+    return ble_att_tx(conn_handle, cid, txom);
 }
 
 int
-ble_att_clt_rx_read_type(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_clt_rx_read_type(uint16_t conn_handle, uint16_t cid,
+                         struct os_mbuf **rxom)
 {
 #if !NIMBLE_BLE_ATT_CLT_READ_TYPE
     return BLE_HS_ENOTSUP;
@@ -422,13 +433,13 @@ ble_att_clt_rx_read_type(uint16_t conn_handle, struct os_mbuf **rxom)
         adata.value_len = data_len - sizeof(*data);
         adata.value = data->value;
 
-        ble_gattc_rx_read_type_adata(conn_handle, &adata);
+        ble_gattc_rx_read_type_adata(conn_handle, cid, &adata);
         os_mbuf_adj(*rxom, data_len);
     }
 
 done:
     /* Notify GATT that the response is done being parsed. */
-    ble_gattc_rx_read_type_complete(conn_handle, rc);
+    ble_gattc_rx_read_type_complete(conn_handle, cid, rc);
     return rc;
 
 }
@@ -438,7 +449,7 @@ done:
  *****************************************************************************/
 
 int
-ble_att_clt_tx_read(uint16_t conn_handle, uint16_t handle)
+ble_att_clt_tx_read(uint16_t conn_handle, uint16_t cid, uint16_t handle)
 {
 #if !NIMBLE_BLE_ATT_CLT_READ
     return BLE_HS_ENOTSUP;
@@ -459,7 +470,7 @@ ble_att_clt_tx_read(uint16_t conn_handle, uint16_t handle)
 
     req->barq_handle = htole16(handle);
 
-    rc = ble_att_tx(conn_handle, txom);
+    rc = ble_att_tx(conn_handle, cid, txom);
     if (rc != 0) {
         return rc;
     }
@@ -468,14 +479,14 @@ ble_att_clt_tx_read(uint16_t conn_handle, uint16_t handle)
 }
 
 int
-ble_att_clt_rx_read(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_clt_rx_read(uint16_t conn_handle, uint16_t cid, struct os_mbuf **rxom)
 {
 #if !NIMBLE_BLE_ATT_CLT_READ
     return BLE_HS_ENOTSUP;
 #endif
 
     /* Pass the Attribute Value field to GATT. */
-    ble_gattc_rx_read_rsp(conn_handle, 0, rxom);
+    ble_gattc_rx_read_rsp(conn_handle, cid, 0, rxom);
     return 0;
 }
 
@@ -484,7 +495,8 @@ ble_att_clt_rx_read(uint16_t conn_handle, struct os_mbuf **rxom)
  *****************************************************************************/
 
 int
-ble_att_clt_tx_read_blob(uint16_t conn_handle, uint16_t handle, uint16_t offset)
+ble_att_clt_tx_read_blob(uint16_t conn_handle, uint16_t cid, uint16_t handle,
+                         uint16_t offset)
 {
 #if !NIMBLE_BLE_ATT_CLT_READ_BLOB
     return BLE_HS_ENOTSUP;
@@ -506,7 +518,7 @@ ble_att_clt_tx_read_blob(uint16_t conn_handle, uint16_t handle, uint16_t offset)
     req->babq_handle = htole16(handle);
     req->babq_offset = htole16(offset);
 
-    rc = ble_att_tx(conn_handle, txom);
+    rc = ble_att_tx(conn_handle, cid, txom);
     if (rc != 0) {
         return rc;
     }
@@ -515,28 +527,25 @@ ble_att_clt_tx_read_blob(uint16_t conn_handle, uint16_t handle, uint16_t offset)
 }
 
 int
-ble_att_clt_rx_read_blob(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_clt_rx_read_blob(uint16_t conn_handle, uint16_t cid,
+                         struct os_mbuf **rxom)
 {
 #if !NIMBLE_BLE_ATT_CLT_READ_BLOB
     return BLE_HS_ENOTSUP;
 #endif
 
     /* Pass the Attribute Value field to GATT. */
-    ble_gattc_rx_read_blob_rsp(conn_handle, 0, rxom);
+    ble_gattc_rx_read_blob_rsp(conn_handle, cid, 0, rxom);
     return 0;
 }
 
 /*****************************************************************************
  * $read multiple                                                            *
  *****************************************************************************/
-int
-ble_att_clt_tx_read_mult(uint16_t conn_handle, const uint16_t *handles,
-                         int num_handles)
+static int
+ble_att_clt_tx_read_mult_op(uint16_t conn_handle, uint16_t cid, uint8_t op,
+                            const uint16_t *handles, int num_handles)
 {
-#if !NIMBLE_BLE_ATT_CLT_READ_MULT
-    return BLE_HS_ENOTSUP;
-#endif
-
     struct ble_att_read_mult_req *req;
     struct os_mbuf *txom;
     int i;
@@ -545,9 +554,7 @@ ble_att_clt_tx_read_mult(uint16_t conn_handle, const uint16_t *handles,
         return BLE_HS_EINVAL;
     }
 
-    req = ble_att_cmd_get(BLE_ATT_OP_READ_MULT_REQ,
-                          sizeof(req->handles[0]) * num_handles,
-                          &txom);
+    req = ble_att_cmd_get(op, sizeof(req->handles[0]) * num_handles, &txom);
     if (req == NULL) {
         return BLE_HS_ENOMEM;
     }
@@ -556,18 +563,62 @@ ble_att_clt_tx_read_mult(uint16_t conn_handle, const uint16_t *handles,
         req->handles[i] = htole16(handles[i]);
     }
 
-    return ble_att_tx(conn_handle, txom);
+    return ble_att_tx(conn_handle, cid, txom);
 }
 
 int
-ble_att_clt_rx_read_mult(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_clt_tx_read_mult(uint16_t conn_handle, uint16_t cid,
+                         const uint16_t *handles, int num_handles)
+{
+#if !NIMBLE_BLE_ATT_CLT_READ_MULT
+    return BLE_HS_ENOTSUP;
+#endif
+
+    return ble_att_clt_tx_read_mult_op(conn_handle, cid,
+                                       BLE_ATT_OP_READ_MULT_REQ, handles,
+                                       num_handles);
+}
+
+int
+ble_att_clt_rx_read_mult(uint16_t conn_handle, uint16_t cid,
+                         struct os_mbuf **rxom)
 {
 #if !NIMBLE_BLE_ATT_CLT_READ_MULT
     return BLE_HS_ENOTSUP;
 #endif
 
     /* Pass the Attribute Value field to GATT. */
-    ble_gattc_rx_read_mult_rsp(conn_handle, 0, rxom);
+    ble_gattc_rx_read_mult_rsp(conn_handle, cid, 0, rxom);
+    return 0;
+}
+
+/*****************************************************************************
+ * $read multiple variable length                                            *
+ *****************************************************************************/
+
+int
+ble_att_clt_tx_read_mult_var(uint16_t conn_handle, uint16_t cid,
+                             const uint16_t *handles, int num_handles)
+{
+#if !NIMBLE_BLE_ATT_CLT_READ_MULT_VAR
+    return BLE_HS_ENOTSUP;
+#endif
+
+    return ble_att_clt_tx_read_mult_op(conn_handle, cid,
+                                       BLE_ATT_OP_READ_MULT_VAR_REQ, handles,
+                                       num_handles);
+}
+
+int
+ble_att_clt_rx_read_mult_var(uint16_t conn_handle, uint16_t cid,
+                             struct os_mbuf **rxom)
+{
+#if !NIMBLE_BLE_ATT_CLT_READ_MULT_VAR
+    return BLE_HS_ENOTSUP;
+#endif
+
+    /* Pass the Length Value Tuple List field to GATT. */
+    ble_gattc_rx_read_mult_var_rsp(conn_handle, cid, 0, rxom);
     return 0;
 }
 
@@ -576,7 +627,7 @@ ble_att_clt_rx_read_mult(uint16_t conn_handle, struct os_mbuf **rxom)
  *****************************************************************************/
 
 int
-ble_att_clt_tx_read_group_type(uint16_t conn_handle,
+ble_att_clt_tx_read_group_type(uint16_t conn_handle, uint16_t cid,
                                uint16_t start_handle, uint16_t end_handle,
                                const ble_uuid_t *uuid)
 {
@@ -601,7 +652,7 @@ ble_att_clt_tx_read_group_type(uint16_t conn_handle,
     req->bagq_end_handle = htole16(end_handle);
     ble_uuid_flat(uuid, req->uuid);
 
-    return ble_att_tx(conn_handle, txom);
+    return ble_att_tx(conn_handle, cid, txom);
 }
 
 static int
@@ -629,7 +680,8 @@ ble_att_clt_parse_read_group_type_adata(
 }
 
 int
-ble_att_clt_rx_read_group_type(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_clt_rx_read_group_type(uint16_t conn_handle, uint16_t cid,
+                               struct os_mbuf **rxom)
 {
 #if !NIMBLE_BLE_ATT_CLT_READ_GROUP_TYPE
     return BLE_HS_ENOTSUP;
@@ -659,13 +711,13 @@ ble_att_clt_rx_read_group_type(uint16_t conn_handle, struct os_mbuf **rxom)
             goto done;
         }
 
-        ble_gattc_rx_read_group_type_adata(conn_handle, &adata);
+        ble_gattc_rx_read_group_type_adata(conn_handle, cid, &adata);
         os_mbuf_adj(*rxom, len);
     }
 
 done:
     /* Notify GATT that the response is done being parsed. */
-    ble_gattc_rx_read_group_type_complete(conn_handle, rc);
+    ble_gattc_rx_read_group_type_complete(conn_handle, cid, rc);
     return rc;
 }
 
@@ -674,7 +726,7 @@ done:
  *****************************************************************************/
 
 int
-ble_att_clt_tx_write_req(uint16_t conn_handle, uint16_t handle,
+ble_att_clt_tx_write_req(uint16_t conn_handle, uint16_t cid, uint16_t handle,
                          struct os_mbuf *txom)
 {
 #if !NIMBLE_BLE_ATT_CLT_WRITE
@@ -693,11 +745,11 @@ ble_att_clt_tx_write_req(uint16_t conn_handle, uint16_t handle,
     req->bawq_handle = htole16(handle);
     os_mbuf_concat(txom2, txom);
 
-    return ble_att_tx(conn_handle, txom2);
+    return ble_att_tx(conn_handle, cid, txom2);
 }
 
 int
-ble_att_clt_tx_write_cmd(uint16_t conn_handle, uint16_t handle,
+ble_att_clt_tx_write_cmd(uint16_t conn_handle, uint16_t cid, uint16_t handle,
                          struct os_mbuf *txom)
 {
 #if !NIMBLE_BLE_ATT_CLT_WRITE_NO_RSP
@@ -730,18 +782,18 @@ ble_att_clt_tx_write_cmd(uint16_t conn_handle, uint16_t handle,
     cmd->handle = htole16(handle);
     os_mbuf_concat(txom2, txom);
 
-    return ble_att_tx(conn_handle, txom2);
+    return ble_att_tx(conn_handle, cid, txom2);
 }
 
 int
-ble_att_clt_rx_write(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_clt_rx_write(uint16_t conn_handle, uint16_t cid, struct os_mbuf **rxom)
 {
 #if !NIMBLE_BLE_ATT_CLT_WRITE
     return BLE_HS_ENOTSUP;
 #endif
 
     /* No payload. */
-    ble_gattc_rx_write_rsp(conn_handle);
+    ble_gattc_rx_write_rsp(conn_handle, cid);
     return 0;
 }
 
@@ -750,7 +802,7 @@ ble_att_clt_rx_write(uint16_t conn_handle, struct os_mbuf **rxom)
  *****************************************************************************/
 
 int
-ble_att_clt_tx_prep_write(uint16_t conn_handle, uint16_t handle,
+ble_att_clt_tx_prep_write(uint16_t conn_handle, uint16_t cid, uint16_t handle,
                           uint16_t offset, struct os_mbuf *txom)
 {
 #if !NIMBLE_BLE_ATT_CLT_PREP_WRITE
@@ -772,7 +824,8 @@ ble_att_clt_tx_prep_write(uint16_t conn_handle, uint16_t handle,
     }
 
     if (OS_MBUF_PKTLEN(txom) >
-        ble_att_mtu(conn_handle) - BLE_ATT_PREP_WRITE_CMD_BASE_SZ) {
+        ble_att_mtu_by_cid(conn_handle, cid) -
+        BLE_ATT_PREP_WRITE_CMD_BASE_SZ) {
         rc = BLE_HS_EINVAL;
         goto err;
     }
@@ -787,7 +840,7 @@ ble_att_clt_tx_prep_write(uint16_t conn_handle, uint16_t handle,
     req->bapc_offset = htole16(offset);
     os_mbuf_concat(txom2, txom);
 
-    return ble_att_tx(conn_handle, txom2);
+    return ble_att_tx(conn_handle, cid, txom2);
 
 err:
     os_mbuf_free_chain(txom);
@@ -795,7 +848,8 @@ err:
 }
 
 int
-ble_att_clt_rx_prep_write(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_clt_rx_prep_write(uint16_t conn_handle, uint16_t cid,
+                          struct os_mbuf **rxom)
 {
 #if !NIMBLE_BLE_ATT_CLT_PREP_WRITE
     return BLE_HS_ENOTSUP;
@@ -824,7 +878,7 @@ ble_att_clt_rx_prep_write(uint16_t conn_handle, struct os_mbuf **rxom)
 
 done:
     /* Notify GATT client that the full response has been parsed. */
-    ble_gattc_rx_prep_write_rsp(conn_handle, rc, handle, offset, rxom);
+    ble_gattc_rx_prep_write_rsp(conn_handle, cid, rc, handle, offset, rxom);
     return rc;
 }
 
@@ -833,7 +887,7 @@ done:
  *****************************************************************************/
 
 int
-ble_att_clt_tx_exec_write(uint16_t conn_handle, uint8_t flags)
+ble_att_clt_tx_exec_write(uint16_t conn_handle, uint16_t cid, uint8_t flags)
 {
 #if !NIMBLE_BLE_ATT_CLT_EXEC_WRITE
     return BLE_HS_ENOTSUP;
@@ -850,7 +904,7 @@ ble_att_clt_tx_exec_write(uint16_t conn_handle, uint8_t flags)
 
     req->baeq_flags = flags;
 
-    rc = ble_att_tx(conn_handle, txom);
+    rc = ble_att_tx(conn_handle, cid, txom);
     if (rc != 0) {
         return rc;
     }
@@ -859,13 +913,14 @@ ble_att_clt_tx_exec_write(uint16_t conn_handle, uint8_t flags)
 }
 
 int
-ble_att_clt_rx_exec_write(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_clt_rx_exec_write(uint16_t conn_handle, uint16_t cid,
+                          struct os_mbuf **rxom)
 {
 #if !NIMBLE_BLE_ATT_CLT_EXEC_WRITE
     return BLE_HS_ENOTSUP;
 #endif
 
-    ble_gattc_rx_exec_write_rsp(conn_handle, 0);
+    ble_gattc_rx_exec_write_rsp(conn_handle, cid, 0);
     return 0;
 }
 
@@ -874,7 +929,7 @@ ble_att_clt_rx_exec_write(uint16_t conn_handle, struct os_mbuf **rxom)
  *****************************************************************************/
 
 int
-ble_att_clt_tx_notify(uint16_t conn_handle, uint16_t handle,
+ble_att_clt_tx_notify(uint16_t conn_handle, uint16_t cid, uint16_t handle,
                       struct os_mbuf *txom)
 {
 #if !NIMBLE_BLE_ATT_CLT_NOTIFY
@@ -899,19 +954,49 @@ ble_att_clt_tx_notify(uint16_t conn_handle, uint16_t handle,
     req->banq_handle = htole16(handle);
     os_mbuf_concat(txom2, txom);
 
-    return ble_att_tx(conn_handle, txom2);
+    return ble_att_tx(conn_handle, cid, txom2);
 
 err:
     os_mbuf_free_chain(txom);
     return rc;
 }
 
+/*****************************************************************************
+ * $multiple handle value notification                                       *
+ *****************************************************************************/
+
+/**
+ * Sends a multiple handle value notification.
+ *
+ * @param txom                  The Handle Length Value Tuple List.  Consumed
+ *                                  in all cases.
+ */
+int
+ble_att_clt_tx_notify_multi(uint16_t conn_handle, uint16_t cid,
+                            struct os_mbuf *txom)
+{
+#if !NIMBLE_BLE_ATT_CLT_NOTIFY_MULTI
+    return BLE_HS_ENOTSUP;
+#endif
+
+    struct os_mbuf *txom2;
+
+    if (ble_att_cmd_get(BLE_ATT_OP_NOTIFY_MULTI_REQ, 0, &txom2) == NULL) {
+        os_mbuf_free_chain(txom);
+        return BLE_HS_ENOMEM;
+    }
+
+    os_mbuf_concat(txom2, txom);
+
+    return ble_att_tx(conn_handle, cid, txom2);
+}
+
 /*****************************************************************************
  * $handle value indication                                                  *
  *****************************************************************************/
 
 int
-ble_att_clt_tx_indicate(uint16_t conn_handle, uint16_t handle,
+ble_att_clt_tx_indicate(uint16_t conn_handle, uint16_t cid, uint16_t handle,
                         struct os_mbuf *txom)
 {
 #if !NIMBLE_BLE_ATT_CLT_INDICATE
@@ -936,7 +1021,7 @@ ble_att_clt_tx_indicate(uint16_t conn_handle, uint16_t handle,
     req->baiq_handle = htole16(handle);
     os_mbuf_concat(txom2, txom);
 
-    return ble_att_tx(conn_handle, txom2);
+    return ble_att_tx(conn_handle, cid, txom2);
 
 err:
     os_mbuf_free_chain(txom);
@@ -944,13 +1029,14 @@ err:
 }
 
 int
-ble_att_clt_rx_indicate(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_clt_rx_indicate(uint16_t conn_handle, uint16_t cid,
+                        struct os_mbuf **rxom)
 {
 #if !NIMBLE_BLE_ATT_CLT_INDICATE
     return BLE_HS_ENOTSUP;
 #endif
 
     /* No payload. */
-    ble_gattc_rx_indicate_rsp(conn_handle);
+    ble_gattc_rx_indicate_rsp(conn_handle, cid);
     return 0;
 }
@@ -54,8 +54,20 @@ ble_att_cmd_get(uint8_t opcode, size_t len, struct os_mbuf **txom)
     return ble_att_cmd_prepare(opcode, len, *txom);
 }
 
+/**
+ * Transmits an ATT PDU over the specified bearer.  The PDU is truncated to the
+ * bearer's MTU.  The mbuf is always consumed.
+ *
+ * @param conn_handle           The connection to send over.
+ * @param cid                   The bearer to send over; BLE_L2CAP_CID_ATT for
+ *                                  the unenhanced bearer or the source CID of
+ *                                  an enhanced bearer.
+ * @param txom                  The ATT PDU to send.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
 int
-ble_att_tx(uint16_t conn_handle, struct os_mbuf *txom)
+ble_att_tx(uint16_t conn_handle, uint16_t cid, struct os_mbuf *txom)
 {
     struct ble_l2cap_chan *chan;
     struct ble_hs_conn *conn;
@@ -66,18 +78,25 @@ ble_att_tx(uint16_t conn_handle, struct os_mbuf *txom)
 
     ble_hs_lock();
 
-    rc = ble_hs_misc_conn_chan_find_reqd(conn_handle, BLE_L2CAP_CID_ATT, &conn,
-                                         &chan);
+    rc = ble_hs_misc_conn_chan_find_reqd(conn_handle, cid, &conn, &chan);
     if (rc != 0) {
+        ble_hs_unlock();
         os_mbuf_free_chain(txom);
-    } else {
-        ble_att_truncate_to_mtu(chan, txom);
+        return rc;
+    }
+
+    ble_att_truncate_to_mtu(chan, txom);
+
+    if (cid == BLE_L2CAP_CID_ATT) {
         rc = ble_l2cap_tx(conn, chan, txom);
+        ble_hs_unlock();
+        return rc;
     }
 
     ble_hs_unlock();
 
-    return rc;
+    /* Enhanced bearers are credit based; they lock the host themselves. */
+    return ble_att_eatt_tx(conn_handle, cid, txom);
 }
 
 static const void *
@@ -225,6 +225,22 @@ struct ble_att_read_mult_req {
  */
 #define BLE_ATT_READ_MULT_RSP_BASE_SZ   1
 
+/**
+ * | Parameter                          | Size (octets)     |
+ * +------------------------------------+-------------------+
+ * | Attribute Opcode                   | 1                 |
+ * | Set Of Handles                     | 4 to (ATT_MTU-1)  |
+ */
+#define BLE_ATT_READ_MULT_VAR_REQ_BASE_SZ   1
+
+/**
+ * | Parameter                          | Size (octets)     |
+ * +------------------------------------+-------------------+
+ * | Attribute Opcode                   | 1                 |
+ * | Length Value Tuple List            | 4 to (ATT_MTU-1)  |
+ */
+#define BLE_ATT_READ_MULT_VAR_RSP_BASE_SZ   1
+
 /**
  * | Parameter                          | Size (octets)     |
  * +------------------------------------+-------------------+
@@ -321,6 +337,20 @@ struct ble_att_notify_req {
     uint16_t banq_handle;
 } __attribute__((packed));
 
+/**
+ * | Parameter                          | Size (octets)     |
+ * +------------------------------------+-------------------+
+ * | Attribute Opcode                   | 1                 |
+ * | Handle Length Value Tuple List     | 8 to (ATT_MTU-1)  |
+ */
+#define BLE_ATT_NOTIFY_MULTI_REQ_BASE_SZ    1
+
+/** Header of each tuple in a multiple handle value notification. */
+struct ble_att_notify_multi_tuple {
+    uint16_t handle;
+    uint16_t len;
+} __attribute__((packed));
+
 /**
  * | Parameter                          | Size (octets)     |
  * +------------------------------------+-------------------+
@@ -440,7 +470,7 @@ void ble_att_indicate_rsp_write(void *payload, int len);
 
 void *ble_att_cmd_prepare(uint8_t opcode, size_t len, struct os_mbuf *txom);
 void *ble_att_cmd_get(uint8_t opcode, size_t len, struct os_mbuf **txom);
-int ble_att_tx(uint16_t conn_handle, struct os_mbuf *txom);
+int ble_att_tx(uint16_t conn_handle, uint16_t cid, struct os_mbuf *txom);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,562 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include "nimble/ble.h"
+#include "host/ble_l2cap.h"
+#include "ble_hs_priv.h"
+#include "ble_l2cap_priv.h"
+
+#if MYNEWT_VAL(BLE_EATT_CHAN_NUM) > 0
+
+/** Fixed L2CAP PSM of the Enhanced ATT service. */
+#define BLE_ATT_EATT_PSM                0x0027
+
+/** The specification does not allow smaller EATT MTUs. */
+#define BLE_ATT_EATT_MTU_MIN            64
+
+#define BLE_ATT_EATT_STATE_FREE         0
+#define BLE_ATT_EATT_STATE_CONNECTING   1
+#define BLE_ATT_EATT_STATE_CONNECTED    2
+/** Channel gone; procedures running on it still have to be failed. */
+#define BLE_ATT_EATT_STATE_CLOSED       3
+
+/**
+ * An enhanced ATT bearer.  ATT PDUs queued for transmission are kept in
+ * tx_q while the channel waits for credits.
+ *
+ * All fields are protected by the host lock.
+ */
+struct ble_att_eatt {
+    struct ble_l2cap_chan *chan;
+    STAILQ_HEAD(, os_mbuf_pkthdr) tx_q;
+    uint16_t conn_handle;
+    uint16_t cid;
+    uint8_t state;
+};
+
+static struct ble_att_eatt ble_att_eatt_tbl[MYNEWT_VAL(BLE_EATT_CHAN_NUM)];
+
+static struct ble_npl_event ble_att_eatt_closed_ev;
+
+static struct ble_att_eatt *
+ble_att_eatt_alloc(uint16_t conn_handle)
+{
+    struct ble_att_eatt *eatt;
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(BLE_EATT_CHAN_NUM); i++) {
+        eatt = &ble_att_eatt_tbl[i];
+        if (eatt->state == BLE_ATT_EATT_STATE_FREE) {
+            memset(eatt, 0, sizeof *eatt);
+            STAILQ_INIT(&eatt->tx_q);
+            eatt->conn_handle = conn_handle;
+            eatt->state = BLE_ATT_EATT_STATE_CONNECTING;
+            return eatt;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+ble_att_eatt_tx_q_clear(struct ble_att_eatt *eatt)
+{
+    struct os_mbuf_pkthdr *omp;
+
+    while ((omp = STAILQ_FIRST(&eatt->tx_q)) != NULL) {
+        STAILQ_REMOVE_HEAD(&eatt->tx_q, omp_next);
+        os_mbuf_free_chain(OS_MBUF_PKTHDR_TO_MBUF(omp));
+    }
+}
+
+/**
+ * Finds the bearer using the specified L2CAP channel.  While the channel is
+ * being connected by us, the channel is not known yet; the first pending
+ * bearer of the connection is used instead.
+ */
+static struct ble_att_eatt *
+ble_att_eatt_find_by_chan(const struct ble_l2cap_chan *chan)
+{
+    struct ble_att_eatt *pending;
+    struct ble_att_eatt *eatt;
+    int i;
+
+    pending = NULL;
+    for (i = 0; i < MYNEWT_VAL(BLE_EATT_CHAN_NUM); i++) {
+        eatt = &ble_att_eatt_tbl[i];
+        if (eatt->state == BLE_ATT_EATT_STATE_FREE ||
+            eatt->state == BLE_ATT_EATT_STATE_CLOSED) {
+
+            continue;
+        }
+
+        if (eatt->chan == chan) {
+            return eatt;
+        }
+
+        if (pending == NULL && eatt->chan == NULL &&
+            eatt->conn_handle == chan->conn_handle) {
+
+            pending = eatt;
+        }
+    }
+
+    return pending;
+}
+
+static struct ble_att_eatt *
+ble_att_eatt_find_by_cid(uint16_t conn_handle, uint16_t cid)
+{
+    struct ble_att_eatt *eatt;
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(BLE_EATT_CHAN_NUM); i++) {
+        eatt = &ble_att_eatt_tbl[i];
+        if (eatt->state == BLE_ATT_EATT_STATE_CONNECTED &&
+            eatt->conn_handle == conn_handle && eatt->cid == cid) {
+
+            return eatt;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Fails the procedures of closed bearers and releases them.  Bearers are
+ * closed with the host locked, so this is deferred to the host task.
+ * Bearers of a terminated connection are released by
+ * ble_att_eatt_connection_broken() instead, before the connection handle
+ * can be reused.
+ */
+static void
+ble_att_eatt_closed_event(struct ble_npl_event *ev)
+{
+    struct ble_att_eatt *eatt;
+    uint16_t conn_handle;
+    uint16_t cid;
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(BLE_EATT_CHAN_NUM); i++) {
+        eatt = &ble_att_eatt_tbl[i];
+
+        ble_hs_lock();
+        if (eatt->state != BLE_ATT_EATT_STATE_CLOSED) {
+            ble_hs_unlock();
+            continue;
+        }
+        conn_handle = eatt->conn_handle;
+        cid = eatt->cid;
+        eatt->state = BLE_ATT_EATT_STATE_FREE;
+        ble_hs_unlock();
+
+        if (cid != 0) {
+            ble_gattc_bearer_closed(conn_handle, cid);
+        }
+    }
+}
+
+/**
+ * Transmits queued PDUs until the channel runs out of credits.
+ */
+static void
+ble_att_eatt_tx_q_drain(uint16_t conn_handle, uint16_t cid)
+{
+    struct ble_l2cap_chan *chan;
+    struct os_mbuf_pkthdr *omp;
+    struct ble_att_eatt *eatt;
+    struct os_mbuf *om;
+    int rc;
+
+    while (1) {
+        ble_hs_lock();
+
+        eatt = ble_att_eatt_find_by_cid(conn_handle, cid);
+        omp = eatt != NULL ? STAILQ_FIRST(&eatt->tx_q) : NULL;
+        if (omp == NULL) {
+            ble_hs_unlock();
+            return;
+        }
+
+        STAILQ_REMOVE_HEAD(&eatt->tx_q, omp_next);
+        chan = eatt->chan;
+
+        ble_hs_unlock();
+
+        om = OS_MBUF_PKTHDR_TO_MBUF(omp);
+        rc = ble_l2cap_send(chan, om);
+        switch (rc) {
+        case 0:
+            break;
+
+        case BLE_HS_ESTALLED:
+            /* The PDU was accepted; continue on TX_UNSTALLED. */
+            return;
+
+        case BLE_HS_EBUSY:
+            /* Another PDU is still being sent; put this one back. */
+            ble_hs_lock();
+            eatt = ble_att_eatt_find_by_cid(conn_handle, cid);
+            if (eatt != NULL) {
+                STAILQ_INSERT_HEAD(&eatt->tx_q, omp, omp_next);
+                om = NULL;
+            }
+            ble_hs_unlock();
+            os_mbuf_free_chain(om);
+            return;
+
+        case BLE_HS_EBADDATA:
+            /* Not consumed by L2CAP. */
+            os_mbuf_free_chain(om);
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+int
+ble_att_eatt_tx(uint16_t conn_handle, uint16_t cid, struct os_mbuf *txom)
+{
+    struct ble_att_eatt *eatt;
+
+    ble_hs_lock();
+
+    eatt = ble_att_eatt_find_by_cid(conn_handle, cid);
+    if (eatt == NULL) {
+        ble_hs_unlock();
+        os_mbuf_free_chain(txom);
+        return BLE_HS_ENOTCONN;
+    }
+
+    /* PDUs are always queued first so they are sent in order, whichever task
+     * drains the queue.
+     */
+    STAILQ_INSERT_TAIL(&eatt->tx_q, OS_MBUF_PKTHDR(txom), omp_next);
+
+    ble_hs_unlock();
+
+    ble_att_eatt_tx_q_drain(conn_handle, cid);
+
+    return 0;
+}
+
+/**
+ * Called when a connection is terminated.  Releases all bearers of the
+ * connection right away; their procedures are failed along with all other
+ * procedures of the connection by ble_gattc_connection_broken().
+ *
+ * @param conn_handle           The handle of the terminated connection.
+ */
+void
+ble_att_eatt_connection_broken(uint16_t conn_handle)
+{
+    struct ble_att_eatt *eatt;
+    int i;
+
+    ble_hs_lock();
+
+    for (i = 0; i < MYNEWT_VAL(BLE_EATT_CHAN_NUM); i++) {
+        eatt = &ble_att_eatt_tbl[i];
+        if (eatt->state != BLE_ATT_EATT_STATE_FREE &&
+            eatt->conn_handle == conn_handle) {
+
+            ble_att_eatt_tx_q_clear(eatt);
+            eatt->chan = NULL;
+            eatt->state = BLE_ATT_EATT_STATE_FREE;
+        }
+    }
+
+    ble_hs_unlock();
+}
+
+int
+ble_att_eatt_bearers(uint16_t conn_handle, uint16_t *cids, int max_cids)
+{
+    struct ble_att_eatt *eatt;
+    int num_cids;
+    int i;
+
+    num_cids = 0;
+
+    ble_hs_lock();
+
+    for (i = 0; i < MYNEWT_VAL(BLE_EATT_CHAN_NUM) && num_cids < max_cids;
+         i++) {
+
+        eatt = &ble_att_eatt_tbl[i];
+        if (eatt->state == BLE_ATT_EATT_STATE_CONNECTED &&
+            eatt->conn_handle == conn_handle) {
+
+            cids[num_cids++] = eatt->cid;
+        }
+    }
+
+    ble_hs_unlock();
+
+    return num_cids;
+}
+
+static int
+ble_att_eatt_rx_ready(struct ble_l2cap_chan *chan)
+{
+    struct os_mbuf *sdu_rx;
+
+    sdu_rx = os_msys_get_pkthdr(MYNEWT_VAL(BLE_EATT_MTU), 0);
+    if (sdu_rx == NULL) {
+        return BLE_HS_ENOMEM;
+    }
+
+    return ble_l2cap_recv_ready(chan, sdu_rx);
+}
+
+static int
+ble_att_eatt_accept(struct ble_l2cap_event *event)
+{
+    struct ble_gap_conn_desc desc;
+    struct ble_att_eatt *eatt;
+    int rc;
+
+    rc = ble_gap_conn_find(event->accept.conn_handle, &desc);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (!desc.sec_state.encrypted) {
+        return BLE_HS_EENCRYPT;
+    }
+
+    if (event->accept.peer_sdu_size < BLE_ATT_EATT_MTU_MIN) {
+        return BLE_HS_EINVAL;
+    }
+
+    ble_hs_lock();
+    eatt = ble_att_eatt_alloc(event->accept.conn_handle);
+    if (eatt != NULL) {
+        eatt->chan = event->accept.chan;
+    }
+    ble_hs_unlock();
+
+    if (eatt == NULL) {
+        return BLE_HS_ENOMEM;
+    }
+
+    rc = ble_att_eatt_rx_ready(event->accept.chan);
+    if (rc != 0) {
+        ble_hs_lock();
+        eatt->state = BLE_ATT_EATT_STATE_FREE;
+        ble_hs_unlock();
+        return BLE_HS_ENOMEM;
+    }
+
+    return 0;
+}
+
+static void
+ble_att_eatt_connected(struct ble_l2cap_event *event)
+{
+    struct ble_l2cap_chan_info info;
+    struct ble_att_eatt *eatt;
+    uint16_t mtu;
+
+    ble_hs_lock();
+
+    eatt = ble_att_eatt_find_by_chan(event->connect.chan);
+    if (eatt != NULL) {
+        if (event->connect.status != 0) {
+            eatt->state = BLE_ATT_EATT_STATE_FREE;
+            eatt = NULL;
+        } else {
+            eatt->chan = event->connect.chan;
+            eatt->cid = event->connect.chan->scid;
+            eatt->state = BLE_ATT_EATT_STATE_CONNECTED;
+        }
+    }
+
+    ble_hs_unlock();
+
+    if (eatt == NULL) {
+        if (event->connect.status == 0) {
+            /* Out of bearers; there is nothing to run this channel. */
+            ble_l2cap_disconnect(event->connect.chan);
+        }
+        return;
+    }
+
+    ble_l2cap_get_chan_info(event->connect.chan, &info);
+    mtu = min(info.our_coc_mtu, info.peer_coc_mtu);
+    ble_gap_mtu_event(event->connect.conn_handle, info.scid, mtu);
+}
+
+/**
+ * Called with the host locked.
+ */
+static void
+ble_att_eatt_disconnected(struct ble_l2cap_event *event)
+{
+    struct ble_att_eatt *eatt;
+
+    eatt = ble_att_eatt_find_by_chan(event->disconnect.chan);
+    if (eatt == NULL || eatt->chan != event->disconnect.chan) {
+        return;
+    }
+
+    ble_att_eatt_tx_q_clear(eatt);
+    eatt->chan = NULL;
+    eatt->state = BLE_ATT_EATT_STATE_CLOSED;
+
+    ble_npl_eventq_put(ble_hs_evq_get(), &ble_att_eatt_closed_ev);
+}
+
+static void
+ble_att_eatt_received(struct ble_l2cap_event *event)
+{
+    struct os_mbuf *om;
+
+    om = event->receive.sdu_rx;
+
+    ble_att_rx_bearer(event->receive.conn_handle, event->receive.chan->scid,
+                      &om);
+    os_mbuf_free_chain(om);
+
+    if (ble_att_eatt_rx_ready(event->receive.chan) != 0) {
+        /* Without a receive buffer the bearer cannot be used anymore. */
+        ble_l2cap_disconnect(event->receive.chan);
+    }
+}
+
+static int
+ble_att_eatt_l2cap_event(struct ble_l2cap_event *event, void *arg)
+{
+    switch (event->type) {
+    case BLE_L2CAP_EVENT_COC_ACCEPT:
+        return ble_att_eatt_accept(event);
+
+    case BLE_L2CAP_EVENT_COC_CONNECTED:
+        ble_att_eatt_connected(event);
+        return 0;
+
+    case BLE_L2CAP_EVENT_COC_DISCONNECTED:
+        ble_att_eatt_disconnected(event);
+        return 0;
+
+    case BLE_L2CAP_EVENT_COC_DATA_RECEIVED:
+        ble_att_eatt_received(event);
+        return 0;
+
+    case BLE_L2CAP_EVENT_COC_TX_UNSTALLED:
+        ble_att_eatt_tx_q_drain(event->tx_unstalled.conn_handle,
+                                event->tx_unstalled.chan->scid);
+        return 0;
+
+    default:
+        return 0;
+    }
+}
+
+int
+ble_att_eatt_connect(uint16_t conn_handle, uint8_t num_bearers)
+{
+    struct os_mbuf *sdu_rx[MYNEWT_VAL(BLE_EATT_CHAN_NUM)];
+    struct ble_att_eatt *eatts[MYNEWT_VAL(BLE_EATT_CHAN_NUM)];
+    struct ble_gap_conn_desc desc;
+    int rc;
+    int i;
+
+    if (num_bearers == 0 || num_bearers > MYNEWT_VAL(BLE_EATT_CHAN_NUM)) {
+        return BLE_HS_EINVAL;
+    }
+
+    rc = ble_gap_conn_find(conn_handle, &desc);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (!desc.sec_state.encrypted) {
+        return BLE_HS_EENCRYPT;
+    }
+
+    memset(sdu_rx, 0, sizeof sdu_rx);
+    memset(eatts, 0, sizeof eatts);
+
+    ble_hs_lock();
+    for (i = 0; i < num_bearers; i++) {
+        eatts[i] = ble_att_eatt_alloc(conn_handle);
+        if (eatts[i] == NULL) {
+            rc = BLE_HS_ENOMEM;
+            break;
+        }
+    }
+    ble_hs_unlock();
+
+    for (i = 0; rc == 0 && i < num_bearers; i++) {
+        sdu_rx[i] = os_msys_get_pkthdr(MYNEWT_VAL(BLE_EATT_MTU), 0);
+        if (sdu_rx[i] == NULL) {
+            rc = BLE_HS_ENOMEM;
+        }
+    }
+
+    if (rc == 0) {
+        rc = ble_l2cap_enhanced_connect(conn_handle, BLE_ATT_EATT_PSM,
+                                        MYNEWT_VAL(BLE_EATT_MTU), num_bearers,
+                                        sdu_rx, ble_att_eatt_l2cap_event,
+                                        NULL);
+        if (rc == 0) {
+            return 0;
+        }
+    } else {
+        for (i = 0; i < num_bearers; i++) {
+            os_mbuf_free_chain(sdu_rx[i]);
+        }
+    }
+
+    ble_hs_lock();
+    for (i = 0; i < num_bearers; i++) {
+        if (eatts[i] != NULL) {
+            eatts[i]->state = BLE_ATT_EATT_STATE_FREE;
+        }
+    }
+    ble_hs_unlock();
+
+    return rc;
+}
+
+int
+ble_att_eatt_init(void)
+{
+    memset(ble_att_eatt_tbl, 0, sizeof ble_att_eatt_tbl);
+    ble_npl_event_init(&ble_att_eatt_closed_ev, ble_att_eatt_closed_event,
+                       NULL);
+
+    return ble_l2cap_create_server(BLE_ATT_EATT_PSM, MYNEWT_VAL(BLE_EATT_MTU),
+                                   ble_att_eatt_l2cap_event, NULL);
+}
+
+#else
+
+int
+ble_att_eatt_connect(uint16_t conn_handle, uint8_t num_bearers)
+{
+    return BLE_HS_ENOTSUP;
+}
+
+#endif
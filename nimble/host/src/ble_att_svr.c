@@ -53,6 +53,23 @@ static uint16_t ble_att_svr_id;
 static void *ble_att_svr_entry_mem;
 static struct os_mempool ble_att_svr_entry_pool;
 
+/**
+ * Handle-indexed view of the visible attributes.  Slot (handle - 1) points to
+ * the attribute with that handle, or is NULL if the attribute is hidden or
+ * unregistered.  Sized to ble_hs_max_attrs when the server is started.
+ */
+static struct ble_att_svr_entry **ble_att_svr_handle_tbl;
+static uint16_t ble_att_svr_handle_tbl_sz;
+
+/**
+ * Visible attributes sorted by (type, handle).  Allows Read By Type and
+ * similar lookups to jump straight to the matching attributes.  Rebuilt
+ * lazily whenever the set of visible attributes changes.
+ */
+static struct ble_att_svr_entry **ble_att_svr_uuid_idx;
+static uint16_t ble_att_svr_uuid_idx_cnt;
+static uint8_t ble_att_svr_uuid_idx_dirty;
+
 static os_membuf_t ble_att_svr_prep_entry_mem[
     OS_MEMPOOL_SIZE(MYNEWT_VAL(BLE_ATT_SVR_MAX_PREP_ENTRIES),
                     sizeof (struct ble_att_prep_entry))
@@ -92,6 +109,27 @@ ble_att_svr_next_id(void)
     return ++ble_att_svr_id;
 }
 
+static void
+ble_att_svr_handle_tbl_set(uint16_t handle_id, struct ble_att_svr_entry *entry)
+{
+    if (handle_id != 0 && handle_id <= ble_att_svr_handle_tbl_sz) {
+        ble_att_svr_handle_tbl[handle_id - 1] = entry;
+    }
+
+    ble_att_svr_uuid_idx_dirty = 1;
+}
+
+/**
+ * Indicates whether every registered attribute is covered by the handle
+ * table.  If not (e.g., more attributes were registered than were accounted
+ * for at startup), lookups fall back to walking the attribute list.
+ */
+static int
+ble_att_svr_handle_tbl_complete(void)
+{
+    return ble_att_svr_id <= ble_att_svr_handle_tbl_sz;
+}
+
 /**
  * Register a host attribute with the BLE stack.
  *
@@ -123,6 +161,7 @@ ble_att_svr_register(const ble_uuid_t *uuid, uint8_t flags,
     entry->ha_cb_arg = cb_arg;
 
     STAILQ_INSERT_TAIL(&ble_att_svr_list, entry, ha_next);
+    ble_att_svr_handle_tbl_set(entry->ha_handle_id, entry);
 
     if (handle_id != NULL) {
         *handle_id = entry->ha_handle_id;
@@ -141,21 +180,28 @@ ble_att_svr_prev_handle(void)
  * Find a host attribute by handle id.
  *
  * @param handle_id             The handle_id to search for
- * @param ha_ptr                On input: Indicates the starting point of the
- *                                  walk; null means start at the beginning of
- *                                  the list, non-null means start at the
- *                                  following entry.
- *                              On output: Indicates the last ble_att element
- *                                  processed, or NULL if the entire list has
- *                                  been processed.
  *
- * @return                      0 on success; BLE_HS_ENOENT on not found.
+ * @return                      The matching attribute on success; NULL if no
+ *                                  visible attribute has the specified
+ *                                  handle.
  */
 struct ble_att_svr_entry *
 ble_att_svr_find_by_handle(uint16_t handle_id)
 {
     struct ble_att_svr_entry *entry;
 
+    if (handle_id == 0) {
+        return NULL;
+    }
+
+    if (handle_id <= ble_att_svr_handle_tbl_sz) {
+        return ble_att_svr_handle_tbl[handle_id - 1];
+    }
+
+    if (ble_att_svr_handle_tbl_complete()) {
+        return NULL;
+    }
+
     for (entry = STAILQ_FIRST(&ble_att_svr_list);
          entry != NULL;
          entry = STAILQ_NEXT(entry, ha_next)) {
@@ -169,33 +215,178 @@ ble_att_svr_find_by_handle(uint16_t handle_id)
 }
 
 /**
- * Find a host attribute by UUID.
+ * Finds the first visible attribute whose handle is greater than or equal to
+ * the specified handle.
  *
- * @param uuid                  The ble_uuid_t to search for; null means
- *                                  find any type of attribute.
- * @param prev                  On input: Indicates the starting point of the
- *                                  walk; null means start at the beginning of
- *                                  the list, non-null means start at the
- *                                  following entry.
- *                              On output: Indicates the last ble_att element
- *                                  processed, or NULL if the entire list has
- *                                  been processed.
+ * @param start_handle          The lowest handle to consider.
  *
- * @return                      0 on success; BLE_HS_ENOENT on not found.
+ * @return                      The first matching attribute; NULL if there
+ *                                  are no attributes at or above
+ *                                  start_handle.
  */
-struct ble_att_svr_entry *
-ble_att_svr_find_by_uuid(struct ble_att_svr_entry *prev, const ble_uuid_t *uuid,
-                         uint16_t end_handle)
+static struct ble_att_svr_entry *
+ble_att_svr_find_first(uint16_t start_handle)
 {
     struct ble_att_svr_entry *entry;
+    int handle_id;
 
-    if (prev == NULL) {
-        entry = STAILQ_FIRST(&ble_att_svr_list);
-    } else {
-        entry = STAILQ_NEXT(prev, ha_next);
+    if (start_handle == 0) {
+        start_handle = 1;
+    }
+
+    for (handle_id = start_handle;
+         handle_id <= ble_att_svr_handle_tbl_sz;
+         handle_id++) {
+
+        entry = ble_att_svr_handle_tbl[handle_id - 1];
+        if (entry != NULL) {
+            return entry;
+        }
+    }
+
+    if (ble_att_svr_handle_tbl_complete()) {
+        return NULL;
+    }
+
+    STAILQ_FOREACH(entry, &ble_att_svr_list, ha_next) {
+        if (entry->ha_handle_id >= start_handle) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static int
+ble_att_svr_uuid_idx_cmp(const ble_uuid_t *uuid1, uint16_t handle1,
+                         const ble_uuid_t *uuid2, uint16_t handle2)
+{
+    int rc;
+
+    if (uuid1->type != uuid2->type) {
+        return uuid1->type - uuid2->type;
+    }
+
+    switch (uuid1->type) {
+    case BLE_UUID_TYPE_16:
+        rc = (int)BLE_UUID16(uuid1)->value - (int)BLE_UUID16(uuid2)->value;
+        break;
+
+    case BLE_UUID_TYPE_32:
+        if (BLE_UUID32(uuid1)->value == BLE_UUID32(uuid2)->value) {
+            rc = 0;
+        } else if (BLE_UUID32(uuid1)->value < BLE_UUID32(uuid2)->value) {
+            rc = -1;
+        } else {
+            rc = 1;
+        }
+        break;
+
+    default:
+        rc = memcmp(BLE_UUID128(uuid1)->value, BLE_UUID128(uuid2)->value, 16);
+        break;
+    }
+
+    if (rc != 0) {
+        return rc;
+    }
+
+    return (int)handle1 - (int)handle2;
+}
+
+static int
+ble_att_svr_uuid_idx_sort_cmp(const void *a, const void *b)
+{
+    const struct ble_att_svr_entry *entry1;
+    const struct ble_att_svr_entry *entry2;
+
+    entry1 = *(struct ble_att_svr_entry * const *)a;
+    entry2 = *(struct ble_att_svr_entry * const *)b;
+
+    return ble_att_svr_uuid_idx_cmp(entry1->ha_uuid, entry1->ha_handle_id,
+                                    entry2->ha_uuid, entry2->ha_handle_id);
+}
+
+/**
+ * Rebuilds the type index if the set of visible attributes has changed since
+ * it was last built.
+ *
+ * @return                      0 if the index is usable;
+ *                              BLE_HS_ENOMEM if the index is too small to
+ *                                  hold every visible attribute.
+ */
+static int
+ble_att_svr_uuid_idx_update(void)
+{
+    struct ble_att_svr_entry *entry;
+    uint16_t cnt;
+
+    if (!ble_att_svr_uuid_idx_dirty) {
+        return 0;
+    }
+
+    cnt = 0;
+    STAILQ_FOREACH(entry, &ble_att_svr_list, ha_next) {
+        if (cnt >= ble_att_svr_handle_tbl_sz) {
+            return BLE_HS_ENOMEM;
+        }
+        ble_att_svr_uuid_idx[cnt++] = entry;
+    }
+
+    if (cnt > 1) {
+        qsort(ble_att_svr_uuid_idx, cnt, sizeof *ble_att_svr_uuid_idx,
+              ble_att_svr_uuid_idx_sort_cmp);
+    }
+
+    ble_att_svr_uuid_idx_cnt = cnt;
+    ble_att_svr_uuid_idx_dirty = 0;
+
+    return 0;
+}
+
+/**
+ * Finds the first visible attribute of the specified type with a handle in
+ * the range [start_handle, end_handle].
+ */
+static struct ble_att_svr_entry *
+ble_att_svr_find_by_uuid_range(const ble_uuid_t *uuid, uint16_t start_handle,
+                               uint16_t end_handle)
+{
+    struct ble_att_svr_entry *entry;
+    int lo;
+    int hi;
+    int mid;
+
+    if (uuid != NULL && ble_att_svr_uuid_idx_update() == 0) {
+        /* Binary search for the first entry >= (uuid, start_handle). */
+        lo = 0;
+        hi = ble_att_svr_uuid_idx_cnt;
+        while (lo < hi) {
+            mid = (lo + hi) / 2;
+            entry = ble_att_svr_uuid_idx[mid];
+            if (ble_att_svr_uuid_idx_cmp(entry->ha_uuid, entry->ha_handle_id,
+                                         uuid, start_handle) < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        if (lo >= ble_att_svr_uuid_idx_cnt) {
+            return NULL;
+        }
+
+        entry = ble_att_svr_uuid_idx[lo];
+        if (entry->ha_handle_id > end_handle ||
+            ble_uuid_cmp(entry->ha_uuid, uuid) != 0) {
+
+            return NULL;
+        }
+
+        return entry;
     }
 
-    for (;
+    for (entry = ble_att_svr_find_first(start_handle);
          entry != NULL && entry->ha_handle_id <= end_handle;
          entry = STAILQ_NEXT(entry, ha_next)) {
 
@@ -207,6 +398,37 @@ ble_att_svr_find_by_uuid(struct ble_att_svr_entry *prev, const ble_uuid_t *uuid,
     return NULL;
 }
 
+/**
+ * Find a host attribute by UUID.
+ *
+ * @param prev                  Indicates the starting point of the walk; null
+ *                                  means start at the beginning of the
+ *                                  attribute table, non-null means start at
+ *                                  the attribute following prev.
+ * @param uuid                  The ble_uuid_t to search for; null means
+ *                                  find any type of attribute.
+ * @param end_handle            The last handle to consider.
+ *
+ * @return                      The matching attribute on success; NULL if no
+ *                                  more attributes match.
+ */
+struct ble_att_svr_entry *
+ble_att_svr_find_by_uuid(struct ble_att_svr_entry *prev, const ble_uuid_t *uuid,
+                         uint16_t end_handle)
+{
+    uint16_t start_handle;
+
+    if (prev == NULL) {
+        start_handle = 1;
+    } else if (prev->ha_handle_id == UINT16_MAX) {
+        return NULL;
+    } else {
+        start_handle = prev->ha_handle_id + 1;
+    }
+
+    return ble_att_svr_find_by_uuid_range(uuid, start_handle, end_handle);
+}
+
 static int
 ble_att_svr_pullup_req_base(struct os_mbuf **om, int base_len,
                             uint8_t *out_att_err)
@@ -560,8 +782,9 @@ ble_att_svr_write_handle(uint16_t conn_handle, uint16_t attr_handle,
 }
 
 int
-ble_att_svr_tx_error_rsp(uint16_t conn_handle, struct os_mbuf *txom,
-                         uint8_t req_op, uint16_t handle, uint8_t error_code)
+ble_att_svr_tx_error_rsp(uint16_t conn_handle, uint16_t cid,
+                         struct os_mbuf *txom, uint8_t req_op,
+                         uint16_t handle, uint8_t error_code)
 {
     struct ble_att_error_rsp *rsp;
 
@@ -577,7 +800,7 @@ ble_att_svr_tx_error_rsp(uint16_t conn_handle, struct os_mbuf *txom,
     rsp->baep_handle = htole16(handle);
     rsp->baep_error_code = error_code;
 
-    return ble_att_tx(conn_handle, txom);
+    return ble_att_tx(conn_handle, cid, txom);
 }
 
 /**
@@ -592,6 +815,7 @@ ble_att_svr_tx_error_rsp(uint16_t conn_handle, struct os_mbuf *txom,
  * sent instead.
  *
  * @param conn_handle           The handle of the connection to send over.
+ * @param cid                   The bearer the request was received on.
  * @param hs_status             The status indicating whether to transmit an
  *                                  affirmative response or an error.
  * @param txom                  Contains the affirmative response payload.
@@ -604,13 +828,11 @@ ble_att_svr_tx_error_rsp(uint16_t conn_handle, struct os_mbuf *txom,
  *                                  field.
  */
 static int
-ble_att_svr_tx_rsp(uint16_t conn_handle, int hs_status, struct os_mbuf *om,
-                   uint8_t att_op, uint8_t err_status, uint16_t err_handle)
+ble_att_svr_tx_rsp(uint16_t conn_handle, uint16_t cid, int hs_status,
+                   struct os_mbuf *om, uint8_t att_op, uint8_t err_status,
+                   uint16_t err_handle)
 {
-    struct ble_l2cap_chan *chan;
-    struct ble_hs_conn *conn;
     int do_tx;
-    int rc;
 
     if (hs_status != 0 && err_status == 0) {
         /* Processing failed, but err_status of 0 means don't send error. */
@@ -620,28 +842,17 @@ ble_att_svr_tx_rsp(uint16_t conn_handle, int hs_status, struct os_mbuf *om,
     }
 
     if (do_tx) {
-        ble_hs_lock();
-
-        rc = ble_att_conn_chan_find(conn_handle, &conn, &chan);
-        if (rc != 0) {
-            /* No longer connected. */
-            hs_status = rc;
-        } else {
-            if (hs_status == 0) {
-                BLE_HS_DBG_ASSERT(om != NULL);
-
-                ble_att_inc_tx_stat(om->om_data[0]);
-                ble_att_truncate_to_mtu(chan, om);
-                hs_status = ble_l2cap_tx(conn, chan, om);
-                om = NULL;
-                if (hs_status != 0) {
-                    err_status = BLE_ATT_ERR_UNLIKELY;
-                }
-           }
+        if (hs_status == 0) {
+            BLE_HS_DBG_ASSERT(om != NULL);
+
+            ble_att_inc_tx_stat(om->om_data[0]);
+            hs_status = ble_att_tx(conn_handle, cid, om);
+            om = NULL;
+            if (hs_status != 0) {
+                err_status = BLE_ATT_ERR_UNLIKELY;
+            }
         }
 
-        ble_hs_unlock();
-
         if (hs_status != 0) {
             STATS_INC(ble_att_stats, error_rsp_tx);
 
@@ -652,7 +863,7 @@ ble_att_svr_tx_rsp(uint16_t conn_handle, int hs_status, struct os_mbuf *om,
                 os_mbuf_adj(om, OS_MBUF_PKTLEN(om));
             }
             if (om != NULL) {
-                ble_att_svr_tx_error_rsp(conn_handle, om, att_op,
+                ble_att_svr_tx_error_rsp(conn_handle, cid, om, att_op,
                                          err_handle, err_status);
                 om = NULL;
             }
@@ -679,7 +890,7 @@ ble_att_svr_build_mtu_rsp(uint16_t conn_handle, struct os_mbuf **rxom,
     txom = NULL;
 
     ble_hs_lock();
-    rc = ble_att_conn_chan_find(conn_handle, NULL, &chan);
+    rc = ble_att_conn_chan_find(conn_handle, BLE_L2CAP_CID_ATT, NULL, &chan);
     if (rc == 0) {
         mtu = chan->my_mtu;
     }
@@ -710,8 +921,85 @@ done:
     return rc;
 }
 
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+/**
+ * Screens an incoming PDU against the robust caching state of the peer.
+ * PDUs that access the database are rejected while the peer is
+ * change-unaware: commands get dropped and requests are answered with a
+ * Database Out Of Sync error.
+ *
+ * @param conn_handle           The connection the PDU was received on.
+ * @param cid                   The bearer the PDU was received on.
+ * @param op                    The ATT opcode of the PDU.
+ * @param rxom                  The PDU payload, without the opcode.  Consumed
+ *                                  if the PDU gets rejected.
+ *
+ * @return                      0 if the PDU should be processed;
+ *                              BLE_HS_EREJECT if it was rejected.
+ */
+int
+ble_att_svr_rx_change_aware(uint16_t conn_handle, uint16_t cid, uint8_t op,
+                            struct os_mbuf **rxom)
+{
+    uint8_t uuid[2];
+    int is_hash_read;
+    int is_req;
+    int rc;
+
+    switch (op) {
+    case BLE_ATT_OP_FIND_INFO_REQ:
+    case BLE_ATT_OP_FIND_TYPE_VALUE_REQ:
+    case BLE_ATT_OP_READ_TYPE_REQ:
+    case BLE_ATT_OP_READ_REQ:
+    case BLE_ATT_OP_READ_BLOB_REQ:
+    case BLE_ATT_OP_READ_MULT_REQ:
+    case BLE_ATT_OP_READ_GROUP_TYPE_REQ:
+    case BLE_ATT_OP_WRITE_REQ:
+    case BLE_ATT_OP_PREP_WRITE_REQ:
+    case BLE_ATT_OP_EXEC_WRITE_REQ:
+    case BLE_ATT_OP_READ_MULT_VAR_REQ:
+        is_req = 1;
+        break;
+
+    case BLE_ATT_OP_WRITE_CMD:
+    case BLE_ATT_OP_SIGNED_WRITE_CMD:
+        is_req = 0;
+        break;
+
+    default:
+        return 0;
+    }
+
+    /* A change-unaware client may always read the Database Hash by type. */
+    is_hash_read = 0;
+    if (op == BLE_ATT_OP_READ_TYPE_REQ &&
+        OS_MBUF_PKTLEN(*rxom) == sizeof (struct ble_att_read_type_req) + 2) {
+
+        rc = os_mbuf_copydata(*rxom, sizeof (struct ble_att_read_type_req),
+                              sizeof uuid, uuid);
+        is_hash_read = rc == 0 &&
+                       get_le16(uuid) == BLE_GATT_CHR_DB_HASH_UUID16;
+    }
+
+    if (ble_gatts_peer_change_aware(conn_handle, is_req, is_hash_read)) {
+        return 0;
+    }
+
+    if (is_req) {
+        STATS_INC(ble_att_stats, error_rsp_tx);
+
+        os_mbuf_adj(*rxom, OS_MBUF_PKTLEN(*rxom));
+        ble_att_svr_tx_error_rsp(conn_handle, cid, *rxom, op, 0,
+                                 BLE_ATT_ERR_DB_OUT_OF_SYNC);
+        *rxom = NULL;
+    }
+
+    return BLE_HS_EREJECT;
+}
+#endif
+
 int
-ble_att_svr_rx_mtu(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_svr_rx_mtu(uint16_t conn_handle, uint16_t cid, struct os_mbuf **rxom)
 {
     struct ble_att_mtu_cmd *cmd;
     struct ble_l2cap_chan *chan;
@@ -721,6 +1009,11 @@ ble_att_svr_rx_mtu(uint16_t conn_handle, struct os_mbuf **rxom)
     uint8_t att_err;
     int rc;
 
+    /* MTU exchange is only allowed on the unenhanced bearer. */
+    if (cid != BLE_L2CAP_CID_ATT) {
+        return BLE_HS_ENOTSUP;
+    }
+
     txom = NULL;
     mtu = 0;
 
@@ -741,12 +1034,13 @@ ble_att_svr_rx_mtu(uint16_t conn_handle, struct os_mbuf **rxom)
     rc = 0;
 
 done:
-    rc = ble_att_svr_tx_rsp(conn_handle, rc, txom, BLE_ATT_OP_MTU_REQ,
+    rc = ble_att_svr_tx_rsp(conn_handle, cid, rc, txom, BLE_ATT_OP_MTU_REQ,
                             att_err, 0);
     if (rc == 0) {
         ble_hs_lock();
 
-        rc = ble_att_conn_chan_find(conn_handle, &conn, &chan);
+        rc = ble_att_conn_chan_find(conn_handle, BLE_L2CAP_CID_ATT, &conn,
+                                    &chan);
         if (rc == 0) {
             ble_att_set_peer_mtu(chan, mtu);
             chan->flags |= BLE_L2CAP_CHAN_F_TXED_MTU;
@@ -792,7 +1086,10 @@ ble_att_svr_fill_info(uint16_t start_handle, uint16_t end_handle,
     num_entries = 0;
     rc = 0;
 
-    STAILQ_FOREACH(ha, &ble_att_svr_list, ha_next) {
+    for (ha = ble_att_svr_find_first(start_handle);
+         ha != NULL;
+         ha = STAILQ_NEXT(ha, ha_next)) {
+
         if (ha->ha_handle_id > end_handle) {
             rc = 0;
             goto done;
@@ -845,7 +1142,7 @@ done:
 }
 
 static int
-ble_att_svr_build_find_info_rsp(uint16_t conn_handle,
+ble_att_svr_build_find_info_rsp(uint16_t conn_handle, uint16_t cid,
                                 uint16_t start_handle, uint16_t end_handle,
                                 struct os_mbuf **rxom,
                                 struct os_mbuf **out_txom,
@@ -874,7 +1171,7 @@ ble_att_svr_build_find_info_rsp(uint16_t conn_handle,
     /* Write the variable length Information Data field, populating the format
      * field as appropriate.
      */
-    mtu = ble_att_mtu(conn_handle);
+    mtu = ble_att_mtu_by_cid(conn_handle, cid);
     rc = ble_att_svr_fill_info(start_handle, end_handle, txom, mtu,
                                &rsp->bafp_format);
     if (rc != 0) {
@@ -891,7 +1188,8 @@ done:
 }
 
 int
-ble_att_svr_rx_find_info(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_svr_rx_find_info(uint16_t conn_handle, uint16_t cid,
+                         struct os_mbuf **rxom)
 {
 #if !MYNEWT_VAL(BLE_ATT_SVR_FIND_INFO)
     return BLE_HS_ENOTSUP;
@@ -928,7 +1226,7 @@ ble_att_svr_rx_find_info(uint16_t conn_handle, struct os_mbuf **rxom)
         goto done;
     }
 
-    rc = ble_att_svr_build_find_info_rsp(conn_handle,
+    rc = ble_att_svr_build_find_info_rsp(conn_handle, cid,
                                         start_handle, end_handle,
                                         rxom, &txom, &att_err);
     if (rc != 0) {
@@ -939,8 +1237,8 @@ ble_att_svr_rx_find_info(uint16_t conn_handle, struct os_mbuf **rxom)
     rc = 0;
 
 done:
-    rc = ble_att_svr_tx_rsp(conn_handle, rc, txom, BLE_ATT_OP_FIND_INFO_REQ,
-                            att_err, err_handle);
+    rc = ble_att_svr_tx_rsp(conn_handle, cid, rc, txom,
+                            BLE_ATT_OP_FIND_INFO_REQ, att_err, err_handle);
     return rc;
 }
 
@@ -1077,10 +1375,9 @@ ble_att_svr_fill_type_value(uint16_t conn_handle,
      * matching group.  For each attribute entry, determine if data needs to be
      * written to the response.
      */
-    STAILQ_FOREACH(ha, &ble_att_svr_list, ha_next) {
-        if (ha->ha_handle_id < start_handle) {
-            continue;
-        }
+    for (ha = ble_att_svr_find_first(start_handle);
+         ha != NULL;
+         ha = STAILQ_NEXT(ha, ha_next)) {
 
         /* Continue to look for end of group in case group is in progress. */
         if (!first && ha->ha_handle_id > end_handle) {
@@ -1154,7 +1451,7 @@ done:
 }
 
 static int
-ble_att_svr_build_find_type_value_rsp(uint16_t conn_handle,
+ble_att_svr_build_find_type_value_rsp(uint16_t conn_handle, uint16_t cid,
                                       uint16_t start_handle,
                                       uint16_t end_handle,
                                       ble_uuid16_t attr_type,
@@ -1181,7 +1478,7 @@ ble_att_svr_build_find_type_value_rsp(uint16_t conn_handle,
     }
 
     /* Write the variable length Information Data field. */
-    mtu = ble_att_mtu(conn_handle);
+    mtu = ble_att_mtu_by_cid(conn_handle, cid);
 
     rc = ble_att_svr_fill_type_value(conn_handle, start_handle, end_handle,
                                      attr_type, *rxom, txom, mtu,
@@ -1198,7 +1495,8 @@ done:
 }
 
 int
-ble_att_svr_rx_find_type_value(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_svr_rx_find_type_value(uint16_t conn_handle, uint16_t cid,
+                               struct os_mbuf **rxom)
 {
 #if !MYNEWT_VAL(BLE_ATT_SVR_FIND_TYPE)
     return BLE_HS_ENOTSUP;
@@ -1236,7 +1534,7 @@ ble_att_svr_rx_find_type_value(uint16_t conn_handle, struct os_mbuf **rxom)
         rc = BLE_HS_EBADDATA;
         goto done;
     }
-    rc = ble_att_svr_build_find_type_value_rsp(conn_handle, start_handle,
+    rc = ble_att_svr_build_find_type_value_rsp(conn_handle, cid, start_handle,
                                                end_handle, attr_type, rxom,
                                                &txom, &att_err);
     if (rc != 0) {
@@ -1247,14 +1545,14 @@ ble_att_svr_rx_find_type_value(uint16_t conn_handle, struct os_mbuf **rxom)
     rc = 0;
 
 done:
-    rc = ble_att_svr_tx_rsp(conn_handle, rc, txom,
+    rc = ble_att_svr_tx_rsp(conn_handle, cid, rc, txom,
                             BLE_ATT_OP_FIND_TYPE_VALUE_REQ, att_err,
                             err_handle);
     return rc;
 }
 
 static int
-ble_att_svr_build_read_type_rsp(uint16_t conn_handle,
+ble_att_svr_build_read_type_rsp(uint16_t conn_handle, uint16_t cid,
                                 uint16_t start_handle, uint16_t end_handle,
                                 const ble_uuid_t *uuid,
                                 struct os_mbuf **rxom,
@@ -1297,12 +1595,17 @@ ble_att_svr_build_read_type_rsp(uint16_t conn_handle,
         goto done;
     }
 
-    mtu = ble_att_mtu(conn_handle);
+    mtu = ble_att_mtu_by_cid(conn_handle, cid);
 
     /* Find all matching attributes, writing a record for each. */
     entry = NULL;
     while (1) {
-        entry = ble_att_svr_find_by_uuid(entry, uuid, end_handle);
+        if (entry == NULL) {
+            entry = ble_att_svr_find_by_uuid_range(uuid, start_handle,
+                                                   end_handle);
+        } else {
+            entry = ble_att_svr_find_by_uuid(entry, uuid, end_handle);
+        }
         if (entry == NULL) {
             rc = BLE_HS_ENOENT;
             break;
@@ -1369,7 +1672,8 @@ done:
 }
 
 int
-ble_att_svr_rx_read_type(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_svr_rx_read_type(uint16_t conn_handle, uint16_t cid,
+                         struct os_mbuf **rxom)
 {
 #if !MYNEWT_VAL(BLE_ATT_SVR_READ_TYPE)
     return BLE_HS_ENOTSUP;
@@ -1421,9 +1725,9 @@ ble_att_svr_rx_read_type(uint16_t conn_handle, struct os_mbuf **rxom)
         goto done;
     }
 
-    rc = ble_att_svr_build_read_type_rsp(conn_handle, start_handle, end_handle,
-                                         &uuid.u, rxom, &txom, &att_err,
-                                         &err_handle);
+    rc = ble_att_svr_build_read_type_rsp(conn_handle, cid, start_handle,
+                                         end_handle, &uuid.u, rxom, &txom,
+                                         &att_err, &err_handle);
     if (rc != 0) {
         goto done;
     }
@@ -1431,13 +1735,13 @@ ble_att_svr_rx_read_type(uint16_t conn_handle, struct os_mbuf **rxom)
     rc = 0;
 
 done:
-    rc = ble_att_svr_tx_rsp(conn_handle, rc, txom, BLE_ATT_OP_READ_TYPE_REQ,
-                            att_err, err_handle);
+    rc = ble_att_svr_tx_rsp(conn_handle, cid, rc, txom,
+                            BLE_ATT_OP_READ_TYPE_REQ, att_err, err_handle);
     return rc;
 }
 
 int
-ble_att_svr_rx_read(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_svr_rx_read(uint16_t conn_handle, uint16_t cid, struct os_mbuf **rxom)
 {
 #if !MYNEWT_VAL(BLE_ATT_SVR_READ)
     return BLE_HS_ENOTSUP;
@@ -1480,13 +1784,14 @@ ble_att_svr_rx_read(uint16_t conn_handle, struct os_mbuf **rxom)
     }
 
 done:
-    rc = ble_att_svr_tx_rsp(conn_handle, rc, txom, BLE_ATT_OP_READ_REQ,
+    rc = ble_att_svr_tx_rsp(conn_handle, cid, rc, txom, BLE_ATT_OP_READ_REQ,
                             att_err, err_handle);
     return rc;
 }
 
 int
-ble_att_svr_rx_read_blob(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_svr_rx_read_blob(uint16_t conn_handle, uint16_t cid,
+                         struct os_mbuf **rxom)
 {
 #if !MYNEWT_VAL(BLE_ATT_SVR_READ_BLOB)
     return BLE_HS_ENOTSUP;
@@ -1533,13 +1838,18 @@ ble_att_svr_rx_read_blob(uint16_t conn_handle, struct os_mbuf **rxom)
     rc = 0;
 
 done:
-    rc = ble_att_svr_tx_rsp(conn_handle, rc, txom, BLE_ATT_OP_READ_BLOB_REQ,
-                            att_err, err_handle);
+    rc = ble_att_svr_tx_rsp(conn_handle, cid, rc, txom,
+                            BLE_ATT_OP_READ_BLOB_REQ, att_err, err_handle);
     return rc;
 }
 
+/**
+ * Builds a read multiple response.  For the variable length variant, each
+ * value is preceded by its length.
+ */
 static int
-ble_att_svr_build_read_mult_rsp(uint16_t conn_handle,
+ble_att_svr_build_read_mult_rsp(uint16_t conn_handle, uint16_t cid,
+                                int variable,
                                 struct os_mbuf **rxom,
                                 struct os_mbuf **out_txom,
                                 uint8_t *att_err,
@@ -1547,10 +1857,13 @@ ble_att_svr_build_read_mult_rsp(uint16_t conn_handle,
 {
     struct os_mbuf *txom;
     uint16_t handle;
+    uint16_t len_off;
     uint16_t mtu;
+    uint8_t len_buf[2];
+    uint8_t rsp_op;
     int rc;
 
-    mtu = ble_att_mtu(conn_handle);
+    mtu = ble_att_mtu_by_cid(conn_handle, cid);
 
     rc = ble_att_svr_pkt(rxom, &txom, att_err);
     if (rc != 0) {
@@ -1558,7 +1871,12 @@ ble_att_svr_build_read_mult_rsp(uint16_t conn_handle,
         goto done;
     }
 
-    if (ble_att_cmd_prepare(BLE_ATT_OP_READ_MULT_RSP, 0, txom) == NULL) {
+    if (variable) {
+        rsp_op = BLE_ATT_OP_READ_MULT_VAR_RSP;
+    } else {
+        rsp_op = BLE_ATT_OP_READ_MULT_RSP;
+    }
+    if (ble_att_cmd_prepare(rsp_op, 0, txom) == NULL) {
         *att_err = BLE_ATT_ERR_INSUFFICIENT_RES;
         *err_handle = 0;
         rc = BLE_HS_ENOMEM;
@@ -1585,11 +1903,33 @@ ble_att_svr_build_read_mult_rsp(uint16_t conn_handle,
         handle = get_le16((*rxom)->om_data);
         os_mbuf_adj(*rxom, 2);
 
+        len_off = OS_MBUF_PKTLEN(txom);
+        if (variable && os_mbuf_extend(txom, 2) == NULL) {
+            *att_err = BLE_ATT_ERR_INSUFFICIENT_RES;
+            *err_handle = 0;
+            rc = BLE_HS_ENOMEM;
+            goto done;
+        }
+
         rc = ble_att_svr_read_handle(conn_handle, handle, 0, txom, att_err);
         if (rc != 0) {
             *err_handle = handle;
             goto done;
         }
+
+        if (variable) {
+            /* The length is that of the full value; the last value may still
+             * get truncated to fit the MTU.
+             */
+            put_le16(len_buf, OS_MBUF_PKTLEN(txom) - len_off - 2);
+            rc = os_mbuf_copyinto(txom, len_off, len_buf, sizeof len_buf);
+            if (rc != 0) {
+                *att_err = BLE_ATT_ERR_INSUFFICIENT_RES;
+                *err_handle = 0;
+                rc = BLE_HS_ENOMEM;
+                goto done;
+            }
+        }
     }
 
     rc = 0;
@@ -1600,7 +1940,8 @@ done:
 }
 
 int
-ble_att_svr_rx_read_mult(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_svr_rx_read_mult(uint16_t conn_handle, uint16_t cid,
+                         struct os_mbuf **rxom)
 {
 #if !MYNEWT_VAL(BLE_ATT_SVR_READ_MULT)
     return BLE_HS_ENOTSUP;
@@ -1616,11 +1957,43 @@ ble_att_svr_rx_read_mult(uint16_t conn_handle, struct os_mbuf **rxom)
     err_handle = 0;
     att_err = 0;
 
-    rc = ble_att_svr_build_read_mult_rsp(conn_handle, rxom, &txom, &att_err,
-                                         &err_handle);
+    rc = ble_att_svr_build_read_mult_rsp(conn_handle, cid, 0, rxom, &txom,
+                                         &att_err, &err_handle);
 
-    return ble_att_svr_tx_rsp(conn_handle, rc, txom, BLE_ATT_OP_READ_MULT_REQ,
-                              att_err, err_handle);
+    return ble_att_svr_tx_rsp(conn_handle, cid, rc, txom,
+                              BLE_ATT_OP_READ_MULT_REQ, att_err, err_handle);
+}
+
+int
+ble_att_svr_rx_read_mult_var(uint16_t conn_handle, uint16_t cid,
+                             struct os_mbuf **rxom)
+{
+#if !MYNEWT_VAL(BLE_ATT_SVR_READ_MULT_VAR)
+    return BLE_HS_ENOTSUP;
+#endif
+
+    struct os_mbuf *txom;
+    uint16_t err_handle;
+    uint8_t att_err;
+    int rc;
+
+    /* Initialize some values in case of early error. */
+    txom = NULL;
+    err_handle = 0;
+    att_err = 0;
+
+    /* At least two handles are required. */
+    if (OS_MBUF_PKTLEN(*rxom) < 4) {
+        att_err = BLE_ATT_ERR_INVALID_PDU;
+        rc = BLE_HS_EBADDATA;
+    } else {
+        rc = ble_att_svr_build_read_mult_rsp(conn_handle, cid, 1, rxom, &txom,
+                                             &att_err, &err_handle);
+    }
+
+    return ble_att_svr_tx_rsp(conn_handle, cid, rc, txom,
+                              BLE_ATT_OP_READ_MULT_VAR_REQ, att_err,
+                              err_handle);
 }
 
 static int
@@ -1687,7 +2060,7 @@ ble_att_svr_read_group_type_entry_write(struct os_mbuf *om, uint16_t mtu,
  * @return                      0 on success; BLE_HS error code on failure.
  */
 static int
-ble_att_svr_build_read_group_type_rsp(uint16_t conn_handle,
+ble_att_svr_build_read_group_type_rsp(uint16_t conn_handle, uint16_t cid,
                                       uint16_t start_handle,
                                       uint16_t end_handle,
                                       const ble_uuid_t *group_uuid,
@@ -1711,7 +2084,7 @@ ble_att_svr_build_read_group_type_rsp(uint16_t conn_handle,
     *att_err = 0;
     *err_handle = start_handle;
 
-    mtu = ble_att_mtu(conn_handle);
+    mtu = ble_att_mtu_by_cid(conn_handle, cid);
 
     /* Just reuse the request buffer for the response. */
     txom = *rxom;
@@ -1729,10 +2102,10 @@ ble_att_svr_build_read_group_type_rsp(uint16_t conn_handle,
 
     start_group_handle = 0;
     rsp->bagp_length = 0;
-    STAILQ_FOREACH(entry, &ble_att_svr_list, ha_next) {
-        if (entry->ha_handle_id < start_handle) {
-            continue;
-        }
+    for (entry = ble_att_svr_find_first(start_handle);
+         entry != NULL;
+         entry = STAILQ_NEXT(entry, ha_next)) {
+
         if (entry->ha_handle_id > end_handle) {
             /* The full input range has been searched. */
             rc = 0;
@@ -1854,7 +2227,8 @@ done:
 }
 
 int
-ble_att_svr_rx_read_group_type(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_svr_rx_read_group_type(uint16_t conn_handle, uint16_t cid,
+                               struct os_mbuf **rxom)
 {
 #if !MYNEWT_VAL(BLE_ATT_SVR_READ_GROUP_TYPE)
     return BLE_HS_ENOTSUP;
@@ -1914,7 +2288,7 @@ ble_att_svr_rx_read_group_type(uint16_t conn_handle, struct os_mbuf **rxom)
         goto done;
     }
 
-    rc = ble_att_svr_build_read_group_type_rsp(conn_handle, start_handle,
+    rc = ble_att_svr_build_read_group_type_rsp(conn_handle, cid, start_handle,
                                                end_handle, &uuid.u,
                                                rxom, &txom, &att_err,
                                                &err_handle);
@@ -1925,7 +2299,7 @@ ble_att_svr_rx_read_group_type(uint16_t conn_handle, struct os_mbuf **rxom)
     rc = 0;
 
 done:
-    rc = ble_att_svr_tx_rsp(conn_handle, rc, txom,
+    rc = ble_att_svr_tx_rsp(conn_handle, cid, rc, txom,
                             BLE_ATT_OP_READ_GROUP_TYPE_REQ, att_err,
                             err_handle);
     return rc;
@@ -1960,7 +2334,7 @@ done:
 }
 
 int
-ble_att_svr_rx_write(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_svr_rx_write(uint16_t conn_handle, uint16_t cid, struct os_mbuf **rxom)
 {
 #if !MYNEWT_VAL(BLE_ATT_SVR_WRITE)
     return BLE_HS_ENOTSUP;
@@ -2005,13 +2379,14 @@ ble_att_svr_rx_write(uint16_t conn_handle, struct os_mbuf **rxom)
     rc = 0;
 
 done:
-    rc = ble_att_svr_tx_rsp(conn_handle, rc, txom, BLE_ATT_OP_WRITE_REQ,
+    rc = ble_att_svr_tx_rsp(conn_handle, cid, rc, txom, BLE_ATT_OP_WRITE_REQ,
                             att_err, handle);
     return rc;
 }
 
 int
-ble_att_svr_rx_write_no_rsp(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_svr_rx_write_no_rsp(uint16_t conn_handle, uint16_t cid,
+                            struct os_mbuf **rxom)
 {
 #if !MYNEWT_VAL(BLE_ATT_SVR_WRITE_NO_RSP)
     return BLE_HS_ENOTSUP;
@@ -2297,7 +2672,8 @@ ble_att_svr_insert_prep_entry(uint16_t conn_handle,
 }
 
 int
-ble_att_svr_rx_prep_write(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_svr_rx_prep_write(uint16_t conn_handle, uint16_t cid,
+                          struct os_mbuf **rxom)
 {
 #if !MYNEWT_VAL(BLE_ATT_SVR_QUEUED_WRITE)
     return BLE_HS_ENOTSUP;
@@ -2372,13 +2748,14 @@ ble_att_svr_rx_prep_write(uint16_t conn_handle, struct os_mbuf **rxom)
     rc = 0;
 
 done:
-    rc = ble_att_svr_tx_rsp(conn_handle, rc, txom, BLE_ATT_OP_PREP_WRITE_REQ,
-                            att_err, err_handle);
+    rc = ble_att_svr_tx_rsp(conn_handle, cid, rc, txom,
+                            BLE_ATT_OP_PREP_WRITE_REQ, att_err, err_handle);
     return rc;
 }
 
 int
-ble_att_svr_rx_exec_write(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_svr_rx_exec_write(uint16_t conn_handle, uint16_t cid,
+                          struct os_mbuf **rxom)
 {
 #if !MYNEWT_VAL(BLE_ATT_SVR_QUEUED_WRITE)
     return BLE_HS_ENOTSUP;
@@ -2447,13 +2824,14 @@ done:
         ble_att_svr_prep_clear(&prep_list);
     }
 
-    rc = ble_att_svr_tx_rsp(conn_handle, rc, txom, BLE_ATT_OP_EXEC_WRITE_REQ,
-                            att_err, err_handle);
+    rc = ble_att_svr_tx_rsp(conn_handle, cid, rc, txom,
+                            BLE_ATT_OP_EXEC_WRITE_REQ, att_err, err_handle);
     return rc;
 }
 
 int
-ble_att_svr_rx_notify(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_svr_rx_notify(uint16_t conn_handle, uint16_t cid,
+                      struct os_mbuf **rxom)
 {
 #if !MYNEWT_VAL(BLE_ATT_SVR_NOTIFY)
     return BLE_HS_ENOTSUP;
@@ -2485,6 +2863,63 @@ ble_att_svr_rx_notify(uint16_t conn_handle, struct os_mbuf **rxom)
     return 0;
 }
 
+int
+ble_att_svr_rx_notify_multi(uint16_t conn_handle, uint16_t cid,
+                            struct os_mbuf **rxom)
+{
+#if !MYNEWT_VAL(BLE_ATT_SVR_NOTIFY_MULTI)
+    return BLE_HS_ENOTSUP;
+#endif
+
+    struct ble_att_notify_multi_tuple *tuple;
+    struct os_mbuf *om;
+    uint16_t handle;
+    uint16_t len;
+    int rc;
+
+    while (OS_MBUF_PKTLEN(*rxom) >= sizeof(*tuple)) {
+        rc = ble_att_svr_pullup_req_base(rxom, sizeof(*tuple), NULL);
+        if (rc != 0) {
+            return BLE_HS_ENOMEM;
+        }
+
+        tuple = (struct ble_att_notify_multi_tuple *)(*rxom)->om_data;
+        handle = le16toh(tuple->handle);
+        len = le16toh(tuple->len);
+
+        if (handle == 0) {
+            return BLE_HS_EBADDATA;
+        }
+
+        os_mbuf_adj(*rxom, sizeof(*tuple));
+
+        /* The last value takes the remainder of the PDU; it may have been
+         * truncated by the sender.
+         */
+        if (len >= OS_MBUF_PKTLEN(*rxom)) {
+            ble_gap_notify_rx_event(conn_handle, handle, *rxom, 0);
+            *rxom = NULL;
+            return 0;
+        }
+
+        om = ble_hs_mbuf_bare_pkt();
+        if (om == NULL) {
+            return BLE_HS_ENOMEM;
+        }
+
+        rc = os_mbuf_appendfrom(om, *rxom, 0, len);
+        if (rc != 0) {
+            os_mbuf_free_chain(om);
+            return BLE_HS_ENOMEM;
+        }
+        os_mbuf_adj(*rxom, len);
+
+        ble_gap_notify_rx_event(conn_handle, handle, om, 0);
+    }
+
+    return 0;
+}
+
 /**
  * @return                      0 on success; nonzero on failure.
  */
@@ -2518,7 +2953,8 @@ done:
 }
 
 int
-ble_att_svr_rx_indicate(uint16_t conn_handle, struct os_mbuf **rxom)
+ble_att_svr_rx_indicate(uint16_t conn_handle, uint16_t cid,
+                        struct os_mbuf **rxom)
 {
 #if !MYNEWT_VAL(BLE_ATT_SVR_INDICATE)
     return BLE_HS_ENOTSUP;
@@ -2560,14 +2996,18 @@ ble_att_svr_rx_indicate(uint16_t conn_handle, struct os_mbuf **rxom)
     /* Strip the request base from the front of the mbuf. */
     os_mbuf_adj(*rxom, sizeof(*req));
 
+#if MYNEWT_VAL(BLE_GATT_CACHING)
+    ble_gattc_cache_rx_indicate(conn_handle, handle);
+#endif
+
     ble_gap_notify_rx_event(conn_handle, handle, *rxom, 1);
     *rxom = NULL;
 
     rc = 0;
 
 done:
-    rc = ble_att_svr_tx_rsp(conn_handle, rc, txom, BLE_ATT_OP_INDICATE_REQ,
-                            att_err, handle);
+    rc = ble_att_svr_tx_rsp(conn_handle, cid, rc, txom,
+                            BLE_ATT_OP_INDICATE_REQ, att_err, handle);
     return rc;
 }
 
@@ -2622,6 +3062,10 @@ ble_att_svr_move_entries(struct ble_att_svr_entry_list *src,
             insert = entry;
         }
 
+        /* Only entries in the visible list are reachable by handle. */
+        ble_att_svr_handle_tbl_set(entry->ha_handle_id,
+                                   dst == &ble_att_svr_list ? entry : NULL);
+
         /* Calculate next candidate to remove */
         if (remove == NULL) {
             entry = STAILQ_FIRST(src);
@@ -2660,6 +3104,13 @@ ble_att_svr_reset(void)
         ble_att_svr_entry_free(entry);
     }
 
+    if (ble_att_svr_handle_tbl != NULL) {
+        memset(ble_att_svr_handle_tbl, 0,
+               ble_att_svr_handle_tbl_sz * sizeof *ble_att_svr_handle_tbl);
+    }
+    ble_att_svr_uuid_idx_cnt = 0;
+    ble_att_svr_uuid_idx_dirty = 1;
+
     /* Note: prep entries do not get freed here because it is assumed there are
      * no established connections.
      */
@@ -2670,6 +3121,16 @@ ble_att_svr_free_start_mem(void)
 {
     free(ble_att_svr_entry_mem);
     ble_att_svr_entry_mem = NULL;
+
+    free(ble_att_svr_handle_tbl);
+    ble_att_svr_handle_tbl = NULL;
+
+    free(ble_att_svr_uuid_idx);
+    ble_att_svr_uuid_idx = NULL;
+
+    ble_att_svr_handle_tbl_sz = 0;
+    ble_att_svr_uuid_idx_cnt = 0;
+    ble_att_svr_uuid_idx_dirty = 1;
 }
 
 int
@@ -2695,6 +3156,16 @@ ble_att_svr_start(void)
             rc = BLE_HS_EOS;
             goto err;
         }
+
+        ble_att_svr_handle_tbl = calloc(ble_hs_max_attrs,
+                                        sizeof *ble_att_svr_handle_tbl);
+        ble_att_svr_uuid_idx = malloc(ble_hs_max_attrs *
+                                      sizeof *ble_att_svr_uuid_idx);
+        if (ble_att_svr_handle_tbl == NULL || ble_att_svr_uuid_idx == NULL) {
+            rc = BLE_HS_ENOMEM;
+            goto err;
+        }
+        ble_att_svr_handle_tbl_sz = ble_hs_max_attrs;
     }
 
     return 0;
@@ -2724,6 +3195,8 @@ ble_att_svr_init(void)
     STAILQ_INIT(&ble_att_svr_hidden_list);
 
     ble_att_svr_id = 0;
+    ble_att_svr_uuid_idx_cnt = 0;
+    ble_att_svr_uuid_idx_dirty = 1;
 
     return 0;
 }
@@ -1103,6 +1103,7 @@ ble_gap_conn_broken(uint16_t conn_handle, int reason)
     ble_l2cap_sig_conn_broken(conn_handle, reason);
     ble_sm_connection_broken(conn_handle);
     ble_gatts_connection_broken(conn_handle);
+    ble_att_eatt_connection_broken(conn_handle);
     ble_gattc_connection_broken(conn_handle);
     ble_hs_flow_connection_broken(conn_handle);;
 
@@ -5735,6 +5736,61 @@ ble_gap_conn_rssi(uint16_t conn_handle, int8_t *out_rssi)
     return rc;
 }
 
+int
+ble_gap_set_tx_weight(uint16_t conn_handle, uint8_t weight)
+{
+#if !MYNEWT_VAL(BLE_HS_TX_SCHED_WEIGHTED)
+    return BLE_HS_ENOTSUP;
+#endif
+
+    struct ble_hs_conn *conn;
+    int rc;
+
+    if (weight == 0) {
+        return BLE_HS_EINVAL;
+    }
+
+    ble_hs_lock();
+
+    conn = ble_hs_conn_find(conn_handle);
+    if (conn == NULL) {
+        rc = BLE_HS_ENOTCONN;
+    } else {
+        conn->bhc_tx_weight = weight;
+        rc = 0;
+    }
+
+    ble_hs_unlock();
+
+    return rc;
+}
+
+int
+ble_gap_conn_tx_stats(uint16_t conn_handle,
+                      struct ble_gap_conn_tx_stats *out_stats)
+{
+    struct ble_hs_conn *conn;
+    int rc;
+
+    ble_hs_lock();
+
+    conn = ble_hs_conn_find(conn_handle);
+    if (conn == NULL) {
+        rc = BLE_HS_ENOTCONN;
+    } else {
+        out_stats->queue_len = conn->bhc_tx_q_len;
+        out_stats->queue_len_max = conn->bhc_tx_q_len_max;
+        out_stats->wait_max_ms =
+            ble_npl_time_ticks_to_ms32(conn->bhc_tx_wait_max);
+        out_stats->weight = conn->bhc_tx_weight;
+        rc = 0;
+    }
+
+    ble_hs_unlock();
+
+    return rc;
+}
+
 /*****************************************************************************
  * $notify                                                                   *
  *****************************************************************************/
@@ -32,6 +32,7 @@ struct ble_att_find_type_value_hinfo;
 struct ble_att_find_info_idata;
 struct ble_att_read_group_type_adata;
 struct ble_att_prep_write_cmd;
+struct ble_store_key_peer_attr;
 
 STATS_SECT_START(ble_gattc_stats)
     STATS_SECT_ENTRY(mtu)
@@ -96,6 +97,12 @@ struct ble_gatts_conn {
     int num_clt_cfgs;
 
     uint16_t indicate_val_handle;
+
+    /** Client Supported Features written by the peer. */
+    uint8_t peer_cl_sup_feat[BLE_GATT_CHR_CLI_SUP_FEAT_SZ];
+
+    /** Robust caching state of the peer; BLE_GATTS_CONN_F_[...]. */
+    ble_gatts_conn_flags flags;
 };
 
 /*** @client. */
@@ -103,45 +110,153 @@ struct ble_gatts_conn {
 int ble_gattc_locked_by_cur_task(void);
 void ble_gatts_indicate_fail_notconn(uint16_t conn_handle);
 
-void ble_gattc_rx_err(uint16_t conn_handle, uint16_t handle, uint16_t status);
+void ble_gattc_rx_err(uint16_t conn_handle, uint16_t cid, uint16_t handle,
+                      uint16_t status);
 void ble_gattc_rx_mtu(uint16_t conn_handle, int status, uint16_t chan_mtu);
-void ble_gattc_rx_read_type_adata(uint16_t conn_handle,
+void ble_gattc_rx_read_type_adata(uint16_t conn_handle, uint16_t cid,
                                   struct ble_att_read_type_adata *adata);
-void ble_gattc_rx_read_type_complete(uint16_t conn_handle, int status);
-void ble_gattc_rx_read_rsp(uint16_t conn_handle, int status,
+void ble_gattc_rx_read_type_complete(uint16_t conn_handle, uint16_t cid,
+                                     int status);
+void ble_gattc_rx_read_rsp(uint16_t conn_handle, uint16_t cid, int status,
                            struct os_mbuf **rxom);
-void ble_gattc_rx_read_blob_rsp(uint16_t conn_handle, int status,
-                                struct os_mbuf **rxom);
-void ble_gattc_rx_read_mult_rsp(uint16_t conn_handle, int status,
-                                struct os_mbuf **rxom);
+void ble_gattc_rx_read_blob_rsp(uint16_t conn_handle, uint16_t cid,
+                                int status, struct os_mbuf **rxom);
+void ble_gattc_rx_read_mult_rsp(uint16_t conn_handle, uint16_t cid,
+                                int status, struct os_mbuf **rxom);
+void ble_gattc_rx_read_mult_var_rsp(uint16_t conn_handle, uint16_t cid,
+                                    int status, struct os_mbuf **om);
 void ble_gattc_rx_read_group_type_adata(
-    uint16_t conn_handle, struct ble_att_read_group_type_adata *adata);
-void ble_gattc_rx_read_group_type_complete(uint16_t conn_handle, int rc);
+    uint16_t conn_handle, uint16_t cid,
+    struct ble_att_read_group_type_adata *adata);
+void ble_gattc_rx_read_group_type_complete(uint16_t conn_handle, uint16_t cid,
+                                           int rc);
 void ble_gattc_rx_find_type_value_hinfo(
-    uint16_t conn_handle, struct ble_att_find_type_value_hinfo *hinfo);
-void ble_gattc_rx_find_type_value_complete(uint16_t conn_handle, int status);
-void ble_gattc_rx_write_rsp(uint16_t conn_handle);
-void ble_gattc_rx_prep_write_rsp(uint16_t conn_handle, int status,
-                                 uint16_t handle, uint16_t offset,
+    uint16_t conn_handle, uint16_t cid,
+    struct ble_att_find_type_value_hinfo *hinfo);
+void ble_gattc_rx_find_type_value_complete(uint16_t conn_handle, uint16_t cid,
+                                           int status);
+void ble_gattc_rx_write_rsp(uint16_t conn_handle, uint16_t cid);
+void ble_gattc_rx_prep_write_rsp(uint16_t conn_handle, uint16_t cid,
+                                 int status, uint16_t handle, uint16_t offset,
                                  struct os_mbuf **rxom);
-void ble_gattc_rx_exec_write_rsp(uint16_t conn_handle, int status);
-void ble_gattc_rx_indicate_rsp(uint16_t conn_handle);
-void ble_gattc_rx_find_info_idata(uint16_t conn_handle,
+void ble_gattc_rx_exec_write_rsp(uint16_t conn_handle, uint16_t cid,
+                                 int status);
+void ble_gattc_rx_indicate_rsp(uint16_t conn_handle, uint16_t cid);
+void ble_gattc_rx_find_info_idata(uint16_t conn_handle, uint16_t cid,
                                   struct ble_att_find_info_idata *idata);
-void ble_gattc_rx_find_info_complete(uint16_t conn_handle, int status);
+void ble_gattc_rx_find_info_complete(uint16_t conn_handle, uint16_t cid,
+                                     int status);
 void ble_gattc_connection_txable(uint16_t conn_handle);
 void ble_gattc_connection_broken(uint16_t conn_handle);
+void ble_gattc_bearer_closed(uint16_t conn_handle, uint16_t cid);
 int32_t ble_gattc_timer(void);
 
 int ble_gattc_any_jobs(void);
 int ble_gattc_init(void);
 
+/*** @client cache. */
+#define BLE_GATTC_CACHE_F_VALID                 0x01
+#define BLE_GATTC_CACHE_F_HASH                  0x02
+#define BLE_GATTC_CACHE_F_BUSY                  0x04
+#define BLE_GATTC_CACHE_F_FILL                  0x08
+#define BLE_GATTC_CACHE_F_WAIT                  0x10
+
+/** Discovery cache state of a connection; see ble_gattc_cache.c. */
+struct ble_gattc_cache_conn {
+    /** BLE_GATTC_CACHE_F_[...]. */
+    uint8_t flags;
+
+    /** Peer's Database Hash; valid if BLE_GATTC_CACHE_F_HASH is set. */
+    uint8_t db_hash[BLE_GATT_DB_HASH_SZ];
+
+    /** Value handle of the peer's Service Changed characteristic. */
+    uint16_t svc_changed_handle;
+
+    /** Cursor of the discovery which populates the cache. */
+    uint8_t svc_idx;
+    uint16_t skip_handle;
+
+    ble_gatt_cache_fn *cb;
+    void *cb_arg;
+};
+
+int ble_gattc_cache_key(uint16_t conn_handle,
+                        struct ble_store_key_peer_attr *out_key);
+void ble_gattc_cache_rx_indicate(uint16_t conn_handle, uint16_t attr_handle);
+void ble_gattc_cache_connection_broken(uint16_t conn_handle);
+
+/*** @client database discovery. */
+#define BLE_GATTC_DISC_DB_F_BUSY                0x01
+#define BLE_GATTC_DISC_DB_F_SVCS                0x02
+#define BLE_GATTC_DISC_DB_F_CHRS_PEND           0x04
+#define BLE_GATTC_DISC_DB_F_CHRS                0x08
+#define BLE_GATTC_DISC_DB_F_ABORT               0x10
+
+/** Database discovery state of a connection; see ble_gattc_disc_db.c. */
+struct ble_gattc_disc_db_conn {
+    /** BLE_GATTC_DISC_DB_F_[...]. */
+    uint8_t flags;
+
+    /** Number of discovery procedures in progress. */
+    uint8_t num_procs;
+
+    /** End handles of the services discovered so far, in handle order. */
+    uint16_t svc_ends[MYNEWT_VAL(BLE_GATT_DISC_DB_MAX_SVCS)];
+    uint8_t num_svcs;
+
+    /** Characteristics whose descriptors remain to be discovered. */
+    struct {
+        uint16_t chr_val_handle;
+        uint16_t end_handle;
+    } ranges[MYNEWT_VAL(BLE_GATT_DISC_DB_MAX_CHRS)];
+    uint8_t range_head;
+    uint8_t num_ranges;
+
+    /** Value handle of the last characteristic discovered. */
+    uint16_t chr_val_handle;
+
+    /** Where the next characteristic discovery starts. */
+    uint16_t chr_start_handle;
+
+    int status;
+    uint16_t num_reqs;
+    ble_npl_time_t start_ticks;
+
+    ble_gatt_disc_db_fn *cb;
+    void *cb_arg;
+};
+
+int ble_gattc_disc_db_svcs(uint16_t conn_handle, ble_gatt_disc_svc_fn *cb,
+                           void *cb_arg);
+int ble_gattc_disc_db_chrs(uint16_t conn_handle, uint16_t start_handle,
+                           uint16_t end_handle, ble_gatt_chr_fn *cb,
+                           void *cb_arg);
+int ble_gattc_disc_db_dscs(uint16_t conn_handle, uint16_t start_handle,
+                           uint16_t end_handle, ble_gatt_dsc_fn *cb,
+                           void *cb_arg);
+void ble_gattc_disc_db_req_tx(uint16_t conn_handle);
+
 /*** @server. */
 #define BLE_GATTS_CLT_CFG_F_NOTIFY              0x0001
 #define BLE_GATTS_CLT_CFG_F_INDICATE            0x0002
 #define BLE_GATTS_CLT_CFG_F_MODIFIED            0x0080 /* Internal only. */
 #define BLE_GATTS_CLT_CFG_F_RESERVED            0xfffc
 
+/** Client Supported Features bits of the features built in. */
+#define BLE_GATTS_CL_SUP_FEAT_MASK                                      \
+    ((MYNEWT_VAL(BLE_GATT_ROBUST_CACHING) ?                             \
+      BLE_GATT_CLI_SUP_FEAT_ROBUST_CACHING : 0) |                       \
+     (MYNEWT_VAL(BLE_EATT_CHAN_NUM) > 0 ?                               \
+      BLE_GATT_CLI_SUP_FEAT_EATT : 0) |                                 \
+     (MYNEWT_VAL(BLE_GATT_NOTIFY_MULTI) ?                               \
+      BLE_GATT_CLI_SUP_FEAT_MULT_NTF : 0))
+
+/** The database changed since the peer last learnt about it. */
+#define BLE_GATTS_CONN_F_CHANGE_UNAWARE         0x01
+
+/** The peer has been told; it becomes change-aware on its next request. */
+#define BLE_GATTS_CONN_F_AWARE_PENDING          0x02
+
 #define BLE_GATTS_INC_SVC_LEN_NO_UUID           4
 #define BLE_GATTS_INC_SVC_LEN_UUID              6
 
@@ -179,6 +294,8 @@ void ble_gatts_tx_notifications(void);
 void ble_gatts_bonding_established(uint16_t conn_handle);
 void ble_gatts_bonding_restored(uint16_t conn_handle);
 void ble_gatts_connection_broken(uint16_t conn_handle);
+int ble_gatts_peer_change_aware(uint16_t conn_handle, int is_req,
+                                int is_hash_read);
 void ble_gatts_lcl_svc_foreach(ble_gatt_svc_foreach_fn cb, void *arg);
 int ble_gatts_register_svcs(const struct ble_gatt_svc_def *svcs,
                             ble_gatt_register_fn *register_cb,
@@ -91,12 +91,16 @@
 /** Procedure stalled due to resource exhaustion. */
 #define BLE_GATTC_PROC_F_STALLED                0x01
 
+/** Procedure started on behalf of ble_gattc_disc_db(). */
+#define BLE_GATTC_PROC_F_DISC_DB                0x02
+
 /** Represents an in-progress GATT procedure. */
 struct ble_gattc_proc {
     STAILQ_ENTRY(ble_gattc_proc) next;
 
     uint32_t exp_os_ticks;
     uint16_t conn_handle;
+    uint16_t cid;
     uint8_t op;
     uint8_t flags;
 
@@ -177,7 +181,9 @@ struct ble_gattc_proc {
         struct {
             uint16_t handles[MYNEWT_VAL(BLE_GATT_READ_MAX_ATTRS)];
             uint8_t num_handles;
+            uint8_t variable;
             ble_gatt_attr_fn *cb;
+            ble_gatt_attr_mult_fn *cb_var;
             void *cb_arg;
         } read_mult;
 
@@ -420,6 +426,14 @@ static struct ble_gattc_proc_list ble_gattc_procs;
  */
 static ble_npl_time_t ble_gattc_resume_at;
 
+#if MYNEWT_VAL(BLE_GATT_CACHING)
+/* Discovery procedures waiting to be answered from the discovery cache. */
+static struct ble_gattc_proc_list ble_gattc_cache_procs;
+static struct ble_npl_event ble_gattc_cache_ev;
+
+static int ble_gattc_cache_enqueue(struct ble_gattc_proc *proc);
+#endif
+
 /* Statistics. */
 STATS_SECT_DECL(ble_gattc_stats) ble_gattc_stats;
 STATS_NAME_START(ble_gattc_stats)
@@ -683,6 +697,20 @@ ble_gattc_proc_alloc(void)
     return proc;
 }
 
+/**
+ * Accounts a request sent by the specified proc to the database discovery
+ * that started it, if any.
+ */
+static void
+ble_gattc_proc_req_sent(const struct ble_gattc_proc *proc)
+{
+#if MYNEWT_VAL(BLE_GATT_DISC_DB)
+    if (proc->flags & BLE_GATTC_PROC_F_DISC_DB) {
+        ble_gattc_disc_db_req_tx(proc->conn_handle);
+    }
+#endif
+}
+
 /**
  * Frees the specified proc entry.  No-op if passed a null pointer.
  */
@@ -728,6 +756,100 @@ ble_gattc_proc_insert(struct ble_gattc_proc *proc)
     ble_hs_unlock();
 }
 
+#if MYNEWT_VAL(BLE_EATT_CHAN_NUM) > 0
+/**
+ * Counts the procedures in progress on the specified ATT bearer.  The host
+ * must be locked by the caller.
+ */
+static int
+ble_gattc_bearer_load(uint16_t conn_handle, uint16_t cid)
+{
+    struct ble_gattc_proc *proc;
+    int cnt;
+
+    cnt = 0;
+    STAILQ_FOREACH(proc, &ble_gattc_procs, next) {
+        if (proc->conn_handle == conn_handle && proc->cid == cid) {
+            cnt++;
+        }
+    }
+
+    return cnt;
+}
+#endif
+
+/**
+ * Selects the ATT bearer a new procedure runs on.  Procedures are spread
+ * across the enhanced bearers of the connection, so independent transactions
+ * do not wait for each other; the least loaded bearer is used.  The
+ * unenhanced bearer is used if the connection has no enhanced bearers, if it
+ * is strictly less loaded, or if the procedure has to run on it.
+ *
+ * @param proc                  The procedure to select a bearer for.  Its op
+ *                                  and connection handle must be set.
+ *
+ * @return                      The CID of the selected bearer.
+ */
+static uint16_t
+ble_gattc_bearer_pick(const struct ble_gattc_proc *proc)
+{
+#if MYNEWT_VAL(BLE_EATT_CHAN_NUM) > 0
+    uint16_t cids[MYNEWT_VAL(BLE_EATT_CHAN_NUM)];
+    uint16_t best_cid;
+    int num_cids;
+    int best_cnt;
+    int cnt;
+    int i;
+
+    switch (proc->op) {
+    case BLE_GATT_OP_MTU:
+        /* MTU exchange is only allowed on the unenhanced bearer. */
+    case BLE_GATT_OP_WRITE_LONG:
+    case BLE_GATT_OP_WRITE_RELIABLE:
+        /* The peer's prepare queue is shared by all bearers; keep queued
+         * writes on a single bearer so they cannot interleave.
+         */
+    case BLE_GATT_OP_INDICATE:
+        /* Confirmations are tracked per connection by the server. */
+        return BLE_L2CAP_CID_ATT;
+
+    default:
+        break;
+    }
+
+    num_cids = ble_att_eatt_bearers(proc->conn_handle, cids,
+                                    MYNEWT_VAL(BLE_EATT_CHAN_NUM));
+    if (num_cids == 0) {
+        return BLE_L2CAP_CID_ATT;
+    }
+
+    ble_hs_lock();
+
+    best_cid = cids[0];
+    best_cnt = ble_gattc_bearer_load(proc->conn_handle, cids[0]);
+    for (i = 1; i < num_cids && best_cnt > 0; i++) {
+        cnt = ble_gattc_bearer_load(proc->conn_handle, cids[i]);
+        if (cnt < best_cnt) {
+            best_cid = cids[i];
+            best_cnt = cnt;
+        }
+    }
+
+    if (best_cnt > 0 &&
+        ble_gattc_bearer_load(proc->conn_handle,
+                              BLE_L2CAP_CID_ATT) < best_cnt) {
+
+        best_cid = BLE_L2CAP_CID_ATT;
+    }
+
+    ble_hs_unlock();
+
+    return best_cid;
+#else
+    return BLE_L2CAP_CID_ATT;
+#endif
+}
+
 static void
 ble_gattc_proc_set_exp_timer(struct ble_gattc_proc *proc)
 {
@@ -828,8 +950,12 @@ ble_gattc_tmo_dispatch_get(uint8_t op)
 
 typedef int ble_gattc_match_fn(struct ble_gattc_proc *proc, void *arg);
 
+/** Matches procedures running on any bearer of a connection. */
+#define BLE_GATTC_CID_ANY                       0
+
 struct ble_gattc_criteria_conn_op {
     uint16_t conn_handle;
+    uint16_t cid;
     uint8_t op;
 };
 
@@ -838,6 +964,8 @@ struct ble_gattc_criteria_conn_op {
  *
  * @param proc                  The procedure to test.
  * @param conn_handle           The connection handle to match against.
+ * @param cid                   The ATT bearer to match against, or
+ *                                  BLE_GATTC_CID_ANY to ignore this criterion.
  * @param op                    The op code to match against, or
  *                                  BLE_GATT_OP_NONE to ignore this criterion.
  *
@@ -854,6 +982,10 @@ ble_gattc_proc_matches_conn_op(struct ble_gattc_proc *proc, void *arg)
         return 0;
     }
 
+    if (criteria->cid != proc->cid && criteria->cid != BLE_GATTC_CID_ANY) {
+        return 0;
+    }
+
     if (criteria->op != proc->op && criteria->op != BLE_GATT_OP_NONE) {
         return 0;
     }
@@ -890,6 +1022,7 @@ ble_gattc_proc_matches_expired(struct ble_gattc_proc *proc, void *arg)
 
 struct ble_gattc_criteria_conn_rx_entry {
     uint16_t conn_handle;
+    uint16_t cid;
     const void *rx_entries;
     int num_rx_entries;
     const void *matching_rx_entry;
@@ -908,6 +1041,10 @@ ble_gattc_proc_matches_conn_rx_entry(struct ble_gattc_proc *proc, void *arg)
         return 0;
     }
 
+    if (criteria->cid != proc->cid) {
+        return 0;
+    }
+
     /* Entry matches; indicate corresponding rx entry. */
     criteria->matching_rx_entry = ble_gattc_rx_entry_find(
         proc->op, criteria->rx_entries, criteria->num_rx_entries);
@@ -971,23 +1108,26 @@ ble_gattc_extract_one(ble_gattc_match_fn *cb, void *arg)
 }
 
 static void
-ble_gattc_extract_by_conn_op(uint16_t conn_handle, uint8_t op, int max_procs,
+ble_gattc_extract_by_conn_op(uint16_t conn_handle, uint16_t cid, uint8_t op,
+                             int max_procs,
                              struct ble_gattc_proc_list *dst_list)
 {
     struct ble_gattc_criteria_conn_op criteria;
 
     criteria.conn_handle = conn_handle;
+    criteria.cid = cid;
     criteria.op = op;
 
     ble_gattc_extract(ble_gattc_proc_matches_conn_op, &criteria, max_procs, dst_list);
 }
 
 static struct ble_gattc_proc *
-ble_gattc_extract_first_by_conn_op(uint16_t conn_handle, uint8_t op)
+ble_gattc_extract_first_by_conn_op(uint16_t conn_handle, uint16_t cid,
+                                   uint8_t op)
 {
     struct ble_gattc_proc_list dst_list;
 
-    ble_gattc_extract_by_conn_op(conn_handle, op, 1, &dst_list);
+    ble_gattc_extract_by_conn_op(conn_handle, cid, op, 1, &dst_list);
     return STAILQ_FIRST(&dst_list);
 }
 
@@ -1022,7 +1162,7 @@ ble_gattc_extract_expired(struct ble_gattc_proc_list *dst_list)
 }
 
 static struct ble_gattc_proc *
-ble_gattc_extract_with_rx_entry(uint16_t conn_handle,
+ble_gattc_extract_with_rx_entry(uint16_t conn_handle, uint16_t cid,
                                 const void *rx_entries, int num_rx_entries,
                                 const void **out_rx_entry)
 {
@@ -1030,6 +1170,7 @@ ble_gattc_extract_with_rx_entry(uint16_t conn_handle,
     struct ble_gattc_proc *proc;
 
     criteria.conn_handle = conn_handle;
+    criteria.cid = cid;
     criteria.rx_entries = rx_entries;
     criteria.num_rx_entries = num_rx_entries;
     criteria.matching_rx_entry = NULL;
@@ -1042,11 +1183,12 @@ ble_gattc_extract_with_rx_entry(uint16_t conn_handle,
 }
 
 /**
- * Searches the main proc list for an entry whose connection handle and op code
- * match those specified.  If a matching entry is found, it is removed from the
- * list and returned.
+ * Searches the main proc list for an entry whose connection handle, bearer and
+ * op code match those specified.  If a matching entry is found, it is removed
+ * from the list and returned.
  *
  * @param conn_handle           The connection handle to match against.
+ * @param cid                   The ATT bearer to match against.
  * @param rx_entries            The array of rx entries corresponding to the
  *                                  op code of the incoming response.
  * @param out_rx_entry          On success, the address of the matching rx
@@ -1055,9 +1197,10 @@ ble_gattc_extract_with_rx_entry(uint16_t conn_handle,
  * @return                      The matching proc entry on success;
  *                                  null on failure.
  */
-#define BLE_GATTC_RX_EXTRACT_RX_ENTRY(conn_handle, rx_entries, out_rx_entry)  \
+#define BLE_GATTC_RX_EXTRACT_RX_ENTRY(conn_handle, cid, rx_entries,          \
+                                      out_rx_entry)                           \
     ble_gattc_extract_with_rx_entry(                                          \
-        (conn_handle), (rx_entries),                                          \
+        (conn_handle), (cid), (rx_entries),                                   \
         sizeof (rx_entries) / sizeof (rx_entries)[0],                         \
         (const void **)(out_rx_entry))
 
@@ -1067,7 +1210,8 @@ ble_gattc_extract_with_rx_entry(uint16_t conn_handle,
  * specified status code.
  */
 static void
-ble_gattc_fail_procs(uint16_t conn_handle, uint8_t op, int status)
+ble_gattc_fail_procs(uint16_t conn_handle, uint16_t cid, uint8_t op,
+                     int status)
 {
     struct ble_gattc_proc_list temp_list;
     struct ble_gattc_proc *proc;
@@ -1076,7 +1220,7 @@ ble_gattc_fail_procs(uint16_t conn_handle, uint8_t op, int status)
     /* Remove all procs with the specified conn handle-op-pair and insert them
      * into the temporary list.
      */
-    ble_gattc_extract_by_conn_op(conn_handle, op, 0, &temp_list);
+    ble_gattc_extract_by_conn_op(conn_handle, cid, op, 0, &temp_list);
 
     /* Notify application of failed procedures and free the corresponding proc
      * entries.
@@ -1275,7 +1419,8 @@ ble_gattc_mtu_tx(struct ble_gattc_proc *proc)
     int rc;
 
     ble_hs_lock();
-    rc = ble_att_conn_chan_find(proc->conn_handle, &conn, &chan);
+    rc = ble_att_conn_chan_find(proc->conn_handle, BLE_L2CAP_CID_ATT, &conn,
+                                &chan);
     if (rc == 0) {
         mtu = chan->my_mtu;
     }
@@ -1304,6 +1449,7 @@ ble_gattc_exchange_mtu(uint16_t conn_handle, ble_gatt_mtu_fn *cb, void *cb_arg)
 
     proc->op = BLE_GATT_OP_MTU;
     proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
     proc->mtu.cb = cb;
     proc->mtu.cb_arg = cb_arg;
 
@@ -1380,13 +1526,15 @@ ble_gattc_disc_all_svcs_tx(struct ble_gattc_proc *proc)
 
     ble_gattc_dbg_assert_proc_not_inserted(proc);
 
-    rc = ble_att_clt_tx_read_group_type(proc->conn_handle,
+    rc = ble_att_clt_tx_read_group_type(proc->conn_handle, proc->cid,
                                         proc->disc_all_svcs.prev_handle + 1,
                                         0xffff, &uuid.u);
     if (rc != 0) {
         return rc;
     }
 
+    ble_gattc_proc_req_sent(proc);
+
     return 0;
 }
 
@@ -1507,9 +1655,9 @@ ble_gattc_disc_all_svcs_rx_complete(struct ble_gattc_proc *proc, int status)
     return 0;
 }
 
-int
-ble_gattc_disc_all_svcs(uint16_t conn_handle, ble_gatt_disc_svc_fn *cb,
-                        void *cb_arg)
+static int
+ble_gattc_disc_all_svcs_start(uint16_t conn_handle, uint8_t flags,
+                              ble_gatt_disc_svc_fn *cb, void *cb_arg)
 {
 #if !MYNEWT_VAL(BLE_GATT_DISC_ALL_SVCS)
     return BLE_HS_ENOTSUP;
@@ -1527,13 +1675,21 @@ ble_gattc_disc_all_svcs(uint16_t conn_handle, ble_gatt_disc_svc_fn *cb,
     }
 
     proc->op = BLE_GATT_OP_DISC_ALL_SVCS;
+    proc->flags = flags;
     proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
     proc->disc_all_svcs.prev_handle = 0x0000;
     proc->disc_all_svcs.cb = cb;
     proc->disc_all_svcs.cb_arg = cb_arg;
 
     ble_gattc_log_proc_init("discover all services\n");
 
+#if MYNEWT_VAL(BLE_GATT_CACHING)
+    if (ble_gattc_cache_enqueue(proc) == 0) {
+        return 0;
+    }
+#endif
+
     rc = ble_gattc_disc_all_svcs_tx(proc);
     if (rc != 0) {
         goto done;
@@ -1548,6 +1704,24 @@ done:
     return rc;
 }
 
+int
+ble_gattc_disc_all_svcs(uint16_t conn_handle, ble_gatt_disc_svc_fn *cb,
+                        void *cb_arg)
+{
+    return ble_gattc_disc_all_svcs_start(conn_handle, 0, cb, cb_arg);
+}
+
+#if MYNEWT_VAL(BLE_GATT_DISC_DB)
+int
+ble_gattc_disc_db_svcs(uint16_t conn_handle, ble_gatt_disc_svc_fn *cb,
+                       void *cb_arg)
+{
+    return ble_gattc_disc_all_svcs_start(conn_handle,
+                                         BLE_GATTC_PROC_F_DISC_DB,
+                                         cb, cb_arg);
+}
+#endif
+
 /*****************************************************************************
  * $discover service by uuid                                                 *
  *****************************************************************************/
@@ -1606,7 +1780,7 @@ ble_gattc_disc_svc_uuid_tx(struct ble_gattc_proc *proc)
     ble_gattc_dbg_assert_proc_not_inserted(proc);
 
     ble_uuid_flat(&proc->disc_svc_uuid.service_uuid.u, val);
-    rc = ble_att_clt_tx_find_type_value(proc->conn_handle,
+    rc = ble_att_clt_tx_find_type_value(proc->conn_handle, proc->cid,
                                         proc->disc_svc_uuid.prev_handle + 1,
                                         0xffff, BLE_ATT_UUID_PRIMARY_SERVICE,
                                         val,
@@ -1741,6 +1915,7 @@ ble_gattc_disc_svc_by_uuid(uint16_t conn_handle, const ble_uuid_t *uuid,
 
     proc->op = BLE_GATT_OP_DISC_SVC_UUID;
     proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
     ble_uuid_to_any(uuid, &proc->disc_svc_uuid.service_uuid);
     proc->disc_svc_uuid.prev_handle = 0x0000;
     proc->disc_svc_uuid.cb = cb;
@@ -1748,6 +1923,12 @@ ble_gattc_disc_svc_by_uuid(uint16_t conn_handle, const ble_uuid_t *uuid,
 
     ble_gattc_log_disc_svc_uuid(proc);
 
+#if MYNEWT_VAL(BLE_GATT_CACHING)
+    if (ble_gattc_cache_enqueue(proc) == 0) {
+        return 0;
+    }
+#endif
+
     rc = ble_gattc_disc_svc_uuid_tx(proc);
     if (rc != 0) {
         goto done;
@@ -1821,7 +2002,7 @@ ble_gattc_find_inc_svcs_tx(struct ble_gattc_proc *proc)
 
     if (proc->find_inc_svcs.cur_start == 0) {
         /* Find the next included service. */
-        rc = ble_att_clt_tx_read_type(proc->conn_handle,
+        rc = ble_att_clt_tx_read_type(proc->conn_handle, proc->cid,
                                       proc->find_inc_svcs.prev_handle + 1,
                                       proc->find_inc_svcs.end_handle, &uuid.u);
         if (rc != 0) {
@@ -1829,7 +2010,7 @@ ble_gattc_find_inc_svcs_tx(struct ble_gattc_proc *proc)
         }
     } else {
         /* Read the UUID of the previously found service. */
-        rc = ble_att_clt_tx_read(proc->conn_handle,
+        rc = ble_att_clt_tx_read(proc->conn_handle, proc->cid,
                                  proc->find_inc_svcs.cur_start);
         if (rc != 0) {
             return rc;
@@ -2057,6 +2238,7 @@ ble_gattc_find_inc_svcs(uint16_t conn_handle, uint16_t start_handle,
 
     proc->op = BLE_GATT_OP_FIND_INC_SVCS;
     proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
     proc->find_inc_svcs.prev_handle = start_handle - 1;
     proc->find_inc_svcs.end_handle = end_handle;
     proc->find_inc_svcs.cb = cb;
@@ -2135,13 +2317,15 @@ ble_gattc_disc_all_chrs_tx(struct ble_gattc_proc *proc)
 
     ble_gattc_dbg_assert_proc_not_inserted(proc);
 
-    rc = ble_att_clt_tx_read_type(proc->conn_handle,
+    rc = ble_att_clt_tx_read_type(proc->conn_handle, proc->cid,
                                   proc->disc_all_chrs.prev_handle + 1,
                                   proc->disc_all_chrs.end_handle, &uuid.u);
     if (rc != 0) {
         return rc;
     }
 
+    ble_gattc_proc_req_sent(proc);
+
     return 0;
 }
 
@@ -2263,10 +2447,10 @@ ble_gattc_disc_all_chrs_rx_complete(struct ble_gattc_proc *proc, int status)
     return 0;
 }
 
-int
-ble_gattc_disc_all_chrs(uint16_t conn_handle, uint16_t start_handle,
-                        uint16_t end_handle, ble_gatt_chr_fn *cb,
-                        void *cb_arg)
+static int
+ble_gattc_disc_all_chrs_start(uint16_t conn_handle, uint8_t flags,
+                              uint16_t start_handle, uint16_t end_handle,
+                              ble_gatt_chr_fn *cb, void *cb_arg)
 {
 #if !MYNEWT_VAL(BLE_GATT_DISC_ALL_CHRS)
     return BLE_HS_ENOTSUP;
@@ -2284,7 +2468,9 @@ ble_gattc_disc_all_chrs(uint16_t conn_handle, uint16_t start_handle,
     }
 
     proc->op = BLE_GATT_OP_DISC_ALL_CHRS;
+    proc->flags = flags;
     proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
     proc->disc_all_chrs.prev_handle = start_handle - 1;
     proc->disc_all_chrs.end_handle = end_handle;
     proc->disc_all_chrs.cb = cb;
@@ -2292,6 +2478,12 @@ ble_gattc_disc_all_chrs(uint16_t conn_handle, uint16_t start_handle,
 
     ble_gattc_log_disc_all_chrs(proc);
 
+#if MYNEWT_VAL(BLE_GATT_CACHING)
+    if (ble_gattc_cache_enqueue(proc) == 0) {
+        return 0;
+    }
+#endif
+
     rc = ble_gattc_disc_all_chrs_tx(proc);
     if (rc != 0) {
         goto done;
@@ -2306,6 +2498,28 @@ done:
     return rc;
 }
 
+int
+ble_gattc_disc_all_chrs(uint16_t conn_handle, uint16_t start_handle,
+                        uint16_t end_handle, ble_gatt_chr_fn *cb,
+                        void *cb_arg)
+{
+    return ble_gattc_disc_all_chrs_start(conn_handle, 0, start_handle,
+                                         end_handle, cb, cb_arg);
+}
+
+#if MYNEWT_VAL(BLE_GATT_DISC_DB)
+int
+ble_gattc_disc_db_chrs(uint16_t conn_handle, uint16_t start_handle,
+                       uint16_t end_handle, ble_gatt_chr_fn *cb,
+                       void *cb_arg)
+{
+    return ble_gattc_disc_all_chrs_start(conn_handle,
+                                         BLE_GATTC_PROC_F_DISC_DB,
+                                         start_handle, end_handle,
+                                         cb, cb_arg);
+}
+#endif
+
 /*****************************************************************************
  * $discover characteristic by uuid                                          *
  *****************************************************************************/
@@ -2363,7 +2577,7 @@ ble_gattc_disc_chr_uuid_tx(struct ble_gattc_proc *proc)
 
     ble_gattc_dbg_assert_proc_not_inserted(proc);
 
-    rc = ble_att_clt_tx_read_type(proc->conn_handle,
+    rc = ble_att_clt_tx_read_type(proc->conn_handle, proc->cid,
                                   proc->disc_chr_uuid.prev_handle + 1,
                                   proc->disc_chr_uuid.end_handle, &uuid.u);
     if (rc != 0) {
@@ -2524,6 +2738,7 @@ ble_gattc_disc_chrs_by_uuid(uint16_t conn_handle, uint16_t start_handle,
 
     proc->op = BLE_GATT_OP_DISC_CHR_UUID;
     proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
     ble_uuid_to_any(uuid, &proc->disc_chr_uuid.chr_uuid);
     proc->disc_chr_uuid.prev_handle = start_handle - 1;
     proc->disc_chr_uuid.end_handle = end_handle;
@@ -2532,6 +2747,12 @@ ble_gattc_disc_chrs_by_uuid(uint16_t conn_handle, uint16_t start_handle,
 
     ble_gattc_log_disc_chr_uuid(proc);
 
+#if MYNEWT_VAL(BLE_GATT_CACHING)
+    if (ble_gattc_cache_enqueue(proc) == 0) {
+        return 0;
+    }
+#endif
+
     rc = ble_gattc_disc_chr_uuid_tx(proc);
     if (rc != 0) {
         goto done;
@@ -2602,13 +2823,15 @@ ble_gattc_disc_all_dscs_tx(struct ble_gattc_proc *proc)
 
     ble_gattc_dbg_assert_proc_not_inserted(proc);
 
-    rc = ble_att_clt_tx_find_info(proc->conn_handle,
+    rc = ble_att_clt_tx_find_info(proc->conn_handle, proc->cid,
                                   proc->disc_all_dscs.prev_handle + 1,
                                   proc->disc_all_dscs.end_handle);
     if (rc != 0) {
         return rc;
     }
 
+    ble_gattc_proc_req_sent(proc);
+
     return 0;
 }
 
@@ -2712,10 +2935,10 @@ ble_gattc_disc_all_dscs_rx_complete(struct ble_gattc_proc *proc, int status)
     return 0;
 }
 
-int
-ble_gattc_disc_all_dscs(uint16_t conn_handle, uint16_t start_handle,
-                        uint16_t end_handle,
-                        ble_gatt_dsc_fn *cb, void *cb_arg)
+static int
+ble_gattc_disc_all_dscs_start(uint16_t conn_handle, uint8_t flags,
+                              uint16_t start_handle, uint16_t end_handle,
+                              ble_gatt_dsc_fn *cb, void *cb_arg)
 {
 #if !MYNEWT_VAL(BLE_GATT_DISC_ALL_DSCS)
     return BLE_HS_ENOTSUP;
@@ -2733,7 +2956,9 @@ ble_gattc_disc_all_dscs(uint16_t conn_handle, uint16_t start_handle,
     }
 
     proc->op = BLE_GATT_OP_DISC_ALL_DSCS;
+    proc->flags = flags;
     proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
     proc->disc_all_dscs.chr_val_handle = start_handle;
     proc->disc_all_dscs.prev_handle = start_handle;
     proc->disc_all_dscs.end_handle = end_handle;
@@ -2742,6 +2967,12 @@ ble_gattc_disc_all_dscs(uint16_t conn_handle, uint16_t start_handle,
 
     ble_gattc_log_disc_all_dscs(proc);
 
+#if MYNEWT_VAL(BLE_GATT_CACHING)
+    if (ble_gattc_cache_enqueue(proc) == 0) {
+        return 0;
+    }
+#endif
+
     rc = ble_gattc_disc_all_dscs_tx(proc);
     if (rc != 0) {
         goto done;
@@ -2756,6 +2987,28 @@ done:
     return rc;
 }
 
+int
+ble_gattc_disc_all_dscs(uint16_t conn_handle, uint16_t start_handle,
+                        uint16_t end_handle,
+                        ble_gatt_dsc_fn *cb, void *cb_arg)
+{
+    return ble_gattc_disc_all_dscs_start(conn_handle, 0, start_handle,
+                                         end_handle, cb, cb_arg);
+}
+
+#if MYNEWT_VAL(BLE_GATT_DISC_DB)
+int
+ble_gattc_disc_db_dscs(uint16_t conn_handle, uint16_t start_handle,
+                       uint16_t end_handle, ble_gatt_dsc_fn *cb,
+                       void *cb_arg)
+{
+    return ble_gattc_disc_all_dscs_start(conn_handle,
+                                         BLE_GATTC_PROC_F_DISC_DB,
+                                         start_handle, end_handle,
+                                         cb, cb_arg);
+}
+#endif
+
 /*****************************************************************************
  * $read                                                                     *
  *****************************************************************************/
@@ -2843,7 +3096,7 @@ ble_gattc_read_tx(struct ble_gattc_proc *proc)
 {
     int rc;
 
-    rc = ble_att_clt_tx_read(proc->conn_handle, proc->read.handle);
+    rc = ble_att_clt_tx_read(proc->conn_handle, proc->cid, proc->read.handle);
     if (rc != 0) {
         return rc;
     }
@@ -2872,6 +3125,7 @@ ble_gattc_read(uint16_t conn_handle, uint16_t attr_handle,
 
     proc->op = BLE_GATT_OP_READ;
     proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
     proc->read.handle = attr_handle;
     proc->read.cb = cb;
     proc->read.cb_arg = cb_arg;
@@ -3006,7 +3260,7 @@ ble_gattc_read_uuid_rx_complete(struct ble_gattc_proc *proc, int status)
 static int
 ble_gattc_read_uuid_tx(struct ble_gattc_proc *proc)
 {
-    return ble_att_clt_tx_read_type(proc->conn_handle,
+    return ble_att_clt_tx_read_type(proc->conn_handle, proc->cid,
                                     proc->read_uuid.start_handle,
                                     proc->read_uuid.end_handle,
                                     &proc->read_uuid.chr_uuid.u);
@@ -3034,6 +3288,7 @@ ble_gattc_read_by_uuid(uint16_t conn_handle, uint16_t start_handle,
 
     proc->op = BLE_GATT_OP_READ_UUID;
     proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
     ble_uuid_to_any(uuid, &proc->read_uuid.chr_uuid);
     proc->read_uuid.start_handle = start_handle;
     proc->read_uuid.end_handle = end_handle;
@@ -3111,12 +3366,13 @@ ble_gattc_read_long_tx(struct ble_gattc_proc *proc)
     ble_gattc_dbg_assert_proc_not_inserted(proc);
 
     if (proc->read_long.offset == 0) {
-        rc = ble_att_clt_tx_read(proc->conn_handle, proc->read_long.handle);
+        rc = ble_att_clt_tx_read(proc->conn_handle, proc->cid,
+                                 proc->read_long.handle);
         if (rc != 0) {
             return rc;
         }
     } else {
-        rc = ble_att_clt_tx_read_blob(proc->conn_handle,
+        rc = ble_att_clt_tx_read_blob(proc->conn_handle, proc->cid,
                                       proc->read_long.handle,
                                       proc->read_long.offset);
         if (rc != 0) {
@@ -3230,6 +3486,7 @@ ble_gattc_read_long(uint16_t conn_handle, uint16_t handle, uint16_t offset,
 
     proc->op = BLE_GATT_OP_READ_LONG;
     proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
     proc->read_long.handle = handle;
     proc->read_long.offset = offset;
     proc->read_long.cb = cb;
@@ -3262,6 +3519,66 @@ done:
  * @return                      The return code of the callback (or 0 if there
  *                                  is no callback).
  */
+static int
+ble_gattc_read_mult_var_cb(struct ble_gattc_proc *proc, int status,
+                           uint16_t att_handle, struct os_mbuf **om)
+{
+    struct ble_gatt_attr attrs[MYNEWT_VAL(BLE_GATT_READ_MAX_ATTRS)];
+    struct ble_gatt_attr *attr;
+    uint8_t len_buf[2];
+    uint16_t len;
+    int num_attrs;
+    int rc;
+    int i;
+
+    num_attrs = 0;
+
+    /* Split the Length Value Tuple List into the individual values.  The
+     * last value may have been truncated to fit the MTU.
+     */
+    while (status == 0 && num_attrs < proc->read_mult.num_handles &&
+           os_mbuf_copydata(*om, 0, sizeof len_buf, len_buf) == 0) {
+
+        os_mbuf_adj(*om, sizeof len_buf);
+        len = min(get_le16(len_buf), OS_MBUF_PKTLEN(*om));
+
+        attr = attrs + num_attrs++;
+        attr->handle = proc->read_mult.handles[num_attrs - 1];
+        attr->offset = 0;
+        attr->om = ble_hs_mbuf_bare_pkt();
+        if (attr->om == NULL ||
+            os_mbuf_appendfrom(attr->om, *om, 0, len) != 0) {
+
+            status = BLE_HS_ENOMEM;
+        }
+        os_mbuf_adj(*om, len);
+    }
+
+    if (status != 0) {
+        STATS_INC(ble_gattc_stats, read_mult_fail);
+
+        for (i = 0; i < num_attrs; i++) {
+            os_mbuf_free_chain(attrs[i].om);
+        }
+        num_attrs = 0;
+    }
+
+    if (proc->read_mult.cb_var == NULL) {
+        rc = 0;
+    } else {
+        rc = proc->read_mult.cb_var(proc->conn_handle,
+                                    ble_gattc_error(status, att_handle),
+                                    attrs, num_attrs,
+                                    proc->read_mult.cb_arg);
+    }
+
+    for (i = 0; i < num_attrs; i++) {
+        os_mbuf_free_chain(attrs[i].om);
+    }
+
+    return rc;
+}
+
 static int
 ble_gattc_read_mult_cb(struct ble_gattc_proc *proc, int status,
                        uint16_t att_handle, struct os_mbuf **om)
@@ -3273,6 +3590,10 @@ ble_gattc_read_mult_cb(struct ble_gattc_proc *proc, int status,
     BLE_HS_DBG_ASSERT(om != NULL || status != 0);
     ble_gattc_dbg_assert_proc_not_inserted(proc);
 
+    if (proc->read_mult.variable) {
+        return ble_gattc_read_mult_var_cb(proc, status, att_handle, om);
+    }
+
     if (status != 0 && status != BLE_HS_EDONE) {
         STATS_INC(ble_gattc_stats, read_mult_fail);
     }
@@ -3327,8 +3648,15 @@ ble_gattc_read_mult_tx(struct ble_gattc_proc *proc)
 {
     int rc;
 
-    rc = ble_att_clt_tx_read_mult(proc->conn_handle, proc->read_mult.handles,
-                                  proc->read_mult.num_handles);
+    if (proc->read_mult.variable) {
+        rc = ble_att_clt_tx_read_mult_var(proc->conn_handle, proc->cid,
+                                          proc->read_mult.handles,
+                                          proc->read_mult.num_handles);
+    } else {
+        rc = ble_att_clt_tx_read_mult(proc->conn_handle, proc->cid,
+                                      proc->read_mult.handles,
+                                      proc->read_mult.num_handles);
+    }
     if (rc != 0) {
         return rc;
     }
@@ -3366,6 +3694,7 @@ ble_gattc_read_mult(uint16_t conn_handle, const uint16_t *handles,
 
     proc->op = BLE_GATT_OP_READ_MULT;
     proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
     memcpy(proc->read_mult.handles, handles, num_handles * sizeof *handles);
     proc->read_mult.num_handles = num_handles;
     proc->read_mult.cb = cb;
@@ -3386,6 +3715,59 @@ done:
     return rc;
 }
 
+int
+ble_gattc_read_mult_var(uint16_t conn_handle, const uint16_t *handles,
+                        uint8_t num_handles, ble_gatt_attr_mult_fn *cb,
+                        void *cb_arg)
+{
+#if !MYNEWT_VAL(BLE_GATT_READ_MULT_VAR)
+    return BLE_HS_ENOTSUP;
+#endif
+
+    struct ble_gattc_proc *proc;
+    int rc;
+
+    proc = NULL;
+
+    STATS_INC(ble_gattc_stats, read_mult);
+
+    if (num_handles < 2 ||
+        num_handles > MYNEWT_VAL(BLE_GATT_READ_MAX_ATTRS)) {
+
+        rc = BLE_HS_EINVAL;
+        goto done;
+    }
+
+    proc = ble_gattc_proc_alloc();
+    if (proc == NULL) {
+        rc = BLE_HS_ENOMEM;
+        goto done;
+    }
+
+    proc->op = BLE_GATT_OP_READ_MULT;
+    proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
+    memcpy(proc->read_mult.handles, handles, num_handles * sizeof *handles);
+    proc->read_mult.num_handles = num_handles;
+    proc->read_mult.variable = 1;
+    proc->read_mult.cb_var = cb;
+    proc->read_mult.cb_arg = cb_arg;
+
+    ble_gattc_log_read_mult(handles, num_handles);
+    rc = ble_gattc_read_mult_tx(proc);
+    if (rc != 0) {
+        goto done;
+    }
+
+done:
+    if (rc != 0) {
+        STATS_INC(ble_gattc_stats, read_mult_fail);
+    }
+
+    ble_gattc_process_status(proc, rc);
+    return rc;
+}
+
 /*****************************************************************************
  * $write no response                                                        *
  *****************************************************************************/
@@ -3404,7 +3786,8 @@ ble_gattc_write_no_rsp(uint16_t conn_handle, uint16_t attr_handle,
 
     ble_gattc_log_write(attr_handle, OS_MBUF_PKTLEN(txom), 0);
 
-    rc = ble_att_clt_tx_write_cmd(conn_handle, attr_handle, txom);
+    rc = ble_att_clt_tx_write_cmd(conn_handle, BLE_L2CAP_CID_ATT, attr_handle,
+                                  txom);
     if (rc != 0) {
         STATS_INC(ble_gattc_stats, write);
     }
@@ -3512,13 +3895,14 @@ ble_gattc_write(uint16_t conn_handle, uint16_t attr_handle,
 
     proc->op = BLE_GATT_OP_WRITE;
     proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
     proc->write.att_handle = attr_handle;
     proc->write.cb = cb;
     proc->write.cb_arg = cb_arg;
 
     ble_gattc_log_write(attr_handle, OS_MBUF_PKTLEN(txom), 1);
 
-    rc = ble_att_clt_tx_write_req(conn_handle, attr_handle, txom);
+    rc = ble_att_clt_tx_write_req(conn_handle, proc->cid, attr_handle, txom);
     txom = NULL;
     if (rc != 0) {
         goto done;
@@ -3630,7 +4014,7 @@ ble_gattc_write_long_tx(struct ble_gattc_proc *proc)
                         proc->write_long.attr.offset);
 
     if (write_len <= 0) {
-        rc = ble_att_clt_tx_exec_write(proc->conn_handle,
+        rc = ble_att_clt_tx_exec_write(proc->conn_handle, proc->cid,
                                        BLE_ATT_EXEC_WRITE_F_EXECUTE);
         goto done;
     }
@@ -3650,7 +4034,7 @@ ble_gattc_write_long_tx(struct ble_gattc_proc *proc)
         goto done;
     }
 
-    rc = ble_att_clt_tx_prep_write(proc->conn_handle,
+    rc = ble_att_clt_tx_prep_write(proc->conn_handle, proc->cid,
                                    proc->write_long.attr.handle,
                                    proc->write_long.attr.offset, om);
     om = NULL;
@@ -3696,7 +4080,7 @@ ble_gattc_write_long_err(struct ble_gattc_proc *proc, int status,
         proc->write_long.attr.offset <
             OS_MBUF_PKTLEN(proc->write_long.attr.om)) {
 
-        ble_att_clt_tx_exec_write(proc->conn_handle,
+        ble_att_clt_tx_exec_write(proc->conn_handle, proc->cid,
                                   BLE_ATT_EXEC_WRITE_F_CANCEL);
     }
 
@@ -3822,6 +4206,7 @@ ble_gattc_write_long(uint16_t conn_handle, uint16_t attr_handle,
 
     proc->op = BLE_GATT_OP_WRITE_LONG;
     proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
     proc->write_long.attr.handle = attr_handle;
     proc->write_long.attr.offset = offset;
     proc->write_long.attr.om = txom;
@@ -3916,7 +4301,7 @@ ble_gattc_write_reliable_tx(struct ble_gattc_proc *proc)
     attr_idx = proc->write_reliable.cur_attr;
 
     if (attr_idx >= proc->write_reliable.num_attrs) {
-        rc = ble_att_clt_tx_exec_write(proc->conn_handle,
+        rc = ble_att_clt_tx_exec_write(proc->conn_handle, proc->cid,
                                        BLE_ATT_EXEC_WRITE_F_EXECUTE);
         goto done;
     }
@@ -3946,7 +4331,7 @@ ble_gattc_write_reliable_tx(struct ble_gattc_proc *proc)
         goto done;
     }
 
-    rc = ble_att_clt_tx_prep_write(proc->conn_handle, attr->handle,
+    rc = ble_att_clt_tx_prep_write(proc->conn_handle, proc->cid, attr->handle,
                                    attr->offset, om);
     om = NULL;
     if (rc != 0) {
@@ -3990,7 +4375,7 @@ ble_gattc_write_reliable_err(struct ble_gattc_proc *proc, int status,
      */
     if (proc->write_reliable.cur_attr < proc->write_reliable.num_attrs) {
 
-        ble_att_clt_tx_exec_write(proc->conn_handle,
+        ble_att_clt_tx_exec_write(proc->conn_handle, proc->cid,
                                   BLE_ATT_EXEC_WRITE_F_CANCEL);
     }
 }
@@ -4105,6 +4490,7 @@ ble_gattc_write_reliable(uint16_t conn_handle,
 
     proc->op = BLE_GATT_OP_WRITE_RELIABLE;
     proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
     proc->write_reliable.num_attrs = num_attrs;
     proc->write_reliable.cur_attr = 0;
     proc->write_reliable.cb = cb;
@@ -4175,7 +4561,8 @@ ble_gattc_notify_custom(uint16_t conn_handle, uint16_t chr_val_handle,
         }
     }
 
-    rc = ble_att_clt_tx_notify(conn_handle, chr_val_handle, txom);
+    rc = ble_att_clt_tx_notify(conn_handle, BLE_L2CAP_CID_ATT, chr_val_handle,
+                               txom);
     txom = NULL;
     if (rc != 0) {
         goto done;
@@ -4208,6 +4595,266 @@ ble_gattc_notify(uint16_t conn_handle, uint16_t chr_val_handle)
     return rc;
 }
 
+int
+ble_gattc_notify_multi_custom(const uint16_t *conn_handles, int num_conns,
+                              uint16_t chr_val_handle, struct os_mbuf *txom)
+{
+#if !MYNEWT_VAL(BLE_GATT_NOTIFY)
+    return BLE_HS_ENOTSUP;
+#endif
+
+    struct os_mbuf *om;
+    int read_rc;
+    int status;
+    int rc;
+    int i;
+
+    read_rc = 0;
+    status = 0;
+
+    if (txom == NULL && num_conns > 0) {
+        /* No custom attribute data; read the value from the specified
+         * attribute.  The value is read once for all recipients; only the
+         * access callback is deduplicated, each recipient still gets a copy.
+         */
+        txom = ble_hs_mbuf_att_pkt();
+        if (txom == NULL) {
+            read_rc = BLE_HS_ENOMEM;
+        } else {
+            rc = ble_att_svr_read_handle(BLE_HS_CONN_HANDLE_NONE,
+                                         chr_val_handle, 0, txom, NULL);
+            if (rc != 0) {
+                /* Fatal error; application disallowed attribute read. */
+                read_rc = BLE_HS_EAPP;
+            }
+        }
+    }
+
+    for (i = 0; i < num_conns; i++) {
+        STATS_INC(ble_gattc_stats, notify);
+        ble_gattc_log_notify(chr_val_handle);
+
+        if (read_rc != 0) {
+            /* There is no value to send to anyone. */
+            rc = read_rc;
+        } else {
+            /* The last recipient takes ownership of the original buffer; the
+             * others get a copy which retains the reserved header space.  The
+             * copy cannot be avoided: mbufs are not reference counted and
+             * each connection prepends its own ATT and L2CAP headers.
+             */
+            if (i == num_conns - 1) {
+                om = txom;
+                txom = NULL;
+            } else {
+                om = os_mbuf_dup(txom);
+            }
+
+            if (om == NULL) {
+                rc = BLE_HS_ENOMEM;
+            } else {
+                rc = ble_att_clt_tx_notify(conn_handles[i], BLE_L2CAP_CID_ATT,
+                                           chr_val_handle, om);
+            }
+        }
+
+        if (rc != 0) {
+            STATS_INC(ble_gattc_stats, notify_fail);
+            if (status == 0) {
+                status = rc;
+            }
+        }
+
+        /* Tell the application that a notification transmission was
+         * attempted.
+         */
+        ble_gap_notify_tx_event(rc, conn_handles[i], chr_val_handle, 0);
+    }
+
+    os_mbuf_free_chain(txom);
+
+    return status;
+}
+
+int
+ble_gattc_notify_multi(const uint16_t *conn_handles, int num_conns,
+                       uint16_t chr_val_handle)
+{
+#if !MYNEWT_VAL(BLE_GATT_NOTIFY)
+    return BLE_HS_ENOTSUP;
+#endif
+
+    int rc;
+
+    rc = ble_gattc_notify_multi_custom(conn_handles, num_conns,
+                                       chr_val_handle, NULL);
+
+    return rc;
+}
+
+/**
+ * Sends the given notifications in a single PDU: a regular notification if
+ * there is only one, a multiple handle value notification otherwise.  The
+ * values are consumed.
+ */
+static int
+ble_gattc_notify_handles_tx(uint16_t conn_handle,
+                            struct ble_gatt_notif *notifs, int num_notifs)
+{
+    struct ble_att_notify_multi_tuple tuple;
+    struct os_mbuf *txom;
+    int rc;
+    int i;
+
+    if (num_notifs == 1) {
+        rc = ble_att_clt_tx_notify(conn_handle, BLE_L2CAP_CID_ATT,
+                                   notifs[0].handle, notifs[0].value);
+        notifs[0].value = NULL;
+        goto done;
+    }
+
+    txom = ble_hs_mbuf_bare_pkt();
+    if (txom == NULL) {
+        rc = BLE_HS_ENOMEM;
+        goto done;
+    }
+
+    for (i = 0; i < num_notifs; i++) {
+        tuple.handle = htole16(notifs[i].handle);
+        tuple.len = htole16(OS_MBUF_PKTLEN(notifs[i].value));
+
+        rc = os_mbuf_append(txom, &tuple, sizeof tuple);
+        if (rc != 0) {
+            os_mbuf_free_chain(txom);
+            rc = BLE_HS_ENOMEM;
+            goto done;
+        }
+
+        os_mbuf_concat(txom, notifs[i].value);
+        notifs[i].value = NULL;
+    }
+
+    rc = ble_att_clt_tx_notify_multi(conn_handle, BLE_L2CAP_CID_ATT, txom);
+
+done:
+    for (i = 0; i < num_notifs; i++) {
+        os_mbuf_free_chain(notifs[i].value);
+        notifs[i].value = NULL;
+
+        if (rc != 0) {
+            STATS_INC(ble_gattc_stats, notify_fail);
+        }
+
+        /* Tell the application that a notification transmission was
+         * attempted.
+         */
+        ble_gap_notify_tx_event(rc, conn_handle, notifs[i].handle, 0);
+    }
+
+    return rc;
+}
+
+int
+ble_gattc_notify_handles(uint16_t conn_handle,
+                         struct ble_gatt_notif *notifs, int num_notifs)
+{
+#if !MYNEWT_VAL(BLE_GATT_NOTIFY)
+    return BLE_HS_ENOTSUP;
+#endif
+
+    uint8_t cl_sup_feat[BLE_GATT_CHR_CLI_SUP_FEAT_SZ];
+    uint16_t pdu_len;
+    uint16_t mtu;
+    int status;
+    int tx_rc;
+    int first;
+    int multi;
+    int rc;
+    int i;
+
+    status = 0;
+
+    /* Multiple handle value notifications may only be sent to clients which
+     * asked for them.
+     */
+    multi = 0;
+    if (MYNEWT_VAL(BLE_GATT_NOTIFY_MULTI) &&
+        ble_gatts_peer_cl_sup_feat_get(conn_handle, cl_sup_feat,
+                                       sizeof cl_sup_feat) == 0) {
+
+        multi = cl_sup_feat[0] & BLE_GATT_CLI_SUP_FEAT_MULT_NTF;
+    }
+    mtu = ble_att_mtu(conn_handle);
+
+    /* notifs[first..i-1] is the batch waiting to be sent; pdu_len is the size
+     * of the PDU carrying it.
+     */
+    first = 0;
+    pdu_len = BLE_ATT_NOTIFY_MULTI_REQ_BASE_SZ;
+
+    for (i = 0; i < num_notifs; i++) {
+        STATS_INC(ble_gattc_stats, notify);
+        ble_gattc_log_notify(notifs[i].handle);
+
+        rc = 0;
+        if (notifs[i].value == NULL) {
+            /* No custom attribute data; read the value from the specified
+             * attribute.
+             */
+            notifs[i].value = ble_hs_mbuf_att_pkt();
+            if (notifs[i].value == NULL) {
+                rc = BLE_HS_ENOMEM;
+            } else if (ble_att_svr_read_handle(BLE_HS_CONN_HANDLE_NONE,
+                                               notifs[i].handle, 0,
+                                               notifs[i].value, NULL) != 0) {
+                /* Fatal error; application disallowed attribute read. */
+                rc = BLE_HS_EAPP;
+            }
+        }
+
+        /* Flush the batch if this value does not fit into it. */
+        if (i > first &&
+            (rc != 0 || !multi ||
+             pdu_len + sizeof(struct ble_att_notify_multi_tuple) +
+             OS_MBUF_PKTLEN(notifs[i].value) > mtu)) {
+
+            tx_rc = ble_gattc_notify_handles_tx(conn_handle, notifs + first,
+                                                i - first);
+            if (tx_rc != 0 && status == 0) {
+                status = tx_rc;
+            }
+            first = i;
+            pdu_len = BLE_ATT_NOTIFY_MULTI_REQ_BASE_SZ;
+        }
+
+        if (rc != 0) {
+            os_mbuf_free_chain(notifs[i].value);
+            notifs[i].value = NULL;
+
+            STATS_INC(ble_gattc_stats, notify_fail);
+            ble_gap_notify_tx_event(rc, conn_handle, notifs[i].handle, 0);
+            if (status == 0) {
+                status = rc;
+            }
+            first = i + 1;
+            continue;
+        }
+
+        pdu_len += sizeof(struct ble_att_notify_multi_tuple) +
+                   OS_MBUF_PKTLEN(notifs[i].value);
+    }
+
+    if (first < num_notifs) {
+        rc = ble_gattc_notify_handles_tx(conn_handle, notifs + first,
+                                         num_notifs - first);
+        if (rc != 0 && status == 0) {
+            status = rc;
+        }
+    }
+
+    return status;
+}
+
 /*****************************************************************************
  * $indicate                                                                 *
  *****************************************************************************/
@@ -4284,7 +4931,8 @@ ble_gattc_indicate_rx_rsp(struct ble_gattc_proc *proc)
 void
 ble_gatts_indicate_fail_notconn(uint16_t conn_handle)
 {
-    ble_gattc_fail_procs(conn_handle, BLE_GATT_OP_INDICATE, BLE_HS_ENOTCONN);
+    ble_gattc_fail_procs(conn_handle, BLE_GATTC_CID_ANY, BLE_GATT_OP_INDICATE,
+                         BLE_HS_ENOTCONN);
 }
 
 int
@@ -4309,6 +4957,7 @@ ble_gattc_indicate_custom(uint16_t conn_handle, uint16_t chr_val_handle,
 
     proc->op = BLE_GATT_OP_INDICATE;
     proc->conn_handle = conn_handle;
+    proc->cid = ble_gattc_bearer_pick(proc);
     proc->indicate.chr_val_handle = chr_val_handle;
 
     ble_gattc_log_indicate(chr_val_handle);
@@ -4333,7 +4982,8 @@ ble_gattc_indicate_custom(uint16_t conn_handle, uint16_t chr_val_handle,
         }
     }
 
-    rc = ble_att_clt_tx_indicate(conn_handle, chr_val_handle, txom);
+    rc = ble_att_clt_tx_indicate(conn_handle, proc->cid, chr_val_handle,
+                                 txom);
     txom = NULL;
     if (rc != 0) {
         goto done;
@@ -4375,12 +5025,14 @@ ble_gattc_indicate(uint16_t conn_handle, uint16_t chr_val_handle)
  * procedure.
  */
 void
-ble_gattc_rx_err(uint16_t conn_handle, uint16_t handle, uint16_t status)
+ble_gattc_rx_err(uint16_t conn_handle, uint16_t cid, uint16_t handle,
+                 uint16_t status)
 {
     struct ble_gattc_proc *proc;
     ble_gattc_err_fn *err_cb;
 
-    proc = ble_gattc_extract_first_by_conn_op(conn_handle, BLE_GATT_OP_NONE);
+    proc = ble_gattc_extract_first_by_conn_op(conn_handle, cid,
+                                              BLE_GATT_OP_NONE);
     if (proc != NULL) {
         err_cb = ble_gattc_err_dispatch_get(proc->op);
         if (err_cb != NULL) {
@@ -4399,7 +5051,8 @@ ble_gattc_rx_mtu(uint16_t conn_handle, int status, uint16_t chan_mtu)
 {
     struct ble_gattc_proc *proc;
 
-    proc = ble_gattc_extract_first_by_conn_op(conn_handle, BLE_GATT_OP_MTU);
+    proc = ble_gattc_extract_first_by_conn_op(conn_handle, BLE_L2CAP_CID_ATT,
+                                              BLE_GATT_OP_MTU);
     if (proc != NULL) {
         ble_gattc_mtu_cb(proc, status, 0, chan_mtu);
         ble_gattc_process_status(proc, BLE_HS_EDONE);
@@ -4411,7 +5064,7 @@ ble_gattc_rx_mtu(uint16_t conn_handle, int status, uint16_t chan_mtu)
  * find-information-response to the appropriate active GATT procedure.
  */
 void
-ble_gattc_rx_find_info_idata(uint16_t conn_handle,
+ble_gattc_rx_find_info_idata(uint16_t conn_handle, uint16_t cid,
                              struct ble_att_find_info_idata *idata)
 {
 #if !NIMBLE_BLE_ATT_CLT_FIND_INFO
@@ -4421,7 +5074,7 @@ ble_gattc_rx_find_info_idata(uint16_t conn_handle,
     struct ble_gattc_proc *proc;
     int rc;
 
-    proc = ble_gattc_extract_first_by_conn_op(conn_handle,
+    proc = ble_gattc_extract_first_by_conn_op(conn_handle, cid,
                                               BLE_GATT_OP_DISC_ALL_DSCS);
     if (proc != NULL) {
         rc = ble_gattc_disc_all_dscs_rx_idata(proc, idata);
@@ -4434,7 +5087,7 @@ ble_gattc_rx_find_info_idata(uint16_t conn_handle,
  * find-information-response to the appropriate active GATT procedure.
  */
 void
-ble_gattc_rx_find_info_complete(uint16_t conn_handle, int status)
+ble_gattc_rx_find_info_complete(uint16_t conn_handle, uint16_t cid, int status)
 {
 #if !NIMBLE_BLE_ATT_CLT_FIND_INFO
     return;
@@ -4443,7 +5096,7 @@ ble_gattc_rx_find_info_complete(uint16_t conn_handle, int status)
     struct ble_gattc_proc *proc;
     int rc;
 
-    proc = ble_gattc_extract_first_by_conn_op(conn_handle,
+    proc = ble_gattc_extract_first_by_conn_op(conn_handle, cid,
                                               BLE_GATT_OP_DISC_ALL_DSCS);
     if (proc != NULL) {
         rc = ble_gattc_disc_all_dscs_rx_complete(proc, status);
@@ -4456,7 +5109,7 @@ ble_gattc_rx_find_info_complete(uint16_t conn_handle, int status)
  * find-by-type-value-response to the appropriate active GATT procedure.
  */
 void
-ble_gattc_rx_find_type_value_hinfo(uint16_t conn_handle,
+ble_gattc_rx_find_type_value_hinfo(uint16_t conn_handle, uint16_t cid,
                                    struct ble_att_find_type_value_hinfo *hinfo)
 {
 #if !NIMBLE_BLE_ATT_CLT_FIND_TYPE
@@ -4466,7 +5119,7 @@ ble_gattc_rx_find_type_value_hinfo(uint16_t conn_handle,
     struct ble_gattc_proc *proc;
     int rc;
 
-    proc = ble_gattc_extract_first_by_conn_op(conn_handle,
+    proc = ble_gattc_extract_first_by_conn_op(conn_handle, cid,
                                               BLE_GATT_OP_DISC_SVC_UUID);
     if (proc != NULL) {
         rc = ble_gattc_disc_svc_uuid_rx_hinfo(proc, hinfo);
@@ -4479,7 +5132,8 @@ ble_gattc_rx_find_type_value_hinfo(uint16_t conn_handle,
  * find-by-type-value-response to the appropriate active GATT procedure.
  */
 void
-ble_gattc_rx_find_type_value_complete(uint16_t conn_handle, int status)
+ble_gattc_rx_find_type_value_complete(uint16_t conn_handle, uint16_t cid,
+                                      int status)
 {
 #if !NIMBLE_BLE_ATT_CLT_FIND_TYPE
     return;
@@ -4488,7 +5142,7 @@ ble_gattc_rx_find_type_value_complete(uint16_t conn_handle, int status)
     struct ble_gattc_proc *proc;
     int rc;
 
-    proc = ble_gattc_extract_first_by_conn_op(conn_handle,
+    proc = ble_gattc_extract_first_by_conn_op(conn_handle, cid,
                                               BLE_GATT_OP_DISC_SVC_UUID);
     if (proc != NULL) {
         rc = ble_gattc_disc_svc_uuid_rx_complete(proc, status);
@@ -4501,7 +5155,7 @@ ble_gattc_rx_find_type_value_complete(uint16_t conn_handle, int status)
  * to the appropriate active GATT procedure.
  */
 void
-ble_gattc_rx_read_type_adata(uint16_t conn_handle,
+ble_gattc_rx_read_type_adata(uint16_t conn_handle, uint16_t cid,
                              struct ble_att_read_type_adata *adata)
 {
 #if !NIMBLE_BLE_ATT_CLT_READ_TYPE
@@ -4512,7 +5166,7 @@ ble_gattc_rx_read_type_adata(uint16_t conn_handle,
     struct ble_gattc_proc *proc;
     int rc;
 
-    proc = BLE_GATTC_RX_EXTRACT_RX_ENTRY(conn_handle,
+    proc = BLE_GATTC_RX_EXTRACT_RX_ENTRY(conn_handle, cid,
                                          ble_gattc_rx_read_type_elem_entries,
                                          &rx_entry);
     if (proc != NULL) {
@@ -4526,7 +5180,7 @@ ble_gattc_rx_read_type_adata(uint16_t conn_handle,
  * the appropriate active GATT procedure.
  */
 void
-ble_gattc_rx_read_type_complete(uint16_t conn_handle, int status)
+ble_gattc_rx_read_type_complete(uint16_t conn_handle, uint16_t cid, int status)
 {
 #if !NIMBLE_BLE_ATT_CLT_READ_TYPE
     return;
@@ -4537,7 +5191,7 @@ ble_gattc_rx_read_type_complete(uint16_t conn_handle, int status)
     int rc;
 
     proc = BLE_GATTC_RX_EXTRACT_RX_ENTRY(
-        conn_handle, ble_gattc_rx_read_type_complete_entries,
+        conn_handle, cid, ble_gattc_rx_read_type_complete_entries,
         &rx_entry);
     if (proc != NULL) {
         rc = rx_entry->cb(proc, status);
@@ -4550,7 +5204,7 @@ ble_gattc_rx_read_type_complete(uint16_t conn_handle, int status)
  * read-by-group-type-response to the appropriate active GATT procedure.
  */
 void
-ble_gattc_rx_read_group_type_adata(uint16_t conn_handle,
+ble_gattc_rx_read_group_type_adata(uint16_t conn_handle, uint16_t cid,
                                    struct ble_att_read_group_type_adata *adata)
 {
 #if !NIMBLE_BLE_ATT_CLT_READ_GROUP_TYPE
@@ -4560,7 +5214,7 @@ ble_gattc_rx_read_group_type_adata(uint16_t conn_handle,
     struct ble_gattc_proc *proc;
     int rc;
 
-    proc = ble_gattc_extract_first_by_conn_op(conn_handle,
+    proc = ble_gattc_extract_first_by_conn_op(conn_handle, cid,
                                               BLE_GATT_OP_DISC_ALL_SVCS);
     if (proc != NULL) {
         rc = ble_gattc_disc_all_svcs_rx_adata(proc, adata);
@@ -4573,7 +5227,8 @@ ble_gattc_rx_read_group_type_adata(uint16_t conn_handle,
  * read-by-group-type-response to the appropriate active GATT procedure.
  */
 void
-ble_gattc_rx_read_group_type_complete(uint16_t conn_handle, int status)
+ble_gattc_rx_read_group_type_complete(uint16_t conn_handle, uint16_t cid,
+                                      int status)
 {
 #if !NIMBLE_BLE_ATT_CLT_READ_GROUP_TYPE
     return;
@@ -4582,7 +5237,7 @@ ble_gattc_rx_read_group_type_complete(uint16_t conn_handle, int status)
     struct ble_gattc_proc *proc;
     int rc;
 
-    proc = ble_gattc_extract_first_by_conn_op(conn_handle,
+    proc = ble_gattc_extract_first_by_conn_op(conn_handle, cid,
                                               BLE_GATT_OP_DISC_ALL_SVCS);
     if (proc != NULL) {
         rc = ble_gattc_disc_all_svcs_rx_complete(proc, status);
@@ -4595,7 +5250,8 @@ ble_gattc_rx_read_group_type_complete(uint16_t conn_handle, int status)
  * procedure.
  */
 void
-ble_gattc_rx_read_rsp(uint16_t conn_handle, int status, struct os_mbuf **om)
+ble_gattc_rx_read_rsp(uint16_t conn_handle, uint16_t cid, int status,
+                      struct os_mbuf **om)
 {
 #if !NIMBLE_BLE_ATT_CLT_READ
     return;
@@ -4605,7 +5261,7 @@ ble_gattc_rx_read_rsp(uint16_t conn_handle, int status, struct os_mbuf **om)
     struct ble_gattc_proc *proc;
     int rc;
 
-    proc = BLE_GATTC_RX_EXTRACT_RX_ENTRY(conn_handle,
+    proc = BLE_GATTC_RX_EXTRACT_RX_ENTRY(conn_handle, cid,
                                          ble_gattc_rx_read_rsp_entries,
                                          &rx_entry);
     if (proc != NULL) {
@@ -4619,7 +5275,7 @@ ble_gattc_rx_read_rsp(uint16_t conn_handle, int status, struct os_mbuf **om)
  * procedure.
  */
 void
-ble_gattc_rx_read_blob_rsp(uint16_t conn_handle, int status,
+ble_gattc_rx_read_blob_rsp(uint16_t conn_handle, uint16_t cid, int status,
                            struct os_mbuf **om)
 {
 #if !NIMBLE_BLE_ATT_CLT_READ_BLOB
@@ -4629,7 +5285,7 @@ ble_gattc_rx_read_blob_rsp(uint16_t conn_handle, int status,
     struct ble_gattc_proc *proc;
     int rc;
 
-    proc = ble_gattc_extract_first_by_conn_op(conn_handle,
+    proc = ble_gattc_extract_first_by_conn_op(conn_handle, cid,
                                               BLE_GATT_OP_READ_LONG);
     if (proc != NULL) {
         rc = ble_gattc_read_long_rx_read_rsp(proc, status, om);
@@ -4642,7 +5298,7 @@ ble_gattc_rx_read_blob_rsp(uint16_t conn_handle, int status,
  * GATT procedure.
  */
 void
-ble_gattc_rx_read_mult_rsp(uint16_t conn_handle, int status,
+ble_gattc_rx_read_mult_rsp(uint16_t conn_handle, uint16_t cid, int status,
                            struct os_mbuf **om)
 {
 #if !NIMBLE_BLE_ATT_CLT_READ_MULT
@@ -4651,7 +5307,29 @@ ble_gattc_rx_read_mult_rsp(uint16_t conn_handle, int status,
 
     struct ble_gattc_proc *proc;
 
-    proc = ble_gattc_extract_first_by_conn_op(conn_handle,
+    proc = ble_gattc_extract_first_by_conn_op(conn_handle, cid,
+                                              BLE_GATT_OP_READ_MULT);
+    if (proc != NULL) {
+        ble_gattc_read_mult_cb(proc, status, 0, om);
+        ble_gattc_process_status(proc, BLE_HS_EDONE);
+    }
+}
+
+/**
+ * Dispatches an incoming ATT read-multiple-variable-response to the
+ * appropriate active GATT procedure.
+ */
+void
+ble_gattc_rx_read_mult_var_rsp(uint16_t conn_handle, uint16_t cid, int status,
+                               struct os_mbuf **om)
+{
+#if !NIMBLE_BLE_ATT_CLT_READ_MULT_VAR
+    return;
+#endif
+
+    struct ble_gattc_proc *proc;
+
+    proc = ble_gattc_extract_first_by_conn_op(conn_handle, cid,
                                               BLE_GATT_OP_READ_MULT);
     if (proc != NULL) {
         ble_gattc_read_mult_cb(proc, status, 0, om);
@@ -4664,7 +5342,7 @@ ble_gattc_rx_read_mult_rsp(uint16_t conn_handle, int status,
  * procedure.
  */
 void
-ble_gattc_rx_write_rsp(uint16_t conn_handle)
+ble_gattc_rx_write_rsp(uint16_t conn_handle, uint16_t cid)
 {
 #if !NIMBLE_BLE_ATT_CLT_WRITE
     return;
@@ -4672,7 +5350,7 @@ ble_gattc_rx_write_rsp(uint16_t conn_handle)
 
     struct ble_gattc_proc *proc;
 
-    proc = ble_gattc_extract_first_by_conn_op(conn_handle,
+    proc = ble_gattc_extract_first_by_conn_op(conn_handle, cid,
                                               BLE_GATT_OP_WRITE);
     if (proc != NULL) {
         ble_gattc_write_cb(proc, 0, 0);
@@ -4685,7 +5363,7 @@ ble_gattc_rx_write_rsp(uint16_t conn_handle)
  * GATT procedure.
  */
 void
-ble_gattc_rx_prep_write_rsp(uint16_t conn_handle, int status,
+ble_gattc_rx_prep_write_rsp(uint16_t conn_handle, uint16_t cid, int status,
                             uint16_t handle, uint16_t offset,
                             struct os_mbuf **om)
 {
@@ -4697,7 +5375,7 @@ ble_gattc_rx_prep_write_rsp(uint16_t conn_handle, int status,
     struct ble_gattc_proc *proc;
     int rc;
 
-    proc = BLE_GATTC_RX_EXTRACT_RX_ENTRY(conn_handle,
+    proc = BLE_GATTC_RX_EXTRACT_RX_ENTRY(conn_handle, cid,
                                          ble_gattc_rx_prep_entries,
                                          &rx_entry);
     if (proc != NULL) {
@@ -4711,7 +5389,7 @@ ble_gattc_rx_prep_write_rsp(uint16_t conn_handle, int status,
  * GATT procedure.
  */
 void
-ble_gattc_rx_exec_write_rsp(uint16_t conn_handle, int status)
+ble_gattc_rx_exec_write_rsp(uint16_t conn_handle, uint16_t cid, int status)
 {
 #if !NIMBLE_BLE_ATT_CLT_EXEC_WRITE
     return;
@@ -4721,7 +5399,7 @@ ble_gattc_rx_exec_write_rsp(uint16_t conn_handle, int status)
     struct ble_gattc_proc *proc;
     int rc;
 
-    proc = BLE_GATTC_RX_EXTRACT_RX_ENTRY(conn_handle,
+    proc = BLE_GATTC_RX_EXTRACT_RX_ENTRY(conn_handle, cid,
                                          ble_gattc_rx_exec_entries, &rx_entry);
     if (proc != NULL) {
         rc = rx_entry->cb(proc, status);
@@ -4734,7 +5412,7 @@ ble_gattc_rx_exec_write_rsp(uint16_t conn_handle, int status)
  * active GATT procedure.
  */
 void
-ble_gattc_rx_indicate_rsp(uint16_t conn_handle)
+ble_gattc_rx_indicate_rsp(uint16_t conn_handle, uint16_t cid)
 {
 #if !NIMBLE_BLE_ATT_CLT_INDICATE
     return;
@@ -4742,7 +5420,7 @@ ble_gattc_rx_indicate_rsp(uint16_t conn_handle)
 
     struct ble_gattc_proc *proc;
 
-    proc = ble_gattc_extract_first_by_conn_op(conn_handle,
+    proc = ble_gattc_extract_first_by_conn_op(conn_handle, cid,
                                               BLE_GATT_OP_INDICATE);
     if (proc != NULL) {
         ble_gattc_indicate_rx_rsp(proc);
@@ -4750,6 +5428,269 @@ ble_gattc_rx_indicate_rsp(uint16_t conn_handle)
     }
 }
 
+/*****************************************************************************
+ * $cache                                                                    *
+ *****************************************************************************/
+
+#if MYNEWT_VAL(BLE_GATT_CACHING)
+
+/**
+ * Indicates whether a cached attribute answers the specified discovery proc.
+ */
+static int
+ble_gattc_cache_matches(const struct ble_gattc_proc *proc,
+                        const struct ble_store_value_peer_attr *value)
+{
+    switch (proc->op) {
+    case BLE_GATT_OP_DISC_ALL_SVCS:
+        return 1;
+
+    case BLE_GATT_OP_DISC_SVC_UUID:
+        return ble_uuid_cmp(&value->uuid.u,
+                            &proc->disc_svc_uuid.service_uuid.u) == 0;
+
+    case BLE_GATT_OP_DISC_ALL_CHRS:
+        return value->handle > proc->disc_all_chrs.prev_handle &&
+               value->handle <= proc->disc_all_chrs.end_handle;
+
+    case BLE_GATT_OP_DISC_CHR_UUID:
+        return value->handle > proc->disc_chr_uuid.prev_handle &&
+               value->handle <= proc->disc_chr_uuid.end_handle &&
+               ble_uuid_cmp(&value->uuid.u,
+                            &proc->disc_chr_uuid.chr_uuid.u) == 0;
+
+    case BLE_GATT_OP_DISC_ALL_DSCS:
+        return value->handle > proc->disc_all_dscs.prev_handle &&
+               value->handle <= proc->disc_all_dscs.end_handle;
+
+    default:
+        BLE_HS_DBG_ASSERT(0);
+        return 0;
+    }
+}
+
+/**
+ * Reports a cached attribute, or the final status if value is null, to the
+ * specified discovery proc's callback.
+ *
+ * @return                      The return code of the callback.
+ */
+static int
+ble_gattc_cache_report(struct ble_gattc_proc *proc, int status,
+                       const struct ble_store_value_peer_attr *value)
+{
+    struct ble_gatt_svc svc;
+    struct ble_gatt_chr chr;
+    struct ble_gatt_dsc dsc;
+
+    if (value != NULL) {
+        svc.start_handle = value->handle;
+        svc.end_handle = value->end_handle;
+        svc.uuid = value->uuid;
+
+        chr.def_handle = value->handle;
+        chr.val_handle = value->end_handle;
+        chr.properties = value->properties;
+        chr.uuid = value->uuid;
+
+        dsc.handle = value->handle;
+        dsc.uuid = value->uuid;
+    }
+
+    switch (proc->op) {
+    case BLE_GATT_OP_DISC_ALL_SVCS:
+        return ble_gattc_disc_all_svcs_cb(proc, status, 0,
+                                          value != NULL ? &svc : NULL);
+
+    case BLE_GATT_OP_DISC_SVC_UUID:
+        return ble_gattc_disc_svc_uuid_cb(proc, status, 0,
+                                          value != NULL ? &svc : NULL);
+
+    case BLE_GATT_OP_DISC_ALL_CHRS:
+        return ble_gattc_disc_all_chrs_cb(proc, status, 0,
+                                          value != NULL ? &chr : NULL);
+
+    case BLE_GATT_OP_DISC_CHR_UUID:
+        return ble_gattc_disc_chr_uuid_cb(proc, status, 0,
+                                          value != NULL ? &chr : NULL);
+
+    case BLE_GATT_OP_DISC_ALL_DSCS:
+        return ble_gattc_disc_all_dscs_cb(proc, status, 0,
+                                          value != NULL ? &dsc : NULL);
+
+    default:
+        BLE_HS_DBG_ASSERT(0);
+        return 0;
+    }
+}
+
+/**
+ * Answers a discovery proc from its connection's cached attribute tree.  The
+ * callback sees the same sequence it would see over the air: one call per
+ * matching attribute, in handle order, then BLE_HS_EDONE.
+ *
+ * @param status                Nonzero to fail the proc with this status
+ *                                  without consulting the cache.
+ */
+static void
+ble_gattc_cache_serve(struct ble_gattc_proc *proc, int status)
+{
+    struct ble_store_value_peer_attr value;
+    struct ble_store_key_peer_attr key;
+    int idx;
+    int rc;
+
+    if (status == 0) {
+        status = ble_gattc_cache_key(proc->conn_handle, &key);
+        if (status == BLE_HS_ENOENT) {
+            /* The peer indicated Service Changed after the proc was queued. */
+            status = BLE_HS_EAGAIN;
+        }
+    }
+
+    if (status == 0) {
+        switch (proc->op) {
+        case BLE_GATT_OP_DISC_ALL_SVCS:
+        case BLE_GATT_OP_DISC_SVC_UUID:
+            key.type = BLE_STORE_PEER_ATTR_TYPE_SVC;
+            break;
+
+        case BLE_GATT_OP_DISC_ALL_CHRS:
+        case BLE_GATT_OP_DISC_CHR_UUID:
+            key.type = BLE_STORE_PEER_ATTR_TYPE_CHR;
+            break;
+
+        default:
+            key.type = BLE_STORE_PEER_ATTR_TYPE_DSC;
+            break;
+        }
+
+        /* Runs out of indices only if the tree has more attributes of one
+         * type than a store key reaches.
+         */
+        status = BLE_HS_ESTORE_CAP;
+        for (idx = 0; idx <= UINT8_MAX; idx++) {
+            key.idx = idx;
+            rc = ble_store_read_peer_attr(&key, &value);
+            if (rc != 0) {
+                status = rc == BLE_HS_ENOENT ? BLE_HS_EDONE : rc;
+                break;
+            }
+
+            if (ble_gattc_cache_matches(proc, &value)) {
+                rc = ble_gattc_cache_report(proc, 0, &value);
+                if (rc != 0) {
+                    /* Application aborted the procedure. */
+                    return;
+                }
+            }
+        }
+    }
+
+    ble_gattc_cache_report(proc, status, NULL);
+}
+
+static void
+ble_gattc_cache_event_handle(struct ble_npl_event *ev)
+{
+    struct ble_gattc_proc *proc;
+
+    while (1) {
+        ble_hs_lock();
+        proc = STAILQ_FIRST(&ble_gattc_cache_procs);
+        if (proc != NULL) {
+            STAILQ_REMOVE_HEAD(&ble_gattc_cache_procs, next);
+        }
+        ble_hs_unlock();
+
+        if (proc == NULL) {
+            return;
+        }
+
+        ble_gattc_cache_serve(proc, 0);
+        ble_gattc_proc_free(proc);
+    }
+}
+
+/**
+ * Queues a discovery proc to be answered from the cache if its connection's
+ * attribute tree has been validated.  Results are delivered from the host
+ * task, so the application never sees a callback before the discovery
+ * function returns.
+ *
+ * @return                      0 if the proc was queued;
+ *                              nonzero if it has to go over the air.
+ */
+static int
+ble_gattc_cache_enqueue(struct ble_gattc_proc *proc)
+{
+    int rc;
+
+    rc = ble_gattc_cache_key(proc->conn_handle, NULL);
+    if (rc != 0) {
+        return rc;
+    }
+
+    ble_hs_lock();
+    STAILQ_INSERT_TAIL(&ble_gattc_cache_procs, proc, next);
+    ble_hs_unlock();
+
+#if !MYNEWT_VAL(BLE_HS_REQUIRE_OS)
+    if (!ble_npl_os_started()) {
+        ble_gattc_cache_event_handle(NULL);
+        return 0;
+    }
+#endif
+
+    ble_npl_eventq_put(ble_hs_evq_get(), &ble_gattc_cache_ev);
+    return 0;
+}
+
+/**
+ * Fails every queued cache proc of the specified connection.
+ */
+static void
+ble_gattc_cache_fail_procs(uint16_t conn_handle)
+{
+    struct ble_gattc_proc_list fail_list;
+    struct ble_gattc_proc *proc;
+    struct ble_gattc_proc *prev;
+    struct ble_gattc_proc *next;
+
+    STAILQ_INIT(&fail_list);
+
+    ble_hs_lock();
+
+    prev = NULL;
+    proc = STAILQ_FIRST(&ble_gattc_cache_procs);
+    while (proc != NULL) {
+        next = STAILQ_NEXT(proc, next);
+
+        if (proc->conn_handle == conn_handle) {
+            if (prev == NULL) {
+                STAILQ_REMOVE_HEAD(&ble_gattc_cache_procs, next);
+            } else {
+                STAILQ_REMOVE_AFTER(&ble_gattc_cache_procs, prev, next);
+            }
+            STAILQ_INSERT_TAIL(&fail_list, proc, next);
+        } else {
+            prev = proc;
+        }
+
+        proc = next;
+    }
+
+    ble_hs_unlock();
+
+    while ((proc = STAILQ_FIRST(&fail_list)) != NULL) {
+        STAILQ_REMOVE_HEAD(&fail_list, next);
+        ble_gattc_cache_serve(proc, BLE_HS_ENOTCONN);
+        ble_gattc_proc_free(proc);
+    }
+}
+
+#endif
+
 /*****************************************************************************
  * $misc                                                                     *
  *****************************************************************************/
@@ -4765,7 +5706,26 @@ ble_gattc_rx_indicate_rsp(uint16_t conn_handle)
 void
 ble_gattc_connection_broken(uint16_t conn_handle)
 {
-    ble_gattc_fail_procs(conn_handle, BLE_GATT_OP_NONE, BLE_HS_ENOTCONN);
+#if MYNEWT_VAL(BLE_GATT_CACHING)
+    ble_gattc_cache_fail_procs(conn_handle);
+    ble_gattc_cache_connection_broken(conn_handle);
+#endif
+
+    ble_gattc_fail_procs(conn_handle, BLE_GATTC_CID_ANY, BLE_GATT_OP_NONE,
+                         BLE_HS_ENOTCONN);
+}
+
+/**
+ * Called when an enhanced ATT bearer is closed.  Fails all GATT procedures
+ * that were running on the bearer.
+ *
+ * @param conn_handle           The connection the bearer belonged to.
+ * @param cid                   The source CID of the closed bearer.
+ */
+void
+ble_gattc_bearer_closed(uint16_t conn_handle, uint16_t cid)
+{
+    ble_gattc_fail_procs(conn_handle, cid, BLE_GATT_OP_NONE, BLE_HS_ENOTCONN);
 }
 
 /**
@@ -4784,6 +5744,12 @@ ble_gattc_init(void)
 
     STAILQ_INIT(&ble_gattc_procs);
 
+#if MYNEWT_VAL(BLE_GATT_CACHING)
+    STAILQ_INIT(&ble_gattc_cache_procs);
+    ble_npl_event_init(&ble_gattc_cache_ev, ble_gattc_cache_event_handle,
+                       NULL);
+#endif
+
     if (MYNEWT_VAL(BLE_GATT_MAX_PROCS) > 0) {
         rc = os_mempool_init(&ble_gattc_proc_pool,
                              MYNEWT_VAL(BLE_GATT_MAX_PROCS),
@@ -0,0 +1,903 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * GATT client discovery cache.
+ *
+ * A peer's attribute tree is kept in the host store as a sequence of
+ * BLE_STORE_OBJ_TYPE_PEER_ATTR records: every service first, then every
+ * characteristic, then every descriptor, each group in handle order, followed
+ * by a single terminator record.  A tree without its terminator is the
+ * remnant of an interrupted discovery and is never used.
+ *
+ * Only bonded peers are cached, and only over an encrypted link.  Each peer
+ * keeps at most one tree, keyed by its identity address and, if the peer
+ * exposes one, its Database Hash.  A tree stored under a different hash is
+ * replaced rather than reused.
+ *
+ * ble_gattc_cache_discover() reads the hash, looks the tree up and, on a
+ * miss, discovers and stores it.  From then on ble_gattc.c answers discovery
+ * procedures on the connection from the store.
+ */
+
+#include <string.h>
+#include "syscfg/syscfg.h"
+#include "host/ble_store.h"
+#include "ble_hs_priv.h"
+
+#if MYNEWT_VAL(BLE_GATT_CACHING)
+
+#define BLE_GATTC_CACHE_SVC_CHANGED_UUID16      0x2a05
+
+static void ble_gattc_cache_lookup(uint16_t conn_handle);
+static void ble_gattc_cache_disc_chrs(uint16_t conn_handle);
+static void ble_gattc_cache_disc_dscs(uint16_t conn_handle);
+
+/**
+ * Lock restrictions: Caller must lock ble_hs_mutex.
+ */
+static struct ble_gattc_cache_conn *
+ble_gattc_cache_conn_find(uint16_t conn_handle, struct ble_hs_conn **out_conn)
+{
+    struct ble_hs_conn *conn;
+
+    BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
+
+    conn = ble_hs_conn_find(conn_handle);
+    if (out_conn != NULL) {
+        *out_conn = conn;
+    }
+    if (conn == NULL) {
+        return NULL;
+    }
+
+    return &conn->bhc_gattc_cache;
+}
+
+/**
+ * Fills in the store key of the attribute tree belonging to the specified
+ * connection's peer.
+ *
+ * Lock restrictions: Caller must lock ble_hs_mutex.
+ */
+static void
+ble_gattc_cache_conn_key(struct ble_hs_conn *conn,
+                         struct ble_store_key_peer_attr *out_key)
+{
+    struct ble_hs_conn_addrs addrs;
+
+    memset(out_key, 0, sizeof *out_key);
+
+    ble_hs_conn_addrs(conn, &addrs);
+    out_key->peer_addr = addrs.peer_id_addr;
+
+    if (conn->bhc_gattc_cache.flags & BLE_GATTC_CACHE_F_HASH) {
+        memcpy(out_key->db_hash, conn->bhc_gattc_cache.db_hash,
+               sizeof out_key->db_hash);
+        out_key->db_hash_present = 1;
+    }
+}
+
+/**
+ * Indicates whether the specified connection's tree has the specified key.
+ *
+ * Lock restrictions: Caller must lock ble_hs_mutex.
+ */
+static int
+ble_gattc_cache_conn_key_eq(struct ble_hs_conn *conn,
+                            const struct ble_store_key_peer_attr *key)
+{
+    struct ble_store_key_peer_attr conn_key;
+
+    ble_gattc_cache_conn_key(conn, &conn_key);
+
+    if (ble_addr_cmp(&conn_key.peer_addr, &key->peer_addr) != 0) {
+        return 0;
+    }
+    if (conn_key.db_hash_present != key->db_hash_present) {
+        return 0;
+    }
+    if (key->db_hash_present &&
+        memcmp(conn_key.db_hash, key->db_hash, sizeof key->db_hash) != 0) {
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Retrieves the store key of the specified connection's attribute tree.
+ *
+ * @param conn_handle           The connection to query.
+ * @param out_key               On success, the tree's key gets written here;
+ *                                  may be NULL.
+ *
+ * @return                      0 if the tree has been validated;
+ *                              BLE_HS_ENOENT if the connection's discovery
+ *                                  procedures are not served from the cache;
+ *                              BLE_HS_ENOTCONN if there is no such
+ *                                  connection.
+ */
+int
+ble_gattc_cache_key(uint16_t conn_handle,
+                    struct ble_store_key_peer_attr *out_key)
+{
+    struct ble_gattc_cache_conn *cache;
+    struct ble_hs_conn *conn;
+    int rc;
+
+    ble_hs_lock();
+
+    cache = ble_gattc_cache_conn_find(conn_handle, &conn);
+    if (cache == NULL) {
+        rc = BLE_HS_ENOTCONN;
+    } else if (!(cache->flags & BLE_GATTC_CACHE_F_VALID)) {
+        rc = BLE_HS_ENOENT;
+    } else {
+        if (out_key != NULL) {
+            ble_gattc_cache_conn_key(conn, out_key);
+        }
+        rc = 0;
+    }
+
+    ble_hs_unlock();
+
+    return rc;
+}
+
+struct ble_gattc_cache_filling {
+    const struct ble_store_key_peer_attr *key;
+    int found;
+};
+
+static int
+ble_gattc_cache_conn_filling(struct ble_hs_conn *conn, void *arg)
+{
+    struct ble_gattc_cache_filling *filling;
+
+    filling = arg;
+
+    if ((conn->bhc_gattc_cache.flags & BLE_GATTC_CACHE_F_FILL) &&
+        ble_gattc_cache_conn_key_eq(conn, filling->key)) {
+
+        filling->found = 1;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Indicates whether some connection is currently storing the tree with the
+ * specified key.
+ *
+ * Lock restrictions: Caller must lock ble_hs_mutex.
+ */
+static int
+ble_gattc_cache_key_filling(const struct ble_store_key_peer_attr *key)
+{
+    struct ble_gattc_cache_filling filling;
+
+    filling.key = key;
+    filling.found = 0;
+    ble_hs_conn_foreach(ble_gattc_cache_conn_filling, &filling);
+
+    return filling.found;
+}
+
+struct ble_gattc_cache_waiters {
+    const struct ble_store_key_peer_attr *key;
+    uint16_t conn_handles[MYNEWT_VAL(BLE_MAX_CONNECTIONS)];
+    int num_conns;
+};
+
+static int
+ble_gattc_cache_collect_waiter(struct ble_hs_conn *conn, void *arg)
+{
+    struct ble_gattc_cache_waiters *waiters;
+    struct ble_gattc_cache_conn *cache;
+
+    waiters = arg;
+    cache = &conn->bhc_gattc_cache;
+
+    if ((cache->flags & BLE_GATTC_CACHE_F_WAIT) &&
+        ble_gattc_cache_conn_key_eq(conn, waiters->key)) {
+
+        cache->flags &= ~BLE_GATTC_CACHE_F_WAIT;
+        waiters->conn_handles[waiters->num_conns++] = conn->bhc_handle;
+    }
+
+    return 0;
+}
+
+/**
+ * Resumes every connection that waited for the tree with the specified key
+ * to be stored.  Each of them either finds the tree now, or takes over its
+ * discovery.
+ */
+static void
+ble_gattc_cache_wake(const struct ble_store_key_peer_attr *key)
+{
+    struct ble_gattc_cache_waiters waiters;
+    int i;
+
+    waiters.key = key;
+    waiters.num_conns = 0;
+
+    ble_hs_lock();
+    ble_hs_conn_foreach(ble_gattc_cache_collect_waiter, &waiters);
+    ble_hs_unlock();
+
+    for (i = 0; i < waiters.num_conns; i++) {
+        ble_gattc_cache_lookup(waiters.conn_handles[i]);
+    }
+}
+
+/**
+ * Completes the cache procedure of the specified connection and reports the
+ * outcome to the application.
+ */
+static void
+ble_gattc_cache_done(uint16_t conn_handle, int status, int valid)
+{
+    struct ble_store_key_peer_attr key;
+    struct ble_gattc_cache_conn *cache;
+    struct ble_hs_conn *conn;
+    ble_gatt_cache_fn *cb;
+    void *cb_arg;
+    int filled;
+
+    ble_hs_lock();
+
+    cache = ble_gattc_cache_conn_find(conn_handle, &conn);
+    if (cache == NULL) {
+        ble_hs_unlock();
+        return;
+    }
+
+    filled = cache->flags & BLE_GATTC_CACHE_F_FILL;
+    if (filled) {
+        ble_gattc_cache_conn_key(conn, &key);
+    }
+
+    cache->flags &= ~(BLE_GATTC_CACHE_F_BUSY | BLE_GATTC_CACHE_F_FILL |
+                      BLE_GATTC_CACHE_F_WAIT);
+    if (valid) {
+        cache->flags |= BLE_GATTC_CACHE_F_VALID;
+    }
+
+    cb = cache->cb;
+    cb_arg = cache->cb_arg;
+
+    ble_hs_unlock();
+
+    if (filled) {
+        ble_gattc_cache_wake(&key);
+    }
+
+    if (cb != NULL) {
+        cb(conn_handle, status, cb_arg);
+    }
+}
+
+/**
+ * Aborts the cache procedure of the specified connection.  A partially stored
+ * tree is deleted.
+ */
+static void
+ble_gattc_cache_fail(uint16_t conn_handle, int status)
+{
+    struct ble_gattc_cache_conn *cache;
+    union ble_store_key key;
+    struct ble_hs_conn *conn;
+    int filling;
+
+    ble_hs_lock();
+
+    cache = ble_gattc_cache_conn_find(conn_handle, &conn);
+    filling = cache != NULL && (cache->flags & BLE_GATTC_CACHE_F_FILL);
+    if (filling) {
+        ble_gattc_cache_conn_key(conn, &key.peer_attr);
+    }
+
+    ble_hs_unlock();
+
+    if (filling) {
+        ble_store_util_delete_all(BLE_STORE_OBJ_TYPE_PEER_ATTR, &key);
+    }
+
+    ble_gattc_cache_done(conn_handle, status, 0);
+}
+
+/**
+ * Stores one record of the tree being discovered over the specified
+ * connection.
+ */
+static int
+ble_gattc_cache_write(uint16_t conn_handle, uint8_t type, uint16_t handle,
+                      uint16_t end_handle, uint8_t properties,
+                      const ble_uuid_t *uuid)
+{
+    struct ble_store_value_peer_attr value;
+    struct ble_store_key_peer_attr key;
+    struct ble_hs_conn *conn;
+    int rc;
+
+    ble_hs_lock();
+    if (ble_gattc_cache_conn_find(conn_handle, &conn) != NULL) {
+        ble_gattc_cache_conn_key(conn, &key);
+        rc = 0;
+    } else {
+        rc = BLE_HS_ENOTCONN;
+    }
+    ble_hs_unlock();
+
+    if (rc != 0) {
+        return rc;
+    }
+
+    /* Store keys reach the first UINT8_MAX records of each type; a tree with
+     * more could not be read back completely.
+     */
+    key.type = type;
+    key.idx = UINT8_MAX - 1;
+    if (ble_store_read_peer_attr(&key, &value) == 0) {
+        return BLE_HS_ESTORE_CAP;
+    }
+
+    memset(&value, 0, sizeof value);
+    value.peer_addr = key.peer_addr;
+    memcpy(value.db_hash, key.db_hash, sizeof value.db_hash);
+    value.db_hash_present = key.db_hash_present;
+    value.type = type;
+    value.handle = handle;
+    value.end_handle = end_handle;
+    value.properties = properties;
+    if (uuid != NULL) {
+        ble_uuid_to_any(uuid, &value.uuid);
+    }
+
+    return ble_store_write_peer_attr(&value);
+}
+
+/**
+ * Reads the idx-th service of the tree being discovered over the specified
+ * connection.
+ */
+static int
+ble_gattc_cache_read_svc(uint16_t conn_handle,
+                         struct ble_store_value_peer_attr *out_svc)
+{
+    struct ble_gattc_cache_conn *cache;
+    struct ble_store_key_peer_attr key;
+    struct ble_hs_conn *conn;
+    int rc;
+
+    ble_hs_lock();
+    cache = ble_gattc_cache_conn_find(conn_handle, &conn);
+    if (cache != NULL) {
+        ble_gattc_cache_conn_key(conn, &key);
+        key.idx = cache->svc_idx;
+        rc = 0;
+    } else {
+        rc = BLE_HS_ENOTCONN;
+    }
+    ble_hs_unlock();
+
+    if (rc != 0) {
+        return rc;
+    }
+
+    key.type = BLE_STORE_PEER_ATTR_TYPE_SVC;
+    return ble_store_read_peer_attr(&key, out_svc);
+}
+
+static void
+ble_gattc_cache_next_svc(uint16_t conn_handle, int rewind)
+{
+    struct ble_gattc_cache_conn *cache;
+
+    ble_hs_lock();
+    cache = ble_gattc_cache_conn_find(conn_handle, NULL);
+    if (cache != NULL) {
+        cache->svc_idx = rewind ? 0 : cache->svc_idx + 1;
+        cache->skip_handle = 0;
+    }
+    ble_hs_unlock();
+}
+
+static int
+ble_gattc_cache_dsc_cb(uint16_t conn_handle,
+                       const struct ble_gatt_error *error,
+                       uint16_t chr_val_handle,
+                       const struct ble_gatt_dsc *dsc, void *arg)
+{
+    struct ble_gattc_cache_conn *cache;
+    uint16_t uuid16;
+    int skip;
+    int rc;
+
+    switch (error->status) {
+    case 0:
+        break;
+
+    case BLE_HS_EDONE:
+        ble_gattc_cache_next_svc(conn_handle, 0);
+        ble_gattc_cache_disc_dscs(conn_handle);
+        return 0;
+
+    default:
+        ble_gattc_cache_fail(conn_handle, error->status);
+        return 0;
+    }
+
+    /* Find Information reports the whole service.  Characteristic
+     * declarations are already stored and each one is immediately followed
+     * by its value; neither is a descriptor.
+     */
+    uuid16 = ble_uuid_u16(&dsc->uuid.u);
+
+    ble_hs_lock();
+    cache = ble_gattc_cache_conn_find(conn_handle, NULL);
+    if (cache == NULL) {
+        skip = 1;
+    } else if (uuid16 == BLE_ATT_UUID_CHARACTERISTIC) {
+        cache->skip_handle = dsc->handle + 1;
+        skip = 1;
+    } else {
+        skip = uuid16 == BLE_ATT_UUID_INCLUDE ||
+               dsc->handle == cache->skip_handle;
+    }
+    ble_hs_unlock();
+
+    if (skip) {
+        return 0;
+    }
+
+    rc = ble_gattc_cache_write(conn_handle, BLE_STORE_PEER_ATTR_TYPE_DSC,
+                               dsc->handle, 0, 0, &dsc->uuid.u);
+    if (rc != 0) {
+        ble_gattc_cache_fail(conn_handle, rc);
+        return rc;
+    }
+
+    return 0;
+}
+
+static void
+ble_gattc_cache_disc_dscs(uint16_t conn_handle)
+{
+    struct ble_store_value_peer_attr svc;
+    int rc;
+
+    while (1) {
+        rc = ble_gattc_cache_read_svc(conn_handle, &svc);
+        if (rc == BLE_HS_ENOENT) {
+            break;
+        }
+        if (rc != 0) {
+            ble_gattc_cache_fail(conn_handle, rc);
+            return;
+        }
+
+        if (svc.handle < svc.end_handle) {
+            rc = ble_gattc_disc_all_dscs(conn_handle, svc.handle,
+                                         svc.end_handle,
+                                         ble_gattc_cache_dsc_cb, NULL);
+            if (rc != 0) {
+                ble_gattc_cache_fail(conn_handle, rc);
+            }
+            return;
+        }
+
+        ble_gattc_cache_next_svc(conn_handle, 0);
+    }
+
+    /* Every service has been walked; seal the tree. */
+    rc = ble_gattc_cache_write(conn_handle, BLE_STORE_PEER_ATTR_TYPE_END,
+                               0, 0, 0, NULL);
+    if (rc != 0) {
+        ble_gattc_cache_fail(conn_handle, rc);
+        return;
+    }
+
+    ble_gattc_cache_done(conn_handle, 0, 1);
+}
+
+static int
+ble_gattc_cache_chr_cb(uint16_t conn_handle,
+                       const struct ble_gatt_error *error,
+                       const struct ble_gatt_chr *chr, void *arg)
+{
+    struct ble_gattc_cache_conn *cache;
+    int rc;
+
+    switch (error->status) {
+    case 0:
+        break;
+
+    case BLE_HS_EDONE:
+        ble_gattc_cache_next_svc(conn_handle, 0);
+        ble_gattc_cache_disc_chrs(conn_handle);
+        return 0;
+
+    default:
+        ble_gattc_cache_fail(conn_handle, error->status);
+        return 0;
+    }
+
+    if (ble_uuid_u16(&chr->uuid.u) == BLE_GATTC_CACHE_SVC_CHANGED_UUID16) {
+        ble_hs_lock();
+        cache = ble_gattc_cache_conn_find(conn_handle, NULL);
+        if (cache != NULL) {
+            cache->svc_changed_handle = chr->val_handle;
+        }
+        ble_hs_unlock();
+    }
+
+    rc = ble_gattc_cache_write(conn_handle, BLE_STORE_PEER_ATTR_TYPE_CHR,
+                               chr->def_handle, chr->val_handle,
+                               chr->properties, &chr->uuid.u);
+    if (rc != 0) {
+        ble_gattc_cache_fail(conn_handle, rc);
+        return rc;
+    }
+
+    return 0;
+}
+
+static void
+ble_gattc_cache_disc_chrs(uint16_t conn_handle)
+{
+    struct ble_store_value_peer_attr svc;
+    int rc;
+
+    rc = ble_gattc_cache_read_svc(conn_handle, &svc);
+    if (rc == BLE_HS_ENOENT) {
+        ble_gattc_cache_next_svc(conn_handle, 1);
+        ble_gattc_cache_disc_dscs(conn_handle);
+        return;
+    }
+
+    if (rc == 0) {
+        rc = ble_gattc_disc_all_chrs(conn_handle, svc.handle, svc.end_handle,
+                                     ble_gattc_cache_chr_cb, NULL);
+    }
+    if (rc != 0) {
+        ble_gattc_cache_fail(conn_handle, rc);
+    }
+}
+
+static int
+ble_gattc_cache_svc_cb(uint16_t conn_handle,
+                       const struct ble_gatt_error *error,
+                       const struct ble_gatt_svc *service, void *arg)
+{
+    int rc;
+
+    switch (error->status) {
+    case 0:
+        rc = ble_gattc_cache_write(conn_handle, BLE_STORE_PEER_ATTR_TYPE_SVC,
+                                   service->start_handle,
+                                   service->end_handle, 0,
+                                   &service->uuid.u);
+        if (rc != 0) {
+            ble_gattc_cache_fail(conn_handle, rc);
+            return rc;
+        }
+        return 0;
+
+    case BLE_HS_EDONE:
+        ble_gattc_cache_next_svc(conn_handle, 1);
+        ble_gattc_cache_disc_chrs(conn_handle);
+        return 0;
+
+    default:
+        ble_gattc_cache_fail(conn_handle, error->status);
+        return 0;
+    }
+}
+
+/**
+ * Retrieves the value handle of the Service Changed characteristic from a
+ * stored tree.
+ *
+ * @param key                   The tree's key.
+ * @param out_handle            On success, the value handle gets written
+ *                                  here; 0 if the peer does not have one.
+ *
+ * @return                      0 on success;
+ *                              BLE_HS_ESTORE_CAP if the tree has more
+ *                                  characteristics than a store key reaches;
+ *                              Other nonzero on store failure.
+ */
+static int
+ble_gattc_cache_find_svc_changed(struct ble_store_key_peer_attr *key,
+                                 uint16_t *out_handle)
+{
+    struct ble_store_value_peer_attr value;
+    int idx;
+    int rc;
+
+    *out_handle = 0;
+
+    key->type = BLE_STORE_PEER_ATTR_TYPE_CHR;
+    for (idx = 0; idx <= UINT8_MAX; idx++) {
+        key->idx = idx;
+        rc = ble_store_read_peer_attr(key, &value);
+        if (rc == BLE_HS_ENOENT) {
+            return 0;
+        }
+        if (rc != 0) {
+            return rc;
+        }
+
+        if (ble_uuid_u16(&value.uuid.u) ==
+            BLE_GATTC_CACHE_SVC_CHANGED_UUID16) {
+
+            *out_handle = value.end_handle;
+            return 0;
+        }
+    }
+
+    return BLE_HS_ESTORE_CAP;
+}
+
+/**
+ * Looks up the tree of the specified connection's peer.  A complete tree is
+ * used as is; otherwise the tree is discovered and stored.
+ */
+static void
+ble_gattc_cache_lookup(uint16_t conn_handle)
+{
+    struct ble_store_value_peer_attr value;
+    struct ble_gattc_cache_conn *cache;
+    union ble_store_key key;
+    struct ble_hs_conn *conn;
+    uint16_t svc_changed_handle;
+    int rc;
+
+    ble_hs_lock();
+
+    cache = ble_gattc_cache_conn_find(conn_handle, &conn);
+    if (cache == NULL) {
+        ble_hs_unlock();
+        return;
+    }
+
+    if (!conn->bhc_sec_state.encrypted || !conn->bhc_sec_state.bonded) {
+        /* Nothing ties the peer to a stored tree; leave discovery to the
+         * air.
+         */
+        ble_hs_unlock();
+        ble_gattc_cache_done(conn_handle, 0, 0);
+        return;
+    }
+
+    ble_gattc_cache_conn_key(conn, &key.peer_attr);
+
+    if (ble_gattc_cache_key_filling(&key.peer_attr)) {
+        /* Another connection to the same peer is discovering its tree right
+         * now; use the tree once it is complete.
+         */
+        cache->flags |= BLE_GATTC_CACHE_F_WAIT;
+        ble_hs_unlock();
+        return;
+    }
+
+    ble_hs_unlock();
+
+    /* A key without a hash matches any of the peer's trees; only one stored
+     * without a hash describes the peer now.
+     */
+    key.peer_attr.type = BLE_STORE_PEER_ATTR_TYPE_END;
+    rc = ble_store_read_peer_attr(&key.peer_attr, &value);
+    if (rc == 0 &&
+        value.db_hash_present == key.peer_attr.db_hash_present) {
+
+        rc = ble_gattc_cache_find_svc_changed(&key.peer_attr,
+                                              &svc_changed_handle);
+        if (rc != 0) {
+            ble_gattc_cache_done(conn_handle, rc, 0);
+            return;
+        }
+
+        ble_hs_lock();
+        cache = ble_gattc_cache_conn_find(conn_handle, NULL);
+        if (cache != NULL) {
+            cache->svc_changed_handle = svc_changed_handle;
+        }
+        ble_hs_unlock();
+
+        ble_gattc_cache_done(conn_handle, 0, 1);
+        return;
+    }
+
+    ble_hs_lock();
+    cache = ble_gattc_cache_conn_find(conn_handle, NULL);
+    if (cache != NULL) {
+        cache->flags |= BLE_GATTC_CACHE_F_FILL;
+        cache->svc_changed_handle = 0;
+        cache->svc_idx = 0;
+        cache->skip_handle = 0;
+    }
+    ble_hs_unlock();
+
+    /* Drop the peer's outdated tree and whatever an interrupted discovery
+     * left behind.
+     */
+    key.peer_attr.type = 0;
+    key.peer_attr.db_hash_present = 0;
+    rc = ble_store_util_delete_all(BLE_STORE_OBJ_TYPE_PEER_ATTR, &key);
+    if (rc == 0) {
+        rc = ble_gattc_disc_all_svcs(conn_handle, ble_gattc_cache_svc_cb,
+                                     NULL);
+    }
+    if (rc != 0) {
+        ble_gattc_cache_fail(conn_handle, rc);
+    }
+}
+
+static int
+ble_gattc_cache_hash_cb(uint16_t conn_handle,
+                        const struct ble_gatt_error *error,
+                        struct ble_gatt_attr *attr, void *arg)
+{
+    struct ble_gattc_cache_conn *cache;
+
+    switch (error->status) {
+    case 0:
+        if (OS_MBUF_PKTLEN(attr->om) == BLE_GATT_DB_HASH_SZ) {
+            ble_hs_lock();
+            cache = ble_gattc_cache_conn_find(conn_handle, NULL);
+            if (cache != NULL) {
+                os_mbuf_copydata(attr->om, 0, BLE_GATT_DB_HASH_SZ,
+                                 cache->db_hash);
+                cache->flags |= BLE_GATTC_CACHE_F_HASH;
+            }
+            ble_hs_unlock();
+        }
+        return 0;
+
+    case BLE_HS_EDONE:
+        ble_gattc_cache_lookup(conn_handle);
+        return 0;
+
+    default:
+        if (error->status > BLE_HS_ERR_ATT_BASE &&
+            error->status < BLE_HS_ERR_HCI_BASE) {
+
+            /* The peer does not expose a Database Hash. */
+            ble_gattc_cache_lookup(conn_handle);
+        } else {
+            ble_gattc_cache_done(conn_handle, error->status, 0);
+        }
+        return 0;
+    }
+}
+
+int
+ble_gattc_cache_discover(uint16_t conn_handle, ble_gatt_cache_fn *cb,
+                         void *cb_arg)
+{
+    struct ble_gattc_cache_conn *cache;
+    int rc;
+
+    ble_hs_lock();
+
+    cache = ble_gattc_cache_conn_find(conn_handle, NULL);
+    if (cache == NULL) {
+        rc = BLE_HS_ENOTCONN;
+    } else if (cache->flags & BLE_GATTC_CACHE_F_BUSY) {
+        rc = BLE_HS_EALREADY;
+    } else {
+        cache->flags = BLE_GATTC_CACHE_F_BUSY;
+        cache->svc_changed_handle = 0;
+        cache->cb = cb;
+        cache->cb_arg = cb_arg;
+        rc = 0;
+    }
+
+    ble_hs_unlock();
+
+    if (rc != 0) {
+        return rc;
+    }
+
+    rc = ble_gattc_read_by_uuid(conn_handle, 1, 0xffff,
+                                BLE_UUID16_DECLARE(BLE_GATT_CHR_DB_HASH_UUID16),
+                                ble_gattc_cache_hash_cb, NULL);
+    if (rc != 0) {
+        ble_hs_lock();
+        cache = ble_gattc_cache_conn_find(conn_handle, NULL);
+        if (cache != NULL) {
+            cache->flags = 0;
+        }
+        ble_hs_unlock();
+    }
+
+    return rc;
+}
+
+/**
+ * Called when the peer sends an indication.  A Service Changed indication
+ * means the cached tree no longer describes the peer; the connection goes
+ * back to discovering over the air until the application calls
+ * ble_gattc_cache_discover() again.  The peer's tree is deleted.
+ */
+void
+ble_gattc_cache_rx_indicate(uint16_t conn_handle, uint16_t attr_handle)
+{
+    struct ble_gattc_cache_conn *cache;
+    union ble_store_key key;
+    struct ble_hs_conn *conn;
+    int delete;
+
+    delete = 0;
+
+    ble_hs_lock();
+
+    cache = ble_gattc_cache_conn_find(conn_handle, &conn);
+    if (cache != NULL &&
+        (cache->flags & BLE_GATTC_CACHE_F_VALID) &&
+        cache->svc_changed_handle != 0 &&
+        cache->svc_changed_handle == attr_handle) {
+
+        cache->flags &= ~BLE_GATTC_CACHE_F_VALID;
+        ble_gattc_cache_conn_key(conn, &key.peer_attr);
+        delete = 1;
+    }
+
+    ble_hs_unlock();
+
+    if (delete) {
+        ble_store_util_delete_all(BLE_STORE_OBJ_TYPE_PEER_ATTR, &key);
+    }
+}
+
+/**
+ * Called when a connection ends.  A connection still waiting for another one
+ * to store its tree has no procedure that would report the termination.
+ */
+void
+ble_gattc_cache_connection_broken(uint16_t conn_handle)
+{
+    struct ble_gattc_cache_conn *cache;
+    int waiting;
+
+    ble_hs_lock();
+    cache = ble_gattc_cache_conn_find(conn_handle, NULL);
+    waiting = cache != NULL && (cache->flags & BLE_GATTC_CACHE_F_WAIT);
+    ble_hs_unlock();
+
+    if (waiting) {
+        ble_gattc_cache_done(conn_handle, BLE_HS_ENOTCONN, 0);
+    }
+}
+
+#else
+
+int
+ble_gattc_cache_discover(uint16_t conn_handle, ble_gatt_cache_fn *cb,
+                         void *cb_arg)
+{
+    return BLE_HS_ENOTSUP;
+}
+
+#endif
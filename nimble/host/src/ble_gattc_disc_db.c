@@ -0,0 +1,601 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * GATT client database discovery.
+ *
+ * ble_gattc_disc_db() discovers a peer's whole database with three kinds of
+ * sub-procedures:
+ *     o One Discover All Primary Services procedure over the whole handle
+ *       range.
+ *     o One Discover All Characteristics procedure over the whole handle
+ *       range, rather than one per service; this saves the request that
+ *       terminates each per-service procedure.
+ *     o One Discover All Characteristic Descriptors procedure per
+ *       characteristic, covering the handles between its value and the next
+ *       characteristic declaration or the end of its service.
+ *       Characteristics without room for descriptors cost no request.
+ *
+ * ATT allows a single outstanding request per bearer, so the procedure never
+ * runs more sub-procedures than the connection has bearers.  With enhanced
+ * ATT bearers, characteristic discovery runs alongside service discovery, and
+ * descriptor discovery alongside both as soon as the service boundaries are
+ * known.  Ranges wait in a queue until a bearer becomes free.  While the
+ * queue is full, characteristic discovery is suspended; it resumes after the
+ * last characteristic reported once the queue has drained, at the cost of one
+ * extra request.
+ *
+ * New sub-procedures are only started once another one has ended.  A
+ * sub-procedure delivering an entry is temporarily detached from its bearer,
+ * which would otherwise look idle.
+ */
+
+#include <string.h>
+#include "syscfg/syscfg.h"
+#include "ble_hs_priv.h"
+
+#if MYNEWT_VAL(BLE_GATT_DISC_DB)
+
+#define BLE_GATTC_DISC_DB_OP_NONE       0
+#define BLE_GATTC_DISC_DB_OP_CHRS       1
+#define BLE_GATTC_DISC_DB_OP_DSCS       2
+
+static void ble_gattc_disc_db_kick(uint16_t conn_handle);
+
+/**
+ * Lock restrictions: Caller must lock ble_hs_mutex.
+ */
+static struct ble_gattc_disc_db_conn *
+ble_gattc_disc_db_conn_find(uint16_t conn_handle)
+{
+    struct ble_hs_conn *conn;
+
+    BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
+
+    conn = ble_hs_conn_find(conn_handle);
+    if (conn == NULL) {
+        return NULL;
+    }
+
+    return &conn->bhc_gattc_disc_db;
+}
+
+/**
+ * Retrieves the number of ATT bearers of the specified connection, i.e., the
+ * number of requests that can be outstanding at once.
+ */
+static int
+ble_gattc_disc_db_num_bearers(uint16_t conn_handle)
+{
+#if MYNEWT_VAL(BLE_EATT_CHAN_NUM) > 0
+    uint16_t cids[MYNEWT_VAL(BLE_EATT_CHAN_NUM)];
+
+    return 1 + ble_att_eatt_bearers(conn_handle, cids,
+                                    MYNEWT_VAL(BLE_EATT_CHAN_NUM));
+#else
+    return 1;
+#endif
+}
+
+/**
+ * Records the first error of a procedure and stops starting new
+ * sub-procedures.
+ *
+ * Lock restrictions: Caller must lock ble_hs_mutex.
+ */
+static void
+ble_gattc_disc_db_abort(struct ble_gattc_disc_db_conn *disc, int status)
+{
+    if (!(disc->flags & BLE_GATTC_DISC_DB_F_ABORT)) {
+        disc->flags |= BLE_GATTC_DISC_DB_F_ABORT;
+        disc->status = status;
+    }
+}
+
+/**
+ * Completes the procedure of the specified connection and reports its outcome
+ * to the application, unless the application aborted it.
+ */
+static void
+ble_gattc_disc_db_done(uint16_t conn_handle)
+{
+    struct ble_gatt_disc_db_event event;
+    struct ble_gattc_disc_db_conn *disc;
+    ble_gatt_disc_db_fn *cb;
+    void *cb_arg;
+
+    ble_hs_lock();
+
+    disc = ble_gattc_disc_db_conn_find(conn_handle);
+    if (disc == NULL || !(disc->flags & BLE_GATTC_DISC_DB_F_BUSY)) {
+        ble_hs_unlock();
+        return;
+    }
+
+    memset(&event, 0, sizeof event);
+    event.type = BLE_GATT_DISC_DB_EVENT_DONE;
+    event.done.status = disc->status;
+    event.done.num_reqs = disc->num_reqs;
+    event.done.elapsed_ms =
+        ble_npl_time_ticks_to_ms32(ble_npl_time_get() - disc->start_ticks);
+
+    cb = disc->cb;
+    cb_arg = disc->cb_arg;
+    disc->flags = 0;
+
+    ble_hs_unlock();
+
+    if (event.done.status != BLE_HS_EAPP) {
+        cb(conn_handle, &event, cb_arg);
+    }
+}
+
+/**
+ * Called when a sub-procedure has ended; phase is the flag of the phase it
+ * ran, or 0 for descriptor discovery.
+ */
+static void
+ble_gattc_disc_db_proc_done(uint16_t conn_handle, uint8_t phase, int status)
+{
+    struct ble_gattc_disc_db_conn *disc;
+
+    ble_hs_lock();
+
+    disc = ble_gattc_disc_db_conn_find(conn_handle);
+    if (disc != NULL && (disc->flags & BLE_GATTC_DISC_DB_F_BUSY)) {
+        BLE_HS_DBG_ASSERT(disc->num_procs > 0);
+        disc->num_procs--;
+        disc->flags &= ~phase;
+        if (status != 0 && status != BLE_HS_EDONE) {
+            ble_gattc_disc_db_abort(disc, status);
+        }
+    }
+
+    ble_hs_unlock();
+
+    ble_gattc_disc_db_kick(conn_handle);
+}
+
+/**
+ * Passes an attribute to the application.  A nonzero return code ends the
+ * calling sub-procedure.
+ */
+static int
+ble_gattc_disc_db_report(uint16_t conn_handle, uint8_t phase,
+                         const struct ble_gatt_disc_db_event *event)
+{
+    struct ble_gattc_disc_db_conn *disc;
+    ble_gatt_disc_db_fn *cb;
+    void *cb_arg;
+    int rc;
+
+    ble_hs_lock();
+
+    disc = ble_gattc_disc_db_conn_find(conn_handle);
+    if (disc == NULL || (disc->flags & BLE_GATTC_DISC_DB_F_ABORT)) {
+        cb = NULL;
+    } else {
+        cb = disc->cb;
+    }
+    cb_arg = disc != NULL ? disc->cb_arg : NULL;
+
+    ble_hs_unlock();
+
+    if (cb != NULL) {
+        rc = cb(conn_handle, event, cb_arg);
+        if (rc == 0) {
+            return 0;
+        }
+
+        ble_hs_lock();
+        disc = ble_gattc_disc_db_conn_find(conn_handle);
+        if (disc != NULL) {
+            ble_gattc_disc_db_abort(disc, BLE_HS_EAPP);
+        }
+        ble_hs_unlock();
+    }
+
+    /* The procedure is being aborted; end the sub-procedure. */
+    ble_gattc_disc_db_proc_done(conn_handle, phase, 0);
+    return BLE_HS_EDONE;
+}
+
+/**
+ * Queues the descriptor range of a characteristic.
+ *
+ * Lock restrictions: Caller must lock ble_hs_mutex.
+ *
+ * @return                      0 on success; BLE_HS_ENOMEM if the queue is
+ *                                  full and characteristic discovery has to
+ *                                  be suspended.
+ */
+static int
+ble_gattc_disc_db_range_push(struct ble_gattc_disc_db_conn *disc,
+                             uint16_t chr_val_handle, uint16_t end_handle)
+{
+    int idx;
+
+    if (end_handle <= chr_val_handle) {
+        /* No room for descriptors. */
+        return 0;
+    }
+
+    if (disc->num_ranges >= MYNEWT_VAL(BLE_GATT_DISC_DB_MAX_CHRS)) {
+        return BLE_HS_ENOMEM;
+    }
+
+    idx = (disc->range_head + disc->num_ranges) %
+          MYNEWT_VAL(BLE_GATT_DISC_DB_MAX_CHRS);
+    disc->ranges[idx].chr_val_handle = chr_val_handle;
+    disc->ranges[idx].end_handle = end_handle;
+    disc->num_ranges++;
+
+    return 0;
+}
+
+/**
+ * Dequeues the next descriptor range and limits it to the characteristic's
+ * service.
+ *
+ * Lock restrictions: Caller must lock ble_hs_mutex.
+ */
+static void
+ble_gattc_disc_db_range_pop(struct ble_gattc_disc_db_conn *disc,
+                            uint16_t *out_chr_val_handle,
+                            uint16_t *out_end_handle)
+{
+    uint16_t chr_val_handle;
+    uint16_t end_handle;
+    int i;
+
+    BLE_HS_DBG_ASSERT(disc->num_ranges > 0);
+
+    chr_val_handle = disc->ranges[disc->range_head].chr_val_handle;
+    end_handle = disc->ranges[disc->range_head].end_handle;
+    disc->range_head = (disc->range_head + 1) %
+                       MYNEWT_VAL(BLE_GATT_DISC_DB_MAX_CHRS);
+    disc->num_ranges--;
+
+    /* Services are reported in handle order; the first one ending after the
+     * value handle contains the characteristic.  If it is not among the
+     * remembered ones, the range runs up to the next characteristic and
+     * service declarations are filtered out instead.
+     */
+    for (i = 0; i < disc->num_svcs; i++) {
+        if (disc->svc_ends[i] >= chr_val_handle) {
+            if (disc->svc_ends[i] < end_handle) {
+                end_handle = disc->svc_ends[i];
+            }
+            break;
+        }
+    }
+
+    *out_chr_val_handle = chr_val_handle;
+    *out_end_handle = end_handle;
+}
+
+static int
+ble_gattc_disc_db_dsc_cb(uint16_t conn_handle,
+                         const struct ble_gatt_error *error,
+                         uint16_t chr_val_handle,
+                         const struct ble_gatt_dsc *dsc, void *arg)
+{
+    struct ble_gatt_disc_db_event event;
+
+    if (error->status != 0) {
+        ble_gattc_disc_db_proc_done(conn_handle, 0, error->status);
+        return 0;
+    }
+
+    switch (ble_uuid_u16(&dsc->uuid.u)) {
+    case BLE_ATT_UUID_PRIMARY_SERVICE:
+    case BLE_ATT_UUID_SECONDARY_SERVICE:
+    case BLE_ATT_UUID_INCLUDE:
+    case BLE_ATT_UUID_CHARACTERISTIC:
+        /* The range crossed into the next service. */
+        return 0;
+
+    default:
+        break;
+    }
+
+    event.type = BLE_GATT_DISC_DB_EVENT_DSC;
+    event.dsc.chr_val_handle = chr_val_handle;
+    event.dsc.dsc = dsc;
+
+    return ble_gattc_disc_db_report(conn_handle, 0, &event);
+}
+
+static int
+ble_gattc_disc_db_chr_cb(uint16_t conn_handle,
+                         const struct ble_gatt_error *error,
+                         const struct ble_gatt_chr *chr, void *arg)
+{
+    struct ble_gatt_disc_db_event event;
+    struct ble_gattc_disc_db_conn *disc;
+    int suspend;
+    int rc;
+
+    rc = 0;
+    suspend = 0;
+
+    ble_hs_lock();
+
+    disc = ble_gattc_disc_db_conn_find(conn_handle);
+    if (disc != NULL && disc->chr_val_handle != 0) {
+        /* The previous characteristic ends where this one begins. */
+        if (error->status == 0) {
+            rc = ble_gattc_disc_db_range_push(disc, disc->chr_val_handle,
+                                              chr->def_handle - 1);
+        } else if (error->status == BLE_HS_EDONE) {
+            rc = ble_gattc_disc_db_range_push(disc, disc->chr_val_handle,
+                                              0xffff);
+        }
+
+        if (rc == BLE_HS_ENOMEM) {
+            /* Rediscover from the previous characteristic once the queue
+             * has drained; this entry is reported then.  A value handle
+             * with room for descriptors is below 0xffff.
+             */
+            disc->chr_start_handle = disc->chr_val_handle + 1;
+            disc->flags |= BLE_GATTC_DISC_DB_F_CHRS_PEND;
+            suspend = 1;
+        }
+    }
+    if (disc != NULL && error->status == 0 && !suspend) {
+        disc->chr_val_handle = chr->val_handle;
+    }
+
+    ble_hs_unlock();
+
+    if (error->status != 0) {
+        ble_gattc_disc_db_proc_done(conn_handle, BLE_GATTC_DISC_DB_F_CHRS,
+                                    error->status);
+        return 0;
+    }
+
+    if (suspend) {
+        ble_gattc_disc_db_proc_done(conn_handle, BLE_GATTC_DISC_DB_F_CHRS, 0);
+        return BLE_HS_EDONE;
+    }
+
+    event.type = BLE_GATT_DISC_DB_EVENT_CHR;
+    event.chr = chr;
+
+    return ble_gattc_disc_db_report(conn_handle, BLE_GATTC_DISC_DB_F_CHRS,
+                                    &event);
+}
+
+static int
+ble_gattc_disc_db_svc_cb(uint16_t conn_handle,
+                         const struct ble_gatt_error *error,
+                         const struct ble_gatt_svc *service, void *arg)
+{
+    struct ble_gatt_disc_db_event event;
+    struct ble_gattc_disc_db_conn *disc;
+
+    if (error->status != 0) {
+        ble_gattc_disc_db_proc_done(conn_handle, BLE_GATTC_DISC_DB_F_SVCS,
+                                    error->status);
+        return 0;
+    }
+
+    ble_hs_lock();
+
+    disc = ble_gattc_disc_db_conn_find(conn_handle);
+    if (disc != NULL &&
+        disc->num_svcs < MYNEWT_VAL(BLE_GATT_DISC_DB_MAX_SVCS)) {
+
+        disc->svc_ends[disc->num_svcs++] = service->end_handle;
+    }
+
+    ble_hs_unlock();
+
+    event.type = BLE_GATT_DISC_DB_EVENT_SVC;
+    event.svc = service;
+
+    return ble_gattc_disc_db_report(conn_handle, BLE_GATTC_DISC_DB_F_SVCS,
+                                    &event);
+}
+
+/**
+ * Starts as many sub-procedures as the connection has free bearers for, and
+ * completes the procedure once nothing is left to do.
+ */
+static void
+ble_gattc_disc_db_kick(uint16_t conn_handle)
+{
+    struct ble_gattc_disc_db_conn *disc;
+    uint16_t chr_val_handle;
+    uint16_t start_handle;
+    uint16_t end_handle;
+    int num_bearers;
+    int done;
+    int op;
+    int rc;
+
+    num_bearers = ble_gattc_disc_db_num_bearers(conn_handle);
+
+    while (1) {
+        op = BLE_GATTC_DISC_DB_OP_NONE;
+        done = 0;
+
+        ble_hs_lock();
+
+        disc = ble_gattc_disc_db_conn_find(conn_handle);
+        if (disc == NULL || !(disc->flags & BLE_GATTC_DISC_DB_F_BUSY)) {
+            ble_hs_unlock();
+            return;
+        }
+
+        if (!(disc->flags & BLE_GATTC_DISC_DB_F_ABORT) &&
+            disc->num_procs < num_bearers) {
+
+            if ((disc->flags & BLE_GATTC_DISC_DB_F_CHRS_PEND) &&
+                disc->num_ranges == 0) {
+
+                disc->flags &= ~BLE_GATTC_DISC_DB_F_CHRS_PEND;
+                disc->flags |= BLE_GATTC_DISC_DB_F_CHRS;
+                disc->num_procs++;
+                start_handle = disc->chr_start_handle;
+                op = BLE_GATTC_DISC_DB_OP_CHRS;
+            } else if (!(disc->flags & BLE_GATTC_DISC_DB_F_SVCS) &&
+                       disc->num_ranges > 0) {
+
+                /* Ranges are bounded by services; wait for all of them. */
+                ble_gattc_disc_db_range_pop(disc, &chr_val_handle,
+                                            &end_handle);
+                if (end_handle > chr_val_handle) {
+                    disc->num_procs++;
+                    op = BLE_GATTC_DISC_DB_OP_DSCS;
+                } else {
+                    ble_hs_unlock();
+                    continue;
+                }
+            }
+        }
+
+        if (op == BLE_GATTC_DISC_DB_OP_NONE) {
+            done = disc->num_procs == 0 &&
+                   ((disc->flags & BLE_GATTC_DISC_DB_F_ABORT) ||
+                    (!(disc->flags & (BLE_GATTC_DISC_DB_F_SVCS |
+                                      BLE_GATTC_DISC_DB_F_CHRS_PEND |
+                                      BLE_GATTC_DISC_DB_F_CHRS)) &&
+                     disc->num_ranges == 0));
+        }
+
+        ble_hs_unlock();
+
+        switch (op) {
+        case BLE_GATTC_DISC_DB_OP_CHRS:
+            rc = ble_gattc_disc_db_chrs(conn_handle, start_handle, 0xffff,
+                                        ble_gattc_disc_db_chr_cb, NULL);
+            break;
+
+        case BLE_GATTC_DISC_DB_OP_DSCS:
+            rc = ble_gattc_disc_db_dscs(conn_handle, chr_val_handle,
+                                        end_handle,
+                                        ble_gattc_disc_db_dsc_cb, NULL);
+            break;
+
+        default:
+            if (done) {
+                ble_gattc_disc_db_done(conn_handle);
+            }
+            return;
+        }
+
+        if (rc != 0) {
+            ble_hs_lock();
+            disc = ble_gattc_disc_db_conn_find(conn_handle);
+            if (disc != NULL) {
+                disc->num_procs--;
+                if (op == BLE_GATTC_DISC_DB_OP_CHRS) {
+                    disc->flags &= ~BLE_GATTC_DISC_DB_F_CHRS;
+                }
+                ble_gattc_disc_db_abort(disc, rc);
+            }
+            ble_hs_unlock();
+        }
+    }
+}
+
+/**
+ * Called whenever a sub-procedure of a database discovery sends a request.
+ */
+void
+ble_gattc_disc_db_req_tx(uint16_t conn_handle)
+{
+    struct ble_gattc_disc_db_conn *disc;
+
+    ble_hs_lock();
+
+    disc = ble_gattc_disc_db_conn_find(conn_handle);
+    if (disc != NULL && (disc->flags & BLE_GATTC_DISC_DB_F_BUSY)) {
+        disc->num_reqs++;
+    }
+
+    ble_hs_unlock();
+}
+
+int
+ble_gattc_disc_db(uint16_t conn_handle, ble_gatt_disc_db_fn *cb,
+                  void *cb_arg)
+{
+    struct ble_gattc_disc_db_conn *disc;
+    int rc;
+
+    if (cb == NULL) {
+        return BLE_HS_EINVAL;
+    }
+
+    ble_hs_lock();
+
+    disc = ble_gattc_disc_db_conn_find(conn_handle);
+    if (disc == NULL) {
+        rc = BLE_HS_ENOTCONN;
+    } else if (disc->flags & BLE_GATTC_DISC_DB_F_BUSY) {
+        rc = BLE_HS_EALREADY;
+    } else {
+        memset(disc, 0, sizeof *disc);
+        disc->flags = BLE_GATTC_DISC_DB_F_BUSY | BLE_GATTC_DISC_DB_F_SVCS |
+                      BLE_GATTC_DISC_DB_F_CHRS_PEND;
+        disc->num_procs = 1;
+        disc->chr_start_handle = 1;
+        disc->start_ticks = ble_npl_time_get();
+        disc->cb = cb;
+        disc->cb_arg = cb_arg;
+        rc = 0;
+    }
+
+    ble_hs_unlock();
+
+    if (rc != 0) {
+        return rc;
+    }
+
+    rc = ble_gattc_disc_db_svcs(conn_handle, ble_gattc_disc_db_svc_cb, NULL);
+    if (rc != 0) {
+        ble_hs_lock();
+        disc = ble_gattc_disc_db_conn_find(conn_handle);
+        if (disc != NULL) {
+            disc->flags = 0;
+        }
+        ble_hs_unlock();
+        return rc;
+    }
+
+    /* Characteristic discovery starts right away if there is a second
+     * bearer, otherwise once the services are known.
+     */
+    ble_gattc_disc_db_kick(conn_handle);
+
+    return 0;
+}
+
+#else
+
+int
+ble_gattc_disc_db(uint16_t conn_handle, ble_gatt_disc_db_fn *cb,
+                  void *cb_arg)
+{
+    return BLE_HS_ENOTSUP;
+}
+
+#endif
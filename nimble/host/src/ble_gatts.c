@@ -24,10 +24,23 @@
 #include "host/ble_uuid.h"
 #include "host/ble_store.h"
 #include "ble_hs_priv.h"
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+#include "tinycrypt/constants.h"
+#include "tinycrypt/cmac_mode.h"
+#endif
 
 #define BLE_GATTS_INCLUDE_SZ    6
 #define BLE_GATTS_CHR_MAX_SZ    19
 
+/* Attribute types the Database Hash is calculated over. */
+#define BLE_GATTS_DSC_EXT_PROP_UUID16       0x2900
+#define BLE_GATTS_DSC_USER_DESC_UUID16      0x2901
+#define BLE_GATTS_DSC_SVR_CFG_UUID16        0x2903
+#define BLE_GATTS_DSC_PRES_FMT_UUID16       0x2904
+#define BLE_GATTS_DSC_AGG_FMT_UUID16        0x2905
+
+#define BLE_GATTS_CHR_SVC_CHANGED_UUID16    0x2a05
+
 static const ble_uuid_t *uuid_pri =
     BLE_UUID16_DECLARE(BLE_ATT_UUID_PRIMARY_SERVICE);
 static const ble_uuid_t *uuid_sec =
@@ -64,6 +77,15 @@ struct ble_gatts_clt_cfg {
 static struct ble_gatts_clt_cfg *ble_gatts_clt_cfgs;
 static int ble_gatts_num_cfgable_chrs;
 
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+/** Cached Database Hash; only meaningful while ble_gatts_db_hash_valid. */
+static uint8_t ble_gatts_db_hash_val[BLE_GATT_DB_HASH_SZ];
+static uint8_t ble_gatts_db_hash_valid;
+
+/** Value handle of the Service Changed characteristic; 0 if none. */
+static uint16_t ble_gatts_svc_changed_handle;
+#endif
+
 STATS_SECT_DECL(ble_gatts_stats) ble_gatts_stats;
 STATS_NAME_START(ble_gatts_stats)
     STATS_NAME(ble_gatts_stats, svcs)
@@ -1214,6 +1236,11 @@ ble_gatts_start(void)
     }
 
 
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+    ble_gatts_db_hash_valid = 0;
+    ble_gatts_svc_changed_handle = 0;
+#endif
+
     ble_gatts_num_svc_entries = 0;
     for (i = 0; i < ble_gatts_num_svc_defs; i++) {
         rc = ble_gatts_register_svcs(ble_gatts_svc_defs[i],
@@ -1262,6 +1289,12 @@ ble_gatts_start(void)
             ble_gatts_clt_cfgs[idx].allowed = allowed_flags;
             ble_gatts_clt_cfgs[idx].flags = 0;
             idx++;
+
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+            if (ble_uuid_u16(chr->uuid) == BLE_GATTS_CHR_SVC_CHANGED_UUID16) {
+                ble_gatts_svc_changed_handle = ha->ha_handle_id + 1;
+            }
+#endif
         }
     }
 
@@ -1300,9 +1333,195 @@ ble_gatts_conn_init(struct ble_gatts_conn *gatts_conn)
         gatts_conn->num_clt_cfgs = 0;
     }
 
+    memset(gatts_conn->peer_cl_sup_feat, 0,
+           sizeof gatts_conn->peer_cl_sup_feat);
+    gatts_conn->flags = 0;
+
     return 0;
 }
 
+/**
+ * Persists the client supported features of a bonded peer, along with the
+ * Database Hash it is change-aware of, so that both survive reconnection.
+ * Nothing is stored for peers that did not enable any feature.
+ */
+static void
+ble_gatts_peer_cl_sup_feat_persist(uint16_t conn_handle)
+{
+    struct ble_store_value_cl_sup_feat value;
+    struct ble_hs_conn *conn;
+    uint8_t any_feat;
+    int aware;
+    int i;
+
+    memset(&value, 0, sizeof value);
+
+    ble_hs_lock();
+
+    conn = ble_hs_conn_find(conn_handle);
+    if (conn == NULL || !conn->bhc_sec_state.bonded) {
+        ble_hs_unlock();
+        return;
+    }
+
+    value.peer_addr = conn->bhc_peer_addr;
+    value.peer_addr.type =
+        ble_hs_misc_peer_addr_type_to_id(conn->bhc_peer_addr.type);
+    memcpy(value.cl_sup_feat, conn->bhc_gatt_svr.peer_cl_sup_feat,
+           sizeof value.cl_sup_feat);
+    aware = !(conn->bhc_gatt_svr.flags & BLE_GATTS_CONN_F_CHANGE_UNAWARE);
+
+    ble_hs_unlock();
+
+    any_feat = 0;
+    for (i = 0; i < sizeof value.cl_sup_feat; i++) {
+        any_feat |= value.cl_sup_feat[i];
+    }
+    if (!any_feat) {
+        return;
+    }
+
+    if (aware && ble_gatts_db_hash(value.db_hash) == 0) {
+        value.db_hash_present = 1;
+    }
+
+    ble_store_write_cl_sup_feat(&value);
+}
+
+/**
+ * Restores the client supported features of a bonded peer.  A peer using
+ * robust caching is change-unaware if the database changed since it last
+ * learnt about it, including across resets of this device.
+ */
+static void
+ble_gatts_peer_cl_sup_feat_restore(uint16_t conn_handle)
+{
+    struct ble_store_value_cl_sup_feat value;
+    struct ble_store_key_cl_sup_feat key;
+    struct ble_gatts_conn *gatt_svr;
+    struct ble_hs_conn *conn;
+    uint8_t hash[BLE_GATT_DB_HASH_SZ];
+    int unaware;
+    int rc;
+
+    ble_hs_lock();
+
+    conn = ble_hs_conn_find(conn_handle);
+    BLE_HS_DBG_ASSERT(conn != NULL);
+
+    memset(&key, 0, sizeof key);
+    key.peer_addr = conn->bhc_peer_addr;
+    key.peer_addr.type =
+        ble_hs_misc_peer_addr_type_to_id(conn->bhc_peer_addr.type);
+
+    ble_hs_unlock();
+
+    rc = ble_store_read_cl_sup_feat(&key, &value);
+    if (rc != 0) {
+        return;
+    }
+
+    unaware = 0;
+    if (value.cl_sup_feat[0] & BLE_GATT_CLI_SUP_FEAT_ROBUST_CACHING) {
+        unaware = !value.db_hash_present ||
+                  ble_gatts_db_hash(hash) != 0 ||
+                  memcmp(hash, value.db_hash, sizeof hash) != 0;
+    }
+
+    ble_hs_lock();
+
+    conn = ble_hs_conn_find(conn_handle);
+    if (conn != NULL) {
+        gatt_svr = &conn->bhc_gatt_svr;
+        memcpy(gatt_svr->peer_cl_sup_feat, value.cl_sup_feat,
+               sizeof gatt_svr->peer_cl_sup_feat);
+        if (unaware) {
+            gatt_svr->flags |= BLE_GATTS_CONN_F_CHANGE_UNAWARE;
+            gatt_svr->flags &= ~BLE_GATTS_CONN_F_AWARE_PENDING;
+        }
+    }
+
+    ble_hs_unlock();
+}
+
+int
+ble_gatts_peer_cl_sup_feat_get(uint16_t conn_handle,
+                               uint8_t *out_supported_feat, uint8_t len)
+{
+    struct ble_hs_conn *conn;
+    int rc;
+
+    ble_hs_lock();
+
+    conn = ble_hs_conn_find(conn_handle);
+    if (conn == NULL) {
+        rc = BLE_HS_ENOTCONN;
+    } else {
+        memset(out_supported_feat, 0, len);
+        memcpy(out_supported_feat, conn->bhc_gatt_svr.peer_cl_sup_feat,
+               min(len, BLE_GATT_CHR_CLI_SUP_FEAT_SZ));
+        rc = 0;
+    }
+
+    ble_hs_unlock();
+
+    return rc;
+}
+
+int
+ble_gatts_peer_cl_sup_feat_update(uint16_t conn_handle, struct os_mbuf *om)
+{
+    uint8_t feat[BLE_GATT_CHR_CLI_SUP_FEAT_SZ];
+    struct ble_hs_conn *conn;
+    uint16_t len;
+    int changed;
+    int rc;
+    int i;
+
+    /* Octets we do not know about are ignored. */
+    memset(feat, 0, sizeof feat);
+    len = min(OS_MBUF_PKTLEN(om), sizeof feat);
+    rc = os_mbuf_copydata(om, 0, len, feat);
+    if (rc != 0) {
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+
+    /* So are features that are not built in. */
+    feat[0] &= BLE_GATTS_CL_SUP_FEAT_MASK;
+
+    changed = 0;
+
+    ble_hs_lock();
+
+    conn = ble_hs_conn_find(conn_handle);
+    if (conn == NULL) {
+        rc = BLE_ATT_ERR_UNLIKELY;
+        goto done;
+    }
+
+    /* A client may not disable a feature it has enabled. */
+    for (i = 0; i < sizeof feat; i++) {
+        if (conn->bhc_gatt_svr.peer_cl_sup_feat[i] & ~feat[i]) {
+            rc = BLE_ATT_ERR_VALUE_NOT_ALLOWED;
+            goto done;
+        }
+    }
+
+    changed = memcmp(conn->bhc_gatt_svr.peer_cl_sup_feat, feat,
+                     sizeof feat) != 0;
+    memcpy(conn->bhc_gatt_svr.peer_cl_sup_feat, feat, sizeof feat);
+    rc = 0;
+
+done:
+    ble_hs_unlock();
+
+    if (rc == 0 && changed) {
+        ble_gatts_peer_cl_sup_feat_persist(conn_handle);
+    }
+
+    return rc;
+}
+
 
 /**
  * Schedules a notification or indication for the specified peer-CCCD pair.  If
@@ -1410,10 +1629,13 @@ ble_gatts_rx_indicate_ack(uint16_t conn_handle, uint16_t chr_val_handle)
     struct ble_store_value_cccd cccd_value;
     struct ble_gatts_clt_cfg *clt_cfg;
     struct ble_hs_conn *conn;
+    int became_aware;
     int clt_cfg_idx;
     int persist;
     int rc;
 
+    became_aware = 0;
+
     clt_cfg_idx = ble_gatts_clt_cfg_find_idx(ble_gatts_clt_cfgs,
                                              chr_val_handle);
     if (clt_cfg_idx == -1) {
@@ -1438,6 +1660,19 @@ ble_gatts_rx_indicate_ack(uint16_t conn_handle, uint16_t chr_val_handle)
         /* Mark that there is no longer an outstanding txed indicate. */
         conn->bhc_gatt_svr.indicate_val_handle = 0;
 
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+        /* A confirmed Service Changed indication makes the peer
+         * change-aware.
+         */
+        if (chr_val_handle == ble_gatts_svc_changed_handle &&
+            conn->bhc_gatt_svr.flags & BLE_GATTS_CONN_F_CHANGE_UNAWARE) {
+
+            conn->bhc_gatt_svr.flags &= ~(BLE_GATTS_CONN_F_CHANGE_UNAWARE |
+                                          BLE_GATTS_CONN_F_AWARE_PENDING);
+            became_aware = 1;
+        }
+#endif
+
         /* Determine if we need to persist that there is no pending indication
          * for this peer-characteristic pair.  If the characteristic has not
          * been modified since we sent the indication, there is no indication
@@ -1477,6 +1712,10 @@ ble_gatts_rx_indicate_ack(uint16_t conn_handle, uint16_t chr_val_handle)
         }
     }
 
+    if (became_aware) {
+        ble_gatts_peer_cl_sup_feat_persist(conn_handle);
+    }
+
     return 0;
 }
 
@@ -1491,7 +1730,6 @@ ble_gatts_chr_updated(uint16_t chr_val_handle)
     int clt_cfg_idx;
     int persist;
     int rc;
-    int i;
 
     /* Determine if notifications or indications are allowed for this
      * characteristic.  If not, return immediately.
@@ -1505,14 +1743,9 @@ ble_gatts_chr_updated(uint16_t chr_val_handle)
     /*** Send notifications and indications to connected devices. */
 
     ble_hs_lock();
-    for (i = 0; ; i++) {
-        /* XXX: This is inefficient when there are a lot of connections.
-         * Consider using a "foreach" function to walk the connection list.
-         */
-        conn = ble_hs_conn_find_by_idx(i);
-        if (conn == NULL) {
-            break;
-        }
+    for (conn = ble_hs_conn_first();
+         conn != NULL;
+         conn = SLIST_NEXT(conn, bhc_next)) {
 
         BLE_HS_DBG_ASSERT_EVAL(conn->bhc_gatt_svr.num_clt_cfgs >
                                clt_cfg_idx);
@@ -1584,14 +1817,21 @@ ble_gatts_chr_updated(uint16_t chr_val_handle)
  * connected devices.  The bluetooth spec does not allow more than one
  * concurrent indication for a single peer, so this function will hold off on
  * sending such indications.
+ *
+ * The connection list is walked once with the host lock held to determine
+ * which peers need an update; the updates are then transmitted with the lock
+ * released.
  */
 static void
 ble_gatts_tx_notifications_one_chr(uint16_t chr_val_handle)
 {
+    uint16_t notify_conns[MYNEWT_VAL(BLE_MAX_CONNECTIONS)];
+    uint16_t indicate_conns[MYNEWT_VAL(BLE_MAX_CONNECTIONS)];
     struct ble_gatts_clt_cfg *clt_cfg;
     struct ble_hs_conn *conn;
-    uint16_t conn_handle;
     uint8_t att_op;
+    int num_notify;
+    int num_indicate;
     int clt_cfg_idx;
     int i;
 
@@ -1604,41 +1844,32 @@ ble_gatts_tx_notifications_one_chr(uint16_t chr_val_handle)
         return;
     }
 
-    for (i = 0; ; i++) {
-        ble_hs_lock();
-
-        conn = ble_hs_conn_find_by_idx(i);
-        if (conn != NULL) {
-            BLE_HS_DBG_ASSERT_EVAL(conn->bhc_gatt_svr.num_clt_cfgs >
-                                   clt_cfg_idx);
-            clt_cfg = conn->bhc_gatt_svr.clt_cfgs + clt_cfg_idx;
-            BLE_HS_DBG_ASSERT_EVAL(clt_cfg->chr_val_handle == chr_val_handle);
+    num_notify = 0;
+    num_indicate = 0;
 
-            /* Determine what type of command should get sent, if any. */
-            att_op = ble_gatts_schedule_update(conn, clt_cfg);
-            conn_handle = conn->bhc_handle;
-        } else {
-            /* Silence some spurious gcc warnings. */
-            att_op = 0;
-            conn_handle = BLE_HS_CONN_HANDLE_NONE;
-        }
-        ble_hs_unlock();
+    ble_hs_lock();
+    for (conn = ble_hs_conn_first();
+         conn != NULL &&
+         num_notify + num_indicate < MYNEWT_VAL(BLE_MAX_CONNECTIONS);
+         conn = SLIST_NEXT(conn, bhc_next)) {
 
-        if (conn == NULL) {
-            /* No more connected devices. */
-            break;
-        }
+        BLE_HS_DBG_ASSERT_EVAL(conn->bhc_gatt_svr.num_clt_cfgs >
+                               clt_cfg_idx);
+        clt_cfg = conn->bhc_gatt_svr.clt_cfgs + clt_cfg_idx;
+        BLE_HS_DBG_ASSERT_EVAL(clt_cfg->chr_val_handle == chr_val_handle);
 
+        /* Determine what type of command should get sent, if any. */
+        att_op = ble_gatts_schedule_update(conn, clt_cfg);
         switch (att_op) {
         case 0:
             break;
 
         case BLE_ATT_OP_NOTIFY_REQ:
-            ble_gattc_notify(conn_handle, chr_val_handle);
+            notify_conns[num_notify++] = conn->bhc_handle;
             break;
 
         case BLE_ATT_OP_INDICATE_REQ:
-            ble_gattc_indicate(conn_handle, chr_val_handle);
+            indicate_conns[num_indicate++] = conn->bhc_handle;
             break;
 
         default:
@@ -1646,8 +1877,63 @@ ble_gatts_tx_notifications_one_chr(uint16_t chr_val_handle)
             break;
         }
     }
+    ble_hs_unlock();
+
+    /* All notification subscribers share a single read of the value. */
+    if (num_notify > 0) {
+        ble_gattc_notify_multi(notify_conns, num_notify, chr_val_handle);
+    }
+
+    for (i = 0; i < num_indicate; i++) {
+        ble_gattc_indicate(indicate_conns[i], chr_val_handle);
+    }
 }
 
+#if MYNEWT_VAL(BLE_GATT_NOTIFY_MULTI)
+/**
+ * Sends the pending notifications of a peer which accepts multiple handle
+ * value notifications, batching them into as few PDUs as possible.
+ */
+static void
+ble_gatts_tx_notifications_one_conn(uint16_t conn_handle)
+{
+    struct ble_gatt_notif notifs[MYNEWT_VAL(BLE_GATT_NOTIFY_MULTI_MAX_ATTRS)];
+    struct ble_gatts_clt_cfg *clt_cfg;
+    struct ble_hs_conn *conn;
+    int num_notifs;
+    int i;
+
+    do {
+        num_notifs = 0;
+
+        ble_hs_lock();
+
+        conn = ble_hs_conn_find(conn_handle);
+        for (i = 0;
+             conn != NULL && i < conn->bhc_gatt_svr.num_clt_cfgs &&
+             num_notifs < MYNEWT_VAL(BLE_GATT_NOTIFY_MULTI_MAX_ATTRS);
+             i++) {
+
+            clt_cfg = conn->bhc_gatt_svr.clt_cfgs + i;
+            if ((clt_cfg->flags & BLE_GATTS_CLT_CFG_F_MODIFIED) &&
+                (clt_cfg->flags & BLE_GATTS_CLT_CFG_F_NOTIFY)) {
+
+                clt_cfg->flags &= ~BLE_GATTS_CLT_CFG_F_MODIFIED;
+                notifs[num_notifs].handle = clt_cfg->chr_val_handle;
+                notifs[num_notifs].value = NULL;
+                num_notifs++;
+            }
+        }
+
+        ble_hs_unlock();
+
+        if (num_notifs > 0) {
+            ble_gattc_notify_handles(conn_handle, notifs, num_notifs);
+        }
+    } while (num_notifs == MYNEWT_VAL(BLE_GATT_NOTIFY_MULTI_MAX_ATTRS));
+}
+#endif
+
 /**
  * Sends all pending notifications and indications.  The bluetooth spec does
  * not allow more than one concurrent indication for a single peer, so this
@@ -1656,9 +1942,39 @@ ble_gatts_tx_notifications_one_chr(uint16_t chr_val_handle)
 void
 ble_gatts_tx_notifications(void)
 {
+#if MYNEWT_VAL(BLE_GATT_NOTIFY_MULTI)
+    uint16_t conn_handles[MYNEWT_VAL(BLE_MAX_CONNECTIONS)];
+    struct ble_hs_conn *conn;
+    int num_conns;
+#endif
     uint16_t chr_val_handle;
     int i;
 
+#if MYNEWT_VAL(BLE_GATT_NOTIFY_MULTI)
+    /* Peers accepting multiple handle value notifications get all of their
+     * pending notifications batched first; the per-characteristic pass below
+     * takes care of everything else.
+     */
+    num_conns = 0;
+
+    ble_hs_lock();
+    for (conn = ble_hs_conn_first();
+         conn != NULL && num_conns < MYNEWT_VAL(BLE_MAX_CONNECTIONS);
+         conn = SLIST_NEXT(conn, bhc_next)) {
+
+        if (conn->bhc_gatt_svr.peer_cl_sup_feat[0] &
+            BLE_GATT_CLI_SUP_FEAT_MULT_NTF) {
+
+            conn_handles[num_conns++] = conn->bhc_handle;
+        }
+    }
+    ble_hs_unlock();
+
+    for (i = 0; i < num_conns; i++) {
+        ble_gatts_tx_notifications_one_conn(conn_handles[i]);
+    }
+#endif
+
     for (i = 0; i < ble_gatts_num_cfgable_chrs; i++) {
         chr_val_handle = ble_gatts_clt_cfgs[i].chr_val_handle;
         ble_gatts_tx_notifications_one_chr(chr_val_handle);
@@ -1704,11 +2020,15 @@ ble_gatts_bonding_established(uint16_t conn_handle)
     }
 
     ble_hs_unlock();
+
+    ble_gatts_peer_cl_sup_feat_persist(conn_handle);
 }
 
 /**
  * Called when bonding has been restored via the encryption procedure.  This
  * function:
+ *     o Restores the client supported features and robust caching state of
+ *       the connected peer.
  *     o Restores persisted CCCD entries for the connected peer.
  *     o Sends all pending notifications to the connected peer.
  *     o Sends up to one pending indication to the connected peer; schedules
@@ -1724,6 +2044,8 @@ ble_gatts_bonding_restored(uint16_t conn_handle)
     uint8_t att_op;
     int rc;
 
+    ble_gatts_peer_cl_sup_feat_restore(conn_handle);
+
     ble_hs_lock();
 
     conn = ble_hs_conn_find(conn_handle);
@@ -1949,6 +2271,222 @@ ble_gatts_find_dsc(const ble_uuid_t *svc_uuid, const ble_uuid_t *chr_uuid,
     }
 }
 
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+static int
+ble_gatts_db_hash_attr(struct tc_cmac_struct *cmac, uint16_t handle,
+                       uint16_t uuid16, int with_value)
+{
+    struct os_mbuf *om;
+    struct os_mbuf *cur;
+    uint8_t buf[4];
+    int rc;
+
+    put_le16(buf, handle);
+    put_le16(buf + 2, uuid16);
+    if (tc_cmac_update(cmac, buf, sizeof buf) == TC_CRYPTO_FAIL) {
+        return BLE_HS_EUNKNOWN;
+    }
+
+    if (!with_value) {
+        return 0;
+    }
+
+    om = ble_hs_mbuf_bare_pkt();
+    if (om == NULL) {
+        return BLE_HS_ENOMEM;
+    }
+
+    rc = ble_att_svr_read_handle(BLE_HS_CONN_HANDLE_NONE, handle, 0, om,
+                                 NULL);
+    for (cur = om; rc == 0 && cur != NULL; cur = SLIST_NEXT(cur, om_next)) {
+        if (tc_cmac_update(cmac, cur->om_data, cur->om_len) ==
+            TC_CRYPTO_FAIL) {
+            rc = BLE_HS_EUNKNOWN;
+        }
+    }
+
+    os_mbuf_free_chain(om);
+    return rc;
+}
+
+/**
+ * Calculates the Database Hash: an AES-CMAC with a zero key over the handle,
+ * type and (for declarations) value of every visible service, include,
+ * characteristic and descriptor attribute that defines the database layout.
+ */
+static int
+ble_gatts_db_hash_calc(uint8_t *out_hash)
+{
+    struct tc_aes_key_sched_struct sched;
+    struct ble_att_svr_entry *entry;
+    struct tc_cmac_struct cmac;
+    uint8_t key[16] = { 0 };
+    uint8_t hash[BLE_GATT_DB_HASH_SZ];
+    uint16_t last_handle;
+    uint16_t uuid16;
+    uint16_t handle;
+    int with_value;
+    int rc;
+
+    if (tc_cmac_setup(&cmac, key, &sched) == TC_CRYPTO_FAIL) {
+        return BLE_HS_EUNKNOWN;
+    }
+
+    last_handle = ble_att_svr_prev_handle();
+    for (handle = 1; handle != 0 && handle <= last_handle; handle++) {
+        entry = ble_att_svr_find_by_handle(handle);
+        if (entry == NULL) {
+            /* Hidden attributes are not part of the database. */
+            continue;
+        }
+
+        uuid16 = ble_uuid_u16(entry->ha_uuid);
+        switch (uuid16) {
+        case BLE_ATT_UUID_PRIMARY_SERVICE:
+        case BLE_ATT_UUID_SECONDARY_SERVICE:
+        case BLE_ATT_UUID_INCLUDE:
+        case BLE_ATT_UUID_CHARACTERISTIC:
+        case BLE_GATTS_DSC_EXT_PROP_UUID16:
+            with_value = 1;
+            break;
+
+        case BLE_GATTS_DSC_USER_DESC_UUID16:
+        case BLE_GATT_DSC_CLT_CFG_UUID16:
+        case BLE_GATTS_DSC_SVR_CFG_UUID16:
+        case BLE_GATTS_DSC_PRES_FMT_UUID16:
+        case BLE_GATTS_DSC_AGG_FMT_UUID16:
+            with_value = 0;
+            break;
+
+        default:
+            continue;
+        }
+
+        rc = ble_gatts_db_hash_attr(&cmac, handle, uuid16, with_value);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    if (tc_cmac_final(hash, &cmac) == TC_CRYPTO_FAIL) {
+        return BLE_HS_EUNKNOWN;
+    }
+
+    /* The CMAC is big-endian; the characteristic value is little-endian. */
+    swap_buf(out_hash, hash, sizeof hash);
+
+    return 0;
+}
+#endif
+
+int
+ble_gatts_db_hash(uint8_t *out_hash)
+{
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+    int rc;
+
+    if (!ble_gatts_db_hash_valid) {
+        rc = ble_gatts_db_hash_calc(ble_gatts_db_hash_val);
+        if (rc != 0) {
+            return rc;
+        }
+        ble_gatts_db_hash_valid = 1;
+    }
+
+    memcpy(out_hash, ble_gatts_db_hash_val, sizeof ble_gatts_db_hash_val);
+    return 0;
+#else
+    return BLE_HS_ENOTSUP;
+#endif
+}
+
+/**
+ * Called after the set of visible attributes changed at runtime.  Clients
+ * using robust caching become change-unaware until they learn about the
+ * change.
+ */
+static void
+ble_gatts_db_changed(void)
+{
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+    struct ble_hs_conn *conn;
+
+    ble_gatts_db_hash_valid = 0;
+
+    ble_hs_lock();
+
+    for (conn = ble_hs_conn_first();
+         conn != NULL;
+         conn = SLIST_NEXT(conn, bhc_next)) {
+
+        if (conn->bhc_gatt_svr.peer_cl_sup_feat[0] &
+            BLE_GATT_CLI_SUP_FEAT_ROBUST_CACHING) {
+
+            conn->bhc_gatt_svr.flags |= BLE_GATTS_CONN_F_CHANGE_UNAWARE;
+            conn->bhc_gatt_svr.flags &= ~BLE_GATTS_CONN_F_AWARE_PENDING;
+        }
+    }
+
+    ble_hs_unlock();
+#endif
+}
+
+/**
+ * Advances the robust caching state of a peer on receipt of an ATT request
+ * or command that depends on the database layout.
+ *
+ * A change-unaware peer has its commands dropped.  Its first request gets
+ * rejected with a Database Out Of Sync error, unless it is a read of the
+ * Database Hash; either way the peer is considered change-aware from its
+ * following request on.
+ *
+ * @param conn_handle           The connection the PDU was received on.
+ * @param is_req                Whether the PDU is a request (vs. command).
+ * @param is_hash_read          Whether the PDU reads the Database Hash.
+ *
+ * @return                      1 if the PDU should be processed;
+ *                              0 if it should be rejected.
+ */
+int
+ble_gatts_peer_change_aware(uint16_t conn_handle, int is_req,
+                            int is_hash_read)
+{
+    struct ble_gatts_conn *gatt_svr;
+    struct ble_hs_conn *conn;
+    int became_aware;
+    int aware;
+
+    became_aware = 0;
+    aware = 1;
+
+    ble_hs_lock();
+
+    conn = ble_hs_conn_find(conn_handle);
+    if (conn != NULL) {
+        gatt_svr = &conn->bhc_gatt_svr;
+        if (gatt_svr->flags & BLE_GATTS_CONN_F_CHANGE_UNAWARE) {
+            if (!is_req) {
+                aware = 0;
+            } else if (gatt_svr->flags & BLE_GATTS_CONN_F_AWARE_PENDING) {
+                gatt_svr->flags &= ~(BLE_GATTS_CONN_F_CHANGE_UNAWARE |
+                                     BLE_GATTS_CONN_F_AWARE_PENDING);
+                became_aware = 1;
+            } else {
+                gatt_svr->flags |= BLE_GATTS_CONN_F_AWARE_PENDING;
+                aware = is_hash_read;
+            }
+        }
+    }
+
+    ble_hs_unlock();
+
+    if (became_aware) {
+        ble_gatts_peer_cl_sup_feat_persist(conn_handle);
+    }
+
+    return aware;
+}
+
 int
 ble_gatts_add_svcs(const struct ble_gatt_svc_def *svcs)
 {
@@ -1993,6 +2531,7 @@ ble_gatts_svc_set_visibility(uint16_t handle, int visible)
             } else {
                 ble_att_svr_hide_range(entry->handle, entry->end_group_handle);
             }
+            ble_gatts_db_changed();
             return 0;
         }
     }
@@ -2154,6 +2693,9 @@ ble_gatts_reset(void)
         /* Unregister all ATT attributes. */
         ble_att_svr_reset();
         ble_gatts_num_cfgable_chrs = 0;
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+        ble_gatts_db_hash_valid = 0;
+#endif
         rc = 0;
 
         /* Note: gatts memory gets freed on next call to ble_gatts_start(). */
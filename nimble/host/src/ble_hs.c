@@ -75,6 +75,11 @@ static struct ble_npl_eventq *ble_hs_evq;
 
 static struct ble_mqueue ble_hs_rx_q;
 
+/** Connection that gets the first turn the next time the tx queues are
+ * serviced.
+ */
+static uint16_t ble_hs_wakeup_tx_next = BLE_HS_CONN_HANDLE_NONE;
+
 static struct ble_npl_mutex ble_hs_mutex;
 
 /** These values keep track of required ATT and GATT resources counts.  They
@@ -102,6 +107,11 @@ STATS_NAME_START(ble_hs_stats)
     STATS_NAME(ble_hs_stats, sync)
     STATS_NAME(ble_hs_stats, pvcy_add_entry)
     STATS_NAME(ble_hs_stats, pvcy_add_entry_fail)
+    STATS_NAME(ble_hs_stats, tx_queued)
+    STATS_NAME(ble_hs_stats, startup_warm)
+    STATS_NAME(ble_hs_stats, startup_reset_ms)
+    STATS_NAME(ble_hs_stats, startup_ver_ms)
+    STATS_NAME(ble_hs_stats, startup_cfg_ms)
 STATS_NAME_END(ble_hs_stats)
 
 struct ble_npl_eventq *
@@ -228,25 +238,97 @@ ble_hs_process_rx_data_queue(void)
     }
 }
 
+/**
+ * Transmits the packet at the head of the specified connection's tx queue.
+ *
+ * @return                      0 if the packet was sent in its entirety;
+ *                              BLE_HS_EAGAIN if the controller is at capacity.
+ */
 static int
-ble_hs_wakeup_tx_conn(struct ble_hs_conn *conn)
+ble_hs_wakeup_tx_pkt(struct ble_hs_conn *conn)
 {
-    struct os_mbuf_pkthdr *omp;
+    ble_npl_time_t head_time;
     struct os_mbuf *om;
     int rc;
 
-    while ((omp = STAILQ_FIRST(&conn->bhc_tx_q)) != NULL) {
-        STAILQ_REMOVE_HEAD(&conn->bhc_tx_q, omp_next);
-
-        om = OS_MBUF_PKTHDR_TO_MBUF(omp);
-        rc = ble_hs_hci_acl_tx_now(conn, &om);
-        if (rc == BLE_HS_EAGAIN) {
-            /* Controller is at capacity.  This packet will be the first to
-             * get transmitted next time around.
-             */
-            STAILQ_INSERT_HEAD(&conn->bhc_tx_q, OS_MBUF_PKTHDR(om), omp_next);
-            return BLE_HS_EAGAIN;
+    om = ble_hs_conn_tx_dequeue(conn, &head_time);
+    BLE_HS_DBG_ASSERT(om != NULL);
+
+    rc = ble_hs_hci_acl_tx_now(conn, &om);
+    if (rc == BLE_HS_EAGAIN) {
+        /* Controller is at capacity.  This packet will be the first to get
+         * transmitted next time around.
+         */
+        ble_hs_conn_tx_requeue(conn, om, head_time);
+        return BLE_HS_EAGAIN;
+    }
+
+    return 0;
+}
+
+/**
+ * Calculates the number of controller buffers needed to transmit the packet
+ * at the head of the specified connection's tx queue.
+ */
+static uint16_t
+ble_hs_wakeup_tx_cost(const struct ble_hs_conn *conn)
+{
+#if MYNEWT_VAL(BLE_HS_TX_SCHED_WEIGHTED)
+    const struct os_mbuf_pkthdr *omp;
+    uint16_t frag_sz;
+
+    omp = STAILQ_FIRST(&conn->bhc_tx_q);
+    frag_sz = ble_hs_hci_max_acl_payload_sz();
+    if (frag_sz == 0) {
+        return 1;
+    }
+
+    return (omp->omp_len + frag_sz - 1) / frag_sz;
+#else
+    /* Plain round-robin; every packet costs a single turn. */
+    return 1;
+#endif
+}
+
+/**
+ * Gives the specified connection its turn in the current scheduling round.
+ *
+ * @return                      0 if the connection used up its turn;
+ *                              BLE_HS_EAGAIN if the controller is at capacity.
+ */
+static int
+ble_hs_wakeup_tx_conn(struct ble_hs_conn *conn)
+{
+    uint16_t cost;
+    int rc;
+
+    if (STAILQ_EMPTY(&conn->bhc_tx_q)) {
+        conn->bhc_tx_deficit = 0;
+        return 0;
+    }
+
+#if MYNEWT_VAL(BLE_HS_TX_SCHED_WEIGHTED)
+    conn->bhc_tx_deficit += conn->bhc_tx_weight;
+#else
+    conn->bhc_tx_deficit = 1;
+#endif
+
+    while (!STAILQ_EMPTY(&conn->bhc_tx_q)) {
+        cost = ble_hs_wakeup_tx_cost(conn);
+        if (cost > conn->bhc_tx_deficit) {
+            break;
+        }
+
+        rc = ble_hs_wakeup_tx_pkt(conn);
+        if (rc != 0) {
+            return rc;
         }
+
+        conn->bhc_tx_deficit -= cost;
+    }
+
+    if (STAILQ_EMPTY(&conn->bhc_tx_q)) {
+        conn->bhc_tx_deficit = 0;
     }
 
     return 0;
@@ -254,11 +336,16 @@ ble_hs_wakeup_tx_conn(struct ble_hs_conn *conn)
 
 /**
  * Schedules the transmission of all queued ACL data packets to the controller.
+ * Controller buffers are distributed among connections in rounds so that a
+ * single busy connection cannot starve the others; see
+ * BLE_HS_TX_SCHED_WEIGHTED for the available policies.
  */
 void
 ble_hs_wakeup_tx(void)
 {
+    struct ble_hs_conn *start;
     struct ble_hs_conn *conn;
+    int pending;
     int rc;
 
     ble_hs_lock();
@@ -272,26 +359,70 @@ ble_hs_wakeup_tx(void)
          conn = SLIST_NEXT(conn, bhc_next)) {
 
         if (conn->bhc_flags & BLE_HS_CONN_F_TX_FRAG) {
-            rc = ble_hs_wakeup_tx_conn(conn);
-            if (rc != 0) {
-                goto done;
+            if (!STAILQ_EMPTY(&conn->bhc_tx_q)) {
+                rc = ble_hs_wakeup_tx_pkt(conn);
+                if (rc != 0) {
+                    goto done;
+                }
             }
             break;
         }
     }
 
-    /* For each connection, transmit queued packets until there are no more
-     * packets to send or the controller's buffers are exhausted.
+    /* Resume the round where the previous call left off. */
+    start = NULL;
+    if (ble_hs_wakeup_tx_next != BLE_HS_CONN_HANDLE_NONE) {
+        start = ble_hs_conn_find(ble_hs_wakeup_tx_next);
+    }
+    if (start == NULL) {
+        start = ble_hs_conn_first();
+    }
+
+    /* Give each connection with queued packets a turn until there are no more
+     * packets to send or the controller's buffers are exhausted.  A round
+     * starts where the previous one was cut short.
      */
-    for (conn = ble_hs_conn_first();
-         conn != NULL;
-         conn = SLIST_NEXT(conn, bhc_next)) {
+    do {
+        pending = 0;
 
-        rc = ble_hs_wakeup_tx_conn(conn);
-        if (rc != 0) {
-            goto done;
+        conn = start;
+        while (conn != NULL) {
+            if (ble_hs_hci_avail_pkts == 0 &&
+                !STAILQ_EMPTY(&conn->bhc_tx_q)) {
+
+                /* Out of buffers; this connection gets the next turn. */
+                ble_hs_wakeup_tx_next = conn->bhc_handle;
+                goto done;
+            }
+
+            rc = ble_hs_wakeup_tx_conn(conn);
+            if (rc != 0) {
+                /* The partially sent packet gets completed first next time;
+                 * the following connection gets the next turn.
+                 */
+                conn = SLIST_NEXT(conn, bhc_next);
+                if (conn == NULL) {
+                    conn = ble_hs_conn_first();
+                }
+                ble_hs_wakeup_tx_next = conn->bhc_handle;
+                goto done;
+            }
+
+            if (!STAILQ_EMPTY(&conn->bhc_tx_q)) {
+                pending = 1;
+            }
+
+            conn = SLIST_NEXT(conn, bhc_next);
+            if (conn == NULL) {
+                conn = ble_hs_conn_first();
+            }
+            if (conn == start) {
+                break;
+            }
         }
-    }
+    } while (pending && ble_hs_hci_avail_pkts > 0);
+
+    ble_hs_wakeup_tx_next = BLE_HS_CONN_HANDLE_NONE;
 
 done:
     ble_hs_unlock();
@@ -372,6 +503,7 @@ ble_hs_reset(void)
      * again when it fails to sync with the controller.
      */
     (void)ble_hci_trans_reset();
+    ble_hs_hci_cmd_reset();
 
     ble_hs_clear_rx_queue();
 
@@ -651,6 +783,9 @@ ble_hs_start(void)
         return rc;
     }
 
+    /* Controller information cached by a previous run may be stale. */
+    ble_hs_startup_cache_clear();
+
     ble_hs_sync();
 
     return 0;
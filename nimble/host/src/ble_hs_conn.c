@@ -27,9 +27,37 @@
 /** At least three channels required per connection (sig, att, sm). */
 #define BLE_HS_CONN_MIN_CHANS       3
 
-static SLIST_HEAD(, ble_hs_conn) ble_hs_conns;
+/** Default share of controller buffers; see ble_gap_set_tx_weight(). */
+#define BLE_HS_CONN_TX_WEIGHT_DFLT  1
+
+/**
+ * Number of buckets in each connection lookup table.  Controllers typically
+ * assign connection handles sequentially, so with one bucket per connection
+ * the handle table usually behaves as a direct map.
+ */
+#define BLE_HS_CONN_TBL_SZ                              \
+    (MYNEWT_VAL(BLE_MAX_CONNECTIONS) > 0 ?              \
+     MYNEWT_VAL(BLE_MAX_CONNECTIONS) : 1)
+
+/** Indicates a connection is not linked into an address table. */
+#define BLE_HS_CONN_BUCKET_NONE     0xffff
+
+SLIST_HEAD(ble_hs_conn_list, ble_hs_conn);
+
+static struct ble_hs_conn_list ble_hs_conns;
 static struct os_mempool ble_hs_conn_pool;
 
+/**
+ * Connection lookup tables.  Every connection in ble_hs_conns is also linked
+ * into the handle table and the peer address table; connections with a known
+ * peer RPA are additionally linked into the RPA table.  The address tables are
+ * keyed on the address value only, so identity address lookups land in the
+ * same bucket regardless of the address type.
+ */
+static struct ble_hs_conn_list ble_hs_conn_handle_tbl[BLE_HS_CONN_TBL_SZ];
+static struct ble_hs_conn_list ble_hs_conn_addr_tbl[BLE_HS_CONN_TBL_SZ];
+static struct ble_hs_conn_list ble_hs_conn_rpa_tbl[BLE_HS_CONN_TBL_SZ];
+
 static os_membuf_t ble_hs_conn_elem_mem[
     OS_MEMPOOL_SIZE(MYNEWT_VAL(BLE_MAX_CONNECTIONS),
                     sizeof (struct ble_hs_conn))
@@ -37,6 +65,55 @@ static os_membuf_t ble_hs_conn_elem_mem[
 
 static const uint8_t ble_hs_conn_null_addr[6];
 
+static uint16_t
+ble_hs_conn_handle_bucket(uint16_t conn_handle)
+{
+    return conn_handle % BLE_HS_CONN_TBL_SZ;
+}
+
+static uint16_t
+ble_hs_conn_addr_bucket(const uint8_t *val)
+{
+    uint32_t hash;
+    int i;
+
+    hash = 0;
+    for (i = 0; i < 6; i++) {
+        hash = hash * 31 + val[i];
+    }
+
+    return hash % BLE_HS_CONN_TBL_SZ;
+}
+
+static void
+ble_hs_conn_addr_link(struct ble_hs_conn *conn)
+{
+    conn->bhc_addr_bucket = ble_hs_conn_addr_bucket(conn->bhc_peer_addr.val);
+    SLIST_INSERT_HEAD(&ble_hs_conn_addr_tbl[conn->bhc_addr_bucket], conn,
+                      bhc_addr_next);
+
+    if (memcmp(conn->bhc_peer_rpa_addr.val, ble_hs_conn_null_addr, 6) == 0) {
+        conn->bhc_rpa_bucket = BLE_HS_CONN_BUCKET_NONE;
+    } else {
+        conn->bhc_rpa_bucket =
+            ble_hs_conn_addr_bucket(conn->bhc_peer_rpa_addr.val);
+        SLIST_INSERT_HEAD(&ble_hs_conn_rpa_tbl[conn->bhc_rpa_bucket], conn,
+                          bhc_rpa_next);
+    }
+}
+
+static void
+ble_hs_conn_addr_unlink(struct ble_hs_conn *conn)
+{
+    SLIST_REMOVE(&ble_hs_conn_addr_tbl[conn->bhc_addr_bucket], conn,
+                 ble_hs_conn, bhc_addr_next);
+
+    if (conn->bhc_rpa_bucket != BLE_HS_CONN_BUCKET_NONE) {
+        SLIST_REMOVE(&ble_hs_conn_rpa_tbl[conn->bhc_rpa_bucket], conn,
+                     ble_hs_conn, bhc_rpa_next);
+    }
+}
+
 int
 ble_hs_conn_can_alloc(void)
 {
@@ -193,6 +270,7 @@ ble_hs_conn_alloc(uint16_t conn_handle)
     }
 
     STAILQ_INIT(&conn->bhc_tx_q);
+    conn->bhc_tx_weight = BLE_HS_CONN_TX_WEIGHT_DFLT;
 
     STATS_INC(ble_hs_stats, conn_create);
 
@@ -214,6 +292,80 @@ ble_hs_conn_delete_chan(struct ble_hs_conn *conn, struct ble_l2cap_chan *chan)
     ble_l2cap_chan_free(conn, chan);
 }
 
+/**
+ * Appends a packet that could not be sent to the connection's tx queue.
+ */
+void
+ble_hs_conn_tx_enqueue(struct ble_hs_conn *conn, struct os_mbuf *om)
+{
+    BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
+
+    if (STAILQ_EMPTY(&conn->bhc_tx_q)) {
+        conn->bhc_tx_q_head_time = ble_npl_time_get();
+    }
+
+    STAILQ_INSERT_TAIL(&conn->bhc_tx_q, OS_MBUF_PKTHDR(om), omp_next);
+
+    conn->bhc_tx_q_len++;
+    if (conn->bhc_tx_q_len > conn->bhc_tx_q_len_max) {
+        conn->bhc_tx_q_len_max = conn->bhc_tx_q_len;
+    }
+
+    STATS_INC(ble_hs_stats, tx_queued);
+}
+
+/**
+ * Puts a packet that was removed with ble_hs_conn_tx_dequeue() back at the
+ * head of the connection's tx queue.  head_time is the value reported by
+ * that call, so the packet's wait keeps counting from when it first reached
+ * the queue head.
+ */
+void
+ble_hs_conn_tx_requeue(struct ble_hs_conn *conn, struct os_mbuf *om,
+                       ble_npl_time_t head_time)
+{
+    BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
+
+    STAILQ_INSERT_HEAD(&conn->bhc_tx_q, OS_MBUF_PKTHDR(om), omp_next);
+    conn->bhc_tx_q_len++;
+    conn->bhc_tx_q_head_time = head_time;
+}
+
+/**
+ * Removes the packet at the head of the connection's tx queue and records how
+ * long it waited there.
+ *
+ * @param out_head_time         On success, the time the packet reached the
+ *                                  queue head; pass it to
+ *                                  ble_hs_conn_tx_requeue() if the packet
+ *                                  goes back.
+ */
+struct os_mbuf *
+ble_hs_conn_tx_dequeue(struct ble_hs_conn *conn, ble_npl_time_t *out_head_time)
+{
+    struct os_mbuf_pkthdr *omp;
+    ble_npl_time_t now;
+
+    BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
+
+    omp = STAILQ_FIRST(&conn->bhc_tx_q);
+    if (omp == NULL) {
+        return NULL;
+    }
+
+    STAILQ_REMOVE_HEAD(&conn->bhc_tx_q, omp_next);
+    conn->bhc_tx_q_len--;
+
+    now = ble_npl_time_get();
+    *out_head_time = conn->bhc_tx_q_head_time;
+    if (now - conn->bhc_tx_q_head_time > conn->bhc_tx_wait_max) {
+        conn->bhc_tx_wait_max = now - conn->bhc_tx_q_head_time;
+    }
+    conn->bhc_tx_q_head_time = now;
+
+    return OS_MBUF_PKTHDR_TO_MBUF(omp);
+}
+
 void
 ble_hs_conn_foreach(ble_hs_conn_foreach_fn *cb, void *arg)
 {
@@ -274,6 +426,10 @@ ble_hs_conn_insert(struct ble_hs_conn *conn)
 
     BLE_HS_DBG_ASSERT_EVAL(ble_hs_conn_find(conn->bhc_handle) == NULL);
     SLIST_INSERT_HEAD(&ble_hs_conns, conn, bhc_next);
+    SLIST_INSERT_HEAD(
+        &ble_hs_conn_handle_tbl[ble_hs_conn_handle_bucket(conn->bhc_handle)],
+        conn, bhc_handle_next);
+    ble_hs_conn_addr_link(conn);
 }
 
 void
@@ -286,6 +442,27 @@ ble_hs_conn_remove(struct ble_hs_conn *conn)
     BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
 
     SLIST_REMOVE(&ble_hs_conns, conn, ble_hs_conn, bhc_next);
+    SLIST_REMOVE(
+        &ble_hs_conn_handle_tbl[ble_hs_conn_handle_bucket(conn->bhc_handle)],
+        conn, ble_hs_conn, bhc_handle_next);
+    ble_hs_conn_addr_unlink(conn);
+}
+
+/**
+ * Re-indexes a connection after its peer address or peer RPA has been
+ * modified.  Must be called for connections that have already been inserted.
+ */
+void
+ble_hs_conn_peer_addr_updated(struct ble_hs_conn *conn)
+{
+#if !NIMBLE_BLE_CONNECT
+    return;
+#endif
+
+    BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
+
+    ble_hs_conn_addr_unlink(conn);
+    ble_hs_conn_addr_link(conn);
 }
 
 struct ble_hs_conn *
@@ -299,7 +476,9 @@ ble_hs_conn_find(uint16_t conn_handle)
 
     BLE_HS_DBG_ASSERT(ble_hs_locked_by_cur_task());
 
-    SLIST_FOREACH(conn, &ble_hs_conns, bhc_next) {
+    SLIST_FOREACH(conn,
+                  &ble_hs_conn_handle_tbl[ble_hs_conn_handle_bucket(conn_handle)],
+                  bhc_handle_next) {
         if (conn->bhc_handle == conn_handle) {
             return conn;
         }
@@ -335,23 +514,31 @@ ble_hs_conn_find_by_addr(const ble_addr_t *addr)
         return NULL;
     }
 
-    SLIST_FOREACH(conn, &ble_hs_conns, bhc_next) {
-        if (BLE_ADDR_IS_RPA(addr)) {
+    if (BLE_ADDR_IS_RPA(addr)) {
+        SLIST_FOREACH(conn,
+                      &ble_hs_conn_rpa_tbl[ble_hs_conn_addr_bucket(addr->val)],
+                      bhc_rpa_next) {
             if (ble_addr_cmp(&conn->bhc_peer_rpa_addr, addr) == 0) {
                 return conn;
             }
-        } else {
-            if (ble_addr_cmp(&conn->bhc_peer_addr, addr) == 0) {
-                return conn;
-            }
-            if (conn->bhc_peer_addr.type < BLE_OWN_ADDR_RPA_PUBLIC_DEFAULT) {
-                continue;
-            }
-            /*If type 0x02 or 0x03 is used, let's double check if address is good */
-            ble_hs_conn_addrs(conn, &addrs);
-            if (ble_addr_cmp(&addrs.peer_id_addr, addr) == 0) {
-                return conn;
-            }
+        }
+
+        return NULL;
+    }
+
+    SLIST_FOREACH(conn,
+                  &ble_hs_conn_addr_tbl[ble_hs_conn_addr_bucket(addr->val)],
+                  bhc_addr_next) {
+        if (ble_addr_cmp(&conn->bhc_peer_addr, addr) == 0) {
+            return conn;
+        }
+        if (conn->bhc_peer_addr.type < BLE_OWN_ADDR_RPA_PUBLIC_DEFAULT) {
+            continue;
+        }
+        /*If type 0x02 or 0x03 is used, let's double check if address is good */
+        ble_hs_conn_addrs(conn, &addrs);
+        if (ble_addr_cmp(&addrs.peer_id_addr, addr) == 0) {
+            return conn;
         }
     }
 
@@ -562,6 +749,7 @@ int
 ble_hs_conn_init(void)
 {
     int rc;
+    int i;
 
     rc = os_mempool_init(&ble_hs_conn_pool, MYNEWT_VAL(BLE_MAX_CONNECTIONS),
                          sizeof (struct ble_hs_conn),
@@ -572,5 +760,11 @@ ble_hs_conn_init(void)
 
     SLIST_INIT(&ble_hs_conns);
 
+    for (i = 0; i < BLE_HS_CONN_TBL_SZ; i++) {
+        SLIST_INIT(&ble_hs_conn_handle_tbl[i]);
+        SLIST_INIT(&ble_hs_conn_addr_tbl[i]);
+        SLIST_INIT(&ble_hs_conn_rpa_tbl[i]);
+    }
+
     return 0;
 }
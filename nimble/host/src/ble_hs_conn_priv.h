@@ -49,6 +49,14 @@ typedef uint8_t ble_hs_conn_flags_t;
 
 struct ble_hs_conn {
     SLIST_ENTRY(ble_hs_conn) bhc_next;
+
+    /** Lookup table links; see ble_hs_conn.c. */
+    SLIST_ENTRY(ble_hs_conn) bhc_handle_next;
+    SLIST_ENTRY(ble_hs_conn) bhc_addr_next;
+    SLIST_ENTRY(ble_hs_conn) bhc_rpa_next;
+    uint16_t bhc_addr_bucket;
+    uint16_t bhc_rpa_bucket;
+
     uint16_t bhc_handle;
     uint8_t bhc_our_addr_type;
 #if MYNEWT_VAL(BLE_EXT_ADV)
@@ -91,8 +99,24 @@ struct ble_hs_conn {
     /** Queue of outgoing packets that could not be sent. */
     STAILQ_HEAD(, os_mbuf_pkthdr) bhc_tx_q;
 
+    /** TX scheduler state; see ble_hs_wakeup_tx(). */
+    uint8_t bhc_tx_weight;
+    uint16_t bhc_tx_deficit;
+
+    /** TX queue statistics. */
+    uint16_t bhc_tx_q_len;
+    uint16_t bhc_tx_q_len_max;
+    ble_npl_time_t bhc_tx_q_head_time;
+    ble_npl_time_t bhc_tx_wait_max;
+
     struct ble_att_svr_conn bhc_att_svr;
     struct ble_gatts_conn bhc_gatt_svr;
+#if MYNEWT_VAL(BLE_GATT_CACHING)
+    struct ble_gattc_cache_conn bhc_gattc_cache;
+#endif
+#if MYNEWT_VAL(BLE_GATT_DISC_DB)
+    struct ble_gattc_disc_db_conn bhc_gattc_disc_db;
+#endif
 
     struct ble_gap_sec_state bhc_sec_state;
 
@@ -122,6 +146,12 @@ struct ble_hs_conn *ble_hs_conn_find_by_addr(const ble_addr_t *addr);
 struct ble_hs_conn *ble_hs_conn_find_by_idx(int idx);
 int ble_hs_conn_exists(uint16_t conn_handle);
 struct ble_hs_conn *ble_hs_conn_first(void);
+void ble_hs_conn_peer_addr_updated(struct ble_hs_conn *conn);
+void ble_hs_conn_tx_enqueue(struct ble_hs_conn *conn, struct os_mbuf *om);
+void ble_hs_conn_tx_requeue(struct ble_hs_conn *conn, struct os_mbuf *om,
+                            ble_npl_time_t head_time);
+struct os_mbuf *ble_hs_conn_tx_dequeue(struct ble_hs_conn *conn,
+                                       ble_npl_time_t *out_head_time);
 struct ble_l2cap_chan *ble_hs_conn_chan_find_by_scid(struct ble_hs_conn *conn,
                                              uint16_t cid);
 struct ble_l2cap_chan *ble_hs_conn_chan_find_by_dcid(struct ble_hs_conn *conn,
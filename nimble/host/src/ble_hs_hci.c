@@ -33,6 +33,27 @@ static struct ble_npl_mutex ble_hs_hci_mutex;
 static struct ble_npl_sem ble_hs_hci_sem;
 
 static struct ble_hci_ev *ble_hs_hci_ack;
+
+/**
+ * Acknowledgements received from the controller that have not been processed
+ * yet.  Up to BLE_HS_HCI_CMD_MAX_INFLIGHT commands can be outstanding, so
+ * that many acks may be pending at once.  The queue is filled from the
+ * transport's context, so it is protected with a critical section.
+ */
+static struct ble_hci_ev *
+ble_hs_hci_ack_q[MYNEWT_VAL(BLE_HS_HCI_CMD_MAX_INFLIGHT)];
+static uint8_t ble_hs_hci_ack_q_head;
+static uint8_t ble_hs_hci_ack_q_len;
+
+/** Number of sent commands whose ack has not been received yet. */
+static uint8_t ble_hs_hci_ack_expected;
+
+/**
+ * Number of commands the controller is currently willing to accept, as
+ * reported in the Num_HCI_Command_Packets field of its most recent ack.
+ */
+static uint8_t ble_hs_hci_cmd_credits;
+
 static uint16_t ble_hs_hci_buf_sz;
 static uint8_t ble_hs_hci_max_pkts;
 
@@ -149,7 +170,7 @@ ble_hs_hci_rx_cmd_complete(const void *data, int len,
             return BLE_HS_ECONTROLLER;
         }
 
-        /* TODO Process num_pkts field. */
+        ble_hs_hci_cmd_credits = nop->num_packets;
 
         out_ack->bha_status = 0;
         out_ack->bha_params = NULL;
@@ -159,7 +180,7 @@ ble_hs_hci_rx_cmd_complete(const void *data, int len,
 
     opcode = le16toh(ev->opcode);
 
-    /* TODO Process num_pkts field. */
+    ble_hs_hci_cmd_credits = ev->num_packets;
 
     out_ack->bha_opcode = opcode;
 
@@ -184,7 +205,7 @@ ble_hs_hci_rx_cmd_status(const void *data, int len,
         return BLE_HS_ECONTROLLER;
     }
 
-    /* XXX: Process num_pkts field. */
+    ble_hs_hci_cmd_credits = ev->num_packets;
 
     out_ack->bha_opcode = le16toh(ev->opcode);
     out_ack->bha_params = NULL;
@@ -251,11 +272,84 @@ ble_hs_hci_process_ack(uint16_t expected_opcode,
     return rc;
 }
 
+/**
+ * Discards all pending acknowledgements and forgets about outstanding
+ * commands.  Called when the host gives up on the controller; any ack that
+ * arrives afterwards is ignored.
+ */
+static void
+ble_hs_hci_ack_q_clear(void)
+{
+    struct ble_hci_ev *ack;
+    uint32_t sr;
+
+    for (;;) {
+        sr = ble_npl_hw_enter_critical();
+        ble_hs_hci_ack_expected = 0;
+        if (ble_hs_hci_ack_q_len == 0) {
+            ack = NULL;
+        } else {
+            ack = ble_hs_hci_ack_q[ble_hs_hci_ack_q_head];
+            ble_hs_hci_ack_q_head = (ble_hs_hci_ack_q_head + 1) %
+                                    MYNEWT_VAL(BLE_HS_HCI_CMD_MAX_INFLIGHT);
+            ble_hs_hci_ack_q_len--;
+        }
+        ble_npl_hw_exit_critical(sr);
+
+        if (ack == NULL) {
+            break;
+        }
+
+        /* Consume the semaphore token that accompanied this ack. */
+        ble_npl_sem_pend(&ble_hs_hci_sem, 0);
+        ble_hci_trans_buf_free((uint8_t *)ack);
+    }
+}
+
+/**
+ * Resets the command flow control state.  After a reset the controller is
+ * guaranteed to accept a single command.
+ */
+void
+ble_hs_hci_cmd_reset(void)
+{
+    ble_hs_hci_ack_q_clear();
+    ble_hs_hci_cmd_credits = 1;
+}
+
+static int
+ble_hs_hci_cmd_send_counted(uint16_t opcode, const void *cmd, uint8_t cmd_len)
+{
+    uint32_t sr;
+    int rc;
+
+    sr = ble_npl_hw_enter_critical();
+    ble_hs_hci_ack_expected++;
+    ble_npl_hw_exit_critical(sr);
+
+    rc = ble_hs_hci_cmd_send_buf(opcode, cmd, cmd_len);
+    if (rc != 0) {
+        sr = ble_npl_hw_enter_critical();
+        ble_hs_hci_ack_expected--;
+        ble_npl_hw_exit_critical(sr);
+        return rc;
+    }
+
+    if (ble_hs_hci_cmd_credits > 0) {
+        ble_hs_hci_cmd_credits--;
+    }
+
+    return 0;
+}
+
 static int
 ble_hs_hci_wait_for_ack(void)
 {
+    uint32_t sr;
     int rc;
 
+    BLE_HS_DBG_ASSERT(ble_hs_hci_ack == NULL);
+
 #if MYNEWT_VAL(BLE_HS_PHONY_HCI_ACKS)
     if (ble_hs_hci_phony_ack_cb == NULL) {
         rc = BLE_HS_ETIMEOUT_HCI;
@@ -264,12 +358,23 @@ ble_hs_hci_wait_for_ack(void)
             (void *) ble_hci_trans_buf_alloc(BLE_HCI_TRANS_BUF_CMD);
         BLE_HS_DBG_ASSERT(ble_hs_hci_ack != NULL);
         rc = ble_hs_hci_phony_ack_cb((void *)ble_hs_hci_ack, 260);
+        if (rc == 0 && ble_hs_hci_ack_expected > 0) {
+            ble_hs_hci_ack_expected--;
+        }
     }
 #else
     rc = ble_npl_sem_pend(&ble_hs_hci_sem,
                           ble_npl_time_ms_to_ticks32(BLE_HCI_CMD_TIMEOUT_MS));
     switch (rc) {
     case 0:
+        sr = ble_npl_hw_enter_critical();
+        BLE_HS_DBG_ASSERT(ble_hs_hci_ack_q_len > 0);
+        ble_hs_hci_ack = ble_hs_hci_ack_q[ble_hs_hci_ack_q_head];
+        ble_hs_hci_ack_q_head = (ble_hs_hci_ack_q_head + 1) %
+                                MYNEWT_VAL(BLE_HS_HCI_CMD_MAX_INFLIGHT);
+        ble_hs_hci_ack_q_len--;
+        ble_npl_hw_exit_critical(sr);
+
         BLE_HS_DBG_ASSERT(ble_hs_hci_ack != NULL);
 
 #if BLE_MONITOR
@@ -291,65 +396,237 @@ ble_hs_hci_wait_for_ack(void)
     return rc;
 }
 
+/**
+ * Retrieves the opcode of the command the current ack refers to, or
+ * BLE_HCI_OPCODE_NOP if the ack is malformed.
+ */
+static uint16_t
+ble_hs_hci_ack_opcode(void)
+{
+    const struct ble_hci_ev_command_complete_nop *cmd_complete;
+    const struct ble_hci_ev_command_status *cmd_status;
+
+    switch (ble_hs_hci_ack->opcode) {
+    case BLE_HCI_EVCODE_COMMAND_COMPLETE:
+        if (ble_hs_hci_ack->length < sizeof(*cmd_complete)) {
+            break;
+        }
+        cmd_complete = (void *)ble_hs_hci_ack->data;
+        return le16toh(cmd_complete->opcode);
+
+    case BLE_HCI_EVCODE_COMMAND_STATUS:
+        if (ble_hs_hci_ack->length < sizeof(*cmd_status)) {
+            break;
+        }
+        cmd_status = (void *)ble_hs_hci_ack->data;
+        return le16toh(cmd_status->opcode);
+
+    default:
+        break;
+    }
+
+    return BLE_HCI_OPCODE_NOP;
+}
+
+/**
+ * Finds the oldest outstanding request the current ack belongs to.  If there
+ * is no match, the oldest outstanding request is returned so that the ack
+ * gets reported as invalid.
+ */
+static struct ble_hs_hci_cmd_req *
+ble_hs_hci_ack_req(struct ble_hs_hci_cmd_req *reqs, int first, int end)
+{
+    uint16_t opcode;
+    int i;
+
+    opcode = ble_hs_hci_ack_opcode();
+
+    for (i = first; i < end; i++) {
+        if (!reqs[i].complete && reqs[i].opcode == opcode) {
+            return reqs + i;
+        }
+    }
+
+    for (i = first; i < end; i++) {
+        if (!reqs[i].complete) {
+            return reqs + i;
+        }
+    }
+
+    BLE_HS_DBG_ASSERT(0);
+    return reqs + first;
+}
+
+/**
+ * Sends a sequence of HCI commands and waits for all of them to be
+ * acknowledged.  As many commands are kept outstanding as the controller's
+ * Num_HCI_Command_Packets allows, up to BLE_HS_HCI_CMD_MAX_INFLIGHT, so the
+ * commands must not depend on one another's results.  Each request's status
+ * is filled in and its callback executed as its acknowledgement arrives.
+ *
+ * @return                      0 if every command succeeded; otherwise the
+ *                                  status of the first command to fail.
+ */
 int
-ble_hs_hci_cmd_tx(uint16_t opcode, const void *cmd, uint8_t cmd_len,
-                  void *rsp, uint8_t rsp_len)
+ble_hs_hci_cmd_tx_multi(struct ble_hs_hci_cmd_req *reqs, int num_reqs)
 {
+    struct ble_hs_hci_cmd_req *req;
     struct ble_hs_hci_ack ack;
+    int first_rc;
+    int first;
+    int sent;
     int rc;
+    int i;
+
+    for (i = 0; i < num_reqs; i++) {
+        reqs[i].status = 0;
+        reqs[i].complete = 0;
+    }
+
+    first_rc = 0;
+    first = 0;
+    sent = 0;
 
-    BLE_HS_DBG_ASSERT(ble_hs_hci_ack == NULL);
     ble_hs_hci_lock();
 
-    rc = ble_hs_hci_cmd_send_buf(opcode, cmd, cmd_len);
-    if (rc != 0) {
-        goto done;
-    }
+    while (first < num_reqs) {
+        /* Keep the controller's command queue filled.  A command can always
+         * be sent if nothing is outstanding; otherwise the controller must
+         * have indicated that it is ready to accept more.
+         */
+        while (sent < num_reqs &&
+               (sent == first ||
+                (ble_hs_hci_cmd_credits > 0 &&
+                 sent - first < MYNEWT_VAL(BLE_HS_HCI_CMD_MAX_INFLIGHT)))) {
+
+            req = reqs + sent;
+            rc = ble_hs_hci_cmd_send_counted(req->opcode, req->cmd,
+                                             req->cmd_len);
+            if (rc != 0) {
+                /* Fail the remaining requests; those already sent still need
+                 * to be acknowledged.
+                 */
+                for (i = sent; i < num_reqs; i++) {
+                    reqs[i].status = rc;
+                    reqs[i].complete = 1;
+                }
+                if (first_rc == 0) {
+                    first_rc = rc;
+                }
+                num_reqs = sent;
+                break;
+            }
+            sent++;
+        }
 
-    rc = ble_hs_hci_wait_for_ack();
-    if (rc != 0) {
-        ble_hs_sched_reset(rc);
-        goto done;
-    }
+        if (first >= num_reqs) {
+            break;
+        }
 
-    rc = ble_hs_hci_process_ack(opcode, rsp, rsp_len, &ack);
-    if (rc != 0) {
-        ble_hs_sched_reset(rc);
-        goto done;
-    }
+        rc = ble_hs_hci_wait_for_ack();
+        if (rc != 0) {
+            ble_hs_hci_ack_q_clear();
+            ble_hs_sched_reset(rc);
+            goto err;
+        }
+
+        req = ble_hs_hci_ack_req(reqs, first, sent);
+        rc = ble_hs_hci_process_ack(req->opcode, req->rsp, req->rsp_len, &ack);
 
-    rc = ack.bha_status;
+        ble_hci_trans_buf_free((uint8_t *) ble_hs_hci_ack);
+        ble_hs_hci_ack = NULL;
 
-    /* on success we should always get full response */
-    if (!rc && (ack.bha_params_len != rsp_len)) {
-        ble_hs_sched_reset(rc);
-        goto done;
+        if (rc != 0) {
+            ble_hs_hci_ack_q_clear();
+            ble_hs_sched_reset(rc);
+            goto err;
+        }
+
+        req->status = ack.bha_status;
+
+        /* on success we should always get full response */
+        if (!req->status && (ack.bha_params_len != req->rsp_len)) {
+            ble_hs_sched_reset(req->status);
+        }
+
+        req->complete = 1;
+        if (req->cb != NULL) {
+            req->cb(req);
+        }
+
+        if (req->status != 0 && first_rc == 0) {
+            first_rc = req->status;
+        }
+
+        while (first < num_reqs && reqs[first].complete) {
+            first++;
+        }
     }
 
-done:
+    ble_hs_hci_unlock();
+    return first_rc;
+
+err:
     if (ble_hs_hci_ack != NULL) {
         ble_hci_trans_buf_free((uint8_t *) ble_hs_hci_ack);
         ble_hs_hci_ack = NULL;
     }
 
+    for (i = first; i < num_reqs; i++) {
+        if (!reqs[i].complete) {
+            reqs[i].status = rc;
+            reqs[i].complete = 1;
+        }
+    }
+
     ble_hs_hci_unlock();
-    return rc;
+    return first_rc != 0 ? first_rc : rc;
+}
+
+int
+ble_hs_hci_cmd_tx(uint16_t opcode, const void *cmd, uint8_t cmd_len,
+                  void *rsp, uint8_t rsp_len)
+{
+    struct ble_hs_hci_cmd_req req = {
+        .opcode = opcode,
+        .cmd = cmd,
+        .cmd_len = cmd_len,
+        .rsp = rsp,
+        .rsp_len = rsp_len,
+    };
+
+    return ble_hs_hci_cmd_tx_multi(&req, 1);
 }
 
 static void
 ble_hs_hci_rx_ack(uint8_t *ack_ev)
 {
-    if (ble_npl_sem_get_count(&ble_hs_hci_sem) > 0) {
+    uint32_t sr;
+    int idx;
+
+    sr = ble_npl_hw_enter_critical();
+    if (ble_hs_hci_ack_expected == 0 ||
+        ble_hs_hci_ack_q_len >= MYNEWT_VAL(BLE_HS_HCI_CMD_MAX_INFLIGHT)) {
+
+        idx = -1;
+    } else {
+        idx = (ble_hs_hci_ack_q_head + ble_hs_hci_ack_q_len) %
+              MYNEWT_VAL(BLE_HS_HCI_CMD_MAX_INFLIGHT);
+        ble_hs_hci_ack_q[idx] = (struct ble_hci_ev *) ack_ev;
+        ble_hs_hci_ack_q_len++;
+        ble_hs_hci_ack_expected--;
+    }
+    ble_npl_hw_exit_critical(sr);
+
+    if (idx == -1) {
         /* This ack is unexpected; ignore it. */
         ble_hci_trans_buf_free(ack_ev);
         return;
     }
-    BLE_HS_DBG_ASSERT(ble_hs_hci_ack == NULL);
 
     /* Unblock the application now that the HCI command buffer is populated
      * with the acknowledgement.
      */
-    ble_hs_hci_ack = (struct ble_hci_ev *) ack_ev;
     ble_npl_sem_release(&ble_hs_hci_sem);
 }
 
@@ -387,7 +664,7 @@ ble_hs_hci_rx_evt(uint8_t *hci_ev, void *arg)
 /**
  * Calculates the largest ACL payload that the controller can accept.
  */
-static uint16_t
+uint16_t
 ble_hs_hci_max_acl_payload_sz(void)
 {
     /* As per BLE 5.1 Standard, Vol. 2, Part E, section 7.8.2:
@@ -609,6 +886,8 @@ ble_hs_hci_init(void)
     rc = ble_npl_sem_init(&ble_hs_hci_sem, 0);
     BLE_HS_DBG_ASSERT_EVAL(rc == 0);
 
+    ble_hs_hci_cmd_credits = 1;
+
     rc = ble_npl_mutex_init(&ble_hs_hci_mutex);
     BLE_HS_DBG_ASSERT_EVAL(rc == 0);
 
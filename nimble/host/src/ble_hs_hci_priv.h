@@ -54,6 +54,34 @@ struct ble_hs_hci_ack {
     uint8_t bha_hci_handle;
 };
 
+struct ble_hs_hci_cmd_req;
+
+/**
+ * Called when the controller acknowledges a command sent with
+ * ble_hs_hci_cmd_tx_multi().  The callback runs in the context of the task
+ * that issued the commands; it must not send HCI commands itself.
+ */
+typedef void ble_hs_hci_cmd_req_fn(struct ble_hs_hci_cmd_req *req);
+
+/** A single command sent with ble_hs_hci_cmd_tx_multi(). */
+struct ble_hs_hci_cmd_req {
+    uint16_t opcode;
+    const void *cmd;
+    uint8_t cmd_len;
+
+    /** Buffer for the return parameters; must be filled completely. */
+    void *rsp;
+    uint8_t rsp_len;
+
+    /** Optional completion callback. */
+    ble_hs_hci_cmd_req_fn *cb;
+    void *cb_arg;
+
+    /** Filled in on completion. */
+    int status;
+    uint8_t complete;
+};
+
 #if MYNEWT_VAL(BLE_EXT_ADV)
 struct ble_hs_hci_ext_scan_param {
     uint8_t scan_type;
@@ -83,6 +111,8 @@ extern uint16_t ble_hs_hci_avail_pkts;
 
 int ble_hs_hci_cmd_tx(uint16_t opcode, const void *cmd, uint8_t cmd_len,
                       void *rsp, uint8_t rsp_len);
+int ble_hs_hci_cmd_tx_multi(struct ble_hs_hci_cmd_req *reqs, int num_reqs);
+void ble_hs_hci_cmd_reset(void);
 void ble_hs_hci_init(void);
 
 void ble_hs_hci_set_le_supported_feat(uint32_t feat);
@@ -112,6 +142,7 @@ void ble_hs_hci_add_avail_pkts(uint16_t delta);
 uint16_t ble_hs_hci_util_handle_pb_bc_join(uint16_t handle, uint8_t pb,
                                            uint8_t bc);
 
+uint16_t ble_hs_hci_max_acl_payload_sz(void);
 int ble_hs_hci_acl_tx_now(struct ble_hs_conn *conn, struct os_mbuf **om);
 int ble_hs_hci_acl_tx(struct ble_hs_conn *conn, struct os_mbuf **om);
 
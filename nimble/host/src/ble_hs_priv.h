@@ -89,6 +89,11 @@ STATS_SECT_START(ble_hs_stats)
     STATS_SECT_ENTRY(sync)
     STATS_SECT_ENTRY(pvcy_add_entry)
     STATS_SECT_ENTRY(pvcy_add_entry_fail)
+    STATS_SECT_ENTRY(tx_queued)
+    STATS_SECT_ENTRY(startup_warm)
+    STATS_SECT_ENTRY(startup_reset_ms)
+    STATS_SECT_ENTRY(startup_ver_ms)
+    STATS_SECT_ENTRY(startup_cfg_ms)
 STATS_SECT_END
 extern STATS_SECT_DECL(ble_hs_stats) ble_hs_stats;
 
@@ -23,86 +23,84 @@
 #include "host/ble_hs_hci.h"
 #include "ble_hs_priv.h"
 
+/** Maximum number of commands in the pipelined part of the startup. */
+#define BLE_HS_STARTUP_MAX_REQS     6
+
+/**
+ * Controller information gathered during startup.  With
+ * BLE_HS_STARTUP_CACHE enabled, it is reused when the host resyncs with the
+ * same controller after a reset.  A controller is considered the same if both
+ * its local version information and its public address are unchanged.
+ */
+struct ble_hs_startup_ctlr_info {
+    struct ble_hci_ip_rd_local_ver_rp ver;
+    uint64_t le_feat;
+    uint16_t acl_pktlen;
+    uint16_t acl_max_pkts;
+    uint8_t pub_addr[6];
+    uint8_t valid;
+};
+
+static struct ble_hs_startup_ctlr_info ble_hs_startup_info;
+
+/** Command and response buffers for the pipelined part of the startup. */
+struct ble_hs_startup_bufs {
+    struct ble_hci_cb_set_event_mask_cp evmask;
+    struct ble_hci_cb_set_event_mask2_cp evmask2;
+    struct ble_hci_le_set_event_mask_cp le_evmask;
+
 #if !MYNEWT_VAL(BLE_CONTROLLER)
-static int
-ble_hs_startup_read_sup_f_tx(void)
+    struct ble_hci_ip_rd_loc_supp_feat_rp sup_f;
+#endif
+    struct ble_hci_le_rd_buf_size_rp le_buf_sz;
+    struct ble_hci_le_rd_loc_supp_feat_rp le_sup_f;
+};
+
+#if !MYNEWT_VAL(BLE_CONTROLLER)
+static void
+ble_hs_startup_read_sup_f_cb(struct ble_hs_hci_cmd_req *req)
 {
-    struct ble_hci_ip_rd_loc_supp_feat_rp rsp;
-    int rc;
+    const struct ble_hci_ip_rd_loc_supp_feat_rp *rsp = req->rsp;
 
-    rc = ble_hs_hci_cmd_tx(BLE_HCI_OP(BLE_HCI_OGF_INFO_PARAMS,
-                                      BLE_HCI_OCF_IP_RD_LOC_SUPP_FEAT),
-                           NULL, 0, &rsp, sizeof(rsp));
-    if (rc != 0) {
-        return rc;
+    if (req->status != 0) {
+        return;
     }
 
     /* for now we don't use it outside of init sequence so check this here
      * LE Supported (Controller) byte 4, bit 6
      */
-    if (!(rsp.features & 0x0000006000000000)) {
+    if (!(rsp->features & 0x0000006000000000)) {
         BLE_HS_LOG(ERROR, "Controller doesn't support LE\n");
-        return BLE_HS_ECONTROLLER;
+        req->status = BLE_HS_ECONTROLLER;
     }
-
-    return 0;
 }
 #endif
 
 static int
-ble_hs_startup_read_local_ver_tx(void)
+ble_hs_startup_read_local_ver_tx(struct ble_hci_ip_rd_local_ver_rp *rsp)
 {
-    struct ble_hci_ip_rd_local_ver_rp rsp;
     int rc;
 
     rc = ble_hs_hci_cmd_tx(BLE_HCI_OP(BLE_HCI_OGF_INFO_PARAMS,
                                       BLE_HCI_OCF_IP_RD_LOCAL_VER),
-                           NULL, 0, &rsp, sizeof(rsp));
-    if (rc != 0) {
-        return rc;
-    }
-
-    /* For now we are interested only in HCI Version */
-    ble_hs_hci_set_hci_version(rsp.hci_ver);
-
-    return 0;
-}
-
-static int
-ble_hs_startup_le_read_sup_f_tx(void)
-{
-    struct ble_hci_le_rd_loc_supp_feat_rp rsp;
-    int rc;
-
-    rc = ble_hs_hci_cmd_tx(BLE_HCI_OP(BLE_HCI_OGF_LE,
-                                      BLE_HCI_OCF_LE_RD_LOC_SUPP_FEAT),
-                           NULL,0, &rsp, sizeof(rsp));
+                           NULL, 0, rsp, sizeof(*rsp));
     if (rc != 0) {
         return rc;
     }
 
-    ble_hs_hci_set_le_supported_feat(le64toh(rsp.features));
+    ble_hs_hci_set_hci_version(rsp->hci_ver);
 
     return 0;
 }
 
-static int
-ble_hs_startup_le_read_buf_sz_tx(uint16_t *out_pktlen, uint8_t *out_max_pkts)
+static void
+ble_hs_startup_le_read_sup_f_cb(struct ble_hs_hci_cmd_req *req)
 {
-    struct ble_hci_le_rd_buf_size_rp rsp;
-    int rc;
+    const struct ble_hci_le_rd_loc_supp_feat_rp *rsp = req->rsp;
 
-    rc = ble_hs_hci_cmd_tx(BLE_HCI_OP(BLE_HCI_OGF_LE,
-                                      BLE_HCI_OCF_LE_RD_BUF_SIZE), NULL, 0,
-                           &rsp, sizeof(rsp));
-    if (rc != 0) {
-        return rc;
+    if (req->status == 0) {
+        ble_hs_startup_info.le_feat = le64toh(rsp->features);
     }
-
-    *out_pktlen = le16toh(rsp.data_len);
-    *out_max_pkts = rsp.data_packets;
-
-    return 0;
 }
 
 static int
@@ -125,61 +123,38 @@ ble_hs_startup_read_buf_sz_tx(uint16_t *out_pktlen, uint16_t *out_max_pkts)
 }
 
 static int
-ble_hs_startup_read_buf_sz(void)
+ble_hs_startup_read_buf_sz(const struct ble_hci_le_rd_buf_size_rp *le_rsp)
 {
-    uint16_t le_pktlen = 0;
-    uint16_t max_pkts = 0;
-    uint16_t pktlen = 0;
-    uint8_t le_max_pkts = 0;
     int rc;
 
-    rc = ble_hs_startup_le_read_buf_sz_tx(&le_pktlen, &le_max_pkts);
-    if (rc != 0) {
-        return rc;
-    }
-
-    if (le_pktlen != 0) {
-        pktlen = le_pktlen;
-        max_pkts = le_max_pkts;
+    if (le16toh(le_rsp->data_len) != 0) {
+        ble_hs_startup_info.acl_pktlen = le16toh(le_rsp->data_len);
+        ble_hs_startup_info.acl_max_pkts = le_rsp->data_packets;
     } else {
-        rc = ble_hs_startup_read_buf_sz_tx(&pktlen, &max_pkts);
+        /* The controller shares its buffers between BR/EDR and LE. */
+        rc = ble_hs_startup_read_buf_sz_tx(&ble_hs_startup_info.acl_pktlen,
+                                           &ble_hs_startup_info.acl_max_pkts);
         if (rc != 0) {
             return rc;
         }
     }
 
-    rc = ble_hs_hci_set_buf_sz(pktlen, max_pkts);
-    if (rc != 0) {
-        return rc;
-    }
-
     return 0;
 }
 
 static int
-ble_hs_startup_read_bd_addr(void)
+ble_hs_startup_read_bd_addr_tx(struct ble_hci_ip_rd_bd_addr_rp *rsp)
 {
-    struct ble_hci_ip_rd_bd_addr_rp rsp;
-    int rc;
-
-    rc = ble_hs_hci_cmd_tx(BLE_HCI_OP(BLE_HCI_OGF_INFO_PARAMS,
-                                      BLE_HCI_OCF_IP_RD_BD_ADDR),
-                           NULL, 0, &rsp, sizeof(rsp));
-    if (rc != 0) {
-        return rc;
-    }
-
-    ble_hs_id_set_pub(rsp.addr);
-    return 0;
+    return ble_hs_hci_cmd_tx(BLE_HCI_OP(BLE_HCI_OGF_INFO_PARAMS,
+                                        BLE_HCI_OCF_IP_RD_BD_ADDR),
+                             NULL, 0, rsp, sizeof(*rsp));
 }
 
-static int
-ble_hs_startup_le_set_evmask_tx(void)
+static void
+ble_hs_startup_le_evmask(struct ble_hci_le_set_event_mask_cp *cmd)
 {
-    struct ble_hci_le_set_event_mask_cp cmd;
     uint8_t version;
     uint64_t mask;
-    int rc;
 
     version = ble_hs_hci_get_hci_version();
 
@@ -238,28 +213,13 @@ ble_hs_startup_le_set_evmask_tx(void)
     }
 #endif
 
-    cmd.event_mask = htole64(mask);
-
-    rc = ble_hs_hci_cmd_tx(BLE_HCI_OP(BLE_HCI_OGF_LE,
-                                      BLE_HCI_OCF_LE_SET_EVENT_MASK),
-                           &cmd, sizeof(cmd), NULL, 0);
-    if (rc != 0) {
-        return rc;
-    }
-
-    return 0;
+    cmd->event_mask = htole64(mask);
 }
 
-static int
-ble_hs_startup_set_evmask_tx(void)
+static void
+ble_hs_startup_evmask(struct ble_hci_cb_set_event_mask_cp *cmd,
+                      struct ble_hci_cb_set_event_mask2_cp *cmd2)
 {
-    struct ble_hci_cb_set_event_mask_cp cmd;
-    struct ble_hci_cb_set_event_mask2_cp cmd2;
-    uint8_t version;
-    int rc;
-
-    version = ble_hs_hci_get_hci_version();
-
     /**
      * Enable the following events:
      *     0x0000000000000010 Disconnection Complete Event
@@ -269,24 +229,116 @@ ble_hs_startup_set_evmask_tx(void)
      *     0x0000800000000000 Encryption Key Refresh Complete Event
      *     0x2000000000000000 LE Meta-Event
      */
-    cmd.event_mask = htole64(0x2000800002008090);
+    cmd->event_mask = htole64(0x2000800002008090);
+
+    /**
+     * Enable the following events (if supported by the controller):
+     *     0x0000000000800000 Authenticated Payload Timeout Event
+     */
+    cmd2->event_mask2 = htole64(0x0000000000800000);
+}
+
+static int
+ble_hs_startup_reset_tx(void)
+{
+    return ble_hs_hci_cmd_tx(BLE_HCI_OP(BLE_HCI_OGF_CTLR_BASEBAND,
+                                        BLE_HCI_OCF_CB_RESET),
+                             NULL, 0, NULL, 0);
+}
+
+static void
+ble_hs_startup_req_add(struct ble_hs_hci_cmd_req *reqs, int *num_reqs,
+                       uint16_t opcode, const void *cmd, uint8_t cmd_len,
+                       void *rsp, uint8_t rsp_len, ble_hs_hci_cmd_req_fn *cb)
+{
+    struct ble_hs_hci_cmd_req *req;
+
+    BLE_HS_DBG_ASSERT(*num_reqs < BLE_HS_STARTUP_MAX_REQS);
+
+    req = reqs + *num_reqs;
+    memset(req, 0, sizeof *req);
+    req->opcode = opcode;
+    req->cmd = cmd;
+    req->cmd_len = cmd_len;
+    req->rsp = rsp;
+    req->rsp_len = rsp_len;
+    req->cb = cb;
+
+    (*num_reqs)++;
+}
+
+/**
+ * Configures the controller and, if requested, reads its capabilities.  None
+ * of these commands depends on another's result, so they are sent as a single
+ * pipelined sequence.
+ *
+ * @param query                 Whether to read the controller capabilities
+ *                                  into ble_hs_startup_info.
+ */
+static int
+ble_hs_startup_config_tx(int query)
+{
+    struct ble_hs_hci_cmd_req reqs[BLE_HS_STARTUP_MAX_REQS];
+    struct ble_hs_startup_bufs bufs;
+    int num_reqs;
+    int rc;
+
+    memset(&bufs, 0, sizeof bufs);
+    num_reqs = 0;
 
-    rc = ble_hs_hci_cmd_tx(BLE_HCI_OP(BLE_HCI_OGF_CTLR_BASEBAND,
+#if !MYNEWT_VAL(BLE_CONTROLLER)
+    if (query) {
+        ble_hs_startup_req_add(reqs, &num_reqs,
+                               BLE_HCI_OP(BLE_HCI_OGF_INFO_PARAMS,
+                                          BLE_HCI_OCF_IP_RD_LOC_SUPP_FEAT),
+                               NULL, 0, &bufs.sup_f, sizeof(bufs.sup_f),
+                               ble_hs_startup_read_sup_f_cb);
+    }
+#endif
+
+    ble_hs_startup_evmask(&bufs.evmask, &bufs.evmask2);
+    ble_hs_startup_req_add(reqs, &num_reqs,
+                           BLE_HCI_OP(BLE_HCI_OGF_CTLR_BASEBAND,
                                       BLE_HCI_OCF_CB_SET_EVENT_MASK),
-                           &cmd, sizeof(cmd), NULL, 0);
+                           &bufs.evmask, sizeof(bufs.evmask), NULL, 0, NULL);
+
+    if (ble_hs_hci_get_hci_version() >= BLE_HCI_VER_BCS_4_1) {
+        ble_hs_startup_req_add(reqs, &num_reqs,
+                               BLE_HCI_OP(BLE_HCI_OGF_CTLR_BASEBAND,
+                                          BLE_HCI_OCF_CB_SET_EVENT_MASK2),
+                               &bufs.evmask2, sizeof(bufs.evmask2),
+                               NULL, 0, NULL);
+    }
+
+    ble_hs_startup_le_evmask(&bufs.le_evmask);
+    ble_hs_startup_req_add(reqs, &num_reqs,
+                           BLE_HCI_OP(BLE_HCI_OGF_LE,
+                                      BLE_HCI_OCF_LE_SET_EVENT_MASK),
+                           &bufs.le_evmask, sizeof(bufs.le_evmask),
+                           NULL, 0, NULL);
+
+    if (query) {
+        ble_hs_startup_req_add(reqs, &num_reqs,
+                               BLE_HCI_OP(BLE_HCI_OGF_LE,
+                                          BLE_HCI_OCF_LE_RD_BUF_SIZE),
+                               NULL, 0,
+                               &bufs.le_buf_sz, sizeof(bufs.le_buf_sz), NULL);
+
+        ble_hs_startup_req_add(reqs, &num_reqs,
+                               BLE_HCI_OP(BLE_HCI_OGF_LE,
+                                          BLE_HCI_OCF_LE_RD_LOC_SUPP_FEAT),
+                               NULL, 0,
+                               &bufs.le_sup_f, sizeof(bufs.le_sup_f),
+                               ble_hs_startup_le_read_sup_f_cb);
+    }
+
+    rc = ble_hs_hci_cmd_tx_multi(reqs, num_reqs);
     if (rc != 0) {
         return rc;
     }
 
-    if (version >= BLE_HCI_VER_BCS_4_1) {
-        /**
-         * Enable the following events:
-         *     0x0000000000800000 Authenticated Payload Timeout Event
-         */
-        cmd2.event_mask2 = htole64(0x0000000000800000);
-        rc = ble_hs_hci_cmd_tx(BLE_HCI_OP(BLE_HCI_OGF_CTLR_BASEBAND,
-                                          BLE_HCI_OCF_CB_SET_EVENT_MASK2),
-                               &cmd2, sizeof(cmd2), NULL, 0);
+    if (query) {
+        rc = ble_hs_startup_read_buf_sz(&bufs.le_buf_sz);
         if (rc != 0) {
             return rc;
         }
@@ -295,28 +347,73 @@ ble_hs_startup_set_evmask_tx(void)
     return 0;
 }
 
+/**
+ * Applies the controller information in ble_hs_startup_info to the host.
+ */
 static int
-ble_hs_startup_reset_tx(void)
+ble_hs_startup_info_apply(void)
 {
-    return ble_hs_hci_cmd_tx(BLE_HCI_OP(BLE_HCI_OGF_CTLR_BASEBAND,
-                                        BLE_HCI_OCF_CB_RESET),
-                             NULL, 0, NULL, 0);
+    int rc;
+
+    rc = ble_hs_hci_set_buf_sz(ble_hs_startup_info.acl_pktlen,
+                               ble_hs_startup_info.acl_max_pkts);
+    if (rc != 0) {
+        return rc;
+    }
+
+    ble_hs_hci_set_le_supported_feat(ble_hs_startup_info.le_feat);
+    ble_hs_id_set_pub(ble_hs_startup_info.pub_addr);
+
+    return 0;
+}
+
+/** Start of the current startup phase; only read by the timing stats. */
+static ble_npl_time_t ble_hs_startup_phase_ticks;
+
+/**
+ * Returns the duration of the current startup phase and starts the next one.
+ * Only called from STATS_INCN(), which is empty when stats are stubbed out.
+ */
+static inline uint32_t
+ble_hs_startup_phase_ms(void)
+{
+    ble_npl_time_t now;
+    uint32_t ms;
+
+    now = ble_npl_time_get();
+    ms = ble_npl_time_ticks_to_ms32(now - ble_hs_startup_phase_ticks);
+    ble_hs_startup_phase_ticks = now;
+
+    return ms;
+}
+
+void
+ble_hs_startup_cache_clear(void)
+{
+    ble_hs_startup_info.valid = 0;
 }
 
 int
 ble_hs_startup_go(void)
 {
+    struct ble_hci_ip_rd_local_ver_rp ver;
+    struct ble_hci_ip_rd_bd_addr_rp bd_addr;
+    int query;
     int rc;
 
+    ble_hs_startup_phase_ticks = ble_npl_time_get();
+
     rc = ble_hs_startup_reset_tx();
     if (rc != 0) {
         return rc;
     }
+    STATS_INCN(ble_hs_stats, startup_reset_ms, ble_hs_startup_phase_ms());
 
-    rc = ble_hs_startup_read_local_ver_tx();
+    rc = ble_hs_startup_read_local_ver_tx(&ver);
     if (rc != 0) {
         return rc;
     }
+    STATS_INCN(ble_hs_stats, startup_ver_ms, ble_hs_startup_phase_ms());
 
     /* XXX: Read local supported commands. */
 
@@ -326,42 +423,50 @@ ble_hs_startup_go(void)
         BLE_HS_LOG(ERROR, "Required controller version is 4.0 (6)\n");
         return BLE_HS_ECONTROLLER;
     }
-
-    rc = ble_hs_startup_read_sup_f_tx();
-    if (rc != 0) {
-        return rc;
-    }
 #endif
 
-    rc = ble_hs_startup_set_evmask_tx();
-    if (rc != 0) {
-        return rc;
-    }
-
-    rc = ble_hs_startup_le_set_evmask_tx();
+    /* The public address is always read; two controllers running the same
+     * firmware report identical version information.
+     */
+    rc = ble_hs_startup_read_bd_addr_tx(&bd_addr);
     if (rc != 0) {
         return rc;
     }
 
-    rc = ble_hs_startup_read_buf_sz();
-    if (rc != 0) {
-        return rc;
+    /* The controller's capabilities only need to be read again if this is a
+     * different controller (or firmware) than the one we last synced with.
+     */
+    query = !MYNEWT_VAL(BLE_HS_STARTUP_CACHE) ||
+            !ble_hs_startup_info.valid ||
+            memcmp(&ver, &ble_hs_startup_info.ver, sizeof ver) != 0 ||
+            memcmp(bd_addr.addr, ble_hs_startup_info.pub_addr,
+                   sizeof ble_hs_startup_info.pub_addr) != 0;
+    if (query) {
+        memset(&ble_hs_startup_info, 0, sizeof ble_hs_startup_info);
+        ble_hs_startup_info.ver = ver;
+        memcpy(ble_hs_startup_info.pub_addr, bd_addr.addr,
+               sizeof ble_hs_startup_info.pub_addr);
+    } else {
+        STATS_INC(ble_hs_stats, startup_warm);
     }
 
-    rc = ble_hs_startup_le_read_sup_f_tx();
+    rc = ble_hs_startup_config_tx(query);
     if (rc != 0) {
         return rc;
     }
 
-    rc = ble_hs_startup_read_bd_addr();
+    rc = ble_hs_startup_info_apply();
     if (rc != 0) {
         return rc;
     }
+    ble_hs_startup_info.valid = 1;
 
     ble_hs_pvcy_set_our_irk(NULL);
 
     /* If flow control is enabled, configure the controller to use it. */
     ble_hs_flow_startup();
 
+    STATS_INCN(ble_hs_stats, startup_cfg_ms, ble_hs_startup_phase_ms());
+
     return 0;
 }
@@ -25,6 +25,7 @@ extern "C" {
 #endif
 
 int ble_hs_startup_go(void);
+void ble_hs_startup_cache_clear(void);
 
 #ifdef __cplusplus
 }
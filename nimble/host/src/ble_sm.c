@@ -554,6 +554,8 @@ ble_sm_persist_keys(struct ble_sm_proc *proc)
 
             identity_ev = 1;
         }
+
+        ble_hs_conn_peer_addr_updated(conn);
     } else {
         peer_addr = conn->bhc_peer_addr;
         peer_addr.type =
@@ -285,6 +285,79 @@ ble_store_delete_cccd(const struct ble_store_key_cccd *key)
     return rc;
 }
 
+int
+ble_store_read_peer_attr(const struct ble_store_key_peer_attr *key,
+                         struct ble_store_value_peer_attr *out_value)
+{
+    union ble_store_value *store_value;
+    union ble_store_key *store_key;
+    int rc;
+
+    store_key = (void *)key;
+    store_value = (void *)out_value;
+    rc = ble_store_read(BLE_STORE_OBJ_TYPE_PEER_ATTR, store_key, store_value);
+    return rc;
+}
+
+int
+ble_store_write_peer_attr(const struct ble_store_value_peer_attr *value)
+{
+    union ble_store_value *store_value;
+    int rc;
+
+    store_value = (void *)value;
+    rc = ble_store_write(BLE_STORE_OBJ_TYPE_PEER_ATTR, store_value);
+    return rc;
+}
+
+int
+ble_store_delete_peer_attr(const struct ble_store_key_peer_attr *key)
+{
+    union ble_store_key *store_key;
+    int rc;
+
+    store_key = (void *)key;
+    rc = ble_store_delete(BLE_STORE_OBJ_TYPE_PEER_ATTR, store_key);
+    return rc;
+}
+
+int
+ble_store_read_cl_sup_feat(const struct ble_store_key_cl_sup_feat *key,
+                           struct ble_store_value_cl_sup_feat *out_value)
+{
+    union ble_store_value *store_value;
+    union ble_store_key *store_key;
+    int rc;
+
+    store_key = (void *)key;
+    store_value = (void *)out_value;
+    rc = ble_store_read(BLE_STORE_OBJ_TYPE_CL_SUP_FEAT, store_key,
+                        store_value);
+    return rc;
+}
+
+int
+ble_store_write_cl_sup_feat(const struct ble_store_value_cl_sup_feat *value)
+{
+    union ble_store_value *store_value;
+    int rc;
+
+    store_value = (void *)value;
+    rc = ble_store_write(BLE_STORE_OBJ_TYPE_CL_SUP_FEAT, store_value);
+    return rc;
+}
+
+int
+ble_store_delete_cl_sup_feat(const struct ble_store_key_cl_sup_feat *key)
+{
+    union ble_store_key *store_key;
+    int rc;
+
+    store_key = (void *)key;
+    rc = ble_store_delete(BLE_STORE_OBJ_TYPE_CL_SUP_FEAT, store_key);
+    return rc;
+}
+
 void
 ble_store_key_from_value_cccd(struct ble_store_key_cccd *out_key,
                               const struct ble_store_value_cccd *value)
@@ -294,6 +367,28 @@ ble_store_key_from_value_cccd(struct ble_store_key_cccd *out_key,
     out_key->idx = 0;
 }
 
+void
+ble_store_key_from_value_peer_attr(
+    struct ble_store_key_peer_attr *out_key,
+    const struct ble_store_value_peer_attr *value)
+{
+    out_key->peer_addr = value->peer_addr;
+    memcpy(out_key->db_hash, value->db_hash, sizeof out_key->db_hash);
+    out_key->db_hash_present = value->db_hash_present;
+    out_key->type = value->type;
+    out_key->handle = value->handle;
+    out_key->idx = 0;
+}
+
+void
+ble_store_key_from_value_cl_sup_feat(
+    struct ble_store_key_cl_sup_feat *out_key,
+    const struct ble_store_value_cl_sup_feat *value)
+{
+    out_key->peer_addr = value->peer_addr;
+    out_key->idx = 0;
+}
+
 void
 ble_store_key_from_value_sec(struct ble_store_key_sec *out_key,
                              const struct ble_store_value_sec *value)
@@ -321,6 +416,16 @@ ble_store_key_from_value(int obj_type,
         ble_store_key_from_value_cccd(&out_key->cccd, &value->cccd);
         break;
 
+    case BLE_STORE_OBJ_TYPE_PEER_ATTR:
+        ble_store_key_from_value_peer_attr(&out_key->peer_attr,
+                                           &value->peer_attr);
+        break;
+
+    case BLE_STORE_OBJ_TYPE_CL_SUP_FEAT:
+        ble_store_key_from_value_cl_sup_feat(&out_key->cl_sup_feat,
+                                             &value->cl_sup_feat);
+        break;
+
     default:
         BLE_HS_DBG_ASSERT(0);
         break;
@@ -350,6 +455,14 @@ ble_store_iterate(int obj_type,
             key.cccd.peer_addr = *BLE_ADDR_ANY;
             pidx = &key.cccd.idx;
             break;
+        case BLE_STORE_OBJ_TYPE_PEER_ATTR:
+            key.peer_attr.peer_addr = *BLE_ADDR_ANY;
+            pidx = &key.peer_attr.idx;
+            break;
+        case BLE_STORE_OBJ_TYPE_CL_SUP_FEAT:
+            key.cl_sup_feat.peer_addr = *BLE_ADDR_ANY;
+            pidx = &key.cl_sup_feat.idx;
+            break;
         default:
             BLE_HS_DBG_ASSERT(0);
             return BLE_HS_EINVAL;
@@ -394,6 +507,8 @@ ble_store_clear(void)
         BLE_STORE_OBJ_TYPE_OUR_SEC,
         BLE_STORE_OBJ_TYPE_PEER_SEC,
         BLE_STORE_OBJ_TYPE_CCCD,
+        BLE_STORE_OBJ_TYPE_PEER_ATTR,
+        BLE_STORE_OBJ_TYPE_CL_SUP_FEAT,
     };
     union ble_store_key key;
     int obj_type;
@@ -410,7 +525,14 @@ ble_store_clear(void)
             rc = ble_store_delete(obj_type, &key);
         } while (rc == 0);
 
-        /* BLE_HS_ENOENT means we deleted everything. */
+        /* BLE_HS_ENOENT means we deleted everything.  Not every store keeps
+         * cached peer attributes or client supported features.
+         */
+        if (rc == BLE_HS_ENOTSUP &&
+            (obj_type == BLE_STORE_OBJ_TYPE_PEER_ATTR ||
+             obj_type == BLE_STORE_OBJ_TYPE_CL_SUP_FEAT)) {
+            continue;
+        }
         if (rc != BLE_HS_ENOENT) {
             return rc;
         }
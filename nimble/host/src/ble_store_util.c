@@ -101,7 +101,8 @@ ble_store_util_bonded_peers(ble_addr_t *out_peer_id_addrs, int *out_num_peers,
 
 /**
  * Deletes all entries from the store that are attached to the specified peer
- * address.  This function deletes security entries and CCCD records.
+ * address.  This function deletes security entries, CCCD records, the
+ * peer's client supported features and its cached attribute tree.
  *
  * @param peer_id_addr          Entries with this peer address get deleted.
  *
@@ -135,6 +136,22 @@ ble_store_util_delete_peer(const ble_addr_t *peer_id_addr)
         return rc;
     }
 
+    memset(&key, 0, sizeof key);
+    key.peer_attr.peer_addr = *peer_id_addr;
+
+    rc = ble_store_util_delete_all(BLE_STORE_OBJ_TYPE_PEER_ATTR, &key);
+    if (rc != 0 && rc != BLE_HS_ENOTSUP) {
+        return rc;
+    }
+
+    memset(&key, 0, sizeof key);
+    key.cl_sup_feat.peer_addr = *peer_id_addr;
+
+    rc = ble_store_util_delete_all(BLE_STORE_OBJ_TYPE_CL_SUP_FEAT, &key);
+    if (rc != 0 && rc != BLE_HS_ENOTSUP) {
+        return rc;
+    }
+
     return 0;
 }
 
@@ -239,6 +256,14 @@ ble_store_util_status_rr(struct ble_store_status_event *event, void *arg)
         case BLE_STORE_OBJ_TYPE_CCCD:
             /* Try unpairing oldest peer except current peer */
             return ble_gap_unpair_oldest_except(&event->overflow.value->cccd.peer_addr);
+        case BLE_STORE_OBJ_TYPE_CL_SUP_FEAT:
+            return ble_gap_unpair_oldest_except(
+                &event->overflow.value->cl_sup_feat.peer_addr);
+        case BLE_STORE_OBJ_TYPE_PEER_ATTR:
+            /* A discovery cache is not worth losing a bond over; the GATT
+             * client discovers over the air instead.
+             */
+            return BLE_HS_ESTORE_CAP;
 
         default:
             return BLE_HS_EUNKNOWN;
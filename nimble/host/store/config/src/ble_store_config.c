@@ -40,6 +40,19 @@ struct ble_store_value_cccd
     ble_store_config_cccds[MYNEWT_VAL(BLE_STORE_MAX_CCCDS)];
 int ble_store_config_num_cccds;
 
+struct ble_store_value_cl_sup_feat
+    ble_store_config_cl_sup_feats[MYNEWT_VAL(BLE_STORE_MAX_BONDS)];
+int ble_store_config_num_cl_sup_feats;
+
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+struct ble_store_value_peer_attr
+    ble_store_config_peer_attrs[MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)];
+
+/* Index of the first peer attr record changed since the last persist. */
+static int ble_store_config_peer_attr_dirty;
+#endif
+int ble_store_config_num_peer_attrs;
+
 /*****************************************************************************
  * $sec                                                                      *
  *****************************************************************************/
@@ -415,6 +428,412 @@ ble_store_config_write_cccd(const struct ble_store_value_cccd *value_cccd)
     return 0;
 }
 
+/*****************************************************************************
+ * $cl sup feat                                                              *
+ *****************************************************************************/
+
+static int
+ble_store_config_find_cl_sup_feat(const struct ble_store_key_cl_sup_feat *key)
+{
+    struct ble_store_value_cl_sup_feat *feat;
+    int skipped;
+    int i;
+
+    skipped = 0;
+    for (i = 0; i < ble_store_config_num_cl_sup_feats; i++) {
+        feat = ble_store_config_cl_sup_feats + i;
+
+        if (ble_addr_cmp(&key->peer_addr, BLE_ADDR_ANY)) {
+            if (ble_addr_cmp(&feat->peer_addr, &key->peer_addr)) {
+                continue;
+            }
+        }
+
+        if (key->idx > skipped) {
+            skipped++;
+            continue;
+        }
+
+        return i;
+    }
+
+    return -1;
+}
+
+static int
+ble_store_config_delete_cl_sup_feat(
+    const struct ble_store_key_cl_sup_feat *key)
+{
+    int idx;
+    int rc;
+
+    idx = ble_store_config_find_cl_sup_feat(key);
+    if (idx == -1) {
+        return BLE_HS_ENOENT;
+    }
+
+    rc = ble_store_config_delete_obj(ble_store_config_cl_sup_feats,
+                                     sizeof *ble_store_config_cl_sup_feats,
+                                     idx,
+                                     &ble_store_config_num_cl_sup_feats);
+    if (rc != 0) {
+        return rc;
+    }
+
+    rc = ble_store_config_persist_cl_sup_feats();
+    if (rc != 0) {
+        return rc;
+    }
+
+    return 0;
+}
+
+static int
+ble_store_config_read_cl_sup_feat(const struct ble_store_key_cl_sup_feat *key,
+                                  struct ble_store_value_cl_sup_feat *value)
+{
+    int idx;
+
+    idx = ble_store_config_find_cl_sup_feat(key);
+    if (idx == -1) {
+        return BLE_HS_ENOENT;
+    }
+
+    *value = ble_store_config_cl_sup_feats[idx];
+    return 0;
+}
+
+static int
+ble_store_config_write_cl_sup_feat(
+    const struct ble_store_value_cl_sup_feat *value)
+{
+    struct ble_store_key_cl_sup_feat key;
+    int idx;
+    int rc;
+
+    ble_store_key_from_value_cl_sup_feat(&key, value);
+    idx = ble_store_config_find_cl_sup_feat(&key);
+    if (idx == -1) {
+        if (ble_store_config_num_cl_sup_feats >=
+            MYNEWT_VAL(BLE_STORE_MAX_BONDS)) {
+
+            BLE_HS_LOG(DEBUG, "error persisting client supported features; "
+                              "too many entries (%d)\n",
+                       ble_store_config_num_cl_sup_feats);
+            return BLE_HS_ESTORE_CAP;
+        }
+
+        idx = ble_store_config_num_cl_sup_feats;
+        ble_store_config_num_cl_sup_feats++;
+    }
+
+    ble_store_config_cl_sup_feats[idx] = *value;
+
+    rc = ble_store_config_persist_cl_sup_feats();
+    if (rc != 0) {
+        return rc;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+ * $peer attr                                                                *
+ *****************************************************************************/
+
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+
+static int
+ble_store_config_find_peer_attr(const struct ble_store_key_peer_attr *key)
+{
+    struct ble_store_value_peer_attr *attr;
+    int skipped;
+    int i;
+
+    skipped = 0;
+    for (i = 0; i < ble_store_config_num_peer_attrs; i++) {
+        attr = ble_store_config_peer_attrs + i;
+
+        if (ble_addr_cmp(&key->peer_addr, BLE_ADDR_ANY)) {
+            if (ble_addr_cmp(&attr->peer_addr, &key->peer_addr)) {
+                continue;
+            }
+        }
+
+        if (key->db_hash_present) {
+            if (!attr->db_hash_present ||
+                memcmp(attr->db_hash, key->db_hash, sizeof attr->db_hash)) {
+                continue;
+            }
+        }
+
+        if (key->type != 0) {
+            if (attr->type != key->type) {
+                continue;
+            }
+        }
+
+        if (key->handle != 0) {
+            if (attr->handle != key->handle) {
+                continue;
+            }
+        }
+
+        if (key->idx > skipped) {
+            skipped++;
+            continue;
+        }
+
+        return i;
+    }
+
+    return -1;
+}
+
+static int
+ble_store_config_peer_attr_same_tree(const struct ble_store_value_peer_attr *a,
+                                     const struct ble_store_value_peer_attr *b)
+{
+    if (ble_addr_cmp(&a->peer_addr, &b->peer_addr)) {
+        return 0;
+    }
+
+    if (a->db_hash_present != b->db_hash_present) {
+        return 0;
+    }
+
+    if (a->db_hash_present &&
+        memcmp(a->db_hash, b->db_hash, sizeof a->db_hash)) {
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Returns the index of the first record belonging to the same attribute
+ * tree as the specified record.
+ */
+static int
+ble_store_config_peer_attr_tree_first(const struct ble_store_value_peer_attr
+                                      *attr)
+{
+    int i;
+
+    for (i = 0; i < ble_store_config_num_peer_attrs; i++) {
+        if (ble_store_config_peer_attr_same_tree(
+                ble_store_config_peer_attrs + i, attr)) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+void
+ble_store_config_peer_attr_mark_dirty(int idx)
+{
+    if (idx < ble_store_config_peer_attr_dirty) {
+        ble_store_config_peer_attr_dirty = idx;
+    }
+}
+
+/**
+ * Indicates whether the specified record belongs to a sealed tree, i.e., a
+ * tree whose terminator record has been written.  Only sealed records are
+ * persisted.
+ */
+int
+ble_store_config_peer_attr_sealed(int idx)
+{
+    const struct ble_store_value_peer_attr *attr;
+    int i;
+
+    attr = ble_store_config_peer_attrs + idx;
+    for (i = ble_store_config_num_peer_attrs - 1; i >= 0; i--) {
+        if (ble_store_config_peer_attrs[i].type ==
+                BLE_STORE_PEER_ATTR_TYPE_END &&
+            ble_store_config_peer_attr_same_tree(
+                ble_store_config_peer_attrs + i, attr)) {
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Removes all records that do not belong to a sealed tree.
+ *
+ * @return                      The number of records removed.
+ */
+int
+ble_store_config_purge_peer_attrs(void)
+{
+    int num_purged;
+    int i;
+
+    num_purged = 0;
+    i = 0;
+    while (i < ble_store_config_num_peer_attrs) {
+        if (ble_store_config_peer_attr_sealed(i)) {
+            i++;
+            continue;
+        }
+
+        ble_store_config_delete_obj(ble_store_config_peer_attrs,
+                                    sizeof *ble_store_config_peer_attrs,
+                                    i, &ble_store_config_num_peer_attrs);
+        ble_store_config_peer_attr_mark_dirty(i);
+        num_purged++;
+    }
+
+    return num_purged;
+}
+
+/**
+ * Persists all peer attr records changed since the last persist.
+ */
+int
+ble_store_config_flush_peer_attrs(void)
+{
+    int dirty;
+    int rc;
+
+    dirty = ble_store_config_peer_attr_dirty;
+    ble_store_config_peer_attr_dirty = MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS);
+
+    rc = ble_store_config_persist_peer_attrs(dirty);
+    if (rc != 0) {
+        ble_store_config_peer_attr_mark_dirty(dirty);
+        return rc;
+    }
+
+    return 0;
+}
+
+/**
+ * Attribute trees are written and deleted one record at a time.  Only a
+ * change to a tree's terminator record is persisted, and only records of
+ * sealed trees ever reach flash: a tree is stored once, when it is sealed,
+ * and leaves flash once, when its terminator (stored last, so deleted last)
+ * goes.  A tree without its terminator is never used, so records that were
+ * not persisted yet do no harm if lost.
+ */
+static int
+ble_store_config_delete_peer_attr(const struct ble_store_key_peer_attr *key)
+{
+    struct ble_store_value_peer_attr attr;
+    int first;
+    int idx;
+    int rc;
+
+    idx = ble_store_config_find_peer_attr(key);
+    if (idx == -1) {
+        return BLE_HS_ENOENT;
+    }
+
+    attr = ble_store_config_peer_attrs[idx];
+
+    /* Once the terminator goes, the whole tree leaves flash. */
+    first = idx;
+    if (attr.type == BLE_STORE_PEER_ATTR_TYPE_END) {
+        first = ble_store_config_peer_attr_tree_first(&attr);
+    }
+    ble_store_config_peer_attr_mark_dirty(first);
+
+    rc = ble_store_config_delete_obj(ble_store_config_peer_attrs,
+                                     sizeof *ble_store_config_peer_attrs,
+                                     idx,
+                                     &ble_store_config_num_peer_attrs);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (attr.type != BLE_STORE_PEER_ATTR_TYPE_END) {
+        return 0;
+    }
+
+    /* A tree is replaced by deleting it; drop any of its records left
+     * behind, as they can no longer be sealed.
+     */
+    while ((idx = ble_store_config_peer_attr_tree_first(&attr)) <
+           ble_store_config_num_peer_attrs) {
+
+        ble_store_config_delete_obj(ble_store_config_peer_attrs,
+                                    sizeof *ble_store_config_peer_attrs,
+                                    idx, &ble_store_config_num_peer_attrs);
+    }
+
+    rc = ble_store_config_flush_peer_attrs();
+    if (rc != 0) {
+        return rc;
+    }
+
+    return 0;
+}
+
+static int
+ble_store_config_read_peer_attr(const struct ble_store_key_peer_attr *key,
+                                struct ble_store_value_peer_attr *value)
+{
+    int idx;
+
+    idx = ble_store_config_find_peer_attr(key);
+    if (idx == -1) {
+        return BLE_HS_ENOENT;
+    }
+
+    *value = ble_store_config_peer_attrs[idx];
+    return 0;
+}
+
+static int
+ble_store_config_write_peer_attr(const struct ble_store_value_peer_attr *value)
+{
+    struct ble_store_key_peer_attr key;
+    int idx;
+    int rc;
+
+    ble_store_key_from_value_peer_attr(&key, value);
+    idx = ble_store_config_find_peer_attr(&key);
+    if (idx == -1) {
+        if (ble_store_config_num_peer_attrs >=
+            MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)) {
+
+            BLE_HS_LOG(DEBUG, "error persisting peer attr; "
+                              "too many entries (%d)\n",
+                       ble_store_config_num_peer_attrs);
+            return BLE_HS_ESTORE_CAP;
+        }
+
+        idx = ble_store_config_num_peer_attrs;
+        ble_store_config_num_peer_attrs++;
+    }
+
+    ble_store_config_peer_attrs[idx] = *value;
+
+    /* Sealing a tree brings all of its records to flash. */
+    if (value->type == BLE_STORE_PEER_ATTR_TYPE_END) {
+        idx = ble_store_config_peer_attr_tree_first(value);
+    }
+    ble_store_config_peer_attr_mark_dirty(idx);
+
+    if (value->type != BLE_STORE_PEER_ATTR_TYPE_END) {
+        return 0;
+    }
+
+    rc = ble_store_config_flush_peer_attrs();
+    if (rc != 0) {
+        return rc;
+    }
+
+    return 0;
+}
+
+#endif
+
 /*****************************************************************************
  * $api                                                                      *
  *****************************************************************************/
@@ -457,6 +876,18 @@ ble_store_config_read(int obj_type, const union ble_store_key *key,
         rc = ble_store_config_read_cccd(&key->cccd, &value->cccd);
         return rc;
 
+    case BLE_STORE_OBJ_TYPE_CL_SUP_FEAT:
+        rc = ble_store_config_read_cl_sup_feat(&key->cl_sup_feat,
+                                               &value->cl_sup_feat);
+        return rc;
+
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+    case BLE_STORE_OBJ_TYPE_PEER_ATTR:
+        rc = ble_store_config_read_peer_attr(&key->peer_attr,
+                                             &value->peer_attr);
+        return rc;
+#endif
+
     default:
         return BLE_HS_ENOTSUP;
     }
@@ -486,6 +917,16 @@ ble_store_config_write(int obj_type, const union ble_store_value *val)
         rc = ble_store_config_write_cccd(&val->cccd);
         return rc;
 
+    case BLE_STORE_OBJ_TYPE_CL_SUP_FEAT:
+        rc = ble_store_config_write_cl_sup_feat(&val->cl_sup_feat);
+        return rc;
+
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+    case BLE_STORE_OBJ_TYPE_PEER_ATTR:
+        rc = ble_store_config_write_peer_attr(&val->peer_attr);
+        return rc;
+#endif
+
     default:
         return BLE_HS_ENOTSUP;
     }
@@ -509,6 +950,16 @@ ble_store_config_delete(int obj_type, const union ble_store_key *key)
         rc = ble_store_config_delete_cccd(&key->cccd);
         return rc;
 
+    case BLE_STORE_OBJ_TYPE_CL_SUP_FEAT:
+        rc = ble_store_config_delete_cl_sup_feat(&key->cl_sup_feat);
+        return rc;
+
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+    case BLE_STORE_OBJ_TYPE_PEER_ATTR:
+        rc = ble_store_config_delete_peer_attr(&key->peer_attr);
+        return rc;
+#endif
+
     default:
         return BLE_HS_ENOTSUP;
     }
@@ -528,6 +979,11 @@ ble_store_config_init(void)
     ble_store_config_num_our_secs = 0;
     ble_store_config_num_peer_secs = 0;
     ble_store_config_num_cccds = 0;
+    ble_store_config_num_cl_sup_feats = 0;
+    ble_store_config_num_peer_attrs = 0;
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+    ble_store_config_peer_attr_dirty = MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS);
+#endif
 
     ble_store_config_conf_init();
 }
@@ -22,6 +22,8 @@
 #if MYNEWT_VAL(BLE_STORE_CONFIG_PERSIST)
 
 #include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "sysinit/sysinit.h"
@@ -34,6 +36,8 @@
 static int
 ble_store_config_conf_set(int argc, char **argv, char *val);
 static int
+ble_store_config_conf_commit(void);
+static int
 ble_store_config_conf_export(void (*func)(char *name, char *val),
                              enum conf_export_tgt tgt);
 
@@ -41,7 +45,7 @@ static struct conf_handler ble_store_config_conf_handler = {
     .ch_name = "ble_hs",
     .ch_get = NULL,
     .ch_set = ble_store_config_conf_set,
-    .ch_commit = NULL,
+    .ch_commit = ble_store_config_conf_commit,
     .ch_export = ble_store_config_conf_export
 };
 
@@ -57,6 +61,33 @@ static struct conf_handler ble_store_config_conf_handler = {
 #define BLE_STORE_CONFIG_CCCD_SET_ENCODE_SZ \
     (MYNEWT_VAL(BLE_STORE_MAX_CCCDS) * BLE_STORE_CONFIG_CCCD_ENCODE_SZ + 1)
 
+#define BLE_STORE_CONFIG_CL_SUP_FEAT_ENCODE_SZ      \
+    BASE64_ENCODE_SIZE(sizeof (struct ble_store_value_cl_sup_feat))
+
+#define BLE_STORE_CONFIG_CL_SUP_FEAT_SET_ENCODE_SZ  \
+    (MYNEWT_VAL(BLE_STORE_MAX_BONDS) *              \
+     BLE_STORE_CONFIG_CL_SUP_FEAT_ENCODE_SZ + 1)
+
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+#define BLE_STORE_CONFIG_PEER_ATTR_ENCODE_SZ        \
+    BASE64_ENCODE_SIZE(sizeof (struct ble_store_value_peer_attr))
+
+/* "ble_hs/peer_attr/<slot>" */
+#define BLE_STORE_CONFIG_PEER_ATTR_NAME_SZ          32
+
+/* Attribute trees are much larger than the other record sets, so they are
+ * persisted one record per setting: "ble_hs/peer_attr/<slot>".  Slots
+ * 0..num_slots-1 may be present in the config backend; they hold the records
+ * of sealed trees, in store order.
+ */
+static int ble_store_config_peer_attr_num_slots;
+
+/* Slots read from the config backend since the last commit. */
+static uint8_t ble_store_config_peer_attr_loaded[
+    (MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS) + 7) / 8];
+static int ble_store_config_peer_attr_loading;
+#endif
+
 static void
 ble_store_config_serialize_arr(const void *arr, int obj_sz, int num_objs,
                                char *out_buf, int buf_sz)
@@ -86,6 +117,102 @@ ble_store_config_deserialize_arr(const char *enc,
     return 0;
 }
 
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+static int
+ble_store_config_conf_set_peer_attr(const char *slot_str, char *val)
+{
+    char buf[BLE_STORE_CONFIG_PEER_ATTR_ENCODE_SZ];
+    char *endptr;
+    long slot;
+    int len;
+
+    slot = strtol(slot_str, &endptr, 10);
+    if (*slot_str == '\0' || *endptr != '\0' || slot < 0 ||
+        slot >= INT16_MAX) {
+
+        return OS_ENOENT;
+    }
+
+    if (slot >= MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)) {
+        /* Left behind by a larger configuration; delete it on commit. */
+        if (val != NULL && *val != '\0' &&
+            slot >= ble_store_config_peer_attr_num_slots) {
+
+            ble_store_config_peer_attr_num_slots = slot + 1;
+        }
+        ble_store_config_peer_attr_loading = 1;
+        return 0;
+    }
+
+    if (val == NULL || *val == '\0') {
+        /* Deleted setting. */
+        ble_store_config_peer_attr_loaded[slot / 8] &= ~(1 << (slot % 8));
+        return 0;
+    }
+
+    if (strlen(val) >= sizeof buf) {
+        return OS_EINVAL;
+    }
+
+    len = base64_decode(val, buf);
+    if (len != sizeof *ble_store_config_peer_attrs) {
+        return OS_EINVAL;
+    }
+
+    memcpy(ble_store_config_peer_attrs + slot, buf, len);
+    ble_store_config_peer_attr_loaded[slot / 8] |= 1 << (slot % 8);
+    ble_store_config_peer_attr_loading = 1;
+
+    return 0;
+}
+
+/**
+ * Gathers the loaded peer attr slots into the store and drops the records of
+ * trees that were never sealed, e.g., ones persisted by an older version.
+ * Any slot whose content moved is rewritten.
+ */
+static int
+ble_store_config_conf_commit_peer_attrs(void)
+{
+    int first_moved;
+    int num;
+    int i;
+
+    if (!ble_store_config_peer_attr_loading) {
+        return 0;
+    }
+    ble_store_config_peer_attr_loading = 0;
+
+    first_moved = MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS);
+    num = 0;
+    for (i = 0; i < MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS); i++) {
+        if (!(ble_store_config_peer_attr_loaded[i / 8] & (1 << (i % 8)))) {
+            continue;
+        }
+
+        if (i >= ble_store_config_peer_attr_num_slots) {
+            ble_store_config_peer_attr_num_slots = i + 1;
+        }
+
+        if (i != num) {
+            if (num < first_moved) {
+                first_moved = num;
+            }
+            ble_store_config_peer_attrs[num] = ble_store_config_peer_attrs[i];
+        }
+        num++;
+    }
+    memset(ble_store_config_peer_attr_loaded, 0,
+           sizeof ble_store_config_peer_attr_loaded);
+
+    ble_store_config_num_peer_attrs = num;
+    ble_store_config_peer_attr_mark_dirty(first_moved);
+    ble_store_config_purge_peer_attrs();
+
+    return ble_store_config_flush_peer_attrs();
+}
+#endif
+
 static int
 ble_store_config_conf_set(int argc, char **argv, char *val)
 {
@@ -113,11 +240,40 @@ ble_store_config_conf_set(int argc, char **argv, char *val)
                     sizeof *ble_store_config_cccds,
                     &ble_store_config_num_cccds);
             return rc;
+        } else if (strcmp(argv[0], "cl_sup_feat") == 0) {
+            rc = ble_store_config_deserialize_arr(
+                    val,
+                    ble_store_config_cl_sup_feats,
+                    sizeof *ble_store_config_cl_sup_feats,
+                    &ble_store_config_num_cl_sup_feats);
+            return rc;
+        }
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+    } else if (argc == 2) {
+        if (strcmp(argv[0], "peer_attr") == 0) {
+            rc = ble_store_config_conf_set_peer_attr(argv[1], val);
+            return rc;
         }
+#endif
     }
     return OS_ENOENT;
 }
 
+static int
+ble_store_config_conf_commit(void)
+{
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+    int rc;
+
+    rc = ble_store_config_conf_commit_peer_attrs();
+    if (rc != 0) {
+        return rc;
+    }
+#endif
+
+    return 0;
+}
+
 static int
 ble_store_config_conf_export(void (*func)(char *name, char *val),
                              enum conf_export_tgt tgt)
@@ -125,7 +281,16 @@ ble_store_config_conf_export(void (*func)(char *name, char *val),
     union {
         char sec[BLE_STORE_CONFIG_SEC_SET_ENCODE_SZ];
         char cccd[BLE_STORE_CONFIG_CCCD_SET_ENCODE_SZ];
+        char cl_sup_feat[BLE_STORE_CONFIG_CL_SUP_FEAT_SET_ENCODE_SZ];
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+        char peer_attr[BLE_STORE_CONFIG_PEER_ATTR_ENCODE_SZ];
+#endif
     } buf;
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+    char name[BLE_STORE_CONFIG_PEER_ATTR_NAME_SZ];
+    int slot;
+    int i;
+#endif
 
     ble_store_config_serialize_arr(ble_store_config_our_secs,
                                    sizeof *ble_store_config_our_secs,
@@ -148,6 +313,29 @@ ble_store_config_conf_export(void (*func)(char *name, char *val),
                                    sizeof buf.cccd);
     func("ble_hs/cccd", buf.cccd);
 
+    ble_store_config_serialize_arr(ble_store_config_cl_sup_feats,
+                                   sizeof *ble_store_config_cl_sup_feats,
+                                   ble_store_config_num_cl_sup_feats,
+                                   buf.cl_sup_feat,
+                                   sizeof buf.cl_sup_feat);
+    func("ble_hs/cl_sup_feat", buf.cl_sup_feat);
+
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+    slot = 0;
+    for (i = 0; i < ble_store_config_num_peer_attrs; i++) {
+        if (!ble_store_config_peer_attr_sealed(i)) {
+            continue;
+        }
+
+        ble_store_config_serialize_arr(ble_store_config_peer_attrs + i,
+                                       sizeof *ble_store_config_peer_attrs, 1,
+                                       buf.peer_attr, sizeof buf.peer_attr);
+        snprintf(name, sizeof name, "ble_hs/peer_attr/%d", slot);
+        func(name, buf.peer_attr);
+        slot++;
+    }
+#endif
+
     return 0;
 }
 
@@ -218,11 +406,106 @@ ble_store_config_persist_cccds(void)
     return 0;
 }
 
+int
+ble_store_config_persist_cl_sup_feats(void)
+{
+    char buf[BLE_STORE_CONFIG_CL_SUP_FEAT_SET_ENCODE_SZ];
+    int rc;
+
+    ble_store_config_serialize_arr(ble_store_config_cl_sup_feats,
+                                   sizeof *ble_store_config_cl_sup_feats,
+                                   ble_store_config_num_cl_sup_feats,
+                                   buf,
+                                   sizeof buf);
+    rc = conf_save_one("ble_hs/cl_sup_feat", buf);
+    if (rc != 0) {
+        return BLE_HS_ESTORE_FAIL;
+    }
+
+    return 0;
+}
+
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+static int
+ble_store_config_save_peer_attr_slot(int slot, char *val)
+{
+    char name[BLE_STORE_CONFIG_PEER_ATTR_NAME_SZ];
+    int rc;
+
+    snprintf(name, sizeof name, "ble_hs/peer_attr/%d", slot);
+    rc = conf_save_one(name, val);
+    if (rc != 0) {
+        return BLE_HS_ESTORE_FAIL;
+    }
+
+    return 0;
+}
+
+/**
+ * Rewrites the slots of all sealed records at or after the specified store
+ * index and deletes the slots past the last one.
+ */
+int
+ble_store_config_persist_peer_attrs(int first_idx)
+{
+    char buf[BLE_STORE_CONFIG_PEER_ATTR_ENCODE_SZ];
+    int slot;
+    int rc;
+    int i;
+
+    /* Records ahead of the first change keep their slots. */
+    slot = 0;
+    for (i = 0; i < first_idx && i < ble_store_config_num_peer_attrs; i++) {
+        if (ble_store_config_peer_attr_sealed(i)) {
+            slot++;
+        }
+    }
+
+    for (; i < ble_store_config_num_peer_attrs; i++) {
+        if (!ble_store_config_peer_attr_sealed(i)) {
+            continue;
+        }
+
+        ble_store_config_serialize_arr(ble_store_config_peer_attrs + i,
+                                       sizeof *ble_store_config_peer_attrs, 1,
+                                       buf, sizeof buf);
+        rc = ble_store_config_save_peer_attr_slot(slot, buf);
+        if (rc != 0) {
+            return rc;
+        }
+
+        slot++;
+        if (slot > ble_store_config_peer_attr_num_slots) {
+            ble_store_config_peer_attr_num_slots = slot;
+        }
+    }
+
+    while (ble_store_config_peer_attr_num_slots > slot) {
+        rc = ble_store_config_save_peer_attr_slot(
+                ble_store_config_peer_attr_num_slots - 1, NULL);
+        if (rc != 0) {
+            return rc;
+        }
+
+        ble_store_config_peer_attr_num_slots--;
+    }
+
+    return 0;
+}
+#endif
+
 void
 ble_store_config_conf_init(void)
 {
     int rc;
 
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+    ble_store_config_peer_attr_num_slots = 0;
+    ble_store_config_peer_attr_loading = 0;
+    memset(ble_store_config_peer_attr_loaded, 0,
+           sizeof ble_store_config_peer_attr_loaded);
+#endif
+
     rc = conf_register(&ble_store_config_conf_handler);
     SYSINIT_PANIC_ASSERT_MSG(rc == 0,
                              "Failed to register ble_store_config conf");
@@ -36,11 +36,28 @@ extern struct ble_store_value_cccd
     ble_store_config_cccds[MYNEWT_VAL(BLE_STORE_MAX_CCCDS)];
 extern int ble_store_config_num_cccds;
 
+extern struct ble_store_value_cl_sup_feat
+    ble_store_config_cl_sup_feats[MYNEWT_VAL(BLE_STORE_MAX_BONDS)];
+extern int ble_store_config_num_cl_sup_feats;
+
+#if MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)
+extern struct ble_store_value_peer_attr
+    ble_store_config_peer_attrs[MYNEWT_VAL(BLE_STORE_MAX_PEER_ATTRS)];
+
+void ble_store_config_peer_attr_mark_dirty(int idx);
+int ble_store_config_peer_attr_sealed(int idx);
+int ble_store_config_purge_peer_attrs(void);
+int ble_store_config_flush_peer_attrs(void);
+#endif
+extern int ble_store_config_num_peer_attrs;
+
 #if MYNEWT_VAL(BLE_STORE_CONFIG_PERSIST)
 
 int ble_store_config_persist_our_secs(void);
 int ble_store_config_persist_peer_secs(void);
 int ble_store_config_persist_cccds(void);
+int ble_store_config_persist_cl_sup_feats(void);
+int ble_store_config_persist_peer_attrs(int first_idx);
 void ble_store_config_conf_init(void);
 
 #else
@@ -48,6 +65,10 @@ void ble_store_config_conf_init(void);
 static inline int ble_store_config_persist_our_secs(void)   { return 0; }
 static inline int ble_store_config_persist_peer_secs(void)  { return 0; }
 static inline int ble_store_config_persist_cccds(void)      { return 0; }
+static inline int ble_store_config_persist_cl_sup_feats(void)
+                                                            { return 0; }
+static inline int ble_store_config_persist_peer_attrs(int first_idx)
+                                                            { return 0; }
 static inline void ble_store_config_conf_init(void)         { }
 
 #endif /* MYNEWT_VAL(BLE_STORE_CONFIG_PERSIST) */
@@ -0,0 +1,407 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "testutil/testutil.h"
+#include "nimble/ble.h"
+#include "host/ble_gatt.h"
+#include "host/ble_l2cap.h"
+#include "ble_hs_test.h"
+#include "ble_hs_test_util.h"
+
+#if MYNEWT_VAL(BLE_EATT_CHAN_NUM) > 1
+
+#define BLE_ATT_EATT_TEST_MAX_READS 8
+#define BLE_ATT_EATT_TEST_MAX_MTUS  8
+
+/** Source CIDs of the bearers opened by the last connect. */
+static uint16_t ble_att_eatt_test_scids[MYNEWT_VAL(BLE_EATT_CHAN_NUM)];
+
+/** MTU events reported to the application. */
+static uint16_t ble_att_eatt_test_mtu_cids[BLE_ATT_EATT_TEST_MAX_MTUS];
+static uint16_t ble_att_eatt_test_mtu;
+static int ble_att_eatt_test_num_mtus;
+
+/** Completed read procedures, indexed by the value passed as callback arg. */
+static int ble_att_eatt_test_read_status[BLE_ATT_EATT_TEST_MAX_READS];
+static uint8_t ble_att_eatt_test_read_val[BLE_ATT_EATT_TEST_MAX_READS];
+static int ble_att_eatt_test_read_cbs[BLE_ATT_EATT_TEST_MAX_READS];
+
+static int
+ble_att_eatt_test_conn_cb(struct ble_gap_event *event, void *arg)
+{
+    if (event->type == BLE_GAP_EVENT_MTU &&
+        event->mtu.channel_id != BLE_L2CAP_CID_ATT) {
+
+        TEST_ASSERT_FATAL(ble_att_eatt_test_num_mtus <
+                          BLE_ATT_EATT_TEST_MAX_MTUS);
+        ble_att_eatt_test_mtu_cids[ble_att_eatt_test_num_mtus++] =
+            event->mtu.channel_id;
+        ble_att_eatt_test_mtu = event->mtu.value;
+    }
+
+    return 0;
+}
+
+static int
+ble_att_eatt_test_read_cb(uint16_t conn_handle,
+                          const struct ble_gatt_error *error,
+                          struct ble_gatt_attr *attr, void *arg)
+{
+    int idx;
+
+    idx = (intptr_t)arg;
+    TEST_ASSERT_FATAL(idx < BLE_ATT_EATT_TEST_MAX_READS);
+
+    ble_att_eatt_test_read_cbs[idx]++;
+    ble_att_eatt_test_read_status[idx] = error->status;
+    if (error->status == 0) {
+        TEST_ASSERT_FATAL(OS_MBUF_PKTLEN(attr->om) == 1);
+        os_mbuf_copydata(attr->om, 0, 1, &ble_att_eatt_test_read_val[idx]);
+    }
+
+    return 0;
+}
+
+/** Runs the events queued for the host task, e.g., closed bearers. */
+static void
+ble_att_eatt_test_util_run_evq(void)
+{
+    struct ble_npl_event *ev;
+
+    while ((ev = ble_npl_eventq_get(ble_hs_evq_get(), 0)) != NULL) {
+        ble_npl_event_run(ev);
+    }
+}
+
+static void
+ble_att_eatt_test_util_create_conn(void)
+{
+    struct ble_hs_conn *conn;
+
+    ble_hs_test_util_create_conn(2, ((uint8_t[]){2,3,4,5,6,7}),
+                                 ble_att_eatt_test_conn_cb, NULL);
+
+    ble_hs_lock();
+    conn = ble_hs_conn_find(2);
+    TEST_ASSERT_FATAL(conn != NULL);
+    conn->bhc_sec_state.encrypted = 1;
+    ble_hs_unlock();
+}
+
+static void
+ble_att_eatt_test_util_init(void)
+{
+    ble_hs_test_util_init();
+
+    memset(ble_att_eatt_test_scids, 0, sizeof ble_att_eatt_test_scids);
+    memset(ble_att_eatt_test_mtu_cids, 0, sizeof ble_att_eatt_test_mtu_cids);
+    ble_att_eatt_test_num_mtus = 0;
+    memset(ble_att_eatt_test_read_status, 0,
+           sizeof ble_att_eatt_test_read_status);
+    memset(ble_att_eatt_test_read_cbs, 0, sizeof ble_att_eatt_test_read_cbs);
+
+    ble_att_eatt_test_util_create_conn();
+}
+
+/**
+ * Opens the specified number of bearers and answers the connect request as
+ * the peer would.  Channels with a zero entry in 'accept' are refused.
+ */
+static void
+ble_att_eatt_test_util_connect(int num, uint16_t result, const int *accept)
+{
+    ble_hs_test_util_eatt_connect(2, num, result, accept,
+                                  ble_att_eatt_test_scids);
+}
+
+/** Disconnects the bearer with the specified source CID on peer request. */
+static void
+ble_att_eatt_test_util_peer_disconnect(uint16_t scid)
+{
+    struct ble_l2cap_sig_disc_req req;
+    int rc;
+
+    req.dcid = htole16(scid);
+    req.scid = htole16(BLE_HS_TEST_UTIL_EATT_DCID(scid));
+
+    rc = ble_hs_test_util_inject_rx_l2cap_sig(2, BLE_L2CAP_SIG_OP_DISCONN_REQ,
+                                              10, &req, sizeof req);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    TEST_ASSERT(ble_hs_test_util_verify_tx_l2cap_sig(
+                    BLE_L2CAP_SIG_OP_DISCONN_RSP, &req, sizeof req) == 10);
+}
+
+/**
+ * Starts a read of the specified attribute and returns the source CID of
+ * the bearer the request was sent on.
+ */
+static uint16_t
+ble_att_eatt_test_util_read(uint16_t attr_handle, int idx)
+{
+    struct os_mbuf *om;
+    uint16_t cid;
+    int rc;
+    int i;
+
+    rc = ble_gattc_read(2, attr_handle, ble_att_eatt_test_read_cb,
+                        (void *)(intptr_t)idx);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    om = ble_hs_test_util_eatt_prev_tx_dequeue_pullup(&cid);
+    TEST_ASSERT_FATAL(om != NULL);
+
+    if (cid != BLE_L2CAP_CID_ATT) {
+        for (i = 0; i < MYNEWT_VAL(BLE_EATT_CHAN_NUM); i++) {
+            if (ble_att_eatt_test_scids[i] != 0 &&
+                cid == ble_att_eatt_test_scids[i]) {
+                break;
+            }
+        }
+        TEST_ASSERT_FATAL(i < MYNEWT_VAL(BLE_EATT_CHAN_NUM));
+    }
+
+    TEST_ASSERT(om->om_data[0] == BLE_ATT_OP_READ_REQ);
+    TEST_ASSERT(get_le16(om->om_data + 1) == attr_handle);
+
+    return cid;
+}
+
+/** Receives a one byte read response on the specified bearer. */
+static void
+ble_att_eatt_test_util_rx_read_rsp(uint16_t cid, uint8_t val)
+{
+    uint8_t buf[2];
+
+    buf[0] = BLE_ATT_OP_READ_RSP;
+    buf[1] = val;
+    ble_hs_test_util_eatt_rx_payload_flat(2, cid, buf, sizeof buf);
+}
+
+static int
+ble_att_eatt_test_util_num_bearers(void)
+{
+    uint16_t cids[MYNEWT_VAL(BLE_EATT_CHAN_NUM)];
+
+    return ble_att_eatt_bearers(2, cids, MYNEWT_VAL(BLE_EATT_CHAN_NUM));
+}
+
+TEST_CASE_SELF(ble_att_eatt_test_connect)
+{
+    uint16_t cids[MYNEWT_VAL(BLE_EATT_CHAN_NUM)];
+    int num;
+    int rc;
+    int i;
+
+    ble_att_eatt_test_util_init();
+
+    /*** Bearers require encryption. */
+    ble_hs_lock();
+    ble_hs_conn_find(2)->bhc_sec_state.encrypted = 0;
+    ble_hs_unlock();
+    rc = ble_att_eatt_connect(2, 1);
+    TEST_ASSERT(rc == BLE_HS_EENCRYPT);
+    ble_hs_lock();
+    ble_hs_conn_find(2)->bhc_sec_state.encrypted = 1;
+    ble_hs_unlock();
+
+    /*** More bearers than configured. */
+    rc = ble_att_eatt_connect(2, MYNEWT_VAL(BLE_EATT_CHAN_NUM) + 1);
+    TEST_ASSERT(rc == BLE_HS_EINVAL);
+
+    /*** Successful connect; every bearer reports its MTU. */
+    num = MYNEWT_VAL(BLE_EATT_CHAN_NUM);
+    ble_att_eatt_test_util_connect(num, 0, NULL);
+
+    TEST_ASSERT(ble_att_eatt_test_num_mtus == num);
+    TEST_ASSERT(ble_att_eatt_test_mtu == MYNEWT_VAL(BLE_EATT_MTU));
+
+    rc = ble_att_eatt_bearers(2, cids, MYNEWT_VAL(BLE_EATT_CHAN_NUM));
+    TEST_ASSERT_FATAL(rc == num);
+    for (i = 0; i < num; i++) {
+        TEST_ASSERT(cids[i] == ble_att_eatt_test_scids[i]);
+        TEST_ASSERT(ble_att_eatt_test_mtu_cids[i] ==
+                    ble_att_eatt_test_scids[i]);
+    }
+
+    /*** All bearers are in use. */
+    rc = ble_att_eatt_connect(2, 1);
+    TEST_ASSERT(rc == BLE_HS_ENOMEM);
+
+    /*** Peer disconnects one bearer; it is released from the host task. */
+    ble_att_eatt_test_util_peer_disconnect(ble_att_eatt_test_scids[0]);
+    TEST_ASSERT(ble_att_eatt_test_util_num_bearers() == num - 1);
+    ble_att_eatt_test_util_run_evq();
+
+    ble_att_eatt_test_util_connect(1, 0, NULL);
+    TEST_ASSERT(ble_att_eatt_test_util_num_bearers() == num);
+
+    ble_att_eatt_test_util_run_evq();
+}
+
+TEST_CASE_SELF(ble_att_eatt_test_peer_reject)
+{
+    static const int accept[2] = { 1, 0 };
+    uint16_t cids[MYNEWT_VAL(BLE_EATT_CHAN_NUM)];
+    int rc;
+
+    ble_att_eatt_test_util_init();
+
+    /*** All bearers refused. */
+    ble_att_eatt_test_util_connect(2, BLE_L2CAP_COC_ERR_INSUFFICIENT_AUTHEN,
+                                   NULL);
+    TEST_ASSERT(ble_att_eatt_test_util_num_bearers() == 0);
+    TEST_ASSERT(ble_att_eatt_test_num_mtus == 0);
+
+    /*** Partially refused; the refused bearer is released. */
+    ble_att_eatt_test_util_connect(2, BLE_L2CAP_COC_ERR_NO_RESOURCES, accept);
+    rc = ble_att_eatt_bearers(2, cids, MYNEWT_VAL(BLE_EATT_CHAN_NUM));
+    TEST_ASSERT_FATAL(rc == 1);
+    TEST_ASSERT(cids[0] == ble_att_eatt_test_scids[0]);
+    TEST_ASSERT(ble_att_eatt_test_num_mtus == 1);
+
+    rc = ble_att_eatt_connect(2, 1);
+    TEST_ASSERT(rc == 0);
+
+    ble_att_eatt_test_util_run_evq();
+}
+
+TEST_CASE_SELF(ble_att_eatt_test_routing)
+{
+    uint16_t cid[5];
+
+    ble_att_eatt_test_util_init();
+    ble_att_eatt_test_util_connect(2, 0, NULL);
+
+    /*** New procedures go to the least loaded bearer. */
+    cid[0] = ble_att_eatt_test_util_read(0x10, 0);
+    cid[1] = ble_att_eatt_test_util_read(0x11, 1);
+    TEST_ASSERT(cid[0] == ble_att_eatt_test_scids[0]);
+    TEST_ASSERT(cid[1] == ble_att_eatt_test_scids[1]);
+
+    /* All enhanced bearers are busy; the unenhanced one is idle. */
+    cid[2] = ble_att_eatt_test_util_read(0x12, 2);
+    TEST_ASSERT(cid[2] == BLE_L2CAP_CID_ATT);
+
+    cid[3] = ble_att_eatt_test_util_read(0x13, 3);
+    TEST_ASSERT(cid[3] == ble_att_eatt_test_scids[0]);
+
+    /*** Responses are matched on the bearer they arrive on. */
+    ble_att_eatt_test_util_rx_read_rsp(cid[1], 0xb1);
+    TEST_ASSERT(ble_att_eatt_test_read_cbs[0] == 0);
+    TEST_ASSERT(ble_att_eatt_test_read_cbs[1] == 1);
+    TEST_ASSERT(ble_att_eatt_test_read_val[1] == 0xb1);
+
+    ble_att_eatt_test_util_rx_read_rsp(cid[2], 0xc2);
+    TEST_ASSERT(ble_att_eatt_test_read_cbs[2] == 1);
+    TEST_ASSERT(ble_att_eatt_test_read_val[2] == 0xc2);
+
+    /* Two procedures on the same bearer complete in order. */
+    ble_att_eatt_test_util_rx_read_rsp(cid[0], 0xa0);
+    TEST_ASSERT(ble_att_eatt_test_read_cbs[0] == 1);
+    TEST_ASSERT(ble_att_eatt_test_read_cbs[3] == 0);
+    TEST_ASSERT(ble_att_eatt_test_read_val[0] == 0xa0);
+
+    ble_att_eatt_test_util_rx_read_rsp(cid[3], 0xd3);
+    TEST_ASSERT(ble_att_eatt_test_read_cbs[3] == 1);
+    TEST_ASSERT(ble_att_eatt_test_read_val[3] == 0xd3);
+
+    /*** A response on an idle bearer completes nothing. */
+    ble_att_eatt_test_util_rx_read_rsp(cid[1], 0xee);
+    TEST_ASSERT(ble_att_eatt_test_read_cbs[1] == 1);
+    TEST_ASSERT(ble_att_eatt_test_read_val[1] == 0xb1);
+
+    ble_att_eatt_test_util_run_evq();
+}
+
+TEST_CASE_SELF(ble_att_eatt_test_bearer_closed)
+{
+    uint16_t cid[2];
+
+    ble_att_eatt_test_util_init();
+    ble_att_eatt_test_util_connect(2, 0, NULL);
+
+    cid[0] = ble_att_eatt_test_util_read(0x10, 0);
+    cid[1] = ble_att_eatt_test_util_read(0x11, 1);
+    TEST_ASSERT_FATAL(cid[0] != cid[1]);
+
+    /*** Only the procedure on the closed bearer fails. */
+    ble_att_eatt_test_util_peer_disconnect(cid[1]);
+    ble_att_eatt_test_util_run_evq();
+
+    TEST_ASSERT(ble_att_eatt_test_read_cbs[1] == 1);
+    TEST_ASSERT(ble_att_eatt_test_read_status[1] == BLE_HS_ENOTCONN);
+    TEST_ASSERT(ble_att_eatt_test_read_cbs[0] == 0);
+
+    ble_att_eatt_test_util_rx_read_rsp(cid[0], 0xa0);
+    TEST_ASSERT(ble_att_eatt_test_read_cbs[0] == 1);
+    TEST_ASSERT(ble_att_eatt_test_read_status[0] == 0);
+}
+
+TEST_CASE_SELF(ble_att_eatt_test_conn_reuse)
+{
+    uint16_t cid[2];
+
+    ble_att_eatt_test_util_init();
+    ble_att_eatt_test_util_connect(2, 0, NULL);
+
+    cid[0] = ble_att_eatt_test_util_read(0x10, 0);
+    cid[1] = ble_att_eatt_test_util_read(0x11, 1);
+
+    /*** Bearer closes, then the connection goes away before the host task
+     *   gets to run.
+     */
+    ble_att_eatt_test_util_peer_disconnect(cid[1]);
+    ble_hs_test_util_hci_rx_disconn_complete_event(2, 0,
+                                                   BLE_ERR_REM_USER_CONN_TERM);
+    TEST_ASSERT(ble_att_eatt_test_read_cbs[0] == 1);
+    TEST_ASSERT(ble_att_eatt_test_read_status[0] == BLE_HS_ENOTCONN);
+    TEST_ASSERT(ble_att_eatt_test_read_cbs[1] == 1);
+    TEST_ASSERT(ble_att_eatt_test_read_status[1] == BLE_HS_ENOTCONN);
+
+    /*** Same handle reused; bearers get the same CIDs again. */
+    ble_att_eatt_test_util_create_conn();
+    ble_att_eatt_test_util_connect(2, 0, NULL);
+
+    TEST_ASSERT(ble_att_eatt_test_util_read(0x10, 2) == cid[0]);
+    TEST_ASSERT(ble_att_eatt_test_util_read(0x11, 3) == cid[1]);
+
+    /* Nothing left over from the old connection fails the new procedures. */
+    ble_att_eatt_test_util_run_evq();
+    TEST_ASSERT(ble_att_eatt_test_read_cbs[2] == 0);
+    TEST_ASSERT(ble_att_eatt_test_read_cbs[3] == 0);
+
+    ble_att_eatt_test_util_rx_read_rsp(cid[1], 0xb1);
+    TEST_ASSERT(ble_att_eatt_test_read_cbs[3] == 1);
+    TEST_ASSERT(ble_att_eatt_test_read_status[3] == 0);
+}
+
+#endif
+
+TEST_SUITE(ble_att_eatt_test_suite)
+{
+#if MYNEWT_VAL(BLE_EATT_CHAN_NUM) > 1
+    ble_att_eatt_test_connect();
+    ble_att_eatt_test_peer_reject();
+    ble_att_eatt_test_routing();
+    ble_att_eatt_test_bearer_closed();
+    ble_att_eatt_test_conn_reuse();
+#endif
+}
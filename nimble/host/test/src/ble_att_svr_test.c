@@ -40,6 +40,7 @@ static uint16_t ble_att_svr_test_n_conn_handle;
 static uint16_t ble_att_svr_test_n_attr_handle;
 static uint8_t ble_att_svr_test_attr_n[1024];
 static uint16_t ble_att_svr_test_attr_n_len;
+static int ble_att_svr_test_n_count;
 
 static void
 ble_att_svr_test_assert_mbufs_freed(void)
@@ -61,6 +62,7 @@ ble_att_svr_test_misc_gap_cb(struct ble_gap_event *event, void *arg)
 
     switch (event->type) {
     case BLE_GAP_EVENT_NOTIFY_RX:
+        ble_att_svr_test_n_count++;
         ble_att_svr_test_n_conn_handle = event->notify_rx.conn_handle;
         ble_att_svr_test_n_attr_handle = event->notify_rx.attr_handle;
         TEST_ASSERT_FATAL(OS_MBUF_PKTLEN(event->notify_rx.om) <=
@@ -487,7 +489,8 @@ ble_att_svr_test_misc_verify_tx_mtu_rsp(uint16_t conn_handle)
 
     ble_hs_lock();
 
-    rc = ble_att_conn_chan_find(conn_handle, &conn, &chan);
+    rc = ble_att_conn_chan_find(conn_handle, BLE_L2CAP_CID_ATT, &conn,
+                                &chan);
     assert(rc == 0);
     my_mtu = chan->my_mtu;
 
@@ -1031,6 +1034,129 @@ TEST_CASE_SELF(ble_att_svr_test_read_mult)
     ble_att_svr_test_assert_mbufs_freed();
 }
 
+static void
+ble_att_svr_test_misc_rx_read_mult_var_req(uint16_t conn_handle,
+                                           const uint16_t *handles,
+                                           int num_handles, int success)
+{
+    uint8_t buf[256];
+    int off;
+    int rc;
+    int i;
+
+    buf[0] = BLE_ATT_OP_READ_MULT_VAR_REQ;
+    off = BLE_ATT_READ_MULT_VAR_REQ_BASE_SZ;
+    for (i = 0; i < num_handles; i++) {
+        put_le16(buf + off, handles[i]);
+        off += 2;
+    }
+
+    rc = ble_hs_test_util_l2cap_rx_payload_flat(conn_handle, BLE_L2CAP_CID_ATT,
+                                                buf, off);
+    if (success) {
+        TEST_ASSERT(rc == 0);
+    } else {
+        TEST_ASSERT(rc != 0);
+    }
+}
+
+static void
+ble_att_svr_test_misc_verify_tx_read_mult_var_rsp(
+    struct ble_hs_test_util_flat_attr *attrs, int num_attrs)
+{
+    struct os_mbuf *om;
+    uint8_t hdr[2];
+    uint8_t u8;
+    int rc;
+    int off;
+    int i;
+
+    om = ble_hs_test_util_prev_tx_dequeue();
+    TEST_ASSERT_FATAL(om != NULL);
+
+    rc = os_mbuf_copydata(om, 0, 1, &u8);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(u8 == BLE_ATT_OP_READ_MULT_VAR_RSP);
+
+    off = 1;
+    for (i = 0; i < num_attrs; i++) {
+        rc = os_mbuf_copydata(om, off, 2, hdr);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(get_le16(hdr) == attrs[i].value_len);
+        off += 2;
+
+        rc = os_mbuf_cmpf(om, off, attrs[i].value, attrs[i].value_len);
+        TEST_ASSERT(rc == 0);
+        off += attrs[i].value_len;
+    }
+
+    TEST_ASSERT(OS_MBUF_PKTLEN(om) == off);
+}
+
+TEST_CASE_SELF(ble_att_svr_test_read_mult_var)
+{
+    uint16_t conn_handle;
+    int rc;
+
+    conn_handle = ble_att_svr_test_misc_init(0);
+
+    struct ble_hs_test_util_flat_attr attrs[2] = {
+        {
+            .handle = 0,
+            .offset = 0,
+            .value = { 1, 2, 3, 4 },
+            .value_len = 4,
+        },
+        {
+            .handle = 0,
+            .offset = 0,
+            .value = { 2, 3, 4, 5, 6 },
+            .value_len = 5,
+        },
+    };
+
+    ble_att_svr_test_attr_r_1 = attrs[0].value;
+    ble_att_svr_test_attr_r_1_len = attrs[0].value_len;
+    ble_att_svr_test_attr_r_2 = attrs[1].value;
+    ble_att_svr_test_attr_r_2_len = attrs[1].value_len;
+
+    rc = ble_att_svr_register(BLE_UUID16_DECLARE(0x1111), HA_FLAG_PERM_RW, 0,
+                              &attrs[0].handle,
+                              ble_att_svr_test_misc_attr_fn_r_1, NULL);
+    TEST_ASSERT(rc == 0);
+
+    rc = ble_att_svr_register(BLE_UUID16_DECLARE(0x2222), HA_FLAG_PERM_RW, 0,
+                              &attrs[1].handle,
+                              ble_att_svr_test_misc_attr_fn_r_2, NULL);
+    TEST_ASSERT(rc == 0);
+
+    /*** Single handle; at least two are required. */
+    ble_att_svr_test_misc_rx_read_mult_var_req(
+        conn_handle, ((uint16_t[]){ attrs[0].handle }), 1, 0);
+    ble_hs_test_util_verify_tx_err_rsp(BLE_ATT_OP_READ_MULT_VAR_REQ,
+                                       0, BLE_ATT_ERR_INVALID_PDU);
+
+    /*** Two attributes of different lengths. */
+    ble_att_svr_test_misc_rx_read_mult_var_req(
+        conn_handle, ((uint16_t[]){ attrs[0].handle, attrs[1].handle }), 2, 1);
+    ble_att_svr_test_misc_verify_tx_read_mult_var_rsp(attrs, 2);
+
+    /*** Empty value. */
+    attrs[0].value_len = 0;
+    ble_att_svr_test_attr_r_1_len = 0;
+    ble_att_svr_test_misc_rx_read_mult_var_req(
+        conn_handle, ((uint16_t[]){ attrs[0].handle, attrs[1].handle }), 2, 1);
+    ble_att_svr_test_misc_verify_tx_read_mult_var_rsp(attrs, 2);
+
+    /*** Second attribute nonexistent; verify only error txed. */
+    ble_att_svr_test_misc_rx_read_mult_var_req(
+        conn_handle, ((uint16_t[]){ attrs[0].handle, 100 }), 2, 0);
+    ble_hs_test_util_verify_tx_err_rsp(BLE_ATT_OP_READ_MULT_VAR_REQ,
+                                       100, BLE_ATT_ERR_INVALID_HANDLE);
+
+    ble_att_svr_test_assert_mbufs_freed();
+}
+
 TEST_CASE_SELF(ble_att_svr_test_write)
 {
     struct ble_hs_conn *conn;
@@ -1637,6 +1763,67 @@ TEST_CASE_SELF(ble_att_svr_test_read_group_type)
     ble_att_svr_test_assert_mbufs_freed();
 }
 
+TEST_CASE_SELF(ble_att_svr_test_hide_range)
+{
+    uint16_t conn_handle;
+    int rc;
+
+    conn_handle = ble_att_svr_test_misc_init(128);
+    ble_att_svr_test_misc_register_group_attrs();
+
+    /*** All attributes are reachable by handle. */
+    TEST_ASSERT(ble_att_svr_find_by_handle(0) == NULL);
+    TEST_ASSERT(ble_att_svr_find_by_handle(1)->ha_handle_id == 1);
+    TEST_ASSERT(ble_att_svr_find_by_handle(24)->ha_handle_id == 24);
+    TEST_ASSERT(ble_att_svr_find_by_handle(25) == NULL);
+
+    /*** Hide the first service. */
+    ble_att_svr_hide_range(1, 5);
+    TEST_ASSERT(ble_att_svr_find_by_handle(1) == NULL);
+    TEST_ASSERT(ble_att_svr_find_by_handle(5) == NULL);
+    TEST_ASSERT(ble_att_svr_find_by_handle(6)->ha_handle_id == 6);
+
+    rc = ble_hs_test_util_rx_att_read_type_req16(conn_handle, 1, 10,
+                                                 BLE_ATT_UUID_CHARACTERISTIC);
+    TEST_ASSERT(rc != 0);
+    ble_hs_test_util_verify_tx_err_rsp(
+        BLE_ATT_OP_READ_TYPE_REQ, 1,
+        BLE_ATT_ERR_ATTR_NOT_FOUND);
+
+    rc = ble_hs_test_util_rx_att_find_info_req(conn_handle, 1, 6);
+    TEST_ASSERT(rc == 0);
+    ble_hs_test_util_verify_tx_find_info_rsp(
+        ((struct ble_hs_test_util_att_info_entry[]) { {
+            .handle = 6,
+            .uuid = BLE_UUID16_DECLARE(BLE_ATT_UUID_PRIMARY_SERVICE),
+        }, {
+            .handle = 0,
+        } }));
+
+    /*** Restore the service. */
+    ble_att_svr_restore_range(1, 5);
+    TEST_ASSERT(ble_att_svr_find_by_handle(1)->ha_handle_id == 1);
+    TEST_ASSERT(ble_att_svr_find_by_handle(5)->ha_handle_id == 5);
+
+    rc = ble_hs_test_util_rx_att_read_type_req16(conn_handle, 1, 10,
+                                                 BLE_ATT_UUID_CHARACTERISTIC);
+    TEST_ASSERT(rc == 0);
+    ble_att_svr_test_misc_verify_tx_read_type_rsp(
+        ((struct ble_att_svr_test_type_entry[]) { {
+            .handle = 2,
+            .value = (uint8_t[]){ 0x01, 0x11 },
+            .value_len = 2,
+        }, {
+            .handle = 4,
+            .value = (uint8_t[]){ 0x03, 0x11 },
+            .value_len = 2,
+        }, {
+            .handle = 0,
+        } }));
+
+    ble_att_svr_test_assert_mbufs_freed();
+}
+
 TEST_CASE_SELF(ble_att_svr_test_prep_write)
 {
     struct ble_hs_conn *conn;
@@ -1824,6 +2011,56 @@ TEST_CASE_SELF(ble_att_svr_test_notify)
     ble_att_svr_test_assert_mbufs_freed();
 }
 
+TEST_CASE_SELF(ble_att_svr_test_notify_multi)
+{
+    uint16_t conn_handle;
+    uint8_t buf[32];
+    int rc;
+
+    conn_handle = ble_att_svr_test_misc_init(0);
+
+    /*** Two values; verify the callback is executed for each. */
+    buf[0] = BLE_ATT_OP_NOTIFY_MULTI_REQ;
+    put_le16(buf + 1, 10);
+    put_le16(buf + 3, 3);
+    memcpy(buf + 5, ((uint8_t[]){ 1, 2, 3 }), 3);
+    put_le16(buf + 8, 11);
+    put_le16(buf + 10, 2);
+    memcpy(buf + 12, ((uint8_t[]){ 4, 5 }), 2);
+
+    ble_att_svr_test_n_count = 0;
+    rc = ble_hs_test_util_l2cap_rx_payload_flat(conn_handle, BLE_L2CAP_CID_ATT,
+                                                buf, 14);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(ble_att_svr_test_n_count == 2);
+    TEST_ASSERT(ble_att_svr_test_n_conn_handle == conn_handle);
+    TEST_ASSERT(ble_att_svr_test_n_attr_handle == 11);
+    TEST_ASSERT(ble_att_svr_test_attr_n_len == 2);
+    TEST_ASSERT(memcmp(ble_att_svr_test_attr_n,
+                       ((uint8_t[]){ 4, 5 }), 2) == 0);
+
+    /*** Truncated last value; verify the remainder is delivered. */
+    ble_att_svr_test_n_count = 0;
+    rc = ble_hs_test_util_l2cap_rx_payload_flat(conn_handle, BLE_L2CAP_CID_ATT,
+                                                buf, 13);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(ble_att_svr_test_n_count == 2);
+    TEST_ASSERT(ble_att_svr_test_attr_n_len == 1);
+
+    /*** Attribute handle of 0; verify callback is not executed. */
+    put_le16(buf + 1, 0);
+    ble_att_svr_test_n_count = 0;
+    rc = ble_hs_test_util_l2cap_rx_payload_flat(conn_handle, BLE_L2CAP_CID_ATT,
+                                                buf, 14);
+    TEST_ASSERT(rc == BLE_HS_EBADDATA);
+    TEST_ASSERT(ble_att_svr_test_n_count == 0);
+
+    /* Notifications are not acknowledged. */
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue() == NULL);
+
+    ble_att_svr_test_assert_mbufs_freed();
+}
+
 TEST_CASE_SELF(ble_att_svr_test_prep_write_tmo)
 {
     int32_t ticks_from_now;
@@ -2124,14 +2361,17 @@ TEST_SUITE(ble_att_svr_suite)
     ble_att_svr_test_read();
     ble_att_svr_test_read_blob();
     ble_att_svr_test_read_mult();
+    ble_att_svr_test_read_mult_var();
     ble_att_svr_test_write();
     ble_att_svr_test_find_info();
     ble_att_svr_test_find_type_value();
     ble_att_svr_test_read_type();
     ble_att_svr_test_read_group_type();
+    ble_att_svr_test_hide_range();
     ble_att_svr_test_prep_write();
     ble_att_svr_test_prep_write_tmo();
     ble_att_svr_test_notify();
+    ble_att_svr_test_notify_multi();
     ble_att_svr_test_indicate();
     ble_att_svr_test_oom();
     ble_att_svr_test_unsupported_req();
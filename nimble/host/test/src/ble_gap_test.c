@@ -835,6 +835,87 @@ TEST_CASE_SELF(ble_gap_test_case_disc_busy)
     ble_hs_test_util_assert_mbufs_freed(NULL);
 }
 
+static struct ble_gap_disc_desc ble_gap_test_disc_multi_descs[2];
+static uint8_t ble_gap_test_disc_multi_data[2][3];
+static int ble_gap_test_disc_multi_count;
+
+static int
+ble_gap_test_util_disc_multi_cb(struct ble_gap_event *event, void *arg)
+{
+    struct ble_gap_disc_desc *desc;
+    int idx;
+
+    if (event->type != BLE_GAP_EVENT_DISC) {
+        return 0;
+    }
+
+    idx = ble_gap_test_disc_multi_count++;
+    TEST_ASSERT_FATAL(idx < 2);
+
+    desc = &ble_gap_test_disc_multi_descs[idx];
+    *desc = event->disc;
+
+    TEST_ASSERT_FATAL(desc->length_data <= 3);
+    memcpy(ble_gap_test_disc_multi_data[idx], desc->data, desc->length_data);
+    desc->data = ble_gap_test_disc_multi_data[idx];
+
+    return 0;
+}
+
+TEST_CASE_SELF(ble_gap_test_case_disc_multi_rpt)
+{
+    static const struct ble_gap_disc_params disc_params = { 0 };
+    struct ble_gap_disc_desc *desc;
+    int rc;
+
+    /* LE Advertising Report event with two reports. */
+    uint8_t evt[] = {
+        BLE_HCI_EVCODE_LE_META, 25,
+        BLE_HCI_LE_SUBEV_ADV_RPT, 2,
+
+        BLE_HCI_ADV_RPT_EVTYPE_ADV_IND, BLE_ADDR_PUBLIC,
+        1, 2, 3, 4, 5, 6,
+        3, 2, BLE_HS_ADV_TYPE_FLAGS, BLE_HS_ADV_F_DISC_GEN,
+        (uint8_t)-40,
+
+        BLE_HCI_ADV_RPT_EVTYPE_NONCONN_IND, BLE_ADDR_RANDOM,
+        7, 8, 9, 10, 11, 0xc0,
+        0,
+        (uint8_t)-60,
+    };
+
+    ble_gap_test_util_init();
+    ble_gap_test_disc_multi_count = 0;
+
+    rc = ble_hs_test_util_disc(BLE_OWN_ADDR_PUBLIC, BLE_HS_FOREVER,
+                               &disc_params, ble_gap_test_util_disc_multi_cb,
+                               NULL, -1, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ble_hs_test_util_hci_rx_evt(evt);
+
+    TEST_ASSERT_FATAL(ble_gap_test_disc_multi_count == 2);
+
+    desc = &ble_gap_test_disc_multi_descs[0];
+    TEST_ASSERT(desc->event_type == BLE_HCI_ADV_RPT_EVTYPE_ADV_IND);
+    TEST_ASSERT(desc->addr.type == BLE_ADDR_PUBLIC);
+    TEST_ASSERT(memcmp(desc->addr.val, ((uint8_t[6]){ 1, 2, 3, 4, 5, 6 }),
+                       6) == 0);
+    TEST_ASSERT(desc->length_data == 3);
+    TEST_ASSERT(desc->data[2] == BLE_HS_ADV_F_DISC_GEN);
+    TEST_ASSERT(desc->rssi == -40);
+
+    desc = &ble_gap_test_disc_multi_descs[1];
+    TEST_ASSERT(desc->event_type == BLE_HCI_ADV_RPT_EVTYPE_NONCONN_IND);
+    TEST_ASSERT(desc->addr.type == BLE_ADDR_RANDOM);
+    TEST_ASSERT(memcmp(desc->addr.val,
+                       ((uint8_t[6]){ 7, 8, 9, 10, 11, 0xc0 }), 6) == 0);
+    TEST_ASSERT(desc->length_data == 0);
+    TEST_ASSERT(desc->rssi == -60);
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
 TEST_SUITE(ble_gap_test_suite_disc)
 {
     ble_gap_test_case_disc_bad_args();
@@ -844,6 +925,7 @@ TEST_SUITE(ble_gap_test_suite_disc)
     ble_gap_test_case_disc_dflts();
     ble_gap_test_case_disc_already();
     ble_gap_test_case_disc_busy();
+    ble_gap_test_case_disc_multi_rpt();
 }
 
 /*****************************************************************************
@@ -0,0 +1,509 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "testutil/testutil.h"
+#include "nimble/ble.h"
+#include "host/ble_gatt.h"
+#include "host/ble_store.h"
+#include "host/ble_uuid.h"
+#include "ble_hs_test.h"
+#include "ble_hs_test_util.h"
+
+#if MYNEWT_VAL(BLE_GATT_CACHING)
+
+/*
+ * Peer database used by every test:
+ *     1-5: Battery service
+ *         2: characteristic declaration (value 3, 0x2a19, read|notify)
+ *         4: CCCD
+ *         5: Characteristic User Description
+ *     6-9: GATT service
+ *         7: characteristic declaration (value 8, 0x2a05, indicate)
+ *         9: CCCD
+ */
+
+static const uint8_t ble_gatt_cache_test_hash[BLE_GATT_DB_HASH_SZ] = {
+    0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+    0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+};
+
+static const uint8_t ble_gatt_cache_test_hash2[BLE_GATT_DB_HASH_SZ] = {
+    0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18,
+    0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20,
+};
+
+static int ble_gatt_cache_test_status;
+static int ble_gatt_cache_test_num_cbs;
+
+static struct ble_gatt_svc ble_gatt_cache_test_svcs[4];
+static int ble_gatt_cache_test_num_svcs;
+static struct ble_gatt_chr ble_gatt_cache_test_chrs[4];
+static int ble_gatt_cache_test_num_chrs;
+static struct ble_gatt_dsc ble_gatt_cache_test_dscs[4];
+static int ble_gatt_cache_test_num_dscs;
+static int ble_gatt_cache_test_disc_done;
+
+static void
+ble_gatt_cache_test_init(void)
+{
+    ble_hs_test_util_init();
+
+    ble_gatt_cache_test_status = -1;
+    ble_gatt_cache_test_num_cbs = 0;
+    ble_gatt_cache_test_num_svcs = 0;
+    ble_gatt_cache_test_num_chrs = 0;
+    ble_gatt_cache_test_num_dscs = 0;
+    ble_gatt_cache_test_disc_done = 0;
+}
+
+static int
+ble_gatt_cache_test_cb(uint16_t conn_handle, int status, void *arg)
+{
+    ble_gatt_cache_test_status = status;
+    ble_gatt_cache_test_num_cbs++;
+    return 0;
+}
+
+static int
+ble_gatt_cache_test_svc_cb(uint16_t conn_handle,
+                           const struct ble_gatt_error *error,
+                           const struct ble_gatt_svc *service, void *arg)
+{
+    if (error->status == 0) {
+        TEST_ASSERT_FATAL(ble_gatt_cache_test_num_svcs < 4);
+        ble_gatt_cache_test_svcs[ble_gatt_cache_test_num_svcs++] = *service;
+    } else {
+        TEST_ASSERT(error->status == BLE_HS_EDONE);
+        ble_gatt_cache_test_disc_done = 1;
+    }
+
+    return 0;
+}
+
+static int
+ble_gatt_cache_test_chr_cb(uint16_t conn_handle,
+                           const struct ble_gatt_error *error,
+                           const struct ble_gatt_chr *chr, void *arg)
+{
+    if (error->status == 0) {
+        TEST_ASSERT_FATAL(ble_gatt_cache_test_num_chrs < 4);
+        ble_gatt_cache_test_chrs[ble_gatt_cache_test_num_chrs++] = *chr;
+    } else {
+        TEST_ASSERT(error->status == BLE_HS_EDONE);
+        ble_gatt_cache_test_disc_done = 1;
+    }
+
+    return 0;
+}
+
+static int
+ble_gatt_cache_test_dsc_cb(uint16_t conn_handle,
+                           const struct ble_gatt_error *error,
+                           uint16_t chr_val_handle,
+                           const struct ble_gatt_dsc *dsc, void *arg)
+{
+    if (error->status == 0) {
+        TEST_ASSERT_FATAL(ble_gatt_cache_test_num_dscs < 4);
+        ble_gatt_cache_test_dscs[ble_gatt_cache_test_num_dscs++] = *dsc;
+    } else {
+        TEST_ASSERT(error->status == BLE_HS_EDONE);
+        ble_gatt_cache_test_disc_done = 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Verifies that the next outgoing ATT PDU has the specified opcode.
+ */
+static void
+ble_gatt_cache_test_verify_tx(uint8_t op)
+{
+    struct os_mbuf *om;
+
+    om = ble_hs_test_util_prev_tx_dequeue_pullup();
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT(om->om_data[0] == op);
+}
+
+static void
+ble_gatt_cache_test_rx(uint16_t conn_handle, const void *data, int len)
+{
+    int rc;
+
+    rc = ble_hs_test_util_l2cap_rx_payload_flat(conn_handle, BLE_L2CAP_CID_ATT,
+                                                data, len);
+    TEST_ASSERT(rc == 0);
+}
+
+/**
+ * Answers the Database Hash read; a null hash means the peer does not expose
+ * one.
+ */
+static void
+ble_gatt_cache_test_rx_hash(uint16_t conn_handle, const uint8_t *db_hash)
+{
+    uint8_t buf[2 + 2 + BLE_GATT_DB_HASH_SZ];
+
+    ble_gatt_cache_test_verify_tx(BLE_ATT_OP_READ_TYPE_REQ);
+
+    if (db_hash == NULL) {
+        ble_hs_test_util_rx_att_err_rsp(conn_handle, BLE_ATT_OP_READ_TYPE_REQ,
+                                        BLE_ATT_ERR_ATTR_NOT_FOUND, 1);
+        return;
+    }
+
+    buf[0] = BLE_ATT_OP_READ_TYPE_RSP;
+    buf[1] = 2 + BLE_GATT_DB_HASH_SZ;
+    put_le16(buf + 2, 0x0100);
+    memcpy(buf + 4, db_hash, BLE_GATT_DB_HASH_SZ);
+    ble_gatt_cache_test_rx(conn_handle, buf, sizeof buf);
+}
+
+/**
+ * Connects to a peer; a secure connection is encrypted and bonded.
+ */
+static void
+ble_gatt_cache_test_connect(uint16_t conn_handle, const uint8_t *peer_addr,
+                            int secure)
+{
+    struct ble_hs_conn *conn;
+
+    ble_hs_test_util_create_conn(conn_handle, peer_addr, NULL, NULL);
+    ble_hs_test_util_prev_tx_queue_clear();
+
+    if (secure) {
+        ble_hs_lock();
+        conn = ble_hs_conn_find(conn_handle);
+        TEST_ASSERT_FATAL(conn != NULL);
+        conn->bhc_sec_state.encrypted = 1;
+        conn->bhc_sec_state.bonded = 1;
+        ble_hs_unlock();
+    }
+}
+
+/**
+ * Answers the discovery that populates the cache with the test database.
+ */
+static void
+ble_gatt_cache_test_rx_db(uint16_t conn_handle)
+{
+    static const uint8_t svcs_rsp[] = {
+        BLE_ATT_OP_READ_GROUP_TYPE_RSP, 6,
+        0x01, 0x00, 0x05, 0x00, 0x0f, 0x18,
+        0x06, 0x00, 0x09, 0x00, 0x01, 0x18,
+    };
+    static const uint8_t chrs_a_rsp[] = {
+        BLE_ATT_OP_READ_TYPE_RSP, 7,
+        0x02, 0x00, BLE_GATT_CHR_PROP_READ | BLE_GATT_CHR_PROP_NOTIFY,
+        0x03, 0x00, 0x19, 0x2a,
+    };
+    static const uint8_t chrs_b_rsp[] = {
+        BLE_ATT_OP_READ_TYPE_RSP, 7,
+        0x07, 0x00, BLE_GATT_CHR_PROP_INDICATE, 0x08, 0x00, 0x05, 0x2a,
+    };
+    static const uint8_t dscs_a_rsp[] = {
+        BLE_ATT_OP_FIND_INFO_RSP, BLE_ATT_FIND_INFO_RSP_FORMAT_16BIT,
+        0x02, 0x00, 0x03, 0x28,
+        0x03, 0x00, 0x19, 0x2a,
+        0x04, 0x00, 0x02, 0x29,
+        0x05, 0x00, 0x01, 0x29,
+    };
+    static const uint8_t dscs_b_rsp[] = {
+        BLE_ATT_OP_FIND_INFO_RSP, BLE_ATT_FIND_INFO_RSP_FORMAT_16BIT,
+        0x07, 0x00, 0x03, 0x28,
+        0x08, 0x00, 0x05, 0x2a,
+        0x09, 0x00, 0x02, 0x29,
+    };
+
+    ble_gatt_cache_test_verify_tx(BLE_ATT_OP_READ_GROUP_TYPE_REQ);
+    ble_gatt_cache_test_rx(conn_handle, svcs_rsp, sizeof svcs_rsp);
+    ble_gatt_cache_test_verify_tx(BLE_ATT_OP_READ_GROUP_TYPE_REQ);
+    ble_hs_test_util_rx_att_err_rsp(conn_handle,
+                                    BLE_ATT_OP_READ_GROUP_TYPE_REQ,
+                                    BLE_ATT_ERR_ATTR_NOT_FOUND, 10);
+
+    ble_gatt_cache_test_verify_tx(BLE_ATT_OP_READ_TYPE_REQ);
+    ble_gatt_cache_test_rx(conn_handle, chrs_a_rsp, sizeof chrs_a_rsp);
+    ble_gatt_cache_test_verify_tx(BLE_ATT_OP_READ_TYPE_REQ);
+    ble_hs_test_util_rx_att_err_rsp(conn_handle, BLE_ATT_OP_READ_TYPE_REQ,
+                                    BLE_ATT_ERR_ATTR_NOT_FOUND, 3);
+
+    ble_gatt_cache_test_verify_tx(BLE_ATT_OP_READ_TYPE_REQ);
+    ble_gatt_cache_test_rx(conn_handle, chrs_b_rsp, sizeof chrs_b_rsp);
+    ble_gatt_cache_test_verify_tx(BLE_ATT_OP_READ_TYPE_REQ);
+    ble_hs_test_util_rx_att_err_rsp(conn_handle, BLE_ATT_OP_READ_TYPE_REQ,
+                                    BLE_ATT_ERR_ATTR_NOT_FOUND, 8);
+
+    ble_gatt_cache_test_verify_tx(BLE_ATT_OP_FIND_INFO_REQ);
+    ble_gatt_cache_test_rx(conn_handle, dscs_a_rsp, sizeof dscs_a_rsp);
+    ble_gatt_cache_test_verify_tx(BLE_ATT_OP_FIND_INFO_REQ);
+    ble_gatt_cache_test_rx(conn_handle, dscs_b_rsp, sizeof dscs_b_rsp);
+}
+
+/**
+ * Runs the cache procedure over a secure connection, expecting the test
+ * database to be discovered and stored, for a total of the specified number
+ * of trees in the store.
+ */
+static void
+ble_gatt_cache_test_fill(uint16_t conn_handle, const uint8_t *db_hash,
+                         int exp_trees)
+{
+    int num_cbs;
+    int count;
+    int rc;
+
+    num_cbs = ble_gatt_cache_test_num_cbs;
+
+    rc = ble_gattc_cache_discover(conn_handle, ble_gatt_cache_test_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ble_gatt_cache_test_rx_hash(conn_handle, db_hash);
+    ble_gatt_cache_test_rx_db(conn_handle);
+
+    TEST_ASSERT(ble_gatt_cache_test_num_cbs == num_cbs + 1);
+    TEST_ASSERT(ble_gatt_cache_test_status == 0);
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue_pullup() == NULL);
+
+    /* 2 services, 2 characteristics, 3 descriptors and the terminator. */
+    rc = ble_store_util_count(BLE_STORE_OBJ_TYPE_PEER_ATTR, &count);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(count == 8 * exp_trees);
+}
+
+TEST_CASE_SELF(ble_gatt_cache_test_fill_serve)
+{
+    int rc;
+
+    ble_gatt_cache_test_init();
+    ble_gatt_cache_test_connect(2, ((uint8_t[]){2,3,4,5,6,7}), 1);
+    ble_gatt_cache_test_fill(2, ble_gatt_cache_test_hash, 1);
+
+    /* Discovery is answered locally. */
+    rc = ble_gattc_disc_all_svcs(2, ble_gatt_cache_test_svc_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ble_gatt_cache_test_disc_done);
+    TEST_ASSERT_FATAL(ble_gatt_cache_test_num_svcs == 2);
+    TEST_ASSERT(ble_gatt_cache_test_svcs[0].start_handle == 1);
+    TEST_ASSERT(ble_gatt_cache_test_svcs[0].end_handle == 5);
+    TEST_ASSERT(ble_uuid_u16(&ble_gatt_cache_test_svcs[0].uuid.u) == 0x180f);
+    TEST_ASSERT(ble_gatt_cache_test_svcs[1].start_handle == 6);
+    TEST_ASSERT(ble_gatt_cache_test_svcs[1].end_handle == 9);
+
+    ble_gatt_cache_test_num_svcs = 0;
+    ble_gatt_cache_test_disc_done = 0;
+    rc = ble_gattc_disc_svc_by_uuid(2, BLE_UUID16_DECLARE(0x1801),
+                                    ble_gatt_cache_test_svc_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ble_gatt_cache_test_disc_done);
+    TEST_ASSERT_FATAL(ble_gatt_cache_test_num_svcs == 1);
+    TEST_ASSERT(ble_gatt_cache_test_svcs[0].start_handle == 6);
+
+    rc = ble_gattc_disc_all_chrs(2, 1, 5, ble_gatt_cache_test_chr_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(ble_gatt_cache_test_num_chrs == 1);
+    TEST_ASSERT(ble_gatt_cache_test_chrs[0].def_handle == 2);
+    TEST_ASSERT(ble_gatt_cache_test_chrs[0].val_handle == 3);
+    TEST_ASSERT(ble_gatt_cache_test_chrs[0].properties ==
+                (BLE_GATT_CHR_PROP_READ | BLE_GATT_CHR_PROP_NOTIFY));
+    TEST_ASSERT(ble_uuid_u16(&ble_gatt_cache_test_chrs[0].uuid.u) == 0x2a19);
+
+    rc = ble_gattc_disc_all_dscs(2, 3, 5, ble_gatt_cache_test_dsc_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(ble_gatt_cache_test_num_dscs == 2);
+    TEST_ASSERT(ble_gatt_cache_test_dscs[0].handle == 4);
+    TEST_ASSERT(ble_uuid_u16(&ble_gatt_cache_test_dscs[0].uuid.u) == 0x2902);
+    TEST_ASSERT(ble_gatt_cache_test_dscs[1].handle == 5);
+    TEST_ASSERT(ble_uuid_u16(&ble_gatt_cache_test_dscs[1].uuid.u) == 0x2901);
+
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue_pullup() == NULL);
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
+TEST_CASE_SELF(ble_gatt_cache_test_per_peer)
+{
+    static const uint8_t svc_changed_ind[] = {
+        BLE_ATT_OP_INDICATE_REQ, 0x08, 0x00, 0x01, 0x00, 0xff, 0xff,
+    };
+    int count;
+    int rc;
+
+    ble_gatt_cache_test_init();
+    ble_gatt_cache_test_connect(2, ((uint8_t[]){2,3,4,5,6,7}), 1);
+    ble_gatt_cache_test_fill(2, ble_gatt_cache_test_hash, 1);
+
+    /* A second peer with the same database hash gets a tree of its own. */
+    ble_gatt_cache_test_connect(3, ((uint8_t[]){3,4,5,6,7,8}), 1);
+    ble_gatt_cache_test_fill(3, ble_gatt_cache_test_hash, 2);
+
+    rc = ble_gattc_disc_all_chrs(3, 6, 9, ble_gatt_cache_test_chr_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(ble_gatt_cache_test_num_chrs == 1);
+    TEST_ASSERT(ble_gatt_cache_test_chrs[0].val_handle == 8);
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue_pullup() == NULL);
+
+    /* Service Changed puts the second peer back on the air and deletes its
+     * tree; the first peer's tree stays.
+     */
+    ble_gatt_cache_test_rx(3, svc_changed_ind, sizeof svc_changed_ind);
+    ble_hs_test_util_prev_tx_queue_clear();
+
+    rc = ble_gattc_disc_all_svcs(3, ble_gatt_cache_test_svc_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    ble_gatt_cache_test_verify_tx(BLE_ATT_OP_READ_GROUP_TYPE_REQ);
+    TEST_ASSERT(ble_gatt_cache_test_num_svcs == 0);
+
+    rc = ble_store_util_count(BLE_STORE_OBJ_TYPE_PEER_ATTR, &count);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(count == 8);
+
+    rc = ble_gattc_disc_all_svcs(2, ble_gatt_cache_test_svc_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ble_gatt_cache_test_num_svcs == 2);
+
+    /* The tree is found again over the first peer's next connection. */
+    rc = ble_gattc_cache_discover(2, ble_gatt_cache_test_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    ble_gatt_cache_test_rx_hash(2, ble_gatt_cache_test_hash);
+
+    TEST_ASSERT(ble_gatt_cache_test_status == 0);
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue_pullup() == NULL);
+}
+
+TEST_CASE_SELF(ble_gatt_cache_test_hash_changed)
+{
+    int rc;
+
+    ble_gatt_cache_test_init();
+    ble_gatt_cache_test_connect(2, ((uint8_t[]){2,3,4,5,6,7}), 1);
+    ble_gatt_cache_test_fill(2, ble_gatt_cache_test_hash, 1);
+
+    /* A new hash replaces the peer's tree. */
+    ble_gatt_cache_test_fill(2, ble_gatt_cache_test_hash2, 1);
+
+    /* So does losing the hash: a tree stored under a hash is not taken for
+     * one without.
+     */
+    ble_gatt_cache_test_fill(2, NULL, 1);
+
+    rc = ble_gattc_cache_discover(2, ble_gatt_cache_test_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    ble_gatt_cache_test_rx_hash(2, NULL);
+
+    TEST_ASSERT(ble_gatt_cache_test_status == 0);
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue_pullup() == NULL);
+
+    rc = ble_gattc_disc_all_svcs(2, ble_gatt_cache_test_svc_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ble_gatt_cache_test_num_svcs == 2);
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue_pullup() == NULL);
+}
+
+TEST_CASE_SELF(ble_gatt_cache_test_insecure)
+{
+    struct ble_hs_conn *conn;
+    int count;
+    int rc;
+
+    ble_gatt_cache_test_init();
+
+    /* A peer exposing a Database Hash over an unencrypted link is not
+     * cached.
+     */
+    ble_gatt_cache_test_connect(2, ((uint8_t[]){2,3,4,5,6,7}), 0);
+
+    rc = ble_gattc_cache_discover(2, ble_gatt_cache_test_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    ble_gatt_cache_test_rx_hash(2, ble_gatt_cache_test_hash);
+
+    TEST_ASSERT(ble_gatt_cache_test_num_cbs == 1);
+    TEST_ASSERT(ble_gatt_cache_test_status == 0);
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue_pullup() == NULL);
+
+    /* Nor is an encrypted but unbonded one. */
+    ble_hs_lock();
+    conn = ble_hs_conn_find(2);
+    TEST_ASSERT_FATAL(conn != NULL);
+    conn->bhc_sec_state.encrypted = 1;
+    ble_hs_unlock();
+
+    rc = ble_gattc_cache_discover(2, ble_gatt_cache_test_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    ble_gatt_cache_test_rx_hash(2, ble_gatt_cache_test_hash);
+
+    TEST_ASSERT(ble_gatt_cache_test_num_cbs == 2);
+    TEST_ASSERT(ble_gatt_cache_test_status == 0);
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue_pullup() == NULL);
+
+    rc = ble_store_util_count(BLE_STORE_OBJ_TYPE_PEER_ATTR, &count);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(count == 0);
+
+    rc = ble_gattc_disc_all_svcs(2, ble_gatt_cache_test_svc_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    ble_gatt_cache_test_verify_tx(BLE_ATT_OP_READ_GROUP_TYPE_REQ);
+}
+
+TEST_CASE_SELF(ble_gatt_cache_test_no_hash)
+{
+    int count;
+    int rc;
+
+    ble_gatt_cache_test_init();
+
+    /* An unbonded peer without a Database Hash is not cached. */
+    ble_gatt_cache_test_connect(2, ((uint8_t[]){2,3,4,5,6,7}), 0);
+
+    rc = ble_gattc_cache_discover(2, ble_gatt_cache_test_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = ble_gattc_cache_discover(2, ble_gatt_cache_test_cb, NULL);
+    TEST_ASSERT(rc == BLE_HS_EALREADY);
+
+    ble_gatt_cache_test_verify_tx(BLE_ATT_OP_READ_TYPE_REQ);
+    ble_hs_test_util_rx_att_err_rsp(2, BLE_ATT_OP_READ_TYPE_REQ,
+                                    BLE_ATT_ERR_ATTR_NOT_FOUND, 1);
+
+    TEST_ASSERT(ble_gatt_cache_test_num_cbs == 1);
+    TEST_ASSERT(ble_gatt_cache_test_status == 0);
+
+    rc = ble_store_util_count(BLE_STORE_OBJ_TYPE_PEER_ATTR, &count);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(count == 0);
+
+    rc = ble_gattc_disc_all_svcs(2, ble_gatt_cache_test_svc_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    ble_gatt_cache_test_verify_tx(BLE_ATT_OP_READ_GROUP_TYPE_REQ);
+}
+
+#endif
+
+TEST_SUITE(ble_gatt_cache_test_suite)
+{
+#if MYNEWT_VAL(BLE_GATT_CACHING)
+    ble_gatt_cache_test_fill_serve();
+    ble_gatt_cache_test_per_peer();
+    ble_gatt_cache_test_hash_changed();
+    ble_gatt_cache_test_insecure();
+    ble_gatt_cache_test_no_hash();
+#endif
+}
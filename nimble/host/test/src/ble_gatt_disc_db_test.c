@@ -0,0 +1,835 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "testutil/testutil.h"
+#include "nimble/ble.h"
+#include "host/ble_gatt.h"
+#include "host/ble_uuid.h"
+#include "ble_hs_test.h"
+#include "ble_hs_test_util.h"
+
+#if MYNEWT_VAL(BLE_GATT_DISC_DB)
+
+/*
+ * Peer database used by every test:
+ *     1-6: Battery service
+ *         2: characteristic declaration (value 3, 0x2a19)
+ *         4: CCCD
+ *         5: characteristic declaration (value 6, 0x2a1a)
+ *     7-10: GATT service
+ *         8: characteristic declaration (value 9, 0x2a05)
+ *         10: CCCD
+ */
+
+/* A database with more characteristics than the descriptor range queue
+ * holds; see ble_gatt_disc_db_test_many_chrs.
+ */
+#define BLE_GATT_DISC_DB_TEST_MANY_CHRS     \
+    (MYNEWT_VAL(BLE_GATT_DISC_DB_MAX_CHRS) + 8)
+
+/* The database of the multi-bearer tests; see ble_gatt_disc_db_test_mb_rx.
+ * Some services are beyond the ones remembered for bounding descriptor
+ * ranges.
+ */
+#define BLE_GATT_DISC_DB_TEST_MB_SVCS       \
+    (MYNEWT_VAL(BLE_GATT_DISC_DB_MAX_SVCS) + 2)
+#define BLE_GATT_DISC_DB_TEST_MB_SVC_CHRS   2
+#define BLE_GATT_DISC_DB_TEST_MB_SVC_SZ     \
+    (1 + 3 * BLE_GATT_DISC_DB_TEST_MB_SVC_CHRS)
+
+#define BLE_GATT_DISC_DB_TEST_MAX_ATTRS     BLE_GATT_DISC_DB_TEST_MANY_CHRS
+
+static struct ble_gatt_svc ble_gatt_disc_db_test_svcs[
+    BLE_GATT_DISC_DB_TEST_MAX_ATTRS];
+static int ble_gatt_disc_db_test_num_svcs;
+static struct ble_gatt_chr ble_gatt_disc_db_test_chrs[
+    BLE_GATT_DISC_DB_TEST_MAX_ATTRS];
+static int ble_gatt_disc_db_test_num_chrs;
+static struct ble_gatt_dsc ble_gatt_disc_db_test_dscs[
+    BLE_GATT_DISC_DB_TEST_MAX_ATTRS];
+static uint16_t ble_gatt_disc_db_test_dsc_chrs[
+    BLE_GATT_DISC_DB_TEST_MAX_ATTRS];
+static int ble_gatt_disc_db_test_num_dscs;
+
+static int ble_gatt_disc_db_test_num_done;
+static int ble_gatt_disc_db_test_status;
+static uint16_t ble_gatt_disc_db_test_num_reqs;
+
+/* The callback aborts the procedure on this characteristic; 0 for none. */
+static uint16_t ble_gatt_disc_db_test_abort_chr;
+
+static void
+ble_gatt_disc_db_test_init(void)
+{
+    ble_hs_test_util_init();
+
+    ble_gatt_disc_db_test_num_svcs = 0;
+    ble_gatt_disc_db_test_num_chrs = 0;
+    ble_gatt_disc_db_test_num_dscs = 0;
+    ble_gatt_disc_db_test_num_done = 0;
+    ble_gatt_disc_db_test_status = -1;
+    ble_gatt_disc_db_test_num_reqs = 0;
+    ble_gatt_disc_db_test_abort_chr = 0;
+
+    ble_hs_test_util_create_conn(2, ((uint8_t[]){2,3,4,5,6,7}), NULL, NULL);
+    ble_hs_test_util_prev_tx_queue_clear();
+}
+
+static int
+ble_gatt_disc_db_test_cb(uint16_t conn_handle,
+                         const struct ble_gatt_disc_db_event *event,
+                         void *arg)
+{
+    TEST_ASSERT(conn_handle == 2);
+    TEST_ASSERT(ble_gatt_disc_db_test_num_done == 0);
+
+    switch (event->type) {
+    case BLE_GATT_DISC_DB_EVENT_SVC:
+        TEST_ASSERT_FATAL(ble_gatt_disc_db_test_num_svcs <
+                          BLE_GATT_DISC_DB_TEST_MAX_ATTRS);
+        ble_gatt_disc_db_test_svcs[ble_gatt_disc_db_test_num_svcs++] =
+            *event->svc;
+        return 0;
+
+    case BLE_GATT_DISC_DB_EVENT_CHR:
+        TEST_ASSERT_FATAL(ble_gatt_disc_db_test_num_chrs <
+                          BLE_GATT_DISC_DB_TEST_MAX_ATTRS);
+        ble_gatt_disc_db_test_chrs[ble_gatt_disc_db_test_num_chrs++] =
+            *event->chr;
+        return event->chr->val_handle == ble_gatt_disc_db_test_abort_chr;
+
+    case BLE_GATT_DISC_DB_EVENT_DSC:
+        TEST_ASSERT_FATAL(ble_gatt_disc_db_test_num_dscs <
+                          BLE_GATT_DISC_DB_TEST_MAX_ATTRS);
+        ble_gatt_disc_db_test_dsc_chrs[ble_gatt_disc_db_test_num_dscs] =
+            event->dsc.chr_val_handle;
+        ble_gatt_disc_db_test_dscs[ble_gatt_disc_db_test_num_dscs++] =
+            *event->dsc.dsc;
+        return 0;
+
+    case BLE_GATT_DISC_DB_EVENT_DONE:
+        ble_gatt_disc_db_test_num_done++;
+        ble_gatt_disc_db_test_status = event->done.status;
+        ble_gatt_disc_db_test_num_reqs = event->done.num_reqs;
+        return 0;
+
+    default:
+        TEST_ASSERT(0);
+        return 0;
+    }
+}
+
+static void
+ble_gatt_disc_db_test_rx(const void *data, int len)
+{
+    int rc;
+
+    rc = ble_hs_test_util_l2cap_rx_payload_flat(2, BLE_L2CAP_CID_ATT,
+                                                data, len);
+    TEST_ASSERT(rc == 0);
+}
+
+/**
+ * Verifies that the next outgoing ATT PDU has the specified opcode and
+ * handle range.
+ */
+static void
+ble_gatt_disc_db_test_verify_tx(uint8_t op, uint16_t start_handle,
+                                uint16_t end_handle)
+{
+    struct os_mbuf *om;
+
+    om = ble_hs_test_util_prev_tx_dequeue_pullup();
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT(om->om_data[0] == op);
+    TEST_ASSERT(get_le16(om->om_data + 1) == start_handle);
+    TEST_ASSERT(get_le16(om->om_data + 3) == end_handle);
+}
+
+static void
+ble_gatt_disc_db_test_rx_svcs(void)
+{
+    static const uint8_t svcs_rsp[] = {
+        BLE_ATT_OP_READ_GROUP_TYPE_RSP, 6,
+        0x01, 0x00, 0x06, 0x00, 0x0f, 0x18,
+        0x07, 0x00, 0x0a, 0x00, 0x01, 0x18,
+    };
+
+    ble_gatt_disc_db_test_verify_tx(BLE_ATT_OP_READ_GROUP_TYPE_REQ,
+                                    1, 0xffff);
+    ble_gatt_disc_db_test_rx(svcs_rsp, sizeof svcs_rsp);
+    ble_gatt_disc_db_test_verify_tx(BLE_ATT_OP_READ_GROUP_TYPE_REQ,
+                                    11, 0xffff);
+    ble_hs_test_util_rx_att_err_rsp(2, BLE_ATT_OP_READ_GROUP_TYPE_REQ,
+                                    BLE_ATT_ERR_ATTR_NOT_FOUND, 11);
+}
+
+static void
+ble_gatt_disc_db_test_rx_chrs(void)
+{
+    /* Every characteristic fits in a single response. */
+    static const uint8_t chrs_rsp[] = {
+        BLE_ATT_OP_READ_TYPE_RSP, 7,
+        0x02, 0x00, BLE_GATT_CHR_PROP_READ, 0x03, 0x00, 0x19, 0x2a,
+        0x05, 0x00, BLE_GATT_CHR_PROP_READ, 0x06, 0x00, 0x1a, 0x2a,
+        0x08, 0x00, BLE_GATT_CHR_PROP_INDICATE, 0x09, 0x00, 0x05, 0x2a,
+    };
+
+    ble_gatt_disc_db_test_verify_tx(BLE_ATT_OP_READ_TYPE_REQ, 1, 0xffff);
+    ble_gatt_disc_db_test_rx(chrs_rsp, sizeof chrs_rsp);
+}
+
+TEST_CASE_SELF(ble_gatt_disc_db_test_all)
+{
+    static const uint8_t dscs_a_rsp[] = {
+        BLE_ATT_OP_FIND_INFO_RSP, BLE_ATT_FIND_INFO_RSP_FORMAT_16BIT,
+        0x04, 0x00, 0x02, 0x29,
+    };
+    static const uint8_t dscs_b_rsp[] = {
+        BLE_ATT_OP_FIND_INFO_RSP, BLE_ATT_FIND_INFO_RSP_FORMAT_16BIT,
+        0x0a, 0x00, 0x02, 0x29,
+    };
+    int rc;
+
+    ble_gatt_disc_db_test_init();
+
+    rc = ble_gattc_disc_db(2, ble_gatt_disc_db_test_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = ble_gattc_disc_db(2, ble_gatt_disc_db_test_cb, NULL);
+    TEST_ASSERT(rc == BLE_HS_EALREADY);
+
+    /* A single bearer; phases run one after another. */
+    ble_gatt_disc_db_test_rx_svcs();
+    TEST_ASSERT_FATAL(ble_gatt_disc_db_test_num_svcs == 2);
+    TEST_ASSERT(ble_gatt_disc_db_test_svcs[0].end_handle == 6);
+    TEST_ASSERT(ble_gatt_disc_db_test_svcs[1].start_handle == 7);
+
+    ble_gatt_disc_db_test_rx_chrs();
+    ble_gatt_disc_db_test_verify_tx(BLE_ATT_OP_READ_TYPE_REQ, 9, 0xffff);
+    ble_hs_test_util_rx_att_err_rsp(2, BLE_ATT_OP_READ_TYPE_REQ,
+                                    BLE_ATT_ERR_ATTR_NOT_FOUND, 9);
+    TEST_ASSERT_FATAL(ble_gatt_disc_db_test_num_chrs == 3);
+    TEST_ASSERT(ble_gatt_disc_db_test_chrs[1].val_handle == 6);
+
+    /* Descriptor ranges stop at the end of the service; the second
+     * characteristic has no room for descriptors.
+     */
+    ble_gatt_disc_db_test_verify_tx(BLE_ATT_OP_FIND_INFO_REQ, 4, 4);
+    ble_gatt_disc_db_test_rx(dscs_a_rsp, sizeof dscs_a_rsp);
+    ble_gatt_disc_db_test_verify_tx(BLE_ATT_OP_FIND_INFO_REQ, 10, 10);
+    TEST_ASSERT(ble_gatt_disc_db_test_num_done == 0);
+    ble_gatt_disc_db_test_rx(dscs_b_rsp, sizeof dscs_b_rsp);
+
+    TEST_ASSERT_FATAL(ble_gatt_disc_db_test_num_dscs == 2);
+    TEST_ASSERT(ble_gatt_disc_db_test_dscs[0].handle == 4);
+    TEST_ASSERT(ble_gatt_disc_db_test_dsc_chrs[0] == 3);
+    TEST_ASSERT(ble_gatt_disc_db_test_dscs[1].handle == 10);
+    TEST_ASSERT(ble_gatt_disc_db_test_dsc_chrs[1] == 9);
+    TEST_ASSERT(ble_uuid_u16(&ble_gatt_disc_db_test_dscs[1].uuid.u) ==
+                0x2902);
+
+    TEST_ASSERT(ble_gatt_disc_db_test_num_done == 1);
+    TEST_ASSERT(ble_gatt_disc_db_test_status == 0);
+    TEST_ASSERT(ble_gatt_disc_db_test_num_reqs == 6);
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue_pullup() == NULL);
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
+TEST_CASE_SELF(ble_gatt_disc_db_test_err)
+{
+    int rc;
+
+    ble_gatt_disc_db_test_init();
+
+    rc = ble_gattc_disc_db(2, ble_gatt_disc_db_test_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ble_gatt_disc_db_test_rx_svcs();
+    ble_gatt_disc_db_test_verify_tx(BLE_ATT_OP_READ_TYPE_REQ, 1, 0xffff);
+    ble_hs_test_util_rx_att_err_rsp(2, BLE_ATT_OP_READ_TYPE_REQ,
+                                    BLE_ATT_ERR_INSUFFICIENT_AUTHEN, 1);
+
+    TEST_ASSERT(ble_gatt_disc_db_test_num_done == 1);
+    TEST_ASSERT(ble_gatt_disc_db_test_status ==
+                BLE_HS_ATT_ERR(BLE_ATT_ERR_INSUFFICIENT_AUTHEN));
+    TEST_ASSERT(ble_gatt_disc_db_test_num_reqs == 3);
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue_pullup() == NULL);
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
+TEST_CASE_SELF(ble_gatt_disc_db_test_abort)
+{
+    int rc;
+
+    ble_gatt_disc_db_test_init();
+    ble_gatt_disc_db_test_abort_chr = 6;
+
+    rc = ble_gattc_disc_db(2, ble_gatt_disc_db_test_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ble_gatt_disc_db_test_rx_svcs();
+    ble_gatt_disc_db_test_rx_chrs();
+
+    /* Nothing is reported after the application aborted. */
+    TEST_ASSERT(ble_gatt_disc_db_test_num_chrs == 2);
+    TEST_ASSERT(ble_gatt_disc_db_test_num_done == 0);
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue_pullup() == NULL);
+
+    /* The procedure can be started again. */
+    rc = ble_gattc_disc_db(2, ble_gatt_disc_db_test_cb, NULL);
+    TEST_ASSERT(rc == 0);
+    ble_gatt_disc_db_test_verify_tx(BLE_ATT_OP_READ_GROUP_TYPE_REQ,
+                                    1, 0xffff);
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
+/**
+ * Answers the next request of a procedure discovering a database of a single
+ * service, 1-(3 * BLE_GATT_DISC_DB_TEST_MANY_CHRS + 1), where the nth
+ * characteristic is declared at 3n + 2 and followed by its value and a CCCD.
+ *
+ * @return                      The opcode of the request; 0 if none was
+ *                                  sent.
+ */
+static uint8_t
+ble_gatt_disc_db_test_rx_many_chrs(void)
+{
+    static const uint8_t svcs_rsp[] = {
+        BLE_ATT_OP_READ_GROUP_TYPE_RSP, 6,
+        0x01, 0x00,
+        (3 * BLE_GATT_DISC_DB_TEST_MANY_CHRS + 1) & 0xff,
+        (3 * BLE_GATT_DISC_DB_TEST_MANY_CHRS + 1) >> 8,
+        0x0f, 0x18,
+    };
+    uint8_t buf[2 + 3 * 7];
+    struct os_mbuf *om;
+    uint16_t start_handle;
+    uint16_t def_handle;
+    uint8_t op;
+    int len;
+    int n;
+
+    om = ble_hs_test_util_prev_tx_dequeue_pullup();
+    if (om == NULL) {
+        return 0;
+    }
+
+    op = om->om_data[0];
+    start_handle = get_le16(om->om_data + 1);
+
+    switch (op) {
+    case BLE_ATT_OP_READ_GROUP_TYPE_REQ:
+        if (start_handle == 1) {
+            ble_gatt_disc_db_test_rx(svcs_rsp, sizeof svcs_rsp);
+        } else {
+            ble_hs_test_util_rx_att_err_rsp(2, op, BLE_ATT_ERR_ATTR_NOT_FOUND,
+                                            start_handle);
+        }
+        break;
+
+    case BLE_ATT_OP_READ_TYPE_REQ:
+        /* Up to three characteristics fit in the default MTU. */
+        n = start_handle < 2 ? 0 : (start_handle - 2 + 2) / 3;
+        buf[0] = BLE_ATT_OP_READ_TYPE_RSP;
+        buf[1] = 7;
+        len = 2;
+        while (n < BLE_GATT_DISC_DB_TEST_MANY_CHRS && len < sizeof buf) {
+            def_handle = 3 * n + 2;
+            put_le16(buf + len, def_handle);
+            buf[len + 2] = BLE_GATT_CHR_PROP_NOTIFY;
+            put_le16(buf + len + 3, def_handle + 1);
+            put_le16(buf + len + 5, 0x2a00 + n);
+            len += 7;
+            n++;
+        }
+
+        if (len > 2) {
+            ble_gatt_disc_db_test_rx(buf, len);
+        } else {
+            ble_hs_test_util_rx_att_err_rsp(2, op, BLE_ATT_ERR_ATTR_NOT_FOUND,
+                                            start_handle);
+        }
+        break;
+
+    case BLE_ATT_OP_FIND_INFO_REQ:
+        TEST_ASSERT(start_handle % 3 == 1);
+        TEST_ASSERT(get_le16(om->om_data + 3) == start_handle);
+
+        buf[0] = BLE_ATT_OP_FIND_INFO_RSP;
+        buf[1] = BLE_ATT_FIND_INFO_RSP_FORMAT_16BIT;
+        put_le16(buf + 2, start_handle);
+        put_le16(buf + 4, BLE_GATT_DSC_CLT_CFG_UUID16);
+        ble_gatt_disc_db_test_rx(buf, 6);
+        break;
+
+    default:
+        TEST_ASSERT(0);
+        break;
+    }
+
+    return op;
+}
+
+TEST_CASE_SELF(ble_gatt_disc_db_test_many_chrs)
+{
+    int num_chr_reqs;
+    int num_reqs;
+    uint8_t op;
+    int rc;
+    int i;
+
+    ble_gatt_disc_db_test_init();
+
+    rc = ble_gattc_disc_db(2, ble_gatt_disc_db_test_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    num_reqs = 0;
+    num_chr_reqs = 0;
+    while ((op = ble_gatt_disc_db_test_rx_many_chrs()) != 0) {
+        num_reqs++;
+        if (op == BLE_ATT_OP_READ_TYPE_REQ) {
+            num_chr_reqs++;
+        }
+    }
+
+    /* Characteristic discovery was suspended while the queue was full, not
+     * failed; every attribute is reported once.
+     */
+    TEST_ASSERT(ble_gatt_disc_db_test_num_done == 1);
+    TEST_ASSERT(ble_gatt_disc_db_test_status == 0);
+    TEST_ASSERT(ble_gatt_disc_db_test_num_reqs == num_reqs);
+
+    TEST_ASSERT(ble_gatt_disc_db_test_num_svcs == 1);
+    TEST_ASSERT_FATAL(ble_gatt_disc_db_test_num_chrs ==
+                      BLE_GATT_DISC_DB_TEST_MANY_CHRS);
+    TEST_ASSERT_FATAL(ble_gatt_disc_db_test_num_dscs ==
+                      BLE_GATT_DISC_DB_TEST_MANY_CHRS);
+
+    for (i = 0; i < BLE_GATT_DISC_DB_TEST_MANY_CHRS; i++) {
+        TEST_ASSERT(ble_gatt_disc_db_test_chrs[i].def_handle == 3 * i + 2);
+        TEST_ASSERT(ble_gatt_disc_db_test_dscs[i].handle == 3 * i + 4);
+        TEST_ASSERT(ble_gatt_disc_db_test_dsc_chrs[i] == 3 * i + 3);
+    }
+
+    /* One extra request resumed characteristic discovery. */
+    TEST_ASSERT(num_chr_reqs ==
+                (BLE_GATT_DISC_DB_TEST_MANY_CHRS + 2) / 3 + 2);
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
+#if MYNEWT_VAL(BLE_EATT_CHAN_NUM) > 1
+
+#define BLE_GATT_DISC_DB_TEST_MB_MAX_BEARERS    \
+    (1 + MYNEWT_VAL(BLE_EATT_CHAN_NUM))
+
+#define BLE_GATT_DISC_DB_TEST_MB_MAX_RANGES     \
+    (BLE_GATT_DISC_DB_TEST_MB_SVCS * BLE_GATT_DISC_DB_TEST_MB_SVC_CHRS)
+
+/** A request the peer has not answered yet. */
+struct ble_gatt_disc_db_test_mb_req {
+    uint16_t cid;
+    uint8_t op;
+    uint16_t start_handle;
+    uint16_t end_handle;
+};
+
+/** What the peer observed during a multi-bearer discovery. */
+struct ble_gatt_disc_db_test_mb_stats {
+    int num_reqs;
+    int max_reqs;
+    int max_dsc_reqs;
+    int svcs_with_chrs;
+
+    /* First request of each descriptor range. */
+    struct ble_gatt_disc_db_test_mb_req ranges[
+        BLE_GATT_DISC_DB_TEST_MB_MAX_RANGES];
+    int num_ranges;
+};
+
+/** Source CIDs of the enhanced bearers. */
+static uint16_t ble_gatt_disc_db_test_mb_scids[
+    MYNEWT_VAL(BLE_EATT_CHAN_NUM)];
+
+static void
+ble_gatt_disc_db_test_mb_init(int num_bearers)
+{
+    static const int accept[MYNEWT_VAL(BLE_EATT_CHAN_NUM)] = { 1 };
+
+    ble_gatt_disc_db_test_init();
+
+    ble_hs_lock();
+    ble_hs_conn_find(2)->bhc_sec_state.encrypted = 1;
+    ble_hs_unlock();
+
+    ble_hs_test_util_eatt_connect(2, MYNEWT_VAL(BLE_EATT_CHAN_NUM), 0,
+                                  num_bearers < MYNEWT_VAL(BLE_EATT_CHAN_NUM) ?
+                                  accept : NULL,
+                                  ble_gatt_disc_db_test_mb_scids);
+}
+
+/**
+ * Maps a source CID to a bearer index; 0 is the unenhanced bearer.
+ */
+static int
+ble_gatt_disc_db_test_mb_bearer(uint16_t cid)
+{
+    int i;
+
+    if (cid == BLE_L2CAP_CID_ATT) {
+        return 0;
+    }
+
+    for (i = 0; i < MYNEWT_VAL(BLE_EATT_CHAN_NUM); i++) {
+        if (ble_gatt_disc_db_test_mb_scids[i] == cid) {
+            return i + 1;
+        }
+    }
+
+    TEST_ASSERT_FATAL(0);
+    return -1;
+}
+
+/**
+ * Retrieves the type of the specified attribute of the peer database:
+ * BLE_GATT_DISC_DB_TEST_MB_SVCS services, each declaring
+ * BLE_GATT_DISC_DB_TEST_MB_SVC_CHRS characteristics that are followed by
+ * their value and a CCCD.  Returns 0 past the last attribute.
+ */
+static uint16_t
+ble_gatt_disc_db_test_mb_attr(uint16_t handle)
+{
+    int off;
+
+    if (handle == 0 ||
+        handle > BLE_GATT_DISC_DB_TEST_MB_SVCS *
+                 BLE_GATT_DISC_DB_TEST_MB_SVC_SZ) {
+
+        return 0;
+    }
+
+    off = (handle - 1) % BLE_GATT_DISC_DB_TEST_MB_SVC_SZ;
+    if (off == 0) {
+        return BLE_ATT_UUID_PRIMARY_SERVICE;
+    }
+
+    switch ((off - 1) % 3) {
+    case 0:
+        return BLE_ATT_UUID_CHARACTERISTIC;
+    case 1:
+        return 0x2a00 + handle;
+    default:
+        return BLE_GATT_DSC_CLT_CFG_UUID16;
+    }
+}
+
+/**
+ * Answers the specified request as the peer would.
+ */
+static void
+ble_gatt_disc_db_test_mb_rx(const struct ble_gatt_disc_db_test_mb_req *req)
+{
+    uint8_t buf[BLE_ATT_MTU_DFLT];
+    uint16_t handle;
+    uint16_t uuid;
+    int len;
+
+    len = 0;
+    switch (req->op) {
+    case BLE_ATT_OP_READ_GROUP_TYPE_REQ:
+        buf[0] = BLE_ATT_OP_READ_GROUP_TYPE_RSP;
+        buf[1] = 6;
+        len = 2;
+        for (handle = req->start_handle;
+             (uuid = ble_gatt_disc_db_test_mb_attr(handle)) != 0 &&
+             handle <= req->end_handle && len + 6 <= sizeof buf;
+             handle++) {
+
+            if (uuid == BLE_ATT_UUID_PRIMARY_SERVICE) {
+                put_le16(buf + len, handle);
+                put_le16(buf + len + 2,
+                         handle + BLE_GATT_DISC_DB_TEST_MB_SVC_SZ - 1);
+                put_le16(buf + len + 4, 0x1800 + handle);
+                len += 6;
+            }
+        }
+        break;
+
+    case BLE_ATT_OP_READ_TYPE_REQ:
+        buf[0] = BLE_ATT_OP_READ_TYPE_RSP;
+        buf[1] = 7;
+        len = 2;
+        for (handle = req->start_handle;
+             (uuid = ble_gatt_disc_db_test_mb_attr(handle)) != 0 &&
+             handle <= req->end_handle && len + 7 <= sizeof buf;
+             handle++) {
+
+            if (uuid == BLE_ATT_UUID_CHARACTERISTIC) {
+                put_le16(buf + len, handle);
+                buf[len + 2] = BLE_GATT_CHR_PROP_NOTIFY;
+                put_le16(buf + len + 3, handle + 1);
+                put_le16(buf + len + 5,
+                         ble_gatt_disc_db_test_mb_attr(handle + 1));
+                len += 7;
+            }
+        }
+        break;
+
+    case BLE_ATT_OP_FIND_INFO_REQ:
+        buf[0] = BLE_ATT_OP_FIND_INFO_RSP;
+        buf[1] = BLE_ATT_FIND_INFO_RSP_FORMAT_16BIT;
+        len = 2;
+        for (handle = req->start_handle;
+             (uuid = ble_gatt_disc_db_test_mb_attr(handle)) != 0 &&
+             handle <= req->end_handle && len + 4 <= sizeof buf;
+             handle++) {
+
+            put_le16(buf + len, handle);
+            put_le16(buf + len + 2, uuid);
+            len += 4;
+        }
+        break;
+
+    default:
+        TEST_ASSERT_FATAL(0);
+        break;
+    }
+
+    if (len > 2) {
+        ble_hs_test_util_eatt_rx_payload_flat(2, req->cid, buf, len);
+    } else {
+        ble_hs_test_util_eatt_rx_att_err_rsp(2, req->cid, req->op,
+                                             BLE_ATT_ERR_ATTR_NOT_FOUND,
+                                             req->start_handle);
+    }
+}
+
+/**
+ * Plays the peer until the procedure sends no more requests.  Requests are
+ * answered in the order they were sent, one at a time, so that every new
+ * request is checked against the ones still outstanding.
+ */
+static void
+ble_gatt_disc_db_test_mb_run(struct ble_gatt_disc_db_test_mb_stats *stats)
+{
+    struct ble_gatt_disc_db_test_mb_req reqs[
+        BLE_GATT_DISC_DB_TEST_MB_MAX_BEARERS];
+    struct ble_gatt_disc_db_test_mb_req req;
+    struct os_mbuf *om;
+    uint16_t cid;
+    int num_reqs;
+    int num_dsc;
+    int bearer;
+    int i;
+
+    memset(stats, 0, sizeof *stats);
+    num_reqs = 0;
+
+    while (1) {
+        while ((om = ble_hs_test_util_eatt_prev_tx_dequeue_pullup(&cid)) !=
+               NULL) {
+
+            /* ATT allows a single outstanding request per bearer. */
+            bearer = ble_gatt_disc_db_test_mb_bearer(cid);
+            for (i = 0; i < num_reqs; i++) {
+                TEST_ASSERT_FATAL(ble_gatt_disc_db_test_mb_bearer(
+                                      reqs[i].cid) != bearer);
+            }
+            TEST_ASSERT_FATAL(num_reqs < BLE_GATT_DISC_DB_TEST_MB_MAX_BEARERS);
+
+            req.cid = cid;
+            req.op = om->om_data[0];
+            req.start_handle = get_le16(om->om_data + 1);
+            req.end_handle = get_le16(om->om_data + 3);
+            reqs[num_reqs++] = req;
+            stats->num_reqs++;
+
+            /* Further requests of a range start right after a CCCD. */
+            if (req.op == BLE_ATT_OP_FIND_INFO_REQ &&
+                ble_gatt_disc_db_test_mb_attr(req.start_handle - 1) !=
+                BLE_GATT_DSC_CLT_CFG_UUID16) {
+
+                TEST_ASSERT_FATAL(stats->num_ranges <
+                                  BLE_GATT_DISC_DB_TEST_MB_MAX_RANGES);
+                stats->ranges[stats->num_ranges++] = req;
+            }
+        }
+
+        if (num_reqs == 0) {
+            break;
+        }
+
+        if (num_reqs > stats->max_reqs) {
+            stats->max_reqs = num_reqs;
+        }
+
+        num_dsc = 0;
+        for (i = 0; i < num_reqs; i++) {
+            if (reqs[i].op == BLE_ATT_OP_FIND_INFO_REQ) {
+                num_dsc++;
+            }
+            if (reqs[i].op == BLE_ATT_OP_READ_GROUP_TYPE_REQ) {
+                stats->svcs_with_chrs |= num_reqs > 1;
+            }
+        }
+        if (num_dsc > stats->max_dsc_reqs) {
+            stats->max_dsc_reqs = num_dsc;
+        }
+
+        req = reqs[0];
+        num_reqs--;
+        memmove(reqs, reqs + 1, num_reqs * sizeof *reqs);
+
+        ble_gatt_disc_db_test_mb_rx(&req);
+    }
+}
+
+/**
+ * Verifies that every attribute of the multi-bearer database was reported
+ * exactly once and that the procedure completed.
+ */
+static void
+ble_gatt_disc_db_test_mb_verify(
+    const struct ble_gatt_disc_db_test_mb_stats *stats)
+{
+    uint16_t handle;
+    int svc_idx;
+    int idx;
+    int i;
+
+    TEST_ASSERT(ble_gatt_disc_db_test_num_done == 1);
+    TEST_ASSERT(ble_gatt_disc_db_test_status == 0);
+    TEST_ASSERT(ble_gatt_disc_db_test_num_reqs == stats->num_reqs);
+
+    TEST_ASSERT_FATAL(ble_gatt_disc_db_test_num_svcs ==
+                      BLE_GATT_DISC_DB_TEST_MB_SVCS);
+    TEST_ASSERT_FATAL(ble_gatt_disc_db_test_num_chrs ==
+                      BLE_GATT_DISC_DB_TEST_MB_MAX_RANGES);
+    TEST_ASSERT_FATAL(ble_gatt_disc_db_test_num_dscs ==
+                      BLE_GATT_DISC_DB_TEST_MB_MAX_RANGES);
+
+    for (i = 0; i < BLE_GATT_DISC_DB_TEST_MB_SVCS; i++) {
+        handle = 1 + i * BLE_GATT_DISC_DB_TEST_MB_SVC_SZ;
+        TEST_ASSERT(ble_gatt_disc_db_test_svcs[i].start_handle == handle);
+        TEST_ASSERT(ble_gatt_disc_db_test_svcs[i].end_handle ==
+                    handle + BLE_GATT_DISC_DB_TEST_MB_SVC_SZ - 1);
+    }
+
+    for (i = 0; i < BLE_GATT_DISC_DB_TEST_MB_MAX_RANGES; i++) {
+        handle = 2 + (i / BLE_GATT_DISC_DB_TEST_MB_SVC_CHRS) *
+                     BLE_GATT_DISC_DB_TEST_MB_SVC_SZ +
+                 (i % BLE_GATT_DISC_DB_TEST_MB_SVC_CHRS) * 3;
+        TEST_ASSERT(ble_gatt_disc_db_test_chrs[i].def_handle == handle);
+    }
+
+    /* Descriptor ranges complete in any order; the declarations of the next
+     * service are never reported as descriptors.
+     */
+    for (i = 0; i < BLE_GATT_DISC_DB_TEST_MB_MAX_RANGES; i++) {
+        handle = ble_gatt_disc_db_test_dscs[i].handle;
+        TEST_ASSERT(ble_gatt_disc_db_test_mb_attr(handle) ==
+                    BLE_GATT_DSC_CLT_CFG_UUID16);
+        TEST_ASSERT(ble_uuid_u16(&ble_gatt_disc_db_test_dscs[i].uuid.u) ==
+                    BLE_GATT_DSC_CLT_CFG_UUID16);
+        TEST_ASSERT(ble_gatt_disc_db_test_dsc_chrs[i] == handle - 1);
+    }
+
+    /* The ranges of the last characteristic of each service are bounded by
+     * the service, unless it is beyond the remembered ones.
+     */
+    TEST_ASSERT_FATAL(stats->num_ranges == BLE_GATT_DISC_DB_TEST_MB_MAX_RANGES);
+    for (i = 0; i < stats->num_ranges; i++) {
+        handle = stats->ranges[i].start_handle;
+        TEST_ASSERT_FATAL(ble_gatt_disc_db_test_mb_attr(handle) ==
+                          BLE_GATT_DSC_CLT_CFG_UUID16);
+
+        svc_idx = (handle - 1) / BLE_GATT_DISC_DB_TEST_MB_SVC_SZ;
+        idx = (handle - 1) % BLE_GATT_DISC_DB_TEST_MB_SVC_SZ;
+        if (idx != BLE_GATT_DISC_DB_TEST_MB_SVC_SZ - 1) {
+            /* Up to the next characteristic declaration. */
+            TEST_ASSERT(stats->ranges[i].end_handle == handle);
+        } else if (svc_idx < MYNEWT_VAL(BLE_GATT_DISC_DB_MAX_SVCS)) {
+            TEST_ASSERT(stats->ranges[i].end_handle == handle);
+        } else {
+            TEST_ASSERT(stats->ranges[i].end_handle > handle);
+        }
+    }
+}
+
+TEST_CASE_SELF(ble_gatt_disc_db_test_eatt)
+{
+    struct ble_gatt_disc_db_test_mb_stats stats;
+    int rc;
+
+    ble_gatt_disc_db_test_mb_init(MYNEWT_VAL(BLE_EATT_CHAN_NUM));
+
+    rc = ble_gattc_disc_db(2, ble_gatt_disc_db_test_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ble_gatt_disc_db_test_mb_run(&stats);
+    ble_gatt_disc_db_test_mb_verify(&stats);
+
+    /* Characteristic discovery ran alongside service discovery; descriptor
+     * ranges were spread over the free bearers, using all of them.
+     */
+    TEST_ASSERT(stats.svcs_with_chrs);
+    TEST_ASSERT(stats.max_dsc_reqs > 1);
+    TEST_ASSERT(stats.max_reqs == BLE_GATT_DISC_DB_TEST_MB_MAX_BEARERS);
+}
+
+TEST_CASE_SELF(ble_gatt_disc_db_test_eatt_few_bearers)
+{
+    struct ble_gatt_disc_db_test_mb_stats stats;
+    int rc;
+
+    /* Fewer bearers than configured; one of them is refused by the peer. */
+    ble_gatt_disc_db_test_mb_init(1);
+
+    rc = ble_gattc_disc_db(2, ble_gatt_disc_db_test_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ble_gatt_disc_db_test_mb_run(&stats);
+    ble_gatt_disc_db_test_mb_verify(&stats);
+
+    TEST_ASSERT(stats.svcs_with_chrs);
+    TEST_ASSERT(stats.max_reqs == 2);
+}
+
+#endif
+
+#endif
+
+TEST_SUITE(ble_gatt_disc_db_test_suite)
+{
+#if MYNEWT_VAL(BLE_GATT_DISC_DB)
+    ble_gatt_disc_db_test_all();
+    ble_gatt_disc_db_test_err();
+    ble_gatt_disc_db_test_abort();
+    ble_gatt_disc_db_test_many_chrs();
+#if MYNEWT_VAL(BLE_EATT_CHAN_NUM) > 1
+    ble_gatt_disc_db_test_eatt();
+    ble_gatt_disc_db_test_eatt_few_bearers();
+#endif
+#endif
+}
@@ -497,6 +497,112 @@ ble_gatt_read_test_misc_mult_verify_bad(
     TEST_ASSERT(!ble_gattc_any_jobs());
 }
 
+static int
+ble_gatt_read_test_mult_var_cb(uint16_t conn_handle,
+                               const struct ble_gatt_error *error,
+                               struct ble_gatt_attr *attrs, uint8_t num_attrs,
+                               void *arg)
+{
+    struct ble_gatt_read_test_attr *dst;
+    int rc;
+    int i;
+
+    TEST_ASSERT_FATAL(error != NULL);
+
+    ble_gatt_read_test_complete = 1;
+
+    if (error->status != 0) {
+        ble_gatt_read_test_bad_conn_handle = conn_handle;
+        ble_gatt_read_test_bad_status = error->status;
+        return 0;
+    }
+
+    for (i = 0; i < num_attrs; i++) {
+        TEST_ASSERT_FATAL(ble_gatt_read_test_num_attrs <
+                          BLE_GATT_READ_TEST_MAX_ATTRS);
+        dst = ble_gatt_read_test_attrs + ble_gatt_read_test_num_attrs++;
+
+        TEST_ASSERT_FATAL(OS_MBUF_PKTLEN(attrs[i].om) <= sizeof dst->value);
+
+        dst->conn_handle = conn_handle;
+        dst->handle = attrs[i].handle;
+        dst->value_len = OS_MBUF_PKTLEN(attrs[i].om);
+        rc = os_mbuf_copydata(attrs[i].om, 0, dst->value_len, dst->value);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    return 0;
+}
+
+/**
+ * Reads the specified attributes with a read multiple variable length
+ * request.  The response is cut to rsp_len bytes if nonzero.
+ */
+static void
+ble_gatt_read_test_misc_mult_var_verify_good(
+    struct ble_hs_test_util_flat_attr *attrs, int rsp_len)
+{
+    uint8_t rsp[BLE_ATT_MTU_DFLT];
+    uint16_t handles[256];
+    struct os_mbuf *om;
+    int num_attrs;
+    int value_len;
+    int off;
+    int rc;
+    int i;
+
+    ble_gatt_read_test_misc_init();
+    ble_hs_test_util_create_conn(2, ((uint8_t[]){2,3,4,5,6,7,8,9}),
+                                 NULL, NULL);
+
+    num_attrs = ble_gatt_read_test_misc_extract_handles(attrs, handles);
+
+    off = 0;
+    for (i = 0; i < num_attrs; i++) {
+        TEST_ASSERT_FATAL(off + 2 + attrs[i].value_len <= sizeof rsp);
+        put_le16(rsp + off, attrs[i].value_len);
+        memcpy(rsp + off + 2, attrs[i].value, attrs[i].value_len);
+        off += 2 + attrs[i].value_len;
+    }
+    if (rsp_len != 0) {
+        off = rsp_len;
+    }
+
+    rc = ble_gattc_read_mult_var(2, handles, num_attrs,
+                                 ble_gatt_read_test_mult_var_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    om = ble_hs_test_util_prev_tx_dequeue_pullup();
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT(om->om_data[0] == BLE_ATT_OP_READ_MULT_VAR_REQ);
+    TEST_ASSERT(OS_MBUF_PKTLEN(om) == 1 + 2 * num_attrs);
+
+    ble_gatt_read_test_misc_rx_rsp_good_raw(2, BLE_ATT_OP_READ_MULT_VAR_RSP,
+                                            rsp, off);
+
+    TEST_ASSERT(ble_gatt_read_test_complete);
+    TEST_ASSERT(!ble_gattc_any_jobs());
+    TEST_ASSERT(ble_gatt_read_test_bad_status == 0);
+
+    /* Only the values present in the response get reported; the last one may
+     * be truncated.
+     */
+    off -= 2;
+    for (i = 0; i < num_attrs && off >= 0; i++) {
+        value_len = min(attrs[i].value_len, off);
+
+        TEST_ASSERT_FATAL(i < ble_gatt_read_test_num_attrs);
+        TEST_ASSERT(ble_gatt_read_test_attrs[i].conn_handle == 2);
+        TEST_ASSERT(ble_gatt_read_test_attrs[i].handle == attrs[i].handle);
+        TEST_ASSERT(ble_gatt_read_test_attrs[i].value_len == value_len);
+        TEST_ASSERT(memcmp(ble_gatt_read_test_attrs[i].value, attrs[i].value,
+                           value_len) == 0);
+
+        off -= 2 + attrs[i].value_len;
+    }
+    TEST_ASSERT(ble_gatt_read_test_num_attrs == i);
+}
+
 TEST_CASE_SELF(ble_gatt_read_test_by_handle)
 {
     /* Read a seven-byte attribute. */
@@ -759,6 +865,67 @@ TEST_CASE_SELF(ble_gatt_read_test_mult)
     ble_hs_test_util_assert_mbufs_freed(NULL);
 }
 
+TEST_CASE_SELF(ble_gatt_read_test_mult_var)
+{
+    int rc;
+
+    /* Read two attributes. */
+    ble_gatt_read_test_misc_mult_var_verify_good(
+        (struct ble_hs_test_util_flat_attr[]) { {
+        .handle = 43,
+        .value = { 0, 1, 2, 3, 4, 5, 6 },
+        .value_len = 7,
+    }, {
+        .handle = 44,
+        .value = { 8, 9, 10, 11 },
+        .value_len = 4,
+    }, {
+        0
+    } }, 0);
+
+    /* Read three attributes, one of them empty. */
+    ble_gatt_read_test_misc_mult_var_verify_good(
+        (struct ble_hs_test_util_flat_attr[]) { {
+        .handle = 145,
+        .value = { 12, 13 },
+        .value_len = 2,
+    }, {
+        .handle = 146,
+        .value_len = 0,
+    }, {
+        .handle = 191,
+        .value = { 14, 15, 16 },
+        .value_len = 3,
+    }, {
+        0
+    } }, 0);
+
+    /* Last value truncated by the peer. */
+    ble_gatt_read_test_misc_mult_var_verify_good(
+        (struct ble_hs_test_util_flat_attr[]) { {
+        .handle = 43,
+        .value = { 0, 1, 2, 3, 4, 5, 6 },
+        .value_len = 7,
+    }, {
+        .handle = 44,
+        .value = { 8, 9, 10, 11 },
+        .value_len = 4,
+    }, {
+        0
+    } }, 2 + 7 + 2 + 1);
+
+    /* At least two handles are required. */
+    ble_gatt_read_test_misc_init();
+    ble_hs_test_util_create_conn(2, ((uint8_t[]){2,3,4,5,6,7,8,9}),
+                                 NULL, NULL);
+    rc = ble_gattc_read_mult_var(2, ((uint16_t[]){ 43 }), 1,
+                                 ble_gatt_read_test_mult_var_cb, NULL);
+    TEST_ASSERT(rc == BLE_HS_EINVAL);
+    TEST_ASSERT(!ble_gattc_any_jobs());
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
 TEST_CASE_SELF(ble_gatt_read_test_concurrent)
 {
     int rc;
@@ -918,6 +1085,7 @@ TEST_SUITE(ble_gatt_read_test_suite)
     ble_gatt_read_test_by_uuid();
     ble_gatt_read_test_long();
     ble_gatt_read_test_mult();
+    ble_gatt_read_test_mult_var();
     ble_gatt_read_test_concurrent();
     ble_gatt_read_test_long_oom();
 }
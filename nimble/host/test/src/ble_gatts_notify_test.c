@@ -73,6 +73,8 @@ ble_gatts_notify_test_events[BLE_GATTS_NOTIFY_TEST_MAX_EVENTS];
 
 static int ble_gatts_notify_test_num_events;
 
+static int ble_gatts_notify_test_num_reads;
+
 typedef int ble_store_write_fn(int obj_type, const union ble_store_value *val);
 
 typedef int ble_store_delete_fn(int obj_type, const union ble_store_key *key);
@@ -389,6 +391,8 @@ ble_gatts_notify_test_misc_access(uint16_t conn_handle,
     TEST_ASSERT_FATAL(ctxt->op == BLE_GATT_ACCESS_OP_READ_CHR);
     TEST_ASSERT(conn_handle == 0xffff);
 
+    ble_gatts_notify_test_num_reads++;
+
     if (attr_handle == ble_gatts_notify_test_chr_1_def_handle + 1) {
         TEST_ASSERT(ctxt->chr ==
                     &ble_gatts_notify_test_svcs[0].characteristics[0]);
@@ -659,6 +663,229 @@ TEST_CASE_SELF(ble_gatts_notify_test_n)
     ble_hs_test_util_assert_mbufs_freed(NULL);
 }
 
+TEST_CASE_SELF(ble_gatts_notify_test_multi_n)
+{
+    static const uint8_t fourbytes[] = { 1, 2, 3, 4 };
+    uint16_t conn_handles[2];
+    struct os_mbuf *om;
+    uint16_t conn_handle;
+    int rc;
+    int i;
+
+    ble_gatts_notify_test_misc_init(&conn_handle, 0,
+                                    BLE_GATTS_CLT_CFG_F_NOTIFY, 0);
+
+    /* Connect a second peer and subscribe it to characteristic 1. */
+    ble_hs_test_util_create_conn(3, ((uint8_t[]){3,4,5,6,7,8}),
+                                 ble_gatts_notify_test_util_gap_event, NULL);
+    ble_gatts_notify_test_misc_enable_notify(
+        3, ble_gatts_notify_test_chr_1_def_handle, BLE_GATTS_CLT_CFG_F_NOTIFY);
+    ble_gatts_notify_test_util_verify_sub_event(
+        3, ble_gatts_notify_test_chr_1_def_handle + 1,
+        BLE_GAP_SUBSCRIBE_REASON_WRITE, 0, 1, 0, 0);
+    ble_hs_test_util_prev_tx_queue_clear();
+
+    /* Update characteristic 1's value; both peers get notified but the value
+     * is only read once.
+     */
+    ble_gatts_notify_test_num_reads = 0;
+    ble_gatts_notify_test_chr_1_len = 3;
+    memcpy(ble_gatts_notify_test_chr_1_val, ((uint8_t[]){0xab,0xcd,0xef}), 3);
+    ble_gatts_chr_updated(ble_gatts_notify_test_chr_1_def_handle + 1);
+    TEST_ASSERT(ble_gatts_notify_test_num_reads == 1);
+
+    for (i = 0; i < 2; i++) {
+        TEST_ASSERT_FATAL(ble_gatts_notify_test_num_events > 0);
+        conn_handle = ble_gatts_notify_test_events[0].notify_tx.conn_handle;
+        TEST_ASSERT(conn_handle == 2 || conn_handle == 3);
+
+        ble_gatts_notify_test_misc_verify_tx_n(
+            conn_handle,
+            ble_gatts_notify_test_chr_1_def_handle + 1,
+            ble_gatts_notify_test_chr_1_val,
+            ble_gatts_notify_test_chr_1_len);
+    }
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue() == NULL);
+    TEST_ASSERT(ble_gatts_notify_test_num_events == 0);
+
+    /* Verify custom notification data sent to both peers. */
+    om = ble_hs_mbuf_from_flat(fourbytes, sizeof fourbytes);
+    TEST_ASSERT_FATAL(om != NULL);
+
+    conn_handles[0] = 2;
+    conn_handles[1] = 3;
+    rc = ble_gattc_notify_multi_custom(conn_handles, 2,
+                                       ble_gatts_notify_test_chr_1_def_handle +
+                                       1, om);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < 2; i++) {
+        ble_gatts_notify_test_misc_verify_tx_n(
+            conn_handles[i],
+            ble_gatts_notify_test_chr_1_def_handle + 1,
+            fourbytes,
+            sizeof fourbytes);
+    }
+
+    /* Unknown connection reports an error, other peers still notified. */
+    conn_handles[0] = 4;
+    conn_handles[1] = 2;
+    rc = ble_gattc_notify_multi(conn_handles, 2,
+                                ble_gatts_notify_test_chr_1_def_handle + 1);
+    TEST_ASSERT(rc == BLE_HS_ENOTCONN);
+
+    ble_gatts_notify_test_misc_verify_tx_n(
+        2,
+        ble_gatts_notify_test_chr_1_def_handle + 1,
+        ble_gatts_notify_test_chr_1_val,
+        ble_gatts_notify_test_chr_1_len);
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
+TEST_CASE_SELF(ble_gatts_notify_test_multi_fail)
+{
+    static uint8_t payload[400];
+    uint16_t conn_handles[3];
+    struct os_mbuf *oms;
+    struct os_mbuf *om;
+    uint16_t attr_handle;
+    uint16_t conn_handle;
+    int rc;
+
+    ble_gatts_notify_test_misc_init(&conn_handle, 0, 0, 0);
+    ble_hs_test_util_create_conn(3, ((uint8_t[]){3,4,5,6,7,8}),
+                                 ble_gatts_notify_test_util_gap_event, NULL);
+    ble_hs_test_util_create_conn(4, ((uint8_t[]){4,5,6,7,8,9}),
+                                 ble_gatts_notify_test_util_gap_event, NULL);
+    ble_hs_test_util_prev_tx_queue_clear();
+
+    attr_handle = ble_gatts_notify_test_chr_1_def_handle + 1;
+    memset(payload, 0x5a, sizeof payload);
+
+    /* The payload spans several mbufs, so copying it for the second
+     * recipient fails once the pool runs low, while the last recipient, which
+     * takes the original, only needs a header.
+     */
+    om = ble_hs_mbuf_from_flat(payload, sizeof payload);
+    TEST_ASSERT_FATAL(om != NULL && SLIST_NEXT(om, om_next) != NULL);
+    oms = ble_hs_test_util_mbuf_alloc_all_but(3);
+
+    conn_handles[0] = 2;
+    conn_handles[1] = 3;
+    conn_handles[2] = 4;
+    rc = ble_gattc_notify_multi_custom(conn_handles, 3, attr_handle, om);
+    TEST_ASSERT(rc == BLE_HS_ENOMEM);
+
+    rc = os_mbuf_free_chain(oms);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* The failure is reported for the middle peer only; the others are still
+     * notified.
+     */
+    ble_gatts_notify_test_misc_verify_tx_n(2, attr_handle, payload, 8);
+    ble_gatts_notify_test_util_verify_tx_event(3, attr_handle,
+                                               BLE_HS_ENOMEM, 0);
+    ble_gatts_notify_test_misc_verify_tx_n(4, attr_handle, payload, 8);
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue() == NULL);
+    TEST_ASSERT(ble_gatts_notify_test_num_events == 0);
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
+TEST_CASE_SELF(ble_gatts_notify_test_mult_ntf)
+{
+    struct ble_gatt_notif notifs[2];
+    struct os_mbuf *om;
+    uint16_t conn_handle;
+    uint8_t feat;
+    int off;
+    int rc;
+
+    ble_gatts_notify_test_misc_init(&conn_handle, 0,
+                                    BLE_GATTS_CLT_CFG_F_NOTIFY,
+                                    BLE_GATTS_CLT_CFG_F_NOTIFY);
+
+    ble_gatts_notify_test_chr_1_len = 2;
+    memcpy(ble_gatts_notify_test_chr_1_val, ((uint8_t[]){0x11,0x22}), 2);
+    ble_gatts_notify_test_chr_2_len = 3;
+    memcpy(ble_gatts_notify_test_chr_2_val, ((uint8_t[]){0x33,0x44,0x55}), 3);
+
+    notifs[0].handle = ble_gatts_notify_test_chr_1_def_handle + 1;
+    notifs[1].handle = ble_gatts_notify_test_chr_2_def_handle + 1;
+
+    /* Without the client feature, each value goes in its own PDU. */
+    notifs[0].value = NULL;
+    notifs[1].value = NULL;
+    rc = ble_gattc_notify_handles(conn_handle, notifs, 2);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ble_gatts_notify_test_misc_verify_tx_n(
+        conn_handle,
+        ble_gatts_notify_test_chr_1_def_handle + 1,
+        ble_gatts_notify_test_chr_1_val,
+        ble_gatts_notify_test_chr_1_len);
+    ble_gatts_notify_test_misc_verify_tx_n(
+        conn_handle,
+        ble_gatts_notify_test_chr_2_def_handle + 1,
+        ble_gatts_notify_test_chr_2_val,
+        ble_gatts_notify_test_chr_2_len);
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue() == NULL);
+
+    /* Client enables multiple handle value notifications. */
+    om = ble_hs_mbuf_from_flat(&(uint8_t){BLE_GATT_CLI_SUP_FEAT_MULT_NTF}, 1);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = ble_gatts_peer_cl_sup_feat_update(conn_handle, om);
+    os_mbuf_free_chain(om);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = ble_gatts_peer_cl_sup_feat_get(conn_handle, &feat, 1);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(feat == BLE_GATT_CLI_SUP_FEAT_MULT_NTF);
+
+    /* A feature can not be disabled once enabled. */
+    om = ble_hs_mbuf_from_flat(&(uint8_t){0}, 1);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = ble_gatts_peer_cl_sup_feat_update(conn_handle, om);
+    os_mbuf_free_chain(om);
+    TEST_ASSERT(rc == BLE_ATT_ERR_VALUE_NOT_ALLOWED);
+
+    /* Both pending values are sent in a single PDU. */
+    notifs[0].value = NULL;
+    notifs[1].value = NULL;
+    rc = ble_gattc_notify_handles(conn_handle, notifs, 2);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    om = ble_hs_test_util_prev_tx_dequeue_pullup();
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT_FATAL(om->om_len == 1 + 4 + 2 + 4 + 3);
+    TEST_ASSERT(om->om_data[0] == BLE_ATT_OP_NOTIFY_MULTI_REQ);
+
+    off = 1;
+    TEST_ASSERT(get_le16(om->om_data + off) ==
+                ble_gatts_notify_test_chr_1_def_handle + 1);
+    TEST_ASSERT(get_le16(om->om_data + off + 2) == 2);
+    TEST_ASSERT(memcmp(om->om_data + off + 4,
+                       ble_gatts_notify_test_chr_1_val, 2) == 0);
+
+    off += 4 + 2;
+    TEST_ASSERT(get_le16(om->om_data + off) ==
+                ble_gatts_notify_test_chr_2_def_handle + 1);
+    TEST_ASSERT(get_le16(om->om_data + off + 2) == 3);
+    TEST_ASSERT(memcmp(om->om_data + off + 4,
+                       ble_gatts_notify_test_chr_2_val, 3) == 0);
+
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue() == NULL);
+
+    ble_gatts_notify_test_util_verify_tx_event(
+        conn_handle, ble_gatts_notify_test_chr_1_def_handle + 1, 0, 0);
+    ble_gatts_notify_test_util_verify_tx_event(
+        conn_handle, ble_gatts_notify_test_chr_2_def_handle + 1, 0, 0);
+    TEST_ASSERT(ble_gatts_notify_test_num_events == 0);
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
 TEST_CASE_SELF(ble_gatts_notify_test_i)
 {
     static const uint8_t fourbytes[] = { 1, 2, 3, 4 };
@@ -1074,6 +1301,9 @@ TEST_CASE_SELF(ble_gatts_notify_test_disallowed)
 TEST_SUITE(ble_gatts_notify_suite)
 {
     ble_gatts_notify_test_n();
+    ble_gatts_notify_test_multi_n();
+    ble_gatts_notify_test_multi_fail();
+    ble_gatts_notify_test_mult_ntf();
     ble_gatts_notify_test_i();
 
     ble_gatts_notify_test_bonded_n();
@@ -23,6 +23,10 @@
 #include "host/ble_uuid.h"
 #include "ble_hs_test.h"
 #include "ble_hs_test_util.h"
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+#include "tinycrypt/constants.h"
+#include "tinycrypt/cmac_mode.h"
+#endif
 
 #define BLE_GATTS_READ_TEST_CHR_1_UUID    0x1111
 #define BLE_GATTS_READ_TEST_CHR_2_UUID    0x2222
@@ -250,8 +254,320 @@ TEST_CASE_SELF(ble_gatts_read_test_case_long)
     ble_hs_test_util_assert_mbufs_freed(NULL);
 }
 
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+static void
+ble_gatts_read_test_misc_db_hash(uint16_t svc_handle, uint8_t *out_hash)
+{
+    struct tc_aes_key_sched_struct sched;
+    struct tc_cmac_struct cmac;
+    uint8_t key[16] = { 0 };
+    uint8_t hash[BLE_GATT_DB_HASH_SZ];
+    uint8_t msg[6 + 9 + 9];
+    uint16_t h;
+    int rc;
+
+    /* Handle, type and value of the service and characteristic
+     * declarations.
+     */
+    h = svc_handle;
+    put_le16(msg + 0, h);
+    put_le16(msg + 2, BLE_ATT_UUID_PRIMARY_SERVICE);
+    put_le16(msg + 4, 0x1234);
+
+    h = ble_gatts_read_test_chr_1_def_handle;
+    put_le16(msg + 6, h);
+    put_le16(msg + 8, BLE_ATT_UUID_CHARACTERISTIC);
+    msg[10] = BLE_GATT_CHR_PROP_READ;
+    put_le16(msg + 11, h + 1);
+    put_le16(msg + 13, BLE_GATTS_READ_TEST_CHR_1_UUID);
+
+    h = ble_gatts_read_test_chr_2_def_handle;
+    put_le16(msg + 15, h);
+    put_le16(msg + 17, BLE_ATT_UUID_CHARACTERISTIC);
+    msg[19] = BLE_GATT_CHR_PROP_READ;
+    put_le16(msg + 20, h + 1);
+    put_le16(msg + 22, BLE_GATTS_READ_TEST_CHR_2_UUID);
+
+    rc = tc_cmac_setup(&cmac, key, &sched);
+    TEST_ASSERT_FATAL(rc == TC_CRYPTO_SUCCESS);
+    rc = tc_cmac_update(&cmac, msg, sizeof msg);
+    TEST_ASSERT_FATAL(rc == TC_CRYPTO_SUCCESS);
+    rc = tc_cmac_final(hash, &cmac);
+    TEST_ASSERT_FATAL(rc == TC_CRYPTO_SUCCESS);
+
+    swap_buf(out_hash, hash, sizeof hash);
+}
+
+static void
+ble_gatts_read_test_misc_db_change(uint16_t svc_handle)
+{
+    int rc;
+
+    rc = ble_gatts_svc_set_visibility(svc_handle, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = ble_gatts_svc_set_visibility(svc_handle, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+TEST_CASE_SELF(ble_gatts_read_test_case_db_hash)
+{
+    uint8_t exp_hash[BLE_GATT_DB_HASH_SZ];
+    uint8_t hash[BLE_GATT_DB_HASH_SZ];
+    uint8_t hidden_hash[BLE_GATT_DB_HASH_SZ];
+    struct os_mbuf *om;
+    uint16_t conn_handle;
+    uint16_t svc_handle;
+    uint8_t feat;
+    int rc;
+
+    ble_gatts_read_test_misc_init(&conn_handle);
+
+    rc = ble_gatts_find_svc(BLE_UUID16_DECLARE(0x1234), &svc_handle);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Hash covers the declarations of the visible database. */
+    ble_gatts_read_test_misc_db_hash(svc_handle, exp_hash);
+
+    rc = ble_gatts_db_hash(hash);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(memcmp(hash, exp_hash, sizeof hash) == 0);
+
+    rc = ble_gatts_svc_set_visibility(svc_handle, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = ble_gatts_db_hash(hidden_hash);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(memcmp(hidden_hash, exp_hash, sizeof hash) != 0);
+
+    rc = ble_gatts_svc_set_visibility(svc_handle, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = ble_gatts_db_hash(hash);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(memcmp(hash, exp_hash, sizeof hash) == 0);
+
+    /*** Peer without robust caching is not affected by changes. */
+    ble_gatts_read_test_chr_1_val[0] = 1;
+    ble_gatts_read_test_chr_1_len = 1;
+    ble_gatts_read_test_once(conn_handle,
+                             ble_gatts_read_test_chr_1_val_handle,
+                             ble_gatts_read_test_chr_1_val,
+                             ble_gatts_read_test_chr_1_len);
+
+    /*** Peer enables robust caching. */
+    feat = BLE_GATT_CLI_SUP_FEAT_ROBUST_CACHING;
+    om = ble_hs_mbuf_from_flat(&feat, sizeof feat);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = ble_gatts_peer_cl_sup_feat_update(conn_handle, om);
+    os_mbuf_free_chain(om);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ble_gatts_read_test_misc_db_change(svc_handle);
+
+    /* First request of the change-unaware peer is rejected... */
+    rc = ble_hs_test_util_l2cap_rx_payload_flat(
+        conn_handle, BLE_L2CAP_CID_ATT,
+        ((uint8_t[]){ BLE_ATT_OP_READ_REQ,
+                      ble_gatts_read_test_chr_1_val_handle, 0 }), 3);
+    TEST_ASSERT(rc == BLE_HS_EREJECT);
+    ble_hs_test_util_verify_tx_err_rsp(BLE_ATT_OP_READ_REQ, 0,
+                                       BLE_ATT_ERR_DB_OUT_OF_SYNC);
+
+    /* ... and the following one is served. */
+    ble_gatts_read_test_once(conn_handle,
+                             ble_gatts_read_test_chr_1_val_handle,
+                             ble_gatts_read_test_chr_1_val,
+                             ble_gatts_read_test_chr_1_len);
+
+    /*** Reading the Database Hash by type is allowed while change-unaware.
+     * This database has no hash characteristic, so the read fails normally.
+     */
+    ble_gatts_read_test_misc_db_change(svc_handle);
+
+    rc = ble_hs_test_util_l2cap_rx_payload_flat(
+        conn_handle, BLE_L2CAP_CID_ATT,
+        ((uint8_t[]){ BLE_ATT_OP_READ_TYPE_REQ, 0x01, 0x00, 0xff, 0xff,
+                      0x2a, 0x2b }), 7);
+    TEST_ASSERT(rc != BLE_HS_EREJECT);
+    ble_hs_test_util_verify_tx_err_rsp(BLE_ATT_OP_READ_TYPE_REQ, 1,
+                                       BLE_ATT_ERR_ATTR_NOT_FOUND);
+
+    ble_gatts_read_test_once(conn_handle,
+                             ble_gatts_read_test_chr_1_val_handle,
+                             ble_gatts_read_test_chr_1_val,
+                             ble_gatts_read_test_chr_1_len);
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
+/*
+ * Connects the test peer, bonded, and restores its bond as the encryption
+ * procedure does.
+ */
+static void
+ble_gatts_read_test_misc_bonded_conn(uint16_t conn_handle, int restore)
+{
+    struct ble_hs_conn *conn;
+
+    ble_hs_test_util_create_conn(conn_handle, ble_gatts_read_test_peer_addr,
+                                 NULL, NULL);
+
+    ble_hs_lock();
+    conn = ble_hs_conn_find(conn_handle);
+    TEST_ASSERT_FATAL(conn != NULL);
+    conn->bhc_sec_state.encrypted = 1;
+    conn->bhc_sec_state.bonded = 1;
+    ble_hs_unlock();
+
+    if (restore) {
+        ble_gatts_bonding_restored(conn_handle);
+    }
+
+    ble_hs_test_util_prev_tx_queue_clear();
+}
+
+static void
+ble_gatts_read_test_misc_verify_stored(uint8_t feat, const uint8_t *hash)
+{
+    struct ble_store_value_cl_sup_feat value;
+    struct ble_store_key_cl_sup_feat key;
+    int rc;
+
+    memset(&key, 0, sizeof key);
+    key.peer_addr.type = BLE_ADDR_PUBLIC;
+    memcpy(key.peer_addr.val, ble_gatts_read_test_peer_addr, 6);
+
+    rc = ble_store_read_cl_sup_feat(&key, &value);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(value.cl_sup_feat[0] == feat);
+    TEST_ASSERT(value.db_hash_present == (hash != NULL));
+    if (hash != NULL) {
+        TEST_ASSERT(memcmp(value.db_hash, hash, sizeof value.db_hash) == 0);
+    }
+}
+
+TEST_CASE_SELF(ble_gatts_read_test_case_db_hash_bonded)
+{
+    uint8_t hash[BLE_GATT_DB_HASH_SZ];
+    struct os_mbuf *om;
+    uint16_t svc_handle;
+    uint8_t feat;
+    int rc;
+
+    ble_hs_test_util_init();
+
+    ble_hs_test_util_reg_svcs(ble_gatts_read_test_svcs,
+                              ble_gatts_read_test_misc_reg_cb,
+                              NULL);
+
+    rc = ble_gatts_find_svc(BLE_UUID16_DECLARE(0x1234), &svc_handle);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ble_gatts_read_test_chr_1_val[0] = 1;
+    ble_gatts_read_test_chr_1_len = 1;
+
+    /*** Bonded peer enables robust caching; the state gets persisted. */
+    ble_gatts_read_test_misc_bonded_conn(2, 0);
+
+    feat = BLE_GATT_CLI_SUP_FEAT_ROBUST_CACHING;
+    om = ble_hs_mbuf_from_flat(&feat, sizeof feat);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = ble_gatts_peer_cl_sup_feat_update(2, om);
+    os_mbuf_free_chain(om);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = ble_gatts_db_hash(hash);
+    TEST_ASSERT_FATAL(rc == 0);
+    ble_gatts_read_test_misc_verify_stored(feat, hash);
+
+    ble_hs_test_util_conn_disconnect(2);
+
+    /*** Peer reconnects to an unchanged database; it is change-aware. */
+    ble_gatts_read_test_misc_bonded_conn(2, 1);
+
+    rc = ble_gatts_peer_cl_sup_feat_get(2, &feat, sizeof feat);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(feat == BLE_GATT_CLI_SUP_FEAT_ROBUST_CACHING);
+
+    ble_gatts_read_test_once(2, ble_gatts_read_test_chr_1_val_handle,
+                             ble_gatts_read_test_chr_1_val,
+                             ble_gatts_read_test_chr_1_len);
+
+    ble_hs_test_util_conn_disconnect(2);
+
+    /*** Database changes while the peer is away. */
+    rc = ble_gatts_svc_set_visibility(svc_handle, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = ble_gatts_db_hash(hash);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ble_gatts_read_test_misc_bonded_conn(2, 1);
+
+    /* Commands of the change-unaware peer are dropped silently. */
+    rc = ble_hs_test_util_l2cap_rx_payload_flat(
+        2, BLE_L2CAP_CID_ATT,
+        ((uint8_t[]){ BLE_ATT_OP_WRITE_CMD,
+                      ble_gatts_read_test_chr_1_val_handle, 0, 1 }), 4);
+    TEST_ASSERT(rc == BLE_HS_EREJECT);
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue() == NULL);
+
+    rc = ble_hs_test_util_l2cap_rx_payload_flat(
+        2, BLE_L2CAP_CID_ATT,
+        ((uint8_t[]){ BLE_ATT_OP_SIGNED_WRITE_CMD,
+                      ble_gatts_read_test_chr_1_val_handle, 0, 1,
+                      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }), 16);
+    TEST_ASSERT(rc != 0);
+    TEST_ASSERT(ble_hs_test_util_prev_tx_dequeue() == NULL);
+
+    /* Its first request is rejected... */
+    rc = ble_hs_test_util_l2cap_rx_payload_flat(
+        2, BLE_L2CAP_CID_ATT,
+        ((uint8_t[]){ BLE_ATT_OP_READ_REQ,
+                      ble_gatts_read_test_chr_1_val_handle, 0 }), 3);
+    TEST_ASSERT(rc == BLE_HS_EREJECT);
+    ble_hs_test_util_verify_tx_err_rsp(BLE_ATT_OP_READ_REQ, 0,
+                                       BLE_ATT_ERR_DB_OUT_OF_SYNC);
+
+    /* ... and the following one makes it change-aware of the new hash. */
+    rc = ble_hs_test_util_l2cap_rx_payload_flat(
+        2, BLE_L2CAP_CID_ATT,
+        ((uint8_t[]){ BLE_ATT_OP_READ_REQ,
+                      ble_gatts_read_test_chr_1_val_handle, 0 }), 3);
+    TEST_ASSERT(rc != BLE_HS_EREJECT);
+    ble_hs_test_util_verify_tx_err_rsp(BLE_ATT_OP_READ_REQ,
+                                       ble_gatts_read_test_chr_1_val_handle,
+                                       BLE_ATT_ERR_INVALID_HANDLE);
+
+    ble_gatts_read_test_misc_verify_stored(
+        BLE_GATT_CLI_SUP_FEAT_ROBUST_CACHING, hash);
+
+    /*** Change while connected; the peer leaves before learning about it. */
+    rc = ble_gatts_svc_set_visibility(svc_handle, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+    ble_hs_test_util_conn_disconnect(2);
+
+    ble_gatts_read_test_misc_bonded_conn(2, 1);
+
+    rc = ble_hs_test_util_l2cap_rx_payload_flat(
+        2, BLE_L2CAP_CID_ATT,
+        ((uint8_t[]){ BLE_ATT_OP_READ_REQ,
+                      ble_gatts_read_test_chr_1_val_handle, 0 }), 3);
+    TEST_ASSERT(rc == BLE_HS_EREJECT);
+    ble_hs_test_util_verify_tx_err_rsp(BLE_ATT_OP_READ_REQ, 0,
+                                       BLE_ATT_ERR_DB_OUT_OF_SYNC);
+
+    ble_gatts_read_test_once(2, ble_gatts_read_test_chr_1_val_handle,
+                             ble_gatts_read_test_chr_1_val,
+                             ble_gatts_read_test_chr_1_len);
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+#endif
+
 TEST_SUITE(ble_gatts_read_test_suite)
 {
     ble_gatts_read_test_case_basic();
     ble_gatts_read_test_case_long();
+#if MYNEWT_VAL(BLE_GATT_ROBUST_CACHING)
+    ble_gatts_read_test_case_db_hash();
+    ble_gatts_read_test_case_db_hash_bonded();
+#endif
 }
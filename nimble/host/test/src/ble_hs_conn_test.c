@@ -216,9 +216,97 @@ TEST_CASE_SELF(ble_hs_conn_test_undirect_connectable_success)
     ble_hs_test_util_assert_mbufs_freed(NULL);
 }
 
+TEST_CASE_SELF(ble_hs_conn_test_lookup)
+{
+    static const uint8_t peer_rpa[6] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+    static const uint8_t null_addr[6];
+    struct ble_hs_conn *conn;
+    ble_addr_t addr;
+    uint16_t handles[4];
+    int i;
+
+    ble_hs_test_util_init();
+
+    /* Use handles that map to the same lookup table bucket. */
+    handles[0] = 1;
+    handles[1] = 1 + MYNEWT_VAL(BLE_MAX_CONNECTIONS);
+    handles[2] = 1 + 2 * MYNEWT_VAL(BLE_MAX_CONNECTIONS);
+    handles[3] = 0x0eff;
+
+    for (i = 0; i < 3; i++) {
+        ble_hs_test_util_create_conn(handles[i],
+                                     ((uint8_t[]){ i + 1, 2, 3, 4, 5, 6 }),
+                                     NULL, NULL);
+    }
+    ble_hs_test_util_create_rpa_conn(handles[3], BLE_OWN_ADDR_PUBLIC,
+                                     null_addr, BLE_ADDR_PUBLIC_ID,
+                                     ((uint8_t[]){ 9, 8, 7, 6, 5, 4 }),
+                                     peer_rpa, BLE_HS_TEST_CONN_FEAT_ALL,
+                                     NULL, NULL);
+
+    ble_hs_lock();
+
+    for (i = 0; i < 4; i++) {
+        conn = ble_hs_conn_find(handles[i]);
+        TEST_ASSERT_FATAL(conn != NULL);
+        TEST_ASSERT(conn->bhc_handle == handles[i]);
+    }
+    TEST_ASSERT(ble_hs_conn_find(2) == NULL);
+
+    for (i = 0; i < 3; i++) {
+        addr.type = BLE_ADDR_PUBLIC;
+        memcpy(addr.val, ((uint8_t[]){ i + 1, 2, 3, 4, 5, 6 }), 6);
+        conn = ble_hs_conn_find_by_addr(&addr);
+        TEST_ASSERT_FATAL(conn != NULL);
+        TEST_ASSERT(conn->bhc_handle == handles[i]);
+    }
+
+    /* Identity address resolves to the connection established over an RPA. */
+    addr.type = BLE_ADDR_PUBLIC;
+    memcpy(addr.val, ((uint8_t[]){ 9, 8, 7, 6, 5, 4 }), 6);
+    conn = ble_hs_conn_find_by_addr(&addr);
+    TEST_ASSERT_FATAL(conn != NULL);
+    TEST_ASSERT(conn->bhc_handle == handles[3]);
+
+    addr.type = BLE_ADDR_RANDOM;
+    memcpy(addr.val, peer_rpa, 6);
+    conn = ble_hs_conn_find_by_addr(&addr);
+    TEST_ASSERT_FATAL(conn != NULL);
+    TEST_ASSERT(conn->bhc_handle == handles[3]);
+
+    /* Updated peer address is found after re-indexing. */
+    conn = ble_hs_conn_find(handles[0]);
+    TEST_ASSERT_FATAL(conn != NULL);
+    conn->bhc_peer_addr.val[0] = 0xaa;
+    ble_hs_conn_peer_addr_updated(conn);
+
+    addr.type = BLE_ADDR_PUBLIC;
+    memcpy(addr.val, ((uint8_t[]){ 1, 2, 3, 4, 5, 6 }), 6);
+    TEST_ASSERT(ble_hs_conn_find_by_addr(&addr) == NULL);
+    addr.val[0] = 0xaa;
+    TEST_ASSERT(ble_hs_conn_find_by_addr(&addr) == conn);
+
+    ble_hs_unlock();
+
+    /* Removed connections can no longer be found. */
+    ble_hs_test_util_conn_disconnect(handles[1]);
+
+    ble_hs_lock();
+    TEST_ASSERT(ble_hs_conn_find(handles[1]) == NULL);
+    TEST_ASSERT(ble_hs_conn_find(handles[0]) != NULL);
+    TEST_ASSERT(ble_hs_conn_find(handles[2]) != NULL);
+    addr.type = BLE_ADDR_PUBLIC;
+    memcpy(addr.val, ((uint8_t[]){ 2, 2, 3, 4, 5, 6 }), 6);
+    TEST_ASSERT(ble_hs_conn_find_by_addr(&addr) == NULL);
+    ble_hs_unlock();
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
 TEST_SUITE(ble_hs_conn_suite)
 {
     ble_hs_conn_test_direct_connect_success();
     ble_hs_conn_test_direct_connectable_success();
     ble_hs_conn_test_undirect_connectable_success();
+    ble_hs_conn_test_lookup();
 }
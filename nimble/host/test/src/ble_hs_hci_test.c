@@ -89,6 +89,84 @@ TEST_CASE_SELF(ble_hs_hci_test_rssi)
     ble_hs_test_util_assert_mbufs_freed(NULL);
 }
 
+static int ble_hs_hci_test_cmd_multi_num_cbs;
+
+static void
+ble_hs_hci_test_cmd_multi_cb(struct ble_hs_hci_cmd_req *req)
+{
+    TEST_ASSERT(req->complete);
+    ble_hs_hci_test_cmd_multi_num_cbs++;
+}
+
+TEST_CASE_SELF(ble_hs_hci_test_cmd_multi)
+{
+    struct ble_hci_cb_set_event_mask_cp evmask = { 0 };
+    struct ble_hci_le_rd_buf_size_rp buf_sz_rsp;
+    struct ble_hci_rd_rssi_rp rssi_rsp;
+    struct ble_hs_hci_cmd_req reqs[3];
+    struct ble_hci_rd_rssi_cp rssi_cmd;
+    int rc;
+
+    memset(reqs, 0, sizeof reqs);
+
+    rssi_cmd.handle = htole16(1);
+    reqs[0].opcode = BLE_HCI_OP(BLE_HCI_OGF_STATUS_PARAMS,
+                                BLE_HCI_OCF_RD_RSSI);
+    reqs[0].cmd = &rssi_cmd;
+    reqs[0].cmd_len = sizeof rssi_cmd;
+    reqs[0].rsp = &rssi_rsp;
+    reqs[0].rsp_len = sizeof rssi_rsp;
+    reqs[0].cb = ble_hs_hci_test_cmd_multi_cb;
+
+    reqs[1].opcode = BLE_HCI_OP(BLE_HCI_OGF_CTLR_BASEBAND,
+                                BLE_HCI_OCF_CB_SET_EVENT_MASK);
+    reqs[1].cmd = &evmask;
+    reqs[1].cmd_len = sizeof evmask;
+    reqs[1].cb = ble_hs_hci_test_cmd_multi_cb;
+
+    reqs[2].opcode = BLE_HCI_OP(BLE_HCI_OGF_LE, BLE_HCI_OCF_LE_RD_BUF_SIZE);
+    reqs[2].rsp = &buf_sz_rsp;
+    reqs[2].rsp_len = sizeof buf_sz_rsp;
+    reqs[2].cb = ble_hs_hci_test_cmd_multi_cb;
+
+    /*** Second command fails; the others still complete. */
+    ble_hs_test_util_hci_ack_set_seq(((struct ble_hs_test_util_hci_ack[]) {
+        {
+            .opcode = BLE_HCI_OP(BLE_HCI_OGF_STATUS_PARAMS,
+                                 BLE_HCI_OCF_RD_RSSI),
+            .evt_params = { 0x01, 0x00, 0xf8 },
+            .evt_params_len = 3,
+        },
+        {
+            .opcode = BLE_HCI_OP(BLE_HCI_OGF_CTLR_BASEBAND,
+                                 BLE_HCI_OCF_CB_SET_EVENT_MASK),
+            .status = BLE_ERR_CMD_DISALLOWED,
+        },
+        {
+            .opcode = BLE_HCI_OP(BLE_HCI_OGF_LE, BLE_HCI_OCF_LE_RD_BUF_SIZE),
+            .evt_params = { 0xfb, 0x00, 0x04 },
+            .evt_params_len = 3,
+        },
+        { 0 }
+    }));
+
+    rc = ble_hs_hci_cmd_tx_multi(reqs, 3);
+    TEST_ASSERT(rc == BLE_HS_HCI_ERR(BLE_ERR_CMD_DISALLOWED));
+    TEST_ASSERT(ble_hs_hci_test_cmd_multi_num_cbs == 3);
+
+    TEST_ASSERT(reqs[0].status == 0);
+    TEST_ASSERT(le16toh(rssi_rsp.handle) == 1);
+    TEST_ASSERT(rssi_rsp.rssi == -8);
+
+    TEST_ASSERT(reqs[1].status == BLE_HS_HCI_ERR(BLE_ERR_CMD_DISALLOWED));
+
+    TEST_ASSERT(reqs[2].status == 0);
+    TEST_ASSERT(le16toh(buf_sz_rsp.data_len) == 251);
+    TEST_ASSERT(buf_sz_rsp.data_packets == 4);
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
 TEST_CASE_SELF(ble_hs_hci_acl_one_conn)
 {
     struct ble_hs_test_util_hci_num_completed_pkts_entry ncpe[2];
@@ -333,10 +411,146 @@ TEST_CASE_SELF(ble_hs_hci_acl_two_conn)
     ble_hs_test_util_assert_mbufs_freed(NULL);
 }
 
+TEST_CASE_SELF(ble_hs_hci_acl_fair)
+{
+    struct ble_hs_test_util_hci_num_completed_pkts_entry ncpe[2];
+    struct ble_gap_conn_tx_stats stats;
+    uint8_t peer_addr1[6] = { 1, 2, 3, 4, 5, 6 };
+    uint8_t peer_addr2[6] = { 2, 3, 4, 5, 6, 7 };
+    uint16_t prev_handle;
+    uint16_t conn_handle;
+    uint16_t attr_handle;
+    struct os_mbuf *om;
+    uint8_t data[8];
+    int rc;
+    int i;
+
+    memset(ncpe, 0, sizeof(ncpe));
+    memset(data, 0, sizeof data);
+
+    ble_hs_test_util_init();
+
+    /* The controller has room for a single 20-byte payload. */
+    rc = ble_hs_hci_set_buf_sz(20, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ble_hs_test_util_create_conn(1, peer_addr1, NULL, NULL);
+    ble_hs_test_util_create_conn(2, peer_addr2, NULL, NULL);
+
+    /* Use up the only controller buffer. */
+    rc = ble_hs_test_util_gatt_write_no_rsp_flat(1, 100, data, sizeof data);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(ble_hs_hci_avail_pkts == 0);
+    ble_hs_test_util_prev_tx_queue_clear();
+
+    /* Queue three packets on each connection.  Connection 1 writes to
+     * attribute 100, connection 2 to attribute 200.
+     */
+    for (i = 0; i < 3; i++) {
+        rc = ble_hs_test_util_gatt_write_no_rsp_flat(1, 100, data,
+                                                     sizeof data);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    for (i = 0; i < 3; i++) {
+        rc = ble_hs_test_util_gatt_write_no_rsp_flat(2, 200, data,
+                                                     sizeof data);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    TEST_ASSERT(ble_hs_test_util_prev_tx_queue_sz() == 0);
+
+    rc = ble_gap_conn_tx_stats(1, &stats);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stats.queue_len == 3);
+    TEST_ASSERT(stats.queue_len_max == 3);
+    TEST_ASSERT(stats.weight == 1);
+
+    /* Free one controller buffer at a time; the connections must take
+     * turns.
+     */
+    conn_handle = 1;
+    prev_handle = BLE_HS_CONN_HANDLE_NONE;
+    for (i = 0; i < 6; i++) {
+        ncpe[0].handle_id = conn_handle;
+        ncpe[0].num_pkts = 1;
+        ble_hs_test_util_hci_rx_num_completed_pkts_event(ncpe);
+        TEST_ASSERT_FATAL(ble_hs_hci_avail_pkts == 0);
+
+        om = ble_hs_test_util_prev_tx_dequeue_pullup();
+        TEST_ASSERT_FATAL(om != NULL);
+        TEST_ASSERT_FATAL(om->om_data[0] == BLE_ATT_OP_WRITE_CMD);
+        attr_handle = get_le16(om->om_data + 1);
+        TEST_ASSERT_FATAL(attr_handle == 100 || attr_handle == 200);
+
+        conn_handle = attr_handle == 100 ? 1 : 2;
+        TEST_ASSERT(conn_handle != prev_handle);
+        prev_handle = conn_handle;
+    }
+    TEST_ASSERT(ble_hs_test_util_prev_tx_queue_sz() == 0);
+
+    rc = ble_gap_conn_tx_stats(2, &stats);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stats.queue_len == 0);
+    TEST_ASSERT(stats.queue_len_max == 3);
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
+TEST_CASE_SELF(ble_hs_hci_acl_wait_requeue)
+{
+    struct ble_hs_test_util_hci_num_completed_pkts_entry ncpe[2];
+    struct ble_gap_conn_tx_stats stats;
+    uint8_t peer_addr[6] = { 1, 2, 3, 4, 5, 6 };
+    uint8_t data[20];
+    int rc;
+    int i;
+
+    memset(ncpe, 0, sizeof(ncpe));
+    memset(data, 0, sizeof data);
+
+    ble_hs_test_util_init();
+
+    /* The controller has room for a single 20-byte payload. */
+    rc = ble_hs_hci_set_buf_sz(20, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ble_hs_test_util_create_conn(1, peer_addr, NULL, NULL);
+
+    /* Use up the only controller buffer. */
+    rc = ble_hs_test_util_gatt_write_no_rsp_flat(1, 100, data, 8);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(ble_hs_hci_avail_pkts == 0);
+
+    /* Queue a packet that takes two fragments. */
+    rc = ble_hs_test_util_gatt_write_no_rsp_flat(1, 100, data, sizeof data);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Free one buffer per second.  The packet goes back to the queue head
+     * after its first fragment; its wait must keep counting from when it
+     * first reached the head.
+     */
+    ncpe[0].handle_id = 1;
+    ncpe[0].num_pkts = 1;
+    for (i = 0; i < 2; i++) {
+        os_time_advance(OS_TICKS_PER_SEC);
+        ble_hs_test_util_hci_rx_num_completed_pkts_event(ncpe);
+    }
+
+    rc = ble_gap_conn_tx_stats(1, &stats);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stats.queue_len == 0);
+    TEST_ASSERT(stats.wait_max_ms == 2000);
+
+    ble_hs_test_util_prev_tx_queue_clear();
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
 TEST_SUITE(ble_hs_hci_suite)
 {
     ble_hs_hci_test_event_bad();
     ble_hs_hci_test_rssi();
+    ble_hs_hci_test_cmd_multi();
     ble_hs_hci_acl_one_conn();
     ble_hs_hci_acl_two_conn();
+    ble_hs_hci_acl_fair();
+    ble_hs_hci_acl_wait_requeue();
 }
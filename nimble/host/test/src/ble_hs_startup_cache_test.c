@@ -0,0 +1,218 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "nimble/hci_common.h"
+#include "ble_hs_test.h"
+#include "testutil/testutil.h"
+#include "ble_hs_test_util.h"
+
+#if MYNEWT_VAL(BLE_HS_STARTUP_CACHE)
+
+/** Local version and public address reported by the fake controller. */
+static uint8_t ble_hs_startup_cache_test_ver[8];
+static uint8_t ble_hs_startup_cache_test_addr[6];
+
+static void
+ble_hs_startup_cache_test_ack_add(struct ble_hs_test_util_hci_ack *acks,
+                                  int *num_acks, uint8_t ogf, uint16_t ocf,
+                                  const void *params, uint8_t params_len)
+{
+    struct ble_hs_test_util_hci_ack *ack;
+
+    ack = acks + (*num_acks)++;
+    memset(ack, 0, sizeof *ack);
+    ack->opcode = ble_hs_hci_util_opcode_join(ogf, ocf);
+    memcpy(ack->evt_params, params, params_len);
+    ack->evt_params_len = params_len;
+}
+
+/**
+ * Sets the acknowledgements of a host sync; the capability queries are only
+ * acknowledged if 'query' is set.
+ */
+static void
+ble_hs_startup_cache_test_set_acks(int query)
+{
+    static const uint8_t sup_f[8] = { 0, 0, 0, 0, 0x60, 0, 0, 0 };
+    static const uint8_t le_buf_sz[3] = { 0x14, 0x00, 200 };
+    static const uint8_t le_sup_f[8] = { 0 };
+    struct ble_hs_test_util_hci_ack acks[10];
+    int num_acks;
+
+    num_acks = 0;
+    ble_hs_startup_cache_test_ack_add(acks, &num_acks,
+                                      BLE_HCI_OGF_CTLR_BASEBAND,
+                                      BLE_HCI_OCF_CB_RESET, NULL, 0);
+    ble_hs_startup_cache_test_ack_add(acks, &num_acks,
+                                      BLE_HCI_OGF_INFO_PARAMS,
+                                      BLE_HCI_OCF_IP_RD_LOCAL_VER,
+                                      ble_hs_startup_cache_test_ver,
+                                      sizeof ble_hs_startup_cache_test_ver);
+    ble_hs_startup_cache_test_ack_add(acks, &num_acks,
+                                      BLE_HCI_OGF_INFO_PARAMS,
+                                      BLE_HCI_OCF_IP_RD_BD_ADDR,
+                                      ble_hs_startup_cache_test_addr,
+                                      sizeof ble_hs_startup_cache_test_addr);
+    if (query) {
+        ble_hs_startup_cache_test_ack_add(acks, &num_acks,
+                                          BLE_HCI_OGF_INFO_PARAMS,
+                                          BLE_HCI_OCF_IP_RD_LOC_SUPP_FEAT,
+                                          sup_f, sizeof sup_f);
+    }
+    ble_hs_startup_cache_test_ack_add(acks, &num_acks,
+                                      BLE_HCI_OGF_CTLR_BASEBAND,
+                                      BLE_HCI_OCF_CB_SET_EVENT_MASK, NULL, 0);
+    ble_hs_startup_cache_test_ack_add(acks, &num_acks,
+                                      BLE_HCI_OGF_CTLR_BASEBAND,
+                                      BLE_HCI_OCF_CB_SET_EVENT_MASK2, NULL, 0);
+    ble_hs_startup_cache_test_ack_add(acks, &num_acks, BLE_HCI_OGF_LE,
+                                      BLE_HCI_OCF_LE_SET_EVENT_MASK, NULL, 0);
+    if (query) {
+        ble_hs_startup_cache_test_ack_add(acks, &num_acks, BLE_HCI_OGF_LE,
+                                          BLE_HCI_OCF_LE_RD_BUF_SIZE,
+                                          le_buf_sz, sizeof le_buf_sz);
+        ble_hs_startup_cache_test_ack_add(acks, &num_acks, BLE_HCI_OGF_LE,
+                                          BLE_HCI_OCF_LE_RD_LOC_SUPP_FEAT,
+                                          le_sup_f, sizeof le_sup_f);
+    }
+
+    /* Terminator. */
+    acks[num_acks].opcode = 0;
+
+    ble_hs_test_util_hci_ack_set_seq(acks);
+}
+
+/**
+ * Resyncs the host the way it does after a controller reset.
+ */
+static void
+ble_hs_startup_cache_test_resync(int query)
+{
+    int rc;
+
+    ble_hs_startup_cache_test_set_acks(query);
+    ble_hs_test_util_hci_out_clear();
+
+    ble_hs_id_reset();
+    rc = ble_hs_startup_go();
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+/**
+ * Indicates whether the host sent the specified command since the last sync;
+ * consumes the sent commands.
+ */
+static int
+ble_hs_startup_cache_test_sent(uint8_t ogf, uint16_t ocf)
+{
+    uint8_t *cmd;
+    int sent;
+
+    sent = 0;
+    while ((cmd = ble_hs_test_util_hci_out_first()) != NULL) {
+        if (get_le16(cmd) == ble_hs_hci_util_opcode_join(ogf, ocf)) {
+            sent = 1;
+        }
+    }
+
+    return sent;
+}
+
+static void
+ble_hs_startup_cache_test_verify_pub(void)
+{
+    uint8_t addr[6];
+    int rc;
+
+    rc = ble_hs_id_copy_addr(BLE_ADDR_PUBLIC, addr, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(memcmp(addr, ble_hs_startup_cache_test_addr, 6) == 0);
+}
+
+TEST_CASE_SELF(ble_hs_startup_cache_test_warm)
+{
+    static const uint8_t ver[8] = { 0x09, 0, 0, 0, 0, 0, 0, 0 };
+    static const uint8_t addr[6] = BLE_HS_TEST_UTIL_PUB_ADDR_VAL;
+    int rc;
+
+    /* The host syncs once during init, with the same controller. */
+    ble_hs_test_util_init();
+    memcpy(ble_hs_startup_cache_test_ver, ver, sizeof ver);
+    memcpy(ble_hs_startup_cache_test_addr, addr, sizeof addr);
+
+    /*** Same controller: only the configuration commands are sent. */
+    ble_hs_startup_cache_test_resync(0);
+
+    ble_hs_test_util_hci_verify_tx(BLE_HCI_OGF_CTLR_BASEBAND,
+                                   BLE_HCI_OCF_CB_RESET, NULL);
+    ble_hs_test_util_hci_verify_tx(BLE_HCI_OGF_INFO_PARAMS,
+                                   BLE_HCI_OCF_IP_RD_LOCAL_VER, NULL);
+    ble_hs_test_util_hci_verify_tx(BLE_HCI_OGF_INFO_PARAMS,
+                                   BLE_HCI_OCF_IP_RD_BD_ADDR, NULL);
+    ble_hs_test_util_hci_verify_tx(BLE_HCI_OGF_CTLR_BASEBAND,
+                                   BLE_HCI_OCF_CB_SET_EVENT_MASK, NULL);
+    ble_hs_test_util_hci_verify_tx(BLE_HCI_OGF_CTLR_BASEBAND,
+                                   BLE_HCI_OCF_CB_SET_EVENT_MASK2, NULL);
+    ble_hs_test_util_hci_verify_tx(BLE_HCI_OGF_LE,
+                                   BLE_HCI_OCF_LE_SET_EVENT_MASK, NULL);
+    TEST_ASSERT(ble_hs_test_util_hci_out_first() == NULL);
+
+    /* Cached public address restored. */
+    ble_hs_startup_cache_test_verify_pub();
+
+    /*** Same version, different public address: a different controller. */
+    ble_hs_startup_cache_test_addr[0]++;
+    ble_hs_startup_cache_test_resync(1);
+    TEST_ASSERT(ble_hs_startup_cache_test_sent(BLE_HCI_OGF_LE,
+                                               BLE_HCI_OCF_LE_RD_BUF_SIZE));
+    ble_hs_startup_cache_test_verify_pub();
+
+    /*** Different version: capabilities are read again. */
+    ble_hs_startup_cache_test_ver[1]++;
+    ble_hs_startup_cache_test_resync(1);
+    TEST_ASSERT(ble_hs_startup_cache_test_sent(BLE_HCI_OGF_LE,
+                                               BLE_HCI_OCF_LE_RD_BUF_SIZE));
+
+    /*** Same controller again: the new capabilities were cached. */
+    ble_hs_startup_cache_test_resync(0);
+    TEST_ASSERT(!ble_hs_startup_cache_test_sent(BLE_HCI_OGF_LE,
+                                                BLE_HCI_OCF_LE_RD_BUF_SIZE));
+    ble_hs_startup_cache_test_verify_pub();
+
+    /*** Cache cleared when the host is restarted. */
+    ble_hs_enabled_state = BLE_HS_ENABLED_STATE_OFF;
+    ble_hs_startup_cache_test_set_acks(1);
+    ble_hs_test_util_hci_out_clear();
+    rc = ble_hs_start();
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ble_hs_startup_cache_test_sent(BLE_HCI_OGF_LE,
+                                               BLE_HCI_OCF_LE_RD_BUF_SIZE));
+
+    ble_hs_test_util_assert_mbufs_freed(NULL);
+}
+
+#endif
+
+TEST_SUITE(ble_hs_startup_cache_test_suite)
+{
+#if MYNEWT_VAL(BLE_HS_STARTUP_CACHE)
+    ble_hs_startup_cache_test_warm();
+#endif
+}
@@ -42,6 +42,7 @@ main(int argc, char **argv)
     ble_gap_test_suite_disc();
 
     ble_att_clt_suite();
+    ble_att_eatt_test_suite();
     ble_att_svr_suite();
     ble_gap_test_suite_adv();
     ble_gap_test_suite_conn_cancel();
@@ -54,6 +55,8 @@ main(int argc, char **argv)
     ble_gap_test_suite_timeout();
     ble_gap_test_suite_update_conn();
     ble_gap_test_suite_wl();
+    ble_gatt_cache_test_suite();
+    ble_gatt_disc_db_test_suite();
     ble_gatt_conn_suite();
     ble_gatt_disc_c_test_suite();
     ble_gatt_disc_d_test_suite();
@@ -69,6 +72,7 @@ main(int argc, char **argv)
     ble_hs_hci_suite();
     ble_hs_id_test_suite_auto();
     ble_hs_pvcy_test_suite_irk();
+    ble_hs_startup_cache_test_suite();
     ble_l2cap_test_suite();
     ble_os_test_suite();
     ble_sm_gen_test_suite();
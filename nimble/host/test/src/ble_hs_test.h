@@ -23,6 +23,7 @@
 #include "testutil/testutil.h"
 
 TEST_SUITE_DECL(ble_att_clt_suite);
+TEST_SUITE_DECL(ble_att_eatt_test_suite);
 TEST_SUITE_DECL(ble_att_svr_suite);
 TEST_SUITE_DECL(ble_gap_test_suite_adv);
 TEST_SUITE_DECL(ble_gap_test_suite_conn_cancel);
@@ -36,6 +37,8 @@ TEST_SUITE_DECL(ble_gap_test_suite_stop_adv);
 TEST_SUITE_DECL(ble_gap_test_suite_timeout);
 TEST_SUITE_DECL(ble_gap_test_suite_update_conn);
 TEST_SUITE_DECL(ble_gap_test_suite_wl);
+TEST_SUITE_DECL(ble_gatt_cache_test_suite);
+TEST_SUITE_DECL(ble_gatt_disc_db_test_suite);
 TEST_SUITE_DECL(ble_gatt_conn_suite);
 TEST_SUITE_DECL(ble_gatt_disc_c_test_suite);
 TEST_SUITE_DECL(ble_gatt_disc_d_test_suite);
@@ -51,6 +54,7 @@ TEST_SUITE_DECL(ble_hs_conn_suite);
 TEST_SUITE_DECL(ble_hs_hci_suite);
 TEST_SUITE_DECL(ble_hs_id_test_suite_auto);
 TEST_SUITE_DECL(ble_hs_pvcy_test_suite_irk);
+TEST_SUITE_DECL(ble_hs_startup_cache_test_suite);
 TEST_SUITE_DECL(ble_l2cap_test_suite);
 TEST_SUITE_DECL(ble_os_test_suite);
 TEST_SUITE_DECL(ble_sm_gen_test_suite);
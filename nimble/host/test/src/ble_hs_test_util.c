@@ -36,6 +36,7 @@ uint8_t g_dev_addr[BLE_DEV_ADDR_LEN];
 
 static STAILQ_HEAD(, os_mbuf_pkthdr) ble_hs_test_util_prev_tx_queue;
 struct os_mbuf *ble_hs_test_util_prev_tx_cur;
+static uint16_t ble_hs_test_util_prev_tx_cur_cid;
 
 int ble_sm_test_store_obj_type;
 union ble_store_key ble_sm_test_store_key;
@@ -111,6 +112,7 @@ ble_hs_test_util_prev_tx_dequeue(void)
 
         os_mbuf_adj(om, BLE_L2CAP_HDR_SZ);
 
+        ble_hs_test_util_prev_tx_cur_cid = l2cap_hdr.cid;
         ble_hs_test_util_prev_tx_cur = om;
         while (OS_MBUF_PKTLEN(ble_hs_test_util_prev_tx_cur) <
                l2cap_hdr.len) {
@@ -145,6 +147,15 @@ ble_hs_test_util_prev_tx_dequeue_pullup(void)
     return om;
 }
 
+/**
+ * Returns the L2CAP channel ID of the most recently dequeued packet.
+ */
+uint16_t
+ble_hs_test_util_prev_tx_cid(void)
+{
+    return ble_hs_test_util_prev_tx_cur_cid;
+}
+
 int
 ble_hs_test_util_prev_tx_queue_sz(void)
 {
@@ -743,7 +754,8 @@ ble_hs_test_util_set_att_mtu(uint16_t conn_handle, uint16_t mtu)
 
     ble_hs_lock();
 
-    rc = ble_att_conn_chan_find(conn_handle, &conn, &chan);
+    rc = ble_att_conn_chan_find(conn_handle, BLE_L2CAP_CID_ATT, &conn,
+                                &chan);
     assert(rc == 0);
     chan->my_mtu = mtu;
     chan->peer_mtu = mtu;
@@ -1090,6 +1102,138 @@ ble_hs_test_util_rx_att_err_rsp(uint16_t conn_handle, uint8_t req_op,
     TEST_ASSERT(rc == 0);
 }
 
+#if MYNEWT_VAL(BLE_EATT_CHAN_NUM) > 0
+/**
+ * Opens the specified number of enhanced ATT bearers and answers the connect
+ * request as the peer would.  Channels with a zero entry in 'accept' are
+ * refused.  The source CIDs of the bearers are written to out_scids, 0 for
+ * refused ones.
+ */
+void
+ble_hs_test_util_eatt_connect(uint16_t conn_handle, int num, uint16_t result,
+                              const int *accept, uint16_t *out_scids)
+{
+    struct ble_l2cap_sig_credit_base_connect_req *req;
+    struct ble_l2cap_sig_credit_base_connect_rsp *rsp;
+    struct ble_l2cap_sig_hdr *hdr;
+    struct os_mbuf *om;
+    uint8_t buf[sizeof *rsp + MYNEWT_VAL(BLE_EATT_CHAN_NUM) * 2];
+    uint16_t scid;
+    int rc;
+    int i;
+
+    rc = ble_att_eatt_connect(conn_handle, num);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    om = ble_hs_test_util_prev_tx_dequeue_pullup();
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT_FATAL(ble_hs_test_util_prev_tx_cid() == BLE_L2CAP_CID_SIG);
+
+    hdr = (struct ble_l2cap_sig_hdr *)om->om_data;
+    TEST_ASSERT_FATAL(hdr->op == BLE_L2CAP_SIG_OP_CREDIT_CONNECT_REQ);
+    TEST_ASSERT_FATAL(le16toh(hdr->length) == sizeof *req + num * 2);
+
+    req = (struct ble_l2cap_sig_credit_base_connect_req *)hdr->data;
+    TEST_ASSERT(le16toh(req->psm) == BLE_HS_TEST_UTIL_EATT_PSM);
+    TEST_ASSERT(le16toh(req->mtu) == MYNEWT_VAL(BLE_EATT_MTU));
+
+    memset(buf, 0, sizeof buf);
+    rsp = (struct ble_l2cap_sig_credit_base_connect_rsp *)buf;
+    rsp->mtu = htole16(MYNEWT_VAL(BLE_EATT_MTU) + 16);
+    rsp->mps = htole16(MYNEWT_VAL(BLE_L2CAP_COC_MPS));
+    rsp->credits = htole16(100);
+    rsp->result = htole16(result);
+
+    for (i = 0; i < num; i++) {
+        scid = le16toh(req->scids[i]);
+        if (accept == NULL || accept[i]) {
+            rsp->dcids[i] = htole16(BLE_HS_TEST_UTIL_EATT_DCID(scid));
+            out_scids[i] = scid;
+        } else {
+            out_scids[i] = 0;
+        }
+    }
+
+    rc = ble_hs_test_util_inject_rx_l2cap_sig(
+        conn_handle, BLE_L2CAP_SIG_OP_CREDIT_CONNECT_RSP, hdr->identifier,
+        rsp, sizeof *rsp + num * 2);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+/**
+ * Dequeues the next outgoing ATT PDU, whichever bearer it was sent on, and
+ * strips the SDU length of enhanced bearers.  L2CAP credit packets are
+ * skipped.  The source CID of the bearer
+ * is written to out_cid; BLE_L2CAP_CID_ATT for the unenhanced bearer.
+ */
+struct os_mbuf *
+ble_hs_test_util_eatt_prev_tx_dequeue_pullup(uint16_t *out_cid)
+{
+    struct os_mbuf *om;
+    uint16_t cid;
+
+    /* Credits returned for received SDUs are not of interest. */
+    do {
+        om = ble_hs_test_util_prev_tx_dequeue_pullup();
+        if (om == NULL) {
+            return NULL;
+        }
+
+        cid = ble_hs_test_util_prev_tx_cid();
+    } while (cid == BLE_L2CAP_CID_SIG &&
+             om->om_data[0] == BLE_L2CAP_SIG_OP_FLOW_CTRL_CREDIT);
+
+    if (cid != BLE_L2CAP_CID_ATT) {
+        TEST_ASSERT_FATAL(get_le16(om->om_data) == OS_MBUF_PKTLEN(om) - 2);
+        os_mbuf_adj(om, 2);
+        cid -= BLE_HS_TEST_UTIL_EATT_DCID(0);
+    }
+
+    *out_cid = cid;
+    return om;
+}
+
+/**
+ * Receives an ATT PDU on the bearer with the specified source CID.
+ */
+void
+ble_hs_test_util_eatt_rx_payload_flat(uint16_t conn_handle, uint16_t cid,
+                                      const void *data, int len)
+{
+    uint8_t buf[BLE_ATT_MTU_DFLT + 2];
+    int rc;
+
+    if (cid == BLE_L2CAP_CID_ATT) {
+        rc = ble_hs_test_util_l2cap_rx_payload_flat(conn_handle, cid,
+                                                    data, len);
+    } else {
+        TEST_ASSERT_FATAL(len <= BLE_ATT_MTU_DFLT);
+        put_le16(buf, len);
+        memcpy(buf + 2, data, len);
+        rc = ble_hs_test_util_l2cap_rx_payload_flat(conn_handle, cid,
+                                                    buf, len + 2);
+    }
+    TEST_ASSERT(rc == 0);
+}
+
+void
+ble_hs_test_util_eatt_rx_att_err_rsp(uint16_t conn_handle, uint16_t cid,
+                                     uint8_t req_op, uint8_t error_code,
+                                     uint16_t err_handle)
+{
+    struct ble_att_error_rsp rsp;
+    uint8_t buf[BLE_ATT_ERROR_RSP_SZ];
+
+    rsp.baep_req_op = req_op;
+    rsp.baep_handle = err_handle;
+    rsp.baep_error_code = error_code;
+
+    ble_att_error_rsp_write(buf, sizeof buf, &rsp);
+
+    ble_hs_test_util_eatt_rx_payload_flat(conn_handle, cid, buf, sizeof buf);
+}
+#endif
+
 void
 ble_hs_test_util_verify_tx_prep_write(uint16_t attr_handle, uint16_t offset,
                                       const void *data, int data_len)
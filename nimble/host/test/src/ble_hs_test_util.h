@@ -97,6 +97,7 @@ struct ble_hs_test_util_att_group_type_entry {
 void ble_hs_test_util_prev_tx_enqueue(struct os_mbuf *om);
 struct os_mbuf *ble_hs_test_util_prev_tx_dequeue(void);
 struct os_mbuf *ble_hs_test_util_prev_tx_dequeue_pullup(void);
+uint16_t ble_hs_test_util_prev_tx_cid(void);
 int ble_hs_test_util_prev_tx_queue_sz(void);
 void ble_hs_test_util_prev_tx_queue_clear(void);
 
@@ -228,6 +229,26 @@ int ble_hs_test_util_rx_att_indicate_req(uint16_t conn_handle,
                                          uint16_t attr_len);
 void ble_hs_test_util_rx_att_err_rsp(uint16_t conn_handle, uint8_t req_op,
                                      uint8_t error_code, uint16_t err_handle);
+
+#if MYNEWT_VAL(BLE_EATT_CHAN_NUM) > 0
+#define BLE_HS_TEST_UTIL_EATT_PSM           0x0027
+
+/* Peer CIDs are offset from ours so that the two cannot be mixed up. */
+#define BLE_HS_TEST_UTIL_EATT_DCID(scid)    ((scid) + 0x10)
+
+void ble_hs_test_util_eatt_connect(uint16_t conn_handle, int num,
+                                   uint16_t result, const int *accept,
+                                   uint16_t *out_scids);
+struct os_mbuf *ble_hs_test_util_eatt_prev_tx_dequeue_pullup(
+    uint16_t *out_cid);
+void ble_hs_test_util_eatt_rx_payload_flat(uint16_t conn_handle,
+                                           uint16_t cid,
+                                           const void *data, int len);
+void ble_hs_test_util_eatt_rx_att_err_rsp(uint16_t conn_handle, uint16_t cid,
+                                          uint8_t req_op, uint8_t error_code,
+                                          uint16_t err_handle);
+#endif
+
 void ble_hs_test_util_verify_tx_prep_write(uint16_t attr_handle,
                                            uint16_t offset,
                                            const void *data, int data_len);
@@ -251,6 +251,12 @@ static const struct ble_hs_test_util_hci_ack hci_startup_seq[] = {
         .evt_params = { 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
         .evt_params_len = 8,
     },
+    {
+        .opcode = ble_hs_hci_util_opcode_join(
+            BLE_HCI_OGF_INFO_PARAMS, BLE_HCI_OCF_IP_RD_BD_ADDR),
+        .evt_params = BLE_HS_TEST_UTIL_PUB_ADDR_VAL,
+        .evt_params_len = 6,
+    },
     {
         .opcode = ble_hs_hci_util_opcode_join(
          BLE_HCI_OGF_INFO_PARAMS, BLE_HCI_OCF_IP_RD_LOC_SUPP_FEAT),
@@ -284,12 +290,6 @@ static const struct ble_hs_test_util_hci_ack hci_startup_seq[] = {
         .evt_params = { 0 },
         .evt_params_len = 8,
     },
-    {
-        .opcode = ble_hs_hci_util_opcode_join(
-            BLE_HCI_OGF_INFO_PARAMS, BLE_HCI_OCF_IP_RD_BD_ADDR),
-        .evt_params = BLE_HS_TEST_UTIL_PUB_ADDR_VAL,
-        .evt_params_len = 6,
-    },
     {
         .opcode = ble_hs_hci_util_opcode_join(
             BLE_HCI_OGF_LE, BLE_HCI_OCF_LE_SET_ADDR_RES_EN),
@@ -512,7 +512,7 @@ ble_hs_test_util_hci_verify_tx(uint8_t ogf, uint16_t ocf,
  * $rx                                                                       *
  *****************************************************************************/
 
-static void
+void
 ble_hs_test_util_hci_rx_evt(uint8_t *evt)
 {
     uint8_t *evbuf;
@@ -88,6 +88,7 @@ uint8_t *ble_hs_test_util_hci_verify_tx(uint8_t ogf, uint16_t ocf,
                                         uint8_t *out_param_len);
 
 /* $rx */
+void ble_hs_test_util_hci_rx_evt(uint8_t *evt);
 void ble_hs_test_util_hci_rx_num_completed_pkts_event(
     struct ble_hs_test_util_hci_num_completed_pkts_entry *entries);
 void ble_hs_test_util_hci_rx_disconn_complete_event(uint16_t conn_handle,
@@ -1061,6 +1061,29 @@ struct ble_hci_le_set_host_feat_cp {
     uint8_t val;
 } __attribute__((packed));
 
+/* List of OCF for Vendor specific commands (OGF = 0x3F) */
+#define BLE_HCI_OCF_VS_SET_MAX_CONN_EVENT_LEN            (0x0001)
+struct ble_hci_vs_set_max_conn_event_len_cp {
+    uint16_t conn_handle;
+    uint32_t max_event_len;
+} __attribute__((packed));
+struct ble_hci_vs_set_max_conn_event_len_rp {
+    uint16_t conn_handle;
+} __attribute__((packed));
+
+#define BLE_HCI_OCF_VS_RD_CONN_TPUT_STATS                (0x0002)
+struct ble_hci_vs_rd_conn_tput_stats_cp {
+    uint16_t conn_handle;
+} __attribute__((packed));
+struct ble_hci_vs_rd_conn_tput_stats_rp {
+    uint16_t conn_handle;
+    uint32_t events;
+    uint32_t tx_pdus;
+    uint32_t tx_bytes;
+    uint32_t rx_pdus;
+    uint32_t rx_bytes;
+} __attribute__((packed));
+
 /* Command Specific Definitions */
 /* --- Set controller to host flow control (OGF 0x03, OCF 0x0031) --- */
 #define BLE_HCI_CTLR_TO_HOST_FC_OFF         (0)
@@ -1807,6 +1830,9 @@ struct ble_hci_ev_le_subev_biginfo_adv_report {
 #define BLE_HCI_LE_ADV_RPT_NUM_RPTS_MIN     (1)
 #define BLE_HCI_LE_ADV_RPT_NUM_RPTS_MAX     (0x19)
 
+/* LE extended advertising report event. (sub event 0x0D) */
+#define BLE_HCI_LE_EXT_ADV_RPT_NUM_RPTS_MAX (0x0A)
+
 /* Bluetooth Assigned numbers for version information.*/
 #define BLE_HCI_VER_BCS_1_0b                (0)
 #define BLE_HCI_VER_BCS_1_1                 (1)
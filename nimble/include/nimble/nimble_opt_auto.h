@@ -77,6 +77,10 @@ extern "C" {
 #define NIMBLE_BLE_ATT_CLT_READ_MULT            \
     (MYNEWT_VAL(BLE_GATT_READ_MULT))
 
+#undef NIMBLE_BLE_ATT_CLT_READ_MULT_VAR
+#define NIMBLE_BLE_ATT_CLT_READ_MULT_VAR        \
+    (MYNEWT_VAL(BLE_GATT_READ_MULT_VAR))
+
 #undef NIMBLE_BLE_ATT_CLT_READ_GROUP_TYPE
 #define NIMBLE_BLE_ATT_CLT_READ_GROUP_TYPE      \
     (MYNEWT_VAL(BLE_GATT_DISC_ALL_SVCS))
@@ -101,6 +105,10 @@ extern "C" {
 #define NIMBLE_BLE_ATT_CLT_NOTIFY               \
     (MYNEWT_VAL(BLE_GATT_NOTIFY))
 
+#undef NIMBLE_BLE_ATT_CLT_NOTIFY_MULTI
+#define NIMBLE_BLE_ATT_CLT_NOTIFY_MULTI         \
+    (MYNEWT_VAL(BLE_GATT_NOTIFY_MULTI))
+
 #undef NIMBLE_BLE_ATT_CLT_INDICATE
 #define NIMBLE_BLE_ATT_CLT_INDICATE             \
     (MYNEWT_VAL(BLE_GATT_INDICATE))
@@ -71,6 +71,11 @@ struct sockaddr_hci {
 #include <fcntl.h>
 #include <sys/ioctl.h>
 
+#if MYNEWT_VAL(BLE_SOCK_RX_BLOCKING)
+#include <poll.h>
+#include <sys/eventfd.h>
+#endif
+
 #include "sysinit/sysinit.h"
 #include "os/os.h"
 #include "mem/mem.h"
@@ -191,14 +196,44 @@ static void *ble_hci_sock_rx_cmd_arg;
 static ble_hci_trans_rx_acl_fn *ble_hci_sock_rx_acl_cb;
 static void *ble_hci_sock_rx_acl_arg;
 
+/* Must be a power of two and hold at least one full command or event. */
+#define BLE_HCI_SOCK_RX_RING_SZ     1024
+#define BLE_HCI_SOCK_RX_RING_MASK   (BLE_HCI_SOCK_RX_RING_SZ - 1)
+
 static struct ble_hci_sock_state {
     int sock;
     struct ble_npl_eventq evq;
     struct ble_npl_event ev;
     struct ble_npl_callout timer;
+#if MYNEWT_VAL(BLE_SOCK_RX_BLOCKING)
+    int wake_fd;
+
+    /*
+     * Set by the reader thread when the socket reports EOF or an error.  Only
+     * the host changes sock; it replaces the socket on the next transport
+     * reset.
+     */
+    int rx_closed;
+#endif
+
+    /*
+     * Received bytes not parsed yet.  Frames are parsed in place; rx_head
+     * and rx_tail are free-running and masked on access.
+     */
+    uint32_t rx_head;
+    uint32_t rx_tail;
+    uint8_t rx_ring[BLE_HCI_SOCK_RX_RING_SZ];
+
+    /*
+     * ACL packet whose remaining rx_acl_rem bytes have not arrived yet.  They
+     * are read straight into the trailing space of its last mbuf; anything
+     * that does not fit lands in the ring and is appended from there.
+     */
+    struct os_mbuf *rx_acl;
+    uint16_t rx_acl_rem;
 
-    uint16_t rx_off;
-    uint8_t rx_data[512];
+    /* Number of bytes to discard from a packet that could not be stored. */
+    uint16_t rx_skip;
 } ble_hci_sock_state;
 
 #if MYNEWT_VAL(BLE_SOCK_USE_TCP)
@@ -317,129 +352,335 @@ ble_hci_sock_cmdevt_tx(uint8_t *hci_ev, uint8_t h4_type)
     return 0;
 }
 
-static int
-ble_hci_sock_rx_msg(void)
+static uint8_t
+ble_hci_sock_rx_peek(const struct ble_hci_sock_state *bhss, uint32_t off)
+{
+    return bhss->rx_ring[(bhss->rx_tail + off) & BLE_HCI_SOCK_RX_RING_MASK];
+}
+
+/* Copies len bytes at offset off from the ring; handles wrapping. */
+static void
+ble_hci_sock_rx_copy(const struct ble_hci_sock_state *bhss, void *dst,
+                     uint32_t off, uint32_t len)
+{
+    uint32_t idx;
+    uint32_t n;
+
+    idx = (bhss->rx_tail + off) & BLE_HCI_SOCK_RX_RING_MASK;
+    n = min(len, BLE_HCI_SOCK_RX_RING_SZ - idx);
+
+    memcpy(dst, &bhss->rx_ring[idx], n);
+    memcpy((uint8_t *)dst + n, bhss->rx_ring, len - n);
+}
+
+static void
+ble_hci_sock_rx_acl_done(struct ble_hci_sock_state *bhss)
 {
-    struct ble_hci_sock_state *bhss;
-    int len;
     struct os_mbuf *m;
+    int sr;
+
+    m = bhss->rx_acl;
+    bhss->rx_acl = NULL;
+
+    OS_ENTER_CRITICAL(sr);
+    ble_hci_sock_rx_acl_cb(m, ble_hci_sock_rx_acl_arg);
+    OS_EXIT_CRITICAL(sr);
+}
+
+/* Discards any partially received packet. */
+static void
+ble_hci_sock_rx_reset(void)
+{
+    struct ble_hci_sock_state *bhss = &ble_hci_sock_state;
+
+    if (bhss->rx_acl != NULL) {
+        os_mbuf_free_chain(bhss->rx_acl);
+        bhss->rx_acl = NULL;
+    }
+    bhss->rx_acl_rem = 0;
+    bhss->rx_skip = 0;
+    bhss->rx_head = 0;
+    bhss->rx_tail = 0;
+}
+
+#if MYNEWT_VAL(BLE_CONTROLLER) || MYNEWT_VAL(BLE_HOST)
+/*
+ * Passes a command or event of len bytes (H4 indicator included) at the
+ * start of the ring to the stack.
+ */
+static void
+ble_hci_sock_rx_cmdevt(struct ble_hci_sock_state *bhss, int buf_type,
+                       uint32_t len)
+{
+    uint32_t buf_sz;
     uint8_t *data;
     int sr;
     int rc;
 
-    bhss = &ble_hci_sock_state;
-    if (bhss->sock < 0) {
-        return -1;
+    if (buf_type == BLE_HCI_TRANS_BUF_CMD) {
+        buf_sz = BLE_HCI_TRANS_CMD_SZ;
+    } else {
+        buf_sz = MYNEWT_VAL(BLE_HCI_EVT_BUF_SIZE);
     }
-    len = read(bhss->sock, bhss->rx_data + bhss->rx_off,
-               sizeof(bhss->rx_data) - bhss->rx_off);
-    if (len < 0) {
-        return -2;
+    if (len - 1 > buf_sz) {
+        STATS_INC(hci_sock_stats, ierr);
+        return;
+    }
+
+    data = ble_hci_trans_buf_alloc(buf_type);
+    if (!data) {
+        STATS_INC(hci_sock_stats, ierr);
+        return;
     }
+
+    ble_hci_sock_rx_copy(bhss, data, 1, len - 1);
+
+    OS_ENTER_CRITICAL(sr);
+    rc = ble_hci_sock_rx_cmd_cb(data, ble_hci_sock_rx_cmd_arg);
+    OS_EXIT_CRITICAL(sr);
+    if (rc) {
+        ble_hci_trans_buf_free(data);
+        STATS_INC(hci_sock_stats, ierr);
+    }
+}
+#endif
+
+/*
+ * Appends the buffered part of the pending ACL packet to its mbuf chain,
+ * chaining in new mbufs as needed.  If the pool runs dry the packet is
+ * dropped and its remaining bytes are skipped.
+ */
+static void
+ble_hci_sock_rx_acl_fill(struct ble_hci_sock_state *bhss)
+{
+    uint32_t idx;
+    uint32_t len;
+    uint32_t n;
+    int rc;
+
+    len = min(bhss->rx_head - bhss->rx_tail, bhss->rx_acl_rem);
     if (len == 0) {
-        return -1;
+        return;
     }
-    bhss->rx_off += len;
-    STATS_INCN(hci_sock_stats, ibytes, len);
 
-    while (bhss->rx_off > 0) {
-        switch (bhss->rx_data[0]) {
+    idx = bhss->rx_tail & BLE_HCI_SOCK_RX_RING_MASK;
+    n = min(len, BLE_HCI_SOCK_RX_RING_SZ - idx);
+
+    rc = os_mbuf_append(bhss->rx_acl, &bhss->rx_ring[idx], n);
+    if (rc == 0 && len > n) {
+        rc = os_mbuf_append(bhss->rx_acl, bhss->rx_ring, len - n);
+    }
+    bhss->rx_tail += len;
+    bhss->rx_acl_rem -= len;
+
+    if (rc != 0) {
+        STATS_INC(hci_sock_stats, imem);
+        os_mbuf_free_chain(bhss->rx_acl);
+        bhss->rx_acl = NULL;
+        bhss->rx_skip = bhss->rx_acl_rem;
+        bhss->rx_acl_rem = 0;
+        return;
+    }
+
+    if (bhss->rx_acl_rem == 0) {
+        ble_hci_sock_rx_acl_done(bhss);
+    }
+}
+
+/*
+ * Starts reception of an ACL packet whose header is at the start of the
+ * ring and takes whatever part of it is already buffered.
+ */
+static void
+ble_hci_sock_rx_acl(struct ble_hci_sock_state *bhss)
+{
+    struct os_mbuf *m;
+    uint32_t pktlen;
+
+    pktlen = BLE_HCI_DATA_HDR_SZ + ble_hci_sock_rx_peek(bhss, 3) +
+             (ble_hci_sock_rx_peek(bhss, 4) << 8);
+
+    STATS_INC(hci_sock_stats, imsg);
+    STATS_INC(hci_sock_stats, iacl);
+
+    bhss->rx_tail++;
+
+    m = ble_hci_trans_acl_buf_alloc();
+    if (!m) {
+        STATS_INC(hci_sock_stats, imem);
+        bhss->rx_skip = pktlen;
+        return;
+    }
+
+    bhss->rx_acl = m;
+    bhss->rx_acl_rem = pktlen;
+    ble_hci_sock_rx_acl_fill(bhss);
+}
+
+/* Parses and dispatches all complete frames in the ring. */
+static void
+ble_hci_sock_rx_parse(struct ble_hci_sock_state *bhss)
+{
+    uint32_t avail;
+    uint32_t len;
+
+    while (bhss->rx_acl == NULL) {
+        avail = bhss->rx_head - bhss->rx_tail;
+
+        if (bhss->rx_skip > 0) {
+            len = min(avail, bhss->rx_skip);
+            bhss->rx_tail += len;
+            bhss->rx_skip -= len;
+            if (bhss->rx_skip > 0) {
+                return;
+            }
+            continue;
+        }
+
+        if (avail == 0) {
+            return;
+        }
+
+        switch (ble_hci_sock_rx_peek(bhss, 0)) {
 #if MYNEWT_VAL(BLE_CONTROLLER)
         case BLE_HCI_UART_H4_CMD:
-            if (bhss->rx_off < sizeof(struct ble_hci_cmd)) {
-                return -1;
+            if (avail < 1 + sizeof(struct ble_hci_cmd)) {
+                return;
             }
-            len = 1 + sizeof(struct ble_hci_cmd) + bhss->rx_data[3];
-            if (bhss->rx_off < len) {
-                return -1;
+            len = 1 + sizeof(struct ble_hci_cmd) +
+                  ble_hci_sock_rx_peek(bhss, 3);
+            if (avail < len) {
+                return;
             }
             STATS_INC(hci_sock_stats, imsg);
             STATS_INC(hci_sock_stats, icmd);
-            data = ble_hci_trans_buf_alloc(BLE_HCI_TRANS_BUF_CMD);
-            if (!data) {
-                STATS_INC(hci_sock_stats, ierr);
-                break;
-            }
-            memcpy(data, &bhss->rx_data[1], len - 1);
-            OS_ENTER_CRITICAL(sr);
-            rc = ble_hci_sock_rx_cmd_cb(data, ble_hci_sock_rx_cmd_arg);
-            OS_EXIT_CRITICAL(sr);
-            if (rc) {
-                ble_hci_trans_buf_free(data);
-                STATS_INC(hci_sock_stats, ierr);
-                break;
-            }
+            ble_hci_sock_rx_cmdevt(bhss, BLE_HCI_TRANS_BUF_CMD, len);
+            bhss->rx_tail += len;
             break;
 #endif
 #if MYNEWT_VAL(BLE_HOST)
         case BLE_HCI_UART_H4_EVT:
-            if (bhss->rx_off < sizeof(struct ble_hci_ev)) {
-                return -1;
+            if (avail < 1 + sizeof(struct ble_hci_ev)) {
+                return;
             }
-            len = 1 + sizeof(struct ble_hci_ev) + bhss->rx_data[2];
-            if (bhss->rx_off < len) {
-                return -1;
+            len = 1 + sizeof(struct ble_hci_ev) +
+                  ble_hci_sock_rx_peek(bhss, 2);
+            if (avail < len) {
+                return;
             }
             STATS_INC(hci_sock_stats, imsg);
             STATS_INC(hci_sock_stats, ievt);
-            data = ble_hci_trans_buf_alloc(BLE_HCI_TRANS_BUF_EVT_HI);
-            if (!data) {
-                STATS_INC(hci_sock_stats, ierr);
-                break;
-            }
-            memcpy(data, &bhss->rx_data[1], len - 1);
-            OS_ENTER_CRITICAL(sr);
-            rc = ble_hci_sock_rx_cmd_cb(data, ble_hci_sock_rx_cmd_arg);
-            OS_EXIT_CRITICAL(sr);
-            if (rc) {
-                ble_hci_trans_buf_free(data);
-                STATS_INC(hci_sock_stats, ierr);
-                return 0;
-            }
+            ble_hci_sock_rx_cmdevt(bhss, BLE_HCI_TRANS_BUF_EVT_HI, len);
+            bhss->rx_tail += len;
             break;
 #endif
         case BLE_HCI_UART_H4_ACL:
-            if (bhss->rx_off < BLE_HCI_DATA_HDR_SZ) {
-                return -1;
+            if (avail < 1 + BLE_HCI_DATA_HDR_SZ) {
+                return;
             }
-            len = 1 + BLE_HCI_DATA_HDR_SZ + (bhss->rx_data[4] << 8) +
-              bhss->rx_data[3];
-            if (bhss->rx_off < len) {
-                return -1;
-            }
-            STATS_INC(hci_sock_stats, imsg);
-            STATS_INC(hci_sock_stats, iacl);
-            m = ble_hci_trans_acl_buf_alloc();
-            if (!m) {
-                STATS_INC(hci_sock_stats, imem);
-                break;
-            }
-            if (os_mbuf_append(m, &bhss->rx_data[1], len - 1)) {
-                STATS_INC(hci_sock_stats, imem);
-                os_mbuf_free_chain(m);
-                break;
-            }
-            OS_ENTER_CRITICAL(sr);
-            ble_hci_sock_rx_acl_cb(m, ble_hci_sock_rx_acl_arg);
-            OS_EXIT_CRITICAL(sr);
+            ble_hci_sock_rx_acl(bhss);
             break;
         default:
+            /* Out of sync; drop bytes until a known indicator shows up. */
             STATS_INC(hci_sock_stats, ierr);
+            bhss->rx_tail++;
             break;
         }
-        memmove(bhss->rx_data, &bhss->rx_data[len], bhss->rx_off - len);
-        bhss->rx_off -= len;
     }
+}
+
+static int
+ble_hci_sock_rx_msg(int sock)
+{
+    struct ble_hci_sock_state *bhss;
+    struct iovec iov[3];
+    struct os_mbuf *m;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t n;
+    int iovcnt;
+    int len;
+
+    bhss = &ble_hci_sock_state;
+    if (sock < 0) {
+        return -1;
+    }
+
+    /*
+     * Read the rest of a pending ACL packet directly into the trailing space
+     * of its last mbuf and whatever follows it into the free part of the
+     * ring.
+     */
+    iovcnt = 0;
+    m = bhss->rx_acl;
+    if (m != NULL) {
+        while (SLIST_NEXT(m, om_next) != NULL) {
+            m = SLIST_NEXT(m, om_next);
+        }
+        n = min(OS_MBUF_TRAILINGSPACE(m), bhss->rx_acl_rem);
+        if (n > 0) {
+            iov[iovcnt].iov_base = m->om_data + m->om_len;
+            iov[iovcnt].iov_len = n;
+            iovcnt++;
+        } else {
+            m = NULL;
+        }
+    }
+
+    head = bhss->rx_head & BLE_HCI_SOCK_RX_RING_MASK;
+    tail = bhss->rx_tail & BLE_HCI_SOCK_RX_RING_MASK;
+    n = BLE_HCI_SOCK_RX_RING_SZ - (bhss->rx_head - bhss->rx_tail);
+    if (n > 0) {
+        iov[iovcnt].iov_base = &bhss->rx_ring[head];
+        iov[iovcnt].iov_len = min(n, BLE_HCI_SOCK_RX_RING_SZ - head);
+        n -= iov[iovcnt].iov_len;
+        iovcnt++;
+        if (n > 0) {
+            iov[iovcnt].iov_base = bhss->rx_ring;
+            iov[iovcnt].iov_len = tail;
+            iovcnt++;
+        }
+    }
+
+    len = readv(sock, iov, iovcnt);
+    if (len < 0) {
+        return -2;
+    }
+    if (len == 0) {
+        return -1;
+    }
+    STATS_INCN(hci_sock_stats, ibytes, len);
+
+    if (m != NULL) {
+        n = min(len, iov[0].iov_len);
+        m->om_len += n;
+        OS_MBUF_PKTHDR(bhss->rx_acl)->omp_len += n;
+        bhss->rx_acl_rem -= n;
+        len -= n;
+        if (bhss->rx_acl_rem == 0) {
+            ble_hci_sock_rx_acl_done(bhss);
+        }
+    }
+    bhss->rx_head += len;
+
+    /* Bytes of the pending packet that did not fit its last mbuf. */
+    if (bhss->rx_acl != NULL) {
+        ble_hci_sock_rx_acl_fill(bhss);
+    }
+    ble_hci_sock_rx_parse(bhss);
+
     return 0;
 }
 
+#if !MYNEWT_VAL(BLE_SOCK_RX_BLOCKING)
 static void
 ble_hci_sock_rx_ev(struct ble_npl_event *ev)
 {
     int rc;
     ble_npl_time_t timeout;
 
-    rc = ble_hci_sock_rx_msg();
+    rc = ble_hci_sock_rx_msg(__atomic_load_n(&ble_hci_sock_state.sock,
+                                             __ATOMIC_ACQUIRE));
     if (rc == 0) {
         ble_npl_eventq_put(&ble_hci_sock_state.evq, &ble_hci_sock_state.ev);
     } else {
@@ -448,13 +689,90 @@ ble_hci_sock_rx_ev(struct ble_npl_event *ev)
     }
 }
 
+static int
+ble_hci_sock_rx_start(void)
+{
+    ble_npl_time_t timeout;
+    int rc;
+
+    rc = ble_npl_time_ms_to_ticks(10, &timeout);
+    if (rc) {
+        return rc;
+    }
+    ble_npl_callout_reset(&ble_hci_sock_state.timer, timeout);
+
+    return 0;
+}
+#else
+static int
+ble_hci_sock_rx_start(void)
+{
+    uint64_t val;
+
+    /* Make the reader thread pick up the (new) socket. */
+    val = 1;
+    if (write(ble_hci_sock_state.wake_fd, &val, sizeof val) != sizeof val) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Reader loop for the blocking receive mode.  Sleeps until the socket is
+ * readable, so received packets are processed without polling delay.  The
+ * socket is picked up from the host each time it signals wake_fd.
+ */
+static void
+ble_hci_sock_rx_loop(void)
+{
+    struct ble_hci_sock_state *bhss = &ble_hci_sock_state;
+    struct pollfd fds[2];
+    uint64_t val;
+    int sock;
+    int nfds;
+    int rc;
+
+    sock = -1;
+
+    while (1) {
+        fds[0].fd = bhss->wake_fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = sock;
+        fds[1].events = POLLIN;
+        nfds = sock >= 0 ? 2 : 1;
+
+        rc = poll(fds, nfds, -1);
+        if (rc < 0) {
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            /* Socket was (re)configured; drop any partial packet. */
+            if (read(bhss->wake_fd, &val, sizeof val) == sizeof val) {
+                ble_hci_sock_rx_reset();
+                sock = __atomic_load_n(&bhss->sock, __ATOMIC_ACQUIRE);
+            }
+            continue;
+        }
+
+        if (nfds > 1 && fds[1].revents) {
+            if (ble_hci_sock_rx_msg(sock) != 0) {
+                /* Peer closed or error; wait for the host to reset us. */
+                sock = -1;
+                __atomic_store_n(&bhss->rx_closed, 1, __ATOMIC_RELEASE);
+            }
+        }
+    }
+}
+#endif
+
 #if MYNEWT_VAL(BLE_SOCK_USE_TCP)
 static int
 ble_hci_sock_config(void)
 {
     struct ble_hci_sock_state *bhss = &ble_hci_sock_state;
     struct sockaddr_in sin;
-    ble_npl_time_t timeout;
     int s;
     int rc;
 
@@ -466,12 +784,16 @@ ble_hci_sock_config(void)
     sin.sin_len = sizeof(sin);
 #endif
 
-#if 0
-    if (bhss->sock >= 0) {
+#if MYNEWT_VAL(BLE_SOCK_RX_BLOCKING)
+    /* The reader stopped using a socket the peer closed; reconnect. */
+    if (__atomic_exchange_n(&bhss->rx_closed, 0, __ATOMIC_ACQ_REL) &&
+        bhss->sock >= 0) {
+
         close(bhss->sock);
-        bhss->sock = -1;
+        __atomic_store_n(&bhss->sock, -1, __ATOMIC_RELEASE);
     }
 #endif
+    s = -1;
     if (bhss->sock < 0) {
         s = socket(PF_INET, SOCK_STREAM, 0);
         if (s < 0) {
@@ -490,13 +812,13 @@ ble_hci_sock_config(void)
         if (rc) {
             goto err;
         }
-        bhss->sock = s;
+        __atomic_store_n(&bhss->sock, s, __ATOMIC_RELEASE);
+        s = -1;
     }
-    rc = ble_npl_time_ms_to_ticks(10, &timeout);
+    rc = ble_hci_sock_rx_start();
     if (rc) {
         goto err;
     }
-    ble_npl_callout_reset(&ble_hci_sock_state.timer, timeout);
 
     return 0;
 err:
@@ -514,7 +836,6 @@ ble_hci_sock_config(void)
     struct sockaddr_hci shci;
     int s;
     int rc;
-    ble_npl_time_t timeout;
 
     memset(&shci, 0, sizeof(shci));
     shci.hci_family = AF_BLUETOOTH;
@@ -523,8 +844,11 @@ ble_hci_sock_config(void)
 
     if (ble_hci_sock_state.sock >= 0) {
         close(ble_hci_sock_state.sock);
-        ble_hci_sock_state.sock = -1;
+        __atomic_store_n(&ble_hci_sock_state.sock, -1, __ATOMIC_RELEASE);
     }
+#if MYNEWT_VAL(BLE_SOCK_RX_BLOCKING)
+    __atomic_store_n(&ble_hci_sock_state.rx_closed, 0, __ATOMIC_RELEASE);
+#endif
 
     s = socket(PF_BLUETOOTH, SOCK_RAW, BTPROTO_HCI);
     if (s < 0) {
@@ -550,13 +874,12 @@ ble_hci_sock_config(void)
     if (rc) {
         goto err;
     }
-    ble_hci_sock_state.sock = s;
+    __atomic_store_n(&ble_hci_sock_state.sock, s, __ATOMIC_RELEASE);
 
-    rc = ble_npl_time_ms_to_ticks(10, &timeout);
+    rc = ble_hci_sock_rx_start();
     if (rc) {
         goto err;
     }
-    ble_npl_callout_reset(&ble_hci_sock_state.timer, timeout);
 
     return 0;
 err:
@@ -759,7 +1082,10 @@ ble_hci_trans_reset(void)
 {
     int rc;
 
+#if !MYNEWT_VAL(BLE_SOCK_RX_BLOCKING)
     ble_npl_callout_stop(&ble_hci_sock_state.timer);
+    ble_hci_sock_rx_reset();
+#endif
 
     /* Reopen the UART. */
     rc = ble_hci_sock_config();
@@ -774,21 +1100,30 @@ ble_hci_trans_reset(void)
 void
 ble_hci_sock_ack_handler(void *arg)
 {
+#if MYNEWT_VAL(BLE_SOCK_RX_BLOCKING)
+    ble_hci_sock_rx_loop();
+#else
     struct ble_npl_event *ev;
 
     while (1) {
         ev = ble_npl_eventq_get(&ble_hci_sock_state.evq, BLE_NPL_TIME_FOREVER);
         ble_npl_event_run(ev);
     }
+#endif
 }
 
 static void
 ble_hci_sock_init_task(void)
 {
+#if MYNEWT_VAL(BLE_SOCK_RX_BLOCKING)
+    ble_hci_sock_state.wake_fd = eventfd(0, EFD_CLOEXEC);
+    SYSINIT_PANIC_ASSERT(ble_hci_sock_state.wake_fd >= 0);
+#else
     ble_npl_eventq_init(&ble_hci_sock_state.evq);
     ble_npl_callout_stop(&ble_hci_sock_state.timer);
     ble_npl_callout_init(&ble_hci_sock_state.timer, &ble_hci_sock_state.evq,
                     ble_hci_sock_rx_ev, NULL);
+#endif
 
 #if MYNEWT
     {
@@ -834,7 +1169,9 @@ ble_hci_sock_init(void)
     ble_hci_sock_state.sock = -1;
 
     ble_hci_sock_init_task();
+#if !MYNEWT_VAL(BLE_SOCK_RX_BLOCKING)
     ble_npl_event_init(&ble_hci_sock_state.ev, ble_hci_sock_rx_ev, NULL);
+#endif
 
     rc = os_mempool_init(&ble_hci_sock_acl_pool,
                          MYNEWT_VAL(BLE_ACL_BUF_COUNT),
@@ -444,6 +444,10 @@
 #define MYNEWT_VAL_BLE_ATT_SVR_NOTIFY (1)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_ATT_SVR_NOTIFY_MULTI
+#define MYNEWT_VAL_BLE_ATT_SVR_NOTIFY_MULTI (1)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_ATT_SVR_QUEUED_WRITE
 #define MYNEWT_VAL_BLE_ATT_SVR_QUEUED_WRITE (1)
 #endif
@@ -468,6 +472,10 @@
 #define MYNEWT_VAL_BLE_ATT_SVR_READ_MULT (1)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_ATT_SVR_READ_MULT_VAR
+#define MYNEWT_VAL_BLE_ATT_SVR_READ_MULT_VAR (1)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_ATT_SVR_READ_TYPE
 #define MYNEWT_VAL_BLE_ATT_SVR_READ_TYPE (1)
 #endif
@@ -524,6 +532,34 @@
 #define MYNEWT_VAL_BLE_GATT_NOTIFY (1)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_GATT_NOTIFY_MULTI
+#define MYNEWT_VAL_BLE_GATT_NOTIFY_MULTI (1)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_GATT_NOTIFY_MULTI_MAX_ATTRS
+#define MYNEWT_VAL_BLE_GATT_NOTIFY_MULTI_MAX_ATTRS (16)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_GATT_ROBUST_CACHING
+#define MYNEWT_VAL_BLE_GATT_ROBUST_CACHING (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_GATT_CACHING
+#define MYNEWT_VAL_BLE_GATT_CACHING (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_GATT_DISC_DB
+#define MYNEWT_VAL_BLE_GATT_DISC_DB (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_GATT_DISC_DB_MAX_SVCS
+#define MYNEWT_VAL_BLE_GATT_DISC_DB_MAX_SVCS (8)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_GATT_DISC_DB_MAX_CHRS
+#define MYNEWT_VAL_BLE_GATT_DISC_DB_MAX_CHRS (32)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_GATT_READ
 #define MYNEWT_VAL_BLE_GATT_READ (MYNEWT_VAL_BLE_ROLE_CENTRAL)
 #endif
@@ -540,6 +576,10 @@
 #define MYNEWT_VAL_BLE_GATT_READ_MULT (MYNEWT_VAL_BLE_ROLE_CENTRAL)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_GATT_READ_MULT_VAR
+#define MYNEWT_VAL_BLE_GATT_READ_MULT_VAR (MYNEWT_VAL_BLE_ROLE_CENTRAL)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_GATT_READ_UUID
 #define MYNEWT_VAL_BLE_GATT_READ_UUID (MYNEWT_VAL_BLE_ROLE_CENTRAL)
 #endif
@@ -600,6 +640,18 @@
 #define MYNEWT_VAL_BLE_HS_FLOW_CTRL_TX_ON_DISCONNECT (0)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_HS_HCI_CMD_MAX_INFLIGHT
+#define MYNEWT_VAL_BLE_HS_HCI_CMD_MAX_INFLIGHT (4)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_HS_STARTUP_CACHE
+#define MYNEWT_VAL_BLE_HS_STARTUP_CACHE (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_HS_TX_SCHED_WEIGHTED
+#define MYNEWT_VAL_BLE_HS_TX_SCHED_WEIGHTED (0)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_HS_LOG_LVL
 #define MYNEWT_VAL_BLE_HS_LOG_LVL (1)
 #endif
@@ -640,6 +692,14 @@
 #define MYNEWT_VAL_BLE_L2CAP_ENHANCED_COC (0)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_EATT_CHAN_NUM
+#define MYNEWT_VAL_BLE_EATT_CHAN_NUM (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_EATT_MTU
+#define MYNEWT_VAL_BLE_EATT_MTU (128)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_L2CAP_JOIN_RX_FRAGS
 #define MYNEWT_VAL_BLE_L2CAP_JOIN_RX_FRAGS (1)
 #endif
@@ -754,6 +814,10 @@
 #define MYNEWT_VAL_BLE_STORE_MAX_CCCDS (8)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_STORE_MAX_PEER_ATTRS
+#define MYNEWT_VAL_BLE_STORE_MAX_PEER_ATTRS (0)
+#endif
+
 /*** @apache-mynewt-nimble/nimble/host/mesh */
 #ifndef MYNEWT_VAL_BLE_MESH_ACCESS_LOG_LVL
 #define MYNEWT_VAL_BLE_MESH_ACCESS_LOG_LVL (1)
@@ -1331,6 +1395,11 @@
 #define MYNEWT_VAL_BLE_SOCK_LINUX_DEV (0)
 #endif
 
+/* Overridden by @apache-mynewt-nimble/porting/targets/linux_blemesh (defined by @apache-mynewt-nimble/nimble/transport/socket) */
+#ifndef MYNEWT_VAL_BLE_SOCK_RX_BLOCKING
+#define MYNEWT_VAL_BLE_SOCK_RX_BLOCKING (1)
+#endif
+
 /* Overridden by @apache-mynewt-nimble/porting/targets/linux_blemesh (defined by @apache-mynewt-nimble/nimble/transport/socket) */
 #ifndef MYNEWT_VAL_BLE_SOCK_STACK_SIZE
 #define MYNEWT_VAL_BLE_SOCK_STACK_SIZE (1028)
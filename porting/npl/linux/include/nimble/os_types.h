@@ -41,6 +41,7 @@ struct ble_npl_event {
     uint8_t                 ev_queued;
     ble_npl_event_fn       *ev_cb;
     void                   *ev_arg;
+    struct ble_npl_event   *ev_next;
 };
 
 struct ble_npl_eventq {
@@ -51,7 +52,9 @@ struct ble_npl_callout {
     struct ble_npl_event    c_ev;
     struct ble_npl_eventq  *c_evq;
     uint32_t                c_ticks;
-    timer_t                 c_timer;
+    struct ble_npl_callout *c_next;
+    struct ble_npl_callout *c_prev;
+    uint16_t                c_slot;
     bool                    c_active;
 };
 
@@ -18,34 +18,246 @@
  */
 
 #include <assert.h>
+#include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <time.h>
-#include <signal.h>
+#include <sys/timerfd.h>
 
 #include "nimble/nimble_npl.h"
 
+/*
+ * All callouts are kept in a hashed timing wheel with one slot per tick
+ * (millisecond).  A callout expiring at tick T lives in slot T % SLOTS; the
+ * slot is recorded in the callout, so arming and stopping a callout are O(1)
+ * list operations.  A bitmap of non-empty slots lets the next due slot be
+ * found without walking the wheel.  A single thread sleeps on a timerfd until
+ * the next non-empty slot comes due, then posts the events of all expired
+ * callouts to their event queues.
+ */
+#define CALLOUT_WHEEL_SLOTS     256
+#define CALLOUT_WHEEL_MASK      (CALLOUT_WHEEL_SLOTS - 1)
+#define CALLOUT_MAP_WORDS       (CALLOUT_WHEEL_SLOTS / 64)
+
+static struct ble_npl_callout *callout_wheel[CALLOUT_WHEEL_SLOTS];
+static uint64_t callout_map[CALLOUT_MAP_WORDS];
+static pthread_mutex_t callout_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t callout_once = PTHREAD_ONCE_INIT;
+static int callout_tfd = -1;
+static int callout_num_active;
+
+/* Last tick processed by the timer thread. */
+static ble_npl_time_t callout_cur;
+
+/* Tick the timerfd is armed for, if callout_wake_armed. */
+static ble_npl_time_t callout_wake;
+static bool callout_wake_armed;
+
+static int
+callout_tick_before(ble_npl_time_t a, ble_npl_time_t b)
+{
+    return (ble_npl_stime_t)(a - b) < 0;
+}
+
 static void
-ble_npl_callout_timer_cb(union sigval sv)
+callout_link(struct ble_npl_callout *c)
 {
-    struct ble_npl_callout *c = (struct ble_npl_callout *)sv.sival_ptr;
-    assert(c);
+    struct ble_npl_callout **head;
 
-    if (c->c_evq) {
-        ble_npl_eventq_put(c->c_evq, &c->c_ev);
+    c->c_slot = c->c_ticks & CALLOUT_WHEEL_MASK;
+    head = &callout_wheel[c->c_slot];
+    callout_map[c->c_slot / 64] |= 1ULL << (c->c_slot % 64);
+
+    c->c_prev = NULL;
+    c->c_next = *head;
+    if (*head != NULL) {
+        (*head)->c_prev = c;
+    }
+    *head = c;
+
+    c->c_active = true;
+    callout_num_active++;
+}
+
+static void
+callout_unlink(struct ble_npl_callout *c)
+{
+    if (c->c_prev != NULL) {
+        c->c_prev->c_next = c->c_next;
     } else {
-        c->c_ev.ev_cb(&c->c_ev);
+        callout_wheel[c->c_slot] = c->c_next;
+        if (c->c_next == NULL) {
+            callout_map[c->c_slot / 64] &= ~(1ULL << (c->c_slot % 64));
+        }
+    }
+    if (c->c_next != NULL) {
+        c->c_next->c_prev = c->c_prev;
+    }
+    c->c_next = NULL;
+    c->c_prev = NULL;
+
+    c->c_active = false;
+    callout_num_active--;
+}
+
+/* Arms the timerfd to fire at the specified tick; 0 disarms it. */
+static void
+callout_arm(ble_npl_time_t now, ble_npl_time_t wake)
+{
+    struct itimerspec its;
+    ble_npl_time_t delay;
+
+    memset(&its, 0, sizeof its);
+
+    callout_wake_armed = wake != 0;
+    if (callout_wake_armed) {
+        callout_wake = wake;
+
+        delay = callout_tick_before(now, wake) ? wake - now : 1;
+        its.it_value.tv_sec = delay / 1000;
+        its.it_value.tv_nsec = (delay % 1000) * 1000000;
+    }
+
+    timerfd_settime(callout_tfd, 0, &its, NULL);
+}
+
+/* Returns the first non-empty slot at or after the specified one. */
+static int
+callout_next_slot(int slot)
+{
+    uint64_t bits;
+    int word;
+    int i;
+
+    word = slot / 64;
+    bits = callout_map[word] & (~0ULL << (slot % 64));
+
+    /* Visit the starting word twice; the second time for the slots before
+     * the starting one.
+     */
+    for (i = 0; i <= CALLOUT_MAP_WORDS; i++) {
+        if (bits != 0) {
+            return word * 64 + __builtin_ctzll(bits);
+        }
+
+        word = (word + 1) % CALLOUT_MAP_WORDS;
+        bits = callout_map[word];
+    }
+
+    return -1;
+}
+
+/* Arms the timerfd for the next non-empty wheel slot. */
+static void
+callout_rearm(ble_npl_time_t now)
+{
+    int slot;
+
+    if (callout_num_active == 0) {
+        callout_arm(now, 0);
+        return;
+    }
+
+    slot = callout_next_slot((now + 1) & CALLOUT_WHEEL_MASK);
+    assert(slot >= 0);
+
+    callout_arm(now, now + 1 + ((slot - (now + 1)) & CALLOUT_WHEEL_MASK));
+}
+
+/* Returns an expired callout from the specified slot, unlinked. */
+static struct ble_npl_callout *
+callout_slot_expired(int slot, ble_npl_time_t now)
+{
+    struct ble_npl_callout *c;
+
+    for (c = callout_wheel[slot]; c != NULL; c = c->c_next) {
+        if (!callout_tick_before(now, c->c_ticks)) {
+            callout_unlink(c);
+            return c;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+callout_expire(ble_npl_time_t now)
+{
+    struct ble_npl_callout *c;
+    ble_npl_time_t span;
+    ble_npl_time_t i;
+    int slot;
+
+    span = now - callout_cur;
+    if (span > CALLOUT_WHEEL_SLOTS) {
+        span = CALLOUT_WHEEL_SLOTS;
+    }
+
+    for (i = 1; i <= span; i++) {
+        slot = (callout_cur + i) & CALLOUT_WHEEL_MASK;
+
+        while ((c = callout_slot_expired(slot, now)) != NULL) {
+            if (c->c_evq) {
+                ble_npl_eventq_put(c->c_evq, &c->c_ev);
+            } else {
+                /* The callback may rearm the callout. */
+                pthread_mutex_unlock(&callout_lock);
+                c->c_ev.ev_cb(&c->c_ev);
+                pthread_mutex_lock(&callout_lock);
+            }
+        }
     }
+
+    callout_cur = now;
+}
+
+static void *
+callout_thread(void *arg)
+{
+    uint64_t expirations;
+    ssize_t rc;
+
+    for (;;) {
+        rc = read(callout_tfd, &expirations, sizeof expirations);
+        if (rc < 0 && errno != EINTR && errno != EAGAIN) {
+            break;
+        }
+
+        pthread_mutex_lock(&callout_lock);
+        callout_expire(ble_npl_time_get());
+        callout_rearm(callout_cur);
+        pthread_mutex_unlock(&callout_lock);
+    }
+
+    return NULL;
+}
+
+static void
+callout_start(void)
+{
+    pthread_t thread;
+    int rc;
+
+    callout_tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    assert(callout_tfd >= 0);
+
+    callout_cur = ble_npl_time_get();
+
+    rc = pthread_create(&thread, NULL, callout_thread, NULL);
+    assert(rc == 0);
+    pthread_detach(thread);
 }
 
-void ble_npl_callout_init(struct ble_npl_callout *c, 
+void ble_npl_callout_init(struct ble_npl_callout *c,
                           struct ble_npl_eventq *evq,
-                          ble_npl_event_fn *ev_cb, 
+                          ble_npl_event_fn *ev_cb,
                           void *ev_arg)
 {
-    struct sigevent         event;
+    pthread_once(&callout_once, callout_start);
 
     /* Initialize the callout. */
     memset(c, 0, sizeof(*c));
@@ -53,33 +265,24 @@ void ble_npl_callout_init(struct ble_npl_callout *c,
     c->c_ev.ev_arg = ev_arg;
     c->c_evq = evq;
     c->c_active = false;
-
-    event.sigev_notify = SIGEV_THREAD;
-    event.sigev_value.sival_ptr = c;     // put callout obj in signal args
-    event.sigev_notify_function = ble_npl_callout_timer_cb;
-    event.sigev_notify_attributes = NULL;
-
-    timer_create(CLOCK_REALTIME, &event, &c->c_timer);
 }
 
 bool ble_npl_callout_is_active(struct ble_npl_callout *c)
 {
-    // TODO: seek native posix method to determine whether timer_t is active.
-    // TODO: fix bug where one-shot timer is still active after fired.
     return c->c_active;
 }
 
 int ble_npl_callout_inited(struct ble_npl_callout *c)
 {
-    return (c->c_timer != NULL);
+    return (c->c_ev.ev_cb != NULL);
 }
 
 ble_npl_error_t ble_npl_callout_reset(struct ble_npl_callout *c,
 				      ble_npl_time_t ticks)
 {
-    struct itimerspec       its;
+    ble_npl_time_t now;
 
-    if (ticks < 0) {
+    if ((ble_npl_stime_t)ticks < 0) {
         return BLE_NPL_EINVAL;
     }
 
@@ -87,26 +290,34 @@ ble_npl_error_t ble_npl_callout_reset(struct ble_npl_callout *c,
         ticks = 1;
     }
 
-    c->c_ticks = ble_npl_time_get() + ticks;
+    pthread_mutex_lock(&callout_lock);
 
-    its.it_interval.tv_sec = 0;
-    its.it_interval.tv_nsec = 0;                     // one shot
-    its.it_value.tv_sec = (ticks / 1000);
-    its.it_value.tv_nsec = (ticks % 1000) * 1000000; // expiration
-    its.it_value.tv_nsec %= 1000000000;
-    c->c_active = true;
-    timer_settime(c->c_timer, 0, &its, NULL);
+    if (c->c_active) {
+        callout_unlink(c);
+    }
+
+    /* An event posted by the previous expiry must not be delivered. */
+    if (c->c_evq) {
+        ble_npl_eventq_remove(c->c_evq, &c->c_ev);
+    }
+
+    now = ble_npl_time_get();
+    c->c_ticks = now + ticks;
+    callout_link(c);
+
+    if (!callout_wake_armed ||
+        callout_tick_before(c->c_ticks, callout_wake)) {
+        callout_arm(now, c->c_ticks);
+    }
+
+    pthread_mutex_unlock(&callout_lock);
 
     return BLE_NPL_OK;
 }
 
 int ble_npl_callout_queued(struct ble_npl_callout *c)
 {
-    struct itimerspec its;
-    timer_gettime(c->c_timer, &its);
-
-    return ((its.it_value.tv_sec > 0) ||
-            (its.it_value.tv_nsec > 0));
+    return c->c_active;
 }
 
 void ble_npl_callout_stop(struct ble_npl_callout *c)
@@ -115,13 +326,17 @@ void ble_npl_callout_stop(struct ble_npl_callout *c)
         return;
     }
 
-    struct itimerspec its;
-    its.it_interval.tv_sec = 0;
-    its.it_interval.tv_nsec = 0;
-    its.it_value.tv_sec = 0;
-    its.it_value.tv_nsec = 0;
-    timer_settime(c->c_timer, 0, &its, NULL);
-    c->c_active = false;
+    /* The timer thread posts events with the lock held, so once the lock is
+     * taken the event is either still on the wheel or already queued.
+     */
+    pthread_mutex_lock(&callout_lock);
+    if (c->c_active) {
+        callout_unlink(c);
+    }
+    if (c->c_evq) {
+        ble_npl_eventq_remove(c->c_evq, &c->c_ev);
+    }
+    pthread_mutex_unlock(&callout_lock);
 }
 
 ble_npl_time_t
@@ -141,18 +356,16 @@ ble_npl_callout_remaining_ticks(struct ble_npl_callout *co,
                                 ble_npl_time_t now)
 {
     ble_npl_time_t rt;
-    uint32_t exp;
 
-    struct itimerspec its;
-    timer_gettime(co->c_timer, &its);
-
-    exp = its.it_value.tv_sec * 1000;
+    pthread_mutex_lock(&callout_lock);
 
-    if (exp > now) {
-        rt = exp - now;
+    if (co->c_active && callout_tick_before(now, co->c_ticks)) {
+        rt = co->c_ticks - now;
     } else {
         rt = 0;
     }
 
+    pthread_mutex_unlock(&callout_lock);
+
     return rt;
 }
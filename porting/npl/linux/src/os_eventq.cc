@@ -26,7 +26,7 @@
 
 extern "C" {
 
-typedef wqueue<ble_npl_event *> wqueue_t;
+typedef wqueue wqueue_t;
 
 static struct ble_npl_eventq dflt_evq;
 
@@ -51,11 +51,7 @@ ble_npl_eventq_is_empty(struct ble_npl_eventq *evq)
 {
     wqueue_t *q = static_cast<wqueue_t *>(evq->q);
 
-    if (q->size()) {
-        return 1;
-    } else {
-        return 0;
-    }
+    return q->is_empty();
 }
 
 int
@@ -69,27 +65,15 @@ ble_npl_eventq_put(struct ble_npl_eventq *evq, struct ble_npl_event *ev)
 {
     wqueue_t *q = static_cast<wqueue_t *>(evq->q);
 
-    if (ev->ev_queued) {
-        return;
-    }
-
-    ev->ev_queued = 1;
     q->put(ev);
 }
 
 struct ble_npl_event *ble_npl_eventq_get(struct ble_npl_eventq *evq,
                                          ble_npl_time_t tmo)
 {
-    struct ble_npl_event *ev;
     wqueue_t *q = static_cast<wqueue_t *>(evq->q);
 
-    ev = q->get(tmo);
-
-    if (ev) {
-        ev->ev_queued = 0;
-    }
-
-    return ev;
+    return q->get(tmo);
 }
 
 void
@@ -118,7 +102,8 @@ ble_npl_event_init(struct ble_npl_event *ev, ble_npl_event_fn *fn,
 bool
 ble_npl_event_is_queued(struct ble_npl_event *ev)
 {
-    return ev->ev_queued;
+    return __atomic_load_n(&ev->ev_queued, __ATOMIC_ACQUIRE) !=
+           WQUEUE_EV_IDLE;
 }
 
 void *
@@ -146,11 +131,6 @@ ble_npl_eventq_remove(struct ble_npl_eventq *evq, struct ble_npl_event *ev)
 {
     wqueue_t *q = static_cast<wqueue_t *>(evq->q);
 
-    if (!ev->ev_queued) {
-        return;
-    }
-
-    ev->ev_queued = 0;
     q->remove(ev);
 }
 
@@ -1,90 +1,289 @@
 /*
-   wqueue.h
-   Worker thread queue based on the Standard C++ library list
-   template class.
-   ------------------------------------------
-   Copyright (c) 2013 Vic Hargrave
-   Licensed under the Apache License, Version 2.0 (the "License");
-   you may not use this file except in compliance with the License.
-   You may obtain a copy of the License at
-       http://www.apache.org/licenses/LICENSE-2.0
-   Unless required by applicable law or agreed to in writing, software
-   distributed under the License is distributed on an "AS IS" BASIS,
-   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-   See the License for the specific language governing permissions and
-   limitations under the License.
-*/
-
-// https://vichargrave.github.io/articles/2013-01/multithreaded-work-queue-in-cpp
-// https://github.com/vichargrave/wqueue/blob/master/wqueue.h
-
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
 
 #ifndef __wqueue_h__
 #define __wqueue_h__
 
+#include <errno.h>
 #include <pthread.h>
-#include <list>
+#include <sched.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "nimble/nimble_npl.h"
 
-using namespace std;
+/* Values of ble_npl_event::ev_queued. */
+#define WQUEUE_EV_IDLE      0   /* Not linked into a queue. */
+#define WQUEUE_EV_QUEUED    1   /* Linked and pending delivery. */
+#define WQUEUE_EV_LINKING   2   /* Being linked by a producer. */
 
-template <typename T> class wqueue
+/**
+ * Intrusive multiple-producer, single-consumer event queue.
+ *
+ * Producers push events onto a lock-free LIFO stack without taking a lock or
+ * allocating memory.  The consumer detaches the whole stack at once and
+ * reverses it into a FIFO list.
+ *
+ * Unlinking is done under the mutex: the consumer holds it while it moves
+ * and pops events, and remove() holds it while it unlinks an event from
+ * either list.  Producers only take the mutex to wake a sleeping consumer.
+ * Once remove() returns, the event is no longer referenced by the queue and
+ * may be freed or reinitialized.
+ *
+ * Event state only moves IDLE -> LINKING (put), LINKING -> QUEUED (the same
+ * put, once the event is on the stack) and QUEUED -> IDLE (pop or remove).
+ * Only the producer that won IDLE -> LINKING may leave LINKING, so pop() and
+ * remove() wait for it to finish instead of marking the event idle under
+ * it.  Otherwise a second put() could link the event again while the first
+ * one still considers it its own.
+ */
+class wqueue
 {
-    list<T>              m_queue;
-    pthread_mutex_t      m_mutex;
-    pthread_mutexattr_t  m_mutex_attr;
-    pthread_cond_t       m_condv;
+    struct ble_npl_event *m_stack;  /* Shared; newest event first. */
+    struct ble_npl_event *m_head;   /* Under m_mutex; oldest event first. */
+    int                   m_sleeping;
+    pthread_mutex_t       m_mutex;
+    pthread_cond_t        m_condv;
 
-public:
-    wqueue()
-    {
-        pthread_mutexattr_init(&m_mutex_attr);
-        pthread_mutexattr_settype(&m_mutex_attr, PTHREAD_MUTEX_RECURSIVE);
-        pthread_mutex_init(&m_mutex, &m_mutex_attr);
-        pthread_cond_init(&m_condv, NULL);
+    /* Called with m_mutex held. */
+    bool refill() {
+        struct ble_npl_event *ev;
+        struct ble_npl_event *next;
+
+        ev = __atomic_exchange_n(&m_stack, (struct ble_npl_event *)NULL,
+                                 __ATOMIC_ACQUIRE);
+        if (ev == NULL) {
+            return false;
+        }
+
+        /* Reverse the detached stack to restore insertion order. */
+        m_head = NULL;
+        while (ev != NULL) {
+            next = ev->ev_next;
+            ev->ev_next = m_head;
+            m_head = ev;
+            ev = next;
+        }
+
+        return true;
     }
 
-    ~wqueue() {
-        pthread_mutex_destroy(&m_mutex);
-        pthread_cond_destroy(&m_condv);
+    /* Waits for the producer which is pushing ev to mark it queued.  That
+     * producer needs no lock to finish.
+     */
+    static void wait_linked(struct ble_npl_event *ev) {
+        while (__atomic_load_n(&ev->ev_queued, __ATOMIC_ACQUIRE) ==
+               WQUEUE_EV_LINKING) {
+            sched_yield();
+        }
     }
 
-    void put(T item) {
+    struct ble_npl_event *pop() {
+        struct ble_npl_event *ev;
+
         pthread_mutex_lock(&m_mutex);
-        m_queue.push_back(item);
-        pthread_cond_signal(&m_condv);
+
+        if (m_head == NULL) {
+            refill();
+        }
+
+        ev = m_head;
+        if (ev != NULL) {
+            m_head = ev->ev_next;
+            ev->ev_next = NULL;
+            wait_linked(ev);
+            __atomic_store_n(&ev->ev_queued, WQUEUE_EV_IDLE, __ATOMIC_RELEASE);
+        }
+
         pthread_mutex_unlock(&m_mutex);
+
+        return ev;
     }
 
-    T get(uint32_t tmo) {
-        pthread_mutex_lock(&m_mutex);
-        if (tmo) {
-            while (m_queue.size() == 0) {
-                pthread_cond_wait(&m_condv, &m_mutex);
+    /* Called with m_mutex held.  Returns false if ev is not in the stack. */
+    bool unlink_stack(struct ble_npl_event *ev) {
+        struct ble_npl_event *prev;
+        struct ble_npl_event *top;
+
+        top = __atomic_load_n(&m_stack, __ATOMIC_ACQUIRE);
+        for (;;) {
+            if (top == ev) {
+                if (__atomic_compare_exchange_n(&m_stack, &top, ev->ev_next,
+                                                false, __ATOMIC_ACQ_REL,
+                                                __ATOMIC_ACQUIRE)) {
+                    return true;
+                }
+
+                /* Another event was pushed on top; ev is now below it. */
+                continue;
+            }
+
+            /* Producers only ever replace the top, so the links below it are
+             * stable while the mutex is held.
+             */
+            for (prev = top; prev != NULL; prev = prev->ev_next) {
+                if (prev->ev_next == ev) {
+                    prev->ev_next = ev->ev_next;
+                    return true;
+                }
             }
+
+            return false;
         }
+    }
 
-        T item = NULL;
+    /* Called with m_mutex held.  Returns false if ev is not in the list. */
+    bool unlink_head(struct ble_npl_event *ev) {
+        struct ble_npl_event **prev;
 
-        if (m_queue.size() != 0) {
-            item = m_queue.front();
-            m_queue.pop_front();
+        for (prev = &m_head; *prev != NULL; prev = &(*prev)->ev_next) {
+            if (*prev == ev) {
+                *prev = ev->ev_next;
+                return true;
+            }
         }
 
-        pthread_mutex_unlock(&m_mutex);
-        return item;
+        return false;
     }
 
-    void remove(T item) {
+    /* Returns false if the deadline passed without any event being put. */
+    bool wait(const struct timespec *deadline) {
+        bool timed_out;
+
+        timed_out = false;
+
         pthread_mutex_lock(&m_mutex);
-        m_queue.remove(item);
+        __atomic_store_n(&m_sleeping, 1, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n(&m_stack, __ATOMIC_SEQ_CST) == NULL) {
+            if (deadline == NULL) {
+                pthread_cond_wait(&m_condv, &m_mutex);
+            } else if (pthread_cond_timedwait(&m_condv, &m_mutex,
+                                              deadline) == ETIMEDOUT) {
+                timed_out = true;
+                break;
+            }
+        }
+        __atomic_store_n(&m_sleeping, 0, __ATOMIC_SEQ_CST);
         pthread_mutex_unlock(&m_mutex);
+
+        return !timed_out;
     }
 
-    int size() {
+public:
+    wqueue() : m_stack(NULL), m_head(NULL), m_sleeping(0)
+    {
+        pthread_condattr_t attr;
+
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_mutex_init(&m_mutex, NULL);
+        pthread_cond_init(&m_condv, &attr);
+        pthread_condattr_destroy(&attr);
+    }
+
+    ~wqueue() {
+        pthread_mutex_destroy(&m_mutex);
+        pthread_cond_destroy(&m_condv);
+    }
+
+    /* May be called from any thread. */
+    void put(struct ble_npl_event *ev) {
+        struct ble_npl_event *top;
+        uint8_t state;
+
+        state = WQUEUE_EV_IDLE;
+        if (!__atomic_compare_exchange_n(&ev->ev_queued, &state,
+                                         WQUEUE_EV_LINKING, false,
+                                         __ATOMIC_ACQ_REL,
+                                         __ATOMIC_ACQUIRE)) {
+            /* Already queued, or being queued by another thread. */
+            return;
+        }
+
+        top = __atomic_load_n(&m_stack, __ATOMIC_RELAXED);
+        do {
+            ev->ev_next = top;
+        } while (!__atomic_compare_exchange_n(&m_stack, &top, ev, true,
+                                              __ATOMIC_SEQ_CST,
+                                              __ATOMIC_RELAXED));
+
+        /* Nobody else changes the state while it is LINKING, even if the
+         * consumer has already popped the event.
+         */
+        __atomic_store_n(&ev->ev_queued, WQUEUE_EV_QUEUED, __ATOMIC_RELEASE);
+
+        if (__atomic_load_n(&m_sleeping, __ATOMIC_SEQ_CST)) {
+            pthread_mutex_lock(&m_mutex);
+            pthread_cond_signal(&m_condv);
+            pthread_mutex_unlock(&m_mutex);
+        }
+    }
+
+    /* Consumer only. */
+    struct ble_npl_event *get(ble_npl_time_t tmo) {
+        struct ble_npl_event *ev;
+        struct timespec deadline;
+
+        if (tmo != 0 && tmo != BLE_NPL_TIME_FOREVER) {
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_sec += tmo / 1000;
+            deadline.tv_nsec += (tmo % 1000) * 1000000;
+            if (deadline.tv_nsec >= 1000000000) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000;
+            }
+        }
+
+        for (;;) {
+            ev = pop();
+            if (ev != NULL || tmo == 0) {
+                return ev;
+            }
+
+            /* Woken up, but the events put may have been removed already. */
+            if (!wait(tmo == BLE_NPL_TIME_FOREVER ? NULL : &deadline)) {
+                return pop();
+            }
+        }
+    }
+
+    /* May be called from any thread. */
+    void remove(struct ble_npl_event *ev) {
         pthread_mutex_lock(&m_mutex);
-        int size = m_queue.size();
+
+        wait_linked(ev);
+
+        if (__atomic_load_n(&ev->ev_queued, __ATOMIC_ACQUIRE) ==
+            WQUEUE_EV_QUEUED &&
+            (unlink_head(ev) || unlink_stack(ev))) {
+
+            ev->ev_next = NULL;
+            __atomic_store_n(&ev->ev_queued, WQUEUE_EV_IDLE, __ATOMIC_RELEASE);
+        }
+
         pthread_mutex_unlock(&m_mutex);
-        return size;
+    }
+
+    /* Only a hint when called from a thread other than the consumer. */
+    bool is_empty() {
+        return m_head == NULL &&
+               __atomic_load_n(&m_stack, __ATOMIC_ACQUIRE) == NULL;
     }
 };
 
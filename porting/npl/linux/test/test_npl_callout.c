@@ -27,6 +27,8 @@
   void ble_npl_callout_stop(struct ble_npl_callout *c);
 */
 
+#include <string.h>
+#include <unistd.h>
 #include "test_util.h"
 #include "nimble/nimble_npl.h"
 
@@ -36,6 +38,7 @@
 static bool                   s_tests_running = true;
 static struct ble_npl_task    s_task;
 static struct ble_npl_callout s_callout;
+static struct ble_npl_callout s_callout_stopped;
 static int                    s_callout_args = TEST_ARGS_VALUE;
 
 static struct ble_npl_eventq  s_eventq;
@@ -74,11 +77,69 @@ int test_queued(void)
 
 int test_reset(void)
 {
-    return ble_npl_callout_reset(&s_callout, TEST_INTERVAL);
+    uint32_t remaining;
+
+    SuccessOrQuit(ble_npl_callout_reset(&s_callout, TEST_INTERVAL),
+                  "callout: reset failed");
+    VerifyOrQuit(ble_npl_callout_is_active(&s_callout),
+                 "callout: not active after reset");
+
+    remaining = ble_npl_callout_remaining_ticks(&s_callout,
+                                                ble_npl_time_get());
+    VerifyOrQuit(remaining > 0 && remaining <= TEST_INTERVAL,
+                 "callout: wrong remaining ticks");
+
+    return PASS;
+}
+
+void on_callout_stopped(struct ble_npl_event *ev)
+{
+    VerifyOrQuit(0, "callout: stopped callout expired");
 }
 
 int test_stop(void)
 {
+    ble_npl_callout_init(&s_callout_stopped, &s_eventq,
+                         on_callout_stopped, NULL);
+    SuccessOrQuit(ble_npl_callout_reset(&s_callout_stopped,
+                                        TEST_INTERVAL / 2),
+                  "callout: reset failed");
+
+    ble_npl_callout_stop(&s_callout_stopped);
+    VerifyOrQuit(!ble_npl_callout_is_active(&s_callout_stopped),
+                 "callout: active after stop");
+    VerifyOrQuit(ble_npl_callout_remaining_ticks(&s_callout_stopped,
+                                                 ble_npl_time_get()) == 0,
+                 "callout: remaining ticks after stop");
+
+    return PASS;
+}
+
+int test_stop_expired(void)
+{
+    ble_npl_callout_init(&s_callout_stopped, &s_eventq,
+                         on_callout_stopped, NULL);
+    SuccessOrQuit(ble_npl_callout_reset(&s_callout_stopped, 1),
+                  "callout: reset failed");
+
+    /* Let the callout expire; its event is now sitting in the queue. */
+    usleep(20 * 1000);
+    VerifyOrQuit(!ble_npl_callout_is_active(&s_callout_stopped),
+                 "callout: active after expiring");
+    VerifyOrQuit(ble_npl_event_is_queued(&s_callout_stopped.c_ev),
+                 "callout: expired event not queued");
+
+    ble_npl_callout_stop(&s_callout_stopped);
+    VerifyOrQuit(!ble_npl_event_is_queued(&s_callout_stopped.c_ev),
+                 "callout: event queued after stop");
+
+    /* The callout may be reused right away. */
+    memset(&s_callout_stopped, 0xa5, sizeof(s_callout_stopped));
+    ble_npl_callout_init(&s_callout_stopped, &s_eventq,
+                         on_callout_stopped, NULL);
+    VerifyOrQuit(ble_npl_eventq_get(&s_eventq, 0) == NULL,
+                 "callout: stopped event delivered");
+
     return PASS;
 }
 
@@ -92,12 +153,17 @@ void *test_task_run(void *args)
     SuccessOrQuit(test_init(),   "callout_init failed");
     SuccessOrQuit(test_queued(), "callout_queued failed");
     SuccessOrQuit(test_reset(),  "callout_reset failed");
+    SuccessOrQuit(test_stop(),   "callout_stop failed");
+    SuccessOrQuit(test_stop_expired(), "callout_stop after expiry failed");
 
     while (s_tests_running)
     {
         ble_npl_eventq_run(&s_eventq);
     }
 
+    VerifyOrQuit(!ble_npl_callout_is_active(&s_callout),
+                 "callout: still active after expiring");
+
     printf("All tests passed\n");
     exit(PASS);
 
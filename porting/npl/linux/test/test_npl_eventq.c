@@ -32,6 +32,8 @@
 
 #include <assert.h>
 #include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
 #include "test_util.h"
 #include "nimble/nimble_npl.h"
 
@@ -102,6 +104,170 @@ int test_get(void)
     return PASS;
 }
 
+int test_get_timeout(void)
+{
+    ble_npl_time_t start;
+    ble_npl_time_t elapsed;
+
+    VerifyOrQuit(ble_npl_eventq_get(&s_eventq, 0) == NULL,
+                 "eventq: event from empty queue");
+
+    start = ble_npl_time_get();
+    VerifyOrQuit(ble_npl_eventq_get(&s_eventq, 50) == NULL,
+                 "eventq: event from empty queue");
+    elapsed = ble_npl_time_get() - start;
+
+    VerifyOrQuit(elapsed >= 50 && elapsed < 1000,
+                 "eventq: timed wait ignored timeout");
+
+    return PASS;
+}
+
+int test_remove(void)
+{
+    SuccessOrQuit(test_put(), "eventq_put failed");
+    VerifyOrQuit(ble_npl_event_is_queued(&s_event),
+                 "eventq: event not queued");
+
+    ble_npl_eventq_remove(&s_eventq, &s_event);
+    VerifyOrQuit(!ble_npl_event_is_queued(&s_event),
+                 "eventq: removed event still queued");
+    VerifyOrQuit(ble_npl_eventq_get(&s_eventq, 0) == NULL,
+                 "eventq: removed event delivered");
+
+    /* A removed event can be put again right away. */
+    SuccessOrQuit(test_put(), "eventq_put failed");
+    ble_npl_eventq_remove(&s_eventq, &s_event);
+    SuccessOrQuit(test_put(), "eventq_put failed");
+    VerifyOrQuit(ble_npl_eventq_get(&s_eventq, 0) == &s_event,
+                 "eventq: re-armed event not delivered");
+    VerifyOrQuit(ble_npl_eventq_get(&s_eventq, 0) == NULL,
+                 "eventq: event delivered twice");
+
+    return PASS;
+}
+
+int test_remove_reuse(void)
+{
+    struct ble_npl_event *evs[3];
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        evs[i] = malloc(sizeof(*evs[i]));
+        VerifyOrQuit(evs[i] != NULL, "eventq: out of memory");
+        ble_npl_event_init(evs[i], on_event, &s_event_args);
+        ble_npl_eventq_put(&s_eventq, evs[i]);
+    }
+
+    /* Not yet seen by the consumer. */
+    ble_npl_eventq_remove(&s_eventq, evs[1]);
+    VerifyOrQuit(!ble_npl_event_is_queued(evs[1]),
+                 "eventq: removed event still queued");
+    memset(evs[1], 0xa5, sizeof(*evs[1]));
+    free(evs[1]);
+
+    VerifyOrQuit(ble_npl_eventq_get(&s_eventq, 0) == evs[0],
+                 "eventq: wrong event delivered");
+
+    /* Already moved to the consumer's list by the previous get. */
+    ble_npl_eventq_remove(&s_eventq, evs[2]);
+    memset(evs[2], 0xa5, sizeof(*evs[2]));
+    ble_npl_event_init(evs[2], on_event, &s_event_args);
+
+    VerifyOrQuit(ble_npl_eventq_get(&s_eventq, 0) == NULL,
+                 "eventq: removed event delivered");
+
+    /* The reused event is queued like a fresh one. */
+    ble_npl_eventq_put(&s_eventq, evs[0]);
+    ble_npl_eventq_put(&s_eventq, evs[2]);
+    VerifyOrQuit(ble_npl_eventq_get(&s_eventq, 0) == evs[0],
+                 "eventq: wrong event delivered");
+    VerifyOrQuit(ble_npl_eventq_get(&s_eventq, 0) == evs[2],
+                 "eventq: reused event not delivered");
+    VerifyOrQuit(ble_npl_eventq_get(&s_eventq, 0) == NULL,
+                 "eventq: event delivered twice");
+
+    free(evs[0]);
+    free(evs[2]);
+
+    return PASS;
+}
+
+#define TEST_STRESS_PRODUCERS  (4)
+#define TEST_STRESS_PUTS       (100000)
+
+static struct ble_npl_event   s_stress_event;
+static volatile bool          s_stress_running;
+static int                    s_stress_done;
+
+static void *stress_producer(void *args)
+{
+    int i;
+
+    for (i = 0; i < TEST_STRESS_PUTS; i++) {
+        ble_npl_eventq_put(&s_eventq, &s_stress_event);
+    }
+
+    __atomic_fetch_add(&s_stress_done, 1, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+static void *stress_remover(void *args)
+{
+    while (s_stress_running) {
+        ble_npl_eventq_remove(&s_eventq, &s_stress_event);
+    }
+
+    return NULL;
+}
+
+int test_put_concurrent(void)
+{
+    pthread_t producers[TEST_STRESS_PRODUCERS];
+    pthread_t remover;
+    struct ble_npl_event *ev;
+    int i;
+
+    ble_npl_event_init(&s_stress_event, on_event, &s_event_args);
+    s_stress_running = true;
+
+    /* The same event is put from several threads while the consumer and
+     * remove() keep unlinking it, so puts race with the event leaving the
+     * queue.
+     */
+    for (i = 0; i < TEST_STRESS_PRODUCERS; i++) {
+        VerifyOrQuit(pthread_create(&producers[i], NULL, stress_producer,
+                                    NULL) == 0,
+                     "eventq: cannot create producer");
+    }
+    VerifyOrQuit(pthread_create(&remover, NULL, stress_remover, NULL) == 0,
+                 "eventq: cannot create remover");
+
+    while (__atomic_load_n(&s_stress_done, __ATOMIC_ACQUIRE) <
+           TEST_STRESS_PRODUCERS) {
+        ev = ble_npl_eventq_get(&s_eventq, 0);
+        VerifyOrQuit(ev == NULL || ev == &s_stress_event,
+                     "eventq: unexpected event delivered");
+    }
+
+    for (i = 0; i < TEST_STRESS_PRODUCERS; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    s_stress_running = false;
+    pthread_join(remover, NULL);
+
+    /* The event is linked at most once. */
+    ev = ble_npl_eventq_get(&s_eventq, 0);
+    VerifyOrQuit(ev == NULL || ev == &s_stress_event,
+                 "eventq: unexpected event delivered");
+    VerifyOrQuit(ble_npl_eventq_get(&s_eventq, 0) == NULL,
+                 "eventq: event delivered twice");
+    VerifyOrQuit(!ble_npl_event_is_queued(&s_stress_event),
+                 "eventq: delivered event still queued");
+
+    return PASS;
+}
 
 void *task_test_runner(void *args)
 {
@@ -110,6 +276,10 @@ void *task_test_runner(void *args)
     SuccessOrQuit(test_init(), "eventq_init failed");
     SuccessOrQuit(test_put(),  "eventq_put failed");
     SuccessOrQuit(test_get(),  "eventq_get failed");
+    SuccessOrQuit(test_get_timeout(), "eventq_get timeout failed");
+    SuccessOrQuit(test_remove(), "eventq_remove failed");
+    SuccessOrQuit(test_remove_reuse(), "eventq_remove reuse failed");
+    SuccessOrQuit(test_put_concurrent(), "eventq_put concurrent failed");
     SuccessOrQuit(test_put(),  "eventq_put failed");
     SuccessOrQuit(test_run(),  "eventq_run failed");
 
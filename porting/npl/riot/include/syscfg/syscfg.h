@@ -929,6 +929,14 @@
 #define MYNEWT_VAL_BLE_LL_CFG_FEAT_SLAVE_INIT_FEAT_XCHG (1)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_LL_CHAN_REMAP_TABLE
+#define MYNEWT_VAL_BLE_LL_CHAN_REMAP_TABLE (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_LL_CONN_ADAPTIVE_BURST
+#define MYNEWT_VAL_BLE_LL_CONN_ADAPTIVE_BURST (0)
+#endif
+
 /* Overridden by @apache-mynewt-nimble/porting/targets/riot (defined by @apache-mynewt-nimble/nimble/controller) */
 #ifndef MYNEWT_VAL_BLE_LL_CONN_INIT_MAX_TX_BYTES
 #define MYNEWT_VAL_BLE_LL_CONN_INIT_MAX_TX_BYTES (MYNEWT_VAL_BLE_LL_MAX_PKT_SIZE)
@@ -1007,6 +1015,10 @@
 #define MYNEWT_VAL_BLE_LL_PRIO (0)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_LL_RESOLV_CACHE_SIZE
+#define MYNEWT_VAL_BLE_LL_RESOLV_CACHE_SIZE (8)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_LL_RESOLV_LIST_SIZE
 #define MYNEWT_VAL_BLE_LL_RESOLV_LIST_SIZE (4)
 #endif
@@ -1025,6 +1037,18 @@
 #define MYNEWT_VAL_BLE_LL_SCA (60)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_LL_SCAN_DUP_EXPIRY_MS
+#define MYNEWT_VAL_BLE_LL_SCAN_DUP_EXPIRY_MS (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_LL_SCAN_DUP_HASH_SIZE
+#define MYNEWT_VAL_BLE_LL_SCAN_DUP_HASH_SIZE (16)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_LL_SCAN_RPT_COALESCE_MS
+#define MYNEWT_VAL_BLE_LL_SCAN_RPT_COALESCE_MS (0)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_LL_SCHED_AUX_CHAIN_MAFS_DELAY
 #define MYNEWT_VAL_BLE_LL_SCHED_AUX_CHAIN_MAFS_DELAY (0)
 #endif
@@ -1041,6 +1065,10 @@
 #define MYNEWT_VAL_BLE_LL_SCHED_SCAN_SYNC_PDU_LEN (32)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_LL_SCHED_SKIPLIST_LEVELS
+#define MYNEWT_VAL_BLE_LL_SCHED_SKIPLIST_LEVELS (0)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_LL_STRICT_CONN_SCHEDULING
 #define MYNEWT_VAL_BLE_LL_STRICT_CONN_SCHEDULING (0)
 #endif
@@ -1112,6 +1140,38 @@
 #define MYNEWT_VAL_BLE_PHY_DBG_TIME_WFR_PIN (-1)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_PHY_NATIVE_SIM
+#define MYNEWT_VAL_BLE_PHY_NATIVE_SIM (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_PHY_NATIVE_SIM_DIR
+#define MYNEWT_VAL_BLE_PHY_NATIVE_SIM_DIR ("/tmp/nimble-air")
+#endif
+
+#ifndef MYNEWT_VAL_BLE_PHY_NATIVE_SIM_LATENCY_US
+#define MYNEWT_VAL_BLE_PHY_NATIVE_SIM_LATENCY_US (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_PHY_NATIVE_SIM_LOSS_PCT
+#define MYNEWT_VAL_BLE_PHY_NATIVE_SIM_LOSS_PCT (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_PHY_NATIVE_SIM_MAX_NODES
+#define MYNEWT_VAL_BLE_PHY_NATIVE_SIM_MAX_NODES (16)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_PHY_NATIVE_SIM_POLL_US
+#define MYNEWT_VAL_BLE_PHY_NATIVE_SIM_POLL_US (250)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_PHY_NATIVE_SIM_RSSI
+#define MYNEWT_VAL_BLE_PHY_NATIVE_SIM_RSSI (-50)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_PHY_NATIVE_SIM_WFR_PAD_US
+#define MYNEWT_VAL_BLE_PHY_NATIVE_SIM_WFR_PAD_US (2000)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_PHY_NRF52840_ERRATA_164
 #define MYNEWT_VAL_BLE_PHY_NRF52840_ERRATA_164 (0)
 #endif
@@ -1149,6 +1209,10 @@
 #define MYNEWT_VAL_BLE_ATT_SVR_NOTIFY (1)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_ATT_SVR_NOTIFY_MULTI
+#define MYNEWT_VAL_BLE_ATT_SVR_NOTIFY_MULTI (1)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_ATT_SVR_QUEUED_WRITE
 #define MYNEWT_VAL_BLE_ATT_SVR_QUEUED_WRITE (1)
 #endif
@@ -1173,6 +1237,10 @@
 #define MYNEWT_VAL_BLE_ATT_SVR_READ_MULT (1)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_ATT_SVR_READ_MULT_VAR
+#define MYNEWT_VAL_BLE_ATT_SVR_READ_MULT_VAR (1)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_ATT_SVR_READ_TYPE
 #define MYNEWT_VAL_BLE_ATT_SVR_READ_TYPE (1)
 #endif
@@ -1229,6 +1297,34 @@
 #define MYNEWT_VAL_BLE_GATT_NOTIFY (1)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_GATT_NOTIFY_MULTI
+#define MYNEWT_VAL_BLE_GATT_NOTIFY_MULTI (1)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_GATT_NOTIFY_MULTI_MAX_ATTRS
+#define MYNEWT_VAL_BLE_GATT_NOTIFY_MULTI_MAX_ATTRS (16)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_GATT_ROBUST_CACHING
+#define MYNEWT_VAL_BLE_GATT_ROBUST_CACHING (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_GATT_CACHING
+#define MYNEWT_VAL_BLE_GATT_CACHING (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_GATT_DISC_DB
+#define MYNEWT_VAL_BLE_GATT_DISC_DB (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_GATT_DISC_DB_MAX_SVCS
+#define MYNEWT_VAL_BLE_GATT_DISC_DB_MAX_SVCS (8)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_GATT_DISC_DB_MAX_CHRS
+#define MYNEWT_VAL_BLE_GATT_DISC_DB_MAX_CHRS (32)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_GATT_READ
 #define MYNEWT_VAL_BLE_GATT_READ (MYNEWT_VAL_BLE_ROLE_CENTRAL)
 #endif
@@ -1245,6 +1341,10 @@
 #define MYNEWT_VAL_BLE_GATT_READ_MULT (MYNEWT_VAL_BLE_ROLE_CENTRAL)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_GATT_READ_MULT_VAR
+#define MYNEWT_VAL_BLE_GATT_READ_MULT_VAR (MYNEWT_VAL_BLE_ROLE_CENTRAL)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_GATT_READ_UUID
 #define MYNEWT_VAL_BLE_GATT_READ_UUID (MYNEWT_VAL_BLE_ROLE_CENTRAL)
 #endif
@@ -1305,6 +1405,18 @@
 #define MYNEWT_VAL_BLE_HS_FLOW_CTRL_TX_ON_DISCONNECT (0)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_HS_HCI_CMD_MAX_INFLIGHT
+#define MYNEWT_VAL_BLE_HS_HCI_CMD_MAX_INFLIGHT (4)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_HS_STARTUP_CACHE
+#define MYNEWT_VAL_BLE_HS_STARTUP_CACHE (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_HS_TX_SCHED_WEIGHTED
+#define MYNEWT_VAL_BLE_HS_TX_SCHED_WEIGHTED (0)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_HS_LOG_LVL
 #define MYNEWT_VAL_BLE_HS_LOG_LVL (1)
 #endif
@@ -1345,6 +1457,14 @@
 #define MYNEWT_VAL_BLE_L2CAP_ENHANCED_COC (0)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_EATT_CHAN_NUM
+#define MYNEWT_VAL_BLE_EATT_CHAN_NUM (0)
+#endif
+
+#ifndef MYNEWT_VAL_BLE_EATT_MTU
+#define MYNEWT_VAL_BLE_EATT_MTU (128)
+#endif
+
 #ifndef MYNEWT_VAL_BLE_L2CAP_JOIN_RX_FRAGS
 #define MYNEWT_VAL_BLE_L2CAP_JOIN_RX_FRAGS (1)
 #endif
@@ -1459,6 +1579,10 @@
 #define MYNEWT_VAL_BLE_STORE_MAX_CCCDS (8)
 #endif
 
+#ifndef MYNEWT_VAL_BLE_STORE_MAX_PEER_ATTRS
+#define MYNEWT_VAL_BLE_STORE_MAX_PEER_ATTRS (0)
+#endif
+
 /*** @apache-mynewt-nimble/nimble/host/services/gap */
 #ifndef MYNEWT_VAL_BLE_SVC_GAP_APPEARANCE
 #define MYNEWT_VAL_BLE_SVC_GAP_APPEARANCE (0)